@@ -33,6 +33,12 @@ void register_tests_graphslam();
 void register_tests_CObservation3DRangeScan();
 void register_tests_atan2lut();
 void register_tests_strings();
+void register_tests_pf();
+void register_tests_velodyne();
+void register_tests_bundle_adjustment();
+void register_tests_kf_slam();
+void register_tests_rrt();
+void register_tests_serialization();
 // -------------------------------------------------
 
 using TestFunctor = std::function<double(int,int)>; // return run-time in secs.
@@ -50,6 +50,7 @@ double obs3d_test_depth_to_3d(int a, int b)
 	T3DPointsProjectionParams pp;
 	pp.PROJ3D_USE_LUT = (a & 0x01)!=0;
 	pp.USE_SSE2 = (a & 0x02)!=0;
+	if (a & 0x04) pp.numThreads = a >> 4; // Number of threads in the high bits (0=all cores)
 
 	TRangeImageFilterParams fp;
 	mrpt::math::CMatrix minF, maxF;
@@ -132,6 +133,11 @@ void register_tests_CObservation3DRangeScan()
 		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->3D (LUT,w/o SSE2,min/maxFilter)",obs3d_test_depth_to_3d, 0x01,0x03) );
 		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->3D (LUT,w/SSE2,min/maxFilter)",obs3d_test_depth_to_3d, 0x03, 0x03) );
 
+		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->3D (LUT,w/SSE2,2 threads)",obs3d_test_depth_to_3d, 0x07 | (2<<4), 0) );
+		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->3D (LUT,w/SSE2,4 threads)",obs3d_test_depth_to_3d, 0x07 | (4<<4), 0) );
+		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->3D (LUT,w/SSE2,all cores)",obs3d_test_depth_to_3d, 0x07, 0) );
+		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->3D (no LUT,all cores,min/maxFilter)",obs3d_test_depth_to_3d, 0x04, 0x03) );
+
 		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->2D scan",obs3d_test_depth_to_2d_scan ) );
 		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->2D scan + min_filter",obs3d_test_depth_to_2d_scan, 1, 0 ) );
 		lstTests.push_back( TestData("3DRangeScan: 320x240 Depth->2D scan + max_filter",obs3d_test_depth_to_2d_scan, 0, 1 ) );
@@ -0,0 +1,65 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+// Reuse code from unit test:
+#include "../../libs/vision/src/bundle_adjustment_test_common.h"
+
+#include "common.h"
+
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+using namespace std;
+
+// ------------------------------------------------------
+//				Benchmark: bundle_adj_full
+// ------------------------------------------------------
+// A synthetic scene with "nFrames" cameras and 100 points per camera, each point seen from 5 cameras.
+// Returns the time per Levenberg-Marquardt iteration.
+double ba_full_solve(int nFrames, int nThreads, int solver)
+{
+	const TCamera cam;
+	TSequenceFeatureObservations obs;
+	TFramePosesVec gt_frames, frames;
+	TLandmarkLocationsVec points;
+	BundleAdjustmentTestScene::create(nFrames, 100*nFrames, 0.5, cam, obs, gt_frames, frames, points);
+
+	const size_t N = 3;
+	TParametersDouble params;
+	params["num_fix_frames"] = 2;
+	params["max_iterations"] = N;
+	params["solver"] = solver;
+	params["num_threads"] = nThreads;
+
+	CTicTac tictac;
+	bundle_adj_full(obs, cam, frames, points, params);
+	return tictac.Tac()/N;
+}
+
+double ba_full_solve_cholesky(int nFrames, int nThreads)
+{
+	return ba_full_solve(nFrames, nThreads, 0);
+}
+
+double ba_full_solve_pcg(int nFrames, int nThreads)
+{
+	return ba_full_solve(nFrames, nThreads, 1);
+}
+
+// ------------------------------------------------------
+// register_tests_bundle_adjustment
+// ------------------------------------------------------
+void register_tests_bundle_adjustment()
+{
+	lstTests.push_back( TestData("vision: bundle_adj_full (100 cams, 10k points, sparse Cholesky), per iter.", ba_full_solve_cholesky, 100, 1 ) );
+	lstTests.push_back( TestData("vision: bundle_adj_full (100 cams, 10k points, PCG), per iter.", ba_full_solve_pcg, 100, 1 ) );
+	lstTests.push_back( TestData("vision: bundle_adj_full (1k cams, 100k points, sparse Cholesky), per iter.", ba_full_solve_cholesky, 1000, 1 ) );
+	lstTests.push_back( TestData("vision: bundle_adj_full (1k cams, 100k points, sparse Cholesky, 4 threads), per iter.", ba_full_solve_cholesky, 1000, 4 ) );
+	lstTests.push_back( TestData("vision: bundle_adj_full (1k cams, 100k points, PCG), per iter.", ba_full_solve_pcg, 1000, 1 ) );
+	lstTests.push_back( TestData("vision: bundle_adj_full (1k cams, 100k points, PCG, 4 threads), per iter.", ba_full_solve_pcg, 1000, 4 ) );
+}
@@ -160,7 +160,7 @@ double feature_extraction_test_SURF( int N, int h )
 // ------------------------------------------------------
 //				Benchmark: FAST
 // ------------------------------------------------------
-double feature_extraction_test_FAST( int N, int h )
+double feature_extraction_test_FAST( int N, int nThreads )
 {
 	CTicTac			tictac;
 
@@ -174,6 +174,7 @@ double feature_extraction_test_FAST( int N, int h )
 	fExt.options.featsType	= featFAST;
 	fExt.options.FASTOptions.threshold = 20;
 	fExt.options.patchSize = 0;
+	if (nThreads>0) fExt.options.numThreads = nThreads;
 
 	img.grayscaleInPlace();
 
@@ -223,7 +224,7 @@ GENERATE_BENCHMARK_FASTERS(feature_extraction_test_FAST12, detectFeatures_SSE2_F
 // ------------------------------------------------------
 //				Benchmark: Spin descriptor
 // ------------------------------------------------------
-double feature_extraction_test_Spin_desc( int N, int h )
+double feature_extraction_test_Spin_desc( int N, int nThreads )
 {
 	CTicTac	 tictac;
 
@@ -237,6 +238,7 @@ double feature_extraction_test_Spin_desc( int N, int h )
 	fExt.options.SpinImagesOptions.radius				= 13;
 	fExt.options.SpinImagesOptions.hist_size_distance	= 10;
 	fExt.options.SpinImagesOptions.hist_size_intensity	= 10;
+	if (nThreads>0) fExt.options.numThreads = nThreads;
 
 	fExt.detectFeatures( img, featsHarris );
 
@@ -291,7 +293,9 @@ void register_tests_feature_extraction()
 #endif
 	lstTests.push_back( TestData("feature_extraction [640x480]: SURF", feature_extraction_test_SURF, 10  ) );
 	lstTests.push_back( TestData("feature_extraction [640x480]: FAST", feature_extraction_test_FAST, 100  ) );
+	lstTests.push_back( TestData("feature_extraction [640x480]: FAST (4 threads)", feature_extraction_test_FAST, 100, 4 ) );
 	lstTests.push_back( TestData("feature_extraction [640x480]: Spin desc.", feature_extraction_test_Spin_desc, 30  ) );
+	lstTests.push_back( TestData("feature_extraction [640x480]: Spin desc. (4 threads)", feature_extraction_test_Spin_desc, 30, 4 ) );
 
 	lstTests.push_back( TestData("feature_extraction [640x480]: FASTER-9", feature_extraction_test_FASTER<featFASTER9,0>, 100 , 20 ) );
 	lstTests.push_back( TestData("feature_extraction [640x480]: FASTER-9 (sorted best 200)", feature_extraction_test_FASTER<featFASTER9,200>, 100 , 20 ) );
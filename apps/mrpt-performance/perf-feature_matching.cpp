@@ -9,6 +9,8 @@
 
 #include <mrpt/utils/CImage.h>
 #include <mrpt/vision/CFeatureExtraction.h>
+#include <mrpt/vision/CBinaryDescriptorIndex.h>
+#include <mrpt/random.h>
 
 #include "common.h"
 
@@ -254,6 +256,71 @@ double feature_matching_test_FAST_SAD( int w, int h )
 	return T;
 }
 
+// ------------------------------------------------------
+//	Binary descriptors: N random 256 bit descriptors, and
+//  queries at a few bits from them.
+// ------------------------------------------------------
+static void makeBinaryDescriptors(int N, std::vector<uint8_t> &descs, std::vector<uint8_t> &queries, size_t &nQueries)
+{
+	const size_t LEN = 32;
+	mrpt::random::CRandomGenerator rng(123);
+	descs.resize(N*LEN);
+	for (size_t i=0;i<descs.size();i++)
+		descs[i] = static_cast<uint8_t>(rng.drawUniform32bit());
+
+	nQueries = 1000;
+	queries.resize(nQueries*LEN);
+	for (size_t q=0;q<nQueries;q++)
+	{
+		const size_t i = rng.drawUniform32bit() % N;
+		for (size_t k=0;k<LEN;k++) queries[q*LEN+k] = descs[i*LEN+k];
+		for (int b=0;b<10;b++)
+		{
+			const uint32_t bit = rng.drawUniform32bit() % (LEN*8);
+			queries[q*LEN + bit/8] ^= (1 << (bit%8));
+		}
+	}
+}
+
+double feature_matching_test_binary_bruteforce( int N, int dummy )
+{
+	std::vector<uint8_t> descs, queries;
+	size_t nQueries;
+	makeBinaryDescriptors(N, descs, queries, nQueries);
+
+	CTicTac	 tictac;
+	std::vector<std::pair<size_t,size_t> > matches;
+	for (size_t q=0;q<nQueries;q++)
+	{
+		uint32_t best1 = 1000, best2 = 1000;
+		size_t best_idx = 0;
+		for (int i=0;i<N;i++)
+		{
+			const uint32_t d = CBinaryDescriptorIndex::hammingDistance(&queries[q*32], &descs[i*32], 32);
+			if (d<best1) { best2 = best1; best1 = d; best_idx = i; }
+			else if (d<best2) best2 = d;
+		}
+		if (best1<=64 && best1<0.8f*best2)
+			matches.push_back(std::make_pair(q,best_idx));
+	}
+	return tictac.Tac()/nQueries;
+}
+
+double feature_matching_test_binary_index( int N, int nThreads )
+{
+	std::vector<uint8_t> descs, queries;
+	size_t nQueries;
+	makeBinaryDescriptors(N, descs, queries, nQueries);
+
+	CBinaryDescriptorIndex idx;
+	idx.build(&descs[0], N, 32);
+
+	CTicTac	 tictac;
+	std::vector<std::pair<size_t,size_t> > matches;
+	idx.matchRatioTest(&queries[0], nQueries, 0.8f, 64, matches, nThreads);
+	return tictac.Tac()/nQueries;
+}
+
 // ------------------------------------------------------
 // register_tests_feature_extraction
 // ------------------------------------------------------
@@ -267,4 +334,10 @@ void register_tests_feature_matching()
 	lstTests.push_back( TestData("feature_matching [640x480]: SURF", feature_matching_test_SURF, 640, 480 ) );
 	lstTests.push_back( TestData("feature_matching [640x480]: FAST + CC", feature_matching_test_FAST_CC, 640, 480 ) );
 	lstTests.push_back( TestData("feature_matching [640x480]: FAST + SAD", feature_matching_test_FAST_SAD, 640, 480 ) );
+
+	lstTests.push_back( TestData("feature_matching: ORB ratio test, brute force (1e4 ORB descs)", feature_matching_test_binary_bruteforce, 10000 ) );
+	lstTests.push_back( TestData("feature_matching: ORB ratio test, Hamming index (1e4 ORB descs)", feature_matching_test_binary_index, 10000, 1 ) );
+	lstTests.push_back( TestData("feature_matching: ORB ratio test, Hamming index (1e4 ORB descs, 4 threads)", feature_matching_test_binary_index, 10000, 4 ) );
+	lstTests.push_back( TestData("feature_matching: ORB ratio test, brute force (1e5 ORB descs)", feature_matching_test_binary_bruteforce, 100000 ) );
+	lstTests.push_back( TestData("feature_matching: ORB ratio test, Hamming index (1e5 ORB descs)", feature_matching_test_binary_index, 100000, 1 ) );
 }
@@ -64,6 +64,64 @@ double graphslam_levmarq_solve(int nVertices, int N)
 }
 
 
+// Large synthetic 3D pose graph: a lawnmower path over a square grid, with odometry edges between consecutive
+// poses plus loop closures with the neighbor in the previous row. Initial node poses are noisy.
+template <class GRAPH_TYPE>
+void create_large_grid_graph(GRAPH_TYPE &graph, size_t nVertices)
+{
+	const size_t W = std::max<size_t>(2, static_cast<size_t>(std::sqrt(double(nVertices))));
+	typename GRAPH_TYPE::global_poses_t  real_poses;
+	for (TNodeID j=0;j<nVertices;j++)
+	{
+		const size_t row = j/W, col = (row%2)==0 ? j%W : W-1-(j%W);
+		real_poses[j] = typename GRAPH_TYPE::global_pose_t( CPose3D(col, row, 0.1*std::sin(0.1*j), (row%2)==0 ? 0:M_PI, 0,0) );
+	}
+	for (TNodeID j=0;j<nVertices;j++)
+	{
+		if (j+1<nVertices)
+			GraphSlamLevMarqTest<GRAPH_TYPE>::addEdge(j,j+1,real_poses,graph);
+		// Neighbor in the previous row:
+		const size_t row = j/W, col = j%W;
+		if (row>0)
+			GraphSlamLevMarqTest<GRAPH_TYPE>::addEdge(row*W-1-col,j,real_poses,graph);
+	}
+	graph.root = TNodeID(0);
+	for (typename GRAPH_TYPE::global_poses_t::const_iterator it=real_poses.begin();it!=real_poses.end();++it)
+	{
+		typename GRAPH_TYPE::global_pose_t p = it->second;
+		if (it->first!=graph.root)
+			p += typename GRAPH_TYPE::global_pose_t( CPose3D(
+				randomGenerator.drawGaussian1D(0,0.05),randomGenerator.drawGaussian1D(0,0.05),randomGenerator.drawGaussian1D(0,0.05),
+				randomGenerator.drawGaussian1D(0,DEG2RAD(1)),randomGenerator.drawGaussian1D(0,DEG2RAD(1)),randomGenerator.drawGaussian1D(0,DEG2RAD(1)) ) );
+		graph.nodes[it->first] = p;
+	}
+}
+
+// Solves a large graph with a fixed number of LM iterations. "num_threads" applies to the evaluation of the edges, the Hessian and its Cholesky factorizations.
+template <class GRAPH_TYPE>
+double graphslam_levmarq_large(int nVertices, int num_threads)
+{
+	GRAPH_TYPE graph;
+	create_large_grid_graph(graph, nVertices);
+
+	TParametersDouble  params;
+	params["max_iterations"] = 10;
+	params["num_threads"] = num_threads;
+	params["e1"] = 0;
+	params["e2"] = 0;
+
+	CTimeLogger timer;
+	graphslam::TResultInfoSpaLevMarq  levmarq_info;
+	timer.enter("test");
+	graphslam::optimize_graph_spa_levmarq(graph, levmarq_info, NULL, params);
+	timer.leave("test");
+
+	const double ret =timer.getMeanTime("test");
+	timer.clear(true); // this disables dump to cout upon destruction
+	return ret;
+}
+
+
 // ------------------------------------------------------
 // register_tests_graphslam
 // ------------------------------------------------------
@@ -74,5 +132,8 @@ void register_tests_graphslam()
 	lstTests.push_back( TestData("graphslam(2d): levmarq 100 KFs/451 edges",graphslam_levmarq_solve<CNetworkOfPoses2D>, 100, 2) );
 	lstTests.push_back( TestData("graphslam(3d): levmarq 50 KFs/101 edges",graphslam_levmarq_solve<CNetworkOfPoses3D>, 50, 10) );
 	lstTests.push_back( TestData("graphslam(3d): levmarq 100 KFs/451 edges",graphslam_levmarq_solve<CNetworkOfPoses3D>, 100, 2) );
+	lstTests.push_back( TestData("graphslam(3d): levmarq 10 iters, 10000 KFs grid",graphslam_levmarq_large<CNetworkOfPoses3D>, 10000, 1) );
+	lstTests.push_back( TestData("graphslam(3d): levmarq 10 iters, 10000 KFs grid (all cores)",graphslam_levmarq_large<CNetworkOfPoses3D>, 10000, 0) );
+	lstTests.push_back( TestData("graphslam(3d): levmarq 10 iters, 50000 KFs grid (all cores)",graphslam_levmarq_large<CNetworkOfPoses3D>, 50000, 0) );
 
 }
@@ -167,6 +167,78 @@ double grid_test_8(int a1, int a2)
 	return tictac.Tac()/N;
 }
 
+// a1: number of poses per batch
+double grid_test_8_batch(int a1, int a2)
+{
+	randomGenerator.randomize(333);
+
+	// prepare the laser scan:
+	CObservation2DRangeScan	scan1;
+	scan1.aperture = M_PIf;
+	scan1.rightToLeft = true;
+	scan1.loadFromVectors( sizeof(SCAN_RANGES_1)/sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,SCAN_VALID_1 );
+
+	COccupancyGridMap2D		gridmap(-20,20,-20,20, 0.05f);
+	gridmap.likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmLikelihoodField_Thrun;
+
+	CPose3D pose3D(0,0,0);
+	gridmap.insertObservation( &scan1, &pose3D );
+
+	std::vector<mrpt::math::TPose2D> poses(a1);
+	for (int i=0;i<a1;i++)
+		poses[i] = mrpt::math::TPose2D(
+			randomGenerator.drawUniform(-1.0,1.0),
+			randomGenerator.drawUniform(-1.0,1.0),
+			randomGenerator.drawUniform(-M_PI,M_PI) );
+
+	std::vector<double> liks;
+	gridmap.computeObservationLikelihoods(&scan1,poses,liks); // Warm-up the cache
+
+	const long N = 10;
+	CTicTac tictac;
+	for (long i=0;i<N;i++)
+		gridmap.computeObservationLikelihoods(&scan1,poses,liks);
+	return tictac.Tac()/(N*a1);
+}
+
+// a1: 0=single pose evaluation, 1=batch
+double grid_test_8_LF(int a1, int a2)
+{
+	if (a1) return grid_test_8_batch(5000,0);
+
+	randomGenerator.randomize(333);
+
+	// prepare the laser scan:
+	CObservation2DRangeScan	scan1;
+	scan1.aperture = M_PIf;
+	scan1.rightToLeft = true;
+	scan1.loadFromVectors( sizeof(SCAN_RANGES_1)/sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,SCAN_VALID_1 );
+
+	COccupancyGridMap2D		gridmap(-20,20,-20,20, 0.05f);
+	gridmap.likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmLikelihoodField_Thrun;
+
+	CPose3D pose3D(0,0,0);
+	gridmap.insertObservation( &scan1, &pose3D );
+
+	std::vector<CPose2D> poses(5000);
+	for (size_t i=0;i<poses.size();i++)
+		poses[i] = CPose2D(
+			randomGenerator.drawUniform(-1.0,1.0),
+			randomGenerator.drawUniform(-1.0,1.0),
+			randomGenerator.drawUniform(-M_PI,M_PI) );
+
+	double R = 0;
+	for (size_t i=0;i<poses.size();i++) // Warm-up the cache
+		R+=gridmap.computeObservationLikelihood(&scan1,poses[i]);
+
+	const long N = 10;
+	CTicTac tictac;
+	for (long k=0;k<N;k++)
+		for (size_t i=0;i<poses.size();i++)
+			R+=gridmap.computeObservationLikelihood(&scan1,poses[i]);
+	return tictac.Tac()/(N*poses.size());
+}
+
 double grid_test_9(int a1, int a2)
 {
 	// test 9: computeMatchingWith2D
@@ -222,6 +294,8 @@ void register_tests_grids()
 	lstTests.push_back( TestData("gridmap2D: insert scan with widening",grid_test_5_6, 1) );
 	lstTests.push_back( TestData("gridmap2D: resize",grid_test_7) );
 	lstTests.push_back( TestData("gridmap2D: computeLikelihood",grid_test_8) );
+	lstTests.push_back( TestData("gridmap2D: computeLikelihood LF_Thrun, one pose",grid_test_8_LF, 0) );
+	lstTests.push_back( TestData("gridmap2D: computeLikelihood LF_Thrun, batch of 5000 poses (time per pose)",grid_test_8_LF, 1) );
 	lstTests.push_back( TestData("gridmap2D: determineMatching2D",grid_test_9, 5000 ) );
 }
 
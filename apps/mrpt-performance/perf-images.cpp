@@ -297,7 +297,7 @@ double stereoimage_rectify_prepare_map(int, int)
 }
 
 template <int IMG_CHANNELS,int w, int h, int w2, int h2>
-double stereoimage_rectify(int, int)
+double stereoimage_rectify(int nThreads, int in_place)
 {
 	const CImage  imgL(w,h,IMG_CHANNELS), imgR(w,h,IMG_CHANNELS);
 	CImage  imgL2, imgR2;
@@ -309,13 +309,17 @@ double stereoimage_rectify(int, int)
 	mrpt::vision::CStereoRectifyMap  rectify_map;
 	rectify_map.enableResizeOutput((w2!=w || h2!=h), w2,h2);
 	rectify_map.setFromCamParams(params);
+	if (nThreads) rectify_map.setNumThreads(nThreads);
+	if (in_place) { imgL2 = imgL; imgR2 = imgR; } // (Only used without resizing)
 
 	CTicTac	 tictac;
 	const size_t N = 20;
 	tictac.Tic();
 	for (size_t i=0;i<N;i++)
 	{
-	    rectify_map.rectify(imgL,imgR, imgL2,imgR2);
+		if (in_place)
+				rectify_map.rectify(imgL2,imgR2);
+		else	rectify_map.rectify(imgL,imgR, imgL2,imgR2);
 	}
 
 	return tictac.Tac()/N;
@@ -438,6 +442,12 @@ void register_tests_image()
 	lstTests.push_back( TestData("stereo: rectify 1024x768->800x600 GRAY", stereoimage_rectify<CH_GRAY,1024,768,800,600>) );
 	lstTests.push_back( TestData("stereo: rectify 1024x768->640x480 GRAY", stereoimage_rectify<CH_GRAY,1024,768,640,480>) );
 
+	lstTests.push_back( TestData("stereo: rectify 640x480 RGB (4 threads)",  stereoimage_rectify<CH_RGB,640,480,640,480>, 4) );
+	lstTests.push_back( TestData("stereo: rectify 1024x768 RGB (4 threads)", stereoimage_rectify<CH_RGB,1024,768,1024,768>, 4) );
+	lstTests.push_back( TestData("stereo: rectify 640x480 GRAY (4 threads)",  stereoimage_rectify<CH_GRAY,640,480,640,480>, 4) );
+	lstTests.push_back( TestData("stereo: rectify in place 640x480 RGB",  stereoimage_rectify<CH_RGB,640,480,640,480>, 1, 1) );
+	lstTests.push_back( TestData("stereo: rectify in place 640x480 RGB (4 threads)",  stereoimage_rectify<CH_RGB,640,480,640,480>, 4, 1) );
+
 }
 
 
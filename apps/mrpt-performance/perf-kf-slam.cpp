@@ -0,0 +1,128 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/slam/CRangeBearingKFSLAM2D.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/obs/CObservationBearingRange.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/math/wrap2pi.h>
+#include <mrpt/random.h>
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::bayes;
+using namespace mrpt::math;
+using namespace mrpt::slam;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::random;
+using namespace std;
+
+// ------------------------------------------------------
+//				Benchmark: range-bearing KF-SLAM
+// ------------------------------------------------------
+// A robot moving 1m per step along a corridor with 2 landmarks per meter, seen (with known IDs) up to 6m away.
+// The map is built until it has "nLandmarks", then returns the time per KF iteration (prediction+update+new landmarks).
+double kfslam_2d_iteration(int nLandmarks, int method)
+{
+	CRandomGenerator rng(123);
+	const double max_range = 6.0;
+
+	vector<double> lm_x, lm_y;
+	for (int i=0;i<nLandmarks+100;i++)
+	{
+		lm_x.push_back(0.5*i);
+		lm_y.push_back(rng.drawUniform(-4.0,4.0));
+	}
+
+	CRangeBearingKFSLAM2D slam;
+	slam.KF_options.method = static_cast<TKFMethod>(method);
+	slam.options.std_sensor_range = 0.01f;
+	slam.options.std_sensor_yaw = DEG2RAD(0.5f);
+
+	CActionRobotMovement2D::TMotionModelOptions odo_opts;
+	odo_opts.modelSelection = CActionRobotMovement2D::mmGaussian;
+	odo_opts.gaussianModel.a1 = 0;
+	odo_opts.gaussianModel.a2 = 0;
+	odo_opts.gaussianModel.a3 = 0;
+	odo_opts.gaussianModel.a4 = 0;
+	odo_opts.gaussianModel.minStdXY = 0.02f;
+	odo_opts.gaussianModel.minStdPHI = DEG2RAD(0.2f);
+
+	const size_t N = 10;
+	size_t nTimed = 0;
+	double t = 0;
+	CTicTac tictac;
+	CPose2D robot(-max_range,0,0);
+	while (nTimed<N)
+	{
+		robot.x_incr(1.0);
+
+		CActionCollectionPtr acts = CActionCollection::Create();
+		CActionRobotMovement2D act;
+		act.computeFromOdometry(CPose2D(1.0+rng.drawGaussian1D(0,0.01),0,rng.drawGaussian1D(0,DEG2RAD(0.1))), odo_opts);
+		acts->insert(act);
+
+		CObservationBearingRangePtr obs = CObservationBearingRange::Create();
+		obs->maxSensorDistance = max_range;
+		obs->fieldOfView_yaw = 2*M_PIf;
+		obs->sensor_std_range = slam.options.std_sensor_range;
+		obs->sensor_std_yaw = slam.options.std_sensor_yaw;
+		for (size_t i=0;i<lm_x.size();i++)
+		{
+			const double dx = lm_x[i]-robot.x(), dy = lm_y[i]-robot.y(), r = std::sqrt(dx*dx+dy*dy);
+			if (r>max_range) continue;
+			CObservationBearingRange::TMeasurement m;
+			m.range = static_cast<float>(r + rng.drawGaussian1D(0,0.01));
+			m.yaw = static_cast<float>(wrapToPi(atan2(dy,dx)-robot.phi()) + rng.drawGaussian1D(0,DEG2RAD(0.5)));
+			m.pitch = 0;
+			m.landmarkID = static_cast<int32_t>(i);
+			obs->sensedData.push_back(m);
+		}
+		CSensoryFramePtr sf = CSensoryFrame::Create();
+		sf->insert(obs);
+
+		const bool timed = slam.getNumberOfLandmarksInTheMap()>=size_t(nLandmarks);
+		tictac.Tic();
+		slam.processActionObservation(acts,sf);
+		if (timed)
+		{
+			t+=tictac.Tac();
+			nTimed++;
+		}
+	}
+	return t/N;
+}
+
+double kfslam_2d_ekf(int nLandmarks, int)
+{
+	return kfslam_2d_iteration(nLandmarks, kfEKFNaive);
+}
+
+double kfslam_2d_seif(int nLandmarks, int)
+{
+	return kfslam_2d_iteration(nLandmarks, kfSEIF);
+}
+
+// ------------------------------------------------------
+// register_tests_kf_slam
+// ------------------------------------------------------
+void register_tests_kf_slam()
+{
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfEKFNaive, 100 landmarks, per iter.", kfslam_2d_ekf, 100) );
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfSEIF, 100 landmarks, per iter.", kfslam_2d_seif, 100) );
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfEKFNaive, 200 landmarks, per iter.", kfslam_2d_ekf, 200) );
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfSEIF, 200 landmarks, per iter.", kfslam_2d_seif, 200) );
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfEKFNaive, 400 landmarks, per iter.", kfslam_2d_ekf, 400) );
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfSEIF, 400 landmarks, per iter.", kfslam_2d_seif, 400) );
+	lstTests.push_back( TestData("bayes: CRangeBearingKFSLAM2D kfSEIF, 1000 landmarks, per iter.", kfslam_2d_seif, 1000) );
+}
@@ -149,6 +149,12 @@ int main(int argc, char **argv)
 		register_tests_CObservation3DRangeScan();
 		register_tests_atan2lut();
 		register_tests_strings();
+		register_tests_pf();
+		register_tests_velodyne();
+		register_tests_bundle_adjustment();
+		register_tests_kf_slam();
+		register_tests_rrt();
+		register_tests_serialization();
 
 		if (doLog)
 		{
@@ -0,0 +1,80 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/slam/CMonteCarloLocalization2D.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random.h>
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::bayes;
+using namespace mrpt::slam;
+using namespace mrpt::maps;
+using namespace mrpt::obs;
+using namespace mrpt::random;
+using namespace mrpt::poses;
+using namespace std;
+
+// ------------------------------------------------------
+//				Benchmark particle filters
+// ------------------------------------------------------
+// a1: number of particles, a2: number of threads for weighting (0=all cores)
+double pf_test_mcl2d_update(int a1, int a2)
+{
+	randomGenerator.randomize(333);
+
+	CObservation2DRangeScanPtr scan = CObservation2DRangeScan::Create();
+	scan->aperture = M_PIf;
+	scan->rightToLeft = true;
+	scan->loadFromVectors( sizeof(SCAN_RANGES_1)/sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,SCAN_VALID_1 );
+
+	COccupancyGridMap2D gridmap(-20,20,-20,20, 0.05f);
+	gridmap.likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmLikelihoodField_Thrun;
+	const CPose3D pose3D(0,0,0);
+	gridmap.insertObservation( scan.pointer(), &pose3D );
+
+	CSensoryFrame sf;
+	sf.insert(scan);
+
+	CMonteCarloLocalization2D pdf;
+	pdf.options.metricMap = &gridmap;
+	pdf.resetUniform(-1,1, -1,1, -M_PI,M_PI, a1);
+
+	CParticleFilter::TParticleFilterOptions pfOpts;
+	pfOpts.PF_algorithm = CParticleFilter::pfStandardProposal;
+	pfOpts.numThreadsObsLikelihood = a2;
+
+	// Warm up the likelihood cache, so we only measure the weighting itself:
+	pdf.prediction_and_update(NULL, &sf, pfOpts);
+
+	const long N = 20;
+	CTicTac tictac;
+	for (long i=0;i<N;i++)
+		pdf.prediction_and_update(NULL, &sf, pfOpts);
+	return tictac.Tac()/N;
+}
+
+// ------------------------------------------------------
+// register_tests_pf
+// ------------------------------------------------------
+void register_tests_pf()
+{
+	lstTests.push_back( TestData("pf: MCL2D weighting 5000 particles, 1 thread",pf_test_mcl2d_update, 5000, 1) );
+	lstTests.push_back( TestData("pf: MCL2D weighting 5000 particles, 2 threads",pf_test_mcl2d_update, 5000, 2) );
+	lstTests.push_back( TestData("pf: MCL2D weighting 5000 particles, 4 threads",pf_test_mcl2d_update, 5000, 4) );
+	lstTests.push_back( TestData("pf: MCL2D weighting 5000 particles, all cores",pf_test_mcl2d_update, 5000, 0) );
+	lstTests.push_back( TestData("pf: MCL2D weighting 20000 particles, 1 thread",pf_test_mcl2d_update, 20000, 1) );
+	lstTests.push_back( TestData("pf: MCL2D weighting 20000 particles, 4 threads",pf_test_mcl2d_update, 20000, 4) );
+	lstTests.push_back( TestData("pf: MCL2D weighting 20000 particles, all cores",pf_test_mcl2d_update, 20000, 0) );
+}
@@ -9,6 +9,9 @@
 
 #include <mrpt/obs/CObservation2DRangeScan.h>
 #include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/maps/CPointCloudFilterVoxelGrid.h>
+#include <mrpt/maps/CPointCloudFilterRadiusOutliers.h>
+#include <mrpt/maps/CPointCloudFilterStatisticalOutliers.h>
 #include <mrpt/poses/CPose2D.h>
 #include <mrpt/random.h>
 
@@ -264,6 +267,64 @@ double pointmap_test_5(int a1, int a2)
 }
 
 
+double pointmap_test_6(int a1, int a2)
+{
+	// test 6: determineMatching3D with a1 points per cloud and a2 threads
+	// ----------------------------------------
+	CRandomGenerator rnd(1234);
+	CSimplePointsMap  pt_map, pt_map2;
+	for (int i=0;i<a1;i++)
+	{
+		pt_map.insertPoint(rnd.drawUniform(-20,20),rnd.drawUniform(-20,20),rnd.drawUniform(-2,2));
+		pt_map2.insertPoint(rnd.drawUniform(-20,20),rnd.drawUniform(-20,20),rnd.drawUniform(-2,2));
+	}
+
+	const CPose3D otherPose(0.05,0.04,0, DEG2RAD(4), 0,0);
+	TMatchingPairList	correspondences;
+	TMatchingParams matchParams;
+	TMatchingExtraResults matchExtraResults;
+	matchParams.maxDistForCorrespondence = 0.50f;
+	matchParams.numThreads = a2;
+
+	// Build the KD-tree out of the timed loop:
+	pt_map.determineMatching3D(&pt_map2, otherPose, correspondences, matchParams, matchExtraResults);
+
+	const long N = 20;
+	CTicTac	 tictac;
+	for (long i=0;i<N;i++)
+		pt_map.determineMatching3D(&pt_map2, otherPose, correspondences, matchParams, matchExtraResults);
+	return tictac.Tac()/N;
+}
+
+double pointmap_test_7(int a1, int a2)
+{
+	// test 7: point cloud filters on a1 points: a2=0: voxel grid, 1: radius outliers, 2: statistical outliers
+	// ----------------------------------------
+	CRandomGenerator rnd(1234);
+	CSimplePointsMap  pt_map_orig;
+	for (int i=0;i<a1;i++)
+		pt_map_orig.insertPoint(rnd.drawUniform(-10,10),rnd.drawUniform(-10,10),rnd.drawUniform(-1,1));
+
+	CPointCloudFilterVoxelGrid f_voxels;
+	f_voxels.options.voxel_size = 0.2;
+	CPointCloudFilterRadiusOutliers f_radius;
+	f_radius.options.radius = 0.2;
+	CPointCloudFilterStatisticalOutliers f_stats;
+	CPointCloudFilterBase *filters[3] = { &f_voxels, &f_radius, &f_stats };
+
+	const long N = 10;
+	double t = 0;
+	for (long i=0;i<N;i++)
+	{
+		CSimplePointsMap pt_map;
+		pt_map.copyFrom(pt_map_orig);
+		CTicTac	 tictac;
+		filters[a2]->filter(&pt_map, mrpt::system::now(), CPose3D());
+		t+=tictac.Tac();
+	}
+	return t/N;
+}
+
 // ------------------------------------------------------
 // register_tests_pointmaps
 // ------------------------------------------------------
@@ -286,12 +347,20 @@ void register_tests_pointmaps()
 
 	lstTests.push_back( TestData("pointmap: (insert scan+2D kd-tree query) x 10",pointmap_test_2,  10,  1 ) );
 	lstTests.push_back( TestData("pointmap: (insert scan+2D kd-tree query) x 50",pointmap_test_2,  50,  1 ) );
-	//lstTests.push_back( TestData("pointmap: (insert scan+2D kd-tree query) x 100",pointmap_test_2, 100, 1 ) );
+	lstTests.push_back( TestData("pointmap: (insert scan+2D kd-tree query) x 100",pointmap_test_2, 100, 1 ) );
 	lstTests.push_back( TestData("pointmap: (insert scan+3D kd-tree query) x 10",pointmap_test_2,  10,  2 ) );
 	lstTests.push_back( TestData("pointmap: (insert scan+3D kd-tree query) x 50",pointmap_test_2,  50,  2 ) );
-	//lstTests.push_back( TestData("pointmap: (insert scan+3D kd-tree query) x 100",pointmap_test_2, 100, 2 ) );
+	lstTests.push_back( TestData("pointmap: (insert scan+3D kd-tree query) x 100",pointmap_test_2, 100, 2 ) );
 
 	lstTests.push_back( TestData("pointmap: computeMatchingWith2D",pointmap_test_4, 5000 ) );
+	lstTests.push_back( TestData("pointmap: determineMatching3D 100k pts, 1 thread",pointmap_test_6, 100000, 1 ) );
+	lstTests.push_back( TestData("pointmap: determineMatching3D 100k pts, 2 threads",pointmap_test_6, 100000, 2 ) );
+	lstTests.push_back( TestData("pointmap: determineMatching3D 100k pts, 4 threads",pointmap_test_6, 100000, 4 ) );
+	lstTests.push_back( TestData("pointmap: determineMatching3D 100k pts, all cores",pointmap_test_6, 100000, 0 ) );
+
+	lstTests.push_back( TestData("pointmap: voxel grid filter 300k pts",pointmap_test_7, 300000, 0 ) );
+	lstTests.push_back( TestData("pointmap: radius outliers filter 300k pts",pointmap_test_7, 300000, 1 ) );
+	lstTests.push_back( TestData("pointmap: statistical outliers filter 300k pts",pointmap_test_7, 300000, 2 ) );
 
 	lstTests.push_back( TestData("pointmap: boundingBox (10 scans)",pointmap_test_5, 10, 50000 ) );
 	lstTests.push_back( TestData("pointmap: boundingBox (1000 scans)",pointmap_test_5, 1000, 5000 ) );
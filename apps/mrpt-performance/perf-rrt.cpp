@@ -0,0 +1,157 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/nav/planners/PlannerRRT_SE2_TPS.h>
+#include <mrpt/maps/CSimpleMap.h>
+#include <mrpt/utils/CConfigFile.h>
+#include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/random.h>
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::math;
+using namespace mrpt::maps;
+using namespace mrpt::nav;
+using namespace mrpt::random;
+using namespace std;
+
+// Same map and PTGs than the "rrtstar-demo" app:
+const string rrt_test_simplemap_file =
+#ifdef MRPT_DATASET_DIR
+	MRPT_DATASET_DIR  "/malaga-cs-fac-building.simplemap.gz";
+#else
+	""
+#endif
+;
+const string rrt_test_config_file =
+#ifdef MRPT_DATASET_DIR
+	MRPT_DATASET_DIR  "/../config_files/navigation-ptgs/ptrrt_config_example1.ini";
+#else
+	""
+#endif
+;
+
+// ------------------------------------------------------
+//				Benchmark: TMoveTree nearest node queries
+// ------------------------------------------------------
+// A tree with "nNodes" random nodes in a 100x100m world. use_kdtree=0 runs a linear scan over all nodes instead.
+double rrt_tree_nearest_node(int nNodes, int use_kdtree)
+{
+	CRandomGenerator rng(123);
+	TMoveTreeSE2_TP tree;
+	tree.insertNode(0, TNodeSE2_TP(TPose2D(0,0,0)));
+	for (int id=1;id<nNodes;id++)
+	{
+		const TPose2D p(rng.drawUniform(-50.0,50.0),rng.drawUniform(-50.0,50.0),rng.drawUniform(-M_PI,M_PI));
+		tree.insertNodeAndEdge(rng.drawUniform32bit() % id, id, TNodeSE2_TP(p), TMoveEdgeSE2_TP(0,p));
+	}
+
+	const PoseDistanceMetric<TNodeSE2> metric;
+	const size_t N = 1000;
+	vector<TNodeSE2> queries(N);
+	for (size_t i=0;i<N;i++)
+		queries[i] = TNodeSE2(TPose2D(rng.drawUniform(-50.0,50.0),rng.drawUniform(-50.0,50.0),rng.drawUniform(-M_PI,M_PI)));
+
+	CTicTac tictac;
+	size_t dummy = 0;
+	for (size_t i=0;i<N;i++)
+	{
+		if (use_kdtree)
+			dummy += tree.getNearestNode(queries[i], metric);
+		else
+		{
+			double best_d = std::numeric_limits<double>::max();
+			TNodeID best_id = INVALID_NODEID;
+			for (TMoveTreeSE2_TP::node_map_t::const_iterator it=tree.getAllNodes().begin();it!=tree.getAllNodes().end();++it)
+			{
+				const double d = metric.distance(TNodeSE2(it->second.state),queries[i]);
+				if (d<best_d) { best_d = d; best_id = it->first; }
+			}
+			dummy += best_id;
+		}
+	}
+	const double t = tictac.Tac()/N;
+	if (dummy==0) cout << ""; // Avoid the compiler to optimize out the loop
+	return t;
+}
+
+// ------------------------------------------------------
+//				Benchmark: PlannerRRT_SE2_TPS
+// ------------------------------------------------------
+// Grows a tree (with a fixed random seed) in the "rrtstar-demo" map until it has "nNodes".
+// Returns the time per new node in the tree.
+double rrt_planner_solve(int nNodes, int nThreads)
+{
+	static CSimpleMap simplemap;
+	static string ptg_cache_dir;
+	if (simplemap.empty())
+	{
+		CFileGZInputStream(rrt_test_simplemap_file) >> simplemap;
+		const string tmp_file = mrpt::system::getTempFileName();
+		mrpt::system::deleteFile(tmp_file);
+		ptg_cache_dir = mrpt::system::extractFileDirectory(tmp_file);
+	}
+
+	PlannerRRT_SE2_TPS planner;
+	planner.loadConfig( CConfigFile(rrt_test_config_file) );
+	planner.params.maxLength = 2.0;
+	planner.params.minDistanceBetweenNewNodes = 0.10;
+	planner.params.minAngBetweenNewNodes = DEG2RAD(20);
+	planner.params.goalBias = 0.05;
+	planner.params.ptg_verbose = false;
+	planner.params.ptg_cache_files_directory = ptg_cache_dir;
+	planner.params.ptg_eval_num_threads = nThreads;
+	planner.initialize();
+
+	PlannerRRT_SE2_TPS::TPlannerInput planner_input;
+	planner_input.start_pose = TPose2D(0,0,0);
+	planner_input.goal_pose  = TPose2D(-20,-30,0);
+	planner_input.obstacles_points.loadFromSimpleMap(simplemap);
+	TPoint3D bbox_min,bbox_max;
+	planner_input.obstacles_points.boundingBox(bbox_min,bbox_max);
+	planner_input.world_bbox_min = TPose2D(bbox_min.x,bbox_min.y,-M_PI);
+	planner_input.world_bbox_max = TPose2D(bbox_max.x,bbox_max.y,M_PI);
+
+	// Repeat short solve() calls (the planner is "any-time") until the tree is large enough:
+	planner.end_criteria.acceptedDistToTarget = 0; // Never stop due to reaching the goal
+	planner.end_criteria.maxComputationTime = 0.05;
+
+	randomGenerator.randomize(123);
+	PlannerRRT_SE2_TPS::TPlannerResult planner_result;
+	CTicTac tictac;
+	double t = 0;
+	while (planner_result.move_tree.getAllNodes().size()<size_t(nNodes))
+	{
+		tictac.Tic();
+		planner.solve(planner_input, planner_result);
+		t+=tictac.Tac();
+	}
+	return t/planner_result.move_tree.getAllNodes().size();
+}
+
+// ------------------------------------------------------
+// register_tests_rrt
+// ------------------------------------------------------
+void register_tests_rrt()
+{
+	lstTests.push_back( TestData("rrt: TMoveTree::getNearestNode(), 1000 nodes (linear scan)", rrt_tree_nearest_node, 1000, 0) );
+	lstTests.push_back( TestData("rrt: TMoveTree::getNearestNode(), 1000 nodes (KD-tree)", rrt_tree_nearest_node, 1000, 1) );
+	lstTests.push_back( TestData("rrt: TMoveTree::getNearestNode(), 10000 nodes (linear scan)", rrt_tree_nearest_node, 10000, 0) );
+	lstTests.push_back( TestData("rrt: TMoveTree::getNearestNode(), 10000 nodes (KD-tree)", rrt_tree_nearest_node, 10000, 1) );
+	lstTests.push_back( TestData("rrt: TMoveTree::getNearestNode(), 100000 nodes (KD-tree)", rrt_tree_nearest_node, 100000, 1) );
+
+	if (mrpt::system::fileExists(rrt_test_simplemap_file) && mrpt::system::fileExists(rrt_test_config_file))
+	{
+		lstTests.push_back( TestData("rrt: PlannerRRT_SE2_TPS malaga-cs-fac map, per new node (1 thread)", rrt_planner_solve, 2000, 1) );
+		lstTests.push_back( TestData("rrt: PlannerRRT_SE2_TPS malaga-cs-fac map, per new node (2 threads)", rrt_planner_solve, 2000, 2) );
+	}
+}
@@ -0,0 +1,71 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/utils/CMemoryStream.h>
+#include <mrpt/utils/CSerializable.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::poses;
+using namespace std;
+
+// ------------------------------------------------------
+//				Benchmark: class registry
+// ------------------------------------------------------
+double serialization_findRegisteredClass(int a1, int a2)
+{
+	const long N = 1000000;
+	const std::string names[2] = { "CPose2D", "CPose3DQuatPDFGaussian" };
+	CTicTac tictac;
+	size_t dummy = 0;
+	for (long i=0;i<N;i++)
+		dummy += findRegisteredClass(names[i & 1])!=NULL;
+	const double t = tictac.Tac()/N;
+	if (dummy==0) cout << ""; // Avoid the compiler to optimize out the loop
+	return t;
+}
+
+// ------------------------------------------------------
+//				Benchmark: write + read small objects
+// ------------------------------------------------------
+// compact=1: with CStream::setCompactClassIDs()
+double serialization_small_objects(int compact, int a2)
+{
+	const long N = 100000;
+	CMemoryStream buf;
+	buf.setCompactClassIDs(compact!=0);
+	const CPose2D p2(1.0,2.0,0.3);
+	const CPose3D p3(1.0,2.0,3.0,0.1,0.2,0.3);
+
+	CTicTac tictac;
+	for (long i=0;i<N;i++)
+	{
+		if (i & 1) buf << p3;
+		else       buf << p2;
+	}
+	buf.Seek(0);
+	CSerializablePtr obj;
+	for (long i=0;i<N;i++)
+		buf >> obj;
+	return tictac.Tac()/N;
+}
+
+// ------------------------------------------------------
+// register_tests_serialization
+// ------------------------------------------------------
+void register_tests_serialization()
+{
+	lstTests.push_back( TestData("serialization: findRegisteredClass()", serialization_findRegisteredClass) );
+	lstTests.push_back( TestData("serialization: write+read CPose2D/CPose3D objects (per object)", serialization_small_objects, 0) );
+	lstTests.push_back( TestData("serialization: write+read CPose2D/CPose3D objects, compact class IDs (per object)", serialization_small_objects, 1) );
+}
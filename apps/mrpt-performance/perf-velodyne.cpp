@@ -0,0 +1,124 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/config.h>
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/system/filesystem.h>
+#ifdef MRPT_PERF_HAS_VELODYNE_PCAP
+#	include <mrpt/hwdrivers/CVelodyneScanner.h>
+#endif
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace std;
+
+const string velodyne_hdl32_pcap_file =
+#ifdef MRPT_TESTS_DATA_DIR
+	MRPT_TESTS_DATA_DIR  "/sample_velodyne_hdl32.pcap";
+#else
+	""
+#endif
+;
+
+#ifdef MRPT_PERF_HAS_VELODYNE_PCAP
+
+// Loads (only once) all the scans in the sample HDL-32 dataset:
+std::vector<CObservationVelodyneScanPtr> & velodyne_test_scans()
+{
+	static std::vector<CObservationVelodyneScanPtr> scans;
+	if (!scans.empty())
+		return scans;
+
+	mrpt::hwdrivers::CVelodyneScanner velodyne;
+	velodyne.setModelName( mrpt::hwdrivers::CVelodyneScanner::HDL32);
+	velodyne.setPCAPInputFile(velodyne_hdl32_pcap_file);
+	velodyne.setPCAPInputFileReadOnce(true);
+	velodyne.enableVerbose(false);
+	velodyne.setPCAPVerbosity(false);
+	velodyne.initialize();
+
+	bool rx_ok = true;
+	for (size_t i=0;i<1000 && rx_ok;i++)
+	{
+		CObservationVelodyneScanPtr scan;
+		CObservationGPSPtr          gps;
+		rx_ok = velodyne.getNextObservation(scan,gps);
+		if (scan) scans.push_back(scan);
+	}
+	return scans;
+}
+
+double velodyne_test_generate_point_cloud(int , int )
+{
+	std::vector<CObservationVelodyneScanPtr> &scans = velodyne_test_scans();
+	if (scans.empty()) return 0;
+
+	const long N = 50;
+	CTicTac tictac;
+	for (long i=0;i<N;i++)
+		for (size_t s=0;s<scans.size();s++)
+			scans[s]->generatePointCloud();
+	return tictac.Tac()/(N*scans.size());
+}
+
+double velodyne_test_se3_trajectory(int num_threads, int )
+{
+	std::vector<CObservationVelodyneScanPtr> &scans = velodyne_test_scans();
+	if (scans.empty()) return 0;
+
+	// A smooth vehicle path, with one pose every 10 ms, covering all the scans:
+	CPose3DInterpolator path;
+	const mrpt::system::TTimeStamp t0 = scans.front()->timestamp - mrpt::system::secondsToTimestamp(1.0);
+	const mrpt::system::TTimeStamp t1 = scans.back()->timestamp + mrpt::system::secondsToTimestamp(1.0);
+	for (mrpt::system::TTimeStamp t=t0;t<=t1;t+=mrpt::system::secondsToTimestamp(0.01))
+	{
+		const double tt = mrpt::system::timeDifference(t0,t);
+		path.insert(t, CPose3D(5.0*tt, std::sin(tt), 0.1*tt, 0.3*tt, 0.02*std::sin(tt), 0.01*tt));
+	}
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters params;
+	params.numThreads = num_threads;
+
+	std::vector<mrpt::math::TPointXYZIu8> pts;
+	const long N = 20;
+	CTicTac tictac;
+	for (long i=0;i<N;i++)
+	{
+		for (size_t s=0;s<scans.size();s++)
+		{
+			CObservationVelodyneScan::TGeneratePointCloudSE3Results stats;
+			pts.clear();
+			scans[s]->generatePointCloudAlongSE3Trajectory(path, pts, stats, params);
+		}
+	}
+	return tictac.Tac()/(N*scans.size());
+}
+
+#endif // MRPT_PERF_HAS_VELODYNE_PCAP
+
+// ------------------------------------------------------
+// register_tests_velodyne
+// ------------------------------------------------------
+void register_tests_velodyne()
+{
+#ifdef MRPT_PERF_HAS_VELODYNE_PCAP
+	if (mrpt::system::fileExists(velodyne_hdl32_pcap_file)) {
+		lstTests.push_back( TestData("velodyne: HDL-32 generatePointCloud()",velodyne_test_generate_point_cloud) );
+		lstTests.push_back( TestData("velodyne: HDL-32 generatePointCloudAlongSE3Trajectory(), 1 thread",velodyne_test_se3_trajectory, 1) );
+		lstTests.push_back( TestData("velodyne: HDL-32 generatePointCloudAlongSE3Trajectory(), 2 threads",velodyne_test_se3_trajectory, 2) );
+		lstTests.push_back( TestData("velodyne: HDL-32 generatePointCloudAlongSE3Trajectory(), 4 threads",velodyne_test_se3_trajectory, 4) );
+		lstTests.push_back( TestData("velodyne: HDL-32 generatePointCloudAlongSE3Trajectory(), all cores",velodyne_test_se3_trajectory, 0) );
+	}
+#endif
+}
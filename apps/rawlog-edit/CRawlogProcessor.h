@@ -14,6 +14,14 @@
 #include <mrpt/utils/CFileGZInputStream.h>
 #include <mrpt/utils/CTicTac.h>
 #include <mrpt/system/os.h>
+#include <mrpt/system/threads.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <exception>
 
 // Aparently, TCLAP headers can't be included in more than one source file
 //  or duplicated linking symbols appear! -> Use forward declarations instead:
@@ -21,6 +29,8 @@
 namespace TCLAP {
 	class CmdLine;
 }
+template <typename T>
+bool getArgValue(TCLAP::CmdLine &cmdline, const std::string &arg_name, T &out_val);
 
 namespace mrpt
 {
@@ -28,6 +38,11 @@ namespace mrpt
 	{
 		/** A virtual class that implements the common stuff around parsing a rawlog file
 		  * and (optionally) display a progress indicator to the console.
+		  *
+		  * If the derived class supports it (see supportsParallelProcessing()) and "--num-threads" is greater than 1,
+		  * entries are processed by a pipeline: one thread reads the input rawlog, a pool of worker threads run processOneEntry()
+		  * on different entries simultaneously, and the calling thread invokes OnPostProcess() (e.g. to write the output rawlog)
+		  * for each entry in the original order.
 		  */
 		class CRawlogProcessor
 		{
@@ -37,6 +52,7 @@ namespace mrpt
 			bool					verbose;
 			mrpt::system::TTimeStamp m_last_console_update;
 			mrpt::utils::CTicTac	m_timParse;
+			unsigned int            m_num_threads; //!< Worker threads for processing entries ("--num-threads")
 
 		public:
 			uint64_t		m_filSize;
@@ -45,54 +61,109 @@ namespace mrpt
 
 			// Ctor
 			CRawlogProcessor(mrpt::utils::CFileGZInputStream &_in_rawlog, TCLAP::CmdLine &_cmdline, bool _verbose) :
-				m_in_rawlog(_in_rawlog),m_cmdline(_cmdline), verbose(_verbose), m_last_console_update( mrpt::system::now() ), m_rawlogEntry(0)
+				m_in_rawlog(_in_rawlog),m_cmdline(_cmdline), verbose(_verbose), m_last_console_update( mrpt::system::now() ), m_num_threads(1), m_rawlogEntry(0)
 			{
 				m_filSize = _in_rawlog.getTotalBytesCount();
+
+				int num_threads = 1;
+				getArgValue<int>(_cmdline,"num-threads",num_threads);
+				m_num_threads = num_threads>0 ? static_cast<unsigned int>(num_threads) : mrpt::system::getNumberOfProcessors();
 			}
 
+			virtual ~CRawlogProcessor() { }
 
 			// The main method:
 			void doProcessRawlog()
+			{
+				m_timParse.Tic();
+
+				if (m_num_threads>1 && supportsParallelProcessing())
+					doProcessRawlogPipelined();
+				else
+					doProcessRawlogSequential();
+
+				if(verbose) std::cout << "\n"; // new line after the "\r".
+
+				m_timToParse = m_timParse.Tac();
+
+			} // end doProcessRawlog
+
+
+			/** Derived classes must return true only if processOneEntry() can be safely invoked from several threads at once,
+			  * for different entries. In that case, processOneEntry() must not use m_rawlogEntry, which is only valid in OnPostProcess().
+			  * Note that workers run ahead of OnPostProcess(): when processing stops (processOneEntry() returned false, the user pressed ESC
+			  * or an exception was thrown), up to 4*num_threads entries after the last post-processed one may have already been passed
+			  * to processOneEntry(). They are never passed to OnPostProcess() (i.e. not saved to the output rawlog), but any side effect of
+			  * processOneEntry() on them (e.g. externalized image files) remains. No more entries are handed to workers once
+			  * processOneEntry() returns false for one of them.
+			  * Default: false. */
+			virtual bool supportsParallelProcessing() const { return false; }
+
+			// The virtual method of the user to be invoked for each read object:
+			//  Return false to abort and stop the read loop.
+			virtual bool processOneEntry(
+				mrpt::obs::CActionCollectionPtr &actions,
+				mrpt::obs::CSensoryFramePtr     &SF,
+				mrpt::obs::CObservationPtr      &obs) = 0;
+
+			// This method can be reimplemented to save the modified object to an output stream.
+			virtual void OnPostProcess(
+				mrpt::obs::CActionCollectionPtr &actions,
+				mrpt::obs::CSensoryFramePtr     &SF,
+				mrpt::obs::CObservationPtr      &obs)
+			{
+				MRPT_UNUSED_PARAM(actions); MRPT_UNUSED_PARAM(SF); MRPT_UNUSED_PARAM(obs);
+				// Default: Do nothing
+			}
+
+		private:
+			/** Shows the progress in the console, if verbose. Returns false if the user pressed ESC to abort.
+			  * \param fil_pos The current position in the input rawlog file. */
+			bool updateConsoleAndCheckAbort(const uint64_t fil_pos)
+			{
+				// Abort if the user presses ESC:
+				if (mrpt::system::os::kbhit())
+					if (27 == mrpt::system::os::getch())
+					{
+						std::cerr << "Aborted since user pressed ESC.\n";
+						return false;
+					}
+
+				// Update status to the console?
+				const mrpt::system::TTimeStamp tNow = mrpt::system::now();
+				if ( mrpt::system::timeDifference(m_last_console_update,tNow)>0.25)
+				{
+					m_last_console_update = tNow;
+					if(verbose)
+					{
+						std::cout << mrpt::format("Progress: %7u objects --- Pos: %9sB/%c%9sB \r",
+						(unsigned int)m_rawlogEntry,
+						mrpt::system::unitsFormat(fil_pos).c_str(),
+						(fil_pos>m_filSize ? '>':' '),
+						mrpt::system::unitsFormat(m_filSize).c_str()
+						);  // \r -> don't go to the next line...
+
+						std::cout.flush();
+					}
+				}
+				return true;
+			}
+
+			void doProcessRawlogSequential()
 			{
 				// The 3 different objects we can read from a rawlog:
 				mrpt::obs::CActionCollectionPtr actions;
 				mrpt::obs::CSensoryFramePtr     SF;
 				mrpt::obs::CObservationPtr      obs;
 
-				m_timParse.Tic();
-
 				// Parse the entire rawlog:
 				while (mrpt::obs::CRawlog::getActionObservationPairOrObservation(
 					m_in_rawlog,
 					actions,SF, obs,
 					m_rawlogEntry ) )
 				{
-					// Abort if the user presses ESC:
-					if (mrpt::system::os::kbhit())
-						if (27 == mrpt::system::os::getch())
-						{
-							std::cerr << "Aborted since user pressed ESC.\n";
-							break;
-						}
-
-					// Update status to the console?
-					const mrpt::system::TTimeStamp tNow = mrpt::system::now();
-					if ( mrpt::system::timeDifference(m_last_console_update,tNow)>0.25)
-					{
-						m_last_console_update = tNow;
-						uint64_t fil_pos = m_in_rawlog.getPosition();
-						if(verbose)
-						{
-							std::cout << mrpt::format("Progress: %7u objects --- Pos: %9sB/%c%9sB \r",
-							(unsigned int)m_rawlogEntry,
-							mrpt::system::unitsFormat(fil_pos).c_str(),
-							(fil_pos>m_filSize ? '>':' '),
-							mrpt::system::unitsFormat(m_filSize).c_str()
-							);  // \r -> don't go to the next line...
-
-							std::cout.flush();
-						}
-					}
+					if (!updateConsoleAndCheckAbort(m_in_rawlog.getPosition()))
+						break;
 
 					// Do whatever:
 					bool process_ret = processOneEntry(actions,SF,obs);
@@ -112,29 +183,145 @@ namespace mrpt
 					    break;
 					}
 				}; // end while
+			}
 
-				if(verbose) std::cout << "\n"; // new line after the "\r".
+			/** Reader thread -> worker threads -> ordered post-processing in the calling thread. */
+			void doProcessRawlogPipelined()
+			{
+				struct TEntry
+				{
+					mrpt::obs::CActionCollectionPtr actions;
+					mrpt::obs::CSensoryFramePtr     SF;
+					mrpt::obs::CObservationPtr      obs;
+					size_t   rawlogEntry;
+					uint64_t filePos;  // Position in the input file after reading this entry
+					bool     processed, process_ret;
+					TEntry() : rawlogEntry(0), filePos(0), processed(false), process_ret(true) {}
+				};
+				typedef std::shared_ptr<TEntry> TEntryPtr;
+
+				std::mutex               mtx;
+				std::condition_variable  cv;
+				std::deque<TEntryPtr>    in_flight;          // Entries read but not post-processed yet, in rawlog order.
+				size_t                   next_to_process = 0; // Index in "in_flight" of the next entry for the workers.
+				bool                     eof = false, abort = false;
+				bool                     stop = false;        // Set when processOneEntry() returned false: no more entries are dispatched.
+				std::exception_ptr       error;
+				const size_t             max_in_flight = 4*m_num_threads; // Bounds memory usage
+
+				// Reader:
+				std::thread reader([&]() {
+					size_t rawlogEntry = m_rawlogEntry;
+					try
+					{
+						for (;;)
+						{
+							{
+								std::unique_lock<std::mutex> lk(mtx);
+								cv.wait(lk, [&]{ return abort || stop || in_flight.size()<max_in_flight; });
+								if (abort || stop) break;
+							}
+							TEntryPtr e = std::make_shared<TEntry>();
+							const bool ok = mrpt::obs::CRawlog::getActionObservationPairOrObservation(m_in_rawlog, e->actions, e->SF, e->obs, rawlogEntry);
+							e->rawlogEntry = rawlogEntry;
+							e->filePos = m_in_rawlog.getPosition();
+
+							std::unique_lock<std::mutex> lk(mtx);
+							if (!ok) break;
+							in_flight.push_back(e);
+							cv.notify_all();
+						}
+					}
+					catch (...)
+					{
+						std::unique_lock<std::mutex> lk(mtx);
+						if (!error) error = std::current_exception();
+					}
+					std::unique_lock<std::mutex> lk(mtx);
+					eof = true;
+					cv.notify_all();
+				});
+
+				// Workers:
+				std::vector<std::thread> workers;
+				for (unsigned int i=0;i<m_num_threads;i++)
+				{
+					workers.push_back(std::thread([&]() {
+						for (;;)
+						{
+							TEntryPtr e;
+							{
+								std::unique_lock<std::mutex> lk(mtx);
+								cv.wait(lk, [&]{ return abort || stop || eof || next_to_process<in_flight.size(); });
+								if (abort || stop || next_to_process>=in_flight.size()) break;
+								e = in_flight[next_to_process++];
+							}
+							bool ret = false;
+							try {
+								ret = processOneEntry(e->actions,e->SF,e->obs);
+							}
+							catch (...)
+							{
+								std::unique_lock<std::mutex> lk(mtx);
+								if (!error) error = std::current_exception();
+								abort = true;
+							}
+							std::unique_lock<std::mutex> lk(mtx);
+							e->process_ret = ret;
+							e->processed = true;
+							if (!ret) stop = true;
+							cv.notify_all();
+						}
+					}));
+				}
 
-				m_timToParse = m_timParse.Tac();
+				// Post-process entries in order, from this thread:
+				try
+				{
+					for (;;)
+					{
+						TEntryPtr e;
+						{
+							std::unique_lock<std::mutex> lk(mtx);
+							cv.wait(lk, [&]{ return error || (eof && in_flight.empty()) || (!in_flight.empty() && in_flight.front()->processed); });
+							if (error || in_flight.empty()) break;
+							e = in_flight.front();
+							in_flight.pop_front();
+							next_to_process--;
+							cv.notify_all();
+						}
+						m_rawlogEntry = e->rawlogEntry;
 
-			} // end doProcessRawlog
+						if (!updateConsoleAndCheckAbort(e->filePos))
+							break;
 
+						OnPostProcess(e->actions,e->SF,e->obs);
 
-			// The virtual method of the user to be invoked for each read object:
-			//  Return false to abort and stop the read loop.
-			virtual bool processOneEntry(
-				mrpt::obs::CActionCollectionPtr &actions,
-				mrpt::obs::CSensoryFramePtr     &SF,
-				mrpt::obs::CObservationPtr      &obs) = 0;
+						if (!e->process_ret)
+						{
+							// Returning false means we should stop parsing the rest of the rawlog:
+							std::cerr << "\nParsing stopped due to request from Rawlog filter implementation.\n";
+							break;
+						}
+					}
+				}
+				catch (...)
+				{
+					std::unique_lock<std::mutex> lk(mtx);
+					if (!error) error = std::current_exception();
+				}
 
-			// This method can be reimplemented to save the modified object to an output stream.
-			virtual void OnPostProcess(
-				mrpt::obs::CActionCollectionPtr &actions,
-				mrpt::obs::CSensoryFramePtr     &SF,
-				mrpt::obs::CObservationPtr      &obs)
-			{
-				MRPT_UNUSED_PARAM(actions); MRPT_UNUSED_PARAM(SF); MRPT_UNUSED_PARAM(obs);
-				// Default: Do nothing
+				{
+					std::unique_lock<std::mutex> lk(mtx);
+					abort = true;
+					cv.notify_all();
+				}
+				reader.join();
+				for (size_t i=0;i<workers.size();i++)
+					workers[i].join();
+
+				if (error)
+					std::rethrow_exception(error);
 			}
 
 		}; // end CRawlogProcessor
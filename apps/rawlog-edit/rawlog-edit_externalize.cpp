@@ -35,8 +35,8 @@ DECLARE_OP_FUNCTION(op_externalize)
 		string outDir;
 
 	public:
-		size_t  entries_converted;
-		size_t  entries_skipped; // Already external
+		std::atomic<size_t>  entries_converted;
+		std::atomic<size_t>  entries_skipped; // Already external
 
 		CRawlogProcessor_Externalize(CFileGZInputStream &in_rawlog, TCLAP::CmdLine &cmdline, bool verbose) :
 			CRawlogProcessorOnEachObservation(in_rawlog,cmdline,verbose)
@@ -149,6 +149,8 @@ DECLARE_OP_FUNCTION(op_externalize)
 			return true;
 		}
 
+		bool supportsParallelProcessing() const MRPT_OVERRIDE { return true; }
+
 		// This method can be reimplemented to save the modified object to an output stream.
 		virtual void OnPostProcess(
 			mrpt::obs::CActionCollectionPtr &actions,
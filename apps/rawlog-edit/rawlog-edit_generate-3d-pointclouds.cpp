@@ -30,7 +30,7 @@ DECLARE_OP_FUNCTION(op_generate_3d_pointclouds)
 		TOutputRawlogCreator	outrawlog;
 
 	public:
-		size_t  entries_modified;
+		std::atomic<size_t>  entries_modified;
 
 		CRawlogProcessor_Generate3DPointClouds(CFileGZInputStream &in_rawlog, TCLAP::CmdLine &cmdline, bool verbose) :
 			CRawlogProcessorOnEachObservation(in_rawlog,cmdline,verbose)
@@ -46,7 +46,7 @@ DECLARE_OP_FUNCTION(op_generate_3d_pointclouds)
 				if (obs3D->hasRangeImage)
 				{
 					obs3D->load();  // We must be sure that depth has been loaded, if stored separately.
-					obs3D->project3DPointsFromDepthImage();
+					obs3D->project3DPointsFromDepthImage(m_num_threads<=1 /* The shared LUT is not safe with concurrent calls */);
 					entries_modified++;
 				}
 			}
@@ -54,6 +54,8 @@ DECLARE_OP_FUNCTION(op_generate_3d_pointclouds)
 			return true;
 		}
 
+		bool supportsParallelProcessing() const MRPT_OVERRIDE { return true; }
+
 		// This method can be reimplemented to save the modified object to an output stream.
 		virtual void OnPostProcess(
 			mrpt::obs::CActionCollectionPtr &actions,
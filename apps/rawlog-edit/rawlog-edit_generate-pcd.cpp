@@ -47,7 +47,35 @@ DECLARE_OP_FUNCTION(op_generate_pcd)
 				throw std::runtime_error(string("ERROR: Output directory does not exist: ")+m_outdir);
 		}
 
+		// Projection of depth images (the costly part) is done here, possibly in parallel for several rawlog entries:
 		bool processOneObservation(CObservationPtr  &obs)
+		{
+			if (IS_CLASS(obs, CObservation3DRangeScan ) )
+			{
+				CObservation3DRangeScanPtr obs3D = CObservation3DRangeScanPtr(obs);
+				if (obs3D->hasRangeImage && !obs3D->hasPoints3D)
+					obs3D->project3DPointsFromDepthImage(m_num_threads<=1 /* The shared LUT is not safe with concurrent calls */);
+			}
+			return true;
+		}
+
+		bool supportsParallelProcessing() const MRPT_OVERRIDE { return true; }
+
+		// Files are saved here, where m_rawlogEntry is valid:
+		virtual void OnPostProcess(
+			mrpt::obs::CActionCollectionPtr &actions,
+			mrpt::obs::CSensoryFramePtr     &SF,
+			mrpt::obs::CObservationPtr      &obs)
+		{
+			MRPT_UNUSED_PARAM(actions);
+			if (obs)
+				saveOneObservation(obs);
+			else if (SF)
+				for (size_t i=0;i<SF->size();i++)
+					saveOneObservation(SF->getObservationByIndex(i));
+		}
+
+		void saveOneObservation(const CObservationPtr &obs)
 		{
 			const string label_time = format("%s/%06u_%s_%f.pcd",
 				m_outdir.c_str(),
@@ -57,9 +85,6 @@ DECLARE_OP_FUNCTION(op_generate_pcd)
 			if (IS_CLASS(obs, CObservation3DRangeScan ) )
 			{
 				CObservation3DRangeScanPtr obs3D = CObservation3DRangeScanPtr(obs);
-				if (obs3D->hasRangeImage && !obs3D->hasPoints3D)
-					obs3D->project3DPointsFromDepthImage();
-
 				if (obs3D->hasPoints3D)
 				{
 					CColouredPointsMap  map;
@@ -84,8 +109,6 @@ DECLARE_OP_FUNCTION(op_generate_pcd)
 					throw std::runtime_error(string("ERROR: While saving file: ")+label_time);
 				entries_done++;
 			}
-
-			return true;
 		}
 	};
 
@@ -95,6 +95,8 @@ TCLAP::SwitchArg arg_overwrite("w","overwrite","Force overwrite target file with
 
 TCLAP::SwitchArg arg_quiet("q","quiet","Terse output",cmd, false);
 
+TCLAP::ValueArg<int> arg_num_threads("","num-threads","Number of threads for processing rawlog entries in parallel, for the operations which support it (--generate-3d-pointclouds, --generate-pcd, --stereo-rectify, --externalize). Use 0 for one thread per core. With a value other than 1, output rawlogs are also written in the block-compressed gz format, compressed in parallel. Default: 1 (sequential processing).",false,1,"N",cmd);
+
 
 
 // ======================================================================
@@ -392,7 +394,18 @@ TOutputRawlogCreator::TOutputRawlogCreator()
 	if (fileExists(out_rawlog_filename) && !arg_overwrite.getValue() )
 		throw runtime_error(string("*ABORTING*: Output file already exists: ") + out_rawlog_filename + string("\n. Select a different output path, remove the file or force overwrite with '-w' or '--overwrite'.") );
 
-	if (!out_rawlog.open(out_rawlog_filename))
+	bool open_ok;
+#if MRPT_HAS_GZ_STREAMS
+	// Only with "--num-threads" other than 1: the output is block-compressed in parallel (see CFileGZOutputStream::openBlockCompressed())
+	if (arg_num_threads.getValue()!=1)
+	{
+		const unsigned int num_threads = arg_num_threads.getValue()>0 ? static_cast<unsigned int>(arg_num_threads.getValue()) : mrpt::system::getNumberOfProcessors();
+		open_ok = out_rawlog.openBlockCompressed(out_rawlog_filename, 1, 1<<20, num_threads);
+	}
+	else
+#endif
+		open_ok = out_rawlog.open(out_rawlog_filename);
+	if (!open_ok)
 		throw runtime_error(string("*ABORTING*: Cannot open output file: ") + out_rawlog_filename );
 }
 
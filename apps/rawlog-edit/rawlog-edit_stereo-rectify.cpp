@@ -9,6 +9,7 @@
 
 #include "rawlog-edit-declarations.h"
 #include <mrpt/vision/CStereoRectifyMap.h>
+#include <set>
 
 using namespace mrpt;
 using namespace mrpt::utils;
@@ -34,14 +35,16 @@ DECLARE_OP_FUNCTION(op_stereo_rectify)
 		string   imgFileExtension;
 		double   rectify_alpha; // [0,1] see cvStereoRectify()
 
-		bool     m_this_obs_is_ok;
-
 		mrpt::vision::CStereoRectifyMap   rectify_map;
+		std::mutex                        rectify_map_mtx; //!< Protects the lazy initialization of rectify_map
+
+		std::mutex                            m_dropped_obs_mtx;
+		std::set<const mrpt::obs::CObservation*> m_dropped_obs; //!< Observations to be removed from the output, due to missing external images
 
-		size_t  m_num_external_files_failures;
+		std::atomic<size_t>  m_num_external_files_failures;
 
 	public:
-		size_t  m_changedCams;
+		std::atomic<size_t>  m_changedCams;
 
 		CRawlogProcessor_StereoRectify(CFileGZInputStream &in_rawlog, TCLAP::CmdLine &cmdline, bool verbose) :
 			CRawlogProcessorOnEachObservation(in_rawlog,cmdline,verbose)
@@ -107,10 +110,10 @@ DECLARE_OP_FUNCTION(op_stereo_rectify)
 			}
 		}
 
+		bool supportsParallelProcessing() const MRPT_OVERRIDE { return true; }
+
 		bool processOneObservation(CObservationPtr  &obs)
 		{
-		    m_this_obs_is_ok = true;
-
 			if ( strCmpI(obs->sensorLabel,target_label))
 			{
 				if (IS_CLASS(obs,CObservationStereoImages))
@@ -120,11 +123,14 @@ DECLARE_OP_FUNCTION(op_stereo_rectify)
 					try
 					{
                         // Already initialized the rectification map?
-                        if (!rectify_map.isSet())
                         {
-                            // On the first ocassion, initialize map:
-                            rectify_map.setAlpha( rectify_alpha );
-                            rectify_map.setFromCamParams( *o );
+                            std::lock_guard<std::mutex> lock(rectify_map_mtx);
+                            if (!rectify_map.isSet())
+                            {
+                                // On the first ocassion, initialize map:
+                                rectify_map.setAlpha( rectify_alpha );
+                                rectify_map.setFromCamParams( *o );
+                            }
                         }
 
 			// This is needed to raise an exception of the correct type that reveal any missing external file:
@@ -132,8 +138,8 @@ DECLARE_OP_FUNCTION(op_stereo_rectify)
 			o->imageRight.getWidth();
 
                         // This call rectifies the images in-place and also updates
-                        // all the camera parameters as needed:
-                        rectify_map.rectify(*o);
+                        // all the camera parameters as needed (the internal buffer can't be shared between threads):
+                        rectify_map.rectify(*o, m_num_threads<=1);
 
                         const string label_time = format("%s_%f", o->sensorLabel.c_str(), timestampTotime_t(o->timestamp) );
                         {
@@ -151,12 +157,13 @@ DECLARE_OP_FUNCTION(op_stereo_rectify)
 					catch (mrpt::utils::CExceptionExternalImageNotFound &)
 					{
 					    const size_t MAX_FAILURES = 1000;
-					    m_num_external_files_failures++;
-
-					    if (m_num_external_files_failures<MAX_FAILURES)
+					    if (++m_num_external_files_failures<MAX_FAILURES)
 					    {
-					        m_this_obs_is_ok = false;
-                            cerr << "\n *WARNING*: Dropping one observation due to missing external image file at rawlog entry " << m_rawlogEntry << endl;
+					        {
+					            std::lock_guard<std::mutex> lock(m_dropped_obs_mtx);
+					            m_dropped_obs.insert(obs.pointer());
+					        }
+                            cerr << "\n *WARNING*: Dropping one observation due to missing external image file: " << o->sensorLabel << " at " << mrpt::system::dateTimeLocalToString(o->timestamp) << endl;
 					    }
 					    else
 					    {
@@ -174,7 +181,24 @@ DECLARE_OP_FUNCTION(op_stereo_rectify)
 			mrpt::obs::CSensoryFramePtr     &SF,
 			mrpt::obs::CObservationPtr      &obs)
 		{
-		    if (!m_this_obs_is_ok) return;
+			{
+				std::lock_guard<std::mutex> lock(m_dropped_obs_mtx);
+				if (!m_dropped_obs.empty())
+				{
+					if (obs && m_dropped_obs.erase(obs.pointer()))
+						return;
+					if (SF)
+					{
+						for (size_t i=0;i<SF->size();)
+						{
+							if (m_dropped_obs.erase(SF->getObservationByIndex(i).pointer()))
+								SF->eraseByIndex(i);
+							else i++;
+						}
+						if (!SF->size()) return;
+					}
+				}
+			}
 
 			ASSERT_((actions && SF) || obs)
 			if (actions)
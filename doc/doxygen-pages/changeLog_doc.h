@@ -22,7 +22,9 @@
 			- Now displays a textual and graphical representation of all observation timestamps, useful to quickly detect sensor "shortages" or temporary failures.
 			- New menu operation: "Edit" -> "Rename selected observation"
 			- mrpt::obs::CObservation3DRangeScan pointclouds are now shown in local coordinates wrt to the vehicle/robot, not to the sensor.
-		- [rawlog-edit](http://www.mrpt.org/list-of-mrpt-apps/application-rawlog-edit/): New flag: `--txt-externals`
+		- [rawlog-edit](http://www.mrpt.org/list-of-mrpt-apps/application-rawlog-edit/):
+			- New flag: `--txt-externals`
+			- New flag `--num-threads`: operations `--generate-3d-pointclouds`, `--generate-pcd`, `--stereo-rectify` and `--externalize` now process rawlog entries in parallel (one reader thread, a pool of workers and an ordered writer). With `--num-threads` other than 1, output rawlogs are also block-compressed in parallel.
 	- Changes in libraries:
 		- \ref mrpt_base_grp
 			- New API to interface ZeroMQ: \ref noncstream_serialization_zmq
@@ -64,11 +66,27 @@
 			- mrpt::utils::CConfigFile and mrpt::utils::CConfigFileMemory now can parse config files with end-of-line backslash to split long strings into several lines.
 			- New class mrpt::poses::FrameTransformer
 			- mrpt::poses classes now have all their constructors from mrpt::math types marked as explicit, to avoid potential ambiguities and unnoticed conversions.
+			- New function mrpt::system::parallelForBlocks() for deterministic, statically-partitioned multithreaded loops.
+			- New class mrpt::system::CWorkerThreadsPool: persistent threads for running parallelForBlocks()-like loops many times per second.
+			- Const KD-tree queries in mrpt::math::KDTreeCapable are now reentrant (no shared query buffer), so they can be called from several threads once the tree is built.
+			- mrpt::math::KDTreeCapable now indexes points appended at the end of the data set incrementally, with a logarithmic forest of KD-trees, instead of rebuilding the whole index after each insertion.
+			- New class mrpt::utils::CMemoryMappedFile
+			- New block-compressed gz file format (see mrpt::compress::zip::TGZBlockIndex), still readable by any gzip tool: mrpt::utils::CFileGZOutputStream::openBlockCompressed() writes it, and mrpt::utils::CFileGZInputStream reads it with parallel decompression (mrpt::utils::CFileGZInputStream::setNumThreads()) and cheap mrpt::utils::CFileGZInputStream::Seek().
+			- mrpt::utils::CFileGZOutputStream::close() now throws on errors writing the last data to disk, instead of ignoring them. The destructor still ignores them.
+			- mrpt::math::CSparseMatrix::CholeskyDecomp now caches the AMD ordering and symbolic analysis: mrpt::math::CSparseMatrix::CholeskyDecomp::update() only redoes the numeric factorization (in-place, optionally multithreaded along the elimination tree) if the sparse structure did not change, and rebuilds the decomposition otherwise. Duplicated entries in the input matrix are now added up.
+			- mrpt::utils::findRegisteredClass() is now lock-free (it reads an immutable snapshot of the class registry, rebuilt after new classes are registered), and mrpt::utils::CStream::ReadObject() no longer builds a `std::string` per object.
+			- New compact object headers in mrpt::utils::CStream: see mrpt::utils::CStream::setCompactClassIDs(). Each class name is written only once per stream, then objects refer to it by a 1 or 2 byte ID. Such streams are always accepted by mrpt::utils::CStream::ReadObject().
 		- \ref mrpt_bayes_grp
 			- [API change] `verbose` is no longer a field of mrpt::bayes::CParticleFilter::TParticleFilterOptions. Use the setVerbosityLevel() method of the CParticleFilter class itself.
 			- [API change] mrpt::bayes::CProbabilityParticle (which affects all PF-based classes in MRPT) has been greatly simplified via usage of the new mrpt::utils::copy_ptr<> pointee-copy-semantics smart pointer.
+			- New option mrpt::bayes::CParticleFilter::TParticleFilterOptions::numThreadsObsLikelihood to evaluate particle weights in parallel in `pfStandardProposal` (used by mrpt::slam::CMonteCarloLocalization2D, mrpt::slam::CMonteCarloLocalization3D, etc.). Maps shared among particles first build their lazily-computed data through the new virtual method mrpt::maps::CMetricMap::prepareConcurrentObservationLikelihood()
+			- New Kalman filter method mrpt::bayes::kfSEIF: a Sparse Extended Information Filter for SLAM problems in mrpt::bayes::CKalmanFilterCapable (hence, in mrpt::slam::CRangeBearingKFSLAM and mrpt::slam::CRangeBearingKFSLAM2D), with a block-sparse information matrix, sparsification to mrpt::bayes::TKF_options::SEIF_max_active_landmarks links to the vehicle (by marginalizing the deactivated landmarks out of the vehicle conditional) and exact mean recovery with mrpt::math::CSparseMatrix. New method mrpt::bayes::CKalmanFilterCapable::getFullCovariance().
 		- \ref mrpt_graphs_grp
 			- New class mrpt::graphs::ScalarFactorGraph, a simple but extensible linear GMRF solver. Refactored from mrpt::maps::CGasConcentrationGridMap2D, etc.
+		- \ref mrpt_graphslam_grp
+			- mrpt::graphslam::optimize_graph_spa_levmarq() reuses the symbolic Cholesky factorization of the Hessian between iterations, and accepts the new parameter `num_threads` for the numeric factorization.
+			- mrpt::graphslam::optimize_graph_spa_levmarq(): the parameter `num_threads` also parallelizes the evaluation of errors and Jacobians of the edges and the accumulation of the gradient and Hessian, with results identical to the single-threaded ones.
+			- New incremental graph optimizer mrpt::graphslam::optimizers::CIncrementalGSO (iSAM2-like): keeps the sparse factorization between updates, relinearizing and refactoring only what changed. Available in graphslam-engine as `CIncrementalGSO`.
 		- \ref mrpt_gui_grp
 			- mrpt::gui::CMyGLCanvasBase is now derived from mrpt::opengl::CTextMessageCapable so they can draw text labels
 			- New class mrpt::gui::CDisplayWindow3DLocker for exception-safe 3D scene lock in 3D windows.
@@ -85,6 +103,10 @@
 			- mrpt::maps::CPointsMap `liblas` import/export methods are now in a separate header. See \ref mrpt_maps_liblas_grp and \ref dep-liblas
 			- New class mrpt::maps::CRandomFieldGridMap3D
 			- New class mrpt::maps::CPointCloudFilterByDistance
+			- New point cloud filters mrpt::maps::CPointCloudFilterVoxelGrid, mrpt::maps::CPointCloudFilterRadiusOutliers and mrpt::maps::CPointCloudFilterStatisticalOutliers, and mrpt::maps::CPointCloudFilterPipeline to chain several filters in place. mrpt::maps::CPointsMap::applyDeletionMask() avoids copying points which do not move.
+			- New methods mrpt::maps::COccupancyGridMap2D::computeObservationLikelihoods() and mrpt::maps::COccupancyGridMap2D::computeLikelihoodField_Thrun_batch() to evaluate one observation at many candidate poses at once. mrpt::slam::CMonteCarloLocalization2D uses them to weight all the particles at once when they share one map with occupancy grids.
+			- mrpt::maps::CPointsMap::insertPoint(), mrpt::maps::CPointsMap::insertAnotherMap(), mrpt::maps::CPointsMap::fuseWith() (if no point is fused) and insertion of observations into point maps no longer force a full rebuild of the KD-tree (see mrpt::maps::CPointsMap::mark_as_points_appended()). mrpt::maps::CPointsMap::fuseWith() is no longer quadratic in the number of points.
+			- mrpt::maps::CPointsMap::determineMatching2D() and mrpt::maps::CPointsMap::determineMatching3D() can now run the KD-tree queries in parallel (new field mrpt::maps::TMatchingParams::numThreads), with results independent of the number of threads, and reuse the memory of the output correspondence list between calls.
 		- \ref mrpt_obs_grp
 			- [ABI change] mrpt::obs::CObservation2DRangeScan
 				- range scan vectors are now protected for safety.
@@ -97,12 +119,24 @@
 			- mrpt::obs::CObservation2DRangeScan now has an optional field for intensity.
 			- mrpt::obs::CRawLog can now holds objects of arbitrary type, not only actions/observations. This may be useful for richer logs aimed at debugging.
 			- mrpt::obs::CObservationVelodyneScan::generatePointCloud() can now generate the microseconds-precise timestamp for each individual point (new param `generatePerPointTimestamp`).
+			- New class mrpt::obs::CObservationVelodyneScan::TPointCloudDecoder: streaming decoder of Velodyne packets with cached per-laser calibration tables and SSE2 point generation, able to emit partial clouds packet by packet. mrpt::obs::CObservationVelodyneScan::generatePointCloud() and mrpt::obs::CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory() now use it (~1.5x faster), and the latter interpolates the vehicle pose only once per packet.
+			- mrpt::obs::CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory() can run multi-threaded (new param `numThreads` in mrpt::obs::CObservationVelodyneScan::TGeneratePointCloudParameters): poses are interpolated once per distinct packet timestamp and packets are transformed in parallel, with results identical to the single-threaded version. New benchmark in mrpt-performance.
+			- mrpt::obs::CObservation3DRangeScan::project3DPointsFromDepthImageInto() can run multi-threaded (new param `numThreads` in mrpt::obs::T3DPointsProjectionParams): the range image is projected in blocks of rows directly into the output point cloud, and coloring and 6D transformation are done in one fused pass. Output is identical for any number of threads. Also fixed wrong Y,Z coordinates in the LUT-based, non-SSE2 projection when the range image has invalid pixels.
+			- New class mrpt::obs::CRawlogIndexedReader for random access to large rawlog files, memory-mapped and lazily decoded, with a persistent index for O(1) seek by index or timestamp.
+			- mrpt::obs::CRawlog::saveToRawLogFile() now writes block-compressed gz files, which mrpt::obs::CRawlog::loadFromRawLogFile() decompresses in parallel and mrpt::obs::CRawlogIndexedReader can access randomly.
 		- \ref mrpt_opengl_grp
 			- [ABI change] mrpt::opengl::CAxis now has many new options exposed to configure its look.
 			- mrpt::opengl::CSetOfLines can now optionally show vertices as dots.
 		- \ref mrpt_slam_grp
 			- [API change] mrpt::slam::CMetricMapBuilder::TOptions does not have a `verbose` field anymore. It's supersedded now by the verbosity level of the CMetricMapBuilder class itself.
 			- [API change] getCurrentMetricMapEstimation() renamed mrpt::slam::CMultiMetricMapPDF::getAveragedMetricMapEstimation() to avoid confusions.
+			- New option mrpt::slam::CICP::TConfigParams::numThreadsMatching for multithreaded point matching in all ICP methods.
+		- \ref mrpt_vision_grp
+			- mrpt::vision::CFeatureExtraction can run multi-threaded (new option mrpt::vision::CFeatureExtraction::TOptions::numThreads): FAST and FASTER detectors run in parallel over overlapping bands of image rows, and KLT responses and spin, polar and log-polar image descriptors are computed in parallel per feature. The detected features and descriptors are identical for any number of threads.
+			- New class mrpt::vision::CBinaryDescriptorIndex: exact k-nearest neighbour search and ratio-test matching of binary (ORB) descriptors in Hamming space, with multi-index hashing, a 64-bit `POPCNT` Hamming distance and multi-threaded batch queries. mrpt::vision::matchFeatures() uses it for ORB descriptors without epipolar or X restrictions, and mrpt::vision::CFeature::descriptorORBDistanceTo() uses its faster Hamming distance (which now saturates at 255 instead of wrapping around).
+			- mrpt::vision::CUndistortMap and mrpt::vision::CStereoRectifyMap remap 8-bit images with their own fixed-point bilinear interpolation over the precomputed 16-bit maps, in parallel by rows (new methods `setNumThreads()`). Both stereo images are rectified in a single parallel pass, output images are reused if they already have the right size, and in-place rectification (including that of mrpt::obs::CObservationStereoImages) swaps the internal buffers instead of copying the images (unless they are externally stored or read-only). New method mrpt::utils::CImage::isReadOnly().
+			- mrpt::vision::bundle_adj_full() scales to thousands of frames: the Schur complement of the landmarks is built directly into a block-sparse reduced camera system from per-frame and per-point observation lists (instead of `std::map`s and a frames x points back-substitution loop), the reduced system can be solved with the sparse Cholesky or the new block-Jacobi preconditioned conjugate gradient (`solver`, `pcg_max_iterations` and `pcg_tolerance` parameters), and residuals, Jacobians, the Schur complement and the back-substitution run in parallel (`num_threads` parameter; results do not depend on it). mrpt::vision::reprojectionResiduals() accepts a number of threads too.
+			- mrpt::vision::CFeatureTracker_KL keeps the grayscale pyramid of the last image between calls, so each frame of a sequence gets only one pyramid (built with mrpt::vision::CImagePyramid::buildPyramidFast() when converting from color), and tracks the features with a native pyramidal Lucas-Kanade with SSE2 bilinear patch sampling, in parallel chunks of features (new `num_threads` parameter). The `LK_epsilon` parameter was truncated to an integer, and is now used as given.
 		- \ref mrpt_hwdrivers_grp
 			- mrpt::hwdrivers::CGenericSensor: external image format is now `png` by default instead of `jpg` to avoid losses.
 			- [ABI change] mrpt::hwdrivers::COpenNI2Generic:
@@ -127,6 +161,10 @@
 				- PTGs are now mrpt::utils::CLoadableOptions classes
 			- New classes:
 				- mrpt::nav::CMultiObjectiveMotionOptimizerBase
+			- mrpt::nav::CAbstractPTGBasedReactive can evaluate all PTG motion candidates (including the "NOP" one) in parallel, in a persistent thread pool. See new parameter `ptg_eval_num_threads`. Evaluation times are stored in each mrpt::nav::CLogFileRecord.
+			- New method mrpt::nav::CParameterizedTrajectoryGenerator::updateTPObstacles() to convert a whole set of obstacle points into TP-Space, optionally in parallel across PTG directions. mrpt::nav::CPTG_DiffDrive_CollisionGridBased implements it by binning the points by collision grid cell, and it is now used by mrpt::nav::CReactiveNavigationSystem and mrpt::nav::CReactiveNavigationSystem3D.
+			- mrpt::nav::CPTG_DiffDrive_CollisionGridBased: faster initialization. Paths are simulated and the collision grid is built in parallel, and the collision grid cache files use a new, compact format (v3) which is read in a single block. Cache files in the former format are still loaded.
+			- mrpt::nav::TMoveTree keeps an incremental KD-tree over the (x,y) of its nodes, which speeds up getNearestNode(). New method mrpt::nav::TMoveTree::getNodesWithinDistance(). Fixed `PoseDistanceMetric<TNodeSE2>::cannotBeNearerThan()`, which compared a squared distance against a plain one. mrpt::nav::PlannerRRT_SE2_TPS can evaluate the candidate edges of all PTGs in parallel: see new parameter mrpt::nav::RRTAlgorithmParams::ptg_eval_num_threads.
 	- Changes in build system:
 		- [Windows only] `DLL`s/`LIB`s now have the signature `lib-${name}${2-digits-version}${compiler-name}_{x32|x64}.{dll/lib}`, allowing several MRPT versions to coexist in the system PATH.
 		- [Visual Studio only] There are no longer `pragma comment(lib...)` in any MRPT header, so it is the user responsibility to correctly tell user projects to link against MRPT libraries.
@@ -109,6 +109,15 @@ namespace mrpt
 				bool pfAuxFilterStandard_FirstStageWeightsMonteCarlo;
 
 				bool pfAuxFilterOptimal_MLE; //!< (Default=false) In the algorithm "CParticleFilter::pfAuxiliaryPFOptimal", if set to true, do not perform rejection sampling, but just the most-likely (ML) particle found in the preliminary weight-determination stage.
+
+				/** Number of threads used to evaluate the observation likelihood of the particles in the update stage of
+				  *  PF_algorithm=pfStandardProposal (default=1: single-threaded; 0: one thread per processor).
+				  *  Each particle weight is computed independently, so results are identical for any number of threads.
+				  *  Lazily-built caches of maps shared among particles are filled in first (see mrpt::maps::CMetricMap::prepareConcurrentObservationLikelihood),
+				  *  but the likelihood function of the map must still be reentrant, e.g. it is not for COccupancyGridMap2D::lmConsensusOWA and COccupancyGridMap2D::lmMeanInformation,
+				  *  which modify the map while evaluating likelihoods.
+				  */
+				unsigned int numThreadsObsLikelihood;
 			};
 
 			/** Statistics for being returned from the "execute" method. */
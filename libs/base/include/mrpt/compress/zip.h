@@ -109,7 +109,47 @@ namespace mrpt
 			bool BASE_IMPEXP  decompress_gz_data_block(
 				const vector_byte &in_gz_data,
 				vector_byte &out_data);
-			
+
+			/** \name Block-compressed gz files
+			  * Block-compressed files are standard multi-member gzip files (hence, readable by any gzip tool or older MRPT versions)
+			  * where each member holds an independently-compressed block of data. A few trailing empty members store an index of the
+			  * blocks in their "extra" header fields, which allows reading blocks in parallel and jumping to any uncompressed offset
+			  * by decompressing only one block. See mrpt::utils::CFileGZOutputStream::openBlockCompressed() and mrpt::utils::CFileGZInputStream.
+			  * @{ */
+
+			/** The index of blocks of a block-compressed gz file */
+			struct BASE_IMPEXP TGZBlockIndex
+			{
+				std::vector<uint64_t> compressed_offset;   //!< File offset of each block, plus a last element with the offset of the end of the last block.
+				std::vector<uint64_t> uncompressed_offset; //!< Offset of the first decompressed byte of each block, plus a last element with the total decompressed size.
+
+				TGZBlockIndex(); //!< Creates an index with no blocks
+				void clear(); //!< Removes all blocks
+				size_t size() const { return compressed_offset.size()-1; } //!< Number of blocks
+				uint64_t totalUncompressedSize() const { return uncompressed_offset.back(); }
+				void push_back(uint64_t compressed_size, uint64_t uncompressed_size); //!< Appends a new block after the last one
+				/** Returns the index of the block containing the given uncompressed offset, or size() if it is past the end of the data (O(log(size())). */
+				size_t findBlock(uint64_t uncompressed_pos) const;
+			};
+
+			/** Compresses a block of data as a gzip member, which is appended to `out_gz_data` (its previous contents are kept).
+			  * \return false on any error. */
+			bool BASE_IMPEXP compress_gz_block(const void *in_data, size_t in_data_size, vector_byte &out_gz_data, const int compress_level = 1);
+
+			/** Decompresses one gzip member, whose decompressed size must be known beforehand (e.g. from a TGZBlockIndex).
+			  * \return false on any error, including a decompressed size different than `out_data_size` or a CRC mismatch. */
+			bool BASE_IMPEXP decompress_gz_block(const void *in_gz_data, size_t in_gz_data_size, void *out_data, size_t out_data_size);
+
+			/** Writes the trailing index members of a block-compressed gz file. `out` must be a raw (not compressing) stream
+			  * placed right after the last block, i.e. at file offset `index.compressed_offset.back()`. */
+			void BASE_IMPEXP write_gz_block_index(mrpt::utils::CStream &out, const TGZBlockIndex &index);
+
+			/** Reads the block index of a block-compressed gz file from a raw (not decompressing), seekable stream, e.g. mrpt::utils::CFileInputStream.
+			  * \return false if the file is not a block-compressed gz file, or its index is corrupted. */
+			bool BASE_IMPEXP read_gz_block_index(mrpt::utils::CStream &in, TGZBlockIndex &index);
+
+			/** @} */
+
 
 		} // End of namespace
 	} // End of namespace
@@ -352,6 +352,11 @@ namespace mrpt
 			  *     ...
 			  *   \endcode
 			  *
+			  * The fill-reducing (AMD) ordering and the symbolic analysis are computed only once, in the constructor. Later calls to update()
+			  * with matrices with the same sparse structure (e.g. the successive Hessians in Levenberg-Marquardt iterations) only redo the numeric
+			  * factorization, in-place over the existing factor L and, optionally, in parallel: columns of L which are not in the same branch
+			  * of the elimination tree are independent, so each "level" of the tree is split among several threads (see setNumThreads()).
+			  *
 			  * \note Only the upper triangular part of the input matrix is accessed.
 			  * \note This class was initially adapted from "robotvision", by Hauke Strasdat, Steven Lovegrove and Andrew J. Davison. See http://www.openslam.org/robotvision.html
 			  * \note This class designed to be "uncopiable".
@@ -362,16 +367,33 @@ namespace mrpt
 			private:
 				css * m_symbolic_structure;
 				csn * m_numeric_structure;
-				const CSparseMatrix *m_originalSM;  //!< A const reference to the original matrix used to build this decomposition.
+				unsigned int m_num_threads;
+
+				// Cached data for numeric re-factorizations in update():
+				std::vector<int> m_A_colptr, m_A_rowidx; //!< Sparse structure of the factorized matrix
+				std::vector<int> m_A_to_L;       //!< For each entry in the input matrix, its index in L->x (or -1 for ignored, lower triangular entries)
+				std::vector<int> m_Lrow_ptr, m_Lrow_col, m_Lrow_idx; //!< Row-wise structure of the strictly lower part of L: column and index in L->x
+				std::vector<int> m_levels_ptr, m_levels_cols; //!< Columns of L grouped by their height in the elimination tree
+				std::vector<double> m_work;      //!< Dense workspace of size N, per thread
+				std::vector<char> m_thread_failed;
+				size_t m_cur_level_first;
+
+				void analyze(const CSparseMatrix &A); //!< Symbolic analysis + first numeric factorization
+				void refactorize(const CSparseMatrix &A); //!< Numeric factorization reusing the symbolic analysis. A must have the cached structure.
+				void release();
+				bool hasSameStructure(const CSparseMatrix &A) const;
+				bool factorColumn(const int j, double *x);
+				static void factorColumnsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
 
 			public:
 				/** Constructor from a square definite-positive sparse matrix A, which can be use to solve Ax=b
 				  *   The actual Cholesky decomposition takes places in this constructor.
+				  *  \param num_threads Number of threads for the numeric factorizations in update(), or 0 to use one per core (see setNumThreads()).
 				  *  \note Only the upper triangular part of the matrix is accessed.
 				  *  \exception std::runtime_error On non-square input matrix.
 				  *  \exception mrpt::math::CExceptionNotDefPos On non-definite-positive matrix as input.
 				  */
-				CholeskyDecomp(const CSparseMatrix &A);
+				CholeskyDecomp(const CSparseMatrix &A, unsigned int num_threads = 1);
 
 				/** Destructor */
 				virtual ~CholeskyDecomp();
@@ -393,9 +415,16 @@ namespace mrpt
 				void backsub(const double *b, double *result, const size_t N) const;
 
 				/** Update the Cholesky factorization from an updated vesion of the original input, square definite-positive sparse matrix.
-				  *  NOTE: This new matrix MUST HAVE exactly the same sparse structure than the original one.
+				  *  If the new matrix has exactly the same sparse structure than the original one, the ordering and the symbolic
+				  *  analysis are reused and only the numeric factorization is recomputed. Otherwise, the decomposition is built from scratch.
+				  *  \exception mrpt::math::CExceptionNotDefPos On non-definite-positive matrix as input.
 				  */
 				void update(const CSparseMatrix &new_SM);
+
+				/** Sets the number of threads for the numeric factorization in update(). Default=1. 0 means one per core (see mrpt::system::getNumberOfProcessors()).
+				  * Parallelism depends on the shape of the elimination tree, and small levels are always processed sequentially. */
+				void setNumThreads(unsigned int num_threads);
+				unsigned int getNumThreads() const { return m_num_threads; }
 			};
 
 
@@ -14,6 +14,8 @@
 // nanoflann library:
 #include <mrpt/otherlibs/nanoflann/nanoflann.hpp>
 #include <mrpt/math/lightweight_geom_data.h>
+#include <algorithm>
+#include <vector>
 
 namespace mrpt
 {
@@ -24,6 +26,14 @@ namespace mrpt
 		  *  @{ */
 
 
+		namespace detail
+		{
+			/** Replaces the data source type of a nanoflann metric adaptor (nanoflann::L2_Simple_Adaptor, nanoflann::L2_Adaptor, nanoflann::L1_Adaptor,...) */
+			template <class METRIC, class NEW_DATASOURCE> struct kdtree_metric_rebind;
+			template <template <class,class,class> class METRIC, class T, class DATASOURCE, class DIST, class NEW_DATASOURCE>
+			struct kdtree_metric_rebind<METRIC<T,DATASOURCE,DIST>,NEW_DATASOURCE> { typedef METRIC<T,NEW_DATASOURCE,DIST> type; };
+		}
+
 		/** A generic adaptor class for providing Nearest Neighbor (NN) lookup via the `nanoflann` library.
 		 *   This makes use of the CRTP design pattern.
 		 *
@@ -54,12 +64,18 @@ namespace mrpt
 		 *  \endcode
 		 *
 		 * The KD-tree index will be built on demand only upon call of any of the query methods provided by this class.
+		 * Points appended at the end of the data set without calling "kdtree_mark_as_outdated()" are indexed incrementally
+		 * in a new, small KD-tree (merged with the previous ones as they grow), instead of rebuilding the whole index.
 		 *
 		 *  Notice that there is only ONE internal cached KD-tree, so if a method to query a 2D point is called,
 		 *  then another method for 3D points, then again the 2D method, three KD-trees will be built. So, try
 		 *  to group all the calls for a given dimensionality together or build different class instances for
 		 *  queries of each dimensionality, etc.
 		 *
+		 *  Query methods do not modify any shared state once the KD-tree for their dimensionality has been built,
+		 *  so they can be invoked concurrently from several threads on the same object, provided the tree was
+		 *  first built from one single thread (see rebuild_kdTree_2D(), rebuild_kdTree_3D()) and the data is not modified meanwhile.
+		 *
 		 *  \sa See some of the derived classes for example implementations. See also the documentation of nanoflann
 		 * \ingroup mrpt_base_grp
 		 */
@@ -125,12 +141,8 @@ namespace mrpt
 
 				const size_t knn = 1; // Number of points to retrieve
 				size_t ret_index;
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_index, &out_dist_sqr );
-
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				kdtree_forest_knn(m_kdtree2d_data, &query_point[0], knn, &ret_index, &out_dist_sqr);
 
 				// Copy output to user vars:
 				out_x = derived().kdtree_get_pt(ret_index,0);
@@ -152,12 +164,8 @@ namespace mrpt
 
 				const size_t knn = 1; // Number of points to retrieve
 				size_t ret_index;
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_index, &out_dist_sqr );
-
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				kdtree_forest_knn(m_kdtree2d_data, &query_point[0], knn, &ret_index, &out_dist_sqr);
 
 				return ret_index;
 				MRPT_END
@@ -221,12 +229,8 @@ namespace mrpt
 				const size_t knn = 2; // Number of points to retrieve
 				size_t  ret_indexes[2];
 				float   ret_sqdist[2];
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_indexes[0], &ret_sqdist[0] );
-
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				kdtree_forest_knn(m_kdtree2d_data, &query_point[0], knn, &ret_indexes[0], &ret_sqdist[0]);
 
 				// Copy output to user vars:
 				out_x1 = derived().kdtree_get_pt(ret_indexes[0],0);
@@ -285,12 +289,8 @@ namespace mrpt
 				out_y.resize(knn);
 				out_dist_sqr.resize(knn);
 
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_indexes[0], &out_dist_sqr[0] );
-
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				kdtree_forest_knn(m_kdtree2d_data, &query_point[0], knn, &ret_indexes[0], &out_dist_sqr[0]);
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -339,12 +339,8 @@ namespace mrpt
 
 				out_idx.resize(knn);
 				out_dist_sqr.resize(knn);
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
-
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				kdtree_forest_knn(m_kdtree2d_data, &query_point[0], knn, &out_idx[0], &out_dist_sqr[0]);
 				MRPT_END
 			}
 
@@ -385,13 +381,8 @@ namespace mrpt
 
 				const size_t knn = 1; // Number of points to retrieve
 				size_t ret_index;
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_index, &out_dist_sqr );
-
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-		        m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				kdtree_forest_knn(m_kdtree3d_data, &query_point[0], knn, &ret_index, &out_dist_sqr);
 
 				// Copy output to user vars:
 				out_x = derived().kdtree_get_pt(ret_index,0);
@@ -416,13 +407,8 @@ namespace mrpt
 
 				const size_t knn = 1; // Number of points to retrieve
 				size_t ret_index;
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_index, &out_dist_sqr );
-
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-		        m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				kdtree_forest_knn(m_kdtree3d_data, &query_point[0], knn, &ret_index, &out_dist_sqr);
 
 				return ret_index;
 				MRPT_END
@@ -475,13 +461,8 @@ namespace mrpt
 				out_z.resize(knn);
 				out_dist_sqr.resize(knn);
 
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&ret_indexes[0], &out_dist_sqr[0] );
-
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				kdtree_forest_knn(m_kdtree3d_data, &query_point[0], knn, &ret_indexes[0], &out_dist_sqr[0]);
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -531,13 +512,8 @@ namespace mrpt
 				out_idx.resize(knn);
 				out_dist_sqr.resize(knn);
 
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
-
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				kdtree_forest_knn(m_kdtree3d_data, &query_point[0], knn, &out_idx[0], &out_dist_sqr[0]);
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -585,7 +561,7 @@ namespace mrpt
 				if ( m_kdtree3d_data.m_num_points!=0 )
 				{
 					const num_t xyz[3] = {x0,y0,z0};
-					m_kdtree3d_data.index->radiusSearch(&xyz[0], maxRadiusSqr, out_indices_dist, nanoflann::SearchParams() );
+					kdtree_forest_radius(m_kdtree3d_data, &xyz[0], maxRadiusSqr, out_indices_dist);
 				}
 				return out_indices_dist.size();
 				MRPT_END
@@ -616,7 +592,7 @@ namespace mrpt
 				if ( m_kdtree2d_data.m_num_points!=0 )
 				{
 					const num_t xyz[2] = {x0,y0};
-					m_kdtree2d_data.index->radiusSearch(&xyz[0], maxRadiusSqr, out_indices_dist, nanoflann::SearchParams() );
+					kdtree_forest_radius(m_kdtree2d_data, &xyz[0], maxRadiusSqr, out_indices_dist);
 				}
 				return out_indices_dist.size();
 				MRPT_END
@@ -651,13 +627,8 @@ namespace mrpt
 
 				out_idx.resize(knn);
 				out_dist_sqr.resize(knn);
-				nanoflann::KNNResultSet<num_t> resultSet(knn);
-				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
-
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				kdtree_forest_knn(m_kdtree3d_data, &query_point[0], knn, &out_idx[0], &out_dist_sqr[0]);
 				MRPT_END
 			}
 
@@ -665,22 +636,82 @@ namespace mrpt
 				kdTreeNClosestPoint3DIdx(static_cast<float>(p0.x),static_cast<float>(p0.y),static_cast<float>(p0.z),N,outIdx,outDistSqr);
 			}
 
+			/** Returns the number of separate trees currently used to index the data of the given dimensionality (nDims=2 or 3).
+			  * Mainly for debugging and testing the incremental updates of the index. */
+			size_t kdtree_get_num_subtrees(int nDims) const
+			{
+				ASSERT_(nDims==2 || nDims==3)
+				return nDims==2 ? m_kdtree2d_data.m_trees.size() : m_kdtree3d_data.m_trees.size();
+			}
+
 			/* @} */
 
 		protected:
-			/** To be called by child classes when KD tree data changes. */
+			/** To be called by child classes when KD tree data changes.
+			  * This is NOT required if the only change is that new points have been appended at the end of the
+			  * data set: they will be indexed incrementally in the next query. */
 			inline void kdtree_mark_as_outdated() const { m_kdtree_is_uptodate = false; }
 
+			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
+			void rebuild_kdTree_2D() const
+			{
+				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); m_kdtree_is_uptodate = true; }
+				m_kdtree2d_data.update(derived(), kdtree_search_params.leaf_max_size);
+			}
+
+			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
+			void rebuild_kdTree_3D() const
+			{
+				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); m_kdtree_is_uptodate = true; }
+				m_kdtree3d_data.update(derived(), kdtree_search_params.leaf_max_size);
+			}
+
 		private:
-			/** Internal structure with the KD-tree representation (mainly used to avoid copying pointers with the = operator) */
+			/** Exposes the range of points [first,first+count) of the derived class to nanoflann as a 0-based data set. */
+			struct TKDTreeRangeAdaptor
+			{
+				inline TKDTreeRangeAdaptor(const Derived &obj, size_t first_, size_t count_) : m_obj(obj), first(first_), count(count_) { }
+
+				const Derived &m_obj;
+				const size_t   first, count;
+
+				inline size_t kdtree_get_point_count() const { return count; }
+				inline num_t kdtree_get_pt(const size_t idx, int dim) const { return m_obj.kdtree_get_pt(first+idx,dim); }
+				inline num_t kdtree_distance(const num_t *p1, const size_t idx_p2,size_t size) const { return m_obj.kdtree_distance(p1,first+idx_p2,size); }
+				/// The bounding box of the derived class (if it has one) is only valid for trees covering the whole data set
+				template <class BBOX>
+				bool kdtree_get_bbox(BBOX &bb) const { return (first==0 && count==m_obj.kdtree_get_point_count()) ? m_obj.kdtree_get_bbox(bb) : false; }
+			};
+
+			/** Internal structure with the KD-tree representation (mainly used to avoid copying pointers with the = operator).
+			  *  The data set is indexed by a "logarithmic forest" of static KD-trees, each one covering a range of consecutive
+			  *  points, so newly appended points can be indexed without rebuilding the whole index: each update builds one
+			  *  new tree for the appended points, merged with the last existing trees while they are less than twice its size.
+			  *  Thus, there are O(log N) trees and each point is re-indexed O(log N) times at most. */
 			template <int _DIM = -1>
 			struct TKDTreeDataHolder
 			{
+				typedef typename detail::kdtree_metric_rebind<metric_t,TKDTreeRangeAdaptor>::type range_metric_t;
+				typedef nanoflann::KDTreeSingleIndexAdaptor<range_metric_t,TKDTreeRangeAdaptor, _DIM> kdtree_index_t;
+
+				/** One of the trees, indexing the points [dataset.first,dataset.first+dataset.count) */
+				struct TSubTree
+				{
+					TSubTree(const Derived &obj, size_t first, size_t count, int dim, size_t leaf_max_size) :
+						dataset(obj,first,count),
+						index(dim, dataset, nanoflann::KDTreeSingleIndexAdaptorParams(leaf_max_size))
+					{
+						index.buildIndex();
+					}
+					TKDTreeRangeAdaptor dataset;
+					kdtree_index_t      index;
+				};
+
 				/** Init the pointer to NULL. */
-				inline TKDTreeDataHolder() : index(NULL),m_dim(_DIM), m_num_points(0) { }
+				inline TKDTreeDataHolder() : m_dim(_DIM), m_num_points(0) { }
 
 				/** Copy constructor: It actually does NOT copy the kd-tree, a new object will be created if required!   */
-				inline TKDTreeDataHolder(const TKDTreeDataHolder &)  : index(NULL),m_dim(_DIM), m_num_points(0) { }
+				inline TKDTreeDataHolder(const TKDTreeDataHolder &)  : m_dim(_DIM), m_num_points(0) { }
 
 				/** Copy operator: It actually does NOT copy the kd-tree, a new object will be created if required!  */
 				inline TKDTreeDataHolder& operator =(const TKDTreeDataHolder &o) {
@@ -692,72 +723,113 @@ namespace mrpt
 				inline ~TKDTreeDataHolder() { clear(); }
 
 				/** Free memory (if allocated)  */
-				inline void clear()	{ mrpt::utils::delete_safe( index ); }
+				inline void clear()
+				{
+					for (size_t i=0;i<m_trees.size();i++) delete m_trees[i];
+					m_trees.clear();
+					m_num_points = 0;
+				}
 
-				typedef nanoflann::KDTreeSingleIndexAdaptor<metric_t,Derived, _DIM> kdtree_index_t;
+				/** Index the points appended to \a obj since the last call (all of them after clear()) */
+				void update(const Derived &obj, size_t leaf_max_size)
+				{
+					const size_t N = obj.kdtree_get_point_count();
+					if (N==m_num_points) return;
+					if (N<m_num_points) clear(); // Points have been removed: rebuild from scratch
 
-				kdtree_index_t *index;  //!< NULL or the up-to-date index
+					// Merge the new points with the smallest (most recent) trees:
+					size_t first = m_num_points, count = N-m_num_points;
+					while (!m_trees.empty() && m_trees.back()->dataset.count < 2*count)
+					{
+						first  = m_trees.back()->dataset.first;
+						count += m_trees.back()->dataset.count;
+						delete m_trees.back();
+						m_trees.pop_back();
+					}
+					m_trees.push_back( new TSubTree(obj, first, count, _DIM, leaf_max_size) );
+					m_num_points = N;
+				}
 
-				std::vector<num_t> query_point;
+				std::vector<TSubTree*> m_trees; //!< The trees, covering consecutive ranges of points, with decreasing sizes. Empty if not built yet.
 				size_t           m_dim;         //!< Dimensionality. typ: 2,3
-				size_t           m_num_points;
+				size_t           m_num_points;  //!< Number of points already indexed
 			};
 
-			mutable TKDTreeDataHolder<2>  m_kdtree2d_data;
-			mutable TKDTreeDataHolder<3>  m_kdtree3d_data;
-			mutable TKDTreeDataHolder<>   m_kdtreeNd_data;
-			mutable bool                  m_kdtree_is_uptodate; //!< whether the KD tree needs to be rebuilt or not.
-
-			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
-			void rebuild_kdTree_2D() const
+			/** kNN search in all the trees of \a data. Results are sorted by increasing distance.
+			  * \return The number of found neighbors (<=knn) */
+			template <int _DIM>
+			size_t kdtree_forest_knn(const TKDTreeDataHolder<_DIM> &data, const num_t *query_point, const size_t knn, size_t *out_idx, num_t *out_dist_sqr) const
 			{
-				typedef typename TKDTreeDataHolder<2>::kdtree_index_t  tree2d_t;
+				if (data.m_trees.size()==1)
+				{	// Most common case: one single tree, which always starts at index 0
+					nanoflann::KNNResultSet<num_t> resultSet(knn);
+					resultSet.init(out_idx, out_dist_sqr);
+					data.m_trees[0]->index.findNeighbors(resultSet, query_point, nanoflann::SearchParams());
+					return resultSet.size();
+				}
 
-				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); }
+				// Several trees: keep the knn best among all of them:
+				size_t small_idx[4];
+				num_t  small_dist[4];
+				std::vector<size_t> big_idx;
+				std::vector<num_t>  big_dist;
+				size_t *tree_idx  = &small_idx[0];
+				num_t  *tree_dist = &small_dist[0];
+				if (knn>4)
+				{
+					big_idx.resize(knn);  tree_idx  = &big_idx[0];
+					big_dist.resize(knn); tree_dist = &big_dist[0];
+				}
 
-				if (!m_kdtree2d_data.index)
+				size_t nFound = 0;
+				for (size_t t=0;t<data.m_trees.size();t++)
 				{
-					// Erase previous tree:
-					m_kdtree2d_data.clear();
-					// And build new index:
-					const size_t N = derived().kdtree_get_point_count();
-					m_kdtree2d_data.m_num_points = N;
-					m_kdtree2d_data.m_dim        = 2;
-					m_kdtree2d_data.query_point.resize(2);
-					if (N)
+					nanoflann::KNNResultSet<num_t> resultSet(knn);
+					resultSet.init(tree_idx, tree_dist);
+					data.m_trees[t]->index.findNeighbors(resultSet, query_point, nanoflann::SearchParams());
+					const size_t first = data.m_trees[t]->dataset.first;
+
+					for (size_t i=0;i<resultSet.size();i++)
 					{
-						m_kdtree2d_data.index = new tree2d_t(2, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size) );
-						m_kdtree2d_data.index->buildIndex();
+						const num_t d = tree_dist[i];
+						if (nFound==knn && !(d<out_dist_sqr[knn-1])) break; // Tree results are sorted: no more candidates here
+						// Insert sorted (ties keep the earlier, lower-index points first):
+						size_t j = (nFound<knn) ? nFound++ : knn-1;
+						for (;j>0 && out_dist_sqr[j-1]>d;j--) {
+							out_dist_sqr[j] = out_dist_sqr[j-1];
+							out_idx[j] = out_idx[j-1];
+						}
+						out_dist_sqr[j] = d;
+						out_idx[j] = first + tree_idx[i];
 					}
-					m_kdtree_is_uptodate = true;
 				}
+				return nFound;
 			}
 
-			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
-			void rebuild_kdTree_3D() const
+			/** Radius search in all the trees of \a data. Results are sorted by increasing distance. */
+			template <int _DIM>
+			void kdtree_forest_radius(const TKDTreeDataHolder<_DIM> &data, const num_t *query_point, const num_t maxRadiusSqr, std::vector<std::pair<size_t,num_t> >& out_indices_dist) const
 			{
-				typedef typename TKDTreeDataHolder<3>::kdtree_index_t  tree3d_t;
-
-				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); }
-
-				if (!m_kdtree3d_data.index)
+				out_indices_dist.clear();
+				std::vector<std::pair<size_t,num_t> > tree_indices_dist;
+				for (size_t t=0;t<data.m_trees.size();t++)
 				{
-					// Erase previous tree:
-					m_kdtree3d_data.clear();
-					// And build new index:
-					const size_t N = derived().kdtree_get_point_count();
-					m_kdtree3d_data.m_num_points = N;
-					m_kdtree3d_data.m_dim        = 3;
-					m_kdtree3d_data.query_point.resize(3);
-					if (N)
-					{
-						m_kdtree3d_data.index = new tree3d_t(3, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size) );
-						m_kdtree3d_data.index->buildIndex();
-					}
-					m_kdtree_is_uptodate = true;
+					std::vector<std::pair<size_t,num_t> > &out = (t==0) ? out_indices_dist : tree_indices_dist;
+					data.m_trees[t]->index.radiusSearch(query_point, maxRadiusSqr, out, nanoflann::SearchParams() );
+					if (t==0) continue;
+					const size_t first = data.m_trees[t]->dataset.first;
+					for (size_t i=0;i<tree_indices_dist.size();i++)
+						out_indices_dist.push_back( std::make_pair(first+tree_indices_dist[i].first, tree_indices_dist[i].second) );
 				}
+				if (data.m_trees.size()>1)
+					std::stable_sort(out_indices_dist.begin(),out_indices_dist.end(), nanoflann::IndexDist_Sorter() );
 			}
 
+			mutable TKDTreeDataHolder<2>  m_kdtree2d_data;
+			mutable TKDTreeDataHolder<3>  m_kdtree3d_data;
+			mutable TKDTreeDataHolder<>   m_kdtreeNd_data;
+			mutable bool                  m_kdtree_is_uptodate; //!< whether the KD tree needs to be rebuilt or not.
+
 		};  // end of KDTreeCapable
 
 		/**  @} */  // end of grouping
@@ -19,5 +19,6 @@
 #include <mrpt/system/os.h>
 #include <mrpt/system/string_utils.h>
 #include <mrpt/system/threads.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
 #endif
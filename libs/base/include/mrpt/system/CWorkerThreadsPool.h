@@ -0,0 +1,62 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  MRPT_SYSTEM_CWorkerThreadsPool_H
+#define  MRPT_SYSTEM_CWorkerThreadsPool_H
+
+#include <mrpt/system/threads.h>
+#include <mrpt/base/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace system
+	{
+		/** A set of persistent worker threads to run parallelForBlocks()-like loops without the cost of creating
+		  *  and joining threads in each call. Intended for loops that run many times per second, e.g. within a control loop.
+		  *
+		  * Threads are created on demand by the first call to parallelForBlocks() requesting them, then sleep
+		  *  until the next call, and are only joined upon clear() or destruction.
+		  * Calls from different threads to the same pool are serialized.
+		  *
+		  * \code
+		  *  mrpt::system::CWorkerThreadsPool pool;
+		  *  for (;;)  // e.g. a navigation loop
+		  *    pool.parallelForBlocks(N, &myBlockWorker, &myData, 4);
+		  * \endcode
+		  *
+		  * \sa mrpt::system::parallelForBlocks
+		  * \ingroup mrpt_thread
+		  */
+		class BASE_IMPEXP CWorkerThreadsPool
+		{
+		public:
+			CWorkerThreadsPool(); //!< Default ctor: no threads are created until the first call to parallelForBlocks()
+			~CWorkerThreadsPool(); //!< Dtor: stops and joins all worker threads
+
+			/** Same semantics than mrpt::system::parallelForBlocks(): the partition of `[0,N)` only depends on `N` and `num_threads`,
+			  *  the first block is processed from the calling thread, and the exception of the lowest-index block, if any, is re-thrown here.
+			  * The remaining blocks are run by (`num_threads-1`) persistent threads of this pool, which are created if needed.
+			  * \param num_threads Number of threads, or 0 to use getNumberOfProcessors(). A value of 1 runs `func(0,N,0,user_param)` in the caller thread.
+			  */
+			void parallelForBlocks(size_t N, TParallelForBlockFunctor func, void *user_param, unsigned int num_threads = 0);
+
+			size_t size() const; //!< Number of worker threads currently alive (the caller thread not included)
+			void clear(); //!< Stops and joins all worker threads. They will be created again if needed.
+
+		private:
+			struct Impl;
+			Impl *m_impl;
+
+			CWorkerThreadsPool(const CWorkerThreadsPool &); // Non-copyable
+			CWorkerThreadsPool & operator =(const CWorkerThreadsPool &); // Non-copyable
+		};
+
+	} // End of namespace
+} // End of namespace
+
+#endif
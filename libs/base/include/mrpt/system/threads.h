@@ -281,6 +281,26 @@ namespace mrpt
 		  */
 		unsigned int BASE_IMPEXP getNumberOfProcessors();
 
+		/** Signature of the per-block worker functions for parallelForBlocks().
+		  * \param first, last The half-open range of item indices `[first,last)` to be processed.
+		  * \param thread_idx The index of the calling thread, in `[0,num_threads)`, to be used to select per-thread scratch buffers.
+		  * \param user_param The same pointer passed to parallelForBlocks().
+		  */
+		typedef void (*TParallelForBlockFunctor)(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
+		/** Processes the items `[0,N)` by splitting them into (at most) `num_threads` contiguous blocks of (almost) the same size,
+		  *  and running `func` on each block from a different thread. The call blocks until all blocks are done.
+		  *
+		  * The partition only depends on `N` and `num_threads`, hence algorithms that write the result for each item
+		  * into its own output slot produce identical results no matter the number of threads.
+		  * The first block is processed from the calling thread. If any worker throws, the exception of the
+		  * lowest-index block is re-thrown here after all threads have finished.
+		  *
+		  * \param num_threads Number of threads, or 0 to use getNumberOfProcessors(). A value of 1 runs `func(0,N,0,user_param)` in the caller thread.
+		  * \sa getNumberOfProcessors
+		  */
+		void BASE_IMPEXP parallelForBlocks(size_t N, TParallelForBlockFunctor func, void *user_param, unsigned int num_threads = 0);
+
 		/** An OS-independent method for sending the current thread to "sleep" for a given period of time.
 		  * \param time_ms The sleep period, in miliseconds.
 		  */
@@ -19,6 +19,10 @@ namespace mrpt
 		 *   If the file is not a .gz file, it silently reads data from the file.
 		 *  This class requires compiling MRPT with wxWidgets. If wxWidgets is not available then the class is actually mapped to the standard CFileInputStream
 		 *
+		 *  Block-compressed gz files (see CFileGZOutputStream::openBlockCompressed()) are detected automatically. For them,
+		 *  Seek() is supported and only decompresses the block containing the new position, and consecutive blocks can be
+		 *  decompressed in parallel while reading (see setNumThreads()).
+		 *
 		 * \sa CFileInputStream
 		 * \ingroup mrpt_base_grp
 		 */
@@ -30,6 +34,9 @@ namespace mrpt
 		private:
 			void		*m_f;
 			uint64_t	m_file_size;	//!< Compressed file size
+			struct TBlockReader;
+			TBlockReader *m_block_reader; //!< Only used for block-compressed files
+			unsigned int  m_num_threads;
 
 		public:
 			CFileGZInputStream(); //!< Constructor without open
@@ -51,16 +58,18 @@ namespace mrpt
 			bool fileOpenCorrectly(); //!< Returns true if the file was open without errors.
 			bool is_open() { return fileOpenCorrectly(); } //!< Returns true if the file was open without errors.
 			bool checkEOF(); //!< Will be true if EOF has been already reached.
+			bool isBlockCompressed() const { return m_block_reader!=NULL; } //!< Returns true if the open file is a block-compressed gz file.
+
+			/** Sets the number of consecutive blocks of block-compressed files which are decompressed at once, each in a different thread (0: one per core). Default is 1.
+			  * No effect for other files. */
+			void setNumThreads(unsigned int num_threads) { m_num_threads = num_threads; }
 
 			uint64_t getTotalBytesCount() MRPT_OVERRIDE; //!< Method for getting the total number of <b>compressed</b> bytes of in the file (the physical size of the compressed file).
-			uint64_t getPosition() MRPT_OVERRIDE; //!< Method for getting the current cursor position in the <b>compressed</b>, where 0 is the first byte and TotalBytesCount-1 the last one.
+			uint64_t getPosition() MRPT_OVERRIDE; //!< Method for getting the current cursor position in the <b>uncompressed</b> stream of data, where 0 is the first byte.
 
-			/** This method is not implemented in this class */
-			uint64_t Seek(uint64_t Offset, CStream::TSeekOrigin Origin = sFromBeginning) MRPT_OVERRIDE
-			{
-            MRPT_UNUSED_PARAM(Offset); MRPT_UNUSED_PARAM(Origin);
-				THROW_EXCEPTION("Seek is not implemented in this class");
-			}
+			/** Moves the cursor within the <b>uncompressed</b> stream of data. Only implemented for block-compressed files (see isBlockCompressed()).
+			  * \exception std::exception If the file is not block-compressed. */
+			uint64_t Seek(uint64_t Offset, CStream::TSeekOrigin Origin = sFromBeginning) MRPT_OVERRIDE;
 
 		}; // End of class def.
 
@@ -34,6 +34,8 @@ namespace mrpt
 			// DECLARE_UNCOPIABLE( CFileGZOutputStream )
 		private:
 			void		*m_f;
+			struct TBlockWriter;
+			TBlockWriter *m_block_writer; //!< Only used for block-compressed files, see openBlockCompressed()
 		public:
 			 /** Constructor: opens an output file with compression level = 1 (minimum, fastest).
 			  * \param fileName The file to be open in this stream
@@ -45,7 +47,7 @@ namespace mrpt
 			  * \sa open
 			  */
 			CFileGZOutputStream();
-			virtual ~CFileGZOutputStream(); //!< Destructor
+			virtual ~CFileGZOutputStream(); //!< Destructor: closes the file, ignoring errors (only printed to std::cerr). Call close() explicitly to handle them.
 
 			 /** Open a file for write, choosing the compression level
 			  * \param fileName The file to be open in this stream
@@ -53,7 +55,23 @@ namespace mrpt
 			  * \return true on success, false on any error.
 			  */
 			bool open(const std::string &fileName, int compress_level = 1 );
-			void close(); //!< Close the file
+
+			/** Open a file for write in the block-compressed format: data is split into blocks of `block_size` uncompressed bytes which are
+			  * compressed independently, and an index of the blocks is appended to the file when it is closed.
+			  * The output is still a standard gzip file, but it can be decompressed in parallel and allows cheap seeks when read back with CFileGZInputStream.
+			  * See \ref mrpt::compress::zip::TGZBlockIndex
+			  * \param fileName The file to be open in this stream
+			  * \param compress_level 0:no compression, 1:fastest, 9:best
+			  * \param block_size The size of uncompressed data in each block (default: 1MiB)
+			  * \param num_threads Number of threads to compress blocks in parallel, or 0 to use one per core. Up to `num_threads` blocks are buffered in memory.
+			  * \return true on success, false on any error.
+			  */
+			bool openBlockCompressed(const std::string &fileName, int compress_level = 1, size_t block_size = 1<<20, unsigned int num_threads = 1);
+			bool isBlockCompressed() const { return m_block_writer!=NULL; } //!< Returns true if the file was open with openBlockCompressed()
+
+			/** Close the file. For block-compressed files, the pending blocks and the block index are written first.
+			  * \exception std::exception On any error writing the last data to disk. The file is closed anyway. */
+			void close();
 			bool fileOpenCorrectly(); //!< Returns true if the file was open without errors.
 			bool is_open() { return fileOpenCorrectly(); } //!< Returns true if the file was open without errors.
 			uint64_t getPosition()  MRPT_OVERRIDE; //!< Method for getting the current cursor position, where 0 is the first byte and TotalBytesCount-1 the last one.
@@ -738,6 +738,9 @@ namespace mrpt
 			  */
 			inline void setFromImageReadOnly( const CImage &other_img ) { setFromIplImageReadOnly(const_cast<void*>(other_img.getAs<void>()) ); }
 
+			/** Returns true if this object only wraps an image owned by someone else (see setFromIplImageReadOnly()) */
+			inline bool isReadOnly() const MRPT_NO_THROWS { return m_imgIsReadOnly; }
+
 			/** Set the image from a matrix, interpreted as grayscale intensity values, in the range [0,1] (normalized=true) or [0,255] (normalized=false)
 			  *	Matrix indexes are assumed to be in this order: M(row,column)
 			  * \sa getAsMatrix
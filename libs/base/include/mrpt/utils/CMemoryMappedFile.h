@@ -0,0 +1,55 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  CMemoryMappedFile_H
+#define  CMemoryMappedFile_H
+
+#include <mrpt/utils/core_defs.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <string>
+
+namespace mrpt
+{
+	namespace utils
+	{
+		/** Read-only mapping of a whole file into the address space of the process (`mmap()` in POSIX systems, file mapping objects in Windows).
+		 *  Opening a file is immediate irrespective of its size, since the OS only loads from disk the pages which are actually accessed.
+		 *  Use it together with mrpt::utils::CMemoryStream::assignMemoryNotOwn() to deserialize objects directly from the mapped memory, without copies.
+		 *
+		 * \sa CFileInputStream, CMemoryStream
+		 * \ingroup mrpt_base_grp
+		 */
+		class BASE_IMPEXP CMemoryMappedFile : public CUncopiable
+		{
+		public:
+			CMemoryMappedFile(); //!< Default constructor
+			/** Constructor which maps the given file
+			  * \exception std::exception On error mapping the file. */
+			CMemoryMappedFile(const std::string &fileName);
+			virtual ~CMemoryMappedFile();
+
+			/** Maps the given file, closing any previously open one.
+			  * \return false on any error */
+			bool open(const std::string &fileName);
+			void close(); //!< Unmaps the file, if open. All pointers returned by data() become invalid.
+			bool is_open() const { return m_is_open; } //!< Returns true if a file was mapped correctly.
+
+			const uint8_t * data() const { return m_data; } //!< The file contents, or NULL if not open or the file is empty.
+			uint64_t size() const { return m_size; } //!< The file size (bytes)
+			const std::string & getFileName() const { return m_fileName; } //!< The name of the mapped file
+
+		private:
+			const uint8_t *m_data;
+			uint64_t       m_size;
+			bool           m_is_open;
+			std::string    m_fileName;
+			void          *m_hFile, *m_hMapping; //!< Windows handles (unused in other OSes)
+		}; // End of class def.
+	} // End of namespace
+} // end of namespace
+#endif
@@ -15,6 +15,7 @@
 #include <mrpt/utils/exceptions.h>
 #include <mrpt/utils/bits.h> // reverseBytesInPlace()
 #include <vector>
+#include <map>
 
 namespace mrpt
 {
@@ -23,6 +24,7 @@ namespace mrpt
 		class CSerializable;
 		struct CSerializablePtr;
 		class CMessage;
+		struct TRuntimeClassId;
 
 		/** This base class is used to provide a unified interface to
 		 *    files,memory buffers,..Please see the derived classes. This class is
@@ -59,10 +61,15 @@ namespace mrpt
 			  * - EXISTING_OBJ=false -> build a new object and return it */
 			template <bool EXISTING_OBJ> void internal_ReadObject(CSerializablePtr &newObj, CSerializable *existingObj = NULL);
 
+		private:
+			bool m_compact_class_ids; //!< See setCompactClassIDs()
+			std::map<const TRuntimeClassId*,uint16_t> m_write_class_ids; //!< Classes already written in compact mode, and their IDs
+			std::vector<const TRuntimeClassId*>        m_read_class_ids;  //!< Classes read so far from compact-mode headers, indexed by their IDs
+
 		public:
 			/* Constructor
 			 */
-			CStream() { }
+			CStream() : m_compact_class_ids(false) { }
 
 			/* Destructor
 			 */
@@ -165,9 +172,27 @@ namespace mrpt
 			virtual uint64_t getPosition() =0;
 
 			/** Writes an object to the stream.
+			 * \sa setCompactClassIDs
 			 */
 			void WriteObject( const CSerializable *o );
 
+			/** Enables the compact mode of WriteObject() (default: disabled): the name of each class is only written
+			 *  the first time an object of that class is written to this stream, then objects refer to it with a 1 or 2 byte ID.
+			 *  This saves space and time for streams with many small objects, e.g. rawlogs with millions of observations.
+			 *
+			 *  ReadObject() always accepts both formats. Since IDs are defined by former objects, compact streams
+			 *  must be read sequentially from their beginning, with one single CStream object (call resetClassIDs() if it is rewound).
+			 *  Compact streams cannot be read by MRPT versions older than 1.5.0.
+			 * \sa resetClassIDs
+			 */
+			void setCompactClassIDs(bool enable) { m_compact_class_ids = enable; }
+			bool getCompactClassIDs() const { return m_compact_class_ids; } //!< \sa setCompactClassIDs
+
+			/** Forgets all the class IDs written or read so far in compact mode, e.g. before writing or reading again from the beginning of the stream.
+			 * File streams call it when they are (re)opened or closed.
+			 * \sa setCompactClassIDs */
+			void resetClassIDs() { m_write_class_ids.clear(); m_read_class_ids.clear(); }
+
 			/** Reads an object from stream, its class determined at runtime, and returns a smart pointer to the object.
 			 * \exception std::exception On I/O error or undefined class.
 			 * \exception mrpt::utils::CExceptionEOF On an End-Of-File condition found at a correct place: an EOF that abruptly finishes in the middle of one object raises a plain std::exception instead.
@@ -113,7 +113,8 @@ CParticleFilter::TParticleFilterOptions::TParticleFilterOptions() :
 	resamplingMethod		( prMultinomial ),
 	max_loglikelihood_dyn_range ( 15 ),
 	pfAuxFilterStandard_FirstStageWeightsMonteCarlo ( false ),
-	pfAuxFilterOptimal_MLE(false)
+	pfAuxFilterOptimal_MLE(false),
+	numThreadsObsLikelihood(1)
 {
 }
 
@@ -154,6 +155,7 @@ void  CParticleFilter::TParticleFilterOptions::dumpToTextStream(mrpt::utils::CSt
 	out.printf("max_loglikelihood_dyn_range             = %f\n", max_loglikelihood_dyn_range);
 	out.printf("pfAuxFilterStandard_FirstStageWeightsMonteCarlo = %c\n", pfAuxFilterStandard_FirstStageWeightsMonteCarlo ? 'Y':'N');
 	out.printf("pfAuxFilterOptimal_MLE                  = %c\n", pfAuxFilterOptimal_MLE? 'Y':'N');
+	out.printf("numThreadsObsLikelihood                 = %u\n", numThreadsObsLikelihood);
 
 	out.printf("\n");
 }
@@ -189,6 +191,7 @@ void  CParticleFilter::TParticleFilterOptions::loadFromConfigFile(
 
 	MRPT_LOAD_CONFIG_VAR(pfAuxFilterStandard_FirstStageWeightsMonteCarlo,bool,	iniFile,section.c_str());
 	MRPT_LOAD_CONFIG_VAR(pfAuxFilterOptimal_MLE,bool,	iniFile,section.c_str());
+	MRPT_LOAD_CONFIG_VAR(numThreadsObsLikelihood,int,	iniFile,section.c_str());
 
 
 	MRPT_END
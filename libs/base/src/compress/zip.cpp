@@ -26,6 +26,10 @@
 #include <mrpt/utils/CFileGZInputStream.h>
 #include <mrpt/utils/CFileInputStream.h>
 
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
 using namespace mrpt;
 using namespace mrpt::utils;
 using namespace mrpt::compress::zip;
@@ -450,4 +454,215 @@ bool mrpt::compress::zip::decompress_gz_data_block(
 	return retVal;
 }
 
+/*---------------------------------------------------------------
+					Block-compressed gz files
+---------------------------------------------------------------*/
+namespace
+{
+	// Gzip members which only hold an "extra" field (RFC 1952) and no data:
+	//  ID1 ID2 CM FLG(FEXTRA) MTIME(4) XFL OS XLEN(2) | SI1 SI2 LEN(2) <LEN bytes> | empty deflate stream (2) CRC32(4) ISIZE(4)
+	const size_t  GZ_EXTRA_MEMBER_OVERHEAD = 12 + 4 + 10;
+	const uint8_t GZ_BLOCK_SI1             = 'M';
+	const uint8_t GZ_BLOCK_SI2_INDEX       = 'I';  // Subfield with a list of blocks: pairs of uint32_t (compressed,uncompressed) sizes
+	const uint8_t GZ_BLOCK_SI2_FOOTER      = 'F';  // Subfield with the file offset of the first index member and the number of blocks (uint64_t each)
+	const size_t  GZ_BLOCK_FOOTER_LEN      = 16;
+	const size_t  GZ_BLOCK_ENTRIES_PER_MEMBER = 8000; // The extra field can hold up to 65535 bytes
+
+	template <typename T> void put_le(vector_byte &buf, T val)
+	{
+		for (size_t i=0;i<sizeof(T);i++) {
+			buf.push_back(static_cast<uint8_t>(val & 0xFF));
+			val = static_cast<T>(val >> 8);
+		}
+	}
+	template <typename T> T get_le(const uint8_t *buf)
+	{
+		T val = 0;
+		for (size_t i=sizeof(T);i>0;i--)
+			val = static_cast<T>((val << 8) | buf[i-1]);
+		return val;
+	}
+
+	void append_extra_member(vector_byte &buf, uint8_t si2, const vector_byte &data)
+	{
+		const uint8_t header[] = { 0x1f, 0x8b, 8, 0x04, 0,0,0,0, 0, 0xff };
+		buf.insert(buf.end(), header, header+sizeof(header));
+		put_le<uint16_t>(buf, static_cast<uint16_t>(data.size()+4));
+		buf.push_back(GZ_BLOCK_SI1);
+		buf.push_back(si2);
+		put_le<uint16_t>(buf, static_cast<uint16_t>(data.size()));
+		buf.insert(buf.end(), data.begin(), data.end());
+		const uint8_t trailer[] = { 0x03, 0x00, 0,0,0,0, 0,0,0,0 };
+		buf.insert(buf.end(), trailer, trailer+sizeof(trailer));
+	}
+
+	/** Checks and parses one member written by append_extra_member(). Returns the size of its data (or -1 on error) and a pointer to it in "data". */
+	int parse_extra_member(const uint8_t *buf, size_t buf_len, uint8_t si2, const uint8_t *&data)
+	{
+		if (buf_len<GZ_EXTRA_MEMBER_OVERHEAD || buf[0]!=0x1f || buf[1]!=0x8b || buf[2]!=8 || buf[3]!=0x04)
+			return -1;
+		const size_t xlen = get_le<uint16_t>(buf+10);
+		const size_t len  = get_le<uint16_t>(buf+14);
+		if (xlen!=len+4 || buf[12]!=GZ_BLOCK_SI1 || buf[13]!=si2 || buf_len<GZ_EXTRA_MEMBER_OVERHEAD+len)
+			return -1;
+		const uint8_t *trailer = buf+16+len;
+		if (trailer[0]!=0x03 || trailer[1]!=0x00 || get_le<uint64_t>(trailer+2)!=0)
+			return -1;
+		data = buf+16;
+		return static_cast<int>(len);
+	}
+}
+
+TGZBlockIndex::TGZBlockIndex()
+{
+	clear();
+}
+
+void TGZBlockIndex::clear()
+{
+	compressed_offset.assign(1, 0);
+	uncompressed_offset.assign(1, 0);
+}
+
+void TGZBlockIndex::push_back(uint64_t compressed_size, uint64_t uncompressed_size)
+{
+	compressed_offset.push_back(compressed_offset.back()+compressed_size);
+	uncompressed_offset.push_back(uncompressed_offset.back()+uncompressed_size);
+}
+
+size_t TGZBlockIndex::findBlock(uint64_t uncompressed_pos) const
+{
+	if (uncompressed_pos>=totalUncompressedSize())
+		return size();
+	return (std::upper_bound(uncompressed_offset.begin(),uncompressed_offset.end(),uncompressed_pos)-uncompressed_offset.begin())-1;
+}
+
+bool mrpt::compress::zip::compress_gz_block(const void *in_data, size_t in_data_size, vector_byte &out_gz_data, const int compress_level)
+{
+	if (in_data_size>std::numeric_limits<uInt>::max())
+		return false;
+
+	z_stream zs;
+	memset(&zs,0,sizeof(zs));
+	if (deflateInit2(&zs, compress_level, Z_DEFLATED, 15+16 /* gzip wrapper */, 8, Z_DEFAULT_STRATEGY)!=Z_OK)
+		return false;
+
+	const size_t old_size = out_gz_data.size();
+	const size_t max_size = deflateBound(&zs, static_cast<uLong>(in_data_size)) + 32;
+	out_gz_data.resize(old_size+max_size);
+
+	zs.next_in   = static_cast<Bytef*>(const_cast<void*>(in_data));
+	zs.avail_in  = static_cast<uInt>(in_data_size);
+	zs.next_out  = &out_gz_data[old_size];
+	zs.avail_out = static_cast<uInt>(max_size);
+	const int ret = deflate(&zs, Z_FINISH);
+	out_gz_data.resize(old_size+zs.total_out);
+	deflateEnd(&zs);
+	return ret==Z_STREAM_END;
+}
+
+bool mrpt::compress::zip::decompress_gz_block(const void *in_gz_data, size_t in_gz_data_size, void *out_data, size_t out_data_size)
+{
+	if (in_gz_data_size>std::numeric_limits<uInt>::max() || out_data_size>std::numeric_limits<uInt>::max())
+		return false;
+
+	z_stream zs;
+	memset(&zs,0,sizeof(zs));
+	if (inflateInit2(&zs, 15+16 /* gzip wrapper */)!=Z_OK)
+		return false;
+
+	uint8_t dummy;
+	zs.next_in   = static_cast<Bytef*>(const_cast<void*>(in_gz_data));
+	zs.avail_in  = static_cast<uInt>(in_gz_data_size);
+	zs.next_out  = out_data_size ? static_cast<Bytef*>(out_data) : &dummy;
+	zs.avail_out = static_cast<uInt>(out_data_size);
+	const int ret = inflate(&zs, Z_FINISH);
+	const bool ok = (ret==Z_STREAM_END && zs.total_out==out_data_size);
+	inflateEnd(&zs);
+	return ok;
+}
+
+void mrpt::compress::zip::write_gz_block_index(mrpt::utils::CStream &out, const TGZBlockIndex &index)
+{
+	MRPT_START
+
+	const size_t nBlocks = index.size();
+	vector_byte buf, data;
+	for (size_t first=0;first<nBlocks;first+=GZ_BLOCK_ENTRIES_PER_MEMBER)
+	{
+		const size_t last = std::min(nBlocks, first+GZ_BLOCK_ENTRIES_PER_MEMBER);
+		data.clear();
+		for (size_t i=first;i<last;i++)
+		{
+			const uint64_t csize = index.compressed_offset[i+1]-index.compressed_offset[i];
+			const uint64_t usize = index.uncompressed_offset[i+1]-index.uncompressed_offset[i];
+			ASSERT_(csize<=std::numeric_limits<uint32_t>::max() && usize<=std::numeric_limits<uint32_t>::max())
+			put_le<uint32_t>(data, static_cast<uint32_t>(csize));
+			put_le<uint32_t>(data, static_cast<uint32_t>(usize));
+		}
+		append_extra_member(buf, GZ_BLOCK_SI2_INDEX, data);
+	}
+
+	data.clear();
+	put_le<uint64_t>(data, index.compressed_offset.back());
+	put_le<uint64_t>(data, static_cast<uint64_t>(nBlocks));
+	append_extra_member(buf, GZ_BLOCK_SI2_FOOTER, data);
+
+	out.WriteBuffer(&buf[0], buf.size());
+
+	MRPT_END
+}
+
+bool mrpt::compress::zip::read_gz_block_index(mrpt::utils::CStream &in, TGZBlockIndex &index)
+{
+	index.clear();
+	try
+	{
+		const size_t footer_size = GZ_EXTRA_MEMBER_OVERHEAD+GZ_BLOCK_FOOTER_LEN;
+		const uint64_t file_size = in.getTotalBytesCount();
+		if (file_size<footer_size)
+			return false;
+
+		// Footer: where the index starts and how many blocks are there:
+		uint8_t footer[GZ_EXTRA_MEMBER_OVERHEAD+GZ_BLOCK_FOOTER_LEN];
+		in.Seek(file_size-footer_size);
+		if (in.ReadBuffer(footer,footer_size)!=footer_size)
+			return false;
+		const uint8_t *data;
+		if (parse_extra_member(footer, footer_size, GZ_BLOCK_SI2_FOOTER, data)!=static_cast<int>(GZ_BLOCK_FOOTER_LEN))
+			return false;
+		const uint64_t index_offset = get_le<uint64_t>(data);
+		const uint64_t nBlocks      = get_le<uint64_t>(data+8);
+		if (index_offset>file_size-footer_size || nBlocks>(file_size-footer_size-index_offset)/8)
+			return false;
+
+		// Index members:
+		vector_byte buf(static_cast<size_t>(file_size-footer_size-index_offset));
+		in.Seek(index_offset);
+		if (!buf.empty() && in.ReadBuffer(&buf[0],buf.size())!=buf.size())
+			return false;
+		index.compressed_offset.reserve(nBlocks+1);
+		index.uncompressed_offset.reserve(nBlocks+1);
+		for (size_t pos=0;pos<buf.size();)
+		{
+			const int len = parse_extra_member(&buf[pos], buf.size()-pos, GZ_BLOCK_SI2_INDEX, data);
+			if (len<0 || (len%8)!=0)
+				break;
+			for (int i=0;i<len;i+=8)
+				index.push_back(get_le<uint32_t>(data+i), get_le<uint32_t>(data+i+4));
+			pos+=GZ_EXTRA_MEMBER_OVERHEAD+len;
+		}
 
+		if (index.size()!=nBlocks || index.compressed_offset.back()!=index_offset)
+		{
+			index.clear();
+			return false;
+		}
+		return true;
+	}
+	catch (std::exception &)
+	{
+		index.clear();
+		return false;
+	}
+}
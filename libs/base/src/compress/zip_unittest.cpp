@@ -9,6 +9,9 @@
 
 #include <mrpt/compress.h>
 #include <mrpt/math/ops_vectors.h>
+#include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/utils/CFileGZOutputStream.h>
+#include <mrpt/system/filesystem.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -47,3 +50,72 @@ TEST(Compress, DataBlockGZ)
 	EXPECT_EQ(0, err ) << "Differences after compressing & decompressing with GZ\n";
 }
 
+
+TEST(Compress, BlockCompressedGZFile)
+{
+	const size_t N = 100000, BLOCK_SIZE = 4096;
+	vector_byte in_data(N);
+	for (size_t i=0;i<N;i++)
+		in_data[i] = static_cast<uint8_t>(i*i/1000);
+
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		CFileGZOutputStream f;
+		ASSERT_TRUE(f.openBlockCompressed(fil, 1, BLOCK_SIZE, 2));
+		for (size_t i=0;i<N;i+=1000)  // Chunks not aligned with blocks
+			f.WriteBuffer(&in_data[i], 1000);
+		EXPECT_EQ(f.getPosition(), N);
+	}
+
+	// It must be a valid gzip file for generic readers:
+	vector_byte all_data;
+	ASSERT_TRUE(mrpt::compress::zip::decompress_gz_file(fil, all_data));
+	EXPECT_TRUE(all_data==in_data);
+
+	CFileGZInputStream f(fil);
+	ASSERT_TRUE(f.isBlockCompressed());
+	f.setNumThreads(2);
+
+	vector_byte read_data(N);
+	EXPECT_EQ(f.ReadBuffer(&read_data[0], N), N);
+	EXPECT_TRUE(read_data==in_data);
+	EXPECT_TRUE(f.checkEOF());
+
+	// Random access, including reads across block boundaries:
+	const size_t offsets[] = { 0, N-1, BLOCK_SIZE-3, 5*BLOCK_SIZE, 12345 };
+	for (size_t i=0;i<sizeof(offsets)/sizeof(offsets[0]);i++)
+	{
+		const size_t len = std::min<size_t>(10, N-offsets[i]);
+		EXPECT_EQ(f.Seek(offsets[i]), offsets[i]);
+		vector_byte buf(len);
+		EXPECT_EQ(f.ReadBuffer(&buf[0], len), len);
+		EXPECT_TRUE(std::equal(buf.begin(), buf.end(), in_data.begin()+offsets[i]));
+		EXPECT_EQ(f.getPosition(), offsets[i]+len);
+	}
+	f.close();
+	mrpt::system::deleteFile(fil);
+}
+
+// Errors writing the last blocks and the block index must be reported by an explicit close():
+TEST(Compress, BlockCompressedGZFileCloseError)
+{
+	const std::string fil = "/dev/full"; // Any write fails with "No space left on device"
+	if (!mrpt::system::fileExists(fil))
+		return;
+
+	// Data which cannot be compressed, so the compressed block does not fit in the file stream buffer:
+	vector_byte in_data(1<<16);
+	uint32_t seed = 1;
+	for (size_t i=0;i<in_data.size();i++)
+	{
+		seed = seed*1103515245 + 12345;
+		in_data[i] = static_cast<uint8_t>(seed >> 24);
+	}
+
+	CFileGZOutputStream f;
+	ASSERT_TRUE(f.openBlockCompressed(fil, 1, in_data.size(), 1));
+	f.WriteBuffer(&in_data[0], in_data.size()); // Only buffered, not written yet
+	EXPECT_THROW(f.close(), std::exception);
+	EXPECT_FALSE(f.fileOpenCorrectly());
+	EXPECT_NO_THROW(f.close());
+}
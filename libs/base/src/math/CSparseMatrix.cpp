@@ -10,6 +10,8 @@
 #include "base-precomp.h"  // Precompiled headers
 
 #include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/system/threads.h>
+#include <algorithm>
 
 using std::string;
 using std::cout;
@@ -326,29 +328,190 @@ bool CSparseMatrix::saveToTextFile_sparse(const std::string &filName)
 *  \exception std::runtime_error On non-square input matrix.
 *  \exception mrpt::math::CExceptionNotDefPos On non-semidefinite-positive matrix as input.
 */
-CSparseMatrix::CholeskyDecomp::CholeskyDecomp(const CSparseMatrix &SM) :
+CSparseMatrix::CholeskyDecomp::CholeskyDecomp(const CSparseMatrix &SM, unsigned int num_threads) :
 	m_symbolic_structure	(NULL),
 	m_numeric_structure		(NULL),
-	m_originalSM			(&SM)
+	m_num_threads			(1),
+	m_cur_level_first		(0)
 {
 	ASSERT_(SM.getColCount()==SM.getRowCount())
 	ASSERT_(SM.isColumnCompressed())
 
+	setNumThreads(num_threads);
+	analyze(SM);
+}
+
+// Destructor:
+CSparseMatrix::CholeskyDecomp::~CholeskyDecomp()
+{
+	release();
+}
+
+void CSparseMatrix::CholeskyDecomp::release()
+{
+	cs_nfree(m_numeric_structure);
+	cs_sfree(m_symbolic_structure);
+	m_numeric_structure = NULL;
+	m_symbolic_structure = NULL;
+}
+
+void CSparseMatrix::CholeskyDecomp::setNumThreads(unsigned int num_threads)
+{
+	m_num_threads = num_threads>0 ? num_threads : mrpt::system::getNumberOfProcessors();
+}
+
+void CSparseMatrix::CholeskyDecomp::analyze(const CSparseMatrix &SM)
+{
+	release();
+	const cs &A = SM.sparse_matrix;
+
 	// symbolic decomposition:
-	m_symbolic_structure = cs_schol(1 /* order */, &m_originalSM->sparse_matrix );
+	m_symbolic_structure = cs_schol(1 /* order */, &A );
 
 	// numeric decomposition:
-	m_numeric_structure = cs_chol(&m_originalSM->sparse_matrix,m_symbolic_structure);
+	m_numeric_structure = cs_chol(&A,m_symbolic_structure);
 
 	if (!m_numeric_structure)
+	{
+		release();
 		throw mrpt::math::CExceptionNotDefPos("CSparseMatrix::CholeskyDecomp: Not positive definite matrix.");
+	}
+
+	// Cache all we need to redo the numeric factorization over the same sparse structure:
+	const int n = A.n, nnzA = A.p[n];
+	m_A_colptr.assign(A.p, A.p+n+1);
+	m_A_rowidx.assign(A.i, A.i+nnzA);
+
+	// Entries of L are stored by cs_chol() with the diagonal first and then by increasing row:
+	const cs *L = m_numeric_structure->L;
+	const int *Lp = L->p, *Li = L->i, *pinv = m_symbolic_structure->pinv;
+
+	// Where each (upper triangular) entry of A goes in the lower triangular, permuted matrix P*A*P':
+	m_A_to_L.assign(nnzA, -1);
+	for (int c=0;c<n;c++)
+	{
+		for (int p=A.p[c];p<A.p[c+1];p++)
+		{
+			const int r = A.i[p];
+			if (r>c) continue;
+			const int r2 = pinv ? pinv[r] : r, c2 = pinv ? pinv[c] : c;
+			const int col = std::min(r2,c2), row = std::max(r2,c2);
+			const int *it = std::lower_bound(Li+Lp[col], Li+Lp[col+1], row);
+			ASSERT_(it!=Li+Lp[col+1] && *it==row)
+			m_A_to_L[p] = static_cast<int>(it-Li);
+		}
+	}
+
+	// Row-wise structure of L, below the diagonal:
+	m_Lrow_ptr.assign(n+1, 0);
+	for (int k=0;k<n;k++)
+		for (int p=Lp[k]+1;p<Lp[k+1];p++)
+			m_Lrow_ptr[Li[p]+1]++;
+	for (int j=0;j<n;j++)
+		m_Lrow_ptr[j+1] += m_Lrow_ptr[j];
+	m_Lrow_col.resize(m_Lrow_ptr[n]);
+	m_Lrow_idx.resize(m_Lrow_ptr[n]);
+	{
+		std::vector<int> next(m_Lrow_ptr.begin(), m_Lrow_ptr.end()-1);
+		for (int k=0;k<n;k++)
+			for (int p=Lp[k]+1;p<Lp[k+1];p++)
+			{
+				const int q = next[Li[p]]++;
+				m_Lrow_col[q] = k;
+				m_Lrow_idx[q] = p;
+			}
+	}
+
+	// Column j only depends on its descendants in the elimination tree, so all columns with the same height
+	// can be computed simultaneously once all lower levels are done:
+	const int *parent = m_symbolic_structure->parent;
+	std::vector<int> height(n, 0);
+	int max_height = 0;
+	for (int j=0;j<n;j++)  // parent[j]>j, so height[j] is final here
+	{
+		mrpt::utils::keep_max(max_height, height[j]);
+		if (parent[j]>=0)
+			mrpt::utils::keep_max(height[parent[j]], height[j]+1);
+	}
+	m_levels_ptr.assign(max_height+2, 0);
+	for (int j=0;j<n;j++)
+		m_levels_ptr[height[j]+1]++;
+	for (int h=0;h<=max_height;h++)
+		m_levels_ptr[h+1] += m_levels_ptr[h];
+	m_levels_cols.resize(n);
+	{
+		std::vector<int> next(m_levels_ptr.begin(), m_levels_ptr.end()-1);
+		for (int j=0;j<n;j++)
+			m_levels_cols[next[height[j]]++] = j;
+	}
+
+	// cs_chol() does not add up duplicated entries in A, so recompute L as update() would do:
+	try {
+		refactorize(SM);
+	}
+	catch (...) {
+		release();
+		throw;
+	}
 }
 
-// Destructor:
-CSparseMatrix::CholeskyDecomp::~CholeskyDecomp()
+bool CSparseMatrix::CholeskyDecomp::hasSameStructure(const CSparseMatrix &SM) const
 {
-	cs_nfree(m_numeric_structure);
-	cs_sfree(m_symbolic_structure);
+	const cs &A = SM.sparse_matrix;
+	if (A.nz!=-1 || A.n!=A.m || A.n+1!=static_cast<int>(m_A_colptr.size()) || A.p[A.n]!=static_cast<int>(m_A_rowidx.size()))
+		return false;
+	return std::equal(m_A_colptr.begin(),m_A_colptr.end(), A.p) &&
+		std::equal(m_A_rowidx.begin(),m_A_rowidx.end(), A.i);
+}
+
+/* Left-looking computation of column j of L, with "x" a zeroed workspace of length N which is left zeroed on return.
+ * L->x must hold P*A*P' (lower triangle) for column j, and the final values of L for all the columns it depends on. */
+bool CSparseMatrix::CholeskyDecomp::factorColumn(const int j, double *x)
+{
+	cs *L = m_numeric_structure->L;
+	const int *Lp = L->p, *Li = L->i;
+	double *Lx = L->x;
+
+	for (int p=Lp[j];p<Lp[j+1];p++)
+		x[Li[p]] = Lx[p];
+
+	// x -= L(j:n,k) * L(j,k) for each column k with L(j,k)!=0:
+	for (int q=m_Lrow_ptr[j];q<m_Lrow_ptr[j+1];q++)
+	{
+		const int k = m_Lrow_col[q], pjk = m_Lrow_idx[q];
+		const double ljk = Lx[pjk];
+		for (int p=pjk;p<Lp[k+1];p++)
+			x[Li[p]] -= Lx[p] * ljk;
+	}
+
+	const double d = x[j];
+	if (d<=0)
+	{
+		for (int p=Lp[j];p<Lp[j+1];p++)
+			x[Li[p]] = 0;
+		return false; // not pos def
+	}
+	const double ljj = std::sqrt(d);
+	Lx[Lp[j]] = ljj;
+	x[j] = 0;
+	for (int p=Lp[j]+1;p<Lp[j+1];p++)
+	{
+		Lx[p] = x[Li[p]] / ljj;
+		x[Li[p]] = 0;
+	}
+	return true;
+}
+
+void CSparseMatrix::CholeskyDecomp::factorColumnsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+{
+	CholeskyDecomp *me = static_cast<CholeskyDecomp*>(user_param);
+	double *x = &me->m_work[thread_idx*me->m_A_colptr.size()];
+	for (size_t i=first;i<last;i++)
+		if (!me->factorColumn(me->m_levels_cols[me->m_cur_level_first+i], x))
+		{
+			me->m_thread_failed[thread_idx] = 1;
+			return;
+		}
 }
 
 /** Return the L matrix (L*L' = M), as a dense matrix. */
@@ -388,23 +551,45 @@ void CSparseMatrix::CholeskyDecomp::backsub(
 }
 
 /** Update the Cholesky factorization from an updated vesion of the original input, square definite-positive sparse matrix.
-*  NOTE: This new matrix MUST HAVE exactly the same sparse structure than the original one.
+*  If the sparse structure is the same than the original one, only the numeric factorization is recomputed.
 */
 void CSparseMatrix::CholeskyDecomp::update(const CSparseMatrix &new_SM)
 {
-	ASSERTMSG_(m_originalSM->sparse_matrix.nzmax == new_SM.sparse_matrix.nzmax, "New matrix doesn't have the same sparse structure!");
-	ASSERTMSG_(m_originalSM->sparse_matrix.n == new_SM.sparse_matrix.n, "New matrix doesn't have the same sparse structure!");
-
-	m_originalSM = &new_SM; // Just copy the reference.
+	ASSERT_(new_SM.getColCount()==new_SM.getRowCount())
+	ASSERT_(new_SM.isColumnCompressed())
 
-	// Release old data:
-	cs_nfree(m_numeric_structure);
-	m_numeric_structure = NULL;
+	if (!m_numeric_structure || !hasSameStructure(new_SM))
+		analyze(new_SM);
+	else refactorize(new_SM);
+}
 
-	// numeric decomposition:
-	m_numeric_structure = cs_chol(&m_originalSM->sparse_matrix,m_symbolic_structure);
-	if (!m_numeric_structure)
-		throw mrpt::math::CExceptionNotDefPos("CholeskyDecomp::update: Not positive definite matrix.");
+void CSparseMatrix::CholeskyDecomp::refactorize(const CSparseMatrix &SM)
+{
+	// Load P*A*P' into the (already allocated) L:
+	const cs &A = SM.sparse_matrix;
+	cs *L = m_numeric_structure->L;
+	const int n = A.n;
+	std::fill(L->x, L->x+L->p[n], 0.0);
+	for (int p=0;p<A.p[n];p++)
+		if (m_A_to_L[p]>=0)
+			L->x[m_A_to_L[p]] += A.x[p];
+
+	// Numeric factorization, level by level of the elimination tree:
+	const size_t MIN_COLUMNS_PER_THREAD = 32; // Don't launch threads for small levels
+	const unsigned int nThreads = m_num_threads;
+	m_work.assign(static_cast<size_t>(nThreads)*(n+1), 0.0);
+	m_thread_failed.assign(nThreads, 0);
+	for (size_t lev=0;lev+1<m_levels_ptr.size();lev++)
+	{
+		m_cur_level_first = m_levels_ptr[lev];
+		const size_t nCols = m_levels_ptr[lev+1]-m_levels_ptr[lev];
+		if (nThreads>1 && nCols>=2*MIN_COLUMNS_PER_THREAD)
+			mrpt::system::parallelForBlocks(nCols, &CholeskyDecomp::factorColumnsBlock, this, std::min<size_t>(nThreads, nCols/MIN_COLUMNS_PER_THREAD));
+		else factorColumnsBlock(0,nCols,0,this);
+
+		if (std::find(m_thread_failed.begin(),m_thread_failed.end(),1)!=m_thread_failed.end())
+			throw mrpt::math::CExceptionNotDefPos("CholeskyDecomp::update: Not positive definite matrix.");
+	}
 }
 
 // ===============    END OF: CSparseMatrix::CholeskyDecomp  inner class  ==============================
@@ -213,3 +213,46 @@ TEST(SparseMatrix, CholeskyDecomp)
 	EXPECT_TRUE(err<1e-8);
 }
 
+TEST(SparseMatrix, CholeskyDecompUpdate)
+{
+	// Block-tridiagonal plus some far off-diagonal blocks, like the Hessian of a pose graph with loop closures:
+	const size_t nBlocks = 200, B = 3, N = nBlocks*B;
+	for (unsigned int num_threads=1;num_threads<=4;num_threads+=3)
+	{
+		std::vector<CSparseMatrix*> Ms;
+		for (int iter=0;iter<3;iter++)
+		{
+			CSparseMatrix *SM = new CSparseMatrix(N,N);
+			for (size_t i=0;i<nBlocks;i++)
+			{
+				const CMatrixDouble COV = mrpt::random::randomGenerator.drawDefinitePositiveMatrix(B, 0.2);
+				SM->insert_submatrix(i*B,i*B, COV*10.0);
+				if (i+1<nBlocks)
+					SM->insert_submatrix(i*B,(i+1)*B, COV*0.1);
+				if (i%10==0 && i+50<nBlocks)
+					SM->insert_submatrix(i*B,(i+50)*B, COV*0.1);
+			}
+			SM->compressFromTriplet();
+			Ms.push_back(SM);
+		}
+
+		CSparseMatrix::CholeskyDecomp  Chol(*Ms[0], num_threads);
+		for (size_t k=1;k<Ms.size();k++)
+		{
+			Chol.update(*Ms[k]); // Same structure: only numeric factorization
+			CSparseMatrix::CholeskyDecomp  Chol_ref(*Ms[k]);
+			const double err = (Chol.get_L()-Chol_ref.get_L()).array().abs().maxCoeff();
+			EXPECT_LT(err, 1e-10) << "num_threads=" << num_threads;
+		}
+
+		// Non definite-positive matrix, with a different structure:
+		CSparseMatrix SM_neg_trip(N,N);
+		SM_neg_trip.insert_entry(0,0, 1.0);
+		SM_neg_trip.insert_entry(1,1, -1.0);
+		for (size_t i=2;i<N;i++) SM_neg_trip.insert_entry(i,i, 1.0);
+		SM_neg_trip.compressFromTriplet();
+		EXPECT_THROW(Chol.update(SM_neg_trip), CExceptionNotDefPos);
+
+		for (size_t k=0;k<Ms.size();k++) delete Ms[k];
+	}
+}
@@ -0,0 +1,159 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "base-precomp.h"  // Precompiled headers
+
+#include <mrpt/system/CWorkerThreadsPool.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+
+using namespace mrpt::system;
+
+struct CWorkerThreadsPool::Impl
+{
+	std::vector<std::thread> threads;  //!< Worker "i" runs block "i+1"; block 0 is run by the caller.
+
+	std::mutex              run_mutex; //!< Serializes calls to parallelForBlocks()
+	std::mutex              m;         //!< Protects all the fields below
+	std::condition_variable cv_start, cv_done;
+	uint64_t                generation; //!< Incremented for each new loop
+	bool                    quit;
+	unsigned int            pending;    //!< Number of workers which have not finished the current loop yet
+
+	// The current loop:
+	TParallelForBlockFunctor func;
+	void                    *user_param;
+	size_t                   N;
+	unsigned int             num_threads;
+	std::vector<std::exception_ptr> errors;
+
+	Impl() : generation(0), quit(false), pending(0), func(NULL), user_param(NULL), N(0), num_threads(0) { }
+
+	static void runBlock(TParallelForBlockFunctor f, size_t N, unsigned int T, unsigned int i, void *param, std::exception_ptr *err)
+	{
+		try {
+			f( (N*i)/T, (N*(i+1))/T, i, param);
+		}
+		catch (...) {
+			*err = std::current_exception();
+		}
+	}
+
+	void workerThread(unsigned int block_idx, uint64_t last_generation)
+	{
+		std::unique_lock<std::mutex> lock(m);
+		for (;;)
+		{
+			while (!quit && generation==last_generation)
+				cv_start.wait(lock);
+			if (quit) return;
+			last_generation = generation;
+
+			// Loops requesting less threads than alive in the pool leave the last workers idle:
+			if (block_idx<num_threads)
+			{
+				const TParallelForBlockFunctor f = func;
+				void *param = user_param;
+				const size_t n = N;
+				const unsigned int T = num_threads;
+				std::exception_ptr *err = &errors[block_idx];
+				lock.unlock();
+				runBlock(f,n,T,block_idx,param,err);
+				lock.lock();
+			}
+			if (--pending==0)
+				cv_done.notify_one();
+		}
+	}
+
+	void stopAll()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m);
+			quit = true;
+		}
+		cv_start.notify_all();
+		for (size_t i=0;i<threads.size();i++)
+			threads[i].join();
+		threads.clear();
+		quit = false;
+	}
+};
+
+CWorkerThreadsPool::CWorkerThreadsPool() :
+	m_impl(new Impl)
+{
+}
+
+CWorkerThreadsPool::~CWorkerThreadsPool()
+{
+	m_impl->stopAll();
+	delete m_impl;
+}
+
+size_t CWorkerThreadsPool::size() const
+{
+	std::lock_guard<std::mutex> lock(m_impl->run_mutex);
+	return m_impl->threads.size();
+}
+
+void CWorkerThreadsPool::clear()
+{
+	std::lock_guard<std::mutex> lock(m_impl->run_mutex);
+	m_impl->stopAll();
+}
+
+void CWorkerThreadsPool::parallelForBlocks(size_t N, TParallelForBlockFunctor func, void *user_param, unsigned int num_threads)
+{
+	ASSERT_(func!=NULL)
+	if (!N) return;
+	if (!num_threads) num_threads = getNumberOfProcessors();
+	if (num_threads>N) num_threads = static_cast<unsigned int>(N);
+
+	if (num_threads<=1)
+	{
+		func(0,N,0,user_param);
+		return;
+	}
+
+	Impl &d = *m_impl;
+	std::lock_guard<std::mutex> run_lock(d.run_mutex);
+
+	// Launch missing workers. No loop is running now, so they can safely take the current generation as "already done":
+	while (d.threads.size()+1<num_threads)
+		d.threads.push_back( std::thread(&Impl::workerThread, &d, static_cast<unsigned int>(d.threads.size()+1), d.generation) );
+
+	{
+		std::lock_guard<std::mutex> lock(d.m);
+		d.func = func;
+		d.user_param = user_param;
+		d.N = N;
+		d.num_threads = num_threads;
+		d.errors.assign(num_threads, std::exception_ptr());
+		d.pending = static_cast<unsigned int>(d.threads.size());
+		d.generation++;
+	}
+	d.cv_start.notify_all();
+
+	Impl::runBlock(func,N,num_threads,0,user_param,&d.errors[0]);
+
+	{
+		std::unique_lock<std::mutex> lock(d.m);
+		while (d.pending!=0)
+			d.cv_done.wait(lock);
+	}
+
+	for (unsigned int i=0;i<num_threads;i++)
+		if (d.errors[i])
+			std::rethrow_exception(d.errors[i]);
+}
@@ -0,0 +1,85 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/utils/mrpt_macros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <stdexcept>
+
+using namespace mrpt::system;
+using namespace std;
+
+namespace
+{
+	struct TFillData
+	{
+		vector<int> items;
+		vector<unsigned int> block_of_item;
+		int round;
+	};
+
+	void fillBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		TFillData &d = *static_cast<TFillData*>(user_param);
+		for (size_t i=first;i<last;i++)
+		{
+			d.items[i]+=d.round;
+			d.block_of_item[i] = thread_idx;
+		}
+	}
+
+	void throwingBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(first); MRPT_UNUSED_PARAM(last); MRPT_UNUSED_PARAM(user_param);
+		if (thread_idx==2)
+			throw std::runtime_error("block 2");
+	}
+}
+
+TEST(CWorkerThreadsPool, ReusedForManyLoops)
+{
+	CWorkerThreadsPool pool;
+	EXPECT_EQ(pool.size(), 0u);
+
+	const size_t N = 1000;
+	TFillData d;
+	d.items.assign(N,0);
+	d.block_of_item.assign(N,0);
+
+	int expected = 0;
+	for (d.round=1;d.round<=50;d.round++)
+	{
+		// Alternate the number of threads, to also check idle workers:
+		const unsigned int nThreads = (d.round%2) ? 4 : 3;
+		pool.parallelForBlocks(N, &fillBlock, &d, nThreads);
+		expected+=d.round;
+
+		for (size_t i=0;i<N;i++)
+			EXPECT_EQ(d.items[i], expected);
+		// Same partition than parallelForBlocks(): block "b" is [b*N/T, (b+1)*N/T)
+		for (unsigned int b=0;b<nThreads;b++)
+			for (size_t i=(b*N)/nThreads;i<((b+1)*N)/nThreads;i++)
+				EXPECT_EQ(d.block_of_item[i], b);
+	}
+	EXPECT_EQ(pool.size(), 3u);
+
+	pool.clear();
+	EXPECT_EQ(pool.size(), 0u);
+	pool.parallelForBlocks(N, &fillBlock, &d, 2);
+	EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST(CWorkerThreadsPool, RethrowsWorkerExceptions)
+{
+	CWorkerThreadsPool pool;
+	EXPECT_THROW(pool.parallelForBlocks(10, &throwingBlock, NULL, 4), std::runtime_error);
+	// The pool is still usable:
+	EXPECT_NO_THROW(pool.parallelForBlocks(10, &throwingBlock, NULL, 2));
+}
@@ -38,6 +38,8 @@
 #endif
 
 #include <fstream>
+#include <thread>
+#include <exception>
 #include <sys/types.h>
 #include <sys/stat.h>
 #ifdef MRPT_OS_APPLE
@@ -520,6 +522,52 @@ unsigned int mrpt::system::getNumberOfProcessors()
     return ret;
 }
 
+/*---------------------------------------------------------------
+					parallelForBlocks
+  ---------------------------------------------------------------*/
+void mrpt::system::parallelForBlocks(size_t N, TParallelForBlockFunctor func, void *user_param, unsigned int num_threads)
+{
+	ASSERT_(func!=NULL)
+	if (!N) return;
+	if (!num_threads) num_threads = getNumberOfProcessors();
+	if (num_threads>N) num_threads = static_cast<unsigned int>(N);
+
+	if (num_threads<=1)
+	{
+		func(0,N,0,user_param);
+		return;
+	}
+
+	// Static partition: block "i" is [i*N/T, (i+1)*N/T)
+	std::vector<std::exception_ptr> errors(num_threads);
+	std::vector<std::thread>        workers;
+	workers.reserve(num_threads-1);
+
+	struct TRunBlock {
+		static void run(TParallelForBlockFunctor f, size_t N, unsigned int T, unsigned int i, void *param, std::exception_ptr *err)
+		{
+			try {
+				f( (N*i)/T, (N*(i+1))/T, i, param);
+			}
+			catch (...) {
+				*err = std::current_exception();
+			}
+		}
+	};
+
+	for (unsigned int i=1;i<num_threads;i++)
+		workers.push_back( std::thread(&TRunBlock::run, func,N,num_threads,i,user_param,&errors[i]) );
+
+	TRunBlock::run(func,N,num_threads,0,user_param,&errors[0]);
+
+	for (size_t i=0;i<workers.size();i++)
+		workers[i].join();
+
+	for (unsigned int i=0;i<num_threads;i++)
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+}
+
 /*---------------------------------------------------------------
 					exitThread
   ---------------------------------------------------------------*/
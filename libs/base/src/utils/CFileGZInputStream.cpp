@@ -15,8 +15,12 @@
 #endif
 
 #include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/utils/CFileInputStream.h>
+#include <mrpt/compress/zip.h>
 #include <mrpt/system/os.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/threads.h>
+#include <cstring>
 
 
 #include <zlib.h>
@@ -26,10 +30,84 @@ using namespace std;
 
 #define THE_GZFILE   reinterpret_cast<gzFile>(m_f)
 
+/** Reads block-compressed files, keeping a cache with the last group of consecutive blocks decompressed in parallel. */
+struct CFileGZInputStream::TBlockReader
+{
+	CFileInputStream  in;
+	mrpt::compress::zip::TGZBlockIndex index;
+	uint64_t          position;
+	size_t            cur_block;   //!< Block of the last read, to avoid searching the index in consecutive reads
+	size_t            cache_first, cache_count; //!< Blocks in the cache: [cache_first, cache_first+cache_count)
+	std::vector<vector_byte> cache;
+	vector_byte       compressed;
+	std::vector<char> decompressed_ok;
+
+	TBlockReader() : position(0), cur_block(0), cache_first(0), cache_count(0) {}
+
+	static void decompressBlocks(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		TBlockReader *me = static_cast<TBlockReader*>(user_param);
+		const uint64_t offset0 = me->index.compressed_offset[me->cache_first];
+		for (size_t i=first;i<last;i++)
+		{
+			const size_t blk = me->cache_first+i;
+			me->cache[i].resize(me->index.uncompressed_offset[blk+1]-me->index.uncompressed_offset[blk]);
+			me->decompressed_ok[i] = mrpt::compress::zip::decompress_gz_block(
+				&me->compressed[me->index.compressed_offset[blk]-offset0], me->index.compressed_offset[blk+1]-me->index.compressed_offset[blk],
+				me->cache[i].empty() ? NULL : &me->cache[i][0], me->cache[i].size());
+		}
+	}
+
+	/** Loads into the cache up to "num_threads" blocks, starting at "first" */
+	void loadBlocks(size_t first, unsigned int num_threads)
+	{
+		cache_first = first;
+		cache_count = std::min<size_t>(std::max(1U,num_threads), index.size()-first);
+		if (cache.size()<cache_count)
+		{
+			cache.resize(cache_count);
+			decompressed_ok.resize(cache_count);
+		}
+		// All the compressed blocks are read at once, since they are contiguous:
+		compressed.resize(index.compressed_offset[first+cache_count]-index.compressed_offset[first]);
+		in.Seek(index.compressed_offset[first]);
+		if (in.ReadBuffer(&compressed[0],compressed.size())!=compressed.size())
+			THROW_EXCEPTION("Unexpected end of block-compressed gz file");
+
+		mrpt::system::parallelForBlocks(cache_count, &TBlockReader::decompressBlocks, this, num_threads);
+		for (size_t i=0;i<cache_count;i++)
+			if (!decompressed_ok[i])
+				THROW_EXCEPTION_FMT("Error decompressing block #%u of gz file", static_cast<unsigned int>(first+i));
+	}
+
+	size_t read(uint8_t *buf, size_t count, unsigned int num_threads)
+	{
+		size_t nRead = 0;
+		while (count && position<index.totalUncompressedSize())
+		{
+			if (position<index.uncompressed_offset[cur_block] || position>=index.uncompressed_offset[cur_block+1])
+				cur_block = index.findBlock(position);
+			if (cur_block<cache_first || cur_block>=cache_first+cache_count)
+				loadBlocks(cur_block, num_threads);
+
+			const vector_byte &blk = cache[cur_block-cache_first];
+			const size_t offset = static_cast<size_t>(position-index.uncompressed_offset[cur_block]);
+			const size_t n = std::min(count, blk.size()-offset);
+			::memcpy(buf, &blk[offset], n);
+			buf+=n;
+			count-=n;
+			nRead+=n;
+			position+=n;
+		}
+		return nRead;
+	}
+};
+
 /*---------------------------------------------------------------
 							Constructor
  ---------------------------------------------------------------*/
-CFileGZInputStream::CFileGZInputStream( const string &fileName ) : m_f(NULL)
+CFileGZInputStream::CFileGZInputStream( const string &fileName ) : m_f(NULL), m_block_reader(NULL), m_num_threads(1)
 {
 	MRPT_START
 	open(fileName);
@@ -38,7 +116,7 @@ CFileGZInputStream::CFileGZInputStream( const string &fileName ) : m_f(NULL)
 /*---------------------------------------------------------------
 							Constructor
  ---------------------------------------------------------------*/
-CFileGZInputStream::CFileGZInputStream( ) : m_f(NULL)
+CFileGZInputStream::CFileGZInputStream( ) : m_f(NULL), m_block_reader(NULL), m_num_threads(1)
 {
 }
 
@@ -49,13 +127,24 @@ bool CFileGZInputStream::open(const std::string &fileName )
 {
 	MRPT_START
 
-	if (m_f) gzclose(THE_GZFILE);
+	close();
 
 	// Get compressed file size:
 	m_file_size = mrpt::system::getFileSize(fileName);
 	if (m_file_size==uint64_t(-1))
 		THROW_EXCEPTION_FMT("Couldn't access the file '%s'",fileName.c_str() );
 
+	// Block-compressed file?
+	{
+		TBlockReader *br = new TBlockReader();
+		if (br->in.open(fileName) && mrpt::compress::zip::read_gz_block_index(br->in, br->index))
+		{
+			m_block_reader = br;
+			return true;
+		}
+		delete br;
+	}
+
 	// Open gz stream:
 	m_f = gzopen(fileName.c_str(),"rb");
 	return m_f != NULL;
@@ -68,11 +157,17 @@ bool CFileGZInputStream::open(const std::string &fileName )
  ---------------------------------------------------------------*/
 void CFileGZInputStream::close()
 {
+	resetClassIDs(); // Compact class IDs only make sense within one file
 	if (m_f)
 	{
 		gzclose(THE_GZFILE);
 		m_f = NULL;
 	}
+	if (m_block_reader)
+	{
+		delete m_block_reader;
+		m_block_reader = NULL;
+	}
 }
 
 /*---------------------------------------------------------------
@@ -89,6 +184,8 @@ CFileGZInputStream::~CFileGZInputStream()
  ---------------------------------------------------------------*/
 size_t  CFileGZInputStream::Read(void *Buffer, size_t Count)
 {
+	if (m_block_reader)
+		return m_block_reader->read(static_cast<uint8_t*>(Buffer),Count,m_num_threads ? m_num_threads : mrpt::system::getNumberOfProcessors());
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
 
 	return gzread(THE_GZFILE,Buffer,Count);
@@ -109,7 +206,7 @@ size_t  CFileGZInputStream::Write(const void *Buffer, size_t Count)
  ---------------------------------------------------------------*/
 uint64_t CFileGZInputStream::getTotalBytesCount()
 {
-	if (!m_f) { THROW_EXCEPTION("File is not open."); }
+	if (!fileOpenCorrectly()) { THROW_EXCEPTION("File is not open."); }
 	return m_file_size;
 }
 
@@ -118,16 +215,37 @@ uint64_t CFileGZInputStream::getTotalBytesCount()
  ---------------------------------------------------------------*/
 uint64_t CFileGZInputStream::getPosition()
 {
+	if (m_block_reader) return m_block_reader->position;
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
 	return gztell(THE_GZFILE);
 }
 
+/*---------------------------------------------------------------
+						Seek
+ ---------------------------------------------------------------*/
+uint64_t CFileGZInputStream::Seek(uint64_t Offset, CStream::TSeekOrigin Origin)
+{
+	if (!m_block_reader) { THROW_EXCEPTION("Seek is only implemented for block-compressed gz files."); }
+
+	const uint64_t total = m_block_reader->index.totalUncompressedSize();
+	uint64_t pos = 0;
+	switch (Origin)
+	{
+	case sFromBeginning: pos = Offset; break;
+	case sFromCurrent:   pos = m_block_reader->position + Offset; break;
+	case sFromEnd:       pos = total + Offset; break;
+	default: THROW_EXCEPTION("Invalid value for 'Origin'");
+	}
+	m_block_reader->position = std::min(pos,total);
+	return m_block_reader->position;
+}
+
 /*---------------------------------------------------------------
 						fileOpenCorrectly
  ---------------------------------------------------------------*/
 bool  CFileGZInputStream::fileOpenCorrectly()
 {
-	return m_f!=NULL;
+	return m_f!=NULL || m_block_reader!=NULL;
 }
 
 /*---------------------------------------------------------------
@@ -135,6 +253,7 @@ bool  CFileGZInputStream::fileOpenCorrectly()
  ---------------------------------------------------------------*/
 bool CFileGZInputStream::checkEOF()
 {
+	if (m_block_reader) return m_block_reader->position>=m_block_reader->index.totalUncompressedSize();
 	if (!m_f)	return true;
 	else		return 0!=gzeof(THE_GZFILE);
 }
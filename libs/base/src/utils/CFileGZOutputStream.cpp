@@ -15,7 +15,11 @@
 #endif
 
 #include <mrpt/utils/CFileGZOutputStream.h>
+#include <mrpt/utils/CFileOutputStream.h>
+#include <mrpt/compress/zip.h>
 #include <mrpt/system/os.h>
+#include <mrpt/system/threads.h>
+#include <limits>
 
 #if MRPT_HAS_GZ_STREAMS
 
@@ -26,12 +30,83 @@
 using namespace mrpt::utils;
 using namespace std;
 
+/** Buffers the data of up to "num_threads" blocks, which are then compressed in parallel and written in order. */
+struct CFileGZOutputStream::TBlockWriter
+{
+	CFileOutputStream  out;
+	int                compress_level;
+	size_t             block_size;
+	unsigned int       num_threads;
+	std::vector<vector_byte> blocks, compressed;
+	std::vector<char>  compressed_ok;
+	size_t             num_blocks;  //!< Blocks in use in "blocks": all are full, except (maybe) the last one
+	uint64_t           position;
+	mrpt::compress::zip::TGZBlockIndex index;
+
+	TBlockWriter(int level, size_t blockSize, unsigned int nThreads) :
+		compress_level(level), block_size(blockSize), num_threads(nThreads),
+		blocks(nThreads), compressed(nThreads), compressed_ok(nThreads),
+		num_blocks(0), position(0)
+	{
+	}
+
+	void write(const uint8_t *buf, size_t count)
+	{
+		while (count)
+		{
+			if (!num_blocks || blocks[num_blocks-1].size()==block_size)
+			{
+				if (num_blocks==num_threads)
+					flush();
+				blocks[num_blocks].clear();
+				blocks[num_blocks].reserve(block_size);
+				num_blocks++;
+			}
+			vector_byte &blk = blocks[num_blocks-1];
+			const size_t n = std::min(count, block_size-blk.size());
+			blk.insert(blk.end(), buf, buf+n);
+			buf+=n;
+			count-=n;
+			position+=n;
+		}
+	}
+
+	static void compressBlocks(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		TBlockWriter *me = static_cast<TBlockWriter*>(user_param);
+		for (size_t i=first;i<last;i++)
+		{
+			me->compressed[i].clear();
+			me->compressed_ok[i] = mrpt::compress::zip::compress_gz_block(&me->blocks[i][0], me->blocks[i].size(), me->compressed[i], me->compress_level);
+		}
+	}
+
+	/** Compresses and writes all the buffered blocks */
+	void flush()
+	{
+		if (num_blocks && blocks[num_blocks-1].empty())
+			num_blocks--;
+		if (!num_blocks) return;
+
+		mrpt::system::parallelForBlocks(num_blocks, &TBlockWriter::compressBlocks, this, num_threads);
+		for (size_t i=0;i<num_blocks;i++)
+		{
+			if (!compressed_ok[i])
+				THROW_EXCEPTION("Error compressing block of gz file");
+			out.WriteBuffer(&compressed[i][0], compressed[i].size());
+			index.push_back(compressed[i].size(), blocks[i].size());
+		}
+		num_blocks = 0;
+	}
+};
+
 
 /*---------------------------------------------------------------
 							Constructor
  ---------------------------------------------------------------*/
 CFileGZOutputStream::CFileGZOutputStream( const string	&fileName ) :
-	m_f(NULL)
+	m_f(NULL), m_block_writer(NULL)
 {
 	MRPT_START
 	if (!open(fileName))
@@ -43,7 +118,7 @@ CFileGZOutputStream::CFileGZOutputStream( const string	&fileName ) :
 				Constructor
  ---------------------------------------------------------------*/
 CFileGZOutputStream::CFileGZOutputStream( ) :
-	m_f(NULL)
+	m_f(NULL), m_block_writer(NULL)
 {
 }
 
@@ -54,7 +129,7 @@ bool CFileGZOutputStream::open( const string	&fileName, int compress_level )
 {
 	MRPT_START
 
-	if (m_f) gzclose(THE_GZFILE);
+	close();
 
 	// Open gz stream:
 	m_f = gzopen(fileName.c_str(),format("wb%i",compress_level).c_str() );
@@ -63,12 +138,44 @@ bool CFileGZOutputStream::open( const string	&fileName, int compress_level )
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+						openBlockCompressed
+ ---------------------------------------------------------------*/
+bool CFileGZOutputStream::openBlockCompressed(const std::string &fileName, int compress_level, size_t block_size, unsigned int num_threads)
+{
+	MRPT_START
+	ASSERT_(block_size>0 && block_size<=std::numeric_limits<uint32_t>::max())
+
+	close();
+
+	if (!num_threads)
+		num_threads = mrpt::system::getNumberOfProcessors();
+	m_block_writer = new TBlockWriter(compress_level, block_size, num_threads);
+	if (!m_block_writer->out.open(fileName))
+	{
+		delete m_block_writer;
+		m_block_writer = NULL;
+		return false;
+	}
+	return true;
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 							Destructor
  ---------------------------------------------------------------*/
 CFileGZOutputStream::~CFileGZOutputStream()
 {
-	close();
+	// Don't throw from the destructor: call close() explicitly to detect errors writing the last data.
+	try
+	{
+		close();
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "[CFileGZOutputStream::~CFileGZOutputStream] Error closing file:\n" << e.what() << std::endl;
+	}
 }
 
 /*---------------------------------------------------------------
@@ -76,11 +183,35 @@ CFileGZOutputStream::~CFileGZOutputStream()
  ---------------------------------------------------------------*/
 void CFileGZOutputStream::close()
 {
+	MRPT_START
+
+	resetClassIDs(); // Compact class IDs only make sense within one file
 	if (m_f)
 	{
-		gzclose(THE_GZFILE);
+		const int ret = gzclose(THE_GZFILE);
 		m_f = NULL;
+		if (ret!=Z_OK)
+			THROW_EXCEPTION_FMT("Error closing gz file (zlib error code: %i)", ret);
+	}
+	if (m_block_writer)
+	{
+		// The stream is closed even if writing the pending blocks or the block index fails:
+		TBlockWriter *bw = m_block_writer;
+		m_block_writer = NULL;
+		try
+		{
+			bw->flush();
+			mrpt::compress::zip::write_gz_block_index(bw->out, bw->index);
+		}
+		catch (...)
+		{
+			delete bw;
+			throw;
+		}
+		delete bw;
 	}
+
+	MRPT_END
 }
 
 /*---------------------------------------------------------------
@@ -99,6 +230,11 @@ size_t  CFileGZOutputStream::Read(void *Buffer, size_t Count)
  ---------------------------------------------------------------*/
 size_t  CFileGZOutputStream::Write(const void *Buffer, size_t Count)
 {
+	if (m_block_writer)
+	{
+		m_block_writer->write(static_cast<const uint8_t*>(Buffer),Count);
+		return Count;
+	}
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
 	return gzwrite(THE_GZFILE,const_cast<void*>(Buffer),Count);
 }
@@ -108,6 +244,7 @@ size_t  CFileGZOutputStream::Write(const void *Buffer, size_t Count)
  ---------------------------------------------------------------*/
 uint64_t CFileGZOutputStream::getPosition()
 {
+	if (m_block_writer) return m_block_writer->position;
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
 	return gztell(THE_GZFILE);
 }
@@ -117,7 +254,7 @@ uint64_t CFileGZOutputStream::getPosition()
  ---------------------------------------------------------------*/
 bool  CFileGZOutputStream::fileOpenCorrectly()
 {
-	return m_f!=NULL;
+	return m_f!=NULL || m_block_writer!=NULL;
 }
 
 #endif  // MRPT_HAS_GZ_STREAMS
@@ -48,6 +48,8 @@ CFileInputStream::CFileInputStream() : m_if()
  ---------------------------------------------------------------*/
 bool CFileInputStream::open( const string &fileName )
 {
+	close();
+
 	// Try to open the file:
 	// Open for input:
 	m_if.open(fileName.c_str(), ios_base::binary | ios_base::in );
@@ -60,6 +62,7 @@ bool CFileInputStream::open( const string &fileName )
 void CFileInputStream::close()
 {
 	if (m_if.is_open()) m_if.close();
+	resetClassIDs(); // Compact class IDs only make sense within one file
 }
 
 /*---------------------------------------------------------------
@@ -67,6 +67,7 @@ bool CFileOutputStream::open(
 void CFileOutputStream::close()
 {
 	if (m_of.is_open()) m_of.close();
+	resetClassIDs(); // Compact class IDs only make sense within one file
 }
 
 /*---------------------------------------------------------------
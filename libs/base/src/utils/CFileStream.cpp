@@ -62,8 +62,7 @@ bool CFileStream::open(const std::string &fileName, TFileOpenModes mode_)
 	else if (mode_==(fomRead|fomWrite))   mode = std::ios_base::in | std::ios_base::out | std::ios_base::trunc;
 	else if (mode_==(fomAppend|fomWrite)) mode = std::ios_base::in | std::ios_base::out | std::ios_base::app;
 
-	if (m_f.is_open())
-		m_f.close();
+	close();
 
 	m_f.open(fileName.c_str(), ios_base::binary | mode );
 	return m_f.is_open();
@@ -76,7 +75,8 @@ bool CFileStream::open(const std::string &fileName, TFileOpenModes mode_)
  ---------------------------------------------------------------*/
 void CFileStream::close()
 {
-	m_f.close();
+	if (m_f.is_open()) m_f.close();
+	resetClassIDs(); // Compact class IDs only make sense within one file
 }
 
 /*---------------------------------------------------------------
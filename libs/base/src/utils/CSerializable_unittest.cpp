@@ -10,6 +10,7 @@
 
 #include <mrpt/utils/CSerializable.h>
 #include <mrpt/utils/CFileInputStream.h>
+#include <mrpt/utils/CFileOutputStream.h>
 #include <mrpt/utils/CMemoryStream.h>
 #include <mrpt/utils/stl_serialization.h>
 #include <mrpt/utils/TStereoCamera.h>
@@ -125,6 +126,85 @@ TEST(SerializeTestBase, WriteReadToMem)
 	}
 }
 
+// Write many objects with and without compact class IDs, then read them back:
+TEST(SerializeTestBase, CompactClassIDs)
+{
+	const size_t nClasses = sizeof(lstClasses)/sizeof(lstClasses[0]);
+	CMemoryStream  buf_plain, buf_compact;
+	buf_compact.setCompactClassIDs(true);
+	for (int round=0;round<10;round++)
+	{
+		for (size_t i=0;i<nClasses;i++)
+		{
+			CSerializablePtr o( static_cast<CSerializable*>(lstClasses[i]->createObject()) );
+			buf_plain << o;
+			buf_compact << o;
+		}
+		buf_compact << CSerializablePtr(); // A NULL object
+	}
+	buf_compact << CPose2D(1.0,2.0,0.5);
+	EXPECT_LT(buf_compact.getTotalBytesCount(), buf_plain.getTotalBytesCount());
+
+	try
+	{
+		buf_compact.Seek(0);
+		for (int round=0;round<10;round++)
+		{
+			for (size_t i=0;i<nClasses;i++)
+			{
+				CSerializablePtr recons;
+				buf_compact >> recons;
+				ASSERT_TRUE(recons.present());
+				EXPECT_EQ(recons->GetRuntimeClass(), lstClasses[i]);
+			}
+			CSerializablePtr null_obj;
+			buf_compact >> null_obj;
+			EXPECT_FALSE(null_obj.present());
+		}
+		CPose2D p;
+		buf_compact >> p;
+		EXPECT_EQ(p, CPose2D(1.0,2.0,0.5));
+	}
+	catch(std::exception &e)
+	{
+		GTEST_FAIL() << "Exception:\n" << e.what() << endl;
+	}
+
+	// Class IDs are only known if the stream is read from its beginning:
+	buf_compact.Seek(0);
+	buf_compact.resetClassIDs();
+	CSerializablePtr recons;
+	for (size_t i=0;i<nClasses;i++) buf_compact >> recons;
+	buf_compact.resetClassIDs();
+	EXPECT_THROW(buf_compact >> recons, std::exception);
+}
+
+// Each file written in compact mode must be self-contained, even if the same stream object wrote other files before:
+TEST(SerializeTestBase, CompactClassIDsFileReopen)
+{
+	const string fil1 = mrpt::system::getTempFileName(), fil2 = mrpt::system::getTempFileName();
+	{
+		CFileOutputStream f(fil1);
+		f.setCompactClassIDs(true);
+		f << CPose2D(1.0,2.0,0.5);
+		ASSERT_TRUE(f.open(fil2));
+		f << CPose2D(3.0,4.0,0.5);
+	}
+
+	CFileInputStream f;
+	CPose2D p;
+	ASSERT_TRUE(f.open(fil2));
+	EXPECT_NO_THROW(f >> p);
+	EXPECT_EQ(p, CPose2D(3.0,4.0,0.5));
+	ASSERT_TRUE(f.open(fil1));
+	EXPECT_NO_THROW(f >> p);
+	EXPECT_EQ(p, CPose2D(1.0,2.0,0.5));
+	f.close();
+
+	mrpt::system::deleteFile(fil1);
+	mrpt::system::deleteFile(fil2);
+}
+
 // Create a set of classes, then test that copy operators "work" (doesn't crash)
 TEST(SerializeTestBase, CopyOperator)
 {
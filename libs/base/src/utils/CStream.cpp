@@ -24,6 +24,11 @@
 // 8 bits:
 #define SERIALIZATION_END_FLAG  0x88
 
+// Object headers in compact mode (see CStream::setCompactClassIDs()). Out of the range of the "class name length | 0x80" of plain headers.
+#define SERIALIZATION_CLASSID_DEFINE  0xFE  // Followed by the class name (length+chars), which gets the next free ID
+#define SERIALIZATION_CLASSID_REF8    0xFD  // Followed by an uint8_t class ID
+#define SERIALIZATION_CLASSID_REF16   0xFC  // Followed by an uint16_t class ID
+
 using namespace mrpt;
 using namespace mrpt::utils;
 using namespace mrpt::system;
@@ -182,10 +187,40 @@ void CStream::WriteObject(const  CSerializable *o )
 	}
 	
 	int8_t  classNamLen = strlen(className);
-	int8_t  classNamLen_mod = classNamLen | 0x80;
 
-	(*this) << classNamLen_mod;
-	this->WriteBuffer( className, classNamLen);
+	if (o != NULL && m_compact_class_ids)
+	{
+		// Compact mode: the class name only the first time, then its ID:
+		const TRuntimeClassId *classId = o->GetRuntimeClass();
+		std::map<const TRuntimeClassId*,uint16_t>::const_iterator it = m_write_class_ids.find(classId);
+		if (it == m_write_class_ids.end())
+		{
+			ASSERTMSG_(m_write_class_ids.size()<0xFFFF, "Too many different classes in a compact stream");
+			const uint16_t newId = static_cast<uint16_t>(m_write_class_ids.size());
+			m_write_class_ids[classId] = newId;
+
+			const uint8_t header = SERIALIZATION_CLASSID_DEFINE;
+			(*this) << header << classNamLen;
+			this->WriteBuffer( className, classNamLen);
+		}
+		else if (it->second<0x100)
+		{
+			const uint8_t header = SERIALIZATION_CLASSID_REF8, id = static_cast<uint8_t>(it->second);
+			(*this) << header << id;
+		}
+		else
+		{
+			const uint8_t header = SERIALIZATION_CLASSID_REF16;
+			(*this) << header << it->second;
+		}
+	}
+	else
+	{
+		int8_t  classNamLen_mod = classNamLen | 0x80;
+
+		(*this) << classNamLen_mod;
+		this->WriteBuffer( className, classNamLen);
+	}
 
 	// Next, the version number:
 	if(o != NULL)
@@ -371,29 +406,68 @@ void CStream::internal_ReadObject(CSerializablePtr &newObj,CSerializable *existi
 		if (sizeof(lengthReadClassName) != ReadBuffer( (void*)&lengthReadClassName, sizeof(lengthReadClassName) ) )
 			THROW_EXCEPTION("Cannot read object header from stream! (EOF?)");
 
-		// Is in old format (< MRPT 0.5.5)?
-		if (! (lengthReadClassName & 0x80 ))
+		const TRuntimeClassId *classId = NULL; // NULL for "nullptr" objects, or unregistered classes
+		bool isNullObj = false;
+
+		if (lengthReadClassName==SERIALIZATION_CLASSID_REF8 || lengthReadClassName==SERIALIZATION_CLASSID_REF16)
 		{
-			isOldFormat = true;
-			uint8_t buf[3];
-			if (3 != ReadBuffer( buf, 3 ) ) THROW_EXCEPTION("Cannot read object header from stream! (EOF?)");
-			if (buf[0] || buf[1] || buf[2]) THROW_EXCEPTION("Expecting 0x00 00 00 while parsing old streaming header (Perhaps it's a gz-compressed stream? Use a GZ-stream for reading)");
+			// Compact header: a class defined by a former object in this stream.
+			uint16_t id;
+			if (lengthReadClassName==SERIALIZATION_CLASSID_REF8)
+			{
+				uint8_t id8;
+				if (sizeof(id8)!=ReadBuffer( (void*)&id8, sizeof(id8) )) THROW_EXCEPTION("Cannot read object class ID from stream!");
+				id = id8;
+			}
+			else if (sizeof(id)!=ReadBufferFixEndianness( &id, 1 /*element count*/ ))
+				THROW_EXCEPTION("Cannot read object class ID from stream!");
+
+			if (id>=m_read_class_ids.size())
+				THROW_EXCEPTION_FMT("Undefined class ID %u in compact stream (Was it read from its beginning?)", static_cast<unsigned int>(id));
+			classId = m_read_class_ids[id];
+			os::strcpy(readClassName, sizeof(readClassName), classId->className);
 		}
+		else
+		{
+			const bool isClassDefinition = (lengthReadClassName==SERIALIZATION_CLASSID_DEFINE);
+			if (isClassDefinition)
+			{
+				// Compact header, first object of its class: the class name follows, as in plain headers.
+				if (sizeof(lengthReadClassName) != ReadBuffer( (void*)&lengthReadClassName, sizeof(lengthReadClassName) ) )
+					THROW_EXCEPTION("Cannot read object header from stream! (EOF?)");
+			}
+			// Is in old format (< MRPT 0.5.5)?
+			else if (! (lengthReadClassName & 0x80 ))
+			{
+				isOldFormat = true;
+				uint8_t buf[3];
+				if (3 != ReadBuffer( buf, 3 ) ) THROW_EXCEPTION("Cannot read object header from stream! (EOF?)");
+				if (buf[0] || buf[1] || buf[2]) THROW_EXCEPTION("Expecting 0x00 00 00 while parsing old streaming header (Perhaps it's a gz-compressed stream? Use a GZ-stream for reading)");
+			}
+
+			// Remove MSB:
+			lengthReadClassName &= 0x7F;
 
-		// Remove MSB:
-		lengthReadClassName &= 0x7F;
+			// Sensible class name size?
+			if (lengthReadClassName>120)
+				THROW_EXCEPTION("Class name has more than 120 chars. This probably means a corrupted binary stream.");
 
-		// Sensible class name size?
-		if (lengthReadClassName>120)
-			THROW_EXCEPTION("Class name has more than 120 chars. This probably means a corrupted binary stream.");
+			if (((size_t)lengthReadClassName)!=ReadBuffer( readClassName, lengthReadClassName ))
+				THROW_EXCEPTION("Cannot read object class name from stream!");
 
-		if (((size_t)lengthReadClassName)!=ReadBuffer( readClassName, lengthReadClassName ))
-			THROW_EXCEPTION("Cannot read object class name from stream!");
+			readClassName[lengthReadClassName]='\0';
 
-		readClassName[lengthReadClassName]='\0';
+			isNullObj = !isClassDefinition && !strcmp(readClassName,"nullptr");
+			if (!isNullObj)
+				classId = findRegisteredClass(readClassName, lengthReadClassName); // Lock-free, no need to build a std::string
 
-		// Pass to string class:
-		const std::string strClassName(readClassName);
+			if (isClassDefinition)
+			{
+				if (!classId)
+					THROW_EXCEPTION_FMT("Class '%s' is not registered! Have you called mrpt::registerClass(CLASS)?",readClassName);
+				m_read_class_ids.push_back(classId);
+			}
+		}
 
 		// Next, the version number:
 		int8_t version;
@@ -406,35 +480,33 @@ void CStream::internal_ReadObject(CSerializablePtr &newObj,CSerializable *existi
 			ASSERT_(version_old>=0 && version_old<255);
 			version = int8_t(version_old);
 		}
-		else if (strClassName != "nullptr" && sizeof(version)!=ReadBuffer( (void*)&version, sizeof(version) ))
+		else if (!isNullObj && sizeof(version)!=ReadBuffer( (void*)&version, sizeof(version) ))
 		{
 				THROW_EXCEPTION("Cannot read object streaming version from stream!");
 		}
 
 		// In MRPT 0.5.5 an end flag was introduced:
 #if CSTREAM_VERBOSE
-		cerr << "[CStream::ReadObject] readClassName:" << strClassName << " version: " << version <<  endl;
+		cerr << "[CStream::ReadObject] readClassName:" << readClassName << " version: " << version <<  endl;
 #endif
 
 		CSerializable* obj = NULL;
 		if (EXISTING_OBJ)
 		{	// (Existing object)
 			// Now, compare to existing class:
-			if(strClassName != "nullptr")
+			if(!isNullObj)
 			{
 				ASSERT_(existingObj)
 				const TRuntimeClassId	*id  = existingObj->GetRuntimeClass();
-				const TRuntimeClassId	*id2 = findRegisteredClass(strClassName);
-				if (!id2) THROW_EXCEPTION_FMT("Stored object has class '%s' which is not registered!",strClassName.c_str());
-				if ( id!=id2 ) THROW_EXCEPTION(format("Stored class does not match with existing object!!:\n Stored: %s\n Expected: %s", id2->className,id->className ));
+				if (!classId) THROW_EXCEPTION_FMT("Stored object has class '%s' which is not registered!",readClassName);
+				if ( id!=classId ) THROW_EXCEPTION(format("Stored class does not match with existing object!!:\n Stored: %s\n Expected: %s", classId->className,id->className ));
 				// It matches, OK
 				obj = existingObj;
 			}
 		}
-		else if (strClassName != "nullptr")
+		else if (!isNullObj)
 		{	// (New object)
-			// Get the mapping to the "TRuntimeClassId*" in the registered classes table:
-			const TRuntimeClassId *classId = findRegisteredClass( strClassName );
+			// The mapping to the "TRuntimeClassId*" in the registered classes table:
 			if (!classId)
 			{
 				const std::string msg = format("Class '%s' is not registered! Have you called mrpt::registerClass(CLASS)?",readClassName);
@@ -445,7 +517,7 @@ void CStream::internal_ReadObject(CSerializablePtr &newObj,CSerializable *existi
 			newObj = CSerializablePtr(obj);
 		}
 
-		if(strClassName != "nullptr")
+		if(!isNullObj)
 		{
 			// Go on, read it:
 			obj->readFromStream( *this, (int)version );
@@ -455,9 +527,9 @@ void CStream::internal_ReadObject(CSerializablePtr &newObj,CSerializable *existi
 		{
 			uint8_t	endFlag;
 			if (sizeof(endFlag)!=ReadBuffer( (void*)&endFlag, sizeof(endFlag) )) THROW_EXCEPTION("Cannot read object streaming version from stream!");
-			if (endFlag!=SERIALIZATION_END_FLAG) THROW_EXCEPTION_FMT("end-flag missing: There is a bug in the deserialization method of class: '%s'",strClassName.c_str());
+			if (endFlag!=SERIALIZATION_END_FLAG) THROW_EXCEPTION_FMT("end-flag missing: There is a bug in the deserialization method of class: '%s'",readClassName);
 		}
-		ASSERT_(!EXISTING_OBJ || strClassName != "nullptr");
+		ASSERT_(!EXISTING_OBJ || !isNullObj);
 	}
 	catch (std::bad_alloc &)
 	{
@@ -13,6 +13,9 @@
 #include <mrpt/utils/CObject.h>
 
 #include <map>
+#include <vector>
+#include <memory>
+#include <cstring>
 #include <cstdarg>
 #include <mutex>
 #include <atomic>
@@ -54,7 +57,59 @@ namespace mrpt
 	{
 		typedef std::map<std::string,const TRuntimeClassId*> TClassnameToRuntimeId;
 
+		/** An immutable open-addressing hash table className -> TRuntimeClassId*, built from the registry contents
+		  * and read without any lock. Names point to the keys of CClassRegistry::registeredClasses, which are never erased. */
+		class TFrozenClassTable
+		{
+		public:
+			explicit TFrozenClassTable(const TClassnameToRuntimeId &classes)
+			{
+				size_t n = 16;
+				while (n<2*classes.size()) n<<=1;
+				m_slots.resize(n);
+				for (TClassnameToRuntimeId::const_iterator it=classes.begin();it!=classes.end();++it)
+				{
+					if (!it->second) continue;
+					size_t i = hash(it->first.c_str(),it->first.size()) & (n-1);
+					while (m_slots[i].id) i = (i+1) & (n-1);
+					m_slots[i].name = it->first.c_str();
+					m_slots[i].len = it->first.size();
+					m_slots[i].id = it->second;
+				}
+			}
+
+			const TRuntimeClassId *find(const char *className, const size_t len) const
+			{
+				const size_t mask = m_slots.size()-1;
+				for (size_t i = hash(className,len) & mask; m_slots[i].id; i = (i+1) & mask)
+					if (m_slots[i].len==len && !::memcmp(m_slots[i].name,className,len))
+						return m_slots[i].id;
+				return NULL;
+			}
+
+		private:
+			struct TSlot
+			{
+				const char *name;
+				size_t len;
+				const TRuntimeClassId *id; //!< NULL for empty slots
+				TSlot() : name(NULL), len(0), id(NULL) { }
+			};
+			std::vector<TSlot> m_slots; //!< Size is a power of 2, at least twice the number of classes
+
+			static size_t hash(const char *s, const size_t len)
+			{
+				// djb2, as in mrpt::utils::reduced_hash()
+				size_t h = 5381;
+				for (size_t i=0;i<len;i++)
+					h = ((h << 5) + h) + static_cast<unsigned char>(s[i]);
+				return h;
+			}
+		};
+
 		/** A singleton with the central registry for CSerializable run-time classes: users do not use this class in any direct way.
+		  * Lookups are lock-free: they read an immutable snapshot of the registry (a TFrozenClassTable), which is only
+		  * rebuilt (with the lock held) by the first lookup after new classes are registered, i.e. a few times at startup.
 	      * \note Class is thread-safe.
 		  */
 		class BASE_IMPEXP CClassRegistry
@@ -70,34 +125,34 @@ namespace mrpt
 
 			void Add( const std::string &className, const TRuntimeClassId &id )
 			{
-				m_being_modified=true;
-				{
-					std::unique_lock<std::mutex> lk(m_cs);
-
-					// Sanity check: don't allow registering twice the same class name!
-					const auto it = registeredClasses.find(className);
-					if (it != registeredClasses.cend()) {
-						if (it->second != &id) {
-							std::cerr << mrpt::format("[MRPT class registry] Warning: overwriting already registered className=`%s` with different `TRuntimeClassId`!\n", className.c_str());
-						}
+				std::unique_lock<std::mutex> lk(m_cs);
+
+				// Sanity check: don't allow registering twice the same class name!
+				const auto it = registeredClasses.find(className);
+				if (it != registeredClasses.cend()) {
+					if (it->second != &id) {
+						std::cerr << mrpt::format("[MRPT class registry] Warning: overwriting already registered className=`%s` with different `TRuntimeClassId`!\n", className.c_str());
 					}
-					registeredClasses[className] = &id;
 				}
-				m_being_modified=false;
+				registeredClasses[className] = &id;
+				m_frozen_outdated.store(true, std::memory_order_release);
 			}
 
-			const TRuntimeClassId *Get(const std::string &className)
+			const TRuntimeClassId *Get(const char *className, const size_t len)
 			{
-				// Optimization to avoid the costly lock() in virtually all situations:
-				bool has_to_unlock = false;
-				if (m_being_modified)
+				// Fast path, without locks, for all lookups once all classes are registered:
+				if (!m_frozen_outdated.load(std::memory_order_acquire))
+					return m_frozen.load(std::memory_order_acquire)->find(className,len);
+
+				std::unique_lock<std::mutex> lk(m_cs);
+				if (m_frozen_outdated.load(std::memory_order_relaxed))
 				{
-					m_cs.lock();
-					has_to_unlock = true;
+					// Old snapshots are kept alive, since other threads may still be reading them:
+					m_all_frozen.push_back( std::unique_ptr<TFrozenClassTable>(new TFrozenClassTable(registeredClasses)) );
+					m_frozen.store(m_all_frozen.back().get(), std::memory_order_release);
+					m_frozen_outdated.store(false, std::memory_order_release);
 				}
-				const TRuntimeClassId *ret = registeredClasses[className];
-				if (has_to_unlock) m_cs.unlock();
-				return ret;
+				return m_frozen.load(std::memory_order_relaxed)->find(className,len);
 			}
 
 			std::vector<const TRuntimeClassId*> getListOfAllRegisteredClasses()
@@ -112,7 +167,7 @@ namespace mrpt
 
 		private:
 			// PRIVATE constructor
-			CClassRegistry() : m_being_modified(false)
+			CClassRegistry() : m_frozen(NULL), m_frozen_outdated(true)
 			{
 			}
 			// PRIVATE destructor
@@ -123,7 +178,9 @@ namespace mrpt
 			// initialized before other classes that call it...
 			TClassnameToRuntimeId			registeredClasses;
 			std::mutex        m_cs;
-			std::atomic<bool> m_being_modified;
+			std::atomic<const TFrozenClassTable*> m_frozen;  //!< The current snapshot of registeredClasses
+			std::atomic<bool> m_frozen_outdated;              //!< Set by Add(); m_frozen must be rebuilt before being read
+			std::vector<std::unique_ptr<TFrozenClassTable> > m_all_frozen; //!< Owner of all snapshots built so far
 
 		};
 
@@ -202,5 +259,10 @@ std::vector<const TRuntimeClassId*> utils::getAllRegisteredClassesChildrenOf(con
  ---------------------------------------------------------------*/
 const TRuntimeClassId *mrpt::utils::findRegisteredClass(const std::string &className)
 {
-	return CClassRegistry::Instance().Get( className );
+	return CClassRegistry::Instance().Get( className.c_str(), className.size() );
+}
+
+const TRuntimeClassId *mrpt::utils::findRegisteredClass(const char *className, const size_t classNameLen)
+{
+	return CClassRegistry::Instance().Get( className, classNameLen );
 }
@@ -16,6 +16,7 @@ namespace mrpt
 {
 	namespace utils
 	{
+		struct TRuntimeClassId;
 		typedef void (*TRegisterFunction)(); // A void(void) function
 
 		// Use a queue for the pending register issues, but also an atomic counter, which is much faster to check than a CS.
@@ -23,6 +24,9 @@ namespace mrpt
 		CThreadSafeQueue<TRegisterFunction> BASE_IMPEXP &   pending_class_registers();
 		extern volatile bool BASE_IMPEXP                           pending_class_registers_modified; //!< Set to true if pending_class_registers() has been called after registerAllPendingClasses(). Startup value is false.
 
+		/** Like mrpt::utils::findRegisteredClass(), for a non null-terminated class name. Lock-free once all classes are registered. */
+		const TRuntimeClassId *findRegisteredClass(const char *className, const size_t classNameLen);
+
 	} // End of namespace
 } // End of namespace
 
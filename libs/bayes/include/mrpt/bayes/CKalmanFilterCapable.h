@@ -12,6 +12,7 @@
 #include <mrpt/math/CMatrixFixedNumeric.h>
 #include <mrpt/math/CMatrixTemplateNumeric.h>
 #include <mrpt/math/CArrayNumeric.h>
+#include <mrpt/math/CSparseMatrix.h>
 #include <mrpt/math/num_jacobian.h>
 #include <mrpt/math/utils.h>
 #include <mrpt/math/num_jacobian.h>
@@ -26,7 +27,8 @@
 #include <mrpt/utils/CFileOutputStream.h>
 #include <mrpt/utils/TEnumType.h>
 #include <mrpt/system/vector_loadsave.h>
-
+#include <map>
+#include <memory> // unique_ptr, auto_ptr
 
 namespace mrpt
 {
@@ -41,7 +43,8 @@ namespace mrpt
 			kfEKFNaive = 0,
 			kfEKFAlaDavison,
 			kfIKFFull,
-			kfIKF
+			kfIKF,
+			kfSEIF //!< Sparse Extended Information Filter (only for SLAM problems, FEAT_SIZE>0). See CKalmanFilterCapable
 		};
 
 		// Forward declaration:
@@ -56,6 +59,7 @@ namespace mrpt
 				method      	( kfEKFNaive),
 				verbosity_level (verb_level_ref),
 				IKF_iterations 	( 5 ),
+				SEIF_max_active_landmarks ( 20 ),
 				enable_profiler	(false),
 				use_analytic_transition_jacobian	(true),
 				use_analytic_observation_jacobian	(true),
@@ -69,6 +73,7 @@ namespace mrpt
 				method = iniFile.read_enum<TKFMethod>(section,"method", method );
 				verbosity_level = iniFile.read_enum<mrpt::utils::VerbosityLevel>(section,"verbosity_level", verbosity_level );
 				MRPT_LOAD_CONFIG_VAR( IKF_iterations, int , iniFile, section  );
+				MRPT_LOAD_CONFIG_VAR( SEIF_max_active_landmarks, int , iniFile, section  );
 				MRPT_LOAD_CONFIG_VAR( enable_profiler, bool    , iniFile, section  );
 				MRPT_LOAD_CONFIG_VAR( use_analytic_transition_jacobian, bool    , iniFile, section  );
 				MRPT_LOAD_CONFIG_VAR( use_analytic_observation_jacobian, bool    , iniFile, section  );
@@ -83,6 +88,7 @@ namespace mrpt
 				out.printf("method                                  = %s\n", mrpt::utils::TEnumType<TKFMethod>::value2name(method).c_str() );
 				out.printf("verbosity_level                         = %s\n", mrpt::utils::TEnumType<mrpt::utils::VerbosityLevel>::value2name(verbosity_level).c_str());
 				out.printf("IKF_iterations                          = %i\n", IKF_iterations);
+				out.printf("SEIF_max_active_landmarks               = %i\n", SEIF_max_active_landmarks);
 				out.printf("enable_profiler                         = %c\n", enable_profiler ? 'Y':'N');
 				out.printf("\n");
 			}
@@ -91,6 +97,7 @@ namespace mrpt
 			TKFMethod	method;				//!< The method to employ (default: kfEKFNaive)
 			mrpt::utils::VerbosityLevel & verbosity_level;
 			int 		IKF_iterations;	//!< Number of refinement iterations, only for the IKF method.
+			int 		SEIF_max_active_landmarks; //!< Only for kfSEIF: maximum number of landmarks linked to the vehicle in the information matrix (default=20). Weaker links are removed after each iteration by marginalizing those landmarks out of the vehicle conditional (see CKalmanFilterCapable).
 			bool		enable_profiler;//!< If enabled (default=false), detailed timing information will be dumped to the console thru a CTimerLog at the end of the execution.
 			bool		use_analytic_transition_jacobian;	//!< (default=true) If true, OnTransitionJacobian will be called; otherwise, the Jacobian will be estimated from a numeric approximation by calling several times to OnTransitionModel.
 			bool		use_analytic_observation_jacobian;	//!< (default=true) If true, OnObservationJacobians will be called; otherwise, the Jacobian will be estimated from a numeric approximation by calling several times to OnObservationModel.
@@ -126,6 +133,21 @@ namespace mrpt
 				const typename CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,0 /* FEAT_SIZE=0 */,ACT_SIZE,KFTYPE>::vector_KFArray_OBS & Z,
 				const vector_int       &data_association,
 				const typename CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,0 /* FEAT_SIZE=0 */,ACT_SIZE,KFTYPE>::KFMatrix_OxO		&R);
+
+			/** Owner of the sparse Cholesky factorization of the information matrix in kfSEIF.
+			  * Copies are left empty: the factorization is recomputed on demand. */
+			struct TSEIFCholeskyHolder
+			{
+#if MRPT_HAS_CXX11
+				typedef std::unique_ptr<mrpt::math::CSparseMatrix::CholeskyDecomp> ptr_t;
+#else
+				typedef std::auto_ptr<mrpt::math::CSparseMatrix::CholeskyDecomp> ptr_t;
+#endif
+				ptr_t ptr;
+				TSEIFCholeskyHolder() {}
+				TSEIFCholeskyHolder(const TSEIFCholeskyHolder &) {}
+				TSEIFCholeskyHolder & operator =(const TSEIFCholeskyHolder &) { ptr.reset(); return *this; }
+			};
 		}
 
 
@@ -152,6 +174,18 @@ namespace mrpt
 		 *	- 2008/FEB: All KF classes corrected, reorganized, and rewritten (JLBC).
 		 *	- 2008/MAR: Implemented IKF (JLBC).
 		 *	- 2009/DEC: Totally rewritten as a generic template using fixed-size matrices where possible (JLBC).
+		 *	- 2017: New method kfSEIF.
+		 *
+		 *  With KF_options.method = kfSEIF, SLAM problems are solved with a Sparse Extended Information Filter (after Thrun et al., 2004):
+		 *  the state is kept as a block-sparse information matrix, where landmarks are only linked to the vehicle and to other landmarks
+		 *  observed at the same time, and at most TKF_options::SEIF_max_active_landmarks of them keep a link with the vehicle ("sparsification").
+		 *  Note that the sparsification differs from the one in the paper: instead of conditioning the vehicle on the deactivated landmarks
+		 *  at their mean, it splits the joint as p(x|a) p(m), where "a" are the landmarks that stay active and p(x|a) is obtained by
+		 *  marginalizing the deactivated ones out of the information blocks of the vehicle and of the active and deactivated landmarks.
+		 *  The mean is recovered exactly at each update with a sparse Cholesky factorization (mrpt::math::CSparseMatrix), so the cost of
+		 *  an iteration grows about linearly with the map size instead of quadratically. In this mode, m_pkk only holds the covariance of the
+		 *  vehicle: use getFullCovariance() or getLandmarkCov() for the rest, which are computed from the information matrix.
+		 *  OnPreComputingPredictions() should be implemented to restrict the landmarks to predict, since each one requires recovering its covariance.
 		 *
 		 *  \sa mrpt::slam::CRangeBearingKFSLAM, mrpt::slam::CRangeBearingKFSLAM2D
 	 	 * \ingroup mrpt_bayes_grp
@@ -211,15 +245,26 @@ namespace mrpt
 			  * \exception std::exception On idx>= getNumberOfLandmarksInTheMap()
 			  */
 			inline void getLandmarkCov(size_t idx, KFMatrix_FxF &feat_cov ) const {
-				m_pkk.extractMatrix(VEH_SIZE+idx*FEAT_SIZE,VEH_SIZE+idx*FEAT_SIZE,feat_cov);
+				if (m_pkk.getColCount()==size_t(m_xkk.size()))
+					m_pkk.extractMatrix(VEH_SIZE+idx*FEAT_SIZE,VEH_SIZE+idx*FEAT_SIZE,feat_cov);
+				else
+				{
+					ASSERT_(idx<getNumberOfLandmarksInTheMap())
+					KFMatrix P;
+					seif_marginalCovariance(std::vector<size_t>(1,idx+1),P);
+					feat_cov = P;
+				}
 			}
 
+			/** Returns the covariance of the whole state vector. This is m_pkk, except for kfSEIF, where it is recovered from the information matrix. */
+			void getFullCovariance(KFMatrix &P) const;
+
 		protected:
 			/** @name Kalman filter state
 				@{ */
 
 			KFVector  m_xkk;  //!< The system state vector.
-			KFMatrix  m_pkk;  //!< The system full covariance matrix.
+			KFMatrix  m_pkk;  //!< The system full covariance matrix (only the vehicle part with kfSEIF).
 
 			/** @} */
 
@@ -454,6 +499,8 @@ namespace mrpt
 			CKalmanFilterCapable() : 
 				mrpt::utils::COutputLogger("CKalmanFilterCapable"),
 				KF_options(this->m_min_verbosity_level),
+				m_seif_chol_outdated(true),
+				m_seif_motion_pending(false),
 				m_user_didnt_implement_jacobian(true) 
 			{} //!< Default constructor
 			virtual ~CKalmanFilterCapable() {}  //!< Destructor
@@ -479,6 +526,28 @@ namespace mrpt
 			KFMatrix 				dh_dx_full_obs;
 			KFMatrix				aux_K_dh_dx;
 
+			/** @name kfSEIF state
+				@{ */
+			/** The information matrix, by blocks: m_seif_info[i][j], j>=i, with node 0 being the vehicle and node i>0 the landmark i-1.
+			  * Only the upper triangle is stored, and the landmarks "active" (linked to the vehicle) are the keys of m_seif_info[0]. */
+			std::vector<std::map<size_t,KFMatrix> > m_seif_info;
+			mutable detail::TSEIFCholeskyHolder m_seif_chol; //!< Factorization of the information matrix
+			mutable bool m_seif_chol_outdated; //!< Whether m_seif_chol must be recomputed before using it
+			mutable bool m_seif_motion_pending; //!< If true, m_seif_chol is the factorization from before the last motion, given by m_seif_F and m_seif_Q
+			KFMatrix_VxV m_seif_F, m_seif_Q;
+
+			void seif_prepare(); //!< (Re)builds the information matrix if m_pkk holds the full covariance, and factorizes it if needed
+			void seif_factorize() const;
+			void seif_addToBlock(const size_t i, const size_t j, const KFMatrix &M);
+			void seif_getBlock(const size_t i, const size_t j, KFMatrix &M) const;
+			void seif_motionUpdate(const KFMatrix_VxV &F, const KFMatrix_VxV &Q);
+			void seif_measurementUpdate(const vector_int &data_association, const KFMatrix_OxO &R);
+			void seif_addNewLandmark(const KFMatrix_FxV &dyn_dxv, const KFMatrix_FxF &Rn);
+			void seif_sparsify();
+			/** Marginal covariance of a set of nodes (0:vehicle, i>0: landmark i-1), in the given order. */
+			void seif_marginalCovariance(const std::vector<size_t> &nodes, KFMatrix &P) const;
+			/** @} */
+
 		protected:
 
 			/** The main entry point, executes one complete step: prediction + update.
@@ -519,6 +588,7 @@ namespace mrpt
 				m_map.insert(bayes::kfEKFAlaDavison,     "kfEKFAlaDavison");
 				m_map.insert(bayes::kfIKFFull,           "kfIKFFull");
 				m_map.insert(bayes::kfIKF,               "kfIKF");
+				m_map.insert(bayes::kfSEIF,              "kfSEIF");
 			}
 		};
 	} // End of namespace
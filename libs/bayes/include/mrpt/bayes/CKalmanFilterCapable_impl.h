@@ -27,7 +27,17 @@ namespace mrpt
 			m_timLogger.enable(KF_options.enable_profiler);
 			m_timLogger.enter("KF:complete_step");
 
-			ASSERT_(size_t(m_xkk.size())==m_pkk.getColCount())
+			if (KF_options.method==kfSEIF)
+				seif_prepare();
+			else if (!m_seif_info.empty() && size_t(m_xkk.size())!=m_pkk.getColCount())
+			{	// Coming from kfSEIF: recover the full covariance.
+				KFMatrix P;
+				getFullCovariance(P);
+				m_pkk = P;
+				m_seif_info.clear();
+			}
+
+			ASSERT_(size_t(m_xkk.size())==m_pkk.getColCount() || (KF_options.method==kfSEIF && m_pkk.getColCount()==VEH_SIZE))
 				ASSERT_(size_t(m_xkk.size())>=VEH_SIZE)
 
 				// =============================================================
@@ -112,14 +122,22 @@ namespace mrpt
 				// ====================================
 				//  3.2:  All Pxy_i
 				// ====================================
-				// Now, update the cov. of landmarks, if any:
-				KFMatrix_VxF aux;
-				for (size_t i=0 ; i<N_map ; i++)
+				if (KF_options.method==kfSEIF)
+				{
+					// m_pkk only has Pxx: update the information matrix instead.
+					seif_motionUpdate(dfv_dxv,Q);
+				}
+				else
 				{
-					aux = dfv_dxv * Eigen::Block<typename KFMatrix::Base,VEH_SIZE,FEAT_SIZE>(m_pkk,0,VEH_SIZE+i*FEAT_SIZE);
+					// Now, update the cov. of landmarks, if any:
+					KFMatrix_VxF aux;
+					for (size_t i=0 ; i<N_map ; i++)
+					{
+						aux = dfv_dxv * Eigen::Block<typename KFMatrix::Base,VEH_SIZE,FEAT_SIZE>(m_pkk,0,VEH_SIZE+i*FEAT_SIZE);
 
-					Eigen::Block<typename KFMatrix::Base,VEH_SIZE,FEAT_SIZE>(m_pkk, 0                    , VEH_SIZE+i*FEAT_SIZE) = aux;
-					Eigen::Block<typename KFMatrix::Base,FEAT_SIZE,VEH_SIZE>(m_pkk, VEH_SIZE+i*FEAT_SIZE , 0                   ) = aux.transpose();
+						Eigen::Block<typename KFMatrix::Base,VEH_SIZE,FEAT_SIZE>(m_pkk, 0                    , VEH_SIZE+i*FEAT_SIZE) = aux;
+						Eigen::Block<typename KFMatrix::Base,FEAT_SIZE,VEH_SIZE>(m_pkk, VEH_SIZE+i*FEAT_SIZE , 0                   ) = aux.transpose();
+					}
 				}
 
 				// =============================================================
@@ -292,22 +310,33 @@ namespace mrpt
 
 				if ( FEAT_SIZE>0 )
 				{	// SLAM-like problem:
-					const Eigen::Block<const typename KFMatrix::Base,VEH_SIZE,VEH_SIZE>  Px(m_pkk,0,0);  // Covariance of the vehicle pose
+					// With kfSEIF, recover the covariances of the vehicle and the predicted landmarks only, in this order:
+					const bool is_seif = KF_options.method==kfSEIF;
+					if (is_seif)
+					{
+						std::vector<size_t> nodes(1+N_pred, 0);
+						for (size_t i=0;i<N_pred;++i)
+							nodes[i+1] = predictLMidxs[i]+1;
+						seif_marginalCovariance(nodes, Pkk_subset);
+					}
+					const KFMatrix &P = is_seif ? Pkk_subset : m_pkk;
+
+					const Eigen::Block<const typename KFMatrix::Base,VEH_SIZE,VEH_SIZE>  Px(P,0,0);  // Covariance of the vehicle pose
 
 					for (size_t i=0;i<N_pred;++i)
 					{
-						const size_t lm_idx_i = predictLMidxs[i];
-						const Eigen::Block<const typename KFMatrix::Base,FEAT_SIZE,VEH_SIZE>   Pxyi_t(m_pkk,VEH_SIZE+lm_idx_i*FEAT_SIZE,0);  // Pxyi^t
+						const size_t off_i = VEH_SIZE + (is_seif ? i : predictLMidxs[i])*FEAT_SIZE;
+						const Eigen::Block<const typename KFMatrix::Base,FEAT_SIZE,VEH_SIZE>   Pxyi_t(P,off_i,0);  // Pxyi^t
 
 						// Only do j>=i (upper triangle), since S is symmetric:
 						for (size_t j=i;j<N_pred;++j)
 						{
-							const size_t lm_idx_j = predictLMidxs[j];
+							const size_t off_j = VEH_SIZE + (is_seif ? j : predictLMidxs[j])*FEAT_SIZE;
 							// Sij block:
 							Eigen::Block<typename KFMatrix::Base, OBS_SIZE, OBS_SIZE> Sij(S,OBS_SIZE*i,OBS_SIZE*j);
 
-							const Eigen::Block<const typename KFMatrix::Base,VEH_SIZE,FEAT_SIZE>   Pxyj(m_pkk,0, VEH_SIZE+lm_idx_j*FEAT_SIZE);
-							const Eigen::Block<const typename KFMatrix::Base,FEAT_SIZE,FEAT_SIZE>  Pyiyj(m_pkk,VEH_SIZE+lm_idx_i*FEAT_SIZE,VEH_SIZE+lm_idx_j*FEAT_SIZE);
+							const Eigen::Block<const typename KFMatrix::Base,VEH_SIZE,FEAT_SIZE>   Pxyj(P,0, off_j);
+							const Eigen::Block<const typename KFMatrix::Base,FEAT_SIZE,FEAT_SIZE>  Pyiyj(P,off_i,off_j);
 
 							Sij = Hxs[i] * Px * Hxs[j].transpose()
 								+ Hys[i] * Pxyi_t * Hxs[j].transpose()
@@ -972,6 +1001,13 @@ namespace mrpt
 					}
 					break;
 
+					// --------------------------------------------------------------------
+					// - Sparse Extended Information Filter
+					// --------------------------------------------------------------------
+				case kfSEIF:
+					seif_measurementUpdate(data_association, R);
+					break;
+
 				default:
 					THROW_EXCEPTION("Invalid value of options.KF_method");
 				} // end switch method
@@ -994,6 +1030,15 @@ namespace mrpt
 				m_timLogger.leave("KF:A.add new landmarks");
 			} // end if data_association!=empty
 
+			if (KF_options.method==kfSEIF)
+			{
+				m_timLogger.enter("KF:A.SEIF sparsification");
+				seif_sparsify();
+				// Keep the covariance of the vehicle in m_pkk:
+				seif_marginalCovariance(std::vector<size_t>(1,0), m_pkk);
+				m_timLogger.leave("KF:A.SEIF sparsification");
+			}
+
 			// Post iteration user code:
 			m_timLogger.enter("KF:B.OnPostIteration");
 			OnPostIteration();
@@ -1056,6 +1101,348 @@ namespace mrpt
 		}
 
 
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::getFullCovariance(KFMatrix &P) const
+		{
+			if (m_pkk.getColCount()==size_t(m_xkk.size()))
+			{
+				P = m_pkk;
+				return;
+			}
+			std::vector<size_t> nodes(getNumberOfLandmarksInTheMap()+1);
+			for (size_t i=0;i<nodes.size();i++)
+				nodes[i]=i;
+			seif_marginalCovariance(nodes, P);
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_prepare()
+		{
+			MRPT_START
+			ASSERTMSG_(FEAT_SIZE>0, "kfSEIF is only applicable to SLAM problems (FEAT_SIZE>0)")
+			ASSERT_(KF_options.SEIF_max_active_landmarks>=0)
+
+			const size_t N = m_xkk.size(), N_map = getNumberOfLandmarksInTheMap();
+			if (m_pkk.getColCount()==N)
+			{
+				// m_pkk has the full covariance (first iteration, after a reset, or coming from other method): invert it.
+				// The small regularization allows starting with a zero covariance (a known initial pose).
+				KFMatrix P = m_pkk, Lambda;
+				for (size_t i=0;i<N;i++)
+					P(i,i) += 1e-10;
+				P.inv(Lambda);
+
+				m_seif_info.assign(N_map+1, std::map<size_t,KFMatrix>());
+				for (size_t i=0;i<=N_map;i++)
+				{
+					const size_t off_i = i==0 ? 0 : VEH_SIZE+(i-1)*FEAT_SIZE, size_i = i==0 ? VEH_SIZE : FEAT_SIZE;
+					for (size_t j=i;j<=N_map;j++)
+					{
+						const size_t off_j = j==0 ? 0 : VEH_SIZE+(j-1)*FEAT_SIZE, size_j = j==0 ? VEH_SIZE : FEAT_SIZE;
+						KFMatrix B;
+						Lambda.extractMatrix(off_i,off_j,size_i,size_j,B);
+						if (i==j || B.array().abs().maxCoeff()!=0)
+							m_seif_info[i][j] = B;
+					}
+				}
+				m_seif_chol_outdated = true;
+
+				KFMatrix_VxV Pxx;
+				m_pkk.extractMatrix(0,0,Pxx);
+				m_pkk = Pxx;
+			}
+			else
+			{
+				ASSERT_(m_pkk.getColCount()==VEH_SIZE && m_seif_info.size()==N_map+1)
+			}
+
+			if (!m_seif_chol.ptr.get() || m_seif_chol_outdated || m_seif_motion_pending)
+				seif_factorize();
+			MRPT_END
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_factorize() const
+		{
+			MRPT_START
+			const size_t N = m_xkk.size();
+			ASSERT_(m_seif_info.size()==getNumberOfLandmarksInTheMap()+1)
+
+			// Upper triangle of the information matrix. All the entries of the stored blocks are inserted, even if zero,
+			// so the sparse structure only changes with the links between nodes and the symbolic analysis can be reused.
+			mrpt::math::CSparseMatrix A(N,N);
+			for (size_t i=0;i<m_seif_info.size();i++)
+			{
+				const size_t off_i = i==0 ? 0 : VEH_SIZE+(i-1)*FEAT_SIZE;
+				for (typename std::map<size_t,KFMatrix>::const_iterator it=m_seif_info[i].begin();it!=m_seif_info[i].end();++it)
+				{
+					const size_t j = it->first, off_j = j==0 ? 0 : VEH_SIZE+(j-1)*FEAT_SIZE;
+					const KFMatrix &B = it->second;
+					for (size_t c=0;c<B.getColCount();c++)
+						for (size_t r=0;r<B.getRowCount();r++)
+							if (i!=j || r<=c)
+								A.insert_entry_fast(off_i+r, off_j+c, B.get_unsafe(r,c));
+				}
+			}
+			A.compressFromTriplet();
+
+			if (m_seif_chol.ptr.get())
+				m_seif_chol.ptr->update(A);
+			else m_seif_chol.ptr.reset(new mrpt::math::CSparseMatrix::CholeskyDecomp(A));
+
+			m_seif_chol_outdated = false;
+			m_seif_motion_pending = false;
+			MRPT_END
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_addToBlock(const size_t i, const size_t j, const KFMatrix &M)
+		{
+			const size_t r = std::min(i,j), c = std::max(i,j);
+			typename std::map<size_t,KFMatrix>::iterator it = m_seif_info[r].find(c);
+			if (it==m_seif_info[r].end())
+			{
+				if (i<=j)
+					m_seif_info[r][c] = M;
+				else m_seif_info[r][c] = M.transpose();
+			}
+			else
+			{
+				if (i<=j)
+					it->second += M;
+				else it->second += M.transpose();
+			}
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_getBlock(const size_t i, const size_t j, KFMatrix &M) const
+		{
+			const size_t r = std::min(i,j), c = std::max(i,j);
+			typename std::map<size_t,KFMatrix>::const_iterator it = m_seif_info[r].find(c);
+			if (it==m_seif_info[r].end())
+				M.zeros(i==0 ? VEH_SIZE : FEAT_SIZE, j==0 ? VEH_SIZE : FEAT_SIZE);
+			else if (i<=j)
+				M = it->second;
+			else M = it->second.transpose();
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_motionUpdate(const KFMatrix_VxV &F, const KFMatrix_VxV &Q)
+		{
+			// Information form of x' = F*x + noise(Q), with Sc = Lxx^-1, W = (F*Sc*F^t+Q)^-1 and B_a = F*Sc*Lxa:
+			//  Lx'x' = W ; Lx'a = W*B_a ; Lab += B_a^t*W*B_b - Lax*Sc*Lxb
+			// Only the active landmarks (those linked to the vehicle) are affected.
+			std::map<size_t,KFMatrix> &row0 = m_seif_info[0];
+			const KFMatrix_VxV Lxx = row0[0];
+			const KFMatrix_VxV Sc = Lxx.inverse();
+			const KFMatrix_VxV W = (F*Sc*F.transpose()+Q).inverse();
+
+			std::vector<size_t> active;
+			std::vector<KFMatrix> Lxa, B;
+			for (typename std::map<size_t,KFMatrix>::const_iterator it=row0.begin();it!=row0.end();++it)
+			{
+				if (it->first==0) continue;
+				active.push_back(it->first);
+				Lxa.push_back(it->second);
+				B.push_back(KFMatrix(F*Sc*it->second));
+			}
+
+			for (size_t p=0;p<active.size();p++)
+				for (size_t q=p;q<active.size();q++)
+					seif_addToBlock(active[p],active[q], KFMatrix(B[p].transpose()*W*B[q] - Lxa[p].transpose()*Sc*Lxa[q]));
+
+			row0[0] = W;
+			for (size_t p=0;p<active.size();p++)
+				row0[active[p]] = W*B[p];
+
+			// The current factorization is still useful to recover covariances, applying this motion on top:
+			if (!m_seif_chol.ptr.get() || m_seif_chol_outdated || m_seif_motion_pending)
+				m_seif_chol_outdated = true;
+			else
+			{
+				m_seif_motion_pending = true;
+				m_seif_F = F;
+				m_seif_Q = Q;
+			}
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_measurementUpdate(const vector_int &data_association, const KFMatrix_OxO &R)
+		{
+			MRPT_START
+			m_timLogger.enter("KF:8.update stage:SEIF");
+
+			KFMatrix_OxO R_inv;
+			R.inv(R_inv);
+
+			// L += H^t R^-1 H, and the information vector of the correction: b = H^t R^-1 ytilde
+			KFVector b = KFVector::Zero(m_xkk.size());
+			bool any_update = false;
+			for (size_t i=0;i<data_association.size();i++)
+			{
+				if (data_association[i]<0) continue;
+
+				const size_t lm_idx = static_cast<size_t>(data_association[i]);
+				const size_t idx_in_pred = mrpt::utils::find_in_vector(lm_idx, predictLMidxs);
+				ASSERTMSG_(idx_in_pred!=std::string::npos, "OnPreComputingPredictions() didn't recommend the prediction of a landmark which has been actually observed!")
+
+				const KFMatrix_OxV &Hx = Hxs[idx_in_pred];
+				const KFMatrix_OxF &Hy = Hys[idx_in_pred];
+				const KFMatrix_VxO HxtRi = Hx.transpose()*R_inv;
+				const KFMatrix_FxO HytRi = Hy.transpose()*R_inv;
+
+				KFArray_OBS ytilde = Z[i];
+				OnSubstractObservationVectors(ytilde, all_predictions[lm_idx]);
+
+				seif_addToBlock(0,0, KFMatrix(HxtRi*Hx));
+				seif_addToBlock(0,lm_idx+1, KFMatrix(HxtRi*Hy));
+				seif_addToBlock(lm_idx+1,lm_idx+1, KFMatrix(HytRi*Hy));
+
+				b.segment(0,VEH_SIZE) += HxtRi*ytilde;
+				b.segment(VEH_SIZE+lm_idx*FEAT_SIZE,FEAT_SIZE) += HytRi*ytilde;
+				any_update = true;
+			}
+
+			if (any_update)
+			{
+				// Mean recovery: x += L^-1 b
+				seif_factorize();
+				const Eigen::VectorXd b_d = b.template cast<double>();
+				Eigen::VectorXd dx;
+				m_seif_chol.ptr->backsub(b_d, dx);
+				m_xkk += dx.template cast<KFTYPE>();
+			}
+
+			m_timLogger.leave("KF:8.update stage:SEIF");
+			MRPT_END
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_addNewLandmark(const KFMatrix_FxV &dyn_dxv, const KFMatrix_FxF &Rn)
+		{
+			// yn = y(x,z): Lxx += G^t Rn^-1 G ; Lx,yn = -G^t Rn^-1 ; Lyn,yn = Rn^-1
+			const size_t n = m_seif_info.size();
+			m_seif_info.resize(n+1);
+
+			KFMatrix_FxF Rn_inv;
+			Rn.inv(Rn_inv);
+			const KFMatrix_VxF GtRi = dyn_dxv.transpose()*Rn_inv;
+			seif_addToBlock(0,0, KFMatrix(GtRi*dyn_dxv));
+			seif_addToBlock(0,n, KFMatrix(-GtRi));
+			seif_addToBlock(n,n, KFMatrix(Rn_inv));
+			m_seif_chol_outdated = true;
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_sparsify()
+		{
+			MRPT_START
+			std::map<size_t,KFMatrix> &row0 = m_seif_info[0];
+			const size_t max_active = static_cast<size_t>(KF_options.SEIF_max_active_landmarks);
+			if (row0.size()-1<=max_active)
+				return;
+
+			// Deactivate the landmarks with the weakest links to the vehicle:
+			std::vector<std::pair<KFTYPE,size_t> > links;
+			for (typename std::map<size_t,KFMatrix>::const_iterator it=row0.begin();it!=row0.end();++it)
+				if (it->first!=0)
+					links.push_back(std::make_pair(it->second.norm(), it->first));
+			std::sort(links.begin(),links.end());
+
+			const size_t nD = links.size()-max_active, nA = max_active;
+			std::vector<size_t> nodes(1,0);  // vehicle, kept (a), deactivated (d)
+			for (size_t k=0;k<nA;k++) nodes.push_back(links[nD+k].second);
+			for (size_t k=0;k<nD;k++) nodes.push_back(links[k].second);
+
+			// Dense information matrix of these nodes:
+			const size_t D = VEH_SIZE+FEAT_SIZE*(nA+nD), M = D-VEH_SIZE, Va = VEH_SIZE+FEAT_SIZE*nA, Md = FEAT_SIZE*nD;
+			KFMatrix L(D,D), B;
+			for (size_t p=0;p<nodes.size();p++)
+				for (size_t q=p;q<nodes.size();q++)
+				{
+					const size_t off_p = p==0 ? 0 : VEH_SIZE+(p-1)*FEAT_SIZE, off_q = q==0 ? 0 : VEH_SIZE+(q-1)*FEAT_SIZE;
+					seif_getBlock(nodes[p],nodes[q],B);
+					L.insertMatrix(off_p,off_q,B);
+					if (p!=q) L.insertMatrixTranspose(off_q,off_p,B);
+				}
+
+			// p(x,m) ~= p(x|a) p(m):
+			//  - Marginal of the map: Lmm - Lmx Lxx^-1 Lxm
+			//  - Vehicle conditioned on the kept landmarks only, with "d" marginalized out (Schur complement of Ldd within
+			//    the x,a,d blocks, not Thrun et al.'s conditioning on d at its mean): L1xx, L1xa, and L1ax L1xx^-1 L1xa on "aa".
+			const KFMatrix Lxx_inv = L.block(0,0,VEH_SIZE,VEH_SIZE).inverse();
+			KFMatrix dLmm = -L.block(VEH_SIZE,0,M,VEH_SIZE)*Lxx_inv*L.block(0,VEH_SIZE,VEH_SIZE,M);
+
+			const KFMatrix Ldd_inv = L.block(Va,Va,Md,Md).inverse();
+			const KFMatrix Lxd_Ldd_inv = L.block(0,Va,VEH_SIZE,Md)*Ldd_inv;
+			const KFMatrix L1xx = L.block(0,0,VEH_SIZE,VEH_SIZE) - Lxd_Ldd_inv*L.block(Va,0,Md,VEH_SIZE);
+			const KFMatrix L1xa = L.block(0,VEH_SIZE,VEH_SIZE,Va-VEH_SIZE) - Lxd_Ldd_inv*L.block(Va,VEH_SIZE,Md,Va-VEH_SIZE);
+			dLmm.block(0,0,Va-VEH_SIZE,Va-VEH_SIZE) += L1xa.transpose()*L1xx.inverse()*L1xa;
+
+			for (size_t p=1;p<nodes.size();p++)
+				for (size_t q=p;q<nodes.size();q++)
+				{
+					dLmm.extractMatrix((p-1)*FEAT_SIZE,(q-1)*FEAT_SIZE,FEAT_SIZE,FEAT_SIZE,B);
+					seif_addToBlock(nodes[p],nodes[q],B);
+				}
+
+			row0[0] = L1xx;
+			for (size_t k=0;k<nA;k++)
+			{
+				L1xa.extractMatrix(0,k*FEAT_SIZE,VEH_SIZE,FEAT_SIZE,B);
+				row0[nodes[k+1]] = B;
+			}
+			for (size_t k=0;k<nD;k++)
+				row0.erase(links[k].second);
+
+			m_seif_chol_outdated = true;
+			MRPT_END
+		}
+
+		template <size_t VEH_SIZE, size_t OBS_SIZE, size_t FEAT_SIZE, size_t ACT_SIZE, typename KFTYPE>
+		void CKalmanFilterCapable<VEH_SIZE,OBS_SIZE,FEAT_SIZE,ACT_SIZE,KFTYPE>::seif_marginalCovariance(const std::vector<size_t> &nodes, KFMatrix &P) const
+		{
+			MRPT_START
+			if (!m_seif_chol.ptr.get() || m_seif_chol_outdated)
+				seif_factorize();
+
+			const size_t N = m_xkk.size();
+			std::vector<size_t> idxs;  // Indices in the state vector
+			size_t veh_off = std::string::npos;
+			for (size_t k=0;k<nodes.size();k++)
+			{
+				if (nodes[k]==0) veh_off = idxs.size();
+				const size_t off = nodes[k]==0 ? 0 : VEH_SIZE+(nodes[k]-1)*FEAT_SIZE, len = nodes[k]==0 ? VEH_SIZE : FEAT_SIZE;
+				ASSERT_(off+len<=N)
+				for (size_t i=0;i<len;i++)
+					idxs.push_back(off+i);
+			}
+
+			// Columns of L^-1, by back-substitution of the unit vectors:
+			const size_t M = idxs.size();
+			P.setSize(M,M);
+			std::vector<double> e(N,0.0), col(N);
+			for (size_t c=0;c<M;c++)
+			{
+				e[idxs[c]] = 1;
+				m_seif_chol.ptr->backsub(&e[0],&col[0],N);
+				e[idxs[c]] = 0;
+				for (size_t r=0;r<M;r++)
+					P.get_unsafe(r,c) = col[idxs[r]];
+			}
+
+			// The factorization is from before the last motion: Pxx' = F*Pxx*F^t+Q, Pxy' = F*Pxy
+			if (m_seif_motion_pending && veh_off!=std::string::npos)
+			{
+				const KFMatrix Px_all = m_seif_F*P.block(veh_off,0,VEH_SIZE,M);
+				P.block(veh_off,0,VEH_SIZE,M) = Px_all;
+				P.block(0,veh_off,M,VEH_SIZE) = Px_all.transpose();
+				P.block(veh_off,veh_off,VEH_SIZE,VEH_SIZE) = Px_all.block(0,veh_off,VEH_SIZE,VEH_SIZE)*m_seif_F.transpose() + m_seif_Q;
+			}
+			MRPT_END
+		}
+
+
 		namespace detail
 		{
 			// generic version for SLAM. There is a speciation below for NON-SLAM problems.
@@ -1115,6 +1502,19 @@ namespace mrpt
 						for (q=0;q<FEAT_SIZE;q++)
 							obj.internal_getXkk()[idx+q] = yn[q];
 
+						if (obj.KF_options.method==kfSEIF)
+						{
+							// Covariance of the landmark given the vehicle pose:
+							typename KF::KFMatrix_FxF Rn;
+							if (use_dyn_dhn_jacobian)
+								dyn_dhn.multiply_HCHt(R, Rn);
+							else Rn = dyn_dhn_R_dyn_dhnT;
+							obj.seif_addNewLandmark(dyn_dxv, Rn);
+
+							obj.getProfiler().leave("KF:9.create new LMs");
+							continue;
+						}
+
 						// --------------------
 						// Append to Pkk:
 						// --------------------
@@ -11,6 +11,7 @@
 
 #include <mrpt/utils/utils_defs.h>
 #include <list>
+#include <map>
 
 namespace mrpt
 {
@@ -38,6 +38,7 @@ MRPT_WARNING("Including <mrpt/graphslam.h> makes compilation much slower, consid
 
 // GraphSlamOptimizers
 #include "graphslam/GSO/CLevMarqGSO.h"
+#include "graphslam/GSO/CIncrementalGSO.h"
 
 // Graph SLAM Engine - Relevant headers
 #include "graphslam/misc/CRangeScanRegistrationDecider.h"
@@ -0,0 +1,324 @@
+/* +---------------------------------------------------------------------------+
+	 |                     Mobile Robot Programming Toolkit (MRPT)               |
+	 |                          http://www.mrpt.org/                             |
+	 |                                                                           |
+	 | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+	 | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+	 | Released under BSD License. See details in http://www.mrpt.org/License    |
+	 +---------------------------------------------------------------------------+ */
+
+#ifndef CINCREMENTALGSO_H
+#define CINCREMENTALGSO_H
+
+#include <mrpt/utils/CLoadableOptions.h>
+#include <mrpt/utils/CConfigFile.h>
+#include <mrpt/utils/CConfigFileBase.h>
+#include <mrpt/utils/CStream.h>
+#include <mrpt/utils/CTicTac.h>
+#include <mrpt/utils/types_simple.h>
+#include <mrpt/utils/aligned_containers.h>
+#include <mrpt/opengl/graph_tools.h>
+#include <mrpt/opengl/CRenderizable.h>
+#include <mrpt/utils/TParameters.h>
+
+#include <mrpt/graphslam/types.h>
+#include <mrpt/graphslam/levmarq.h>
+#include <mrpt/graphslam/interfaces/CGraphSlamOptimizer.h>
+
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace mrpt { namespace graphslam { namespace optimizers {
+
+/**\brief Incremental (iSAM-like) non-linear graph slam optimization scheme.
+ *
+ * ## Description
+ *
+ * Unlike CLevMarqGSO, which runs a whole Levenberg-Marquardt optimization
+ * over (part of) the graph every time it is updated, this optimizer keeps the
+ * linearized problem and its sparse Cholesky factorization between calls,
+ * and updates them with the nodes and edges added to the graph since the last
+ * call. The approach follows iSAM2 (Kaess et al., 2012):
+ *
+ * - Every node (except the root, which is fixed) keeps its own linearization
+ *   point and the increment solved for it, and each edge caches its
+ *   contributions to the information matrix and to the gradient evaluated at
+ *   the linearization points of its nodes.
+ * - Only the nodes whose increment exceeds \b relinearize_threshold are
+ *   relinearized ("fluid relinearization"), which only requires re-evaluating
+ *   their edges.
+ * - The block Cholesky factor of the information matrix is kept in the
+ *   natural (insertion) ordering of the nodes, so adding a node and its
+ *   odometry edge only requires recomputing the last rows of the factor.
+ *   In general, only the rows from the oldest node involved in a change
+ *   onwards are recomputed.
+ * - The back-substitution only visits those rows whose solution can change,
+ *   stopping the propagation towards older nodes once the change is below
+ *   \b wildfire_threshold.
+ * - Relinearization steps that increase the error of the affected edges are
+ *   shortened, and the damping of the information matrix is then raised as
+ *   in Levenberg-Marquardt (and lowered again once full steps succeed).
+ *
+ * Hence, for the usual odometry + local constraints the time per update
+ * stays roughly constant regardless of the graph size. A loop closure to a
+ * node much older than the current one, or relinearizing old nodes, requires
+ * refactoring the rows from that node onwards (the Bayes tree reordering of
+ * iSAM2 is not implemented).
+ *
+ * The optimizer assumes that the node poses are only modified by itself once
+ * they have been added to the graph, and that edges are never removed: if
+ * nodes or edges are removed, the incremental state is rebuilt from scratch.
+ * Edges are identified by their pair of nodes and their insertion order among
+ * the edges between the same nodes, so new edges are detected even if others
+ * were removed in the meantime, except if they are between the same nodes.
+ *
+ * ### .ini Configuration Parameters
+ *
+ * \htmlinclude graphslam-engine_config_params_preamble.txt
+ *
+ * - \b class_verbosity
+ *   + \a Section       : OptimizerParameters
+ *   + \a Default value : 1 (LVL_INFO)
+ *   + \a Required      : FALSE
+ *
+ * - \b relinearize_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 0.05
+ *  + \a Required      : FALSE
+ *  + \a Description   : Nodes whose increment (in any of its components, in
+ *  the tangent space of the pose) is larger than this value are relinearized.
+ *
+ * - \b wildfire_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1e-3
+ *  + \a Required      : FALSE
+ *  + \a Description   : The back-substitution does not propagate changes in
+ *  the solution of a node smaller than this value to older nodes.
+ *
+ * - \b iterations_per_update
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Maximum number of relinearization and solution steps
+ *  per call to updateState().
+ *
+ * - \b diagonal_damping
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1e-6
+ *  + \a Required      : FALSE
+ *  + \a Description   : Value added to the diagonal of the information
+ *  matrix, so the problem is well defined even for nodes without edges yet.
+ *
+ * Visualization parameters (section VisualizationParameters) are the same
+ * ones than those of CLevMarqGSO.
+ *
+ * \ingroup mrpt_graphslam_grp
+ */
+template<class GRAPH_t=typename mrpt::graphs::CNetworkOfPoses2DInf>
+class CIncrementalGSO:
+	public mrpt::graphslam::optimizers::CGraphSlamOptimizer<GRAPH_t>
+{
+	public:
+		// Public methods
+		//////////////////////////////////////////////////////////////
+
+		typedef typename GRAPH_t::constraint_t constraint_t;
+		typedef typename GRAPH_t::constraint_t::type_value pose_t; // type of underlying poses (2D/3D)
+		typedef mrpt::graphslam::graphslam_traits<GRAPH_t> gst;
+
+		CIncrementalGSO();
+		~CIncrementalGSO();
+		void initCIncrementalGSO();
+
+		bool updateState( mrpt::obs::CActionCollectionPtr action,
+				mrpt::obs::CSensoryFramePtr observations,
+				mrpt::obs::CObservationPtr observation );
+
+		void setGraphPtr(GRAPH_t* graph);
+		void setWindowManagerPtr(mrpt::graphslam::CWindowManager* win_manager);
+		void setCriticalSectionPtr(mrpt::synch::CCriticalSection* graph_section);
+		void initializeVisuals();
+		void updateVisuals();
+		/**\brief Get a list of the window events that happened since the last
+		 * call.
+		 */
+		void notifyOfWindowEvents(const std::map<std::string, bool>& events_occurred);
+		/**\brief Struct for holding the optimization-related variables in a
+		 * compact form
+		 */
+		struct OptimizationParams: public mrpt::utils::CLoadableOptions {
+			public:
+				OptimizationParams();
+				~OptimizationParams();
+
+				void loadFromConfigFile(
+						const mrpt::utils::CConfigFileBase &source,
+						const std::string &section);
+				void 	dumpToTextStream(mrpt::utils::CStream &out) const;
+
+				double relinearize_threshold;
+				double wildfire_threshold;
+				int iterations_per_update;
+				double diagonal_damping;
+		};
+
+		void loadParams(const std::string& source_fname);
+		void printParams() const;
+
+		/**\brief struct for holding the graph visualization-related variables in a
+		 * compact form
+		 */
+		struct GraphVisualizationParams: public mrpt::utils::CLoadableOptions {
+			public:
+				GraphVisualizationParams();
+				~GraphVisualizationParams();
+
+				void loadFromConfigFile(
+						const mrpt::utils::CConfigFileBase &source,
+						const std::string &section);
+				void dumpToTextStream(mrpt::utils::CStream &out) const;
+
+				mrpt::utils::TParametersDouble cfg;
+				bool visualize_optimized_graph;
+				// textMessage parameters
+				std::string keystroke_graph_toggle; // see Ctor for initialization
+				std::string keystroke_graph_autofit; // see Ctor for initialization
+				int text_index_graph;
+				double offset_y_graph;
+		};
+		void getDescriptiveReport(std::string* report_str) const;
+
+		/**\brief Drops all the incremental state, so the next update
+		 * relinearizes and factors the whole graph again.
+		 */
+		void resetState();
+		/**\brief Sum of the squared errors of the edges, evaluated at the
+		 * linearization points (i.e. as seen by the optimizer).
+		 */
+		double getLinearizedSquareError() const;
+
+		// Public members
+		// ////////////////////////////
+		OptimizationParams opt_params; /**<Parameters relevant to the optimization of the graph. */
+		GraphVisualizationParams viz_params; /**<Parameters relevant to the visualization of the graph. */
+
+	private:
+		typedef typename gst::matrix_VxV_t block_t;
+		typedef typename gst::Array_O array_t;
+		typedef typename mrpt::aligned_containers<size_t,block_t>::map_t block_row_t;
+		enum { DIMS_POSE = gst::SE_TYPE::VECTOR_SIZE };
+
+		/**\brief Linearization of an edge at the linearization points of its
+		 * nodes.
+		 *
+		 * var1 and var2 are the indices of the variables for the edge nodes
+		 * (std::string::npos for the root). H12 is the block J1^t * Inf * J2,
+		 * i.e. row var1, column var2 of the information matrix.
+		 */
+		struct TEdgeLinearization {
+			typename gst::edge_const_iterator edge;
+			size_t var1, var2;
+			block_t H11, H22, H12;
+			array_t g1, g2;
+			double sq_error;
+		};
+		/**\brief One block row of the Cholesky factor: column indices (sorted)
+		 * and their blocks.
+		 */
+		struct TFactorRow {
+			std::vector<size_t> cols;
+			typename mrpt::aligned_containers<block_t>::vector_t blocks;
+		};
+
+		// Private methods
+		// ////////////////////////////
+
+		void optimizeGraph();
+		/**\brief Registers the nodes and edges added to the graph since the last
+		 * call. The variables whose rows of the information matrix changed are
+		 * appended to \a affected_vars.
+		 */
+		void registerNewNodesAndEdges(std::vector<size_t> &affected_vars);
+		/**\brief Relinearizes the variables whose increment exceeds the
+		 * threshold, shortening the step if it increases the error of their edges.
+		 * \return The number of relinearized variables
+		 */
+		size_t relinearizeVariables(std::vector<size_t> &affected_vars);
+		void linearizeEdge(TEdgeLinearization &e) const;
+		/**\brief Residual P1 (+) EDGE (+) inv(P2) of an edge at the current
+		 * linearization points, and its error vector */
+		void computeEdgeResidual(const TEdgeLinearization &e,
+				pose_t &P1DP2inv, array_t &err) const;
+		/**\brief Updates the rows of the factor, the forward substitution and
+		 * (partially) the back-substitution, starting from the oldest of the
+		 * affected variables, and writes the new estimates to the graph.
+		 */
+		void updateFactorizationAndSolve(std::vector<size_t> &affected_vars);
+		void rebuildInformationRow(size_t k);
+		void computeFactorRow(size_t k);
+		/**\brief Solves for the increment of variable k given those of the newer
+		 * ones
+		 * \return The maximum absolute change in its components
+		 */
+		double backSubstituteVariable(size_t k);
+		const pose_t & getFixedOrLinPose(size_t var) const;
+
+		void initGraphVisualization();
+		inline void updateGraphVisualization();
+		void toggleGraphVisualization();
+		inline void fitGraphInView();
+
+		// Private members
+		//////////////////////////////////////////////////////////////
+		GRAPH_t* m_graph; /**<\brief Pointer to the graph under construction */
+		mrpt::gui::CDisplayWindow3D* m_win;
+		mrpt::graphslam::CWindowManager* m_win_manager;
+		mrpt::graphslam::CWindowObserver* m_win_observer;
+		mrpt::synch::CCriticalSection* m_graph_section;
+
+		bool m_initialized_visuals;
+		bool m_has_read_config;
+		bool m_autozoom_active;
+
+		/**\name Incremental state of the optimizer
+		 * Variables are indexed in the order in which nodes were added.
+		 * @{ */
+		std::map<mrpt::utils::TNodeID, size_t> m_node_to_var;
+		std::vector<mrpt::utils::TNodeID> m_var_to_node;
+		mrpt::utils::TNodeID m_root; //!< Root node when the state was built
+		typename mrpt::aligned_containers<pose_t>::vector_t m_x_lin; //!< Linearization points
+		typename mrpt::aligned_containers<array_t>::vector_t m_delta; //!< Current solution: estimate = exp(-delta) (+) x_lin
+		std::vector<std::vector<size_t> > m_var_edges; //!< Indices in m_edges of the edges of each variable
+
+		typename mrpt::aligned_containers<TEdgeLinearization>::vector_t m_edges;
+		std::map<mrpt::utils::TPairNodeIDs, size_t> m_known_edges; //!< Number of edges already in m_edges (or ignored), per (from,to) pair: always the first ones of the pair in the graph multimap
+		size_t m_num_known_edges; //!< Sum of all counts in m_known_edges
+
+		std::vector<block_row_t> m_H; //!< Lower block triangle of the information matrix, by rows
+		typename mrpt::aligned_containers<array_t>::vector_t m_g; //!< Gradient
+		std::vector<TFactorRow> m_L; //!< Strictly lower part of the Cholesky factor, by rows
+		typename mrpt::aligned_containers<block_t>::vector_t m_L_diag_inv; //!< Inverses of the diagonal blocks of the factor
+		std::vector<std::vector<std::pair<size_t,size_t> > > m_L_col_rows; //!< (row, index in row) of the nonzero blocks of each column of the factor
+		std::vector<size_t> m_etree_parent; //!< Elimination tree
+		std::vector<size_t> m_etree_mark;
+		size_t m_etree_stamp;
+		typename mrpt::aligned_containers<array_t>::vector_t m_y; //!< Solution of the forward substitution
+		std::vector<size_t> m_last_updated_vars; //!< Nodes back-substituted in the last solution
+		std::set<size_t> m_relin_candidates; //!< Nodes whose increment is above relinearize_threshold
+		double m_lambda; //!< Levenberg-Marquardt damping, raised when relinearization steps must be shortened
+
+		size_t m_last_num_refactored_rows;
+		size_t m_last_num_backsubstituted_vars;
+		size_t m_last_num_relinearized_vars;
+		/** @} */
+
+		mrpt::utils::CTimeLogger m_time_logger; /**<Time logger instance */
+};
+
+} } } // end of namespaces
+
+#include "CIncrementalGSO_impl.h"
+
+#endif /* end of include guard: CINCREMENTALGSO_H */
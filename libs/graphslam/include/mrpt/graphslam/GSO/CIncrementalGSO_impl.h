@@ -0,0 +1,1035 @@
+/* +---------------------------------------------------------------------------+
+	 |                     Mobile Robot Programming Toolkit (MRPT)               |
+	 |                          http://www.mrpt.org/                             |
+	 |                                                                           |
+	 | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+	 | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+	 | Released under BSD License. See details in http://www.mrpt.org/License    |
+	 +---------------------------------------------------------------------------+ */
+
+#ifndef CINCREMENTALGSO_IMPL_H
+#define CINCREMENTALGSO_IMPL_H
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace mrpt { namespace graphslam { namespace optimizers {
+
+// Ctors, Dtors
+//////////////////////////////////////////////////////////////
+
+template<class GRAPH_t>
+CIncrementalGSO<GRAPH_t>::CIncrementalGSO()
+{
+	MRPT_START;
+
+	this->initCIncrementalGSO();
+
+	MRPT_END;
+}
+template<class GRAPH_t>
+CIncrementalGSO<GRAPH_t>::~CIncrementalGSO() {
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::initCIncrementalGSO() {
+	MRPT_START;
+
+	m_graph = NULL;
+	m_win = NULL;
+	m_win_manager = NULL;
+	m_win_observer = NULL;
+	m_graph_section = NULL;
+
+	m_initialized_visuals = false;
+	m_has_read_config = false;
+	m_autozoom_active = true;
+
+	this->resetState();
+
+	this->setLoggerName("CIncrementalGSO");
+	this->logging_enable_keep_record = true;
+
+	MRPT_END;
+}
+
+// Member function implementations
+//////////////////////////////////////////////////////////////
+template<class GRAPH_t>
+bool CIncrementalGSO<GRAPH_t>::updateState(
+		mrpt::obs::CActionCollectionPtr action,
+		mrpt::obs::CSensoryFramePtr observations,
+		mrpt::obs::CObservationPtr observation ) {
+	MRPT_START;
+	MRPT_UNUSED_PARAM(action); MRPT_UNUSED_PARAM(observations); MRPT_UNUSED_PARAM(observation);
+	this->logFmt(mrpt::utils::LVL_DEBUG, "In updateOptimizerState... ");
+	ASSERTMSG_(m_graph, "No graph was given, see setGraphPtr()");
+
+	// The engine already holds the graph lock while calling this method:
+	this->optimizeGraph();
+
+	return true;
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::setGraphPtr(GRAPH_t* graph) {
+	MRPT_START;
+
+	m_graph = graph;
+	this->resetState();
+
+	this->logFmt(mrpt::utils::LVL_DEBUG, "Fetched the graph successfully");
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::setWindowManagerPtr(
+		mrpt::graphslam::CWindowManager* win_manager) {
+	MRPT_START;
+	ASSERT_(win_manager);
+
+	m_win_manager = win_manager;
+	if (m_win_manager) {
+		m_win = m_win_manager->win;
+
+		m_win_observer = m_win_manager->observer;
+	}
+	this->logFmt(mrpt::utils::LVL_DEBUG, "Fetched the CDisplayWindow successfully");
+
+	MRPT_END;
+}
+
+template <class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::setCriticalSectionPtr(
+		mrpt::synch::CCriticalSection* graph_section) {
+	MRPT_START;
+
+	m_graph_section = graph_section;
+
+	this->logFmt(mrpt::utils::LVL_DEBUG, "Fetched the CCRiticalSection successfully");
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::initializeVisuals() {
+	MRPT_START;
+	ASSERT_(m_win_manager);
+	this->logFmt(mrpt::utils::LVL_DEBUG, "Initializing visuals");
+
+	ASSERTMSG_(m_win,
+			"Visualization of data was requested but no CDisplayWindow3D pointer "
+			" was given.");
+	ASSERT_(m_has_read_config);
+
+	this->initGraphVisualization();
+
+	m_initialized_visuals = true;
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::updateVisuals() {
+	MRPT_START;
+	ASSERTMSG_(m_win_manager, "No CWindowManager* is given");
+	ASSERT_(m_initialized_visuals);
+	ASSERTMSG_(m_win,
+			"Visualization of data was requested but no CDisplayWindow3D pointer was given.");
+
+	this->updateGraphVisualization();
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::notifyOfWindowEvents(
+		const std::map<std::string, bool>& events_occurred)
+{
+	MRPT_START;
+	ASSERTMSG_(m_win_manager, "No CWindowManager* is given");
+
+	// graph toggling
+	if (events_occurred.find(viz_params.keystroke_graph_toggle)->second) {
+		this->toggleGraphVisualization();
+	}
+
+	// if mouse event, let the user decide about the camera
+	if (events_occurred.find("mouse_clicked")->second) {
+		MRPT_LOG_DEBUG_STREAM( "Mouse was clicked. Disabling autozoom.");
+		m_autozoom_active = false;
+	}
+
+	// autofit the graph once
+	if (events_occurred.find(viz_params.keystroke_graph_autofit)->second) {
+		MRPT_LOG_DEBUG_STREAM( "Autofit button was pressed");
+		this->fitGraphInView();
+	}
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::initGraphVisualization() {
+	MRPT_START;
+	ASSERTMSG_(m_win_manager, "No CWindowManager* is given");
+
+	if (viz_params.visualize_optimized_graph) {
+		m_win_observer->registerKeystroke(viz_params.keystroke_graph_toggle,
+				"Toggle Graph visualization");
+		m_win_observer->registerKeystroke(viz_params.keystroke_graph_autofit,
+				"Fit Graph in view");
+
+		m_win_manager->assignTextMessageParameters(
+				/* offset_y*	= */ &viz_params.offset_y_graph,
+				/* text_index* = */ &viz_params.text_index_graph );
+	}
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+inline void CIncrementalGSO<GRAPH_t>::updateGraphVisualization() {
+	MRPT_START;
+	ASSERTMSG_(m_win_manager, "No CWindowManager* is given");
+	using namespace mrpt::opengl;
+	using namespace mrpt::utils;
+
+	this->logFmt(mrpt::utils::LVL_DEBUG, "In the updateGraphVisualization function");
+
+	// update the graph (clear and rewrite..)
+	COpenGLScenePtr& scene = m_win->get3DSceneAndLock();
+
+	// remove previous graph and insert the new instance
+	CRenderizablePtr prev_object = scene->getByName("optimized_graph");
+	bool prev_visibility = true;
+	if (prev_object) { // set the visibility of the graph correctly
+		prev_visibility = prev_object->isVisible();
+	}
+	scene->removeObject(prev_object);
+
+	CSetOfObjectsPtr graph_obj =
+		graph_tools::graph_visualize(*m_graph, viz_params.cfg);
+	graph_obj->setName("optimized_graph");
+	graph_obj->setVisibility(prev_visibility);
+	scene->insert(graph_obj);
+	m_win->unlockAccess3DScene();
+
+	m_win_manager->addTextMessage(5,-viz_params.offset_y_graph,
+			format("Optimized Graph: #nodes %d",
+				static_cast<int>(m_graph->nodeCount())),
+			TColorf(0.0, 0.0, 0.0),
+			/* unique_index = */ viz_params.text_index_graph);
+
+	m_win->forceRepaint();
+
+	if (m_autozoom_active) {
+		this->fitGraphInView();
+	}
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::toggleGraphVisualization() {
+	MRPT_START;
+	using namespace mrpt::opengl;
+
+	COpenGLScenePtr& scene = m_win->get3DSceneAndLock();
+
+	CRenderizablePtr graph_obj = scene->getByName("optimized_graph");
+	graph_obj->setVisibility(!graph_obj->isVisible());
+
+	m_win->unlockAccess3DScene();
+	m_win->forceRepaint();
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::fitGraphInView() {
+	MRPT_START;
+	using namespace mrpt::opengl;
+
+	ASSERTMSG_(m_win,
+			"\nVisualization of data was requested but no CDisplayWindow3D pointer was given\n");
+
+	// first fetch the graph object
+	COpenGLScenePtr& scene = m_win->get3DSceneAndLock();
+	CRenderizablePtr obj = scene->getByName("optimized_graph");
+	CSetOfObjectsPtr graph_obj = static_cast<CSetOfObjectsPtr>(obj);
+	m_win->unlockAccess3DScene();
+	m_win->forceRepaint();
+
+	// autofit it based on its grid
+	CGridPlaneXYPtr obj_grid = graph_obj->CSetOfObjects::getByClass<CGridPlaneXY>();
+	if (obj_grid) {
+		float x_min,x_max, y_min,y_max;
+		obj_grid->getPlaneLimits(x_min,x_max, y_min,y_max);
+		const float z_min = obj_grid->getPlaneZcoord();
+		m_win->setCameraPointingToPoint( 0.5*(x_min+x_max), 0.5*(y_min+y_max), z_min );
+		m_win->setCameraZoom( 2.0f * std::max(10.0f, std::max(x_max-x_min, y_max-y_min) ) );
+	}
+	m_win->setCameraAzimuthDeg(60);
+	m_win->setCameraElevationDeg(75);
+	m_win->setCameraProjective(true);
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::resetState() {
+	m_node_to_var.clear();
+	m_var_to_node.clear();
+	m_root = INVALID_NODEID;
+	m_x_lin.clear();
+	m_delta.clear();
+	m_var_edges.clear();
+	m_edges.clear();
+	m_known_edges.clear();
+	m_num_known_edges = 0;
+	m_H.clear();
+	m_g.clear();
+	m_L.clear();
+	m_L_diag_inv.clear();
+	m_L_col_rows.clear();
+	m_etree_parent.clear();
+	m_etree_mark.clear();
+	m_etree_stamp = 0;
+	m_y.clear();
+	m_last_updated_vars.clear();
+	m_relin_candidates.clear();
+	m_lambda = 0;
+	m_last_num_refactored_rows = 0;
+	m_last_num_backsubstituted_vars = 0;
+	m_last_num_relinearized_vars = 0;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::optimizeGraph() {
+	MRPT_START;
+	m_time_logger.enter("CIncrementalGSO::optimizeGraph");
+
+	// Start over if the graph is not the one the state was built for:
+	if (m_root!=INVALID_NODEID &&
+			(m_root!=m_graph->root ||
+			 m_graph->nodeCount()<m_var_to_node.size()+1 ||
+			 m_graph->edgeCount()<m_num_known_edges) ) {
+		this->logFmt(mrpt::utils::LVL_WARN,
+				"The graph shrank or its root changed: rebuilding the incremental state.");
+		this->resetState();
+	}
+
+	std::vector<size_t> affected_vars;
+	m_time_logger.enter("CIncrementalGSO::registerNewNodesAndEdges");
+	this->registerNewNodesAndEdges(affected_vars);
+	m_time_logger.leave("CIncrementalGSO::registerNewNodesAndEdges");
+
+	m_last_num_relinearized_vars = 0;
+	m_last_num_refactored_rows = 0;
+	m_last_num_backsubstituted_vars = 0;
+	for (int iter=0; iter<std::max(1,opt_params.iterations_per_update); iter++) {
+		m_time_logger.enter("CIncrementalGSO::relinearize");
+		m_last_num_relinearized_vars += this->relinearizeVariables(affected_vars);
+		m_time_logger.leave("CIncrementalGSO::relinearize");
+
+		if (affected_vars.empty())
+			break; // Nothing changed
+
+		m_time_logger.enter("CIncrementalGSO::updateFactorizationAndSolve");
+		this->updateFactorizationAndSolve(affected_vars);
+		m_time_logger.leave("CIncrementalGSO::updateFactorizationAndSolve");
+		affected_vars.clear();
+	}
+
+	this->logFmt(mrpt::utils::LVL_DEBUG,
+			"Relinearized %u nodes, refactored %u rows, back-substituted %u nodes",
+			static_cast<unsigned int>(m_last_num_relinearized_vars),
+			static_cast<unsigned int>(m_last_num_refactored_rows),
+			static_cast<unsigned int>(m_last_num_backsubstituted_vars));
+
+	m_time_logger.leave("CIncrementalGSO::optimizeGraph");
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::registerNewNodesAndEdges(
+		std::vector<size_t> &affected_vars) {
+	MRPT_START;
+	using namespace mrpt::utils;
+	typedef typename GRAPH_t::global_poses_t::const_iterator node_iterator;
+
+	if (m_root==INVALID_NODEID) {
+		ASSERTMSG_(m_graph->nodes.find(m_graph->root)!=m_graph->nodes.end(),
+				"The root node has no global pose in the graph");
+		m_root = m_graph->root;
+	}
+
+	// New nodes: usually, they have larger IDs than the known ones.
+	if (m_graph->nodeCount()!=m_var_to_node.size()+1) {
+		node_iterator it_node = m_graph->nodes.begin();
+		if (!m_node_to_var.empty()) {
+			// Right after the largest known ID:
+			it_node = m_graph->nodes.find(m_node_to_var.rbegin()->first);
+			ASSERT_(it_node!=m_graph->nodes.end());
+			++it_node;
+			const size_t num_unknown = m_graph->nodeCount()-m_var_to_node.size()-1;
+			if (static_cast<size_t>(std::distance(it_node,
+							static_cast<node_iterator>(m_graph->nodes.end())))!=num_unknown)
+				it_node = m_graph->nodes.begin(); // Not only at the end: full scan
+		}
+		for (; it_node!=m_graph->nodes.end(); ++it_node) {
+			if (it_node->first==m_root ||
+					m_node_to_var.find(it_node->first)!=m_node_to_var.end())
+				continue;
+
+			const size_t k = m_var_to_node.size();
+			m_node_to_var[it_node->first] = k;
+			m_var_to_node.push_back(it_node->first);
+			m_x_lin.push_back(it_node->second);
+			array_t zero;
+			zero.setZero();
+			m_delta.push_back(zero);
+			m_g.push_back(zero);
+			m_y.push_back(zero);
+			m_var_edges.push_back(std::vector<size_t>());
+			m_H.push_back(block_row_t());
+			affected_vars.push_back(k);
+		}
+	}
+
+	// New edges: the edges of each (from,to) pair beyond the number of those
+	// already known. Edges with the same pair of nodes keep their insertion
+	// order in the multimap, so the known ones are always the first ones of
+	// each pair, and an edge is identified by its pair and its position among
+	// them. Both containers are sorted by (from,to): they are walked together.
+	typedef std::map<TPairNodeIDs,size_t>::iterator known_iterator;
+	typename gst::edge_const_iterator it = m_graph->edges.begin();
+	known_iterator it_known = m_known_edges.begin();
+	bool graph_changed = false;
+	while (it!=m_graph->edges.end()) {
+		const TPairNodeIDs key = it->first;
+		while (it_known!=m_known_edges.end() && it_known->first<key) {
+			++it_known;
+			graph_changed = true; // Known edges which are no longer in the graph
+		}
+		size_t num_known = (it_known!=m_known_edges.end() && it_known->first==key) ?
+			it_known->second : 0;
+
+		for (; it!=m_graph->edges.end() && it->first==key; ++it) {
+			if (num_known) {
+				num_known--;
+				continue;
+			}
+
+			const TNodeID from = key.first;
+			const TNodeID to = it->first.second;
+			std::map<TNodeID,size_t>::const_iterator it_v1 = m_node_to_var.find(from);
+			std::map<TNodeID,size_t>::const_iterator it_v2 = m_node_to_var.find(to);
+			if ((it_v1==m_node_to_var.end() && from!=m_root) ||
+					(it_v2==m_node_to_var.end() && to!=m_root))
+				continue; // Its nodes have no pose yet: try again in the next call
+
+			if (it_known==m_known_edges.end() || it_known->first!=key)
+				it_known = m_known_edges.insert(it_known, std::make_pair(key,size_t(0)));
+			it_known->second++;
+			m_num_known_edges++;
+			if (from==to || (from==m_root && to==m_root))
+				continue; // Nothing to optimize here
+
+			TEdgeLinearization e;
+			e.edge = it;
+			e.var1 = it_v1!=m_node_to_var.end() ? it_v1->second : std::string::npos;
+			e.var2 = it_v2!=m_node_to_var.end() ? it_v2->second : std::string::npos;
+			this->linearizeEdge(e);
+
+			const size_t edge_idx = m_edges.size();
+			m_edges.push_back(e);
+			if (e.var1!=std::string::npos) {
+				m_var_edges[e.var1].push_back(edge_idx);
+				affected_vars.push_back(e.var1);
+			}
+			if (e.var2!=std::string::npos) {
+				m_var_edges[e.var2].push_back(edge_idx);
+				affected_vars.push_back(e.var2);
+			}
+		}
+		if (num_known)
+			graph_changed = true; // Fewer edges than known for this pair
+		if (it_known!=m_known_edges.end() && it_known->first==key)
+			++it_known;
+	}
+	if (it_known!=m_known_edges.end())
+		graph_changed = true; // Known pairs after the last one in the graph
+
+	if (graph_changed) {
+		this->logFmt(mrpt::utils::LVL_WARN,
+				"Edges were removed from the graph: rebuilding the incremental state.");
+		this->resetState();
+		affected_vars.clear();
+		this->registerNewNodesAndEdges(affected_vars);
+	}
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+size_t CIncrementalGSO<GRAPH_t>::relinearizeVariables(
+		std::vector<size_t> &affected_vars) {
+	MRPT_START;
+
+	// The back-substitution keeps track of the nodes above the threshold:
+	const std::vector<size_t> relin_vars(m_relin_candidates.begin(), m_relin_candidates.end());
+	m_relin_candidates.clear();
+	if (relin_vars.empty())
+		return 0;
+
+	std::set<size_t> relin_edges;
+	for (size_t i=0; i<relin_vars.size(); i++) {
+		const std::vector<size_t> &edges = m_var_edges[relin_vars[i]];
+		relin_edges.insert(edges.begin(), edges.end());
+	}
+	double old_error = 0;
+	for (std::set<size_t>::const_iterator it=relin_edges.begin(); it!=relin_edges.end(); ++it)
+		old_error += m_edges[*it].sq_error;
+
+	// x_lin <- exp(-step*delta) (+) x_lin, and thus delta <- 0. Full
+	// Gauss-Newton steps may increase the error after large corrections (e.g.
+	// loop closures), so the step is halved until the error of the edges of
+	// the relinearized variables does not grow (backtracking line search):
+	const int max_step_halvings = 6;
+	typename mrpt::aligned_containers<pose_t>::vector_t old_x_lin(relin_vars.size());
+	for (size_t i=0; i<relin_vars.size(); i++)
+		old_x_lin[i] = m_x_lin[relin_vars[i]];
+	double step = 1.0;
+	for (int trial=0; ; trial++) {
+		for (size_t i=0; i<relin_vars.size(); i++) {
+			const size_t k = relin_vars[i];
+			array_t exp_delta;
+			for (size_t d=0; d<DIMS_POSE; d++)
+				exp_delta[d] = -step*m_delta[k][d];
+			pose_t exp_delta_pose(mrpt::poses::UNINITIALIZED_POSE);
+			gst::SE_TYPE::exp(exp_delta, exp_delta_pose);
+			m_x_lin[k].composeFrom(exp_delta_pose, old_x_lin[i]);
+		}
+		if (trial==max_step_halvings)
+			break;
+
+		double new_error = 0;
+		for (std::set<size_t>::const_iterator it=relin_edges.begin(); it!=relin_edges.end(); ++it) {
+			pose_t P1DP2inv(mrpt::poses::UNINITIALIZED_POSE);
+			array_t err;
+			this->computeEdgeResidual(m_edges[*it], P1DP2inv, err);
+			new_error += err.squaredNorm();
+		}
+		if (new_error<=old_error)
+			break;
+		step *= 0.5;
+	}
+
+	// Adapt the damping as Levenberg-Marquardt does, so the next solutions
+	// take shorter steps if the linear model was not good enough. Changing it
+	// requires rebuilding all the rows:
+	const double old_lambda = m_lambda;
+	if (step<1.0) {
+		double max_diag = 0;
+		for (size_t i=0; i<relin_vars.size(); i++) {
+			const block_t &H_kk = m_H[relin_vars[i]].find(relin_vars[i])->second;
+			for (size_t d=0; d<DIMS_POSE; d++)
+				max_diag = std::max(max_diag, H_kk(d,d));
+		}
+		m_lambda = std::max(10*m_lambda, 1e-3*max_diag);
+		this->logFmt(mrpt::utils::LVL_DEBUG,
+				"Relinearization step shortened to %g, damping raised to %e",
+				step, m_lambda);
+	}
+	else if (m_lambda>0) {
+		m_lambda *= 0.1;
+		if (m_lambda < 1e-6)
+			m_lambda = 0;
+	}
+	if (m_lambda!=old_lambda)
+		for (size_t k=0; k<m_var_to_node.size(); k++)
+			affected_vars.push_back(k);
+
+	for (size_t i=0; i<relin_vars.size(); i++) {
+		m_delta[relin_vars[i]].setZero();
+		affected_vars.push_back(relin_vars[i]);
+	}
+	// Relinearize the edges of those variables, just once each:
+	for (std::set<size_t>::const_iterator it=relin_edges.begin(); it!=relin_edges.end(); ++it) {
+		TEdgeLinearization &e = m_edges[*it];
+		this->linearizeEdge(e);
+		if (e.var1!=std::string::npos) affected_vars.push_back(e.var1);
+		if (e.var2!=std::string::npos) affected_vars.push_back(e.var2);
+	}
+
+	return relin_vars.size();
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+const typename CIncrementalGSO<GRAPH_t>::pose_t &
+CIncrementalGSO<GRAPH_t>::getFixedOrLinPose(size_t var) const {
+	if (var!=std::string::npos)
+		return m_x_lin[var];
+	return m_graph->nodes.find(m_root)->second;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::computeEdgeResidual(
+		const TEdgeLinearization &e, pose_t &P1DP2inv, array_t &err) const {
+	typedef mrpt::graphslam::detail::AuxErrorEval<typename gst::edge_t,gst> aux_t;
+
+	// Residual pose error P1DP2inv = P1 (+) EDGE (+) inv(P2), as in
+	// optimize_graph_spa_levmarq():
+	const pose_t &P1 = this->getFixedOrLinPose(e.var1);
+	const pose_t &P2 = this->getFixedOrLinPose(e.var2);
+	pose_t P1D(mrpt::poses::UNINITIALIZED_POSE);
+	P1D.composeFrom(P1, e.edge->second.getPoseMean());
+	const pose_t P2inv = -P2;
+	P1DP2inv.composeFrom(P1D, P2inv);
+	aux_t::computePseudoLnError(P1DP2inv, err, e.edge);
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::linearizeEdge(TEdgeLinearization &e) const {
+	typedef mrpt::graphslam::detail::AuxErrorEval<typename gst::edge_t,gst> aux_t;
+
+	pose_t P1DP2inv(mrpt::poses::UNINITIALIZED_POSE);
+	array_t err;
+	this->computeEdgeResidual(e, P1DP2inv, err);
+	e.sq_error = err.squaredNorm();
+
+	block_t J1, J2;
+	gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &J1, &J2);
+
+	aux_t::multiplyJtLambdaJ(J1, e.H11, e.edge);
+	aux_t::multiplyJtLambdaJ(J2, e.H22, e.edge);
+	aux_t::multiplyJ1tLambdaJ2(J1, J2, e.H12, e.edge);
+	e.g1.setZero();
+	e.g2.setZero();
+	aux_t::multiply_Jt_W_err(J1, e.edge, err, e.g1);
+	aux_t::multiply_Jt_W_err(J2, e.edge, err, e.g2);
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::rebuildInformationRow(size_t k) {
+	// Row k of the lower triangle of H (columns <=k), and g_k, from the cached
+	// edge linearizations:
+	block_row_t &row = m_H[k];
+	row.clear();
+	block_t &diag = row[k];
+	diag.setZero();
+	for (size_t d=0; d<DIMS_POSE; d++)
+		diag(d,d) = opt_params.diagonal_damping + m_lambda;
+	m_g[k].setZero();
+
+	const std::vector<size_t> &edges = m_var_edges[k];
+	for (size_t i=0; i<edges.size(); i++) {
+		const TEdgeLinearization &e = m_edges[edges[i]];
+		if (e.var1==k) {
+			diag += e.H11;
+			m_g[k] += e.g1;
+			if (e.var2!=std::string::npos && e.var2<k) {
+				block_t &b = row[e.var2];
+				b += e.H12;
+			}
+		}
+		if (e.var2==k) {
+			diag += e.H22;
+			m_g[k] += e.g2;
+			if (e.var1!=std::string::npos && e.var1<k) {
+				block_t &b = row[e.var1];
+				b += e.H12.transpose();
+			}
+		}
+	}
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::computeFactorRow(size_t k) {
+	const size_t NPOS = std::string::npos;
+	const block_row_t &H_row = m_H[k];
+	TFactorRow &L_row = m_L[k];
+
+	// Nonzero pattern of row k of L: the nodes reachable in the elimination
+	// tree from the nonzero columns of row k of H (see cs_ereach() in CSparse).
+	L_row.cols.clear();
+	const size_t stamp = ++m_etree_stamp;
+	m_etree_mark[k] = stamp;
+	for (typename block_row_t::const_iterator it=H_row.begin(); it!=H_row.end() && it->first<k; ++it) {
+		for (size_t i=it->first; m_etree_mark[i]!=stamp; i=m_etree_parent[i]) {
+			L_row.cols.push_back(i);
+			m_etree_mark[i] = stamp;
+			if (m_etree_parent[i]==NPOS) {
+				m_etree_parent[i] = k;
+				break;
+			}
+		}
+	}
+	std::sort(L_row.cols.begin(), L_row.cols.end());
+	L_row.blocks.resize(L_row.cols.size());
+
+	// L(k,c) = ( H(k,c) - sum_{m<c} L(k,m)*L(c,m)^t ) * L(c,c)^-t
+	typename block_row_t::const_iterator it_H = H_row.begin();
+	block_t D = H_row.find(k)->second;
+	for (size_t idx=0; idx<L_row.cols.size(); idx++) {
+		const size_t c = L_row.cols[idx];
+		block_t B;
+		while (it_H->first<c) ++it_H;
+		if (it_H->first==c) B = it_H->second;
+		else B.setZero();
+
+		const TFactorRow &L_c = m_L[c];
+		for (size_t i=0, j=0; i<idx && j<L_c.cols.size(); ) {
+			if (L_row.cols[i]<L_c.cols[j]) i++;
+			else if (L_row.cols[i]>L_c.cols[j]) j++;
+			else {
+				B.noalias() -= L_row.blocks[i] * L_c.blocks[j].transpose();
+				i++; j++;
+			}
+		}
+		L_row.blocks[idx].noalias() = B * m_L_diag_inv[c].transpose();
+		D.noalias() -= L_row.blocks[idx] * L_row.blocks[idx].transpose();
+		m_L_col_rows[c].push_back(std::make_pair(k, idx));
+	}
+
+	// L(k,k) = chol( H(k,k) - sum_{c<k} L(k,c)*L(k,c)^t )
+	typedef Eigen::Matrix<double,DIMS_POSE,DIMS_POSE> dense_block_t;
+	const Eigen::LLT<dense_block_t> llt(D);
+	if (llt.info()!=Eigen::Success)
+		THROW_EXCEPTION_FMT("Non positive-definite information matrix for node #%u",
+				static_cast<unsigned int>(m_var_to_node[k]));
+	dense_block_t L_kk_inv = dense_block_t::Identity();
+	llt.matrixL().solveInPlace(L_kk_inv);
+	m_L_diag_inv[k] = L_kk_inv;
+}
+
+template<class GRAPH_t>
+double CIncrementalGSO<GRAPH_t>::backSubstituteVariable(size_t k) {
+	// delta_k = L(k,k)^-t * ( y_k - sum_{r>k} L(r,k)^t * delta_r )
+	array_t v = m_y[k];
+	const std::vector<std::pair<size_t,size_t> > &col = m_L_col_rows[k];
+	for (size_t i=0; i<col.size(); i++)
+		v.noalias() -= m_L[col[i].first].blocks[col[i].second].transpose() * m_delta[col[i].first];
+
+	array_t new_delta;
+	new_delta.noalias() = m_L_diag_inv[k].transpose() * v;
+	const double change = (new_delta - m_delta[k]).array().abs().maxCoeff();
+	m_delta[k] = new_delta;
+	m_last_updated_vars.push_back(k);
+	if (new_delta.array().abs().maxCoeff() > opt_params.relinearize_threshold)
+		m_relin_candidates.insert(k);
+	else m_relin_candidates.erase(k);
+	return change;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::updateFactorizationAndSolve(
+		std::vector<size_t> &affected_vars) {
+	MRPT_START;
+	const size_t NPOS = std::string::npos;
+
+	std::sort(affected_vars.begin(), affected_vars.end());
+	affected_vars.erase(std::unique(affected_vars.begin(), affected_vars.end()), affected_vars.end());
+	const size_t n = m_var_to_node.size();
+	const size_t c0 = affected_vars.front();
+	m_last_updated_vars.clear();
+
+	for (size_t i=0; i<affected_vars.size(); i++)
+		this->rebuildInformationRow(affected_vars[i]);
+
+	// Rows of the factor >=c0 depend on the changed rows of H: drop their
+	// blocks from the column lists and the elimination tree.
+	for (size_t r=c0; r<m_L.size(); r++) {
+		const std::vector<size_t> &cols = m_L[r].cols;
+		for (size_t i=0; i<cols.size(); i++) {
+			const size_t c = cols[i];
+			if (m_etree_parent[c]!=NPOS && m_etree_parent[c]>=c0)
+				m_etree_parent[c] = NPOS;
+			std::vector<std::pair<size_t,size_t> > &col = m_L_col_rows[c];
+			while (!col.empty() && col.back().first>=c0)
+				col.pop_back();
+		}
+	}
+	m_L.resize(n);
+	m_L_diag_inv.resize(n);
+	m_L_col_rows.resize(n);
+	m_etree_parent.resize(n, NPOS);
+	m_etree_mark.resize(n, 0);
+
+	// Up-looking Cholesky of rows c0..n-1, and forward substitution L*y=g:
+	for (size_t k=c0; k<n; k++) {
+		this->computeFactorRow(k);
+
+		array_t v = m_g[k];
+		const TFactorRow &L_row = m_L[k];
+		for (size_t i=0; i<L_row.cols.size(); i++)
+			v.noalias() -= L_row.blocks[i] * m_y[L_row.cols[i]];
+		m_y[k].noalias() = m_L_diag_inv[k] * v;
+	}
+	m_last_num_refactored_rows += n-c0;
+
+	// Back-substitution L^t * delta = y. All rows >=c0 change; older ones only
+	// if the solution of any newer node in their column changed significantly.
+	std::priority_queue<size_t> pending; // Largest index first
+	std::vector<size_t> visited;
+	for (size_t k=n; k-->c0; ) {
+		const double change = this->backSubstituteVariable(k);
+		if (change > opt_params.wildfire_threshold) {
+			const std::vector<size_t> &cols = m_L[k].cols;
+			for (size_t i=0; i<cols.size() && cols[i]<c0; i++)
+				pending.push(cols[i]);
+		}
+	}
+	size_t last_k = NPOS;
+	while (!pending.empty()) {
+		const size_t k = pending.top();
+		pending.pop();
+		if (k==last_k) continue; // Duplicated entry
+		last_k = k;
+
+		const double change = this->backSubstituteVariable(k);
+		if (change > opt_params.wildfire_threshold) {
+			const std::vector<size_t> &cols = m_L[k].cols;
+			for (size_t i=0; i<cols.size(); i++)
+				pending.push(cols[i]);
+		}
+	}
+	m_last_num_backsubstituted_vars += m_last_updated_vars.size();
+
+	// Write the new estimates to the graph: x = exp(-delta) (+) x_lin
+	std::sort(m_last_updated_vars.begin(), m_last_updated_vars.end());
+	m_last_updated_vars.erase(std::unique(m_last_updated_vars.begin(), m_last_updated_vars.end()), m_last_updated_vars.end());
+	for (size_t i=0; i<m_last_updated_vars.size(); i++) {
+		const size_t k = m_last_updated_vars[i];
+		array_t exp_delta;
+		for (size_t d=0; d<DIMS_POSE; d++)
+			exp_delta[d] = -m_delta[k][d];
+		pose_t exp_delta_pose(mrpt::poses::UNINITIALIZED_POSE);
+		gst::SE_TYPE::exp(exp_delta, exp_delta_pose);
+
+		typename GRAPH_t::global_poses_t::iterator it_node = m_graph->nodes.find(m_var_to_node[k]);
+		ASSERT_(it_node!=m_graph->nodes.end());
+		it_node->second.composeFrom(exp_delta_pose, m_x_lin[k]);
+	}
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+double CIncrementalGSO<GRAPH_t>::getLinearizedSquareError() const {
+	double err = 0;
+	for (size_t i=0; i<m_edges.size(); i++)
+		err += m_edges[i].sq_error;
+	return err;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::printParams() const {
+	opt_params.dumpToConsole();
+	viz_params.dumpToConsole();
+}
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::loadParams(const std::string& source_fname) {
+	MRPT_START;
+
+	using namespace mrpt::utils;
+
+	opt_params.loadFromConfigFileName(source_fname, "OptimizerParameters");
+	viz_params.loadFromConfigFileName(source_fname, "VisualizationParameters");
+
+	// set the logging level if given by the user
+	CConfigFile source(source_fname);
+	// Minimum verbosity level of the logger
+	int min_verbosity_level = source.read_int(
+			"OptimizerParameters",
+			"class_verbosity",
+			1, false);
+	this->setMinLoggingLevel(VerbosityLevel(min_verbosity_level));
+
+	this->logFmt(mrpt::utils::LVL_DEBUG, "Successfully loaded Params. ");
+	m_has_read_config = true;
+
+	MRPT_END;
+}
+
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::getDescriptiveReport(std::string* report_str) const {
+	MRPT_START;
+	using namespace std;
+
+	const std::string report_sep(2, '\n');
+	const std::string header_sep(80, '#');
+
+	// Report on graph
+	stringstream class_props_ss;
+	class_props_ss << "Incremental Optimization Summary: " << std::endl;
+	class_props_ss << header_sep << std::endl;
+	class_props_ss << "Optimized nodes           : " << m_var_to_node.size() << std::endl;
+	class_props_ss << "Optimized edges           : " << m_edges.size() << std::endl;
+	class_props_ss << "Sq. error (linearization) : " << this->getLinearizedSquareError() << std::endl;
+	class_props_ss << "Last update               : "
+		<< m_last_num_relinearized_vars << " relinearized nodes, "
+		<< m_last_num_refactored_rows << " refactored rows, "
+		<< m_last_num_backsubstituted_vars << " back-substituted nodes" << std::endl;
+
+	// time and output logging
+	const std::string time_res = m_time_logger.getStatsAsText();
+	const std::string output_res = this->getLogAsString();
+
+	// merge the individual reports
+	report_str->clear();
+
+	*report_str += class_props_ss.str();
+	*report_str += report_sep;
+
+	*report_str += time_res;
+	*report_str += report_sep;
+
+	*report_str += output_res;
+	*report_str += report_sep;
+
+	MRPT_END;
+}
+
+// OptimizationParams
+//////////////////////////////////////////////////////////////
+template<class GRAPH_t>
+CIncrementalGSO<GRAPH_t>::OptimizationParams::OptimizationParams():
+	relinearize_threshold(0.05),
+	wildfire_threshold(1e-3),
+	iterations_per_update(1),
+	diagonal_damping(1e-6)
+{ }
+template<class GRAPH_t>
+CIncrementalGSO<GRAPH_t>::OptimizationParams::~OptimizationParams() {
+}
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::OptimizationParams::dumpToTextStream(
+		mrpt::utils::CStream &out) const {
+	MRPT_START;
+
+	out.printf("------------------[ Incremental Optimization ]------------------\n");
+	out.printf("Relinearization threshold      = %e\n", relinearize_threshold);
+	out.printf("Wildfire threshold             = %e\n", wildfire_threshold);
+	out.printf("Iterations per update          = %d\n", iterations_per_update);
+	out.printf("Diagonal damping               = %e\n", diagonal_damping);
+	std::cout << std::endl;
+
+	MRPT_END;
+}
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::OptimizationParams::loadFromConfigFile(
+		const mrpt::utils::CConfigFileBase &source,
+		const std::string &section) {
+	MRPT_START;
+	MRPT_LOAD_CONFIG_VAR(relinearize_threshold, double, source, section);
+	MRPT_LOAD_CONFIG_VAR(wildfire_threshold, double, source, section);
+	MRPT_LOAD_CONFIG_VAR(iterations_per_update, int, source, section);
+	MRPT_LOAD_CONFIG_VAR(diagonal_damping, double, source, section);
+
+	ASSERTMSG_(relinearize_threshold > 0,
+			format("Invalid value for relinearize_threshold: %e",
+				relinearize_threshold) );
+	ASSERTMSG_(diagonal_damping >= 0,
+			format("Invalid value for diagonal_damping: %e",
+				diagonal_damping) );
+	MRPT_END;
+}
+
+// GraphVisualizationParams
+//////////////////////////////////////////////////////////////
+template<class GRAPH_t>
+CIncrementalGSO<GRAPH_t>::GraphVisualizationParams::GraphVisualizationParams():
+	keystroke_graph_toggle("s"),
+	keystroke_graph_autofit("a")
+{
+}
+template<class GRAPH_t>
+CIncrementalGSO<GRAPH_t>::GraphVisualizationParams::~GraphVisualizationParams() {
+}
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::GraphVisualizationParams::dumpToTextStream(
+		mrpt::utils::CStream &out) const {
+	MRPT_START;
+
+	out.printf("-----------[ Graph Visualization Parameters ]-----------\n");
+	out.printf("Visualize optimized graph = %s\n",
+			visualize_optimized_graph ? "TRUE" : "FALSE");
+
+	out.printf("%s", cfg.getAsString().c_str());
+
+	std::cout << std::endl;
+
+	MRPT_END;
+}
+template<class GRAPH_t>
+void CIncrementalGSO<GRAPH_t>::GraphVisualizationParams::loadFromConfigFile(
+		const mrpt::utils::CConfigFileBase &source,
+		const std::string &section) {
+	MRPT_START;
+	using namespace utils;
+
+	visualize_optimized_graph = source.read_bool(
+			section,
+			"visualize_optimized_graph",
+			1, false);
+
+	cfg["show_ID_labels"] = source.read_bool(
+			section,
+			"optimized_show_ID_labels",
+			0, false);
+	cfg["show_ground_grid"] = source.read_double(
+			section,
+			"optimized_show_ground_grid",
+			1, false);
+	cfg["show_edges"] = source.read_bool(
+			section,
+			"optimized_show_edges",
+			1, false);
+	cfg["edge_color"] = source.read_int(
+			section,
+			"optimized_edge_color",
+			4286611456, false);
+	cfg["edge_width"] = source.read_double(
+			section,
+			"optimized_edge_width",
+			1.5, false);
+	cfg["show_node_corners"] = source.read_bool(
+			section,
+			"optimized_show_node_corners",
+			1, false);
+	cfg["show_edge_rel_poses"] = source.read_bool(
+			section,
+			"optimized_show_edge_rel_poses",
+			1, false);
+	cfg["edge_rel_poses_color"] = source.read_int(
+			section,
+			"optimized_edge_rel_poses_color",
+			1090486272, false);
+	cfg["nodes_edges_corner_scale"] = source.read_double(
+			section,
+			"optimized_nodes_edges_corner_scale",
+			0.4, false);
+	cfg["nodes_corner_scale"] = source.read_double(
+			section,
+			"optimized_nodes_corner_scale",
+			0.7, false);
+	cfg["point_size"] = source.read_int(
+			section,
+			"optimized_point_size",
+			0, false);
+	cfg["point_color"] = source.read_int(
+			section,
+			"optimized_point_color",
+			10526880, false);
+
+	MRPT_END;
+}
+
+} } } // end of namespaces
+
+#endif /* end of include guard: CINCREMENTALGSO_IMPL_H */
@@ -22,6 +22,7 @@
 #include <mrpt/graphslam/ERD/CEmptyERD.h>
 #include <mrpt/graphslam/ERD/CLoopCloserERD.h>
 #include <mrpt/graphslam/GSO/CLevMarqGSO.h>
+#include <mrpt/graphslam/GSO/CIncrementalGSO.h>
 
 #include <string>
 #include <iostream>
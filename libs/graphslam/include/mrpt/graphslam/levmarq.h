@@ -44,6 +44,7 @@ namespace mrpt
 		  *		- "tau": (default=1e-3) Initial tau value for the lev-marq algorithm.
 		  *		- "e1": (default=1e-6) Lev-marq algorithm iteration stopping criterion #1: |gradient| < e1
 		  *		- "e2": (default=1e-6) Lev-marq algorithm iteration stopping criterion #2: |delta_incr| < e2*(x_norm+e2)
+		  *		- "num_threads": (default=1) Number of threads for the evaluation of the errors and Jacobians of the edges, the accumulation of the gradient and the Hessian, and the sparse Cholesky factorization of the Hessian, 0 means one per core (see mrpt::math::CSparseMatrix::CholeskyDecomp::setNumThreads()). The result does not depend on the number of threads.
 		  *
 		  * \note The following graph types are supported: mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D, mrpt::graphs::CNetworkOfPoses2DInf, mrpt::graphs::CNetworkOfPoses3DInf
 		  *
@@ -89,6 +90,7 @@ namespace mrpt
 			const double e2 = extra_params.getWithDefaultVal("e2",1e-6);
 
 			const double SCALE_HESSIAN = extra_params.getWithDefaultVal("scale_hessian",1);
+			const unsigned int num_threads = static_cast<unsigned int>(extra_params.getWithDefaultVal("num_threads",1));
 
 
 			mrpt::utils::CTimeLogger  profiler(enable_profiler);
@@ -166,7 +168,8 @@ namespace mrpt
 			const size_t nObservations = lstObservationData.size();
 			ASSERT_ABOVE_(nObservations,0)
 
-			// Cholesky object, as a pointer to reuse it between iterations:
+			// Cholesky object, as a pointer to reuse it between iterations (the AMD ordering and symbolic
+			// analysis are computed only once, since the structure of H does not change):
 #if MRPT_HAS_CXX11
 			typedef std::unique_ptr<CSparseMatrix::CholeskyDecomp> SparseCholeskyDecompPtr;
 #else
@@ -188,7 +191,7 @@ namespace mrpt
 			profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------\  .
 			double total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
 				graph, lstObservationData,
-				lstJacobians, errs);
+				lstJacobians, errs, num_threads);
 			profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");  // ------------------------------/
 
 
@@ -208,6 +211,20 @@ namespace mrpt
 						mrpt::utils::find_in_vector(id2,*nodes_to_optimize) ));
 			}
 
+			// For the multi-threaded evaluation of the gradient and the Hessian, the observations of each free node:
+			vector<vector<size_t> >  freeNodeIndex_to_observations;
+			if (num_threads!=1)
+			{
+				freeNodeIndex_to_observations.resize(nFreeNodes);
+				for (size_t idx_obs=0;idx_obs<nObservations;idx_obs++)
+				{
+					const size_t idx1 = observationIndex_to_relatedFreeNodeIndex[idx_obs].first;
+					const size_t idx2 = observationIndex_to_relatedFreeNodeIndex[idx_obs].second;
+					if (idx1!=string::npos) freeNodeIndex_to_observations[idx1].push_back(idx_obs);
+					if (idx2!=string::npos && idx2!=idx1) freeNodeIndex_to_observations[idx2].push_back(idx_obs);
+				}
+			}
+
 			// other important vars for the main loop:
 			CVectorDouble grad(nFreeNodes*DIMS_POSE);
 			grad.setZero();
@@ -245,6 +262,25 @@ namespace mrpt
 					// "lstJacobians" is sorted in the same order than "lstObservationData":
 					ASSERT_EQUAL_(lstJacobians.size(),lstObservationData.size())
 
+					if (num_threads!=1)
+					{
+						// Multi-threaded: each thread builds the gradient and the Hessian columns of a block of free nodes.
+						vector<const typename gst::TPairJacobs*> jacobs_ptrs;
+						jacobs_ptrs.reserve(nObservations);
+						for (typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ=lstJacobians.begin();itJ!=lstJacobians.end();++itJ)
+							jacobs_ptrs.push_back(&itJ->second);
+
+						detail::TGradAndHessianThreadsData<GRAPH_T> data;
+						data.observations = &lstObservationData[0];
+						data.jacobs = &jacobs_ptrs[0];
+						data.errs = &errs[0];
+						data.obs_free_node_idxs = &observationIndex_to_relatedFreeNodeIndex[0];
+						data.free_node_obs = &freeNodeIndex_to_observations[0];
+						data.grad_parts = &grad_parts[0];
+						data.H_map = &H_map[0];
+						mrpt::system::parallelForBlocks(nFreeNodes, &detail::accumulateGradAndHessianBlock<GRAPH_T>, &data, num_threads);
+					}
+					else
 					{
 						size_t idx_obs;
 						typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ;
@@ -305,7 +341,9 @@ namespace mrpt
 					//  - H_map[i]: corresponds to the i'th column of H.
 					//              Here "i" corresponds to [0,N-1] indices of appearance in the map "*nodes_to_optimize".
 					//  - H_map[i][j] is the entry for the j'th row, with "j" also in the range [0,N-1] as ordered in "*nodes_to_optimize".
+					// (Already done above in the multi-threaded case)
 					// ======================================================================
+					if (num_threads==1)
 					{
 						size_t idxObs;
 						typename gst::map_pairIDs_pairJacobs_t::const_iterator itJacobPair;
@@ -441,7 +479,7 @@ namespace mrpt
 				{
 					profiler.enter("optimize_graph_spa_levmarq.sp_H:chol");
 					if (!ptrCh.get())
-							ptrCh = SparseCholeskyDecompPtr(new CSparseMatrix::CholeskyDecomp(sp_H) );
+							ptrCh = SparseCholeskyDecompPtr(new CSparseMatrix::CholeskyDecomp(sp_H, num_threads) );
 					else ptrCh.get()->update(sp_H);
 					profiler.leave("optimize_graph_spa_levmarq.sp_H:chol");
 
@@ -526,7 +564,7 @@ namespace mrpt
 					profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------\  .
 					double new_total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
 						graph, lstObservationData,
-						new_lstJacobians, new_errs);
+						new_lstJacobians, new_errs, num_threads);
 					profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------/
 
 					// Now, to decide whether to accept the change:
@@ -12,6 +12,7 @@
 #include <mrpt/graphs/CNetworkOfPoses.h>
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/system/threads.h>  // parallelForBlocks()
 
 #include <memory>
 
@@ -142,15 +143,125 @@ namespace mrpt
 				}
 			};
 
+			// Residual pose error of one constraint, P1DP2inv = P1 * EDGE * inv(P2), its pseudo-ln and its Jacobians:
+			template <class GRAPH_T>
+			void computeJacobiansAndErrorOfObservation(
+				const typename graphslam_traits<GRAPH_T>::observation_info_t &obs,
+				typename graphslam_traits<GRAPH_T>::Array_O &err,
+				typename graphslam_traits<GRAPH_T>::TPairJacobs &jacobs)
+			{
+				typedef graphslam_traits<GRAPH_T> gst;
+
+				typename gst::graph_t::constraint_t::type_value P1DP2inv(mrpt::poses::UNINITIALIZED_POSE);
+				{
+					typename gst::graph_t::constraint_t::type_value P1D(mrpt::poses::UNINITIALIZED_POSE);
+					P1D.composeFrom(*obs.P1,*obs.edge_mean);
+					const typename gst::graph_t::constraint_t::type_value P2inv = -(*obs.P2); // Pose inverse (NOT just switching signs!)
+					P1DP2inv.composeFrom(P1D,P2inv);
+				}
+
+				AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, err, obs.edge);
+				gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &jacobs.first,&jacobs.second);
+			}
+
+			template <class GRAPH_T>
+			struct TJacobiansAndErrorsThreadsData
+			{
+				typedef graphslam_traits<GRAPH_T> gst;
+				const typename gst::observation_info_t *observations;
+				typename gst::Array_O *out_errs;        //!< One output slot per observation
+				typename gst::TPairJacobs *out_jacobs;  //!< One output slot per observation
+			};
+
+			// Worker (for mrpt::system::parallelForBlocks) evaluating the errors and Jacobians of a block of observations.
+			template <class GRAPH_T>
+			void computeJacobiansAndErrorsBlock(size_t first, size_t last, unsigned int thread_idx, void *param)
+			{
+				MRPT_UNUSED_PARAM(thread_idx);
+				const TJacobiansAndErrorsThreadsData<GRAPH_T> &data = *static_cast<const TJacobiansAndErrorsThreadsData<GRAPH_T>*>(param);
+				for (size_t i=first;i<last;i++)
+					computeJacobiansAndErrorOfObservation<GRAPH_T>(data.observations[i], data.out_errs[i], data.out_jacobs[i]);
+			}
+
+			template <class GRAPH_T>
+			struct TGradAndHessianThreadsData
+			{
+				typedef graphslam_traits<GRAPH_T> gst;
+				typedef typename mrpt::aligned_containers<TNodeID,typename gst::matrix_VxV_t>::map_t  map_ID2matrix_VxV_t;
+
+				const typename gst::observation_info_t *observations;
+				const typename gst::TPairJacobs * const *jacobs;  //!< The Jacobians of each observation
+				const typename gst::Array_O *errs;
+				const std::pair<size_t,size_t> *obs_free_node_idxs; //!< The indices of the free nodes of each observation (string::npos for fixed ones)
+				const std::vector<size_t> *free_node_obs;  //!< For each free node, the indices of its observations (sorted)
+				typename gst::Array_O *grad_parts;         //!< One output slot per free node
+				map_ID2matrix_VxV_t *H_map;                //!< One output column per free node
+			};
+
+			// Worker (for mrpt::system::parallelForBlocks) accumulating the gradient and the columns of the Hessian of a block of free nodes.
+			// Each thread only writes the entries of its own nodes, adding up the contributions in the same order of observations than
+			// the single-threaded loops, so the result is identical for any number of threads.
+			template <class GRAPH_T>
+			void accumulateGradAndHessianBlock(size_t first, size_t last, unsigned int thread_idx, void *param)
+			{
+				MRPT_UNUSED_PARAM(thread_idx);
+				typedef graphslam_traits<GRAPH_T> gst;
+				typedef AuxErrorEval<typename gst::edge_t,gst> aux_t;
+				const TGradAndHessianThreadsData<GRAPH_T> &data = *static_cast<const TGradAndHessianThreadsData<GRAPH_T>*>(param);
+
+				for (size_t c=first;c<last;c++)
+				{
+					const std::vector<size_t> &obs_idxs = data.free_node_obs[c];
+					for (size_t k=0;k<obs_idxs.size();k++)
+					{
+						const size_t idx_obs = obs_idxs[k];
+						const typename gst::edge_const_iterator &edge = data.observations[idx_obs].edge;
+						const typename gst::TPairJacobs &jacobs = *data.jacobs[idx_obs];
+						const size_t idx1 = data.obs_free_node_idxs[idx_obs].first;
+						const size_t idx2 = data.obs_free_node_idxs[idx_obs].second;
+
+						// grad[c] += J^t_{obs->c} * Inf.Matrix * errs_obs
+						if (idx1==c) aux_t::multiply_Jt_W_err(jacobs.first, edge, data.errs[idx_obs], data.grad_parts[c]);
+						if (idx2==c) aux_t::multiply_Jt_W_err(jacobs.second, edge, data.errs[idx_obs], data.grad_parts[c]);
+
+						// Hessian blocks of column "c" (upper triangular part, see optimize_graph_spa_levmarq()):
+						const bool edge_straight = edge->first.first < edge->first.second;
+						const size_t idx_i = edge_straight ? idx1 : idx2;
+						const size_t idx_j = edge_straight ? idx2 : idx1;
+						const typename gst::matrix_VxV_t &J1 = edge_straight ? jacobs.first : jacobs.second;
+						const typename gst::matrix_VxV_t &J2 = edge_straight ? jacobs.second : jacobs.first;
+
+						typename gst::matrix_VxV_t JtJ(mrpt::math::UNINITIALIZED_MATRIX);
+						if (idx_i==c)
+						{
+							aux_t::multiplyJtLambdaJ(J1,JtJ,edge);
+							data.H_map[c][c] += JtJ;
+						}
+						if (idx_j==c)
+						{
+							aux_t::multiplyJtLambdaJ(J2,JtJ,edge);
+							data.H_map[c][c] += JtJ;
+							if (idx_i!=std::string::npos)
+							{
+								aux_t::multiplyJ1tLambdaJ2(J1,J2,JtJ,edge);
+								data.H_map[c][idx_i] += JtJ;
+							}
+						}
+					}
+				}
+			}
+
 		} // end NS detail
 
 		// Compute, at once, jacobians and the error vectors for each constraint in "lstObservationData", returns the overall squared error.
+		// With num_threads!=1, the constraints are evaluated in parallel (0: one thread per core), with identical results.
 		template <class GRAPH_T>
 		double computeJacobiansAndErrors(
 			const GRAPH_T &graph,
 			const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>  &lstObservationData,
 			typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t   &lstJacobians,
-			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs
+			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs,
+			unsigned int num_threads = 1
 			)
 		{
 			MRPT_UNUSED_PARAM(graph);
@@ -161,38 +272,39 @@ namespace mrpt
 
 			const size_t nObservations = lstObservationData.size();
 
-			for (size_t i=0;i<nObservations;i++)
+			if (num_threads==1 || nObservations<2)
 			{
-				const typename gst::observation_info_t & obs = lstObservationData[i];
-				typename gst::edge_const_iterator it = obs.edge;
-				const typename gst::graph_t::constraint_t::type_value* EDGE_POSE = obs.edge_mean;
-				typename gst::graph_t::constraint_t::type_value* P1 = obs.P1;
-				typename gst::graph_t::constraint_t::type_value* P2 = obs.P2;
-
-				const mrpt::utils::TPairNodeIDs                   &ids  = it->first;
-				const typename gst::graph_t::edge_t  &edge = it->second;
-
-				// Compute the residual pose error of these pair of nodes + its constraint,
-				//  that is: P1DP2inv = P1 * EDGE * inv(P2)
-				typename gst::graph_t::constraint_t::type_value P1DP2inv(mrpt::poses::UNINITIALIZED_POSE);
+				for (size_t i=0;i<nObservations;i++)
 				{
-					typename gst::graph_t::constraint_t::type_value P1D(mrpt::poses::UNINITIALIZED_POSE);
-					P1D.composeFrom(*P1,*EDGE_POSE);
-					const typename gst::graph_t::constraint_t::type_value P2inv = -(*P2); // Pose inverse (NOT just switching signs!)
-					P1DP2inv.composeFrom(P1D,P2inv);
+					// Add to vector of errors, and compute the jacobians:
+					errs.resize(errs.size()+1);
+					MRPT_ALIGN16 std::pair<mrpt::utils::TPairNodeIDs,typename gst::TPairJacobs> newMapEntry;
+					newMapEntry.first = lstObservationData[i].edge->first;
+					detail::computeJacobiansAndErrorOfObservation<GRAPH_T>(lstObservationData[i], errs.back(), newMapEntry.second);
+
+					// And insert into map of jacobians:
+					lstJacobians.insert(lstJacobians.end(),newMapEntry );
 				}
+			}
+			else
+			{
+				// Each observation has its own output slots, then they are moved to the map in the same order:
+				errs.resize(nObservations);
+				typename mrpt::aligned_containers<typename gst::TPairJacobs>::vector_t jacobs(nObservations);
 
-				// Add to vector of errors:
-				errs.resize(errs.size()+1);
-				detail::AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, errs.back(),edge);
-
-				// Compute the jacobians:
-				MRPT_ALIGN16 std::pair<mrpt::utils::TPairNodeIDs,typename gst::TPairJacobs> newMapEntry;
-				newMapEntry.first = ids;
-				gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &newMapEntry.second.first,&newMapEntry.second.second);
+				detail::TJacobiansAndErrorsThreadsData<GRAPH_T> data;
+				data.observations = &lstObservationData[0];
+				data.out_errs = &errs[0];
+				data.out_jacobs = &jacobs[0];
+				mrpt::system::parallelForBlocks(nObservations, &detail::computeJacobiansAndErrorsBlock<GRAPH_T>, &data, num_threads);
 
-				// And insert into map of jacobians:
-				lstJacobians.insert(lstJacobians.end(),newMapEntry );
+				for (size_t i=0;i<nObservations;i++)
+				{
+					MRPT_ALIGN16 std::pair<mrpt::utils::TPairNodeIDs,typename gst::TPairJacobs> newMapEntry;
+					newMapEntry.first = lstObservationData[i].edge->first;
+					newMapEntry.second = jacobs[i];
+					lstJacobians.insert(lstJacobians.end(),newMapEntry );
+				}
 			}
 
 			// return overall square error:  (Was: std::accumulate(...,mrpt::math::squareNorm_accum<>), but led to GCC errors when enabling parallelization)
@@ -0,0 +1,170 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "graph_slam_levmarq_test_common.h"
+#include <mrpt/graphslam/GSO/CIncrementalGSO.h>
+
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::random;
+using namespace mrpt::utils;
+using namespace mrpt::poses;
+using namespace mrpt::graphs;
+using namespace mrpt::math;
+using namespace std;
+
+template <class my_graph_t>
+class IncrementalGSOTester : public GraphSlamLevMarqTest<my_graph_t>, public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+	}
+	virtual void TearDown() {  }
+
+	// Feeds the ring path graph to the optimizer node by node, as the graphslam
+	// engine would do, and checks that the final graph is consistent.
+	void test_incremental_ring_path()
+	{
+		// Edges are noise-free, so the optimum has zero error:
+		my_graph_t full_graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(full_graph);
+
+		my_graph_t graph;
+		graph.root = full_graph.root;
+		graph.nodes[full_graph.root] = full_graph.nodes[full_graph.root];
+
+		mrpt::graphslam::optimizers::CIncrementalGSO<my_graph_t> optimizer;
+		optimizer.opt_params.relinearize_threshold = 1e-3;
+		optimizer.opt_params.iterations_per_update = 3;
+		optimizer.setMinLoggingLevel(LVL_ERROR);
+		optimizer.setGraphPtr(&graph);
+
+		const double initial_error = full_graph.getGlobalSquareError();
+		for (typename my_graph_t::global_poses_t::const_iterator it_node=full_graph.nodes.begin();
+				it_node!=full_graph.nodes.end(); ++it_node)
+		{
+			const TNodeID id = it_node->first;
+			if (id==full_graph.root) continue;
+			graph.nodes[id] = it_node->second; // Noisy initial guess
+			for (typename my_graph_t::const_iterator it=full_graph.edges.begin(); it!=full_graph.edges.end(); ++it)
+				if (std::max(it->first.first,it->first.second)==id)
+					graph.edges.insert(*it);
+
+			optimizer.updateState(
+					mrpt::obs::CActionCollectionPtr(),
+					mrpt::obs::CSensoryFramePtr(),
+					mrpt::obs::CObservationPtr());
+			ASSERT_EQ(graph.edgeCount(), graph.edges.size());
+		}
+		ASSERT_EQ(graph.nodeCount(), full_graph.nodeCount());
+		ASSERT_EQ(graph.edgeCount(), full_graph.edgeCount());
+
+		// A few more calls, with no new data, let the last relinearizations settle:
+		for (int i=0;i<10;i++)
+			optimizer.updateState(
+					mrpt::obs::CActionCollectionPtr(),
+					mrpt::obs::CSensoryFramePtr(),
+					mrpt::obs::CObservationPtr());
+
+		const double final_error = graph.getGlobalSquareError();
+		EXPECT_LT(final_error, 1e-2*initial_error);
+		EXPECT_LE(final_error, 1e-2);
+
+		// Restarting from scratch over the whole graph gives the same result:
+		const my_graph_t graph_incremental = graph;
+		optimizer.resetState();
+		optimizer.updateState(
+				mrpt::obs::CActionCollectionPtr(),
+				mrpt::obs::CSensoryFramePtr(),
+				mrpt::obs::CObservationPtr());
+		EXPECT_LE(graph.getGlobalSquareError(), 1e-2);
+		for (typename my_graph_t::global_poses_t::const_iterator it=graph.nodes.begin(); it!=graph.nodes.end(); ++it)
+			EXPECT_NEAR((it->second.getAsVectorVal()-graph_incremental.nodes.find(it->first)->second.getAsVectorVal()).array().abs().maxCoeff(), 0, 1e-2);
+	}
+
+	// Removes an edge and adds another one between other nodes before the same
+	// call to the optimizer, so the number of edges does not change: both
+	// changes must be taken into account anyway.
+	void test_replaced_edge()
+	{
+		my_graph_t graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph);
+
+		mrpt::graphslam::optimizers::CIncrementalGSO<my_graph_t> optimizer;
+		optimizer.opt_params.relinearize_threshold = 1e-3;
+		optimizer.opt_params.iterations_per_update = 3;
+		optimizer.setMinLoggingLevel(LVL_ERROR);
+		optimizer.setGraphPtr(&graph);
+		for (int i=0;i<5;i++)
+			optimizer.updateState(
+					mrpt::obs::CActionCollectionPtr(),
+					mrpt::obs::CSensoryFramePtr(),
+					mrpt::obs::CObservationPtr());
+
+		const size_t nEdges = graph.edgeCount();
+		graph.edges.erase(graph.edges.begin());
+		// A biased measurement, so the optimum changes:
+		typename my_graph_t::edge_t new_edge = graph.nodes[26] - graph.nodes[1];
+		new_edge += typename my_graph_t::edge_t(CPose3D(1.0,0,0, 0,0,0));
+		graph.insertEdge(1,26, new_edge);
+		ASSERT_EQ(graph.edgeCount(), nEdges);
+
+		for (int i=0;i<10;i++)
+			optimizer.updateState(
+					mrpt::obs::CActionCollectionPtr(),
+					mrpt::obs::CSensoryFramePtr(),
+					mrpt::obs::CObservationPtr());
+
+		// Same result than from scratch over the final graph:
+		const my_graph_t graph_incremental = graph;
+		optimizer.resetState();
+		for (int i=0;i<10;i++)
+			optimizer.updateState(
+					mrpt::obs::CActionCollectionPtr(),
+					mrpt::obs::CSensoryFramePtr(),
+					mrpt::obs::CObservationPtr());
+		for (typename my_graph_t::global_poses_t::const_iterator it=graph.nodes.begin(); it!=graph.nodes.end(); ++it)
+			EXPECT_NEAR((it->second.getAsVectorVal()-graph_incremental.nodes.find(it->first)->second.getAsVectorVal()).array().abs().maxCoeff(), 0, 1e-2);
+	}
+};
+
+typedef IncrementalGSOTester<CNetworkOfPoses2D> IncrementalGSOTester2D;
+typedef IncrementalGSOTester<CNetworkOfPoses3D> IncrementalGSOTester3D;
+
+TEST_F(IncrementalGSOTester2D, OptimizeSampleRingPath)
+{
+	for (int seed=1;seed<5;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_incremental_ring_path();
+	}
+}
+
+TEST_F(IncrementalGSOTester3D, OptimizeSampleRingPath)
+{
+	for (int seed=1;seed<5;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_incremental_ring_path();
+	}
+}
+
+TEST_F(IncrementalGSOTester2D, ReplacedEdge)
+{
+	randomGenerator.randomize(1);
+	test_replaced_edge();
+}
+
+TEST_F(IncrementalGSOTester3D, ReplacedEdge)
+{
+	randomGenerator.randomize(1);
+	test_replaced_edge();
+}
@@ -70,6 +70,8 @@ void TUserOptionsChecker::createDeciderOptimizerMappings() {
 	// optimizers
 	optimizers_map["CLevMarqGSO"] =
 		&createGraphSlamOptimizer<CLevMarqGSO<CNetworkOfPoses2DInf> >;
+	optimizers_map["CIncrementalGSO"] =
+		&createGraphSlamOptimizer<CIncrementalGSO<CNetworkOfPoses2DInf> >;
 
 	MRPT_END;
 }
@@ -268,6 +270,13 @@ void TUserOptionsChecker::populateDeciderOptimizerProperties() {
 
 		optimizers_descriptions.push_back(opt);
 	}
+	{ // CIncrementalGSO
+		TOptimizerProps* opt = new TOptimizerProps;
+		opt->name = "CIncrementalGSO";
+		opt->description = "Incremental (iSAM-like) non-linear graphSLAM solver, with partial relinearization and refactorization";
+
+		optimizers_descriptions.push_back(opt);
+	}
 	MRPT_END
 }
 
@@ -60,6 +60,27 @@ protected:
 
 	} // end test_ring_path
 
+	void test_ring_path_multithreaded()
+	{
+		my_graph_t graph_st;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph_st);
+		my_graph_t graph_mt = graph_st;
+
+		TParametersDouble  params;
+		params["max_iterations"] = 1000;
+
+		graphslam::TResultInfoSpaLevMarq  info_st, info_mt;
+		graphslam::optimize_graph_spa_levmarq(graph_st, info_st, NULL, params);
+		params["num_threads"] = 4;
+		graphslam::optimize_graph_spa_levmarq(graph_mt, info_mt, NULL, params);
+
+		// The multi-threaded evaluation must give the same results:
+		EXPECT_EQ(info_st.num_iters, info_mt.num_iters);
+		EXPECT_NEAR(info_st.final_total_sq_error, info_mt.final_total_sq_error, 1e-12);
+		for (typename my_graph_t::global_poses_t::const_iterator it=graph_st.nodes.begin(); it!=graph_st.nodes.end(); ++it)
+			EXPECT_NEAR(0, (it->second.getAsVectorVal()-graph_mt.nodes[it->first].getAsVectorVal()).array().abs().maxCoeff(), 1e-9);
+	}
+
 	void test_graph_bin_serialization()
 	{
 		my_graph_t graph;
@@ -101,6 +122,14 @@ TEST_F(GraphSlamLevMarqTester2D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester2D, OptimizeSampleRingPathMultiThreaded)
+{
+	for (int seed=1;seed<3;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_ring_path_multithreaded();
+	}
+}
 TEST_F(GraphSlamLevMarqTester2D, BinarySerialization)
 {
 	randomGenerator.randomize(123);
@@ -115,6 +144,14 @@ TEST_F(GraphSlamLevMarqTester3D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester3D, OptimizeSampleRingPathMultiThreaded)
+{
+	for (int seed=1;seed<3;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_ring_path_multithreaded();
+	}
+}
 TEST_F(GraphSlamLevMarqTester3D, BinarySerialization)
 {
 	randomGenerator.randomize(123);
@@ -143,7 +143,7 @@ namespace mrpt
 			/// \overload
 			inline void  insertPoint( const mrpt::math::TPoint3Df &p ) { insertPoint(p.x,p.y,p.z); }
 			/// \overload
-			inline void  insertPoint( float x, float y, float z) { insertPointFast(x,y,z); mark_as_modified(); }
+			inline void  insertPoint( float x, float y, float z) { insertPointFast(x,y,z); mark_as_points_appended(); }
 
 			/** Changes just the color of a given point from the map. First index is 0.
 			 * \exception Throws std::exception on index out of bound.
@@ -102,6 +102,7 @@ namespace maps
 
 		std::vector<double> precomputedLikelihood; //!< Auxiliary variables to speed up the computation of observation likelihood values for LF method among others, at a high cost in memory (see TLikelihoodOptions::enableLikelihoodCache).
 		bool precomputedLikelihoodToBeRecomputed;
+		bool precomputedLikelihoodIsComplete; //!< Whether all cells of precomputedLikelihood have been filled in by prepareConcurrentObservationLikelihood(), since the last reset of the cache
 
 		/** Used for Voronoi calculation.Same struct as "map", but contains a "0" if not a basis point. */
 		mrpt::utils::CDynamicGrid<uint8_t>	m_basis_map;
@@ -150,6 +151,10 @@ namespace maps
 		/** One of the methods that can be selected for implementing "computeObservationLikelihood". */
 		double	 computeObservationLikelihood_likelihoodField_II(const mrpt::obs::CObservation *obs,const mrpt::poses::CPose2D &takenFrom );
 
+		void   prepareLikelihoodFieldCache(); //!< Resets the likelihood-field cache (precomputedLikelihood) if needed, before evaluating the LF likelihood model
+		double computeLikelihoodField_Thrun_cell(int cx, int cy) const; //!< Likelihood-field value for the cell (cx,cy), which must be inside the map, computed without the cache
+		inline double getLikelihoodField_Thrun_cell(int cx, int cy); //!< Like computeLikelihoodField_Thrun_cell() but through the cache, if enabled
+
 		virtual void  internal_clear( ) MRPT_OVERRIDE; //!< Clear the map: It set all cells to their default occupancy value (0.5), without changing the resolution (the grid extension is reset to the default values).
 
 		 /** Insert the observation information into this map.
@@ -441,6 +446,11 @@ namespace maps
 			std::vector<double>	OWA_individualLikValues; //!< [OWA method] This will contain the ascending-ordered list of likelihood values for individual range measurements in the scan.
 		} likelihoodOutputs;
 
+		/** Fills in the whole likelihood-field cache (if TLikelihoodOptions::enableLikelihoodCache is set), so lmLikelihoodField_Thrun
+		  *  likelihoods can be evaluated from several threads at once. Note that lmConsensusOWA and lmMeanInformation are never reentrant.
+		  *  The cache is only filled once, until the map is modified (e.g. by inserting an observation). \sa CMetricMap::prepareConcurrentObservationLikelihood */
+		void  prepareConcurrentObservationLikelihood() MRPT_OVERRIDE;
+
 		 void  subSample( int downRatio ); //!< Performs a downsampling of the gridmap, by a given factor: resolution/=ratio
 
 		/** Computes the entropy and related values of this grid map.
@@ -646,6 +656,24 @@ namespace maps
 		  */
 		double	 computeLikelihoodField_Thrun( const CPointsMap	*pm, const mrpt::poses::CPose2D *relativePose = NULL);
 
+		/** Batched version of computeLikelihoodField_Thrun(): computes the log-likelihood of the same set of points (in local coordinates)
+		  *  for N candidate relative poses, returning exactly the same values than N calls to computeLikelihoodField_Thrun().
+		  *  Points are decimated and gathered only once, sin/cos are evaluated once per pose, and points are transformed
+		  *  into cell indices two at a time with SSE2 (if available).
+		  * \param pm The points map, in local coordinates.
+		  * \param poses The N candidate poses of the points map in this map's coordinates.
+		  * \param out_log_liks The N output log-likelihood values.
+		  * \sa computeObservationLikelihoods
+		  */
+		void computeLikelihoodField_Thrun_batch( const CPointsMap *pm, const std::vector<mrpt::math::TPose2D> &poses, std::vector<double> &out_log_liks);
+
+		/** Computes the log-likelihood of one observation for N candidate robot poses, with the same result than calling
+		  *  computeObservationLikelihood() for each pose. For 2D range scans and TLikelihoodOptions::likelihoodMethod=lmLikelihoodField_Thrun
+		  *  this uses the much faster computeLikelihoodField_Thrun_batch().
+		  * \sa computeLikelihoodField_Thrun_batch
+		  */
+		void computeObservationLikelihoods( const mrpt::obs::CObservation *obs, const std::vector<mrpt::math::TPose2D> &takenFrom, std::vector<double> &out_log_liks);
+
 		/** Computes the likelihood [0,1] of a set of points, given the current grid map as reference.
 		  * \param pm The points map
 		  * \param relativePose The relative pose of the points map in this map's coordinates, or NULL for (0,0,0).
@@ -0,0 +1,53 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointCloudFilterBase.h>
+#include <mrpt/utils/mrpt_macros.h>
+
+#include <mrpt/maps/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace maps
+	{
+		/** A chain of point cloud filters, applied in order to the same point cloud, in place.
+		 *
+		 * Usage:
+		 * \code
+		 *  mrpt::maps::CPointCloudFilterPipeline pipeline;
+		 *  mrpt::maps::CPointCloudFilterVoxelGrid *voxels = new mrpt::maps::CPointCloudFilterVoxelGrid;
+		 *  voxels->options.voxel_size = 0.05;
+		 *  pipeline.filters.push_back( mrpt::maps::CPointCloudFilterBasePtr(voxels) );
+		 *  pipeline.filters.push_back( mrpt::maps::CPointCloudFilterBasePtr(new mrpt::maps::CPointCloudFilterRadiusOutliers) );
+		 *  pipeline.filter(&my_points, timestamp, pose);
+		 * \endcode
+		 *
+		 * If `out_deletion_mask` is requested, it refers to the points of the input cloud, no matter how many stages removed points.
+		 * If `do_not_delete` is set, the filters are run on an internal copy of the point cloud and the input is left untouched.
+		 *
+		 * \sa CPointCloudFilterVoxelGrid, CPointCloudFilterRadiusOutliers, CPointCloudFilterStatisticalOutliers
+		  * \ingroup mrpt_maps_grp
+		 */
+		class MAPS_IMPEXP CPointCloudFilterPipeline : public mrpt::maps::CPointCloudFilterBase
+		{
+		public:
+			// See base docs
+			void filter(
+				mrpt::maps::CPointsMap * inout_pointcloud,       //!< [in,out] The input pointcloud, which will be modified upon return after filtering.
+				const mrpt::system::TTimeStamp pc_timestamp,     //!< [in] The timestamp of the input pointcloud, passed to each filter.
+				const mrpt::poses::CPose3D & pc_reference_pose,  //!< [in] The pose of the input pointcloud, passed to each filter.
+				TExtraFilterParams * params = nullptr            //!< [in,out] additional in/out parameters
+			) MRPT_OVERRIDE;
+
+			std::vector<CPointCloudFilterBasePtr> filters; //!< The filters, applied in this order. NULL entries are ignored.
+		};
+
+	}
+} // End of namespace
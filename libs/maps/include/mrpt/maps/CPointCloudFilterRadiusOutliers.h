@@ -0,0 +1,53 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointCloudFilterBase.h>
+#include <mrpt/utils/CLoadableOptions.h>
+
+#include <mrpt/maps/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace maps
+	{
+		/** Radius outlier removal: points with less than `min_neighbors` other points closer than `radius` are removed.
+		 *
+		 * Neighbors are searched in the 27 surrounding cells of a hashed voxel grid with cells of side `radius`,
+		 * so the cost is linear with the number of points for a bounded point density. The pointcloud timestamp and pose are ignored.
+		 *
+		 * \sa CPointsMap, CPointCloudFilterPipeline, CPointCloudFilterStatisticalOutliers
+		  * \ingroup mrpt_maps_grp
+		 */
+		class MAPS_IMPEXP CPointCloudFilterRadiusOutliers : public mrpt::maps::CPointCloudFilterBase
+		{
+		public:
+			// See base docs
+			void filter(
+				mrpt::maps::CPointsMap * inout_pointcloud,       //!< [in,out] The input pointcloud, which will be modified upon return after filtering.
+				const mrpt::system::TTimeStamp pc_timestamp,     //!< [in] Ignored
+				const mrpt::poses::CPose3D & pc_reference_pose,  //!< [in] Ignored
+				TExtraFilterParams * params = nullptr            //!< [in,out] additional in/out parameters
+			) MRPT_OVERRIDE;
+
+			struct MAPS_IMPEXP TOptions : public mrpt::utils::CLoadableOptions
+			{
+				double       radius;         //!< (Default: 0.10 m) Neighborhood radius.
+				unsigned int min_neighbors;  //!< (Default: 2) Minimum number of other points within `radius` for a point to be kept.
+
+				TOptions();
+				void loadFromConfigFile(const mrpt::utils::CConfigFileBase &source, const std::string &section) MRPT_OVERRIDE; // See base docs
+				void saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &section) const MRPT_OVERRIDE;
+			};
+
+			TOptions options;
+		};
+
+	}
+} // End of namespace
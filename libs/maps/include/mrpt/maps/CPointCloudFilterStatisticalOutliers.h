@@ -0,0 +1,53 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointCloudFilterBase.h>
+#include <mrpt/utils/CLoadableOptions.h>
+
+#include <mrpt/maps/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace maps
+	{
+		/** Statistical outlier removal: for each point, the mean distance `d` to its `mean_k` nearest neighbors is computed,
+		 *   and points with `d > mean(d) + std_dev_mul * std(d)` (statistics over the whole cloud) are removed.
+		 *
+		 * Neighbors are found with the KD-tree of the point cloud. The pointcloud timestamp and pose are ignored.
+		 *
+		 * \sa CPointsMap, CPointCloudFilterPipeline, CPointCloudFilterRadiusOutliers
+		  * \ingroup mrpt_maps_grp
+		 */
+		class MAPS_IMPEXP CPointCloudFilterStatisticalOutliers : public mrpt::maps::CPointCloudFilterBase
+		{
+		public:
+			// See base docs
+			void filter(
+				mrpt::maps::CPointsMap * inout_pointcloud,       //!< [in,out] The input pointcloud, which will be modified upon return after filtering.
+				const mrpt::system::TTimeStamp pc_timestamp,     //!< [in] Ignored
+				const mrpt::poses::CPose3D & pc_reference_pose,  //!< [in] Ignored
+				TExtraFilterParams * params = nullptr            //!< [in,out] additional in/out parameters
+			) MRPT_OVERRIDE;
+
+			struct MAPS_IMPEXP TOptions : public mrpt::utils::CLoadableOptions
+			{
+				unsigned int mean_k;       //!< (Default: 8) Number of nearest neighbors used to compute the mean distance of each point.
+				double       std_dev_mul;  //!< (Default: 1.0) Number of standard deviations above the mean distance for a point to be considered an outlier.
+
+				TOptions();
+				void loadFromConfigFile(const mrpt::utils::CConfigFileBase &source, const std::string &section) MRPT_OVERRIDE; // See base docs
+				void saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &section) const MRPT_OVERRIDE;
+			};
+
+			TOptions options;
+		};
+
+	}
+} // End of namespace
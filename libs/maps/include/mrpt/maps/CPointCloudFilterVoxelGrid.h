@@ -0,0 +1,58 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointCloudFilterBase.h>
+#include <mrpt/utils/CLoadableOptions.h>
+
+#include <mrpt/maps/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace maps
+	{
+		/** Voxel-grid downsampling of a point cloud: the space is split in cubic voxels of side `voxel_size`,
+		 *   and all the points within each voxel are replaced by one single point.
+		 *
+		 * The surviving point of each voxel is the first one (in the original order) falling inside it, so
+		 * any additional per-point field (color, weight,...) is kept from that point, while its coordinates are
+		 * replaced by the voxel centroid if `use_centroid` is true. Voxels are found with a hash table, hence
+		 * the cost is linear with the number of points. The pointcloud timestamp and pose are ignored: voxels
+		 * are aligned with the axes of the frame in which the points are given.
+		 *
+		 * \sa CPointsMap, CPointCloudFilterPipeline
+		  * \ingroup mrpt_maps_grp
+		 */
+		class MAPS_IMPEXP CPointCloudFilterVoxelGrid : public mrpt::maps::CPointCloudFilterBase
+		{
+		public:
+			// See base docs
+			void filter(
+				mrpt::maps::CPointsMap * inout_pointcloud,       //!< [in,out] The input pointcloud, which will be modified upon return after filtering.
+				const mrpt::system::TTimeStamp pc_timestamp,     //!< [in] Ignored
+				const mrpt::poses::CPose3D & pc_reference_pose,  //!< [in] Ignored
+				TExtraFilterParams * params = nullptr            //!< [in,out] additional in/out parameters
+			) MRPT_OVERRIDE;
+
+			struct MAPS_IMPEXP TOptions : public mrpt::utils::CLoadableOptions
+			{
+				double voxel_size;                 //!< (Default: 0.10 m) Side length of each voxel.
+				bool   use_centroid;               //!< (Default: true) Move each surviving point to the centroid of its voxel. If false, it keeps its original coordinates.
+				unsigned int min_points_per_voxel; //!< (Default: 1) Voxels with less points than this are entirely removed.
+
+				TOptions();
+				void loadFromConfigFile(const mrpt::utils::CConfigFileBase &source, const std::string &section) MRPT_OVERRIDE; // See base docs
+				void saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &section) const MRPT_OVERRIDE;
+			};
+
+			TOptions options;
+		};
+
+	}
+} // End of namespace
@@ -142,6 +142,10 @@ namespace maps
 		/** Auxiliary method called from within \a addFrom() automatically, to finish the copying of class-specific data  */
 		virtual void  addFrom_classSpecific(const CPointsMap &anotherMap, const size_t nPreviousPoints) = 0;
 
+		/** Appends \a count points with default values (as \a resize() would), but without invalidating the kd-tree: the caller must
+		  *  then overwrite only the new points and call mark_as_points_appended(). \sa resize */
+		void  appendDefaultPoints(const size_t count);
+
 	public:
 
 		/** @} */
@@ -416,7 +420,7 @@ namespace maps
 		/** Provides a way to insert (append) individual points into the map: the missing fields of child
 		  * classes (color, weight, etc) are left to their default values
 		  */
-		inline void  insertPoint( float x, float y, float z=0 ) { insertPointFast(x,y,z); mark_as_modified(); }
+		inline void  insertPoint( float x, float y, float z=0 ) { insertPointFast(x,y,z); mark_as_points_appended(); }
 		/// \overload
 		inline void  insertPoint( const mrpt::math::TPoint3D &p ) { insertPoint(p.x,p.y,p.z); }
 		/// overload (RGB data is ignored in classes without color information)
@@ -775,6 +779,14 @@ namespace maps
 			kdtree_mark_as_outdated();
 		}
 
+		/** Like mark_as_modified(), for changes which only append new points at the end of the map (existing points unchanged):
+		  *  the kd-tree is then updated incrementally in the next query instead of being rebuilt from scratch. */
+		inline void mark_as_points_appended() const
+		{
+			m_largestDistanceFromOriginIsUpdated=false;
+			m_boundingBoxIsUpdated = false;
+		}
+
 	protected:
 		std::vector<float>     x,y,z;        //!< The point coordinates
 
@@ -801,6 +813,20 @@ namespace maps
 		/** Helper method for ::copyFrom() */
 		void  base_copyFrom(const CPointsMap &obj);
 
+		/** Common part of determineMatching2D() and determineMatching3D(): nearest-neighbour search for the selected
+		  *  points of \a otherMap, already transformed into the frame of this map in \a x_locals, \a y_locals, \a z_locals
+		  *  (\a z_locals=NULL for 2D matching), split in blocks among TMatchingParams::numThreads threads.
+		  *  The memory already reserved in \a correspondences is reused. The output does not depend on the number of threads. */
+		void  determineMatching_NN(
+			const CPointsMap      * otherMap,
+			const float *x_locals, const float *y_locals, const float *z_locals,
+			mrpt::utils::TMatchingPairList     & correspondences,
+			const TMatchingParams & params,
+			TMatchingExtraResults & extraResults ) const;
+
+		/** Worker for determineMatching_NN(), with the signature of mrpt::system::parallelForBlocks() */
+		static void determineMatching_NNBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
 
 		/** @name PLY Import virtual methods to implement in base classes
 			@{ */
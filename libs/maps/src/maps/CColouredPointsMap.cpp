@@ -403,7 +403,7 @@ void  CColouredPointsMap::insertPoint( float x, float y, float z, float R, float
 	m_color_G.push_back(G);
 	m_color_B.push_back(B);
 
-	mark_as_modified();
+	mark_as_points_appended();
 }
 
 /*---------------------------------------------------------------
@@ -100,6 +100,7 @@ COccupancyGridMap2D::COccupancyGridMap2D(
 		x_min(),x_max(),y_min(),y_max(), resolution(),
 		precomputedLikelihood(),
 		precomputedLikelihoodToBeRecomputed(true),
+		precomputedLikelihoodIsComplete(false),
 		m_basis_map(),
 		m_voronoi_diagram(),
 		m_is_empty(true),
@@ -14,6 +14,7 @@
 #include <mrpt/obs/CObservationRange.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/utils/CStream.h>
+#include <mrpt/utils/SSE_types.h>
 
 
 using namespace mrpt;
@@ -493,6 +494,124 @@ double	 COccupancyGridMap2D::computeObservationLikelihood_likelihoodField_II(
 }
 
 
+#define LIK_LF_CACHE_INVALID    (66)
+
+/*---------------------------------------------------------------
+					prepareLikelihoodFieldCache
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::prepareLikelihoodFieldCache()
+{
+	if (!likelihoodOptions.enableLikelihoodCache)
+		return;
+
+	// Reset the precomputed likelihood values map
+	if (precomputedLikelihoodToBeRecomputed || precomputedLikelihood.size()!=map.size())
+	{
+		if (!map.empty())
+				precomputedLikelihood.assign( map.size(),LIK_LF_CACHE_INVALID);
+		else	precomputedLikelihood.clear();
+
+		precomputedLikelihoodToBeRecomputed = false;
+		precomputedLikelihoodIsComplete = false;
+	}
+}
+
+/*---------------------------------------------------------------
+				prepareConcurrentObservationLikelihood
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::prepareConcurrentObservationLikelihood()
+{
+	if (!likelihoodOptions.enableLikelihoodCache || likelihoodOptions.likelihoodMethod!=lmLikelihoodField_Thrun)
+		return;
+
+	// The cache is filled lazily while evaluating likelihoods, which is not thread-safe: fill it all now.
+	// Cells out of the map borders are never looked up (see computeLikelihoodField_Thrun()).
+	prepareLikelihoodFieldCache();
+	if (precomputedLikelihoodIsComplete)
+		return; // Already filled, and the map has not changed since then.
+	for (unsigned int cy=0;cy+1<size_y;cy++)
+		for (unsigned int cx=0;cx+1<size_x;cx++)
+			getLikelihoodField_Thrun_cell(cx,cy);
+	precomputedLikelihoodIsComplete = true;
+}
+
+/*---------------------------------------------------------------
+					getLikelihoodField_Thrun_cell
+ ---------------------------------------------------------------*/
+inline double COccupancyGridMap2D::getLikelihoodField_Thrun_cell(int cx, int cy)
+{
+	if (!likelihoodOptions.enableLikelihoodCache)
+		return computeLikelihoodField_Thrun_cell(cx,cy);
+
+	double &cached = precomputedLikelihood[ cx+cy*size_x ];
+	if (cached==LIK_LF_CACHE_INVALID)
+		cached = computeLikelihoodField_Thrun_cell(cx,cy);
+	return cached;
+}
+
+/*---------------------------------------------------------------
+					computeLikelihoodField_Thrun_cell
+ ---------------------------------------------------------------*/
+double COccupancyGridMap2D::computeLikelihoodField_Thrun_cell(int cx, int cy) const
+{
+	const int K = (int)ceil(likelihoodOptions.LF_maxCorrsDistance/*m*/ / resolution);	// The size of the checking area for matchings:
+	const float zHit = likelihoodOptions.LF_zHit;
+	const float zRandomTerm = likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+	const unsigned int size_x_1 = size_x-1;
+	const unsigned int size_y_1 = size_y-1;
+	const cellType thresholdCellValue = p2l(0.5f);
+	const double constDist2DiscrUnits = 100 / (resolution * resolution);
+	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
+
+	// Find the closest occupied cell in a certain range, given by K:
+	int xx1 = max(0,cx-K);
+	int xx2 = min(size_x_1,(unsigned)(cx+K));
+	int yy1 = max(0,cy-K);
+	int yy2 = min(size_y_1,(unsigned)(cy+K));
+
+	float occupiedMinDist;
+
+	// Optimized code: this part will be invoked a *lot* of times:
+	{
+		const cellType  *mapPtr  = &map[xx1+yy1*size_x]; // Initial pointer position
+		unsigned   incrAfterRow = size_x - ((xx2-xx1)+1);
+
+		signed int Ax0 = 10*(xx1-cx);
+		signed int Ay  = 10*(yy1-cy);
+
+		unsigned int occupiedMinDistInt = mrpt::utils::round( maxCorrDist_sq * constDist2DiscrUnits );
+
+		for (int yy=yy1;yy<=yy2;yy++)
+		{
+			unsigned int Ay2 = square((unsigned int)(Ay)); // Square is faster with unsigned.
+			signed short Ax=Ax0;
+			cellType  cell;
+
+			for (int xx=xx1;xx<=xx2;xx++)
+			{
+				if ( (cell =*mapPtr++) < thresholdCellValue )
+				{
+					unsigned int d = square((unsigned int)(Ax)) + Ay2;
+					keep_min(occupiedMinDistInt, d);
+				}
+				Ax += 10;
+			}
+			// Go to (xx1,yy++)
+			mapPtr += incrAfterRow;
+			Ay += 10;
+		}
+
+		occupiedMinDist = occupiedMinDistInt * constDist2DiscrUnits_INV ;
+	}
+
+	if (likelihoodOptions.LF_useSquareDist)
+		occupiedMinDist*=occupiedMinDist;
+
+	return zRandomTerm  + zHit * exp( Q * occupiedMinDist );
+}
+
 /*---------------------------------------------------------------
 					computeLikelihoodField_Thrun
  ---------------------------------------------------------------*/
@@ -502,7 +621,6 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 
 	double		ret;
 	size_t		N = pm->size();
-	int		K = (int)ceil(likelihoodOptions.LF_maxCorrsDistance/*m*/ / resolution);	// The size of the checking area for matchings:
 
 	bool		Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
 
@@ -529,53 +647,33 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 	double		thisLik;
 	double		maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
 	double		minimumLik = zRandomTerm  + zHit * exp( Q * maxCorrDist_sq );
-	double		ccos,ssin;
-	float		occupiedMinDist;
+	double		ccos=1,ssin=0;
 
-#define LIK_LF_CACHE_INVALID    (66)
-
-    if (likelihoodOptions.enableLikelihoodCache)
-    {
-        // Reset the precomputed likelihood values map
-        if (precomputedLikelihoodToBeRecomputed)
-        {
-			if (!map.empty())
-					precomputedLikelihood.assign( map.size(),LIK_LF_CACHE_INVALID);
-			else	precomputedLikelihood.clear();
+	prepareLikelihoodFieldCache();
 
-			precomputedLikelihoodToBeRecomputed = false;
-        }
-    }
-
-	cellType	thresholdCellValue = p2l(0.5f);
 	int			decimation = likelihoodOptions.LF_decimation;
-
-	const double _resolution = this->resolution;
-	const double constDist2DiscrUnits = 100 / (_resolution * _resolution);
-	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
-
-
 	if (N<10) decimation = 1;
 
+	if (relativePose)
+	{
+#ifdef HAVE_SINCOS
+		::sincos(relativePose->phi(), &ssin,&ccos);
+#else
+		ccos = cos(relativePose->phi());
+		ssin = sin(relativePose->phi());
+#endif
+	}
+
 	TPoint2D	pointLocal;
 	TPoint2D	pointGlobal;
 
 	for (size_t j=0;j<N;j+= decimation)
 	{
-
-		occupiedMinDist = maxCorrDist_sq; // The max.distance
-
 		// Get the point and pass it to global coordinates:
 		if (relativePose)
 		{
 			pm->getPoint(j,pointLocal);
 			//pointGlobal = *relativePose + pointLocal;
-#ifdef HAVE_SINCOS
-			::sincos(relativePose->phi(), &ssin,&ccos);
-#else
-			ccos = cos(relativePose->phi());
-			ssin = sin(relativePose->phi());
-#endif
 			pointGlobal.x = relativePose->x() + pointLocal.x * ccos - pointLocal.y * ssin;
 			pointGlobal.y = relativePose->y() + pointLocal.x * ssin + pointLocal.y * ccos;
 		}
@@ -598,63 +696,7 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 		else
 		{
 			// We are into the map limits:
-            if (likelihoodOptions.enableLikelihoodCache)
-            {
-                thisLik = precomputedLikelihood[ cx+cy*size_x ];
-            }
-
-			if (!likelihoodOptions.enableLikelihoodCache || thisLik==LIK_LF_CACHE_INVALID )
-			{
-				// Compute now:
-				// -------------
-				// Find the closest occupied cell in a certain range, given by K:
-				int xx1 = max(0,cx-K);
-				int xx2 = min(size_x_1,(unsigned)(cx+K));
-				int yy1 = max(0,cy-K);
-				int yy2 = min(size_y_1,(unsigned)(cy+K));
-
-				// Optimized code: this part will be invoked a *lot* of times:
-				{
-					cellType  *mapPtr  = &map[xx1+yy1*size_x]; // Initial pointer position
-					unsigned   incrAfterRow = size_x - ((xx2-xx1)+1);
-
-					signed int Ax0 = 10*(xx1-cx);
-					signed int Ay  = 10*(yy1-cy);
-
-					unsigned int occupiedMinDistInt = mrpt::utils::round( maxCorrDist_sq * constDist2DiscrUnits );
-
-					for (int yy=yy1;yy<=yy2;yy++)
-					{
-						unsigned int Ay2 = square((unsigned int)(Ay)); // Square is faster with unsigned.
-						signed short Ax=Ax0;
-						cellType  cell;
-
-						for (int xx=xx1;xx<=xx2;xx++)
-						{
-							if ( (cell =*mapPtr++) < thresholdCellValue )
-							{
-								unsigned int d = square((unsigned int)(Ax)) + Ay2;
-								keep_min(occupiedMinDistInt, d);
-							}
-							Ax += 10;
-						}
-						// Go to (xx1,yy++)
-						mapPtr += incrAfterRow;
-						Ay += 10;
-					}
-
-					occupiedMinDist = occupiedMinDistInt * constDist2DiscrUnits_INV ;
-				}
-
-				if (likelihoodOptions.LF_useSquareDist)
-					occupiedMinDist*=occupiedMinDist;
-
-				thisLik = zRandomTerm  + zHit * exp( Q * occupiedMinDist );
-
-                if (likelihoodOptions.enableLikelihoodCache)
-                    // And save it into the table and into "thisLik":
-                    precomputedLikelihood[ cx+cy*size_x ] = thisLik;
-			}
+			thisLik = getLikelihoodField_Thrun_cell(cx,cy);
 		}
 
 		// Update the likelihood:
@@ -677,6 +719,153 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+					computeLikelihoodField_Thrun_batch
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::computeLikelihoodField_Thrun_batch(
+	const CPointsMap *pm,
+	const std::vector<mrpt::math::TPose2D> &poses,
+	std::vector<double> &out_log_liks )
+{
+	MRPT_START
+
+	const size_t nPoses = poses.size();
+	out_log_liks.resize(nPoses);
+	if (!nPoses) return;
+
+	const size_t N = pm->size();
+	if (!N)
+	{
+		out_log_liks.assign(nPoses, -100); // No way to estimate this likelihood!!
+		return;
+	}
+
+	const bool Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
+	const float zHit = likelihoodOptions.LF_zHit;
+	const float zRandomTerm = likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance); // (double, as in computeLikelihoodField_Thrun(), for identical results)
+	const double minimumLik = zRandomTerm  + zHit * exp( Q * maxCorrDist_sq );
+	const unsigned int size_x_1 = size_x-1;
+	const unsigned int size_y_1 = size_y-1;
+
+	prepareLikelihoodFieldCache();
+
+	// Gather the (decimated) local points once for all the poses:
+	size_t decimation = likelihoodOptions.LF_decimation;
+	if (N<10) decimation = 1;
+	const size_t nPts = (N+decimation-1)/decimation;
+	const std::vector<float> &pts_x = pm->getPointsBufferRef_x();
+	const std::vector<float> &pts_y = pm->getPointsBufferRef_y();
+	std::vector<double> lxs(nPts), lys(nPts);
+	for (size_t j=0,k=0;j<N;j+=decimation,k++)
+	{
+		lxs[k] = pts_x[j];
+		lys[k] = pts_y[j];
+	}
+	std::vector<int> cxs(nPts+1), cys(nPts+1); // +1: room for the 2-wide SSE2 stores
+
+	for (size_t p=0;p<nPoses;p++)
+	{
+		const mrpt::math::TPose2D &pose = poses[p];
+		double ccos,ssin;
+#ifdef HAVE_SINCOS
+		::sincos(pose.phi, &ssin,&ccos);
+#else
+		ccos = cos(pose.phi);
+		ssin = sin(pose.phi);
+#endif
+
+		// 1) Points to cell indices. Same arithmetic than x2idx(),y2idx() in computeLikelihoodField_Thrun(),
+		//    so the results are identical to that method.
+		size_t k=0;
+#if MRPT_HAS_SSE2
+		{
+			const __m128d px = _mm_set1_pd(pose.x), py = _mm_set1_pd(pose.y);
+			const __m128d c = _mm_set1_pd(ccos), s = _mm_set1_pd(ssin);
+			const __m128d xmin = _mm_set1_pd(x_min), ymin = _mm_set1_pd(y_min);
+			const __m128d res = _mm_set1_pd(resolution);
+			for (;k+1<nPts;k+=2)
+			{
+				const __m128d lx = _mm_loadu_pd(&lxs[k]);
+				const __m128d ly = _mm_loadu_pd(&lys[k]);
+				const __m128d gx = _mm_sub_pd(_mm_add_pd(px,_mm_mul_pd(lx,c)),_mm_mul_pd(ly,s));
+				const __m128d gy = _mm_add_pd(_mm_add_pd(py,_mm_mul_pd(lx,s)),_mm_mul_pd(ly,c));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&cxs[k]), _mm_cvttpd_epi32(_mm_div_pd(_mm_sub_pd(gx,xmin),res)) );
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&cys[k]), _mm_cvttpd_epi32(_mm_div_pd(_mm_sub_pd(gy,ymin),res)) );
+			}
+		}
+#endif
+		for (;k<nPts;k++)
+		{
+			cxs[k] = x2idx( pose.x + lxs[k] * ccos - lys[k] * ssin );
+			cys[k] = y2idx( pose.y + lxs[k] * ssin + lys[k] * ccos );
+		}
+
+		// 2) Look-up (or compute) the likelihood of each cell:
+		double ret = 0;
+		for (k=0;k<nPts;k++)
+		{
+			const int cx = cxs[k], cy = cys[k];
+			const double thisLik = ( static_cast<unsigned>(cx)>=size_x_1 || static_cast<unsigned>(cy)>=size_y_1 ) ?
+				minimumLik : getLikelihoodField_Thrun_cell(cx,cy);
+
+			if (Product_T_OrSum_F)
+				ret += log(thisLik);
+			else ret += thisLik;
+		}
+		if (!Product_T_OrSum_F)
+			ret = log( ret / nPts );
+
+		out_log_liks[p] = ret;
+	}
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					computeObservationLikelihoods
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::computeObservationLikelihoods(
+	const CObservation *obs,
+	const std::vector<mrpt::math::TPose2D> &takenFrom,
+	std::vector<double> &out_log_liks )
+{
+	MRPT_START
+
+	const size_t nPoses = takenFrom.size();
+	out_log_liks.resize(nPoses);
+
+	if (likelihoodOptions.likelihoodMethod==lmLikelihoodField_Thrun &&
+		genericMapParams.enableObservationLikelihood &&
+		IS_CLASS(obs, CObservation2DRangeScan) )
+	{
+		const CObservation2DRangeScan *scan = static_cast<const CObservation2DRangeScan*>(obs);
+		// Same checks than in internal_computeObservationLikelihood() & computeObservationLikelihood_likelihoodField_Thrun()
+		if ( !scan->isPlanarScan(insertionOptions.horizontalTolerance) ||
+			(insertionOptions.useMapAltitude && fabs(insertionOptions.mapAltitude - scan->sensorPose.z() ) > 0.01) )
+		{
+			out_log_liks.assign(nPoses,-10);
+			return;
+		}
+
+		CPointsMap::TInsertionOptions		opts;
+		opts.minDistBetweenLaserPoints	= resolution*0.5f;
+		opts.isPlanarMap				= true; // Already filtered above!
+		opts.horizontalTolerance		= insertionOptions.horizontalTolerance;
+
+		computeLikelihoodField_Thrun_batch( scan->buildAuxPointsMap<mrpt::maps::CPointsMap>(&opts), takenFrom, out_log_liks );
+	}
+	else
+	{
+		// Generic method: one pose at a time.
+		for (size_t i=0;i<nPoses;i++)
+			out_log_liks[i] = computeObservationLikelihood(obs, CPose3D(CPose2D(takenFrom[i])) );
+	}
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 					computeLikelihoodField_II
  ---------------------------------------------------------------*/
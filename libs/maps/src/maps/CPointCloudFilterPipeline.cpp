@@ -0,0 +1,79 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include <mrpt/maps/CPointCloudFilterPipeline.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+
+using namespace mrpt::maps;
+
+void CPointCloudFilterPipeline::filter(
+	mrpt::maps::CPointsMap * pc,
+	const mrpt::system::TTimeStamp pc_timestamp,
+	const mrpt::poses::CPose3D & pc_reference_pose,
+	TExtraFilterParams * params
+)
+{
+	MRPT_START;
+	ASSERT_(pc != nullptr);
+
+	const size_t N = pc->size();
+	const bool want_mask = (params != nullptr && params->out_deletion_mask != nullptr);
+
+	// If the input must be left untouched, work on a copy:
+	CSimplePointsMap pc_copy;
+	CPointsMap *work_pc = pc;
+	if (params != nullptr && params->do_not_delete)
+	{
+		pc_copy.copyFrom(*pc);
+		work_pc = &pc_copy;
+	}
+
+	// Original index of each point surviving so far:
+	std::vector<size_t> orig_idx;
+	if (want_mask) {
+		orig_idx.resize(N);
+		for (size_t i=0;i<N;i++) orig_idx[i]=i;
+	}
+
+	std::vector<bool> stage_mask;
+	TExtraFilterParams stage_params;
+	if (want_mask) stage_params.out_deletion_mask = &stage_mask;
+
+	for (size_t f=0;f<filters.size();f++)
+	{
+		if (!filters[f]) continue;
+		const size_t n_before = work_pc->size();
+		stage_mask.clear();
+		filters[f]->filter(work_pc, pc_timestamp, pc_reference_pose, &stage_params);
+
+		// Some filters may decide not to delete the points marked in their masks (e.g. CPointCloudFilterByDistance):
+		if (want_mask && work_pc->size()!=n_before)
+		{
+			ASSERT_EQUAL_(stage_mask.size(), orig_idx.size());
+			size_t j=0;
+			for (size_t i=0;i<orig_idx.size();i++)
+				if (!stage_mask[i])
+					orig_idx[j++] = orig_idx[i];
+			orig_idx.resize(j);
+			ASSERT_EQUAL_(j, work_pc->size()); // All the filters must honor their deletion masks
+		}
+	}
+
+	if (want_mask)
+	{
+		std::vector<bool> &mask = *params->out_deletion_mask;
+		mask.assign(N, true);
+		for (size_t i=0;i<orig_idx.size();i++)
+			mask[orig_idx[i]] = false;
+	}
+
+	MRPT_END;
+}
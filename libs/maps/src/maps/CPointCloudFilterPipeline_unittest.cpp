@@ -0,0 +1,175 @@
+/* +---------------------------------------------------------------------------+
+|                     Mobile Robot Programming Toolkit (MRPT)               |
+|                          http://www.mrpt.org/                             |
+|                                                                           |
+| Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+| See: http://www.mrpt.org/Authors - All rights reserved.                   |
+| Released under BSD License. See details in http://www.mrpt.org/License    |
++---------------------------------------------------------------------------+ */
+
+#include <mrpt/maps/CPointCloudFilterPipeline.h>
+#include <mrpt/maps/CPointCloudFilterVoxelGrid.h>
+#include <mrpt/maps/CPointCloudFilterRadiusOutliers.h>
+#include <mrpt/maps/CPointCloudFilterStatisticalOutliers.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/maps/CColouredPointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::maps;
+
+// 4x4x4 clusters of 5 points each, centered at the middle of 0.1m voxels, plus some isolated points:
+static void createTestCloud(CPointsMap &m, size_t &num_clusters, size_t &num_isolated)
+{
+	mrpt::random::CRandomGenerator rnd(123);
+	m.clear();
+	num_clusters = 0;
+	for (int ix=-2;ix<2;ix++)
+		for (int iy=-2;iy<2;iy++)
+			for (int iz=0;iz<4;iz++)
+			{
+				for (int k=0;k<5;k++)
+					m.insertPoint( (ix+0.5)*0.1 + rnd.drawUniform(-0.01,0.01), (iy+0.5)*0.1 + rnd.drawUniform(-0.01,0.01), (iz+0.5)*0.1 + rnd.drawUniform(-0.01,0.01) );
+				num_clusters++;
+			}
+	m.insertPoint(3.05,0.05,0.05);
+	m.insertPoint(-2.05,1.05,0.55);
+	num_isolated = 2;
+}
+
+TEST(CPointCloudFilterVoxelGrid, downsample)
+{
+	CSimplePointsMap pc;
+	size_t nClusters, nIsolated;
+	createTestCloud(pc,nClusters,nIsolated);
+	const size_t N = pc.size();
+
+	CPointCloudFilterVoxelGrid f;
+	f.options.voxel_size = 0.1;
+	std::vector<bool> mask;
+	CPointCloudFilterBase::TExtraFilterParams extra;
+	extra.out_deletion_mask = &mask;
+	f.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D(), &extra);
+
+	EXPECT_EQ(pc.size(), nClusters+nIsolated);
+	ASSERT_EQ(mask.size(), N);
+	size_t nKept = 0;
+	for (size_t i=0;i<N;i++) if (!mask[i]) nKept++;
+	EXPECT_EQ(nKept, pc.size());
+
+	// Surviving points are the voxel centroids, in the original order:
+	float x,y,z;
+	pc.getPoint(0,x,y,z);
+	EXPECT_NEAR(x,-0.15,0.01); EXPECT_NEAR(y,-0.15,0.01); EXPECT_NEAR(z,0.05,0.01);
+	pc.getPoint(pc.size()-1,x,y,z);
+	EXPECT_FLOAT_EQ(x,-2.05f); EXPECT_FLOAT_EQ(y,1.05f); EXPECT_FLOAT_EQ(z,0.55f);
+
+	// Remove voxels with few points:
+	createTestCloud(pc,nClusters,nIsolated);
+	f.options.min_points_per_voxel = 2;
+	f.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D());
+	EXPECT_EQ(pc.size(), nClusters);
+}
+
+TEST(CPointCloudFilterVoxelGrid, keepsColorOfFirstPoint)
+{
+	CColouredPointsMap pc;
+	pc.insertPoint(0.01f,0.01f,0.01f, 1.f,0.f,0.f);
+	pc.insertPoint(0.03f,0.03f,0.03f, 0.f,1.f,0.f);
+	pc.insertPoint(0.51f,0.01f,0.01f, 0.f,0.f,1.f);
+
+	CPointCloudFilterVoxelGrid f;
+	f.options.voxel_size = 0.1;
+	f.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D());
+	ASSERT_EQ(pc.size(), 2u);
+
+	float x,y,z,R,G,B;
+	pc.getPoint(0,x,y,z,R,G,B);
+	EXPECT_FLOAT_EQ(x,0.02f);
+	EXPECT_FLOAT_EQ(R,1.f); EXPECT_FLOAT_EQ(G,0.f);
+	pc.getPoint(1,x,y,z,R,G,B);
+	EXPECT_FLOAT_EQ(x,0.51f);
+	EXPECT_FLOAT_EQ(B,1.f);
+}
+
+TEST(CPointCloudFilterRadiusOutliers, removeIsolated)
+{
+	CSimplePointsMap pc;
+	size_t nClusters, nIsolated;
+	createTestCloud(pc,nClusters,nIsolated);
+	const size_t N = pc.size();
+
+	CPointCloudFilterRadiusOutliers f;
+	f.options.radius = 0.05;
+	f.options.min_neighbors = 3;
+	f.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D());
+	EXPECT_EQ(pc.size(), N-nIsolated);
+}
+
+TEST(CPointCloudFilterStatisticalOutliers, removeIsolated)
+{
+	CSimplePointsMap pc;
+	size_t nClusters, nIsolated;
+	createTestCloud(pc,nClusters,nIsolated);
+	const size_t N = pc.size();
+
+	CPointCloudFilterStatisticalOutliers f;
+	f.options.mean_k = 4;
+	f.options.std_dev_mul = 1.0;
+	std::vector<bool> mask;
+	CPointCloudFilterBase::TExtraFilterParams extra;
+	extra.out_deletion_mask = &mask;
+	f.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D(), &extra);
+	EXPECT_EQ(pc.size(), N-nIsolated);
+	EXPECT_TRUE(mask[N-1]);
+	EXPECT_TRUE(mask[N-2]);
+}
+
+TEST(CPointCloudFilterPipeline, chainAndMask)
+{
+	CSimplePointsMap pc, pc_orig;
+	size_t nClusters, nIsolated;
+	createTestCloud(pc,nClusters,nIsolated);
+	pc_orig.copyFrom(pc);
+	const size_t N = pc.size();
+
+	CPointCloudFilterPipeline pipeline;
+	CPointCloudFilterRadiusOutliers *rof = new CPointCloudFilterRadiusOutliers;
+	rof->options.radius = 0.05;
+	rof->options.min_neighbors = 3;
+	CPointCloudFilterVoxelGrid *vg = new CPointCloudFilterVoxelGrid;
+	vg->options.voxel_size = 0.1;
+	vg->options.use_centroid = false;
+	pipeline.filters.push_back(CPointCloudFilterBasePtr(rof));
+	pipeline.filters.push_back(CPointCloudFilterBasePtr(vg));
+
+	// Only compute the mask:
+	std::vector<bool> mask;
+	CPointCloudFilterBase::TExtraFilterParams extra;
+	extra.out_deletion_mask = &mask;
+	extra.do_not_delete = true;
+	pipeline.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D(), &extra);
+	EXPECT_EQ(pc.size(), N);
+	ASSERT_EQ(mask.size(), N);
+
+	// Now, for real:
+	std::vector<bool> mask2;
+	extra.out_deletion_mask = &mask2;
+	extra.do_not_delete = false;
+	pipeline.filter(&pc, mrpt::system::now(), mrpt::poses::CPose3D(), &extra);
+	EXPECT_EQ(pc.size(), nClusters);
+	EXPECT_TRUE(mask==mask2);
+
+	// The mask refers to the input points:
+	size_t j = 0;
+	for (size_t i=0;i<N;i++)
+	{
+		if (mask[i]) continue;
+		float x0,y0,z0,x,y,z;
+		pc_orig.getPoint(i,x0,y0,z0);
+		pc.getPoint(j++,x,y,z);
+		EXPECT_EQ(x0,x); EXPECT_EQ(y0,y); EXPECT_EQ(z0,z);
+	}
+	EXPECT_EQ(j, pc.size());
+}
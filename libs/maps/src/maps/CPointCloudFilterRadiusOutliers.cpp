@@ -0,0 +1,95 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include <mrpt/maps/CPointCloudFilterRadiusOutliers.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/utils/CConfigFileBase.h>
+#include "CPointCloudVoxelIndex.h"
+
+using namespace mrpt::maps;
+using namespace mrpt::utils;
+
+void CPointCloudFilterRadiusOutliers::filter(
+	mrpt::maps::CPointsMap * pc,
+	const mrpt::system::TTimeStamp ,
+	const mrpt::poses::CPose3D & ,
+	TExtraFilterParams * params
+)
+{
+	MRPT_START;
+	ASSERT_(pc != nullptr);
+
+	const size_t N = pc->size();
+	std::vector<bool> deletion_mask(N, false);
+
+	if (N>0 && options.min_neighbors>0)
+	{
+		const std::vector<float> &xs = pc->getPointsBufferRef_x(), &ys = pc->getPointsBufferRef_y(), &zs = pc->getPointsBufferRef_z();
+		detail::CPointCloudVoxelIndex vi;
+		vi.build(&xs[0],&ys[0],&zs[0],N,options.radius);
+
+		const std::vector<uint32_t> &pts = vi.pointIndices();
+		const float r2 = static_cast<float>(options.radius*options.radius);
+		const unsigned int min_nn = options.min_neighbors;
+
+		for (size_t i=0;i<N;i++)
+		{
+			int32_t cx,cy,cz;
+			vi.voxelCoordsOfPoint(i,cx,cy,cz);
+			const float x=xs[i], y=ys[i], z=zs[i];
+
+			// Count neighbors in the 27 surrounding voxels, until we have enough:
+			unsigned int nn = 0;
+			for (int dx=-1;dx<=1 && nn<min_nn;dx++)
+				for (int dy=-1;dy<=1 && nn<min_nn;dy++)
+					for (int dz=-1;dz<=1 && nn<min_nn;dz++)
+					{
+						const int64_t v = vi.findVoxel(cx+dx,cy+dy,cz+dz);
+						if (v<0) continue;
+						for (size_t k=vi.voxelBegin(v), k1=vi.voxelEnd(v);k<k1 && nn<min_nn;k++)
+						{
+							const size_t j = pts[k];
+							if (j==i) continue;
+							if (square(xs[j]-x)+square(ys[j]-y)+square(zs[j]-z)<=r2)
+								nn++;
+						}
+					}
+			deletion_mask[i] = (nn<min_nn);
+		}
+
+		if (params == nullptr || params->do_not_delete == false)
+			pc->applyDeletionMask(deletion_mask);
+	}
+
+	if (params != nullptr && params->out_deletion_mask != nullptr) {
+		params->out_deletion_mask->swap(deletion_mask);
+	}
+
+	MRPT_END;
+}
+
+CPointCloudFilterRadiusOutliers::TOptions::TOptions() :
+	radius(0.10),
+	min_neighbors(2)
+{
+}
+
+void CPointCloudFilterRadiusOutliers::TOptions::loadFromConfigFile(const mrpt::utils::CConfigFileBase &c, const std::string &s)
+{
+	MRPT_LOAD_CONFIG_VAR(radius, double, c, s);
+	MRPT_LOAD_CONFIG_VAR(min_neighbors, int, c, s);
+}
+
+void CPointCloudFilterRadiusOutliers::TOptions::saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &s) const
+{
+	MRPT_SAVE_CONFIG_VAR_COMMENT(radius, "Neighborhood radius [m]");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(min_neighbors, "Minimum number of other points within `radius` for a point to be kept");
+}
@@ -0,0 +1,94 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include <mrpt/maps/CPointCloudFilterStatisticalOutliers.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/utils/CConfigFileBase.h>
+
+using namespace mrpt::maps;
+using namespace mrpt::utils;
+
+void CPointCloudFilterStatisticalOutliers::filter(
+	mrpt::maps::CPointsMap * pc,
+	const mrpt::system::TTimeStamp ,
+	const mrpt::poses::CPose3D & ,
+	TExtraFilterParams * params
+)
+{
+	MRPT_START;
+	ASSERT_(pc != nullptr);
+	ASSERT_ABOVE_(options.mean_k,0u)
+
+	const size_t N = pc->size();
+	std::vector<bool> deletion_mask(N, false);
+
+	if (N>1)
+	{
+		const std::vector<float> &xs = pc->getPointsBufferRef_x(), &ys = pc->getPointsBufferRef_y(), &zs = pc->getPointsBufferRef_z();
+
+		// 1) Mean distance of each point to its K neighbors (the first result is the point itself):
+		const size_t K = std::min<size_t>(options.mean_k, N-1);
+		std::vector<double> mean_dists(N);
+		std::vector<size_t> nn_idxs;
+		std::vector<float>  nn_sq_dists;
+		double sum=0, sum_sq=0;
+		for (size_t i=0;i<N;i++)
+		{
+			pc->kdTreeNClosestPoint3DIdx(xs[i],ys[i],zs[i], K+1, nn_idxs, nn_sq_dists);
+			double d = 0;
+			size_t n = 0;
+			for (size_t k=0;k<nn_idxs.size();k++)
+			{
+				if (nn_idxs[k]==i) continue;
+				d+=std::sqrt(nn_sq_dists[k]);
+				if (++n==K) break;
+			}
+			if (n) d/=n;
+			mean_dists[i] = d;
+			sum+=d;
+			sum_sq+=d*d;
+		}
+
+		// 2) Threshold from the global statistics:
+		const double mean = sum/N;
+		const double std_dev = std::sqrt( std::max(0.0, sum_sq/N - mean*mean) );
+		const double max_dist = mean + options.std_dev_mul * std_dev;
+		for (size_t i=0;i<N;i++)
+			deletion_mask[i] = mean_dists[i]>max_dist;
+
+		if (params == nullptr || params->do_not_delete == false)
+			pc->applyDeletionMask(deletion_mask);
+	}
+
+	if (params != nullptr && params->out_deletion_mask != nullptr) {
+		params->out_deletion_mask->swap(deletion_mask);
+	}
+
+	MRPT_END;
+}
+
+CPointCloudFilterStatisticalOutliers::TOptions::TOptions() :
+	mean_k(8),
+	std_dev_mul(1.0)
+{
+}
+
+void CPointCloudFilterStatisticalOutliers::TOptions::loadFromConfigFile(const mrpt::utils::CConfigFileBase &c, const std::string &s)
+{
+	MRPT_LOAD_CONFIG_VAR(mean_k, int, c, s);
+	MRPT_LOAD_CONFIG_VAR(std_dev_mul, double, c, s);
+}
+
+void CPointCloudFilterStatisticalOutliers::TOptions::saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &s) const
+{
+	MRPT_SAVE_CONFIG_VAR_COMMENT(mean_k, "Number of nearest neighbors used to compute the mean distance of each point");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(std_dev_mul, "Number of standard deviations above the mean distance for a point to be considered an outlier");
+}
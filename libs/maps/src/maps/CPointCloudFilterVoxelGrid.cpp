@@ -0,0 +1,94 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include <mrpt/maps/CPointCloudFilterVoxelGrid.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/utils/CConfigFileBase.h>
+#include "CPointCloudVoxelIndex.h"
+
+using namespace mrpt::maps;
+using namespace mrpt::utils;
+
+void CPointCloudFilterVoxelGrid::filter(
+	mrpt::maps::CPointsMap * pc,
+	const mrpt::system::TTimeStamp ,
+	const mrpt::poses::CPose3D & ,
+	TExtraFilterParams * params
+)
+{
+	MRPT_START;
+	ASSERT_(pc != nullptr);
+
+	const size_t N = pc->size();
+	std::vector<bool> deletion_mask(N, true);
+
+	if (N>0)
+	{
+		const std::vector<float> &xs = pc->getPointsBufferRef_x(), &ys = pc->getPointsBufferRef_y(), &zs = pc->getPointsBufferRef_z();
+		detail::CPointCloudVoxelIndex vi;
+		vi.build(&xs[0],&ys[0],&zs[0],N,options.voxel_size);
+
+		const std::vector<uint32_t> &pts = vi.pointIndices();
+		const bool do_delete = (params == nullptr || params->do_not_delete == false);
+
+		const size_t nVoxels = vi.voxelCount();
+		for (size_t v=0;v<nVoxels;v++)
+		{
+			const size_t i0 = vi.voxelBegin(v), i1 = vi.voxelEnd(v);
+			if (i1-i0 < options.min_points_per_voxel)
+				continue; // Remove all the points in this voxel
+
+			const size_t first_pt = pts[i0]; // The lowest index within the voxel
+			deletion_mask[first_pt] = false;
+
+			if (options.use_centroid && do_delete && i1-i0>1)
+			{
+				double sx=0,sy=0,sz=0;
+				for (size_t k=i0;k<i1;k++) {
+					const size_t i = pts[k];
+					sx+=xs[i]; sy+=ys[i]; sz+=zs[i];
+				}
+				const double inv_n = 1.0/(i1-i0);
+				pc->setPointFast(first_pt, static_cast<float>(sx*inv_n), static_cast<float>(sy*inv_n), static_cast<float>(sz*inv_n) );
+			}
+		}
+
+		if (do_delete)
+			pc->applyDeletionMask(deletion_mask);
+	}
+
+	if (params != nullptr && params->out_deletion_mask != nullptr) {
+		params->out_deletion_mask->swap(deletion_mask);
+	}
+
+	MRPT_END;
+}
+
+CPointCloudFilterVoxelGrid::TOptions::TOptions() :
+	voxel_size(0.10),
+	use_centroid(true),
+	min_points_per_voxel(1)
+{
+}
+
+void CPointCloudFilterVoxelGrid::TOptions::loadFromConfigFile(const mrpt::utils::CConfigFileBase &c, const std::string &s)
+{
+	MRPT_LOAD_CONFIG_VAR(voxel_size, double, c, s);
+	MRPT_LOAD_CONFIG_VAR(use_centroid, bool, c, s);
+	MRPT_LOAD_CONFIG_VAR(min_points_per_voxel, int, c, s);
+}
+
+void CPointCloudFilterVoxelGrid::TOptions::saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &s) const
+{
+	MRPT_SAVE_CONFIG_VAR_COMMENT(voxel_size, "Side length of each voxel [m]");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(use_centroid, "Move each surviving point to the centroid of its voxel");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(min_points_per_voxel, "Voxels with less points than this are entirely removed");
+}
@@ -0,0 +1,65 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include "CPointCloudVoxelIndex.h"
+#include <cmath>
+
+using namespace mrpt::maps::detail;
+
+void CPointCloudVoxelIndex::build(const float *xs, const float *ys, const float *zs, const size_t N, const double voxel_size)
+{
+	MRPT_START
+	ASSERT_ABOVE_(voxel_size,0.0)
+	ASSERT_BELOW_(N, size_t(0xFFFFFFFF))
+
+	const double inv_size = 1.0/voxel_size;
+	const double max_coord = (KEY_OFFSET-1)*voxel_size;
+
+	m_keys.resize(N);
+	m_point_voxel.resize(N);
+	m_voxels.clear();
+	m_voxels.reserve(N/2+1);
+
+	// 1) Voxel of each point, voxels numbered by first appearance:
+	std::vector<uint32_t> counts;
+	counts.reserve(N/2+1);
+	for (size_t i=0;i<N;i++)
+	{
+		if (std::abs(xs[i])>=max_coord || std::abs(ys[i])>=max_coord || std::abs(zs[i])>=max_coord)
+			THROW_EXCEPTION_FMT("Point #%u (%f,%f,%f) is out of the range of the voxel index with voxel size %f",static_cast<unsigned int>(i),xs[i],ys[i],zs[i],voxel_size)
+
+		const uint64_t key = packKey(
+			static_cast<int32_t>(std::floor(xs[i]*inv_size)),
+			static_cast<int32_t>(std::floor(ys[i]*inv_size)),
+			static_cast<int32_t>(std::floor(zs[i]*inv_size)) );
+		m_keys[i] = key;
+
+		const std::pair<std::unordered_map<uint64_t,uint32_t>::iterator,bool> ins = m_voxels.insert( std::make_pair(key, static_cast<uint32_t>(counts.size()) ) );
+		if (ins.second) counts.push_back(0);
+		const uint32_t v = ins.first->second;
+		m_point_voxel[i] = v;
+		counts[v]++;
+	}
+
+	// 2) Counting sort of point indices by voxel:
+	const size_t nVoxels = counts.size();
+	m_voxel_first.resize(nVoxels+1);
+	m_voxel_first[0] = 0;
+	for (size_t v=0;v<nVoxels;v++)
+		m_voxel_first[v+1] = m_voxel_first[v] + counts[v];
+
+	m_pts.resize(N);
+	for (size_t v=0;v<nVoxels;v++) counts[v] = m_voxel_first[v];
+	for (size_t i=0;i<N;i++)
+		m_pts[ counts[m_point_voxel[i]]++ ] = static_cast<uint32_t>(i);
+
+	MRPT_END
+}
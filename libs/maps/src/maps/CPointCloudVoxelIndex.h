@@ -0,0 +1,68 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/utils/mrpt_stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace mrpt
+{
+	namespace maps
+	{
+		namespace detail
+		{
+			/** Internal: hashed voxel index of a point cloud, used by the voxel-based point cloud filters.
+			  * Points are bucketed into cubic voxels of a fixed size. Voxels are numbered in the order
+			  * of appearance of their first point, and the indices of the points in each voxel are kept
+			  * in increasing order in one contiguous array (CSR layout).
+			  */
+			class CPointCloudVoxelIndex
+			{
+			public:
+				/** Build the index for the points (xs[i],ys[i],zs[i]), i=[0,N). Throws if a point is too far from the origin for the given voxel size. */
+				void build(const float *xs, const float *ys, const float *zs, const size_t N, const double voxel_size);
+
+				inline size_t voxelCount() const { return m_voxel_first.size()-1; }
+				inline size_t voxelOfPoint(size_t pt_idx) const { return m_point_voxel[pt_idx]; }
+				/** Point indices of voxel `v` are `pointIndices()[voxelBegin(v)]...pointIndices()[voxelEnd(v)-1]` */
+				inline size_t voxelBegin(size_t v) const { return m_voxel_first[v]; }
+				inline size_t voxelEnd(size_t v) const { return m_voxel_first[v+1]; }
+				inline const std::vector<uint32_t> & pointIndices() const { return m_pts; }
+
+				/** Returns the voxel with the given integer coordinates, or -1 if it is empty. */
+				inline int64_t findVoxel(int32_t ix, int32_t iy, int32_t iz) const {
+					const std::unordered_map<uint64_t,uint32_t>::const_iterator it = m_voxels.find(packKey(ix,iy,iz));
+					return it==m_voxels.end() ? -1 : static_cast<int64_t>(it->second);
+				}
+				/** Integer coordinates of the voxel containing the i'th point. */
+				inline void voxelCoordsOfPoint(size_t pt_idx, int32_t &ix, int32_t &iy, int32_t &iz) const {
+					const uint64_t k = m_keys[pt_idx];
+					ix = static_cast<int32_t>( (k>>42) & KEY_MASK) - KEY_OFFSET;
+					iy = static_cast<int32_t>( (k>>21) & KEY_MASK) - KEY_OFFSET;
+					iz = static_cast<int32_t>(  k      & KEY_MASK) - KEY_OFFSET;
+				}
+
+			private:
+				static const int32_t  KEY_OFFSET = 1<<20;        //!< Voxel coordinates are stored with 21 bits each
+				static const uint64_t KEY_MASK   = (1<<21)-1;
+
+				static inline uint64_t packKey(int32_t ix, int32_t iy, int32_t iz) {
+					return (static_cast<uint64_t>(ix+KEY_OFFSET)<<42) | (static_cast<uint64_t>(iy+KEY_OFFSET)<<21) | static_cast<uint64_t>(iz+KEY_OFFSET);
+				}
+
+				std::vector<uint64_t> m_keys;         //!< Packed voxel coordinates of each point
+				std::vector<uint32_t> m_point_voxel;  //!< Voxel index of each point
+				std::vector<uint32_t> m_voxel_first;  //!< CSR offsets of each voxel in m_pts (plus a last sentinel)
+				std::vector<uint32_t> m_pts;          //!< Point indices, sorted by voxel
+				std::unordered_map<uint64_t,uint32_t> m_voxels; //!< packed key -> voxel index
+			};
+		}
+	}
+} // End of namespace
@@ -13,6 +13,7 @@
 #include <mrpt/utils/CTicTac.h>
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/system/os.h>
+#include <mrpt/system/threads.h>
 #include <mrpt/math/geometry.h>
 #include <mrpt/utils/CStream.h>
 
@@ -325,29 +326,16 @@ void CPointsMap::determineMatching2D(
 
 	const size_t nLocalPoints = otherMap->size();
 	const size_t nGlobalPoints = this->size();
-	float _sumSqrDist=0;
-	size_t _sumSqrCount = 0;
-	size_t nOtherMapPointsWithCorrespondence = 0;	// Number of points with one corrs. at least
 
 	float local_x_min= std::numeric_limits<float>::max(), local_x_max= -std::numeric_limits<float>::max();
 	float global_x_min=std::numeric_limits<float>::max(), global_x_max= -std::numeric_limits<float>::max();
 	float local_y_min= std::numeric_limits<float>::max(), local_y_max= -std::numeric_limits<float>::max();
 	float global_y_min=std::numeric_limits<float>::max(), global_y_max= -std::numeric_limits<float>::max();
 
-	double       maxDistForCorrespondenceSquared;
-	float        x_local, y_local;
-	unsigned int localIdx;
-
-	const float *x_other_it,*y_other_it,*z_other_it; // *x_global_it,*y_global_it; //,*z_global_it;
-
-	// Prepare output: no correspondences initially:
+	// Prepare output: no correspondences initially (keep the already reserved memory, if any):
 	correspondences.clear();
-	correspondences.reserve(nLocalPoints);
 	extraResults.correspondencesRatio = 0;
 
-	TMatchingPairList _correspondences;
-	_correspondences.reserve(nLocalPoints);
-
 	// Hay mapa global?
 	if (!nGlobalPoints) return;  // No
 
@@ -467,88 +455,8 @@ void CPointsMap::determineMatching2D(
 		local_y_min>global_y_max ||
 		local_y_max<global_y_min) return;	// We know for sure there is no matching at all
 
-
-	// Loop for each point in local map:
-	// --------------------------------------------------
-	for ( localIdx=params.offset_other_map_points,
-			x_other_it=&otherMap->x[params.offset_other_map_points],
-			y_other_it=&otherMap->y[params.offset_other_map_points],
-			z_other_it=&otherMap->z[params.offset_other_map_points];
-			localIdx<nLocalPoints;
-			x_other_it+=params.decimation_other_map_points,y_other_it+=params.decimation_other_map_points,z_other_it+=params.decimation_other_map_points,localIdx+=params.decimation_other_map_points )
-	{
-		// For speed-up:
-		x_local = x_locals[localIdx]; // *x_locals_it;
-		y_local = y_locals[localIdx]; // *y_locals_it;
-
-		// Find all the matchings in the requested distance:
-
-		// KD-TREE implementation =================================
-		// Use a KD-tree to look for the nearnest neighbor of:
-		//   (x_local, y_local, z_local)
-		// In "this" (global/reference) points map.
-
-		float tentativ_err_sq;
-		unsigned int tentativ_this_idx = kdTreeClosestPoint2D(
-			x_local,  y_local,  // Look closest to this guy
-			tentativ_err_sq // save here the min. distance squared
-			);
-
-		// Compute max. allowed distance:
-		maxDistForCorrespondenceSquared = square(
-			params.maxAngularDistForCorrespondence * std::sqrt( square(params.angularDistPivotPoint.x-x_local) + square(params.angularDistPivotPoint.y-y_local) ) +
-					params.maxDistForCorrespondence );
-
-		// Distance below the threshold??
-		if ( tentativ_err_sq < maxDistForCorrespondenceSquared )
-		{
-			// Save all the correspondences:
-			_correspondences.resize(_correspondences.size()+1);
-
-			TMatchingPair & p = _correspondences.back();
-
-			p.this_idx = tentativ_this_idx;
-			p.this_x = x[tentativ_this_idx];
-			p.this_y = y[tentativ_this_idx];
-			p.this_z = z[tentativ_this_idx];
-
-			p.other_idx = localIdx;
-			p.other_x = *x_other_it;
-			p.other_y = *y_other_it;
-			p.other_z = *z_other_it;
-
-			p.errorSquareAfterTransformation  = tentativ_err_sq;
-
-			// At least one:
-			nOtherMapPointsWithCorrespondence++;
-
-			// Accumulate the MSE:
-			_sumSqrDist+= p.errorSquareAfterTransformation;
-			_sumSqrCount++;
-		}
-
-	} // For each local point
-
-	// Additional consistency filter: "onlyKeepTheClosest" up to now
-	//  led to just one correspondence for each "local map" point, but
-	//  many of them may have as corresponding pair the same "global point"!!
-	// -------------------------------------------------------------------------
-	if (params.onlyUniqueRobust) {
-		ASSERTMSG_(params.onlyKeepTheClosest, "ERROR: onlyKeepTheClosest must be also set to true when onlyUniqueRobust=true.");
-		_correspondences.filterUniqueRobustPairs(nGlobalPoints,correspondences);
-	}
-	else {
-		correspondences.swap(_correspondences);
-	}
-
-	// If requested, copy sum of squared distances to output pointer:
-	// -------------------------------------------------------------------
-	if (_sumSqrCount)
-			extraResults.sumSqrDist = _sumSqrDist / static_cast<double>(_sumSqrCount);
-	else	extraResults.sumSqrDist = 0;
-
-	// The ratio of points in the other map with corrs:
-	extraResults.correspondencesRatio = params.decimation_other_map_points*nOtherMapPointsWithCorrespondence / static_cast<float>(nLocalPoints);
+	// Nearest neighbours of each local point in "this" (global/reference) map:
+	determineMatching_NN(otherMap, &x_locals[0], &y_locals[0], NULL, correspondences, params, extraResults);
 
 	MRPT_END
 }
@@ -1027,23 +935,13 @@ void  CPointsMap::determineMatching3D(
 
 	const size_t nLocalPoints = otherMap->size();
 	const size_t nGlobalPoints = this->size();
-	float					_sumSqrDist=0;
-	size_t					_sumSqrCount = 0;
-	size_t					nOtherMapPointsWithCorrespondence = 0;	// Number of points with one corrs. at least
 
 	float local_x_min= std::numeric_limits<float>::max(), local_x_max= -std::numeric_limits<float>::max();
 	float local_y_min= std::numeric_limits<float>::max(), local_y_max= -std::numeric_limits<float>::max();
 	float local_z_min= std::numeric_limits<float>::max(), local_z_max= -std::numeric_limits<float>::max();
 
-	double					maxDistForCorrespondenceSquared;
-
-
-	// Prepare output: no correspondences initially:
+	// Prepare output: no correspondences initially (keep the already reserved memory, if any):
 	correspondences.clear();
-	correspondences.reserve(nLocalPoints);
-
-	TMatchingPairList _correspondences;
-	_correspondences.reserve(nLocalPoints);
 
 	// Empty maps?  Nothing to do
 	if (!nGlobalPoints || !nLocalPoints) return;
@@ -1086,80 +984,159 @@ void  CPointsMap::determineMatching3D(
 		local_y_min>global_y_max ||
 		local_y_max<global_y_min) return;	// No need to compute: matching is ZERO.
 
-	// Loop for each point in local map:
-	// --------------------------------------------------
-	for (unsigned int localIdx=params.offset_other_map_points; localIdx<nLocalPoints; localIdx+=params.decimation_other_map_points)
-	{
-		// For speed-up:
-		const float x_local = x_locals[localIdx];
-		const float y_local = y_locals[localIdx];
-		const float z_local = z_locals[localIdx];
+	// Nearest neighbours of each local point in "this" (global/reference) map:
+	determineMatching_NN(otherMap, &x_locals[0], &y_locals[0], &z_locals[0], correspondences, params, extraResults);
 
-		{
-			// KD-TREE implementation
-			// Use a KD-tree to look for the nearnest neighbor of:
-			//   (x_local, y_local, z_local)
-			// In "this" (global/reference) points map.
+	MRPT_END
+}
 
-			float tentativ_err_sq;
-			const unsigned int tentativ_this_idx = kdTreeClosestPoint3D(
-				x_local,  y_local, z_local,  // Look closest to this guy
-				tentativ_err_sq // save here the min. distance squared
-				);
+namespace
+{
+	/** Data shared by the threads in CPointsMap::determineMatching_NN() */
+	struct TMatchingNNThreadsData
+	{
+		const CPointsMap      * me;
+		const CPointsMap      * otherMap;
+		const float           * x_locals, * y_locals, * z_locals;
+		const TMatchingParams * params;
+		TMatchingPair         * out_pairs; //!< One slot per query point. Slots without a pairing are marked with errorSquareAfterTransformation<0
+	};
+}
 
-			// Compute max. allowed distance:
-			maxDistForCorrespondenceSquared = square(
-						params.maxAngularDistForCorrespondence * params.angularDistPivotPoint.distanceTo(TPoint3D(x_local,y_local,z_local)) +
-						params.maxDistForCorrespondence );
+/*---------------------------------------------------------------
+				determineMatching_NN
+---------------------------------------------------------------*/
+void CPointsMap::determineMatching_NNBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+{
+	MRPT_UNUSED_PARAM(thread_idx);
+	const TMatchingNNThreadsData &d = *static_cast<const TMatchingNNThreadsData*>(user_param);
+	const TMatchingParams &params = *d.params;
+	const CPointsMap &me = *d.me;
+	const bool is_3D = (d.z_locals!=NULL);
 
-			// Distance below the threshold??
-			if ( tentativ_err_sq < maxDistForCorrespondenceSquared )
-			{
-				// Save all the correspondences:
-				_correspondences.resize(_correspondences.size()+1);
+	for (size_t k=first;k<last;k++)
+	{
+		const size_t localIdx = params.offset_other_map_points + k*params.decimation_other_map_points;
+		const float x_local = d.x_locals[localIdx];
+		const float y_local = d.y_locals[localIdx];
+		const float z_local = is_3D ? d.z_locals[localIdx] : 0;
 
-				TMatchingPair & p = _correspondences.back();
+		// Use the KD-tree to look for the nearest neighbor in "this" (global/reference) points map:
+		float tentativ_err_sq;
+		const unsigned int tentativ_this_idx = is_3D ?
+			me.kdTreeClosestPoint3D(x_local,y_local,z_local, tentativ_err_sq) :
+			me.kdTreeClosestPoint2D(x_local,y_local, tentativ_err_sq);
 
-				p.this_idx = tentativ_this_idx;
-				p.this_x = x[tentativ_this_idx];
-				p.this_y = y[tentativ_this_idx];
-				p.this_z = z[tentativ_this_idx];
+		// Compute max. allowed distance:
+		const double maxDistForCorrespondenceSquared = square(
+			params.maxAngularDistForCorrespondence * (is_3D ?
+				params.angularDistPivotPoint.distanceTo(TPoint3D(x_local,y_local,z_local)) :
+				std::sqrt( square(params.angularDistPivotPoint.x-x_local) + square(params.angularDistPivotPoint.y-y_local) ) ) +
+			params.maxDistForCorrespondence );
 
-				p.other_idx = localIdx;
-				p.other_x = otherMap->x[localIdx];
-				p.other_y = otherMap->y[localIdx];
-				p.other_z = otherMap->z[localIdx];
+		TMatchingPair & p = d.out_pairs[k];
 
-				p.errorSquareAfterTransformation  = tentativ_err_sq;
+		// Distance below the threshold??
+		if ( tentativ_err_sq < maxDistForCorrespondenceSquared )
+		{
+			p.this_idx = tentativ_this_idx;
+			p.this_x = me.x[tentativ_this_idx];
+			p.this_y = me.y[tentativ_this_idx];
+			p.this_z = me.z[tentativ_this_idx];
 
-				// At least one:
-				nOtherMapPointsWithCorrespondence++;
+			p.other_idx = localIdx;
+			p.other_x = d.otherMap->x[localIdx];
+			p.other_y = d.otherMap->y[localIdx];
+			p.other_z = d.otherMap->z[localIdx];
 
-				// Accumulate the MSE:
-				_sumSqrDist+= p.errorSquareAfterTransformation;
-				_sumSqrCount++;
-			}
+			p.errorSquareAfterTransformation  = tentativ_err_sq;
+		}
+		else
+		{
+			p.errorSquareAfterTransformation = -1; // No pairing
+		}
+	}
+}
 
+void CPointsMap::determineMatching_NN(
+	const CPointsMap      * otherMap,
+	const float *x_locals, const float *y_locals, const float *z_locals,
+	TMatchingPairList     & correspondences,
+	const TMatchingParams & params,
+	TMatchingExtraResults & extraResults ) const
+{
+	MRPT_START
 
-		} // End of test_match
-	} // For each local point
+	const size_t nLocalPoints = otherMap->size();
+	const size_t nGlobalPoints = this->size();
+	ASSERT_(nLocalPoints>0 && nGlobalPoints>0)
+
+	// Number of points from the other map to be queried:
+	const size_t nQueries = (nLocalPoints>params.offset_other_map_points) ?
+		1 + (nLocalPoints-params.offset_other_map_points-1)/params.decimation_other_map_points : 0;
+
+	// Build the KD-tree now, from this thread, so the queries below don't modify it:
+	if (z_locals) rebuild_kdTree_3D();
+	else          rebuild_kdTree_2D();
+
+	// One slot per query point. resize() reuses the memory of the previous call, if the caller keeps the list:
+	correspondences.resize(nQueries);
+
+	TMatchingNNThreadsData thread_data;
+	thread_data.me = this;
+	thread_data.otherMap = otherMap;
+	thread_data.x_locals = x_locals;
+	thread_data.y_locals = y_locals;
+	thread_data.z_locals = z_locals;
+	thread_data.params = &params;
+	thread_data.out_pairs = nQueries ? &correspondences[0] : NULL;
+
+	mrpt::system::parallelForBlocks(nQueries, &CPointsMap::determineMatching_NNBlock, &thread_data, params.numThreads);
+
+	// Remove slots without pairing, keeping the order of the local points. Statistics are accumulated
+	// here, sequentially, so results are exactly the same for any number of threads:
+	float  _sumSqrDist = 0;
+	size_t nCorrs = 0;
+	for (size_t k=0;k<nQueries;k++)
+	{
+		if (correspondences[k].errorSquareAfterTransformation<0) continue;
+		if (nCorrs!=k) correspondences[nCorrs] = correspondences[k];
+		_sumSqrDist+= correspondences[nCorrs].errorSquareAfterTransformation;
+		nCorrs++;
+	}
+	correspondences.resize(nCorrs);
 
 	// Additional consistency filter: "onlyKeepTheClosest" up to now
 	//  led to just one correspondence for each "local map" point, but
 	//  many of them may have as corresponding pair the same "global point"!!
+	//  Same criterion than TMatchingPairList::filterUniqueRobustPairs(), done in-place.
 	// -------------------------------------------------------------------------
-	if (params.onlyUniqueRobust) {
+	if (params.onlyUniqueRobust)
+	{
 		ASSERTMSG_(params.onlyKeepTheClosest, "ERROR: onlyKeepTheClosest must be also set to true when onlyUniqueRobust=true.");
-		_correspondences.filterUniqueRobustPairs(nGlobalPoints,correspondences);
-	}
-	else {
-		correspondences.swap(_correspondences);
+
+		std::vector<int> bestMatchForThisMap(nGlobalPoints, -1);
+		for (size_t i=0;i<nCorrs;i++)
+		{
+			int &best = bestMatchForThisMap[correspondences[i].this_idx];
+			if (best<0 || correspondences[i].errorSquareAfterTransformation < correspondences[best].errorSquareAfterTransformation)
+				best = static_cast<int>(i);
+		}
+		size_t nKept = 0;
+		for (size_t i=0;i<nCorrs;i++)
+		{
+			if (bestMatchForThisMap[correspondences[i].this_idx]!=static_cast<int>(i)) continue;
+			if (nKept!=i) correspondences[nKept] = correspondences[i];
+			nKept++;
+		}
+		correspondences.resize(nKept);
 	}
 
 	// If requested, copy sum of squared distances to output pointer:
 	// -------------------------------------------------------------------
-	extraResults.sumSqrDist = (_sumSqrCount) ? _sumSqrDist / static_cast<double>(_sumSqrCount) : 0;
-	extraResults.correspondencesRatio = params.decimation_other_map_points*nOtherMapPointsWithCorrespondence / static_cast<float>(nLocalPoints);
+	extraResults.sumSqrDist = (nCorrs) ? _sumSqrDist / static_cast<double>(nCorrs) : 0;
+	// The ratio of points in the other map with corrs:
+	extraResults.correspondencesRatio = params.decimation_other_map_points*nCorrs / static_cast<float>(nLocalPoints);
 
 	MRPT_END
 }
@@ -1527,15 +1504,21 @@ void CPointsMap::PLY_export_get_vertex(
 	pt.z = z[idx];
 }
 
+// Grows through insertPointFast(), so the points already indexed in the kd-tree remain valid (resize() invalidates it):
+void  CPointsMap::appendDefaultPoints(const size_t count)
+{
+	this->reserve(this->size()+count);
+	for (size_t i=0;i<count;i++)
+		this->insertPointFast(0,0,0);
+}
+
 // Generic implementation (a more optimized one should exist in derived classes):
 void  CPointsMap::addFrom(const CPointsMap &anotherMap)
 {
 	const size_t nThis = this->size();
 	const size_t nOther = anotherMap.size();
 
-	const size_t nTot = nThis+nOther;
-
-	this->resize(nTot);
+	this->appendDefaultPoints(nOther);
 
 	for (size_t i=0,j=nThis;i<nOther;i++, j++)
 	{
@@ -1547,7 +1530,7 @@ void  CPointsMap::addFrom(const CPointsMap &anotherMap)
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(anotherMap,nThis);
 
-	mark_as_modified();
+	mark_as_points_appended();
 }
 
 /** Save the point cloud as a PCL PCD file, in either ASCII or binary format \return false on any error */
@@ -1601,8 +1584,12 @@ void  CPointsMap::applyDeletionMask( const std::vector<bool> &mask )
 		if (!mask[i])
 		{
 			// Pt[j] <---- Pt[i]
-			this->getPointAllFieldsFast(i,Pt);
-			this->setPointAllFieldsFast(j++,Pt);
+			if (i!=j)
+			{
+				this->getPointAllFieldsFast(i,Pt);
+				this->setPointAllFieldsFast(j,Pt);
+			}
+			j++;
 		}
 	}
 
@@ -1623,7 +1610,7 @@ void  CPointsMap::insertAnotherMap(
 	const size_t N_other = otherMap->size();
 
 	// Set the new size:
-	this->resize( N_this + N_other );
+	this->appendDefaultPoints(N_other);
 
 	mrpt::math::TPoint3Df pt;
 	size_t src,dst;
@@ -1643,7 +1630,7 @@ void  CPointsMap::insertAnotherMap(
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(*otherMap, N_this);
 
-	mark_as_modified();
+	mark_as_points_appended();
 }
 
 
@@ -1700,7 +1687,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation2DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended(); // Any other change is notified by the methods called below
 
 		const CObservation2DRangeScan *o = static_cast<const CObservation2DRangeScan *>(obs);
 		// Insert only HORIZONTAL scans??
@@ -1784,7 +1771,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation3DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended(); // Any other change is notified by the methods called below
 
 		const CObservation3DRangeScan *o = static_cast<const CObservation3DRangeScan *>(obs);
 		// Insert only HORIZONTAL scans??
@@ -1843,7 +1830,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationRange  (IRs, Sonars, etc.)
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended(); // Any other change is notified by the methods called below
 
 		const CObservationRange* o = static_cast<const CObservationRange*>(obs);
 
@@ -1886,7 +1873,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationVelodyneScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_points_appended(); // Any other change is notified by the methods called below
 
 		const CObservationVelodyneScan *o = static_cast<const CObservationVelodyneScan *>(obs);
 
@@ -1930,8 +1917,6 @@ void  CPointsMap::fuseWith(
 	TPoint3D			a,b;
 	const CPose2D		nullPose(0,0,0);
 
-	mark_as_modified();
-
 	//const size_t nThis  =     this->size();
 	const size_t nOther = otherMap->size();
 
@@ -1963,30 +1948,22 @@ void  CPointsMap::fuseWith(
 	// Merge matched points from both maps:
 	//  AND add new points which have been not matched:
 	// -------------------------------------------------
+	bool anyFused = false;
+	size_t corrIdx = 0; // Correspondences are sorted by "other_idx", with one at most for each point.
 	for (size_t i=0;i<nOther;i++)
 	{
 		const unsigned long	w_a = otherMap->getPoint(i,a);	// Get "local" point into "a"
 
-		// Find closest correspondence of "a":
+		// Find the correspondence of "a", if any:
 		int			closestCorr = -1;
-		float		minDist	= std::numeric_limits<float>::max();
-		for (TMatchingPairList::const_iterator corrsIt = correspondences.begin(); corrsIt!=correspondences.end(); ++corrsIt)
-		{
-			if (corrsIt->other_idx==i)
-			{
-				float	dist = square( corrsIt->other_x - corrsIt->this_x ) +
-							   square( corrsIt->other_y - corrsIt->this_y ) +
-							   square( corrsIt->other_z - corrsIt->this_z );
-				if (dist<minDist)
-				{
-					minDist = dist;
-					closestCorr = corrsIt->this_idx;
-				}
-			}
-		} // End of for each correspondence...
+		while (corrIdx<correspondences.size() && correspondences[corrIdx].other_idx<i)
+			corrIdx++;
+		if (corrIdx<correspondences.size() && correspondences[corrIdx].other_idx==i)
+			closestCorr = correspondences[corrIdx].this_idx;
 
 		if (closestCorr!=-1)
 		{	// Merge:		FUSION
+			anyFused = true;
 			unsigned long w_b = getPoint(closestCorr,b);
 
 			ASSERT_((w_a+w_b)>0);
@@ -2010,6 +1987,11 @@ void  CPointsMap::fuseWith(
 				(*notFusedPoints).push_back(false);
 		}
 	}
+
+	// Fused points have been moved, but if there were only additions the kd-tree can be updated incrementally:
+	if (anyFused)
+	     mark_as_modified();
+	else mark_as_points_appended();
 }
 
 void CPointsMap::loadFromVelodyneScan(
@@ -2023,7 +2005,7 @@ void CPointsMap::loadFromVelodyneScan(
 	if (scan.point_cloud.x.empty())
 		return;
 
-	this->mark_as_modified();
+	this->mark_as_points_appended(); // resize(0) below notifies the deletion of old points, if any.
 
 	// Insert vs. load and replace:
 	if (!insertionOptions.addToExistingPointsMap)
@@ -2032,8 +2014,7 @@ void CPointsMap::loadFromVelodyneScan(
 	// Alloc space:
 	const size_t nOldPtsCount = this->size();
 	const size_t nScanPts = scan.point_cloud.size();
-	const size_t nNewPtsCount = nOldPtsCount + nScanPts;
-	this->resize(nNewPtsCount);
+	this->appendDefaultPoints(nScanPts);
 
 	const float K = 1.0f / 255;  // Intensity scale.
 
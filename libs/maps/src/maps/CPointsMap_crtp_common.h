@@ -31,7 +31,10 @@ namespace detail
 			using namespace mrpt::poses;
 			using mrpt::math::square;
 			using mrpt::utils::DEG2RAD;
-			obj.mark_as_modified();
+			// Only appending new points does not require a full rebuild of the kd-tree:
+			if (obj.insertionOptions.addToExistingPointsMap)
+			     obj.mark_as_points_appended();
+			else obj.mark_as_modified();
 
 			// If robot pose is supplied, compute sensor pose relative to it.
 			CPose3D sensorPose3D(UNINITIALIZED_POSE);
@@ -304,7 +307,10 @@ namespace detail
 		{
 			using namespace mrpt::poses;
 			using mrpt::math::square;
-			obj.mark_as_modified();
+			// Only appending new points does not require a full rebuild of the kd-tree:
+			if (obj.insertionOptions.addToExistingPointsMap)
+			     obj.mark_as_points_appended();
+			else obj.mark_as_modified();
 
 			// If robot pose is supplied, compute sensor pose relative to it.
 			CPose3D sensorPose3D(UNINITIALIZED_POSE);
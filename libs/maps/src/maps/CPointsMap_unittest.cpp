@@ -12,6 +12,8 @@
 #include <mrpt/maps/CWeightedPointsMap.h>
 #include <mrpt/maps/CColouredPointsMap.h>
 #include <mrpt/poses/CPoint2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -193,3 +195,157 @@ TEST(CColouredPointsMapTests, clipOutOfRange)
 	do_test_clipOutOfRange<CColouredPointsMap>();
 }
 
+
+// Matching must give exactly the same pairings for any number of threads,
+// and each pairing must be the actual nearest neighbour:
+TEST(CSimplePointsMapTests, determineMatchingMultiThread)
+{
+	mrpt::random::CRandomGenerator rnd(123);
+	CSimplePointsMap  global_map, local_map;
+	for (int i=0;i<3000;i++)
+		global_map.insertPoint(rnd.drawUniform(-10,10),rnd.drawUniform(-10,10),rnd.drawUniform(-1,1));
+	for (int i=0;i<1001;i++)
+		local_map.insertPoint(rnd.drawUniform(-9,9),rnd.drawUniform(-9,9),rnd.drawUniform(-1,1));
+
+	const CPose3D local_pose(0.1,-0.2,0.05, DEG2RAD(5.0),0,0);
+
+	for (int test=0;test<4;test++)
+	{
+		const bool is_3D = (test & 1)!=0;
+		TMatchingParams params;
+		params.maxDistForCorrespondence = 0.3f;
+		params.maxAngularDistForCorrespondence = 0.01f;
+		params.onlyUniqueRobust = (test & 2)!=0;
+		params.decimation_other_map_points = 3;
+		params.offset_other_map_points = 1;
+
+		TMatchingPairList corrs[2];
+		TMatchingExtraResults extra[2];
+		const unsigned int nThreads[2] = {1, 4};
+		for (int k=0;k<2;k++)
+		{
+			params.numThreads = nThreads[k];
+			if (is_3D)
+				global_map.determineMatching3D(&local_map,local_pose,corrs[k],params,extra[k]);
+			else global_map.determineMatching2D(&local_map,CPose2D(local_pose),corrs[k],params,extra[k]);
+		}
+
+		ASSERT_TRUE(!corrs[0].empty());
+		ASSERT_EQ(corrs[0].size(),corrs[1].size());
+		EXPECT_EQ(extra[0].sumSqrDist,extra[1].sumSqrDist);
+		EXPECT_EQ(extra[0].correspondencesRatio,extra[1].correspondencesRatio);
+		for (size_t i=0;i<corrs[0].size();i++)
+		{
+			EXPECT_EQ(corrs[0][i].this_idx,corrs[1][i].this_idx);
+			EXPECT_EQ(corrs[0][i].other_idx,corrs[1][i].other_idx);
+			EXPECT_EQ(corrs[0][i].errorSquareAfterTransformation,corrs[1][i].errorSquareAfterTransformation);
+			EXPECT_EQ(corrs[0][i].other_idx % params.decimation_other_map_points, params.offset_other_map_points);
+			if (i>0) EXPECT_LT(corrs[0][i-1].other_idx,corrs[0][i].other_idx);
+		}
+
+		// Brute force check of a few pairings:
+		for (size_t i=0;i<corrs[0].size();i+=17)
+		{
+			const TMatchingPair &p = corrs[0][i];
+			double lx,ly,lz;
+			local_pose.composePoint(p.other_x,p.other_y,p.other_z,lx,ly,lz);
+			double min_d2 = std::numeric_limits<double>::max();
+			for (size_t j=0;j<global_map.size();j++)
+			{
+				float gx,gy,gz;
+				global_map.getPoint(j,gx,gy,gz);
+				const double d2 = square(gx-lx)+square(gy-ly) + (is_3D ? square(gz-lz) : 0);
+				min_d2 = std::min(min_d2,d2);
+			}
+			EXPECT_NEAR(p.errorSquareAfterTransformation, min_d2, 1e-4);
+		}
+	}
+}
+
+// Points appended to a map must be indexed incrementally, giving the same
+// results than a kd-tree built from scratch:
+TEST(CSimplePointsMapTests, kdTreeIncrementalInsert)
+{
+	mrpt::random::CRandomGenerator rnd(321);
+	CSimplePointsMap  pts;
+	size_t max_subtrees = 0;
+	for (int step=0;step<60;step++)
+	{
+		const int nNew = 1 + step*7;
+		for (int i=0;i<nNew;i++)
+			pts.insertPoint(rnd.drawUniform(-10,10),rnd.drawUniform(-10,10),rnd.drawUniform(-1,1));
+
+		CSimplePointsMap  ref;  // KD-tree built from scratch
+		ref.insertAnotherMap(&pts, CPose3D());
+
+		for (int q=0;q<10;q++)
+		{
+			const float qx = rnd.drawUniform(-11,11), qy = rnd.drawUniform(-11,11), qz = rnd.drawUniform(-1,1);
+			float d2, d2_ref, d3, d3_ref;
+			pts.kdTreeClosestPoint2D(qx,qy,d2);
+			ref.kdTreeClosestPoint2D(qx,qy,d2_ref);
+			EXPECT_EQ(d2,d2_ref);
+			pts.kdTreeClosestPoint3D(qx,qy,qz,d3);
+			ref.kdTreeClosestPoint3D(qx,qy,qz,d3_ref);
+			EXPECT_EQ(d3,d3_ref);
+
+			std::vector<size_t> idxs, idxs_ref;
+			std::vector<float> dists, dists_ref;
+			pts.kdTreeNClosestPoint3DIdx(qx,qy,qz,5,idxs,dists);
+			ref.kdTreeNClosestPoint3DIdx(qx,qy,qz,5,idxs_ref,dists_ref);
+			for (size_t k=0;k<5;k++) EXPECT_EQ(dists[k],dists_ref[k]);
+
+			std::vector<std::pair<size_t,float> > rad, rad_ref;
+			pts.kdTreeRadiusSearch2D(qx,qy,1.0f,rad);
+			ref.kdTreeRadiusSearch2D(qx,qy,1.0f,rad_ref);
+			EXPECT_EQ(rad.size(),rad_ref.size());
+		}
+		EXPECT_EQ(ref.kdtree_get_num_subtrees(2),1u);
+		max_subtrees = std::max(max_subtrees, pts.kdtree_get_num_subtrees(2));
+	}
+	// The index must have been updated incrementally, with a logarithmic number of trees:
+	EXPECT_GT(max_subtrees,1u);
+	EXPECT_LT(max_subtrees,20u);
+
+	// Deleting points forces a full rebuild:
+	pts.clipOutOfRangeInZ(-0.5f,0.5f);
+	float d2;
+	pts.kdTreeClosestPoint2D(0,0,d2);
+	EXPECT_EQ(pts.kdtree_get_num_subtrees(2),1u);
+}
+
+// resize() may be followed by overwriting the existing points too (e.g. CObservation3DRangeScan::project3DPointsFromDepthImageInto()),
+// so it must invalidate the kd-tree, while insertAnotherMap() keeps it and indexes the new points only:
+TEST(CSimplePointsMapTests, kdTreeAfterResize)
+{
+	mrpt::random::CRandomGenerator rnd(123);
+	CSimplePointsMap  pts;
+	for (int i=0;i<500;i++)
+		pts.insertPoint(rnd.drawUniform(-10,10),rnd.drawUniform(-10,10));
+	float d2;
+	pts.kdTreeClosestPoint2D(0,0,d2); // Builds the kd-tree
+
+	pts.resize(520);
+	for (size_t i=0;i<pts.size();i++)
+		pts.setPointFast(i, rnd.drawUniform(-10,10),rnd.drawUniform(-10,10),0); // As the point cloud adaptor does: no mark_as_modified()
+
+	CSimplePointsMap  other;
+	load_demo_9pts_map(other);
+	pts.kdTreeClosestPoint2D(0,0,d2);
+	pts.insertAnotherMap(&other, CPose3D(-20,0,0, 0,0,0));
+
+	for (int q=0;q<100;q++)
+	{
+		const float qx = rnd.drawUniform(-25,11), qy = rnd.drawUniform(-11,11);
+		float min_d2 = std::numeric_limits<float>::max();
+		for (size_t j=0;j<pts.size();j++)
+		{
+			float px,py,pz;
+			pts.getPoint(j,px,py,pz);
+			min_d2 = std::min(min_d2, square(px-qx)+square(py-qy));
+		}
+		pts.kdTreeClosestPoint2D(qx,qy,d2);
+		EXPECT_NEAR(d2, min_d2, 1e-5);
+	}
+	EXPECT_EQ(pts.kdtree_get_num_subtrees(2),2u);
+}
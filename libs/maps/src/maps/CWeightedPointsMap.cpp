@@ -91,6 +91,7 @@ void CWeightedPointsMap::resize(size_t newLength)
 	y.resize( newLength, 0 );
 	z.resize( newLength, 0 );
 	pointWeight.resize(newLength, 1);
+	mark_as_modified();
 }
 
 // Resizes all point buffers so they can hold the given number of points, *erasing* all previous contents
@@ -102,6 +103,7 @@ void CWeightedPointsMap::setSize(size_t newLength)
 	y.assign( newLength, 0);
 	z.assign( newLength, 0);
 	pointWeight.assign( newLength, 1 );
+	mark_as_modified();
 }
 
 void  CWeightedPointsMap::setPointFast(size_t index,float x,float y,float z)
@@ -12,6 +12,7 @@
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/nav/planners/TMoveTree.h>
 #include <mrpt/nav/planners/PlannerRRT_common.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <numeric>
 
 #include <mrpt/nav/link_pragmas.h>
@@ -99,6 +100,39 @@ namespace mrpt
 		protected:
 			bool m_initialized;
 
+			/** The result of trying to extend the tree towards a random state with one PTG. Filled in by the worker threads
+			  * of \a m_ptg_eval_pool, then merged in PTG order by solve(). */
+			struct TPTGEdgeCandidate
+			{
+				bool no_nearest_node; //!< No node could be reached from the PTG paths
+				bool is_valid;        //!< Whether \a edge is a collision-free candidate for the tree
+				TMoveEdgeSE2_TP edge;
+				std::string log_txt;
+				double time_getNearestNode, time_getNearestNode_new_state, time_changeCoordinatesReference, time_SpaceTransformer; //!< Time, in seconds, or <0 if not run.
+
+				TPTGEdgeCandidate() : no_nearest_node(false), is_valid(false),
+					time_getNearestNode(-1), time_getNearestNode_new_state(-1), time_changeCoordinatesReference(-1), time_SpaceTransformer(-1) { }
+			};
+
+			/** Everything needed to evaluate the candidate edges of one RRT iteration from the worker threads of \a m_ptg_eval_pool.
+			  * The tree is not modified while the workers run; each one writes only the candidates of its PTGs. */
+			struct TPTGEdgesEvalTask
+			{
+				PlannerRRT_SE2_TPS *planner;
+				const TPlannerInput *pi;
+				const TPlannerResult *result;
+				node_pose_t x_rand;
+				std::vector<TPTGEdgeCandidate> candidates; //!< One per PTG
+			};
+			/** Worker (with the signature of mrpt::system::parallelForBlocks()) for the PTGs `[first,last)` of a TPTGEdgesEvalTask */
+			static void evalPTGEdgesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
+			/** [Algo `tp_space_rrt`: Lines 5-16] for one PTG. `local_obs` is a temporary map owned by the calling thread. */
+			void evalPTGEdgeCandidate(size_t idxPTG, const TPlannerInput &pi, const TPlannerResult &result, const node_pose_t &x_rand, mrpt::maps::CSimplePointsMap &local_obs, TPTGEdgeCandidate &out);
+
+			mrpt::system::CWorkerThreadsPool m_ptg_eval_pool; //!< Persistent threads for RRTAlgorithmParams::ptg_eval_num_threads
+			std::vector<mrpt::maps::CSimplePointsMap> m_local_obs_per_thread; //!< Like \a m_local_obs, one for each worker thread
+
 		}; // end class PlannerRRT_SE2_TPS
 		
 	  /** @} */
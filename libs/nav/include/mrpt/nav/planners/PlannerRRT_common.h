@@ -95,6 +95,9 @@ namespace mrpt
 			bool   ptg_verbose; //!< Display PTG construction info (default=true)
 
 			size_t save_3d_log_freq; //!< Frequency (in iters) of saving tree state to debug log files viewable in SceneViewer3D (default=0, disabled)
+			/** Number of threads for evaluating the candidate edges of all PTGs in each RRT iteration (Default=1: sequential evaluation; 0: one per processor).
+			  * Threads are persistent between iterations. Candidates are merged in PTG order, so results do not depend on this number. */
+			unsigned int ptg_eval_num_threads;
 
 			RRTAlgorithmParams();
 		};
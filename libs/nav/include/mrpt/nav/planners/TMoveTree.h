@@ -13,6 +13,9 @@
 #include <mrpt/utils/traits_map.h>
 #include <mrpt/math/wrap2pi.h>
 #include <mrpt/poses/CPose2D.h>
+#include <algorithm>
+#include <set>
+#include <vector>
 
 #include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
 #include <mrpt/nav/link_pragmas.h>
@@ -71,7 +74,13 @@ namespace mrpt
 			typedef typename MAPS_IMPLEMENTATION::template map<mrpt::utils::TNodeID, node_t>  node_map_t;  //!< Map: TNode_ID => Node info
 			typedef std::list<node_t> path_t; //!< A topological path up-tree
 
-			/** Finds the nearest node to a given pose, using the given metric */
+			/** Finds the nearest node to a given pose, using the given metric.
+			  * Nodes are searched for in a KD-tree of their (x,y) coordinates, which is kept updated as new nodes are inserted,
+			  * so only those nodes passing the `cannotBeNearerThan()` test of the metric (that is, within a square of the current
+			  * minimum distance around the query) are actually evaluated. Ties are resolved in favor of the lowest node ID.
+			  * \return The ID of the nearest node, or INVALID_NODEID if none could be evaluated by the metric.
+			  * \sa getNodesWithinDistance()
+			  */
 			template <class NODE_TYPE_FOR_METRIC>
 			mrpt::utils::TNodeID getNearestNode(
 				const NODE_TYPE_FOR_METRIC &query_pt,
@@ -84,24 +93,81 @@ namespace mrpt
 
 				double min_d = std::numeric_limits<double>::max();
 				mrpt::utils::TNodeID min_id=INVALID_NODEID;
-				for (typename node_map_t::const_iterator it=m_nodes.begin();it!=m_nodes.end();++it)
+				const NODE_TYPE_FOR_METRIC ptTo(query_pt.state);
+
+				// Depth-first traversal, nearest branch first. Each entry: (KD-tree node, the splitting plane of its parent if it is on the far side, or -1)
+				std::vector<TKDStackEntry> stack;
+				if (!m_kdtree.empty()) stack.push_back(TKDStackEntry(0));
+				while (!stack.empty())
 				{
-					if (ignored_nodes && ignored_nodes->find(it->first)!=ignored_nodes->end())
-						continue; // ignore it
-					const NODE_TYPE_FOR_METRIC ptTo(query_pt.state);
-					const NODE_TYPE_FOR_METRIC ptFrom(it->second.state);
-					if (distanceMetricEvaluator.cannotBeNearerThan(ptFrom,ptTo,min_d))
-						continue; // Skip the more expensive calculation of exact distance
-					double d = distanceMetricEvaluator.distance(ptFrom,ptTo);
-					if (d<min_d) {
-						min_d = d;
-						min_id = it->first;
+					const TKDStackEntry cur = stack.back();
+					stack.pop_back();
+					if (cur.plane_dim>=0 && distanceMetricEvaluator.cannotBeNearerThan(NODE_TYPE_FOR_METRIC(pointOnPlane(query_pt.state,cur)),ptTo,min_d))
+						continue; // This whole branch is farther than the best node so far
+					const TKDNode &kdn = m_kdtree[cur.kd_idx];
+
+					if (!ignored_nodes || ignored_nodes->find(kdn.node_id)==ignored_nodes->end())
+					{
+						const NODE_TYPE_FOR_METRIC ptFrom(kdn.state);
+						if (!distanceMetricEvaluator.cannotBeNearerThan(ptFrom,ptTo,min_d)) // Skip the more expensive calculation of exact distance
+						{
+							const double d = distanceMetricEvaluator.distance(ptFrom,ptTo);
+							// Ties are broken by node ID. Metrics return DBL_MAX for unreachable nodes: never pick those.
+							if (d<min_d || (d==min_d && kdn.node_id<min_id && d<std::numeric_limits<double>::max())) {
+								min_d = d;
+								min_id = kdn.node_id;
+							}
+						}
 					}
+
+					const int near_side = isBelowSplit(query_pt.state,kdn) ? 0:1;
+					if (kdn.children[1-near_side]>=0) stack.push_back(TKDStackEntry(kdn.children[1-near_side],kdn));
+					if (kdn.children[near_side]>=0)   stack.push_back(TKDStackEntry(kdn.children[near_side]));
 				}
 				if (out_distance) *out_distance = min_d;
 				return min_id;
 			}
 
+			/** Finds all the nodes within a given distance `max_dist` (in the units of the metric) to a given pose.
+			  * \param[out] out_nodes Pairs of (node ID, distance), sorted by increasing node ID.
+			  * \sa getNearestNode()
+			  */
+			template <class NODE_TYPE_FOR_METRIC>
+			void getNodesWithinDistance(
+				const NODE_TYPE_FOR_METRIC &query_pt,
+				const PoseDistanceMetric<NODE_TYPE_FOR_METRIC> &distanceMetricEvaluator,
+				const double max_dist,
+				std::vector<std::pair<mrpt::utils::TNodeID,double> > &out_nodes
+				) const
+			{
+				out_nodes.clear();
+				const NODE_TYPE_FOR_METRIC ptTo(query_pt.state);
+
+				std::vector<TKDStackEntry> stack;
+				if (!m_kdtree.empty()) stack.push_back(TKDStackEntry(0));
+				while (!stack.empty())
+				{
+					const TKDStackEntry cur = stack.back();
+					stack.pop_back();
+					if (cur.plane_dim>=0 && distanceMetricEvaluator.cannotBeNearerThan(NODE_TYPE_FOR_METRIC(pointOnPlane(query_pt.state,cur)),ptTo,max_dist))
+						continue;
+					const TKDNode &kdn = m_kdtree[cur.kd_idx];
+
+					const NODE_TYPE_FOR_METRIC ptFrom(kdn.state);
+					if (!distanceMetricEvaluator.cannotBeNearerThan(ptFrom,ptTo,max_dist))
+					{
+						const double d = distanceMetricEvaluator.distance(ptFrom,ptTo);
+						if (d<=max_dist)
+							out_nodes.push_back(std::make_pair(kdn.node_id,d));
+					}
+
+					const int near_side = isBelowSplit(query_pt.state,kdn) ? 0:1;
+					if (kdn.children[1-near_side]>=0) stack.push_back(TKDStackEntry(kdn.children[1-near_side],kdn));
+					if (kdn.children[near_side]>=0)   stack.push_back(TKDStackEntry(kdn.children[near_side]));
+				}
+				std::sort(out_nodes.begin(), out_nodes.end());
+			}
+
 			void insertNodeAndEdge(
 				const mrpt::utils::TNodeID parent_id, 
 				const mrpt::utils::TNodeID new_child_id, 
@@ -113,12 +179,14 @@ namespace mrpt
 				edges_of_parent.push_back( typename base_t::TEdgeInfo(new_child_id,false/*direction_child_to_parent*/, new_edge_data ) );
 				// node:
 				m_nodes[new_child_id] = node_t(new_child_id,parent_id, &edges_of_parent.back().data, new_child_node_data);
+				kdtreeInsert(new_child_id, new_child_node_data.state);
 			}
 
 			/** Insert a node without edges (should be used only for a tree root node) */
 			void insertNode(const mrpt::utils::TNodeID node_id, const NODE_TYPE_DATA &node_data) 
 			{
 				m_nodes[node_id] = node_t(node_id,INVALID_NODEID, NULL, node_data);
+				kdtreeInsert(node_id, node_data.state);
 			}
 
 			mrpt::utils::TNodeID getNextFreeNodeID() const { return m_nodes.size(); }
@@ -158,6 +226,114 @@ namespace mrpt
 		private:
 			node_map_t  m_nodes;  //!< Info per node
 
+			typedef decltype(NODE_TYPE_DATA::state) node_state_t;
+
+			/** A node of the KD-tree used to speed-up node searches, which splits the (x,y) plane by alternating axes.
+			  * The heading (phi) is not used for splitting, since the metrics only provide bounds for the distances in (x,y) (see `cannotBeNearerThan()`). */
+			struct TKDNode
+			{
+				node_state_t         state;
+				mrpt::utils::TNodeID node_id;
+				int32_t              children[2]; //!< Indices in m_kdtree of the children with a coordinate below/above ours, or -1 if none
+				uint8_t              split_dim;   //!< 0: x, 1: y
+			};
+			std::vector<TKDNode> m_kdtree; //!< The KD-tree of all nodes. Element [0] is the root.
+			size_t m_kdtree_last_rebuild_size = 0; //!< Number of nodes in the last call to kdtreeRebuild()
+
+			/** A KD-tree node pending to be visited in searches */
+			struct TKDStackEntry
+			{
+				int32_t kd_idx;
+				int     plane_dim;  //!< -1: no need to check the distance to the splitting plane, 0/1: plane x/y=plane_val
+				double  plane_val;
+				explicit TKDStackEntry(int32_t idx) : kd_idx(idx), plane_dim(-1), plane_val(0) {}
+				TKDStackEntry(int32_t idx, const TKDNode &parent) :
+					kd_idx(idx), plane_dim(parent.split_dim), plane_val(parent.split_dim==0 ? parent.state.x : parent.state.y) {}
+			};
+
+			static bool isBelowSplit(const node_state_t &state, const TKDNode &kdn) {
+				return kdn.split_dim==0 ? state.x<kdn.state.x : state.y<kdn.state.y;
+			}
+			/** The projection of the query onto the splitting plane, which is nearer to the query than any node on the other side,
+			  * so the metric can tell whether the whole branch can be discarded. */
+			template <class STATE>
+			static STATE pointOnPlane(const STATE &query, const TKDStackEntry &e) {
+				STATE p = query;
+				if (e.plane_dim==0) p.x = e.plane_val;
+				else                p.y = e.plane_val;
+				return p;
+			}
+
+			/** Adds one node to the KD-tree, which is rebuilt balanced if it became too deep */
+			void kdtreeInsert(const mrpt::utils::TNodeID node_id, const node_state_t &state)
+			{
+				TKDNode kdn;
+				kdn.state = state;
+				kdn.node_id = node_id;
+				kdn.children[0] = kdn.children[1] = -1;
+				kdn.split_dim = 0;
+
+				size_t depth = 0;
+				if (!m_kdtree.empty())
+				{
+					int32_t idx = 0;
+					for (;;)
+					{
+						depth++;
+						TKDNode &parent = m_kdtree[idx];
+						const int side = isBelowSplit(state,parent) ? 0:1;
+						if (parent.children[side]<0) {
+							parent.children[side] = static_cast<int32_t>(m_kdtree.size());
+							kdn.split_dim = 1-parent.split_dim;
+							break;
+						}
+						idx = parent.children[side];
+					}
+				}
+				m_kdtree.push_back(kdn);
+
+				// Nodes are inserted in random order, so this should not happen often. Rebuilds are, at least, one per doubling
+				// the number of nodes, to bound their cost even for degenerate sets of nodes:
+				size_t log2_N = 0;
+				while ((size_t(1)<<log2_N)<m_kdtree.size()) log2_N++;
+				if (depth>3*log2_N+8 && m_kdtree.size()>=2*m_kdtree_last_rebuild_size)
+					kdtreeRebuild();
+			}
+
+			/** Rebuilds the KD-tree from scratch, with median splits */
+			void kdtreeRebuild()
+			{
+				std::vector<TKDNode> nodes;
+				nodes.swap(m_kdtree);
+				m_kdtree_last_rebuild_size = nodes.size();
+				m_kdtree.reserve(nodes.size());
+				kdtreeBuild(nodes.begin(), nodes.end(), 0);
+			}
+
+			int32_t kdtreeBuild(typename std::vector<TKDNode>::iterator first, typename std::vector<TKDNode>::iterator last, uint8_t split_dim)
+			{
+				if (first==last) return -1;
+				typename std::vector<TKDNode>::iterator mid = first + (last-first)/2;
+				if (split_dim==0)
+				     std::nth_element(first,mid,last, [](const TKDNode &a, const TKDNode &b) { return a.state.x<b.state.x; });
+				else std::nth_element(first,mid,last, [](const TKDNode &a, const TKDNode &b) { return a.state.y<b.state.y; });
+
+				// Nodes equal to the median may be at either side: move them all to the upper one, as expected by kdtreeInsert()
+				const double split_val = (split_dim==0 ? mid->state.x : mid->state.y);
+				mid = std::partition(first, last, [split_dim,split_val](const TKDNode &a) { return (split_dim==0 ? a.state.x : a.state.y)<split_val; });
+				typename std::vector<TKDNode>::iterator median = std::find_if(mid, last, [split_dim,split_val](const TKDNode &a) { return (split_dim==0 ? a.state.x : a.state.y)==split_val; });
+				std::iter_swap(mid, median);
+
+				const int32_t idx = static_cast<int32_t>(m_kdtree.size());
+				m_kdtree.push_back(*mid);
+				m_kdtree[idx].split_dim = split_dim;
+				const int32_t child_lo = kdtreeBuild(first, mid, 1-split_dim);
+				const int32_t child_hi = kdtreeBuild(mid+1, last, 1-split_dim);
+				m_kdtree[idx].children[0] = child_lo;
+				m_kdtree[idx].children[1] = child_hi;
+				return idx;
+			}
+
 		}; // end TMoveTree
 
 		/** An edge for the move tree used for planning in SE2 and TP-space */
@@ -192,8 +368,9 @@ namespace mrpt
 		{
 			bool cannotBeNearerThan(const TNodeSE2 &a, const TNodeSE2& b,const double d) const
 			{
-				if (std::abs(a.state.x-b.state.x)>d) return true;
-				if (std::abs(a.state.y-b.state.y)>d) return true;
+				// distance() is squared:
+				if (mrpt::math::square(a.state.x-b.state.x)>d) return true;
+				if (mrpt::math::square(a.state.y-b.state.y)>d) return true;
 				return false;
 			}
 
@@ -20,6 +20,7 @@
 #include <mrpt/system/datetime.h>
 #include <mrpt/math/filters.h>
 #include <mrpt/synch/CCriticalSection.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <mrpt/math/CPolygon.h>
 #include <mrpt/maps/CPointCloudFilterBase.h>
 
@@ -167,6 +168,9 @@ namespace mrpt
 			bool  enable_obstacle_filtering;
 			bool  evaluate_clearance; //!< Default: false
 			double max_dist_for_timebased_path_prediction; //!< Max dist [meters] to use time-based path prediction for NOP evaluation.
+			/** Number of threads for evaluating all PTGs (TP-Obstacles, holonomic method and candidate scores) in each navigation step (Default=1: sequential evaluation in the navigation thread; 0: one per processor).
+			  * Threads are persistent between navigation steps. Each PTG has its own holonomic method instance, so results do not depend on this number. */
+			unsigned int ptg_eval_num_threads;
 
 			virtual void loadFromConfigFile(const mrpt::utils::CConfigFileBase &c, const std::string &s) MRPT_OVERRIDE;
 			virtual void saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &s) const MRPT_OVERRIDE;
@@ -231,7 +235,7 @@ namespace mrpt
 
 		/** @name Variables for CReactiveNavigationSystem::performNavigationStep
 			@{ */
-		mrpt::utils::CTicTac totalExecutionTime, executionTime, tictac;
+		mrpt::utils::CTicTac totalExecutionTime, executionTime;
 		mrpt::math::LowPassFilter_IIR1  meanExecutionTime;
 		mrpt::math::LowPassFilter_IIR1  meanTotalExecutionTime;
 		mrpt::math::LowPassFilter_IIR1  meanExecutionPeriod;    //!< Runtime estimation of execution period of the method.
@@ -256,14 +260,14 @@ namespace mrpt
 		/** Generates a pointcloud of obstacles, and the robot shape, to be saved in the logging record for the current timestep */
 		virtual void loggingGetWSObstaclesAndShape(CLogFileRecord &out_log) = 0;
 
-		/** Scores \a holonomicMovement */
+		/** Scores \a holonomicMovement. Debug traces are added to \a debug_msgs, to be later merged into CLogFileRecord::additional_debug_msgs */
 		void calc_move_candidate_scores(TCandidateMovementPTG         & holonomicMovement,
 			const std::vector<double>        & in_TPObstacles,
 			const mrpt::nav::ClearanceDiagram & in_clearance,
 			const mrpt::math::TPose2D  & WS_Target,
 			const mrpt::math::TPoint2D & TP_Target,
 			CLogFileRecord::TInfoPerPTG & log,
-			CLogFileRecord & newLogRec,
+			std::map<std::string, std::string> & debug_msgs,
 			const bool this_is_PTG_continuation,
 			const mrpt::math::TPose2D &relPoseVelCmd_NOP,
 			const unsigned int ptg_idx4weights,
@@ -296,6 +300,16 @@ namespace mrpt
 		std::vector<TInfoPerPTG> m_infoPerPTG; //!< Temporary buffers for working with each PTG during a navigationStep()
 		mrpt::system::TTimeStamp m_infoPerPTG_timestamp;
 
+		/** Outputs of build_movement_candidate() which must not be written into shared objects while PTGs are evaluated
+		  * in parallel. They are merged into the log record and the time logger in PTG order once all candidates are done. */
+		struct TCandidateEvalLog
+		{
+			std::map<std::string, std::string> debug_msgs; //!< To be merged into CLogFileRecord::additional_debug_msgs
+			double timeForTPObsTransformation, timeForHolonomicMethod, timeForCandidateScores; //!< Time, in seconds, or <0 if not run.
+
+			TCandidateEvalLog() : timeForTPObsTransformation(-1), timeForHolonomicMethod(-1), timeForCandidateScores(-1) { }
+		};
+
 		void build_movement_candidate(CParameterizedTrajectoryGenerator * ptg,
 			const size_t indexPTG,
 			const mrpt::math::TPose2D &relTarget,
@@ -303,6 +317,7 @@ namespace mrpt
 			TInfoPerPTG &ipf,
 			TCandidateMovementPTG &holonomicMovement,
 			CLogFileRecord &newLogRec,
+			TCandidateEvalLog &evalLog,
 			const bool this_is_PTG_continuation,
 			mrpt::nav::CAbstractHolonomicReactiveMethod *holoMethod,
 			const mrpt::system::TTimeStamp tim_start_iteration,
@@ -310,6 +325,25 @@ namespace mrpt
 			const mrpt::math::TPose2D &relPoseVelCmd_NOP = mrpt::poses::CPose2D()
 		);
 
+		/** Everything needed to evaluate the motion candidates of one navigation step from the worker threads of \a m_ptg_eval_pool.
+		  * Each worker only writes the entries of its own PTGs (and the "NOP" entry, evaluated right after the PTG it belongs to). */
+		struct TCandidatesEvalTask
+		{
+			CAbstractPTGBasedReactive *nav;
+			mrpt::math::TPose2D relTarget, rel_pose_PTG_origin_wrt_sense;
+			mrpt::system::TTimeStamp tim_start_iteration;
+			CLogFileRecord *newLogRec;
+			std::vector<TCandidateMovementPTG> *candidate_movs;
+			std::vector<TCandidateEvalLog> evalLogs; //!< One per PTG, plus the "NOP" candidate
+
+			int NOP_ptg_idx; //!< Index of the PTG for the "NOP" candidate, or -1 if it must not be evaluated.
+			mrpt::math::TPose2D relTarget_NOP, rel_pose_PTG_origin_wrt_sense_NOP, rel_cur_pose_wrt_last_vel_cmd_NOP;
+		};
+		/** Worker (with the signature of mrpt::system::parallelForBlocks()) for the PTGs `[first,last)` of a TCandidatesEvalTask */
+		static void evalMovementCandidatesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
+		mrpt::system::CWorkerThreadsPool m_ptg_eval_pool; //!< Persistent threads for TAbstractPTGNavigatorParams::ptg_eval_num_threads
+
 		struct NAV_IMPEXP TSentVelCmd
 		{
 			int ptg_index; //!< 0-based index of used PTG
@@ -63,6 +63,8 @@ namespace nav
 		/** Known values: 
 		 *	- "executionTime": The total computation time, excluding sensing.
 		 *	- "estimatedExecutionPeriod": The estimated execution period.
+		 *	- "time_PTGs_eval": Wall-clock time for evaluating all motion candidates (all PTGs, plus the "NOP" one).
+		 *	- "num_threads_PTGs_eval": Number of threads used for that evaluation (see CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::ptg_eval_num_threads).
 		 */
 		std::map<std::string, double>  values;
 		/** Known values:
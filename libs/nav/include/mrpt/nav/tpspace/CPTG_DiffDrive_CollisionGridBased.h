@@ -44,7 +44,8 @@ namespace nav
 	class NAV_IMPEXP CPTG_DiffDrive_CollisionGridBased : public CPTG_RobotShape_Polygonal
 	{
 	public:
-		/** The main method to be implemented in derived classes: it defines the differential-driven differential equation */
+		/** The main method to be implemented in derived classes: it defines the differential-driven differential equation.
+		  * \note It is invoked from several threads at once while initializing the PTG, so it must not modify any shared state. */
 		virtual void ptgDiffDriveSteeringFunction( float alpha, float t, float x, float y, float phi, float &v, float &w) const = 0;
 
 		/** @name Virtual interface of each PTG implementation 
@@ -76,6 +77,11 @@ namespace nav
 
 		void updateTPObstacle(double ox, double oy, std::vector<double> &tp_obstacles) const MRPT_OVERRIDE;
 		void updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const MRPT_OVERRIDE;
+		/** Batched version of updateTPObstacle(): obstacle points are first binned by collision grid cell, so the list of (k,d) pairs of
+		  * each occupied cell is only visited once for all the points falling into it (twice, at most, if some of them lie inside the robot shape),
+		  * and cells are visited in memory order. With `num_threads>1`, each thread updates a different range of PTG directions (`k`)
+		  * of `tp_obstacles`, so no locks are needed. See full docs in CParameterizedTrajectoryGenerator::updateTPObstacles() */
+		void updateTPObstacles(const float *xs, const float *ys, const size_t N, std::vector<double> &tp_obstacles, const unsigned int num_threads = 1) const MRPT_OVERRIDE;
 		
 		/** This family of PTGs ignores the dynamic states */
 		virtual void onNewNavDynamicState() MRPT_OVERRIDE {
@@ -115,7 +121,7 @@ protected:
 		void internal_readFromStream(mrpt::utils::CStream &in) MRPT_OVERRIDE;
 		void internal_writeToStream(mrpt::utils::CStream &out) const  MRPT_OVERRIDE;
 
-		/** Numerically solve the diferential equations to generate a family of trajectories */
+		/** Numerically solve the diferential equations to generate a family of trajectories. Different trajectories (`k`) are simulated in parallel. */
 		void simulateTrajectories(
 				float			max_time,
 				float			max_dist,
@@ -160,12 +166,44 @@ protected:
 
 		}; // end of class CCollisionGrid
 
+		/** Data shared by the threads of simulateTrajectories(). Per-path results are stored separately, then merged in order. */
+		struct TSimulateTrajectoriesTask
+		{
+			const CPTG_DiffDrive_CollisionGridBased *ptg;
+			float max_time, max_dist, diferencial_t, min_dist;
+			unsigned int max_n;
+			std::vector<TCPointVector> *trajectories;
+			std::vector<float> x_min, x_max, y_min, y_max, max_acc_lin, max_acc_ang; //!< One entry per path `k`
+		};
+		static void simulateTrajectoriesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
+		/** The list of cells (index `cx+cy*size_x`) of the collision grid swept by the robot shape along one path, with the minimum distance for each one */
+		typedef std::vector<std::pair<uint32_t,float> > TSweptCells;
+		/** Data shared by the threads which build the collision grid in internal_initialize() */
+		struct TBuildCollisionGridTask
+		{
+			const CPTG_DiffDrive_CollisionGridBased *ptg;
+			std::vector<TSweptCells> *swept_cells; //!< One entry per path `k`
+		};
+		static void buildCollisionGridBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
 		// Save/Load from files.
 		bool saveColGridsToFile( const std::string &filename, const mrpt::math::CPolygon & computed_robotShape ) const;	// true = OK
 		bool loadColGridsFromFile( const std::string &filename, const mrpt::math::CPolygon & current_robotShape ); // true = OK
 
 		CCollisionGrid	m_collisionGrid; //!< The collision grid
 
+		/** Data shared by the threads of updateTPObstacles() */
+		struct TUpdateTPObstaclesTask
+		{
+			const CCollisionGrid *grid;
+			const CPTG_DiffDrive_CollisionGridBased *ptg;
+			const std::vector<uint32_t> *cell_keys; //!< Sorted, unique list of `(cell_index<<1) | is_obs_inside_robot_shape`
+			std::vector<double> *tp_obstacles;
+		};
+		/** Updates the TP-Obstacles for directions `k` in `[first,last)` \sa updateTPObstacles() */
+		static void updateTPObstaclesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param);
+
 		/** Specifies the min/max values for "k" and "n", respectively.
 		  * \sa m_lambdaFunctionOptimizer
 		  */
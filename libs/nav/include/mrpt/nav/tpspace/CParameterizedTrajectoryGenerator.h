@@ -183,6 +183,14 @@ namespace nav
 		/** Like updateTPObstacle() but for one direction only (`k`) in TP-Space. `tp_obstacle_k` must be initialized with initTPObstacleSingle() before call (collision-free ranges, in "pseudometers", un-normalized). */
 		virtual void updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const = 0;
 
+		/** Like updateTPObstacle() but for a whole set of `N` obstacle points, given as separate arrays of coordinates (relative to the origin of the PTG).
+		  * The default implementation calls updateTPObstacle() for each point or, if `num_threads>1`, splits the set of PTG directions (`k`) among
+		  * threads and calls updateTPObstacleSingle() for each point and direction. Derived classes may reimplement it with more efficient, batched algorithms.
+		  * The result is the same than calling updateTPObstacle() for each point, in any order.
+		  * \param num_threads Number of threads to split the work into (0: as many as processors). Leave it to 1 if this method is already invoked from parallel loops.
+		  * \sa mrpt::system::parallelForBlocks */
+		virtual void updateTPObstacles(const float *xs, const float *ys, const size_t N, std::vector<double> &tp_obstacles, const unsigned int num_threads = 1) const;
+
 		/** Loads a set of default parameters into the PTG. Users normally will call `loadFromConfigFile()` instead, this method is provided 
 		  * exclusively for the PTG-configurator tool. */
 		virtual void loadDefaultParams();
@@ -330,6 +338,8 @@ protected:
 		  * \param inout_tp_obs The target where to store the new TP-Obs distance, if it fulfills the criteria determined by the collision behavior.
 		  */
 		void internal_TPObsDistancePostprocess(const double ox, const double oy, const double new_tp_obs_dist, double &inout_tp_obs) const;
+		/** \overload For callers which already know whether the obstacle point lies inside the robot shape (see isPointInsideRobotShape()) */
+		void internal_TPObsDistancePostprocess(const bool is_obs_inside_robot_shape, const double new_tp_obs_dist, double &inout_tp_obs) const;
 
 		virtual void internal_readFromStream(mrpt::utils::CStream &in);
 		virtual void internal_writeToStream(mrpt::utils::CStream &out) const;
@@ -21,8 +21,6 @@ using namespace mrpt::math;
 using namespace mrpt::poses;
 using namespace std;
 
-MRPT_TODO("Optimize getNearestNode() with KD-tree!")
-
 PlannerRRT_SE2_TPS::PlannerRRT_SE2_TPS() :
 	m_initialized(false)
 {
@@ -57,6 +55,19 @@ void PlannerRRT_SE2_TPS::solve(
 	for (const auto & ptg : m_PTGs)
 		mrpt::utils::keep_max(max_veh_radius, ptg->getMaxRobotRadius());
 
+	for (const auto & ptg : m_PTGs)
+		ASSERT_ABOVE_(ptg->getRefDistance(),1.1*max_veh_radius); // Make sure the PTG covers at least a bit more than the vehicle shape!! (should be much, much higher)
+
+	// Threads for evaluating all PTGs in each iteration:
+	const unsigned int nThreads = static_cast<unsigned int>(std::min<size_t>(params.ptg_eval_num_threads!=0 ? params.ptg_eval_num_threads : mrpt::system::getNumberOfProcessors(), std::max<size_t>(m_PTGs.size(),1)));
+	if (m_local_obs_per_thread.size()<nThreads)
+		m_local_obs_per_thread.resize(nThreads);
+
+	TPTGEdgesEvalTask ptgEvalTask;
+	ptgEvalTask.planner = this;
+	ptgEvalTask.pi = &pi;
+	ptgEvalTask.result = &result;
+
 	// [Algo `tp_space_rrt`: Line 1]: Init tree adding the initial pose
 	if (result.move_tree.getAllNodes().empty())
 	{
@@ -109,30 +120,32 @@ void PlannerRRT_SE2_TPS::solve(
 		typedef std::map<double,TMoveEdgeSE2_TP> sorted_solution_list_t;
 		sorted_solution_list_t  candidate_new_nodes; // Map: cost -> info. Pick begin() to select the lowest-cose one.
 
-		const PoseDistanceMetric<TNodeSE2> distance_evaluator_se2;  // Plain distances in SE(2), not along PTGs
 		bool is_new_best_solution = false; // Just for logging purposes
 
-//#define DO_LOG_TXTS
 		std::string sLogTxt; 
 
 		// [Algo `tp_space_rrt`: Line 5]: For each PTG
 		// -----------------------------------------
 		const size_t nPTGs = m_PTGs.size();
+		ptgEvalTask.x_rand = x_rand;
+		ptgEvalTask.candidates.assign(nPTGs, TPTGEdgeCandidate());
+		m_ptg_eval_pool.parallelForBlocks(nPTGs, &PlannerRRT_SE2_TPS::evalPTGEdgesBlock, &ptgEvalTask, nThreads);
+
+		// Merge the candidates of each PTG, in order:
 		for (size_t idxPTG=0;idxPTG<nPTGs;++idxPTG)
 		{
 			rrt_iter_counter++;
+			const TPTGEdgeCandidate &c = ptgEvalTask.candidates[idxPTG];
 
-			// [Algo `tp_space_rrt`: Line 5]: Search nearest neig. to x_rand
-			// -----------------------------------------------
-			const PoseDistanceMetric<TNodeSE2_TP> distance_evaluator(*m_PTGs[idxPTG]);
-
-			const TNodeSE2_TP query_node(x_rand);
-			
-			m_timelogger.enter("TMoveTree::getNearestNode");
-			mrpt::utils::TNodeID x_nearest_id = result.move_tree.getNearestNode(query_node, distance_evaluator );
-			m_timelogger.leave("TMoveTree::getNearestNode");
+			if (m_timelogger.isEnabled())
+			{
+				if (c.time_getNearestNode>=0) m_timelogger.registerUserMeasure("TMoveTree::getNearestNode", c.time_getNearestNode);
+				if (c.time_getNearestNode_new_state>=0) m_timelogger.registerUserMeasure("TMoveTree::getNearestNode", c.time_getNearestNode_new_state);
+				if (c.time_changeCoordinatesReference>=0) m_timelogger.registerUserMeasure("PT_RRT::solve.changeCoordinatesReference", c.time_changeCoordinatesReference);
+				if (c.time_SpaceTransformer>=0) m_timelogger.registerUserMeasure("PT_RRT::solve.SpaceTransformer", c.time_SpaceTransformer);
+			}
 
-			if (x_nearest_id==INVALID_NODEID)
+			if (c.no_nearest_node)
 			{
 				// We can't find any close node, at least with this PTG's paths: skip
 
@@ -157,143 +170,12 @@ void PlannerRRT_SE2_TPS::solve(
 				continue; // Skip
 			}
 
-			const TNodeSE2_TP &     x_nearest_node = result.move_tree.getAllNodes().find(x_nearest_id)->second;
-
-			// [Algo `tp_space_rrt`: Line 6]: Relative target
-			// -----------------------------------------------
-			const CPose2D x_nearest_pose( x_nearest_node.state );
-			const CPose2D x_rand_rel = x_rand_pose - x_nearest_pose;
-
-			// [Algo `tp_space_rrt`: Line 7]: Relative target in TP-Space
-			// ------------------------------------------------------------
-			const double D_max = std::min(params.maxLength, m_PTGs[idxPTG]->getRefDistance() );
-
-			double d_rand; // Coordinates in TP-space
-			int   k_rand; // k_rand is the index of target_alpha in PTGs corresponding to a specific d_rand
-			//bool tp_point_is_exact =
-			m_PTGs[idxPTG]->inverseMap_WS2TP(
-				x_rand_rel.x(), x_rand_rel.y(),
-				k_rand, d_rand );
-			d_rand *= m_PTGs[idxPTG]->getRefDistance(); // distance to target, in "real meters"
-
-			float d_free;
-			//bool local_obs_ok = false; // Just for 3D log files: indicates whether obstacle points have been recomputed
-
-			// [Algo `tp_space_rrt`: Line 8]: TP-Obstacles
-			// ------------------------------------------------------------
-			// Transform obstacles as seen from x_nearest_node -> TP_obstacles
-			double TP_Obstacles_k_rand = .0; //vector<double> TP_Obstacles;
-			const double MAX_DIST_FOR_OBSTACLES = 1.5*m_PTGs[idxPTG]->getRefDistance(); // Maximum Euclidean distance (radius) for considering obstacles around the current robot pose
-			
-			ASSERT_ABOVE_(m_PTGs[idxPTG]->getRefDistance(),1.1*max_veh_radius); // Make sure the PTG covers at least a bit more than the vehicle shape!! (should be much, much higher)
-
-			{
-				CTimeLoggerEntry tle(m_timelogger,"PT_RRT::solve.changeCoordinatesReference");
-				transformPointcloudWithSquareClipping(pi.obstacles_points,m_local_obs,CPose2D(x_nearest_node.state),MAX_DIST_FOR_OBSTACLES);
-				//local_obs_ok=true;
-			}
-			{
-				CTimeLoggerEntry tle(m_timelogger,"PT_RRT::solve.SpaceTransformer");
-				spaceTransformerOneDirectionOnly(k_rand, m_local_obs, m_PTGs[idxPTG].pointer(), MAX_DIST_FOR_OBSTACLES, TP_Obstacles_k_rand);
-			}
-
-			// directions k_rand in TP_obstacles[k_rand] = d_free
-			// this is the collision free distance to the TP_target
-			d_free = TP_Obstacles_k_rand; // TP_Obstacles[k_rand];
-
-			// [Algo `tp_space_rrt`: Line 10]: d_new
-			// ------------------------------------------------------------
-			double d_new = std::min(D_max, d_rand);   //distance of the new candidate state in TP-space
-
-			//mrpt::poses::CPose2D *log_new_state_ptr=NULL; // For graphical logs only
-
-#ifdef DO_LOG_TXTS
-			sLogTxt += mrpt::format("tp_idx=%u tp_exact=%c\n d_free: %f d_rand=%f d_new=%f\n",static_cast<unsigned int>(idxPTG), tp_point_is_exact ? 'Y':'N',d_free,d_rand,d_new);
-			sLogTxt += mrpt::format(" nearest:%s\n",x_nearest_pose.asString().c_str());
-#endif
+			sLogTxt += c.log_txt;
 
-			// [Algo `tp_space_rrt`: Line 13]: Do we have free space?
+			// [Algo `tp_space_rrt`: Line 16]: Add to candidate solution set
 			// ------------------------------------------------------------
-			if ( d_free>=d_new )
-			{
-				// [Algo `tp_space_rrt`: Line 14]: PTG function
-				// ------------------------------------------------------------
-				//given d_rand and k_rand provides x,y,phi of the point in c-space
-				uint32_t nStep;
-				m_PTGs[idxPTG]->getPathStepForDist(k_rand, d_new, nStep);
-
-				mrpt::math::TPose2D rel_pose;
-				m_PTGs[idxPTG]->getPathPose(k_rand, nStep, rel_pose);
-
-				mrpt::math::wrapToPiInPlace(rel_pose.phi); // wrap to [-pi,pi] -->avoid out of bounds errors
-
-				// [Algo `tp_space_rrt`: Line 15]: pose composition
-				// ------------------------------------------------------------
-				const mrpt::poses::CPose2D new_state_rel(rel_pose);
-				mrpt::poses::CPose2D new_state = x_nearest_pose+new_state_rel; //compose the new_motion as the last nmotion and the new state
-				//log_new_state_ptr = &new_state;
-
-				// Check whether there's already a too-close node around:
-				// --------------------------------------------------------
-				bool accept_this_node = true;
-
-
-				// Is this a potential solution
-				const double goal_dist = new_state.distance2DTo(pi.goal_pose.x,pi.goal_pose.y);
-				const double goal_ang  = std::abs( mrpt::math::angDistance(new_state.phi(), pi.goal_pose.phi ) );
-				const bool is_acceptable_goal =
-					(goal_dist<end_criteria.acceptedDistToTarget) &&
-					(goal_ang <end_criteria.acceptedAngToTarget);
-
-				mrpt::utils::TNodeID new_nearest_id=INVALID_NODEID;
-				if (!is_acceptable_goal) // Only check for nearby nodes if this is not a solution!
-				{
-					double new_nearest_dist;
-					const TNodeSE2 new_state_node(new_state);
-
-					m_timelogger.enter("TMoveTree::getNearestNode");
-					new_nearest_id = result.move_tree.getNearestNode(new_state_node, distance_evaluator_se2,&new_nearest_dist, &result.acceptable_goal_node_ids );
-					m_timelogger.leave("TMoveTree::getNearestNode");
-
-					if (new_nearest_id!=INVALID_NODEID)
-					{
-						// Also check angular distance:
-						const double new_nearest_ang = std::abs( mrpt::math::angDistance(new_state.phi(), result.move_tree.getAllNodes().find(new_nearest_id)->second.state.phi ) );
-						accept_this_node = (new_nearest_dist>=params.minDistanceBetweenNewNodes || new_nearest_ang >= params.minAngBetweenNewNodes);
-					}
-				}
-
-				if (!accept_this_node)
-				{
-#ifdef DO_LOG_TXTS
-					if (new_nearest_id!=INVALID_NODEID) {
-						sLogTxt += mrpt::format(" -> new node NOT accepted for closeness to: %s\n",result.move_tree.getAllNodes().find(new_nearest_id)->second.state.asString().c_str());
-					}
-#endif
-					continue; // Too close node, skip!
-				}
-
-				// [Algo `tp_space_rrt`: Line 16]: Add to candidate solution set
-				// ------------------------------------------------------------
-				// Create "movement" (tree edge) object:
-				TMoveEdgeSE2_TP new_edge(x_nearest_id, mrpt::math::TPose2D(new_state));
-				
-				new_edge.cost     = d_new;
-				new_edge.ptg_index= idxPTG;
-				new_edge.ptg_K    = k_rand;
-				new_edge.ptg_dist = d_new;
-
-				candidate_new_nodes[new_edge.cost] = new_edge;
-
-			} // end if the path is obstacle free
-			else
-			{
-#ifdef DO_LOG_TXTS
-				sLogTxt += mrpt::format(" -> d_free NOT < d_rand\n");
-#endif
-			}
-
-
+			if (c.is_valid)
+				candidate_new_nodes[c.edge.cost] = c.edge;
 		} // end for idxPTG
 
 		// [Algo `tp_space_rrt`: Line 19]: Any solution found?
@@ -381,3 +263,173 @@ void PlannerRRT_SE2_TPS::solve(
 
 
 
+
+void PlannerRRT_SE2_TPS::evalPTGEdgesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+{
+	TPTGEdgesEvalTask &t = *static_cast<TPTGEdgesEvalTask*>(user_param);
+	PlannerRRT_SE2_TPS &planner = *t.planner;
+
+	for (size_t idxPTG=first;idxPTG<last;idxPTG++)
+		planner.evalPTGEdgeCandidate(idxPTG, *t.pi, *t.result, t.x_rand, planner.m_local_obs_per_thread[thread_idx], t.candidates[idxPTG]);
+}
+
+//#define DO_LOG_TXTS
+
+void PlannerRRT_SE2_TPS::evalPTGEdgeCandidate(
+	size_t idxPTG,
+	const TPlannerInput &pi,
+	const TPlannerResult &result,
+	const node_pose_t &x_rand,
+	mrpt::maps::CSimplePointsMap &local_obs,
+	TPTGEdgeCandidate &out)
+{
+	const CPose2D x_rand_pose(x_rand);
+	const PoseDistanceMetric<TNodeSE2> distance_evaluator_se2;  // Plain distances in SE(2), not along PTGs
+	CTicTac tictac;
+#ifdef DO_LOG_TXTS
+	std::string &sLogTxt = out.log_txt;
+#endif
+
+	// [Algo `tp_space_rrt`: Line 5]: Search nearest neig. to x_rand
+	// -----------------------------------------------
+	const PoseDistanceMetric<TNodeSE2_TP> distance_evaluator(*m_PTGs[idxPTG]);
+
+	const TNodeSE2_TP query_node(x_rand);
+
+	tictac.Tic();
+	mrpt::utils::TNodeID x_nearest_id = result.move_tree.getNearestNode(query_node, distance_evaluator );
+	out.time_getNearestNode = tictac.Tac();
+
+	if (x_nearest_id==INVALID_NODEID)
+	{
+		// We can't find any close node, at least with this PTG's paths: skip
+		out.no_nearest_node = true;
+		return;
+	}
+
+	const TNodeSE2_TP &     x_nearest_node = result.move_tree.getAllNodes().find(x_nearest_id)->second;
+
+	// [Algo `tp_space_rrt`: Line 6]: Relative target
+	// -----------------------------------------------
+	const CPose2D x_nearest_pose( x_nearest_node.state );
+	const CPose2D x_rand_rel = x_rand_pose - x_nearest_pose;
+
+	// [Algo `tp_space_rrt`: Line 7]: Relative target in TP-Space
+	// ------------------------------------------------------------
+	const double D_max = std::min(params.maxLength, m_PTGs[idxPTG]->getRefDistance() );
+
+	double d_rand; // Coordinates in TP-space
+	int   k_rand; // k_rand is the index of target_alpha in PTGs corresponding to a specific d_rand
+	//bool tp_point_is_exact =
+	m_PTGs[idxPTG]->inverseMap_WS2TP(
+		x_rand_rel.x(), x_rand_rel.y(),
+		k_rand, d_rand );
+	d_rand *= m_PTGs[idxPTG]->getRefDistance(); // distance to target, in "real meters"
+
+	float d_free;
+
+	// [Algo `tp_space_rrt`: Line 8]: TP-Obstacles
+	// ------------------------------------------------------------
+	// Transform obstacles as seen from x_nearest_node -> TP_obstacles
+	double TP_Obstacles_k_rand = .0; //vector<double> TP_Obstacles;
+	const double MAX_DIST_FOR_OBSTACLES = 1.5*m_PTGs[idxPTG]->getRefDistance(); // Maximum Euclidean distance (radius) for considering obstacles around the current robot pose
+
+	tictac.Tic();
+	transformPointcloudWithSquareClipping(pi.obstacles_points,local_obs,CPose2D(x_nearest_node.state),MAX_DIST_FOR_OBSTACLES);
+	out.time_changeCoordinatesReference = tictac.Tac();
+
+	tictac.Tic();
+	spaceTransformerOneDirectionOnly(k_rand, local_obs, m_PTGs[idxPTG].pointer(), MAX_DIST_FOR_OBSTACLES, TP_Obstacles_k_rand);
+	out.time_SpaceTransformer = tictac.Tac();
+
+	// directions k_rand in TP_obstacles[k_rand] = d_free
+	// this is the collision free distance to the TP_target
+	d_free = TP_Obstacles_k_rand; // TP_Obstacles[k_rand];
+
+	// [Algo `tp_space_rrt`: Line 10]: d_new
+	// ------------------------------------------------------------
+	double d_new = std::min(D_max, d_rand);   //distance of the new candidate state in TP-space
+
+#ifdef DO_LOG_TXTS
+	sLogTxt += mrpt::format("tp_idx=%u tp_exact=%c\n d_free: %f d_rand=%f d_new=%f\n",static_cast<unsigned int>(idxPTG), tp_point_is_exact ? 'Y':'N',d_free,d_rand,d_new);
+	sLogTxt += mrpt::format(" nearest:%s\n",x_nearest_pose.asString().c_str());
+#endif
+
+	// [Algo `tp_space_rrt`: Line 13]: Do we have free space?
+	// ------------------------------------------------------------
+	if ( d_free>=d_new )
+	{
+		// [Algo `tp_space_rrt`: Line 14]: PTG function
+		// ------------------------------------------------------------
+		//given d_rand and k_rand provides x,y,phi of the point in c-space
+		uint32_t nStep;
+		m_PTGs[idxPTG]->getPathStepForDist(k_rand, d_new, nStep);
+
+		mrpt::math::TPose2D rel_pose;
+		m_PTGs[idxPTG]->getPathPose(k_rand, nStep, rel_pose);
+
+		mrpt::math::wrapToPiInPlace(rel_pose.phi); // wrap to [-pi,pi] -->avoid out of bounds errors
+
+		// [Algo `tp_space_rrt`: Line 15]: pose composition
+		// ------------------------------------------------------------
+		const mrpt::poses::CPose2D new_state_rel(rel_pose);
+		mrpt::poses::CPose2D new_state = x_nearest_pose+new_state_rel; //compose the new_motion as the last nmotion and the new state
+
+		// Check whether there's already a too-close node around:
+		// --------------------------------------------------------
+		bool accept_this_node = true;
+
+		// Is this a potential solution
+		const double goal_dist = new_state.distance2DTo(pi.goal_pose.x,pi.goal_pose.y);
+		const double goal_ang  = std::abs( mrpt::math::angDistance(new_state.phi(), pi.goal_pose.phi ) );
+		const bool is_acceptable_goal =
+			(goal_dist<end_criteria.acceptedDistToTarget) &&
+			(goal_ang <end_criteria.acceptedAngToTarget);
+
+		mrpt::utils::TNodeID new_nearest_id=INVALID_NODEID;
+		if (!is_acceptable_goal) // Only check for nearby nodes if this is not a solution!
+		{
+			double new_nearest_dist;
+			const TNodeSE2 new_state_node(new_state);
+
+			tictac.Tic();
+			new_nearest_id = result.move_tree.getNearestNode(new_state_node, distance_evaluator_se2,&new_nearest_dist, &result.acceptable_goal_node_ids );
+			out.time_getNearestNode_new_state = tictac.Tac();
+
+			if (new_nearest_id!=INVALID_NODEID)
+			{
+				// Also check angular distance:
+				const double new_nearest_ang = std::abs( mrpt::math::angDistance(new_state.phi(), result.move_tree.getAllNodes().find(new_nearest_id)->second.state.phi ) );
+				accept_this_node = (new_nearest_dist>=params.minDistanceBetweenNewNodes || new_nearest_ang >= params.minAngBetweenNewNodes);
+			}
+		}
+
+		if (!accept_this_node)
+		{
+#ifdef DO_LOG_TXTS
+			if (new_nearest_id!=INVALID_NODEID) {
+				sLogTxt += mrpt::format(" -> new node NOT accepted for closeness to: %s\n",result.move_tree.getAllNodes().find(new_nearest_id)->second.state.asString().c_str());
+			}
+#endif
+			return; // Too close node, skip!
+		}
+
+		// Create "movement" (tree edge) object:
+		TMoveEdgeSE2_TP new_edge(x_nearest_id, mrpt::math::TPose2D(new_state));
+
+		new_edge.cost     = d_new;
+		new_edge.ptg_index= idxPTG;
+		new_edge.ptg_K    = k_rand;
+		new_edge.ptg_dist = d_new;
+
+		out.edge = new_edge;
+		out.is_valid = true;
+
+	} // end if the path is obstacle free
+	else
+	{
+#ifdef DO_LOG_TXTS
+		sLogTxt += mrpt::format(" -> d_free NOT < d_rand\n");
+#endif
+	}
+}
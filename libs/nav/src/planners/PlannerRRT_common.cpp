@@ -27,7 +27,8 @@ RRTAlgorithmParams::RRTAlgorithmParams() :
 	minDistanceBetweenNewNodes(0.10),
 	minAngBetweenNewNodes(mrpt::utils::DEG2RAD(15)),
 	ptg_verbose(true),
-	save_3d_log_freq(0)
+	save_3d_log_freq(0),
+	ptg_eval_num_threads(1)
 {
 	robot_shape.push_back(mrpt::math::TPoint2D(-0.5, -0.5));
 	robot_shape.push_back(mrpt::math::TPoint2D(0.8, -0.4));
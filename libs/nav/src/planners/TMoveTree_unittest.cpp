@@ -0,0 +1,126 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/nav/planners/TMoveTree.h>
+#include <mrpt/nav/tpspace/CPTG_DiffDrive_C.h>
+#include <mrpt/utils/CConfigFileMemory.h>
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+using namespace mrpt;
+using namespace mrpt::math;
+using namespace mrpt::nav;
+using namespace mrpt::utils;
+
+namespace
+{
+	double randomIn(double a, double b) { return a + (b-a)*(std::rand()/double(RAND_MAX)); }
+
+	// Compares the KD-tree-based searches against brute force, for the given tree and random queries:
+	void checkSearches(const TMoveTreeSE2_TP &tree)
+	{
+		const PoseDistanceMetric<TNodeSE2> metric;
+		std::set<TNodeID> ignored;
+		ignored.insert(1);
+
+		for (int q=0;q<200;q++)
+		{
+			const TNodeSE2 query(TPose2D(randomIn(-12,12),randomIn(-12,12),randomIn(-M_PI,M_PI)));
+			const std::set<TNodeID> *ignored_nodes = (q%2) ? &ignored : NULL;
+
+			double best_d = std::numeric_limits<double>::max();
+			TNodeID best_id = INVALID_NODEID;
+			for (TMoveTreeSE2_TP::node_map_t::const_iterator it=tree.getAllNodes().begin();it!=tree.getAllNodes().end();++it)
+			{
+				if (ignored_nodes && ignored_nodes->count(it->first)) continue;
+				const double d = metric.distance(TNodeSE2(it->second.state),query);
+				if (d<best_d) { best_d = d; best_id = it->first; }
+			}
+
+			double d;
+			const TNodeID id = tree.getNearestNode(query, metric, &d, ignored_nodes);
+			EXPECT_EQ(id, best_id);
+			EXPECT_EQ(d, best_d);
+
+			const double max_dist = 2.0;
+			std::vector<std::pair<TNodeID,double> > near_nodes, near_nodes_bf;
+			tree.getNodesWithinDistance(query, metric, max_dist, near_nodes);
+			for (TMoveTreeSE2_TP::node_map_t::const_iterator it=tree.getAllNodes().begin();it!=tree.getAllNodes().end();++it)
+			{
+				const double dn = metric.distance(TNodeSE2(it->second.state),query);
+				if (dn<=max_dist)
+					near_nodes_bf.push_back(std::make_pair(it->first,dn));
+			}
+			EXPECT_TRUE(near_nodes==near_nodes_bf);
+		}
+	}
+}
+
+TEST(NavTests, TMoveTree_nearest_nodes)
+{
+	std::srand(1234);
+
+	// Random nodes, as in RRT planners:
+	{
+		TMoveTreeSE2_TP tree;
+		tree.insertNode(0, TNodeSE2_TP(TPose2D(0,0,0)));
+		for (TNodeID id=1;id<2000;id++)
+		{
+			const TPose2D p(randomIn(-10,10),randomIn(-10,10),randomIn(-M_PI,M_PI));
+			tree.insertNodeAndEdge(std::rand() % id, id, TNodeSE2_TP(p), TMoveEdgeSE2_TP(0,p));
+		}
+		checkSearches(tree);
+	}
+
+	// Nodes sorted along a line, plus repeated poses (forces rebuilding the KD-tree):
+	{
+		TMoveTreeSE2_TP tree;
+		tree.insertNode(0, TNodeSE2_TP(TPose2D(-10,-10,0)));
+		for (TNodeID id=1;id<1000;id++)
+		{
+			const TPose2D p = (id%3) ? TPose2D(-10+0.02*id,-10+0.01*id,0) : TPose2D(1,1,0.1*id);
+			tree.insertNodeAndEdge(id-1, id, TNodeSE2_TP(p), TMoveEdgeSE2_TP(0,p));
+		}
+		checkSearches(tree);
+	}
+}
+
+TEST(NavTests, TMoveTree_nearest_node_PTG_metric)
+{
+	// C-PTG (circular arcs), driving forward only:
+	CConfigFileMemory cfg;
+	cfg.write("PTG","num_paths",101);
+	cfg.write("PTG","refDistance",3.0);
+	cfg.write("PTG","resolution",0.25);
+	cfg.write("PTG","v_max_mps",1.0);
+	cfg.write("PTG","w_max_dps",60.0);
+	cfg.write("PTG","K",1.0);
+	const CPTG_DiffDrive_C ptg(cfg,"PTG");
+	const PoseDistanceMetric<TNodeSE2_TP> metric(ptg);
+
+	// Nodes along the X axis, all heading forward:
+	TMoveTreeSE2_TP tree;
+	tree.insertNode(0, TNodeSE2_TP(TPose2D(0,0,0)));
+	for (TNodeID id=1;id<50;id++)
+		tree.insertNodeAndEdge(id-1, id, TNodeSE2_TP(TPose2D(id,0,0)), TMoveEdgeSE2_TP(0,TPose2D(id,0,0)));
+
+	// Right behind all the nodes: no node can reach these poses.
+	for (int i=1;i<=10;i++)
+	{
+		double d = 0;
+		const TNodeID id = tree.getNearestNode(TNodeSE2_TP(TPose2D(-0.5*i,0,0)), metric, &d);
+		EXPECT_EQ(id, INVALID_NODEID) << "i=" << i;
+		EXPECT_EQ(d, std::numeric_limits<double>::max()) << "i=" << i;
+	}
+
+	// Ahead of all the nodes: the last one is the nearest.
+	double d = 0;
+	EXPECT_EQ(tree.getNearestNode(TNodeSE2_TP(TPose2D(50.5,0,0)), metric, &d), TNodeID(49));
+	EXPECT_NEAR(d, 1.5, 1e-6);
+}
@@ -87,7 +87,8 @@ void CAbstractPTGBasedReactive::preDestructor()
 
 	mrpt::utils::delete_safe(m_logFile);
 
-	// Free holonomic method:
+	// Stop the PTG evaluation threads, then free holonomic method:
+	m_ptg_eval_pool.clear();
 	this->deleteHolonomicObjects();
 }
 
@@ -303,9 +304,6 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 		// ------- start of motion decision zone ---------
 		executionTime.Tic();
 
-		// Round #1: As usual, pure reactive, evaluate all PTGs and all directions from scratch.
-		// =========
-
 		mrpt::math::TPose2D rel_pose_PTG_origin_wrt_sense(0,0,0),relPoseSense(0,0,0), relPoseVelCmd(0,0,0);
 		if (params_abstract_ptg_navigator.use_delays_model)
 		{
@@ -392,48 +390,17 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 		m_infoPerPTG_timestamp = tim_start_iteration;
 		vector<TCandidateMovementPTG> candidate_movs(nPTGs+1); // the last extra one is for the evaluation of "NOP motion command" choice.
 
-		for (size_t indexPTG=0;indexPTG<nPTGs;indexPTG++)
-		{
-			CParameterizedTrajectoryGenerator * ptg = getPTG(indexPTG);
-			TInfoPerPTG &ipf = m_infoPerPTG[indexPTG];
-
-			// The picked movement in TP-Space (to be determined by holonomic method below)
-			TCandidateMovementPTG &cm = candidate_movs[indexPTG];
-
-			ASSERT_(m_navigationParams);
-			build_movement_candidate(
-				ptg, indexPTG,
-				relTarget, rel_pose_PTG_origin_wrt_sense,
-				ipf, cm,
-				newLogRec, false /* this is a regular PTG reactive case */,
-				m_holonomicMethod[indexPTG],
-				tim_start_iteration,
-				*m_navigationParams
-				);
-		} // end for each PTG
-
-		// check for collision, which is reflected by ALL TP-Obstacles being zero:
-		bool is_all_ptg_collision = true;
-		for (size_t indexPTG = 0; indexPTG < nPTGs; indexPTG++)
-		{
-			bool is_collision = true;
-			const auto & obs = m_infoPerPTG[indexPTG].TP_Obstacles;
-			for (const auto o : obs) {
-				if (o != 0) {
-					is_collision = false;
-					break;
-				}
-			}
-			if (!is_collision) {
-				is_all_ptg_collision = false;
-				break;
-			}
-		}
-		if (is_all_ptg_collision) {
-			m_robot.sendApparentCollisionEvent();
-		}
-
-		// Round #2: Evaluate dont sending any new velocity command ("NOP" motion)
+		TCandidatesEvalTask evalTask;
+		evalTask.nav = this;
+		evalTask.relTarget = relTarget;
+		evalTask.rel_pose_PTG_origin_wrt_sense = rel_pose_PTG_origin_wrt_sense;
+		evalTask.tim_start_iteration = tim_start_iteration;
+		evalTask.newLogRec = &newLogRec;
+		evalTask.candidate_movs = &candidate_movs;
+		evalTask.evalLogs.resize(nPTGs+1);
+		evalTask.NOP_ptg_idx = -1;
+
+		// Round #2 (decided here, evaluated below along with round #1): Evaluate dont sending any new velocity command ("NOP" motion)
 		// =========
 		bool NOP_not_too_old = true;
 		bool NOP_not_too_close_and_have_to_slowdown = true;
@@ -501,30 +468,20 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 			{
 				ASSERT_(last_sent_ptg!=nullptr);
 
-				const TPose2D relTarget_NOP = m_navigationParams->target - robot_pose_at_send_cmd;
+				evalTask.relTarget_NOP = m_navigationParams->target - robot_pose_at_send_cmd;
 				rel_pose_PTG_origin_wrt_sense_NOP = robot_odom_at_send_cmd - (m_curPoseVel.rawOdometry + relPoseSense);
 				rel_cur_pose_wrt_last_vel_cmd_NOP = m_curPoseVel.rawOdometry - robot_odom_at_send_cmd;
 
-				// Update PTG response to dynamic params:
-				last_sent_ptg->updateNavDynamicState(m_lastSentVelCmd.ptg_dynState);
-
 				if (fill_log_record)
 				{
 					newLogRec.additional_debug_msgs["rel_cur_pose_wrt_last_vel_cmd_NOP(interp)"] = rel_cur_pose_wrt_last_vel_cmd_NOP.asString();
 					newLogRec.additional_debug_msgs["robot_odom_at_send_cmd(interp)"] = robot_odom_at_send_cmd.asString();
 				}
 
-				ASSERT_(m_navigationParams);
-				build_movement_candidate(
-					last_sent_ptg, m_lastSentVelCmd.ptg_index,
-					relTarget_NOP, rel_pose_PTG_origin_wrt_sense_NOP,
-					m_infoPerPTG[nPTGs], candidate_movs[nPTGs],
-					newLogRec, true /* this is the PTG continuation (NOP) choice */,
-					m_holonomicMethod[m_lastSentVelCmd.ptg_index],
-					tim_start_iteration,
-					*m_navigationParams,
-					rel_cur_pose_wrt_last_vel_cmd_NOP);
-
+				// The NOP candidate is evaluated right after the regular evaluation of its PTG, in the same thread:
+				evalTask.NOP_ptg_idx = m_lastSentVelCmd.ptg_index;
+				evalTask.rel_pose_PTG_origin_wrt_sense_NOP = rel_pose_PTG_origin_wrt_sense_NOP;
+				evalTask.rel_cur_pose_wrt_last_vel_cmd_NOP = rel_cur_pose_wrt_last_vel_cmd_NOP;
 			} // end valid interpolated origin pose
 			else
 			{
@@ -533,6 +490,57 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 			}
 		} //end can_do_NOP_motion
 
+		// Round #1: As usual, pure reactive, evaluate all PTGs and all directions from scratch (plus the NOP candidate, if any).
+		// =========
+		if (last_sent_ptg) {
+			// Restore the dynamic state of the current step for the regular evaluation:
+			last_sent_ptg->updateNavDynamicState(ptg_dynState);
+		}
+		{
+			const unsigned int nThreads = params_abstract_ptg_navigator.ptg_eval_num_threads!=0 ? params_abstract_ptg_navigator.ptg_eval_num_threads : mrpt::system::getNumberOfProcessors();
+
+			CTicTac tictacEval;
+			m_ptg_eval_pool.parallelForBlocks(nPTGs, &CAbstractPTGBasedReactive::evalMovementCandidatesBlock, &evalTask, nThreads);
+			newLogRec.values["time_PTGs_eval"] = tictacEval.Tac();
+			newLogRec.values["num_threads_PTGs_eval"] = std::min<size_t>(nThreads, nPTGs);
+
+			// Merge the outputs of each candidate, in order:
+			for (size_t i=0;i<evalTask.evalLogs.size();i++)
+			{
+				const TCandidateEvalLog &el = evalTask.evalLogs[i];
+				for (std::map<std::string,std::string>::const_iterator it=el.debug_msgs.begin();it!=el.debug_msgs.end();++it)
+					newLogRec.additional_debug_msgs[it->first] = it->second;
+
+				if (m_timelogger.isEnabled())
+				{
+					if (el.timeForTPObsTransformation>=0) m_timelogger.registerUserMeasure("navigationStep.STEP3_WSpaceToTPSpace", el.timeForTPObsTransformation);
+					if (el.timeForHolonomicMethod>=0) m_timelogger.registerUserMeasure("navigationStep.STEP4_HolonomicMethod", el.timeForHolonomicMethod);
+					if (el.timeForCandidateScores>=0) m_timelogger.registerUserMeasure("navigationStep.calc_move_candidate_scores", el.timeForCandidateScores);
+				}
+			}
+		}
+
+		// check for collision, which is reflected by ALL TP-Obstacles being zero:
+		bool is_all_ptg_collision = true;
+		for (size_t indexPTG = 0; indexPTG < nPTGs; indexPTG++)
+		{
+			bool is_collision = true;
+			const auto & obs = m_infoPerPTG[indexPTG].TP_Obstacles;
+			for (const auto o : obs) {
+				if (o != 0) {
+					is_collision = false;
+					break;
+				}
+			}
+			if (!is_collision) {
+				is_all_ptg_collision = false;
+				break;
+			}
+		}
+		if (is_all_ptg_collision) {
+			m_robot.sendApparentCollisionEvent();
+		}
+
 		// Evaluate all the candidates and pick the "best" one, using 
 		// the user-defined multiobjective optimizer
 		// --------------------------------------------------------------
@@ -731,6 +739,48 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 }
 
 
+void CAbstractPTGBasedReactive::evalMovementCandidatesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+{
+	MRPT_UNUSED_PARAM(thread_idx);
+	TCandidatesEvalTask &t = *static_cast<TCandidatesEvalTask*>(user_param);
+	CAbstractPTGBasedReactive &nav = *t.nav;
+	const size_t nPTGs = nav.getPTG_count();
+
+	for (size_t indexPTG=first;indexPTG<last;indexPTG++)
+	{
+		CParameterizedTrajectoryGenerator * ptg = nav.getPTG(indexPTG);
+
+		ASSERT_(nav.m_navigationParams);
+		nav.build_movement_candidate(
+			ptg, indexPTG,
+			t.relTarget, t.rel_pose_PTG_origin_wrt_sense,
+			nav.m_infoPerPTG[indexPTG], (*t.candidate_movs)[indexPTG],
+			*t.newLogRec, t.evalLogs[indexPTG],
+			false /* this is a regular PTG reactive case */,
+			nav.m_holonomicMethod[indexPTG],
+			t.tim_start_iteration,
+			*nav.m_navigationParams
+			);
+
+		if (t.NOP_ptg_idx==static_cast<int>(indexPTG))
+		{
+			// Update PTG response to dynamic params:
+			ptg->updateNavDynamicState(nav.m_lastSentVelCmd.ptg_dynState);
+
+			nav.build_movement_candidate(
+				ptg, indexPTG,
+				t.relTarget_NOP, t.rel_pose_PTG_origin_wrt_sense_NOP,
+				nav.m_infoPerPTG[nPTGs], (*t.candidate_movs)[nPTGs],
+				*t.newLogRec, t.evalLogs[nPTGs],
+				true /* this is the PTG continuation (NOP) choice */,
+				nav.m_holonomicMethod[indexPTG],
+				t.tim_start_iteration,
+				*nav.m_navigationParams,
+				t.rel_cur_pose_wrt_last_vel_cmd_NOP);
+		}
+	}
+}
+
 void CAbstractPTGBasedReactive::STEP8_GenerateLogRecord(CLogFileRecord &newLogRec,const TPose2D& relTarget,int nSelectedPTG, const mrpt::kinematics::CVehicleVelCmdPtr &new_vel_cmd, const int nPTGs, const bool best_is_NOP_cmdvel, const mrpt::math::TPose2D &rel_cur_pose_wrt_last_vel_cmd_NOP, const mrpt::math::TPose2D &rel_pose_PTG_origin_wrt_sense_NOP, const double executionTimeValue, const double tim_changeSpeed, const mrpt::system::TTimeStamp &tim_start_iteration)
 {
 	// ---------------------------------------
@@ -793,7 +843,7 @@ void CAbstractPTGBasedReactive::calc_move_candidate_scores(
 	const mrpt::math::TPose2D  & WS_Target,
 	const mrpt::math::TPoint2D & TP_Target,
 	CLogFileRecord::TInfoPerPTG & log,
-	CLogFileRecord & newLogRec,
+	std::map<std::string, std::string> & debug_msgs,
 	const bool this_is_PTG_continuation,
 	const mrpt::math::TPose2D & rel_cur_pose_wrt_last_vel_cmd_NOP,
 	const unsigned int ptg_idx4weights,
@@ -830,7 +880,7 @@ void CAbstractPTGBasedReactive::calc_move_candidate_scores(
 
 		const double f = std::min(1.0,Vf + target_WS_d*(1.0-Vf)/TARGET_SLOW_APPROACHING_DISTANCE);
 		if (f < cm.speed) {
-			newLogRec.additional_debug_msgs["PTG_eval.speed"] = mrpt::format("Relative speed reduced %.03f->%.03f based on Euclidean nearness to target.", cm.speed,f);
+			debug_msgs["PTG_eval.speed"] = mrpt::format("Relative speed reduced %.03f->%.03f based on Euclidean nearness to target.", cm.speed,f);
 			cm.speed = f;
 		}
 	}
@@ -885,7 +935,7 @@ void CAbstractPTGBasedReactive::calc_move_candidate_scores(
 			is_time_based = true;
 			is_exact = true; // well, sort of...
 			const double NOP_At = m_lastSentVelCmd.speed_scale * mrpt::system::timeDifference(m_lastSentVelCmd.tim_send_cmd_vel, tim_start_iteration);
-			newLogRec.additional_debug_msgs["PTG_eval.NOP_At"] = mrpt::format("%.06f s",NOP_At);
+			debug_msgs["PTG_eval.NOP_At"] = mrpt::format("%.06f s",NOP_At);
 			cur_k = move_k;
 			cur_ptg_step = mrpt::utils::round(NOP_At / cm.PTG->getPathStepDuration());
 			cur_norm_d = cm.PTG->getPathDist(cur_k, cur_ptg_step) / cm.PTG->getRefDistance();
@@ -902,7 +952,7 @@ void CAbstractPTGBasedReactive::calc_move_candidate_scores(
 		{
 			// Don't trust this step: we are not 100% sure of the robot pose in TP-Space for this "PTG continuation" step:
 			cm.speed = -0.01; // this enforces a 0 global evaluation score
-			newLogRec.additional_debug_msgs["PTG_eval"] = "PTG-continuation not allowed, cur. pose out of PTG domain.";
+			debug_msgs["PTG_eval"] = "PTG-continuation not allowed, cur. pose out of PTG domain.";
 			return;
 		}
 		bool WS_point_is_unique = true; 
@@ -914,7 +964,7 @@ void CAbstractPTGBasedReactive::calc_move_candidate_scores(
 				WS_point_is_unique = cm.PTG->isBijectiveAt(cur_k, cur_ptg_step);
 				const uint32_t predicted_step = mrpt::system::timeDifference(m_lastSentVelCmd.tim_send_cmd_vel, mrpt::system::now()) / cm.PTG->getPathStepDuration();
 				WS_point_is_unique = WS_point_is_unique && cm.PTG->isBijectiveAt(move_k, predicted_step);
-				newLogRec.additional_debug_msgs["PTG_eval.bijective"] = mrpt::format("isBijectiveAt(): k=%i step=%i -> %s", (int)cur_k, (int)cur_ptg_step, WS_point_is_unique ? "yes" : "no");
+				debug_msgs["PTG_eval.bijective"] = mrpt::format("isBijectiveAt(): k=%i step=%i -> %s", (int)cur_k, (int)cur_ptg_step, WS_point_is_unique ? "yes" : "no");
 
 				if (!WS_point_is_unique)
 				{
@@ -935,21 +985,21 @@ void CAbstractPTGBasedReactive::calc_move_candidate_scores(
 				cm.PTG->getPathPose(m_lastSentVelCmd.ptg_alpha_index, cur_ptg_step, predicted_rel_pose);
 				const auto predicted_pose_global = m_lastSentVelCmd.poseVel.rawOdometry + predicted_rel_pose;
 				const double predicted2real_dist = mrpt::math::hypot_fast(predicted_pose_global.x - m_curPoseVel.rawOdometry.x, predicted_pose_global.y - m_curPoseVel.rawOdometry.y);
-				newLogRec.additional_debug_msgs["PTG_eval.lastCmdPose(raw)"] = m_lastSentVelCmd.poseVel.pose.asString();
-				newLogRec.additional_debug_msgs["PTG_eval.PTGcont"] = mrpt::format("mismatchDistance=%.03f cm", 1e2*predicted2real_dist);
+				debug_msgs["PTG_eval.lastCmdPose(raw)"] = m_lastSentVelCmd.poseVel.pose.asString();
+				debug_msgs["PTG_eval.PTGcont"] = mrpt::format("mismatchDistance=%.03f cm", 1e2*predicted2real_dist);
 
 				if (predicted2real_dist > params_abstract_ptg_navigator.max_distance_predicted_actual_path &&
 					(!is_slowdown || (target_d_norm - cur_norm_d)*ref_dist>2.0 /*meters*/)
 					)
 				{
 					cm.speed = -0.01; // this enforces a 0 global evaluation score
-					newLogRec.additional_debug_msgs["PTG_eval"] = "PTG-continuation not allowed, mismatchDistance above threshold.";
+					debug_msgs["PTG_eval"] = "PTG-continuation not allowed, mismatchDistance above threshold.";
 					return;
 				}
 			}
 			else {
 				cm.speed = -0.01; // this enforces a 0 global evaluation score
-				newLogRec.additional_debug_msgs["PTG_eval"] = "PTG-continuation not allowed, couldn't get PTG step for cur. robot pose.";
+				debug_msgs["PTG_eval"] = "PTG-continuation not allowed, couldn't get PTG step for cur. robot pose.";
 				return;
 			}
 		}
@@ -1185,6 +1235,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 	TInfoPerPTG &ipf,
 	TCandidateMovementPTG &cm,
 	CLogFileRecord &newLogRec,
+	TCandidateEvalLog &evalLog,
 	const bool this_is_PTG_continuation,
 	mrpt::nav::CAbstractHolonomicReactiveMethod *holoMethod,
 	const mrpt::system::TTimeStamp tim_start_iteration,
@@ -1227,7 +1278,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		ipf.target_k = 0;
 		ipf.target_dist = 0;
 
-		newLogRec.additional_debug_msgs[mrpt::format("mov_candidate_%u", static_cast<unsigned int>(indexPTG))] = "PTG discarded since target is out of domain.";
+		evalLog.debug_msgs[mrpt::format("mov_candidate_%u", static_cast<unsigned int>(indexPTG))] = "PTG discarded since target is out of domain.";
 
 		{   // Invalid PTG (target out of reachable space):
 			// - holonomicMovement= Leave default values
@@ -1243,7 +1294,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		//  STEP3(b): Build TP-Obstacles
 		// -----------------------------------------------------------------------------
 		{
-			tictac.Tic();
+			CTicTac tictac;
 
 			// Initialize TP-Obstacles:
 			const size_t Ki = ptg->getAlphaValuesCount();
@@ -1263,16 +1314,14 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 			const double _refD = 1.0 / ptg->getRefDistance();
 			for (size_t i = 0; i < Ki; i++) ipf.TP_Obstacles[i] *= _refD;
 
-			timeForTPObsTransformation = tictac.Tac();
-			if (m_timelogger.isEnabled())
-				m_timelogger.registerUserMeasure("navigationStep.STEP3_WSpaceToTPSpace", timeForTPObsTransformation);
+			timeForTPObsTransformation = evalLog.timeForTPObsTransformation = tictac.Tac();
 		}
 
 		//  STEP4: Holonomic navigation method
 		// -----------------------------------------------------------------------------
 		if (!this_is_PTG_continuation)
 		{
-			tictac.Tic();
+			CTicTac tictac;
 
 			ASSERT_(holoMethod);
 			// Slow down if we are approaching the final target, etc.
@@ -1319,9 +1368,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 			// Scale:
 			cm.speed *= velScale;
 
-			timeForHolonomicMethod = tictac.Tac();
-			if (m_timelogger.isEnabled())
-				m_timelogger.registerUserMeasure("navigationStep.STEP4_HolonomicMethod", timeForHolonomicMethod);
+			timeForHolonomicMethod = evalLog.timeForHolonomicMethod = tictac.Tac();
 		}
 		else
 		{
@@ -1333,7 +1380,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		// STEP5: Evaluate each movement to assign them a "evaluation" value.
 		// ---------------------------------------------------------------------
 		{
-			CTimeLoggerEntry tle(m_timelogger, "navigationStep.calc_move_candidate_scores");
+			CTicTac tictac;
 
 			calc_move_candidate_scores(
 				cm,
@@ -1341,7 +1388,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 				ipf.clearance,
 				relTarget,
 				ipf.TP_Target,
-				newLogRec.infoPerPTG[idx_in_log_infoPerPTGs], newLogRec,
+				newLogRec.infoPerPTG[idx_in_log_infoPerPTGs], evalLog.debug_msgs,
 				this_is_PTG_continuation, rel_cur_pose_wrt_last_vel_cmd_NOP,
 				indexPTG, 
 				tim_start_iteration);
@@ -1355,6 +1402,8 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 
 			//  SAVE LOG
 			newLogRec.infoPerPTG[idx_in_log_infoPerPTGs].evalFactors = cm.props;
+
+			evalLog.timeForCandidateScores = tictac.Tac();
 		}
 
 	} // end "valid_TP"
@@ -1397,6 +1446,7 @@ void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR_CS(enable_obstacle_filtering, bool);
 	MRPT_LOAD_CONFIG_VAR_CS(evaluate_clearance, bool);
 	MRPT_LOAD_CONFIG_VAR_CS(max_dist_for_timebased_path_prediction, double);
+	MRPT_LOAD_CONFIG_VAR_CS(ptg_eval_num_threads, int);
 
 	MRPT_END;
 }
@@ -1433,6 +1483,7 @@ void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::saveToConfigFile(mr
 	MRPT_SAVE_CONFIG_VAR_COMMENT(enable_obstacle_filtering, "Enabled obstacle filtering (params in its own section)");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(evaluate_clearance, "Enable exact computation of clearance (default=false)");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(max_dist_for_timebased_path_prediction, "Max dist [meters] to use time-based path prediction for NOP evaluation");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(ptg_eval_num_threads, "Number of threads for evaluating all PTGs in each navigation step (Default=1, 0=one per processor)");
 }
 
 CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::TAbstractPTGNavigatorParams() :
@@ -1448,7 +1499,8 @@ CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::TAbstractPTGNavigatorPar
 	robot_absolute_speed_limits(),
 	enable_obstacle_filtering(true),
 	evaluate_clearance(false),
-	max_dist_for_timebased_path_prediction(2.0)
+	max_dist_for_timebased_path_prediction(2.0),
+	ptg_eval_num_threads(1)
 {
 }
 
@@ -212,6 +212,11 @@ void CReactiveNavigationSystem::STEP3_WSpaceToTPSpace(const size_t ptg_idx,std::
 	const float *xs,*ys,*zs;
 	m_WS_Obstacles.getPointsBuffer(nObs,xs,ys,zs);
 
+	// Relative obstacle coordinates, passed all together to the PTG for faster, batched processing:
+	std::vector<float> rel_xs, rel_ys;
+	rel_xs.reserve(nObs);
+	rel_ys.reserve(nObs);
+
 	for (size_t obs=0;obs<nObs;obs++)
 	{
 		double ox,oy,oz=zs[obs];
@@ -221,12 +226,16 @@ void CReactiveNavigationSystem::STEP3_WSpaceToTPSpace(const size_t ptg_idx,std::
 			oy>-OBS_MAX_XY && oy<OBS_MAX_XY &&
 			oz>=params_reactive_nav.min_obstacles_height && oz<= params_reactive_nav.max_obstacles_height)
 		{
-			ptg->updateTPObstacle(ox, oy, out_TPObstacles);
+			rel_xs.push_back(static_cast<float>(ox));
+			rel_ys.push_back(static_cast<float>(oy));
 			if (eval_clearance) {
 				ptg->updateClearance(ox, oy, out_clearance);
 			}
 		}
 	}
+
+	if (!rel_xs.empty())
+		ptg->updateTPObstacles(&rel_xs[0], &rel_ys[0], rel_xs.size(), out_TPObstacles);
 }
 
 
@@ -257,21 +257,29 @@ void CReactiveNavigationSystem3D::STEP3_WSpaceToTPSpace(
 
 	const mrpt::poses::CPose2D rel_pose_PTG_origin_wrt_sense(rel_pose_PTG_origin_wrt_sense_);
 
+	// Relative obstacle coordinates, passed all together to the PTG of each level for faster, batched processing:
+	std::vector<float> rel_xs, rel_ys;
+
 	for (size_t j=0;j<m_robotShape.size();j++)
 	{
 		size_t nObs;
 		const float *xs,*ys,*zs;
 		m_WS_Obstacles_inlevels[j].getPointsBuffer(nObs,xs,ys,zs);
+		if (!nObs) continue;
 
+		rel_xs.resize(nObs);
+		rel_ys.resize(nObs);
 		for (size_t obs=0;obs<nObs;obs++)
 		{
 			double ox, oy;
 			rel_pose_PTG_origin_wrt_sense.composePoint(xs[obs], ys[obs], ox, oy);
-			m_ptgmultilevel[ptg_idx].PTGs[j]->updateTPObstacle(ox, oy, out_TPObstacles);
+			rel_xs[obs] = static_cast<float>(ox);
+			rel_ys[obs] = static_cast<float>(oy);
 			if (eval_clearance) {
 				m_ptgmultilevel[ptg_idx].PTGs[j]->updateClearance(ox, oy, out_clearance);
 			}
 		}
+		m_ptgmultilevel[ptg_idx].PTGs[j]->updateTPObstacles(&rel_xs[0], &rel_ys[0], nObs, out_TPObstacles);
 	}
 
 	// Distances in TP-Space are normalized to [0,1]
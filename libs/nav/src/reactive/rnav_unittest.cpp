@@ -26,7 +26,8 @@ void run_rnav_test(
 	const TPoint2D &world_topleft,
 	const TPoint2D &world_rightbottom,
 	const TPoint2D &block_obstacle_topleft = TPoint2D(0,0),
-	const TPoint2D &block_obstacle_rightbottom = TPoint2D(0,0)
+	const TPoint2D &block_obstacle_rightbottom = TPoint2D(0,0),
+	const unsigned int ptg_eval_num_threads = 1
 	)
 {
 	using namespace std;
@@ -43,6 +44,7 @@ void run_rnav_test(
 
 	mrpt::utils::CConfigFile cfg(sFil);
 	cfg.write("CAbstractPTGBasedReactive", "holonomic_method", sHoloMethod);
+	cfg.write("CAbstractPTGBasedReactive", "ptg_eval_num_threads", ptg_eval_num_threads);
 	cfg.discardSavingChanges();
 
 	// Create a grid map with a synthetic test environment with a simple obstacle:
@@ -195,3 +197,11 @@ TEST(CReactiveNavigationSystem3D, with_obstacle_nav_ND) {
 TEST(CReactiveNavigationSystem3D, with_obstacle_nav_FullEval) {
 	run_rnav_test<mrpt::nav::CReactiveNavigationSystem3D>("reactive3d_config.ini", "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br);
 }
+
+// Same, evaluating PTGs from several threads:
+TEST(CReactiveNavigationSystem, with_obstacle_nav_FullEval_threads) {
+	run_rnav_test<mrpt::nav::CReactiveNavigationSystem>("reactive2d_config.ini", "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br, 3);
+}
+TEST(CReactiveNavigationSystem3D, with_obstacle_nav_ND_threads) {
+	run_rnav_test<mrpt::nav::CReactiveNavigationSystem3D>("reactive3d_config.ini", "CHolonomicND", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br, 3);
+}
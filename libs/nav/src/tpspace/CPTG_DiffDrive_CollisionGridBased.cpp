@@ -17,6 +17,9 @@
 #include <mrpt/math/geometry.h>
 #include <mrpt/utils/stl_serialization.h>
 #include <mrpt/kinematics/CVehicleVelCmd_DiffDriven.h>
+#include <mrpt/system/threads.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace mrpt::nav;
 
@@ -87,26 +90,17 @@ mrpt::utils::CStream & mrpt::nav::operator >> (mrpt::utils::CStream& i, mrpt::na
 
 
 /*---------------------------------------------------------------
-					simulateTrajectories
-	Solve trajectories and fill cells.
+					simulateTrajectoriesBlock
+	Simulates the paths "k" in [first,last)
   ---------------------------------------------------------------*/
-void CPTG_DiffDrive_CollisionGridBased::simulateTrajectories(
-		float			max_time,
-		float			max_dist,
-		unsigned int	max_n,
-		float			diferencial_t,
-		float			min_dist,
-		float			*out_max_acc_v,
-		float			*out_max_acc_w)
+void CPTG_DiffDrive_CollisionGridBased::simulateTrajectoriesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
 {
 	using mrpt::math::square;
+	MRPT_UNUSED_PARAM(thread_idx);
 
-	internal_deinitialize(); // Free previous paths
-
-	m_stepTimeDuration = diferencial_t;
-
-	// Reserve the size in the buffers:
-	m_trajectory.resize( m_alphaValuesCount );
+	TSimulateTrajectoriesTask &task = *static_cast<TSimulateTrajectoriesTask*>(user_param);
+	const CPTG_DiffDrive_CollisionGridBased &ptg = *task.ptg;
+	const float diferencial_t = task.diferencial_t;
 
 	const float  radio_max_robot=1.0f; // Arbitrary "robot radius", only to determine the spacing of points under pure rotation
 
@@ -115,103 +109,153 @@ void CPTG_DiffDrive_CollisionGridBased::simulateTrajectories(
 
 	float          ult_dist, ult_dist1, ult_dist2;
 
-	// For the grid:
-	float		   x_min = 1e3f, x_max = -1e3;
-	float		   y_min = 1e3f, y_max = -1e3;
+	for (size_t k=first;k<last;k++)
+	{
+		// For the grid:
+		float		   x_min = 1e3f, x_max = -1e3;
+		float		   y_min = 1e3f, y_max = -1e3;
 
-	// Para averiguar las maximas ACELERACIONES lineales y angulares:
-	float			max_acc_lin, max_acc_ang;
+		// Para averiguar las maximas ACELERACIONES lineales y angulares:
+		float			max_acc_lin = 0, max_acc_ang = 0;
 
-	max_acc_lin = max_acc_ang = 0;
+		// Simulate / evaluate the trajectory selected by this "alpha":
+		// ------------------------------------------------------------
+		const float alpha = ptg.index2alpha( static_cast<uint16_t>(k) );
 
-	try
-	{
-		for (unsigned int k=0;k<m_alphaValuesCount;k++)
+		points.clear();
+		float t = .0f, dist = .0f, girado = .0f;
+		float x = .0f, y = .0f, phi = .0f, v = .0f, w = .0f, _x = .0f, _y = .0f, _phi = .0f;
+
+		// Sliding window with latest movement commands (for the optional low-pass filtering):
+		float  last_vs[2] = {.0f,.0f}, last_ws[2] = {.0f,.0f};
+
+		// Add the first, initial point:
+		points.push_back( TCPoint(	x,y,phi, t,dist, v,w ) );
+
+		// Simulate until...
+		while ( t < task.max_time && dist < task.max_dist && points.size() < task.max_n && fabs(girado) < 1.95 * M_PI )
 		{
-			// Simulate / evaluate the trajectory selected by this "alpha":
-			// ------------------------------------------------------------
-			const float alpha = index2alpha( k );
+			// Max. aceleraciones:
+			if (t>1)
+			{
+				float acc_lin = fabs( (last_vs[0]-last_vs[1])/diferencial_t);
+				float acc_ang = fabs( (last_ws[0]-last_ws[1])/diferencial_t);
+				mrpt::utils::keep_max(max_acc_lin, acc_lin);
+				mrpt::utils::keep_max(max_acc_ang, acc_ang);
+			}
 
-			points.clear();
-			float t = .0f, dist = .0f, girado = .0f;
-			float x = .0f, y = .0f, phi = .0f, v = .0f, w = .0f, _x = .0f, _y = .0f, _phi = .0f;
+			// Compute new movement command (v,w):
+			ptg.ptgDiffDriveSteeringFunction( alpha,t, x, y, phi, v,w );
 
-			// Sliding window with latest movement commands (for the optional low-pass filtering):
-			float  last_vs[2] = {.0f,.0f}, last_ws[2] = {.0f,.0f};
+			// History of v/w ----------------------------------
+			last_vs[1]=last_vs[0];
+			last_ws[1]=last_ws[0];
+			last_vs[0] = v;
+			last_ws[0] = w;
+			// -------------------------------------------
 
-			// Add the first, initial point:
-			points.push_back( TCPoint(	x,y,phi, t,dist, v,w ) );
+			// Finite difference equation:
+			x += cos(phi)* v * diferencial_t;
+			y += sin(phi)* v * diferencial_t;
+			phi+= w * diferencial_t;
 
-			// Simulate until...
-			while ( t < max_time && dist < max_dist && points.size() < max_n && fabs(girado) < 1.95 * M_PI )
-			{
-				// Max. aceleraciones:
-				if (t>1)
-				{
-					float acc_lin = fabs( (last_vs[0]-last_vs[1])/diferencial_t);
-					float acc_ang = fabs( (last_ws[0]-last_ws[1])/diferencial_t);
-					mrpt::utils::keep_max(max_acc_lin, acc_lin);
-					mrpt::utils::keep_max(max_acc_ang, acc_ang);
-				}
+			// Counters:
+			girado += w * diferencial_t;
 
-				// Compute new movement command (v,w):
-				ptgDiffDriveSteeringFunction( alpha,t, x, y, phi, v,w );
+			float v_inTPSpace = sqrt( square(v)+square(w*ptg.turningRadiusReference) );
 
-				// History of v/w ----------------------------------
-				last_vs[1]=last_vs[0];
-				last_ws[1]=last_ws[0];
-				last_vs[0] = v;
-				last_ws[0] = w;
-				// -------------------------------------------
+			dist += v_inTPSpace  * diferencial_t;
 
-				// Finite difference equation:
-				x += cos(phi)* v * diferencial_t;
-				y += sin(phi)* v * diferencial_t;
-				phi+= w * diferencial_t;
+			t += diferencial_t;
 
-				// Counters:
-				girado += w * diferencial_t;
+			// Save sample if we moved far enough:
+			ult_dist1 = sqrt( square( _x - x )+square( _y - y  ) );
+			ult_dist2 = fabs( radio_max_robot* ( _phi - phi ) );
+			ult_dist = std::max( ult_dist1, ult_dist2 );
 
-				float v_inTPSpace = sqrt( square(v)+square(w*turningRadiusReference) );
+			if (ult_dist > task.min_dist)
+			{
+				// Set the (v,w) to the last record:
+				points.back().v = v;
+				points.back().w = w;
 
-				dist += v_inTPSpace  * diferencial_t;
+				// And add the new record:
+				points.push_back( TCPoint(	x,y,phi,t,dist,v,w) );
 
-				t += diferencial_t;
+				// For the next iter:
+				_x = x;
+				_y = y;
+				_phi = phi;
+			}
 
-				// Save sample if we moved far enough:
-				ult_dist1 = sqrt( square( _x - x )+square( _y - y  ) );
-				ult_dist2 = fabs( radio_max_robot* ( _phi - phi ) );
-				ult_dist = std::max( ult_dist1, ult_dist2 );
+			// for the grid:
+			x_min = std::min(x_min,x); x_max = std::max(x_max,x);
+			y_min = std::min(y_min,y); y_max = std::max(y_max,y);
+		}
 
-				if (ult_dist > min_dist)
-				{
-					// Set the (v,w) to the last record:
-					points.back().v = v;
-					points.back().w = w;
+		// Add the final point:
+		points.back().v = v;
+		points.back().w = w;
+		points.push_back( TCPoint(	x,y,phi,t,dist,v,w) );
 
-					// And add the new record:
-					points.push_back( TCPoint(	x,y,phi,t,dist,v,w) );
+		// Save data to C-Space path structure:
+		(*task.trajectories)[k] = points;
 
-					// For the next iter:
-					_x = x;
-					_y = y;
-					_phi = phi;
-				}
+		task.x_min[k] = x_min; task.x_max[k] = x_max;
+		task.y_min[k] = y_min; task.y_max[k] = y_max;
+		task.max_acc_lin[k] = max_acc_lin;
+		task.max_acc_ang[k] = max_acc_ang;
+	} // end for "k"
+}
 
-				// for the grid:
-				x_min = std::min(x_min,x); x_max = std::max(x_max,x);
-				y_min = std::min(y_min,y); y_max = std::max(y_max,y);
-			}
+/*---------------------------------------------------------------
+					simulateTrajectories
+	Solve trajectories and fill cells.
+  ---------------------------------------------------------------*/
+void CPTG_DiffDrive_CollisionGridBased::simulateTrajectories(
+		float			max_time,
+		float			max_dist,
+		unsigned int	max_n,
+		float			diferencial_t,
+		float			min_dist,
+		float			*out_max_acc_v,
+		float			*out_max_acc_w)
+{
+	internal_deinitialize(); // Free previous paths
 
-			// Add the final point:
-			points.back().v = v;
-			points.back().w = w;
-			points.push_back( TCPoint(	x,y,phi,t,dist,v,w) );
+	m_stepTimeDuration = diferencial_t;
 
-			// Save data to C-Space path structure:
-			m_trajectory[k] = points;
+	// Reserve the size in the buffers:
+	m_trajectory.resize( m_alphaValuesCount );
 
-		} // end for "k"
+	try
+	{
+		// Each path only depends on its "alpha": simulate them in parallel
+		TSimulateTrajectoriesTask task;
+		task.ptg = this;
+		task.max_time = max_time;
+		task.max_dist = max_dist;
+		task.max_n = max_n;
+		task.diferencial_t = diferencial_t;
+		task.min_dist = min_dist;
+		task.trajectories = &m_trajectory;
+		task.x_min.resize(m_alphaValuesCount); task.x_max.resize(m_alphaValuesCount);
+		task.y_min.resize(m_alphaValuesCount); task.y_max.resize(m_alphaValuesCount);
+		task.max_acc_lin.resize(m_alphaValuesCount); task.max_acc_ang.resize(m_alphaValuesCount);
+
+		mrpt::system::parallelForBlocks(m_alphaValuesCount, &simulateTrajectoriesBlock, &task);
+
+		// For the grid:
+		float		   x_min = 1e3f, x_max = -1e3;
+		float		   y_min = 1e3f, y_max = -1e3;
+		float			max_acc_lin = 0, max_acc_ang = 0;
+		for (unsigned int k=0;k<m_alphaValuesCount;k++)
+		{
+			x_min = std::min(x_min,task.x_min[k]); x_max = std::max(x_max,task.x_max[k]);
+			y_min = std::min(y_min,task.y_min[k]); y_max = std::max(y_max,task.y_max[k]);
+			mrpt::utils::keep_max(max_acc_lin, task.max_acc_lin[k]);
+			mrpt::utils::keep_max(max_acc_ang, task.max_acc_ang[k]);
+		}
 
 		// Save accelerations
 		if (out_max_acc_v) *out_max_acc_v = max_acc_lin;
@@ -349,6 +393,36 @@ bool CPTG_DiffDrive_CollisionGridBased::loadColGridsFromFile( const std::string
 
 const uint32_t COLGRID_FILE_MAGIC     = 0xC0C0C0C3;
 
+namespace
+{
+	// Helpers for the compact encoding of the collision grid (file format v3):
+	// unsigned integers are stored as LEB128-like variable-length sequences of bytes (7 bits each).
+	void writeVarUInt(std::vector<uint8_t> &buf, uint32_t v)
+	{
+		while (v>=0x80)
+		{
+			buf.push_back(static_cast<uint8_t>(v | 0x80));
+			v>>=7;
+		}
+		buf.push_back(static_cast<uint8_t>(v));
+	}
+	bool readVarUInt(const uint8_t *&p, const uint8_t *end, uint32_t &v)
+	{
+		v = 0;
+		for (unsigned int shift=0;shift<32;shift+=7)
+		{
+			if (p==end) return false;
+			const uint8_t b = *p++;
+			v |= static_cast<uint32_t>(b & 0x7F) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false; // Corrupted data
+	}
+	// Signed integers are zig-zag mapped to unsigned ones first:
+	inline uint32_t zigzagEncode(int32_t v) { return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31); }
+	inline int32_t  zigzagDecode(uint32_t v) { return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1); }
+}
+
 /*---------------------------------------------------------------
 					Save to file
   ---------------------------------------------------------------*/
@@ -358,7 +432,7 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile( mrpt::utils:
 	{
 		if (!f) return false;
 
-		const uint8_t serialize_version = 2; // v1: As of jun 2012, v2: As of dec-2013
+		const uint8_t serialize_version = 3; // v1: As of jun 2012, v2: As of dec-2013, v3: As of 2017 (compact cells)
 
 		// Save magic signature && serialization version:
 		*f << COLGRID_FILE_MAGIC << serialize_version;
@@ -372,20 +446,70 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile( mrpt::utils:
 			<< static_cast<float>(m_parent->getMax_V())
 			<< static_cast<float>(m_parent->getMax_W());
 
+		// v3: other parameters which affect the simulated paths:
+		uint32_t nTotalSteps = 0;
+		for (size_t k=0;k<m_parent->m_trajectory.size();k++)
+			nTotalSteps += static_cast<uint32_t>(m_parent->m_trajectory[k].size());
+		*f << static_cast<float>(m_parent->turningRadiusReference) << nTotalSteps;
+
 		*f << m_x_min << m_x_max << m_y_min << m_y_max;
 		*f << m_resolution;
 
 		//v1 was:  *f << m_map;
-		uint32_t N = m_map.size();
-		*f << N;
+		//v2 was: for each cell, its size and all its (k,d) pairs.
+		// v3: a single block of bytes with, for each non-empty cell only: the increment of its index, its size, and
+		//     its (k,d) pairs, with "k" as increments wrt the former "k" and "d" as the index of the path step with that
+		//     distance (all of them as variable-length integers). "d" is only stored as a float if it is not found in the path.
+		std::vector<uint8_t> buf;
+		uint32_t nNonEmptyCells = 0, next_cell_idx = 0;
+		const uint32_t N = static_cast<uint32_t>(m_map.size());
 		for (uint32_t i=0;i<N;i++)
 		{
-			uint32_t M = m_map[i].size();
-			*f << M;
-			for (uint32_t k=0;k<M;k++)
-				*f << m_map[i][k].first << m_map[i][k].second;
+			const TCollisionCell &cell = m_map[i];
+			if (cell.empty()) continue;
+
+			nNonEmptyCells++;
+			writeVarUInt(buf, i-next_cell_idx);
+			next_cell_idx = i+1;
+
+			writeVarUInt(buf, static_cast<uint32_t>(cell.size()));
+			int32_t last_k = 0;
+			for (TCollisionCell::const_iterator it=cell.begin();it!=cell.end();++it)
+			{
+				const uint16_t k = it->first;
+				writeVarUInt(buf, zigzagEncode(int32_t(k)-last_k));
+				last_k = k;
+
+				// Find the path step with this distance:
+				uint32_t step_plus_one = 0; // 0 means "not found"
+				if (k<m_parent->m_trajectory.size())
+				{
+					const TCPointVector &traj = m_parent->m_trajectory[k];
+					size_t lo=0, hi=traj.size(); // Binary search: "dist" never decreases along a path
+					while (lo<hi)
+					{
+						const size_t mid = (lo+hi)/2;
+						if (traj[mid].dist<it->second) lo=mid+1;
+						else hi=mid;
+					}
+					if (lo<traj.size() && traj[lo].dist==it->second)
+						step_plus_one = static_cast<uint32_t>(lo+1);
+				}
+				writeVarUInt(buf, step_plus_one);
+				if (!step_plus_one)
+				{
+					uint32_t d_bits;
+					std::memcpy(&d_bits, &it->second, sizeof(d_bits));
+					for (int b=0;b<4;b++)
+						buf.push_back(static_cast<uint8_t>(d_bits >> (8*b)));
+				}
+			}
 		}
 
+		*f << N << nNonEmptyCells << static_cast<uint32_t>(buf.size());
+		if (!buf.empty())
+			f->WriteBuffer(&buf[0], buf.size());
+
 		return true;
 	}
 	catch(...)
@@ -417,6 +541,7 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile( mrpt::util
 		switch (serialized_version)
 		{
 		case 2:
+		case 3:
 			{
 				mrpt::math::CPolygon stored_shape;
 				*f >> stored_shape;
@@ -443,6 +568,7 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile( mrpt::util
 
 		// and standard PTG data:
 #define READ_UINT16_CHECK_IT_MATCHES_STORED(_VAR) { uint16_t ff; *f >> ff; if (ff!=_VAR) return false; }
+#define READ_UINT32_CHECK_IT_MATCHES_STORED(_VAR) { uint32_t ff; *f >> ff; if (ff!=_VAR) return false; }
 #define READ_FLOAT_CHECK_IT_MATCHES_STORED(_VAR) { float ff; *f >> ff; if (std::abs(ff-_VAR)>1e-4f) return false; }
 #define READ_DOUBLE_CHECK_IT_MATCHES_STORED(_VAR) { double ff; *f >> ff; if (std::abs(ff-_VAR)>1e-6) return false; }
 
@@ -450,6 +576,15 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile( mrpt::util
 		READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_V())
 		READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_W())
 
+		uint32_t nTotalSteps = 0;
+		for (size_t k=0;k<m_parent->m_trajectory.size();k++)
+			nTotalSteps += static_cast<uint32_t>(m_parent->m_trajectory[k].size());
+		if (serialized_version>=3)
+		{
+			READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->turningRadiusReference)
+			READ_UINT32_CHECK_IT_MATCHES_STORED(nTotalSteps)
+		}
+
 		// Cell dimensions:
 		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_min)
 		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_max)
@@ -458,19 +593,75 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile( mrpt::util
 		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_resolution)
 
 		// OK, all parameters seem to be exactly the same than when we precomputed the table: load it.
-		//v1 was:  *f >> m_map;
-		uint32_t N;
-		*f >> N;
-		 m_map.resize(N);
-		for (uint32_t i=0;i<N;i++)
+		// The cells are decoded into a temporary vector, so the grid is left untouched if the data turns out to be corrupted:
+		std::vector<TCollisionCell> cells;
+		if (serialized_version==2)
 		{
-			uint32_t M;
-			*f >> M;
-			 m_map[i].resize(M);
-			for (uint32_t k=0;k<M;k++)
-				*f >> m_map[i][k].first >> m_map[i][k].second;
+			//v1 was:  *f >> m_map;
+			uint32_t N;
+			*f >> N;
+			cells.resize(N);
+			for (uint32_t i=0;i<N;i++)
+			{
+				uint32_t M;
+				*f >> M;
+				cells[i].resize(M);
+				for (uint32_t k=0;k<M;k++)
+					*f >> cells[i][k].first >> cells[i][k].second;
+			}
+			m_map.swap(cells);
+			return true;
 		}
 
+		// v3: Read the whole block of cells at once, then decode it from memory:
+		uint32_t N, nNonEmptyCells, nBytes;
+		*f >> N >> nNonEmptyCells >> nBytes;
+		if (N!=m_map.size()) return false;
+		cells.resize(N);
+
+		std::vector<uint8_t> buf(nBytes);
+		if (nBytes && f->ReadBuffer(&buf[0], nBytes)!=nBytes)
+			return false;
+
+		const uint8_t *p = buf.empty() ? NULL : &buf[0];
+		const uint8_t *end = p+buf.size();
+		uint32_t next_cell_idx = 0;
+		for (uint32_t c=0;c<nNonEmptyCells;c++)
+		{
+			uint32_t idx_incr, M;
+			if (!readVarUInt(p,end,idx_incr) || !readVarUInt(p,end,M)) return false;
+			const uint32_t i = next_cell_idx+idx_incr;
+			if (i>=N || M>m_parent->getAlphaValuesCount()) return false;
+			next_cell_idx = i+1;
+
+			TCollisionCell &cell = cells[i];
+			cell.resize(M);
+			int32_t k = 0;
+			for (uint32_t j=0;j<M;j++)
+			{
+				uint32_t k_incr, step_plus_one;
+				if (!readVarUInt(p,end,k_incr) || !readVarUInt(p,end,step_plus_one)) return false;
+				k += zigzagDecode(k_incr);
+				if (k<0 || k>=static_cast<int32_t>(m_parent->m_trajectory.size())) return false;
+				cell[j].first = static_cast<uint16_t>(k);
+
+				if (step_plus_one)
+				{
+					if (step_plus_one>m_parent->m_trajectory[k].size()) return false;
+					cell[j].second = m_parent->m_trajectory[k][step_plus_one-1].dist;
+				}
+				else
+				{
+					if (end-p<4) return false;
+					uint32_t d_bits = 0;
+					for (int b=0;b<4;b++)
+						d_bits |= static_cast<uint32_t>(*p++) << (8*b);
+					std::memcpy(&cell[j].second, &d_bits, sizeof(d_bits));
+				}
+			}
+		}
+		if (p!=end) return false;
+		m_map.swap(cells);
 		return true;
 	}
 	catch(std::exception &e)
@@ -664,84 +855,130 @@ void CPTG_DiffDrive_CollisionGridBased::internal_initialize(const std::string &
 	else
 	{
 		// BUGFIX: In case we start reading the file and in the end detected an error,
-		//         we must make sure that there's space enough for the grid:
+		//         we must make sure that there's space enough for the grid, and that it's empty:
 		m_collisionGrid.setSize( -refDistance,refDistance,-refDistance,refDistance,m_collisionGrid.getResolution());
-
-		const int grid_cx_max = m_collisionGrid.getSizeX()-1;
-		const int grid_cy_max = m_collisionGrid.getSizeY()-1;
-		const double half_cell = m_collisionGrid.getResolution()*0.5;
-
-		const size_t nVerts = m_robotShape.verticesCount();
-		std::vector<mrpt::math::TPoint2D> transf_shape(nVerts); // The robot shape at each location
+		m_collisionGrid.clear();
 
 		// RECOMPUTE THE COLLISION GRIDS:
 		// ---------------------------------------
+		// The cells swept by each path are found in parallel, then inserted into the grid in increasing "k" order,
+		// so the contents of each cell do not depend on the number of threads:
+		std::vector<TSweptCells> swept_cells(Ki);
+		TBuildCollisionGridTask task;
+		task.ptg = this;
+		task.swept_cells = &swept_cells;
+		mrpt::system::parallelForBlocks(Ki, &buildCollisionGridBlock, &task);
+
+		const unsigned int grid_size_x = static_cast<unsigned int>(m_collisionGrid.getSizeX());
 		for (size_t k=0;k<Ki;k++)
 		{
-			const size_t nPoints = getPathStepCount(k);
-			ASSERT_(nPoints>1)
+			for (TSweptCells::const_iterator it=swept_cells[k].begin();it!=swept_cells[k].end();++it)
+				m_collisionGrid.updateCellInfo(it->first % grid_size_x, it->first / grid_size_x, static_cast<uint16_t>(k), it->second);
+			TSweptCells().swap(swept_cells[k]); // Free memory
+		}
 
-			for (size_t n=0;n<(nPoints-1);n++)
-			{
-				// Translate and rotate the robot shape at this C-Space pose:
-				mrpt::math::TPose2D p;
-				getPathPose(k, n, p);
+		if (verbose)
+			cout << format("Done! [%.03f sec]\n",tictac.Tac() );
 
-				mrpt::math::TPoint2D bb_min(std::numeric_limits<double>::max(),std::numeric_limits<double>::max());
-				mrpt::math::TPoint2D bb_max(-std::numeric_limits<double>::max(),-std::numeric_limits<double>::max());
+		// save it to the cache file for the next run:
+		saveColGridsToFile( cacheFilename, m_robotShape );
 
-				for (size_t m = 0;m<nVerts;m++)
-				{
-					transf_shape[m].x = p.x + cos(p.phi)*m_robotShape.GetVertex_x(m)-sin(p.phi)*m_robotShape.GetVertex_y(m);
-					transf_shape[m].y = p.y + sin(p.phi)*m_robotShape.GetVertex_x(m)+cos(p.phi)*m_robotShape.GetVertex_y(m);
-					mrpt::utils::keep_max( bb_max.x, transf_shape[m].x); mrpt::utils::keep_max( bb_max.y, transf_shape[m].y);
-					mrpt::utils::keep_min( bb_min.x, transf_shape[m].x); mrpt::utils::keep_min( bb_min.y, transf_shape[m].y);
-				}
+	}	// "else" recompute all PTG
 
-				// Robot shape polygon:
-				const mrpt::math::TPolygon2D poly(transf_shape);
+	MRPT_END
+}
 
-				// Get the range of cells that may collide with this shape:
-				const int ix_min = std::max(0,m_collisionGrid.x2idx(bb_min.x)-1);
-				const int iy_min = std::max(0,m_collisionGrid.y2idx(bb_min.y)-1);
-				const int ix_max = std::min(m_collisionGrid.x2idx(bb_max.x)+1,grid_cx_max);
-				const int iy_max = std::min(m_collisionGrid.y2idx(bb_max.y)+1,grid_cy_max);
+void CPTG_DiffDrive_CollisionGridBased::buildCollisionGridBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+{
+	MRPT_UNUSED_PARAM(thread_idx);
+	TBuildCollisionGridTask &task = *static_cast<TBuildCollisionGridTask*>(user_param);
+	const CPTG_DiffDrive_CollisionGridBased &ptg = *task.ptg;
+	const CCollisionGrid &grid = ptg.m_collisionGrid;
+	const mrpt::math::CPolygon &robotShape = ptg.m_robotShape;
 
-				for (int ix=ix_min;ix<ix_max;ix++)
-				{
-					const double cx = m_collisionGrid.idx2x(ix) - half_cell;
+	const int grid_cx_max = grid.getSizeX()-1;
+	const int grid_cy_max = grid.getSizeY()-1;
+	const int grid_size_x = grid.getSizeX();
+	const double half_cell = grid.getResolution()*0.5;
 
-					for (int iy=iy_min;iy<iy_max;iy++)
-					{
-						const double cy = m_collisionGrid.idx2y(iy) - half_cell;
+	const size_t nVerts = robotShape.verticesCount();
+	std::vector<mrpt::math::TPoint2D> transf_shape(nVerts); // The robot shape at each location
 
-						if ( poly.contains( mrpt::math::TPoint2D(cx,cy) ) )
-						{
-							// Collision!! Update cell info:
-							const float d = this->getPathDist(k, n);
-							m_collisionGrid.updateCellInfo(ix  ,iy  ,  k,d);
-							m_collisionGrid.updateCellInfo(ix-1,iy  ,  k,d);
-							m_collisionGrid.updateCellInfo(ix  ,iy-1,  k,d);
-							m_collisionGrid.updateCellInfo(ix-1,iy-1,  k,d);
-						}
-					}	// for iy
-				}	// for ix
+	// Minimum distance for each cell swept by the current path, and the list of such cells:
+	std::vector<float> cell_min_dist(grid.getSizeX()*grid.getSizeY(), std::numeric_limits<float>::max());
+	std::vector<uint32_t> swept_idxs;
 
-			} // n
+	for (size_t k=first;k<last;k++)
+	{
+		const size_t nPoints = ptg.getPathStepCount(k);
+		ASSERT_(nPoints>1)
 
-			if (verbose)
-				cout << k << "/" << Ki << ",";
-		} // k
+		for (size_t n=0;n<(nPoints-1);n++)
+		{
+			// Translate and rotate the robot shape at this C-Space pose:
+			mrpt::math::TPose2D p;
+			ptg.getPathPose(k, n, p);
 
-		if (verbose)
-			cout << format("Done! [%.03f sec]\n",tictac.Tac() );
+			mrpt::math::TPoint2D bb_min(std::numeric_limits<double>::max(),std::numeric_limits<double>::max());
+			mrpt::math::TPoint2D bb_max(-std::numeric_limits<double>::max(),-std::numeric_limits<double>::max());
 
-		// save it to the cache file for the next run:
-		saveColGridsToFile( cacheFilename, m_robotShape );
+			for (size_t m = 0;m<nVerts;m++)
+			{
+				transf_shape[m].x = p.x + cos(p.phi)*robotShape.GetVertex_x(m)-sin(p.phi)*robotShape.GetVertex_y(m);
+				transf_shape[m].y = p.y + sin(p.phi)*robotShape.GetVertex_x(m)+cos(p.phi)*robotShape.GetVertex_y(m);
+				mrpt::utils::keep_max( bb_max.x, transf_shape[m].x); mrpt::utils::keep_max( bb_max.y, transf_shape[m].y);
+				mrpt::utils::keep_min( bb_min.x, transf_shape[m].x); mrpt::utils::keep_min( bb_min.y, transf_shape[m].y);
+			}
 
-	}	// "else" recompute all PTG
+			// Robot shape polygon:
+			const mrpt::math::TPolygon2D poly(transf_shape);
 
-	MRPT_END
+			// Get the range of cells that may collide with this shape:
+			const int ix_min = std::max(0,grid.x2idx(bb_min.x)-1);
+			const int iy_min = std::max(0,grid.y2idx(bb_min.y)-1);
+			const int ix_max = std::min(grid.x2idx(bb_max.x)+1,grid_cx_max);
+			const int iy_max = std::min(grid.y2idx(bb_max.y)+1,grid_cy_max);
+
+			for (int ix=ix_min;ix<ix_max;ix++)
+			{
+				const double cx = grid.idx2x(ix) - half_cell;
+
+				for (int iy=iy_min;iy<iy_max;iy++)
+				{
+					const double cy = grid.idx2y(iy) - half_cell;
+
+					if ( poly.contains( mrpt::math::TPoint2D(cx,cy) ) )
+					{
+						// Collision!! Update cell info for the 4 cells sharing the corner (cx,cy):
+						const float d = ptg.getPathDist(k, n);
+						for (int dx=0;dx<2;dx++)
+						{
+							for (int dy=0;dy<2;dy++)
+							{
+								if (ix-dx<0 || iy-dy<0) continue;
+								const uint32_t idx = (ix-dx) + (iy-dy)*grid_size_x;
+								float &min_d = cell_min_dist[idx];
+								if (min_d==std::numeric_limits<float>::max())
+									swept_idxs.push_back(idx);
+								mrpt::utils::keep_min(min_d, d);
+							}
+						}
+					}
+				}	// for iy
+			}	// for ix
+		} // n
+
+		// Save results for this path and reset the scratch buffer:
+		TSweptCells &out = (*task.swept_cells)[k];
+		out.resize(swept_idxs.size());
+		for (size_t i=0;i<swept_idxs.size();i++)
+		{
+			out[i].first = swept_idxs[i];
+			out[i].second = cell_min_dist[swept_idxs[i]];
+			cell_min_dist[swept_idxs[i]] = std::numeric_limits<float>::max();
+		}
+		swept_idxs.clear();
+	} // k
 }
 
 size_t CPTG_DiffDrive_CollisionGridBased::getPathStepCount(uint16_t k) const
@@ -802,6 +1039,76 @@ void CPTG_DiffDrive_CollisionGridBased::updateTPObstacle(
 	}
 }
 
+void CPTG_DiffDrive_CollisionGridBased::updateTPObstacles(
+	const float *xs, const float *ys, const size_t N,
+	std::vector<double> &tp_obstacles,
+	const unsigned int num_threads) const
+{
+	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
+
+	// 1) Bin obstacles by cell: only cells with some (k,d) pair are kept, and the point-inside-robot test
+	//    is done once per point (instead of once per (k,d) pair) since it is the only dependency on the exact point coordinates.
+	const int size_x = static_cast<int>(m_collisionGrid.getSizeX()), size_y = static_cast<int>(m_collisionGrid.getSizeY());
+	ASSERT_(uint64_t(size_x)*uint64_t(size_y) < (uint64_t(1)<<31));
+
+	std::vector<uint32_t> cell_keys;
+	cell_keys.reserve(N);
+	for (size_t i=0;i<N;i++)
+	{
+		const int cx = m_collisionGrid.x2idx(xs[i]), cy = m_collisionGrid.y2idx(ys[i]);
+		if (cx<0 || cx>=size_x || cy<0 || cy>=size_y) continue;
+		if (m_collisionGrid.cellByIndex(cx,cy)->empty()) continue;
+		const bool is_inside = isPointInsideRobotShape(xs[i],ys[i]);
+		cell_keys.push_back( (static_cast<uint32_t>(cx + cy*size_x) << 1) | (is_inside ? 1:0) );
+	}
+	// Points in the same cell, and on the same side of the robot shape, have exactly the same effect on tp_obstacles: keep one of them.
+	std::sort(cell_keys.begin(), cell_keys.end());
+	cell_keys.erase(std::unique(cell_keys.begin(), cell_keys.end()), cell_keys.end());
+
+	// 2) Update tp_obstacles, visiting the cells in memory order:
+	TUpdateTPObstaclesTask task;
+	task.grid = &m_collisionGrid;
+	task.ptg = this;
+	task.cell_keys = &cell_keys;
+	task.tp_obstacles = &tp_obstacles;
+
+	if (num_threads==1)
+		updateTPObstaclesBlock(0, m_alphaValuesCount, 0, &task);
+	else
+		mrpt::system::parallelForBlocks(m_alphaValuesCount, &updateTPObstaclesBlock, &task, num_threads);
+}
+
+void CPTG_DiffDrive_CollisionGridBased::updateTPObstaclesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+{
+	MRPT_UNUSED_PARAM(thread_idx);
+	const TUpdateTPObstaclesTask &task = *static_cast<TUpdateTPObstaclesTask*>(user_param);
+	const std::vector<uint32_t> &cell_keys = *task.cell_keys;
+	std::vector<double> &tp_obstacles = *task.tp_obstacles;
+	const unsigned int size_x = static_cast<unsigned int>(task.grid->getSizeX());
+	const bool all_k = (first==0 && last==tp_obstacles.size());
+
+	for (size_t i=0;i<cell_keys.size();i++)
+	{
+		const uint32_t cell_idx = cell_keys[i] >> 1;
+		const bool is_inside = (cell_keys[i] & 1)!=0;
+		const TCollisionCell & cell = *task.grid->cellByIndex(cell_idx % size_x, cell_idx / size_x);
+
+		if (!is_inside)
+		{
+			// Most common case: keep the minimum distance
+			for (TCollisionCell::const_iterator it = cell.begin(); it != cell.end(); ++it)
+				if (all_k || (it->first>=first && it->first<last))
+					mrpt::utils::keep_min(tp_obstacles[it->first], static_cast<double>(it->second));
+		}
+		else
+		{
+			for (TCollisionCell::const_iterator it = cell.begin(); it != cell.end(); ++it)
+				if (all_k || (it->first>=first && it->first<last))
+					task.ptg->internal_TPObsDistancePostprocess(true, it->second, tp_obstacles[it->first]);
+		}
+	}
+}
+
 void CPTG_DiffDrive_CollisionGridBased::updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const
 {
 	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
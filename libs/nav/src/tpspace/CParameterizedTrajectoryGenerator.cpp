@@ -13,6 +13,7 @@
 #include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>
+#include <mrpt/system/threads.h>
 #include <mrpt/opengl/CSetOfLines.h>
 
 using namespace mrpt::nav;
@@ -335,7 +336,11 @@ void CParameterizedTrajectoryGenerator::deinitialize()
 
 void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(const double ox, const double oy, const double new_tp_obs_dist, double &inout_tp_obs) const
 {
-	const bool is_obs_inside_robot_shape = isPointInsideRobotShape(ox,oy);
+	internal_TPObsDistancePostprocess(isPointInsideRobotShape(ox,oy), new_tp_obs_dist, inout_tp_obs);
+}
+
+void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(const bool is_obs_inside_robot_shape, const double new_tp_obs_dist, double &inout_tp_obs) const
+{
 	if (!is_obs_inside_robot_shape)
 	{
 		mrpt::utils::keep_min(inout_tp_obs, new_tp_obs_dist);
@@ -370,6 +375,48 @@ void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(const
 	}
 }
 
+namespace
+{
+	struct TUpdateTPObstaclesSingleTask
+	{
+		const CParameterizedTrajectoryGenerator *ptg;
+		const float *xs, *ys;
+		size_t N;
+		std::vector<double> *tp_obstacles;
+	};
+
+	// Each block of PTG directions [first,last) is only written by one thread:
+	void updateTPObstaclesSingleBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TUpdateTPObstaclesSingleTask &task = *static_cast<TUpdateTPObstaclesSingleTask*>(user_param);
+		for (size_t k=first;k<last;k++)
+		{
+			double &tp_obs_k = (*task.tp_obstacles)[k];
+			for (size_t i=0;i<task.N;i++)
+				task.ptg->updateTPObstacleSingle(task.xs[i], task.ys[i], static_cast<uint16_t>(k), tp_obs_k);
+		}
+	}
+}
+
+void CParameterizedTrajectoryGenerator::updateTPObstacles(const float *xs, const float *ys, const size_t N, std::vector<double> &tp_obstacles, const unsigned int num_threads) const
+{
+	if (num_threads==1)
+	{
+		for (size_t i=0;i<N;i++)
+			updateTPObstacle(xs[i], ys[i], tp_obstacles);
+		return;
+	}
+
+	TUpdateTPObstaclesSingleTask task;
+	task.ptg = this;
+	task.xs = xs;
+	task.ys = ys;
+	task.N = N;
+	task.tp_obstacles = &tp_obstacles;
+	mrpt::system::parallelForBlocks(m_alphaValuesCount, &updateTPObstaclesSingleBlock, &task, num_threads);
+}
+
 void mrpt::nav::CParameterizedTrajectoryGenerator::initClearanceDiagram(ClearanceDiagram & cd) const
 {
 	cd.resize(m_alphaValuesCount, m_clearance_decimated_paths);
@@ -8,8 +8,12 @@
    +---------------------------------------------------------------------------+ */
 
 #include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
+#include <mrpt/nav/tpspace/CPTG_DiffDrive_C.h>
 #include <mrpt/utils/CConfigFile.h>
+#include <mrpt/utils/CConfigFileMemory.h>
+#include <mrpt/utils/CFileGZOutputStream.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/compress/zip.h>
 #include <gtest/gtest.h>
 
 // Defined in tests/test_main.cpp
@@ -150,6 +154,41 @@ TEST(NavTests, PTGs_tests)
 			EXPECT_TRUE(any_change_all);
 		}
 
+		// TEST: batched TP_obstacles == one-by-one TP_obstacles
+		{
+			// Points both outside and inside the robot shape, with many of them sharing the same cell:
+			std::vector<float> xs, ys;
+			for (double ox=-refDist*0.5;ox<refDist*0.5;ox+=0.0371)
+				for (double oy=-refDist*0.5;oy<refDist*0.5;oy+=0.0529)
+				{
+					xs.push_back(static_cast<float>(ox));
+					ys.push_back(static_cast<float>(oy));
+				}
+
+			const PTG_collision_behavior_t org_behavior = CParameterizedTrajectoryGenerator::COLLISION_BEHAVIOR;
+			const PTG_collision_behavior_t behaviors[2] = { COLL_BEH_BACK_AWAY, COLL_BEH_STOP };
+			for (int b=0;b<2;b++)
+			{
+				CParameterizedTrajectoryGenerator::COLLISION_BEHAVIOR = behaviors[b];
+
+				std::vector<double> TP_obstacles_1by1;
+				ptg->initTPObstacles(TP_obstacles_1by1);
+				for (size_t i=0;i<xs.size();i++)
+					ptg->updateTPObstacle(xs[i],ys[i], TP_obstacles_1by1);
+
+				for (unsigned int nThreads=1;nThreads<=3;nThreads+=2)
+				{
+					std::vector<double> TP_obstacles_batch;
+					ptg->initTPObstacles(TP_obstacles_batch);
+					ptg->updateTPObstacles(&xs[0],&ys[0],xs.size(), TP_obstacles_batch, nThreads);
+
+					EXPECT_TRUE(TP_obstacles_1by1==TP_obstacles_batch) << "Test: batched TP_obstacles\n PTG: " << sPTGDesc << endl << "nThreads: " << nThreads << endl;
+					num_tests_run++;
+				}
+			}
+			CParameterizedTrajectoryGenerator::COLLISION_BEHAVIOR = org_behavior;
+		}
+
 
 		printf("PTG `%50s` run %6u tests.\n", sPTGDesc.c_str(), (unsigned int)num_tests_run );
 
@@ -162,3 +201,182 @@ TEST(NavTests, PTGs_tests)
 
 }
 
+
+// Collision grids loaded from a cache file must be identical to those computed from scratch:
+TEST(NavTests, PTGs_cache_file)
+{
+	using namespace std;
+	using namespace mrpt;
+	using namespace mrpt::nav;
+
+	const string sFil = mrpt::utils::MRPT_GLOBAL_UNITTEST_SRC_DIR + string("/tests/PTGs_for_tests.ini");
+	if (!mrpt::system::fileExists(sFil))
+	{
+		cerr << "**WARNING* Skipping tests since file cannot be found: '" << sFil << "'\n";
+		return;
+	}
+
+	mrpt::utils::CConfigFile cfg(sFil);
+	const unsigned int PTG_COUNT = cfg.read_int("PTG_UNIT_TESTS","PTG_COUNT",0, true );
+
+	for ( unsigned int n=0;n<PTG_COUNT;n++)
+	{
+		const string sPTGName = cfg.read_string("PTG_UNIT_TESTS",format("PTG%u_Type", n ),"", true );
+		const string sCacheFile = mrpt::system::getTempFileName();
+
+		// 1st: computed (and saved to the cache file), 2nd: loaded from the cache file.
+		CParameterizedTrajectoryGenerator *ptgs[2];
+		for (int i=0;i<2;i++)
+		{
+			ptgs[i] = CParameterizedTrajectoryGenerator::CreatePTG(sPTGName,cfg,"PTG_UNIT_TESTS", format("PTG%u_",n) );
+			ASSERT_TRUE(ptgs[i]!=NULL) << "Failed creating PTG #" << n << endl;
+			ptgs[i]->initialize( sCacheFile, false /*verbose */ );
+		}
+
+		const double refDist = ptgs[0]->getRefDistance();
+		bool all_equal = true;
+		for (double ox=-refDist;all_equal && ox<refDist;ox+=0.0713)
+			for (double oy=-refDist;all_equal && oy<refDist;oy+=0.0713)
+			{
+				std::vector<double> TP_obstacles[2];
+				for (int i=0;i<2;i++)
+				{
+					ptgs[i]->initTPObstacles(TP_obstacles[i]);
+					ptgs[i]->updateTPObstacle(ox,oy, TP_obstacles[i]);
+				}
+				all_equal = (TP_obstacles[0]==TP_obstacles[1]);
+				EXPECT_TRUE(all_equal) << "PTG: " << ptgs[0]->getDescription() << endl << "(ox,oy): " << ox << " " << oy << endl;
+			}
+
+		for (int i=0;i<2;i++)
+			delete ptgs[i];
+		mrpt::system::deleteFile(sCacheFile);
+	}
+}
+
+namespace
+{
+	// Gives access to the collision grid and its cache file load/save methods:
+	class CPTG_DiffDrive_C_CacheTest : public mrpt::nav::CPTG_DiffDrive_C
+	{
+	public:
+		CPTG_DiffDrive_C_CacheTest(const mrpt::utils::CConfigFileBase &cfg,const std::string &sSection) : mrpt::nav::CPTG_DiffDrive_C(cfg,sSection) { }
+
+		using mrpt::nav::CPTG_DiffDrive_CollisionGridBased::saveColGridsToFile;
+		using mrpt::nav::CPTG_DiffDrive_CollisionGridBased::loadColGridsFromFile;
+		using mrpt::nav::CPTG_DiffDrive_CollisionGridBased::TCollisionCell;
+
+		std::vector<TCollisionCell> getAllCells() const
+		{
+			std::vector<TCollisionCell> cells;
+			for (unsigned int cy=0;cy<m_collisionGrid.getSizeY();cy++)
+				for (unsigned int cx=0;cx<m_collisionGrid.getSizeX();cx++)
+					cells.push_back(*m_collisionGrid.cellByIndex(cx,cy));
+			return cells;
+		}
+		void clearAllCells()
+		{
+			for (unsigned int cy=0;cy<m_collisionGrid.getSizeY();cy++)
+				for (unsigned int cx=0;cx<m_collisionGrid.getSizeX();cx++)
+					m_collisionGrid.cellByIndex(cx,cy)->clear();
+		}
+		// Writes the collision grid in the former (v2) cache file format, with all the (k,d) pairs of each cell.
+		void saveColGridsToFile_v2(const std::string &filename) const
+		{
+			mrpt::utils::CFileGZOutputStream fo(filename);
+			fo << static_cast<uint32_t>(1) << static_cast<uint32_t>(0xC0C0C0C3) << static_cast<uint8_t>(2);
+			fo << getRobotShape();
+			fo << getDescription() << getAlphaValuesCount() << static_cast<float>(getMax_V()) << static_cast<float>(getMax_W());
+			fo << m_collisionGrid.getXMin() << m_collisionGrid.getXMax() << m_collisionGrid.getYMin() << m_collisionGrid.getYMax();
+			fo << m_collisionGrid.getResolution();
+
+			const std::vector<TCollisionCell> cells = getAllCells();
+			fo << static_cast<uint32_t>(cells.size());
+			for (size_t i=0;i<cells.size();i++)
+			{
+				fo << static_cast<uint32_t>(cells[i].size());
+				for (size_t j=0;j<cells[i].size();j++)
+					fo << cells[i][j].first << cells[i][j].second;
+			}
+		}
+	};
+}
+
+// Both the current (v3) and the former (v2) cache file formats must be actually loaded, and restore the exact same collision grid:
+TEST(NavTests, PTGs_cache_file_formats)
+{
+	using namespace std;
+	using namespace mrpt;
+	using namespace mrpt::nav;
+
+	mrpt::utils::CConfigFileMemory cfg;
+	cfg.write("PTG","num_paths",101);
+	cfg.write("PTG","refDistance",3.0);
+	cfg.write("PTG","resolution",0.10);
+	cfg.write("PTG","v_max_mps",1.0);
+	cfg.write("PTG","w_max_dps",60.0);
+	cfg.write("PTG","K",1.0);
+	const double shape_x[4] = {-0.2, 0.5, 0.5,-0.2}, shape_y[4] = {0.3, 0.3,-0.3,-0.3};
+	for (int i=0;i<4;i++)
+	{
+		cfg.write("PTG",format("shape_x%i",i),shape_x[i]);
+		cfg.write("PTG",format("shape_y%i",i),shape_y[i]);
+	}
+
+	CPTG_DiffDrive_C_CacheTest ptg(cfg,"PTG");
+	ptg.initialize(string(), false /*verbose */);
+
+	typedef CPTG_DiffDrive_C_CacheTest::TCollisionCell TCell;
+	const vector<TCell> computed_cells = ptg.getAllCells();
+	size_t nNonEmptyCells = 0;
+	for (size_t i=0;i<computed_cells.size();i++)
+		if (!computed_cells[i].empty()) nNonEmptyCells++;
+	ASSERT_GT(nNonEmptyCells, 0u);
+
+	const string sCacheFile = mrpt::system::getTempFileName();
+	for (int version=2;version<=3;version++)
+	{
+		if (version==3)
+			ASSERT_TRUE(ptg.saveColGridsToFile(sCacheFile, ptg.getRobotShape()));
+		else ptg.saveColGridsToFile_v2(sCacheFile);
+
+		ptg.clearAllCells();
+		ASSERT_TRUE(ptg.loadColGridsFromFile(sCacheFile, ptg.getRobotShape())) << "File format v" << version;
+
+		const vector<TCell> loaded_cells = ptg.getAllCells();
+		ASSERT_EQ(computed_cells.size(), loaded_cells.size());
+		for (size_t i=0;i<computed_cells.size();i++)
+			EXPECT_TRUE(computed_cells[i]==loaded_cells[i]) << "File format v" << version << ", cell #" << i;
+	}
+
+	// A cache file computed for another robot shape must be rejected:
+	mrpt::math::CPolygon other_shape = ptg.getRobotShape();
+	other_shape.AddVertex(0.6,0.0);
+	EXPECT_FALSE(ptg.loadColGridsFromFile(sCacheFile, other_shape));
+
+	// A v3 file whose cells decode fine but with trailing garbage must be rejected, leaving the grid unmodified:
+	{
+		ASSERT_TRUE(ptg.saveColGridsToFile(sCacheFile, ptg.getRobotShape()));
+		mrpt::vector_byte data;
+		ASSERT_TRUE(mrpt::compress::zip::decompress_gz_file(sCacheFile, data));
+		// The encoded cells are the last "nBytes" of the file, right after "nBytes" itself:
+		size_t nBytes_pos = 0;
+		for (size_t i=data.size()-4;i>0 && !nBytes_pos;i--)
+			if ((data[i] | (data[i+1]<<8) | (data[i+2]<<16) | (static_cast<uint32_t>(data[i+3])<<24)) == data.size()-i-4)
+				nBytes_pos = i;
+		ASSERT_GT(nBytes_pos, 0u);
+		data.push_back(0);
+		const uint32_t new_nBytes = static_cast<uint32_t>(data.size()-nBytes_pos-4);
+		for (int b=0;b<4;b++)
+			data[nBytes_pos+b] = static_cast<uint8_t>(new_nBytes >> (8*b));
+		ASSERT_TRUE(mrpt::compress::zip::compress_gz_file(sCacheFile, data, 1));
+
+		ptg.clearAllCells();
+		EXPECT_FALSE(ptg.loadColGridsFromFile(sCacheFile, ptg.getRobotShape()));
+		const vector<TCell> loaded_cells = ptg.getAllCells();
+		for (size_t i=0;i<loaded_cells.size();i++)
+			EXPECT_TRUE(loaded_cells[i].empty()) << "cell #" << i;
+	}
+
+	mrpt::system::deleteFile(sCacheFile);
+}
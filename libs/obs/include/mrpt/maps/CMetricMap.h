@@ -231,6 +231,12 @@ namespace mrpt
 			  */
 			virtual void  auxParticleFilterCleanUp() { /* Default implementation: do nothing. */ }
 
+			/** This method is called before evaluating computeObservationLikelihood() on this same map from several threads at once,
+			  *  e.g. by particle filters with mrpt::bayes::CParticleFilter::TParticleFilterOptions::numThreadsObsLikelihood!=1.
+			  *  Maps that lazily build auxiliary data while evaluating likelihoods must build it all here, so the evaluation becomes read-only.
+			  */
+			virtual void  prepareConcurrentObservationLikelihood() { /* Default implementation: do nothing. */ }
+
 			/** Returns the square distance from the 2D point (x0,y0) to the closest correspondence in the map. */
 			virtual float squareDistanceToClosestCorrespondence(float x0,float y0 ) const;
 
@@ -28,6 +28,7 @@ namespace mrpt
 			size_t decimation_other_map_points; //!< (Default=1) Only consider 1 out of this number of points from the "other" map.
 			size_t offset_other_map_points;  //!< Index of the first point in the "other" map to start checking for correspondences (Default=0)
 			mrpt::math::TPoint3D angularDistPivotPoint; //!< The point used to calculate angular distances: e.g. the coordinates of the sensor for a 2D laser scanner.
+			unsigned int numThreads; //!< (Default=1) Number of threads for the nearest-neighbour search, where supported (e.g. point maps). 0 means as many as CPU cores. The returned pairings do not depend on this value.
 
 			/** Ctor: default values */
 			TMatchingParams() :
@@ -37,7 +38,8 @@ namespace mrpt
 				onlyUniqueRobust(false),
 				decimation_other_map_points(1),
 				offset_other_map_points(0),
-				angularDistPivotPoint(0,0,0)
+				angularDistPivotPoint(0,0,0),
+				numThreads(1)
 			{}
 		};
 
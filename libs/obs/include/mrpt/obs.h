@@ -56,6 +56,7 @@ MRPT_WARNING("Including <mrpt/obs.h> makes compilation much slower, consider inc
 
 // Others:
 #include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CRawlogIndexedReader.h>
 #include <mrpt/obs/carmen_log_tools.h>
 
 // Very basic classes for maps:
@@ -35,7 +35,10 @@ namespace obs
 		bool PROJ3D_USE_LUT; //!< (Default:true) [Only used when `range_is_depth`=true] Whether to use a Look-up-table (LUT) to speed up the conversion. It's thread safe in all situations <b>except</b> when you call this method from different threads <b>and</b> with different camera parameter matrices. In all other cases, it is a good idea to left it enabled.
 		bool USE_SSE2; //!< (Default:true) If possible, use SSE2 optimized code.
 		bool MAKE_DENSE; //!< (Default:true) set to false if you want to preserve the organization of the point cloud
-		T3DPointsProjectionParams() :  takeIntoAccountSensorPoseOnRobot(false), robotPoseInTheWorld(NULL), PROJ3D_USE_LUT(true),USE_SSE2(true), MAKE_DENSE(true)
+		/** (Default:1) Number of threads used to project the range image (split in blocks of rows), color and transform the points. 0 means one per CPU core.
+		  * The output is identical for any number of threads. Only worth it for large range images. */
+		unsigned int numThreads;
+		T3DPointsProjectionParams() :  takeIntoAccountSensorPoseOnRobot(false), robotPoseInTheWorld(NULL), PROJ3D_USE_LUT(true),USE_SSE2(true), MAKE_DENSE(true), numThreads(1)
 		{}
 	};
 	/** Used in CObservation3DRangeScan::convertTo2DScan() */
@@ -10,125 +10,76 @@
 #define CObservation3DRangeScan_project3D_impl_H
 
 #include <mrpt/utils/round.h> // round()
+#include <mrpt/system/threads.h> // parallelForBlocks()
 
 namespace mrpt {
 namespace obs {
 namespace detail {
-	// Auxiliary functions which implement SSE-optimized proyection of 3D point cloud:
-	template <class POINTMAP> void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE);
-	template <class POINTMAP> void do_project_3d_pointcloud_SSE2(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE);
+	// Auxiliary functions which implement SSE-optimized proyection of 3D point cloud.
+	// Both project the rows [r0,r1) into the points starting at `idx0` and return the number of written points.
+	template <class POINTMAP> size_t do_project_3d_pointcloud(const int r0,const int r1,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE, const size_t idx0);
+	template <class POINTMAP> size_t do_project_3d_pointcloud_SSE2(const int r0,const int r1,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE, const size_t idx0);
 
+	/** Data shared by the worker threads of project3DPointsFromDepthImageInto() */
 	template <class POINTMAP>
-	void project3DPointsFromDepthImageInto(
-			mrpt::obs::CObservation3DRangeScan    & src_obs,
-			POINTMAP                   & dest_pointcloud,
-			const mrpt::obs::T3DPointsProjectionParams & projectParams,
-			const mrpt::obs::TRangeImageFilterParams &filterParams)
+	struct TProject3DThreadsData
 	{
-		using namespace mrpt::math;
-
-		if (!src_obs.hasRangeImage) return;
-
-		mrpt::utils::PointCloudAdapter<POINTMAP> pca(dest_pointcloud);
-
-		// ------------------------------------------------------------
-		// Stage 1/3: Create 3D point cloud local coordinates
-		// ------------------------------------------------------------
-		const int W = src_obs.rangeImage.cols();
-		const int H = src_obs.rangeImage.rows();
-		ASSERT_(W!=0 && H!=0);
-		const size_t WH = W*H;
-
-		src_obs.resizePoints3DVectors(WH); // This is to make sure points3D_idxs_{x,y} have the expected sizes.
-		pca.resize(WH); // Reserve memory for 3D points. It will be later resized again to the actual number of valid points
+		TProject3DThreadsData(mrpt::obs::CObservation3DRangeScan &src_obs_, mrpt::utils::PointCloudAdapter<POINTMAP> &pca_,const mrpt::obs::T3DPointsProjectionParams &projectParams_,const mrpt::obs::TRangeImageFilterParams &filterParams_) :
+			src_obs(src_obs_), pca(pca_), projectParams(projectParams_), filterParams(filterParams_),
+			W(0), kys(NULL), kzs(NULL), use_sse2(false), isDirectCorresp(false), hasColorIntensityImg(false), imgW(0), imgH(0), cx(0),cy(0),fx(0),fy(0), apply_transf(false)
+		{}
+
+		mrpt::obs::CObservation3DRangeScan & src_obs;
+		mrpt::utils::PointCloudAdapter<POINTMAP> & pca;
+		const mrpt::obs::T3DPointsProjectionParams & projectParams;
+		const mrpt::obs::TRangeImageFilterParams & filterParams;
+
+		// Stage 1:
+		int W;
+		const float *kys, *kzs; //!< LUT, or NULL if not used
+		bool use_sse2;
+		std::vector<size_t> block_first_idx, block_num_pts; //!< For each thread: first point index & number of points written
+
+		// Stage 2:
+		bool isDirectCorresp, hasColorIntensityImg;
+		int imgW, imgH;
+		float cx,cy,fx,fy;
+		mrpt::math::CMatrixFixedNumeric<float,4,4> T_inv;
+
+		// Stage 3:
+		bool apply_transf;
+		mrpt::math::CMatrixFixedNumeric<float,4,4> HM;
+	};
+
+	// Stage 1 worker: projects the rows [r0,r1) into the points starting at index r0*W
+	template <class POINTMAP>
+	void project3DRowsBlock(size_t r0, size_t r1, unsigned int thread_idx, void *param)
+	{
+		TProject3DThreadsData<POINTMAP> &d = *static_cast<TProject3DThreadsData<POINTMAP>*>(param);
+		mrpt::obs::CObservation3DRangeScan &src_obs = d.src_obs;
+		const int W = d.W;
+		const size_t idx0 = r0*W;
+		size_t nPts;
 
-		if (src_obs.range_is_depth)
+		if (d.kys)
 		{
-			// range_is_depth = true
-
-			// Use cached tables?
-			if (projectParams.PROJ3D_USE_LUT)
-			{
-				// Use LUT:
-				if (src_obs.m_3dproj_lut.prev_camParams!=src_obs.cameraParams || WH!=size_t(src_obs.m_3dproj_lut.Kys.size()))
-				{
-					src_obs.m_3dproj_lut.prev_camParams = src_obs.cameraParams;
-					src_obs.m_3dproj_lut.Kys.resize(WH);
-					src_obs.m_3dproj_lut.Kzs.resize(WH);
-
-					const float r_cx = src_obs.cameraParams.cx();
-					const float r_cy = src_obs.cameraParams.cy();
-					const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
-					const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-
-					float *kys = &src_obs.m_3dproj_lut.Kys[0];
-					float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
-					for (int r=0;r<H;r++)
-						for (int c=0;c<W;c++)
-						{
-							*kys++ = (r_cx - c) * r_fx_inv;
-							*kzs++ = (r_cy - r) * r_fy_inv;
-						}
-				} // end update LUT.
-
-				ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kys.size()))
-				ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kzs.size()))
-				float *kys = &src_obs.m_3dproj_lut.Kys[0];
-				float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
-
-				if (filterParams.rangeMask_min) { // sanity check:
-					ASSERT_EQUAL_(filterParams.rangeMask_min->cols(), src_obs.rangeImage.cols());
-					ASSERT_EQUAL_(filterParams.rangeMask_min->rows(), src_obs.rangeImage.rows());
-				}
-				if (filterParams.rangeMask_max) { // sanity check:
-					ASSERT_EQUAL_(filterParams.rangeMask_max->cols(), src_obs.rangeImage.cols());
-					ASSERT_EQUAL_(filterParams.rangeMask_max->rows(), src_obs.rangeImage.rows());
-				}
-	#if MRPT_HAS_SSE2
-				if ((W & 0x07)==0 && projectParams.USE_SSE2)
-					 do_project_3d_pointcloud_SSE2(H,W,kys,kzs,src_obs.rangeImage,pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, filterParams, projectParams.MAKE_DENSE);
-				else do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, filterParams, projectParams.MAKE_DENSE);  // if image width is not 8*N, use standard method
-	#else
-				do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca,src_obs.points3D_idxs_x, src_obs.points3D_idxs_y,filterParams, projectParams.MAKE_DENSE);
-	#endif
-			}
-			else
-			{
-				// Without LUT:
-				const float r_cx =  src_obs.cameraParams.cx();
-				const float r_cy = src_obs.cameraParams.cy();
-				const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
-				const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-				TRangeImageFilter rif(filterParams);
-				size_t idx=0;
-				for (int r=0;r<H;r++)
-					for (int c=0;c<W;c++)
-					{
-						const float D = src_obs.rangeImage.coeff(r,c);
-						if (rif.do_range_filter(r,c,D))
-						{
-							const float Kz = (r_cy - r) * r_fy_inv;
-							const float Ky = (r_cx - c) * r_fx_inv;
-							pca.setPointXYZ(idx,
-								D,        // x
-								Ky * D,   // y
-								Kz * D    // z
-								);
-							src_obs.points3D_idxs_x[idx]=c;
-							src_obs.points3D_idxs_y[idx]=r;
-							++idx;
-						}
-					}
-				pca.resize(idx); // Actual number of valid pts
-			}
+			// Use LUT:
+#if MRPT_HAS_SSE2
+			if (d.use_sse2)
+				 nPts = do_project_3d_pointcloud_SSE2(r0,r1,W,d.kys,d.kzs,src_obs.rangeImage,d.pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, d.filterParams, d.projectParams.MAKE_DENSE, idx0);
+			else nPts = do_project_3d_pointcloud(r0,r1,W,d.kys,d.kzs,src_obs.rangeImage,d.pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, d.filterParams, d.projectParams.MAKE_DENSE, idx0);
+#else
+			nPts = do_project_3d_pointcloud(r0,r1,W,d.kys,d.kzs,src_obs.rangeImage,d.pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, d.filterParams, d.projectParams.MAKE_DENSE, idx0);
+#endif
 		}
 		else
 		{
-			/* range_is_depth = false :
+			/* Without LUT:
 			  *   Ky = (r_cx - c)/r_fx
 			  *   Kz = (r_cy - r)/r_fy
 			  *
-			  *   x(i) = rangeImage(r,c) / sqrt( 1 + Ky^2 + Kz^2 )
+			  *  range_is_depth = true:   x(i) = rangeImage(r,c)
+			  *  range_is_depth = false : x(i) = rangeImage(r,c) / sqrt( 1 + Ky^2 + Kz^2 )
 			  *   y(i) = Ky * x(i)
 			  *   z(i) = Kz * x(i)
 			  */
@@ -136,9 +87,10 @@ namespace detail {
 			const float r_cy = src_obs.cameraParams.cy();
 			const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
 			const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-			TRangeImageFilter rif(filterParams);
-			size_t idx=0;
-			for (int r=0;r<H;r++)
+			const bool range_is_depth = src_obs.range_is_depth;
+			TRangeImageFilter rif(d.filterParams);
+			size_t idx=idx0;
+			for (int r=r0;r<int(r1);r++)
 				for (int c=0;c<W;c++)
 				{
 					const float D = src_obs.rangeImage.coeff(r,c);
@@ -146,8 +98,8 @@ namespace detail {
 					{
 						const float Ky = (r_cx - c) * r_fx_inv;
 						const float Kz = (r_cy - r) * r_fy_inv;
-						pca.setPointXYZ(idx,
-							D / std::sqrt(1+Ky*Ky+Kz*Kz), // x
+						d.pca.setPointXYZ(idx,
+							range_is_depth ? D : D / std::sqrt(1+Ky*Ky+Kz*Kz), // x
 							Ky * D,   // y
 							Kz * D    // z
 							);
@@ -156,54 +108,35 @@ namespace detail {
 						++idx;
 					}
 				}
-			pca.resize(idx); // Actual number of valid pts
+			nPts = idx-idx0;
 		}
+		d.block_first_idx[thread_idx] = idx0;
+		d.block_num_pts[thread_idx] = nPts;
+	}
 
-		// -------------------------------------------------------------
-		// Stage 2/3: Project local points into RGB image to get colors
-		// -------------------------------------------------------------
-		if (src_obs.hasIntensityImage)
-		{
-			const int imgW = src_obs.intensityImage.getWidth();
-			const int imgH = src_obs.intensityImage.getHeight();
-			const bool hasColorIntensityImg = src_obs.intensityImage.isColor();
-
-			const float cx = src_obs.cameraParamsIntensity.cx();
-			const float cy = src_obs.cameraParamsIntensity.cy();
-			const float fx = src_obs.cameraParamsIntensity.fx();
-			const float fy = src_obs.cameraParamsIntensity.fy();
-
-			// Unless we are in a special case (both depth & RGB images coincide)...
-			const bool isDirectCorresp = src_obs.doDepthAndIntensityCamerasCoincide();
-
-			// ...precompute the inverse of the pose transformation out of the loop,
-			//  store as a 4x4 homogeneous matrix to exploit SSE optimizations below:
-			mrpt::math::CMatrixFixedNumeric<float,4,4> T_inv;
-			if (!isDirectCorresp)
-			{
-			 mrpt::math::CMatrixFixedNumeric<double,3,3> R_inv;
-			 mrpt::math::CMatrixFixedNumeric<double,3,1> t_inv;
-				mrpt::math::homogeneousMatrixInverse(
-					src_obs.relativePoseIntensityWRTDepth.getRotationMatrix(),src_obs.relativePoseIntensityWRTDepth.m_coords,
-					R_inv,t_inv);
-
-				T_inv(3,3)=1;
-				T_inv.block<3,3>(0,0)=R_inv.cast<float>();
-				T_inv.block<3,1>(0,3)=t_inv.cast<float>();
-			}
+	// Stages 2 & 3 worker: color and 6D transformation of the points [i0,i1), in one single pass
+	template <class POINTMAP>
+	void colorAndTransformPointsBlock(size_t i0, size_t i1, unsigned int , void *param)
+	{
+		TProject3DThreadsData<POINTMAP> &d = *static_cast<TProject3DThreadsData<POINTMAP>*>(param);
+		const mrpt::obs::CObservation3DRangeScan &src_obs = d.src_obs;
+		mrpt::utils::PointCloudAdapter<POINTMAP> &pca = d.pca;
 
-			Eigen::Matrix<float,4,1>  pt_wrt_color, pt_wrt_depth;
-			pt_wrt_depth[3]=1;
+		Eigen::Matrix<float,4,1>  pt_wrt_color, pt_wrt_depth, pt_transf;
+		pt_wrt_depth[3]=1;
 
-			mrpt::utils::TColor pCol;
+		mrpt::utils::TColor pCol;
 
-			// For each local point:
-			const size_t nPts = pca.size();
-			for (size_t i=0;i<nPts;i++)
+		for (size_t i=i0;i<i1;i++)
+		{
+			// -------------------------------------------------------------
+			// Stage 2/3: Project local points into RGB image to get colors
+			// -------------------------------------------------------------
+			if (src_obs.hasIntensityImage)
 			{
 				int img_idx_x, img_idx_y;  // projected pixel coordinates, in the RGB image plane
 				bool pointWithinImage = false;
-				if (isDirectCorresp)
+				if (d.isDirectCorresp)
 				{
 					pointWithinImage=true;
 					img_idx_x = src_obs.points3D_idxs_x[i];
@@ -213,21 +146,21 @@ namespace detail {
 				{
 					// Project point, which is now in "pca" in local coordinates wrt the depth camera, into the intensity camera:
 					pca.getPointXYZ(i,pt_wrt_depth[0],pt_wrt_depth[1],pt_wrt_depth[2]);
-					pt_wrt_color.noalias() = T_inv*pt_wrt_depth;
+					pt_wrt_color.noalias() = d.T_inv*pt_wrt_depth;
 
 					// Project to image plane:
 					if (pt_wrt_color[2]) {
-						img_idx_x = mrpt::utils::round( cx + fx * pt_wrt_color[0]/pt_wrt_color[2] );
-						img_idx_y = mrpt::utils::round( cy + fy * pt_wrt_color[1]/pt_wrt_color[2] );
+						img_idx_x = mrpt::utils::round( d.cx + d.fx * pt_wrt_color[0]/pt_wrt_color[2] );
+						img_idx_y = mrpt::utils::round( d.cy + d.fy * pt_wrt_color[1]/pt_wrt_color[2] );
 						pointWithinImage=
-							img_idx_x>=0 && img_idx_x<imgW &&
-							img_idx_y>=0 && img_idx_y<imgH;
+							img_idx_x>=0 && img_idx_x<d.imgW &&
+							img_idx_y>=0 && img_idx_y<d.imgH;
 					}
 				}
 
 				if (pointWithinImage)
 				{
-					if (hasColorIntensityImg)  {
+					if (d.hasColorIntensityImg)  {
 						const uint8_t *c= src_obs.intensityImage.get_unsafe(img_idx_x, img_idx_y, 0);
 						pCol.R = c[2];
 						pCol.G = c[1];
@@ -244,10 +177,146 @@ namespace detail {
 				}
 				// Set color:
 				pca.setPointRGBu8(i,pCol.R,pCol.G,pCol.B);
-			} // end for each point
-		} // end if src_obs has intensity image
+			}
+
+			// ------------------------------------------------------------
+			// Stage 3/3: Apply 6D transformations
+			// ------------------------------------------------------------
+			if (d.apply_transf)
+			{
+				pca.getPointXYZ(i,pt_wrt_depth[0],pt_wrt_depth[1],pt_wrt_depth[2]);
+				pt_transf.noalias() = d.HM*pt_wrt_depth;
+				pca.setPointXYZ(i,pt_transf[0],pt_transf[1],pt_transf[2]);
+			}
+		} // end for each point
+	}
+
+	template <class POINTMAP>
+	void project3DPointsFromDepthImageInto(
+			mrpt::obs::CObservation3DRangeScan    & src_obs,
+			POINTMAP                   & dest_pointcloud,
+			const mrpt::obs::T3DPointsProjectionParams & projectParams,
+			const mrpt::obs::TRangeImageFilterParams &filterParams)
+	{
+		using namespace mrpt::math;
+
+		if (!src_obs.hasRangeImage) return;
+
+		mrpt::utils::PointCloudAdapter<POINTMAP> pca(dest_pointcloud);
+		TProject3DThreadsData<POINTMAP> td(src_obs,pca,projectParams,filterParams);
+
+		// ------------------------------------------------------------
+		// Stage 1/3: Create 3D point cloud local coordinates
+		// ------------------------------------------------------------
+		const int W = src_obs.rangeImage.cols();
+		const int H = src_obs.rangeImage.rows();
+		ASSERT_(W!=0 && H!=0);
+		const size_t WH = W*H;
+		td.W = W;
+
+		src_obs.resizePoints3DVectors(WH); // This is to make sure points3D_idxs_{x,y} have the expected sizes.
+		pca.resize(WH); // Reserve memory for 3D points. It will be later resized again to the actual number of valid points
+
+		// Use cached tables?
+		if (src_obs.range_is_depth && projectParams.PROJ3D_USE_LUT)
+		{
+			// Use LUT:
+			if (src_obs.m_3dproj_lut.prev_camParams!=src_obs.cameraParams || WH!=size_t(src_obs.m_3dproj_lut.Kys.size()))
+			{
+				src_obs.m_3dproj_lut.prev_camParams = src_obs.cameraParams;
+				src_obs.m_3dproj_lut.Kys.resize(WH);
+				src_obs.m_3dproj_lut.Kzs.resize(WH);
+
+				const float r_cx = src_obs.cameraParams.cx();
+				const float r_cy = src_obs.cameraParams.cy();
+				const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
+				const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
+
+				float *kys = &src_obs.m_3dproj_lut.Kys[0];
+				float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
+				for (int r=0;r<H;r++)
+					for (int c=0;c<W;c++)
+					{
+						*kys++ = (r_cx - c) * r_fx_inv;
+						*kzs++ = (r_cy - r) * r_fy_inv;
+					}
+			} // end update LUT.
+
+			ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kys.size()))
+			ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kzs.size()))
+			td.kys = &src_obs.m_3dproj_lut.Kys[0];
+			td.kzs = &src_obs.m_3dproj_lut.Kzs[0];
+
+			if (filterParams.rangeMask_min) { // sanity check:
+				ASSERT_EQUAL_(filterParams.rangeMask_min->cols(), src_obs.rangeImage.cols());
+				ASSERT_EQUAL_(filterParams.rangeMask_min->rows(), src_obs.rangeImage.rows());
+			}
+			if (filterParams.rangeMask_max) { // sanity check:
+				ASSERT_EQUAL_(filterParams.rangeMask_max->cols(), src_obs.rangeImage.cols());
+				ASSERT_EQUAL_(filterParams.rangeMask_max->rows(), src_obs.rangeImage.rows());
+			}
+			td.use_sse2 = (W & 0x07)==0 && projectParams.USE_SSE2; // if image width is not 8*N, use standard method
+		}
+
+		// Split the image in blocks of rows, each one written by one thread directly into the output cloud,
+		// starting at the index of its first pixel:
+		unsigned int nThreads = projectParams.numThreads!=0 ? projectParams.numThreads : mrpt::system::getNumberOfProcessors();
+		nThreads = std::min<unsigned int>(nThreads, H);
+		td.block_first_idx.assign(nThreads,0);
+		td.block_num_pts.assign(nThreads,0);
+		mrpt::system::parallelForBlocks(H, &project3DRowsBlock<POINTMAP>, &td, nThreads);
+
+		// Make the point cloud contiguous (only needed for MAKE_DENSE or without LUT; otherwise all blocks are full):
+		size_t nPts = td.block_num_pts[0];
+		for (unsigned int k=1;k<nThreads;k++)
+		{
+			const size_t i0 = td.block_first_idx[k], n = td.block_num_pts[k];
+			if (i0!=nPts)
+			{
+				float x,y,z;
+				for (size_t i=0;i<n;i++)
+				{
+					pca.getPointXYZ(i0+i,x,y,z);
+					pca.setPointXYZ(nPts+i,x,y,z);
+					src_obs.points3D_idxs_x[nPts+i] = src_obs.points3D_idxs_x[i0+i];
+					src_obs.points3D_idxs_y[nPts+i] = src_obs.points3D_idxs_y[i0+i];
+				}
+			}
+			nPts+=n;
+		}
+
+		// -------------------------------------------------------------
+		// Stage 2/3: Project local points into RGB image to get colors
+		// -------------------------------------------------------------
+		if (src_obs.hasIntensityImage)
+		{
+			td.imgW = src_obs.intensityImage.getWidth();
+			td.imgH = src_obs.intensityImage.getHeight();
+			td.hasColorIntensityImg = src_obs.intensityImage.isColor();
+
+			td.cx = src_obs.cameraParamsIntensity.cx();
+			td.cy = src_obs.cameraParamsIntensity.cy();
+			td.fx = src_obs.cameraParamsIntensity.fx();
+			td.fy = src_obs.cameraParamsIntensity.fy();
 
-		// ...
+			// Unless we are in a special case (both depth & RGB images coincide)...
+			td.isDirectCorresp = src_obs.doDepthAndIntensityCamerasCoincide();
+
+			// ...precompute the inverse of the pose transformation out of the loop,
+			//  store as a 4x4 homogeneous matrix to exploit SSE optimizations below:
+			if (!td.isDirectCorresp)
+			{
+				mrpt::math::CMatrixFixedNumeric<double,3,3> R_inv;
+				mrpt::math::CMatrixFixedNumeric<double,3,1> t_inv;
+				mrpt::math::homogeneousMatrixInverse(
+					src_obs.relativePoseIntensityWRTDepth.getRotationMatrix(),src_obs.relativePoseIntensityWRTDepth.m_coords,
+					R_inv,t_inv);
+
+				td.T_inv(3,3)=1;
+				td.T_inv.template block<3,3>(0,0)=R_inv.cast<float>();
+				td.T_inv.template block<3,1>(0,3)=t_inv.cast<float>();
+			}
+		} // end if src_obs has intensity image
 
 		// ------------------------------------------------------------
 		// Stage 3/3: Apply 6D transformations
@@ -260,28 +329,27 @@ namespace detail {
 			if (projectParams.robotPoseInTheWorld)
 				transf_to_apply.composeFrom(*projectParams.robotPoseInTheWorld, mrpt::poses::CPose3D(transf_to_apply));
 
-			const mrpt::math::CMatrixFixedNumeric<float,4,4> HM = transf_to_apply.getHomogeneousMatrixVal().cast<float>();
-			Eigen::Matrix<float,4,1>  pt, pt_transf;
-			pt[3]=1;
-
-			const size_t nPts = pca.size();
-			for (size_t i=0;i<nPts;i++)
-			{
-				pca.getPointXYZ(i,pt[0],pt[1],pt[2]);
-				pt_transf.noalias() = HM*pt;
-				pca.setPointXYZ(i,pt_transf[0],pt_transf[1],pt_transf[2]);
-			}
+			td.HM = transf_to_apply.getHomogeneousMatrixVal().cast<float>();
+			td.apply_transf = true;
 		}
+
+		// Stages 2 & 3 are done in one pass over the points, in parallel:
+		if (nPts && (src_obs.hasIntensityImage || td.apply_transf))
+			mrpt::system::parallelForBlocks(nPts, &colorAndTransformPointsBlock<POINTMAP>, &td, std::min<size_t>(nThreads,nPts));
+
+		// Actual number of valid pts. The per-point setters have no side effects, so this also marks the point cloud as modified
+		// (invalidate cached bounding boxes, octrees, etc.) once, from this thread, after all points have been written:
+		pca.resize(nPts);
 	} // end of project3DPointsFromDepthImageInto
 
 	// Auxiliary functions which implement proyection of 3D point clouds:
 	template <class POINTMAP>
-	inline void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &fp, bool MAKE_DENSE)
+	inline size_t do_project_3d_pointcloud(const int r0,const int r1,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &fp, bool MAKE_DENSE, const size_t idx0)
 	{
 		TRangeImageFilter rif(fp);
 		// Preconditions: minRangeMask() has the right size
-		size_t idx=0;
-		for (int r=0;r<H;r++)
+		size_t idx=idx0;
+		for (int r=r0;r<r1;r++)
 			for (int c=0;c<W;c++)
 			{
 				const float D = rangeImage.coeff(r,c);
@@ -294,29 +362,32 @@ namespace detail {
 					continue;
 				}
 
-				pca.setPointXYZ(idx, D /*x*/, *kys++ * D /*y*/, *kzs++ * D /*z*/);
+				const size_t k = r*W+c; // LUT index
+				pca.setPointXYZ(idx, D /*x*/, kys[k] * D /*y*/, kzs[k] * D /*z*/);
 				idxs_x[idx]=c;
 				idxs_y[idx]=r;
 				++idx;
 			}
-		pca.resize(idx);
+		return idx-idx0;
 	}
 
 	// Auxiliary functions which implement proyection of 3D point clouds:
 	template <class POINTMAP>
-	inline void do_project_3d_pointcloud_SSE2(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE)
+	inline size_t do_project_3d_pointcloud_SSE2(const int r0,const int r1,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE, const size_t idx0)
 	{
+			size_t idx=idx0;
 	#if MRPT_HAS_SSE2
 			// Preconditions: minRangeMask() has the right size
 			// Use optimized version:
 			const int W_4 = W >> 2;  // /=4 , since we process 4 values at a time.
-			size_t idx=0;
 			MRPT_ALIGN16 float xs[4],ys[4],zs[4];
 			const __m128 D_zeros = _mm_set_ps(.0f,.0f,.0f,.0f);
 			const __m128 xormask = (filterParams.rangeCheckBetween) ?
 				_mm_cmpneq_ps(D_zeros,D_zeros) :	// want points BETWEEN min and max to be valid
 				_mm_cmpeq_ps(D_zeros,D_zeros);		// want points OUTSIDE of min and max to be valid
-			for (int r=0;r<H;r++)
+			kys += r0*W;
+			kzs += r0*W;
+			for (int r=r0;r<r1;r++)
 			{
 				const float *D_ptr = &rangeImage.coeffRef(r,0);  // Matrices are 16-aligned
 				const float *Dgt_ptr = !filterParams.rangeMask_min ? NULL : &filterParams.rangeMask_min->coeffRef(r,0);
@@ -401,8 +472,8 @@ namespace detail {
 					kzs+=4;
 				}
 			}
-			pca.resize(idx);
 	#endif
+			return idx-idx0;
 	}
 
 } // End of namespace
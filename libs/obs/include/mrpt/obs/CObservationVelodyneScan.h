@@ -176,12 +176,65 @@ namespace obs
 			bool   dualKeepStrongest, dualKeepLast; //!< (Default:true) In VLP16 dual mode, keep both or just one of the returns.
 			bool   generatePerPointTimestamp;       //!< (Default:false) If `true`, populate the vector timestamp
 			bool   generatePerPointAzimuth;         //!< (Default:false) If `true`, populate the vector azimuth
+			unsigned int numThreads;                //!< (Default:1) Number of threads for generatePointCloudAlongSE3Trajectory(), or 0 to use all CPU cores. The generated points do not depend on this value.
 
 			TGeneratePointCloudParameters();
 		};
 
 		static const TGeneratePointCloudParameters defaultPointCloudParams;
 
+		/** Streaming decoder of raw Velodyne packets into 3D points (in sensor-local coordinates).
+		  * It keeps a table with all the per-laser calibration terms and the azimuth interpolation factors,
+		  * which is only rebuilt when the LIDAR model or its calibration changes, so it is cheap to reuse
+		  * a single decoder for a whole sequence of scans. Each block (firing) of a packet is decoded at once
+		  * into the structure-of-arrays TPointCloud, using SSE2 instructions when available.
+		  *
+		  * Packets can be decoded one by one with decodePacket(), e.g. to start processing partial point clouds as
+		  * soon as they arrive from the sensor, without waiting for the 360 deg sweep to be complete:
+		  * \code
+		  *   CObservationVelodyneScan::TPointCloudDecoder decoder;
+		  *   CObservationVelodyneScan::TPointCloud pc;
+		  *   decoder.setup(obs);
+		  *   for (size_t i=0;i<obs.scan_packets.size();i++) {
+		  *     pc.clear();
+		  *     decoder.decodePacket(obs, i, pc, params);
+		  *     // ... process pc ...
+		  *   }
+		  * \endcode
+		  * The output of decodePacket() for all packets, one after the other, is identical to that of CObservationVelodyneScan::generatePointCloud().
+		  * \note New in MRPT 1.5.0
+		  */
+		class OBS_IMPEXP TPointCloudDecoder
+		{
+		public:
+			TPointCloudDecoder();
+
+			/** Prepares the decoding tables for the LIDAR model and calibration of the given scan.
+			  * It does nothing if they did not change since the last call. Must be called before decodePacket(). */
+			void setup(const CObservationVelodyneScan &scan);
+
+			/** Decodes one packet of \a scan, APPENDING the resulting points to \a out_pc.
+			  * This method is const, so it can be safely invoked from several threads at once (on different output clouds).
+			  * Firing blocks with an unexpected header (mangled data) are silently skipped.
+			  * \return The number of points appended to \a out_pc.
+			  */
+			size_t decodePacket(const CObservationVelodyneScan &scan, size_t packet_idx, TPointCloud &out_pc, const TGeneratePointCloudParameters &params = defaultPointCloudParams) const;
+
+			/** Calls setup() and decodes all packets of \a scan into \a out_pc, whose previous contents are cleared. */
+			void decodeScan(const CObservationVelodyneScan &scan, TPointCloud &out_pc, const TGeneratePointCloudParameters &params = defaultPointCloudParams);
+
+		private:
+			std::vector<VelodyneCalibration::PerLaserCalib> m_calib; //!< A copy of the calibration used to build the tables below
+			std::vector<double> m_distance_correction;  //!< Per-laser distance correction
+			std::vector<float>  m_cos_vert, m_sin_vert, m_horz_offset, m_vert_offset; //!< Per-laser vertical angle and offsets
+			/** Fraction of the azimuth increment between consecutive blocks to add to each firing, indexed by [dual_mode][block][dsr] */
+			double m_azimuth_adjust[2][BLOCKS_PER_PACKET][SCANS_PER_BLOCK];
+			const float *m_lut_cos, *m_lut_sin; //!< Azimuth sin/cos tables, with ROTATION_MAX_UNITS entries
+		};
+
+		/** Returns the timestamp of the given packet, from the GPS time of the first packet and the observation timestamp. */
+		mrpt::system::TTimeStamp getPacketTimestamp(size_t packet_idx) const;
+
 		/** Generates the point cloud into the point cloud data fields in \a CObservationVelodyneScan::point_cloud
 		  * where it is stored in local coordinates wrt the sensor (neither the vehicle nor the world).
 		  * So, this method does not take into account the possible motion of the sensor through the world as it collects LIDAR scans. 
@@ -204,6 +257,10 @@ namespace obs
 		  * \param[out] out_points The generated points, in the same coordinates frame than \a vehicle_path. Points are APPENDED to the list, so prevous contents are kept.
 		  * \param[out] results_stats Stats
 		  * \param[in] params Filtering and other parameters
+		  *
+		  * With `params.numThreads!=1`, the poses of the sensor for all the distinct packet timestamps are first interpolated
+		  * in parallel, then packets are decoded and transformed in parallel, in contiguous chunks which are finally
+		  * appended to \a out_points in their original order.
 		  * \sa generatePointCloud(), TGeneratePointCloudParameters
 		  */
 		void generatePointCloudAlongSE3Trajectory(
@@ -131,7 +131,8 @@ namespace mrpt
 			bool  loadFromRawLogFile( const std::string &fileName, bool non_obs_objects_are_legal = false );
 
 			/** Saves the contents to a rawlog-file, compatible with RawlogViewer (As the sequence of internal objects).
-			  *  The file is saved with gz-commpressed if MRPT has gz-streams.
+			  *  The file is saved with gz-commpressed if MRPT has gz-streams, in the block-compressed format (see mrpt::utils::CFileGZOutputStream::openBlockCompressed()),
+			  *  which is readable as any other gz file but also allows parallel decompression and random access (e.g. with CRawlogIndexedReader).
 			  * \returns It returns false if any error is found while writing/creating the target file.
 			  */
 			bool saveToRawLogFile( const std::string &fileName ) const;
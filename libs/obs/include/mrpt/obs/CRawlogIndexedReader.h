@@ -0,0 +1,117 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CRawlogIndexedReader_H
+#define CRawlogIndexedReader_H
+
+#include <mrpt/utils/CSerializable.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/compress/zip.h>
+#include <mrpt/system/datetime.h>
+#include <mrpt/obs/CObservation.h>
+#include <mrpt/obs/link_pragmas.h>
+#include <vector>
+#include <string>
+
+namespace mrpt
+{
+	namespace obs
+	{
+		/** Random-access, read-only view of a rawlog file, which decodes objects lazily and only on demand.
+		  *
+		  * Opening a rawlog with CRawlog::loadFromRawLogFile() deserializes the whole dataset into memory, which for large
+		  * datasets may take minutes and gigabytes of RAM. Instead, this class memory-maps the file (see mrpt::utils::CMemoryMappedFile)
+		  * and keeps an index with, for each serialized object in the file: its byte offset and length, its class name,
+		  * its timestamp and its sensor label. Objects are then deserialized directly from the mapped memory only when requested
+		  * with getObject() or getObservation(), so accessing the i'th entry or seeking by time is O(1) regardless of the dataset size.
+		  *
+		  * Building the index requires one sequential pass over the file. To avoid repeating it, the index is saved to a sidecar file
+		  * (see getIndexFileName()) next to the rawlog, which is reused in later calls to open() as long as the rawlog file size and
+		  * modification time still match those recorded in the index. If the sidecar file can not be written (e.g. read-only directories)
+		  * the index is simply kept in memory.
+		  *
+		  * The timestamp of each entry is that of the observation for CObservation-derived objects, and that of the first
+		  * observation (or action) for CSensoryFrame (or CActionCollection) objects. Other objects have an INVALID_TIMESTAMP.
+		  *
+		  * Once open(), all const methods are reentrant and may be invoked from several threads simultaneously, since each
+		  * call decodes its object from the shared, read-only mapping into a new instance.
+		  *
+		  * Block-compressed gz rawlogs (the default output of CRawlog::saveToRawLogFile(), see mrpt::utils::CFileGZOutputStream::openBlockCompressed())
+		  * are also supported: reading one object then only requires decompressing the one or two blocks which hold it.
+		  *
+		  * \note Rawlogs compressed as a single gz stream (e.g. those saved with older MRPT versions) can not be randomly accessed and
+		  *       must be decompressed first (e.g. with mrpt::compress::zip::decompress_gz_file()); open() returns false for them.
+		  *
+		  * \sa CRawlog, mrpt::utils::CMemoryMappedFile
+		  * \ingroup mrpt_obs_grp
+		  */
+		class OBS_IMPEXP CRawlogIndexedReader : public mrpt::utils::CUncopiable
+		{
+		public:
+			/** One entry in the index, per serialized object in the rawlog file */
+			struct OBS_IMPEXP TEntry
+			{
+				TEntry();
+				uint64_t  offset;  //!< Byte offset of the serialized object in the rawlog file
+				uint64_t  length;  //!< Length (bytes) of the serialized object
+				mrpt::system::TTimeStamp timestamp; //!< Timestamp of the object (see the class description), or INVALID_TIMESTAMP
+				std::string className;   //!< Class name of the object, e.g. "CObservation2DRangeScan"
+				std::string sensorLabel; //!< Sensor label for observations, empty otherwise
+			};
+
+			CRawlogIndexedReader(); //!< Default constructor
+			virtual ~CRawlogIndexedReader();
+
+			/** Maps the given (uncompressed) rawlog file into memory and loads its index, building it first if needed.
+			  * \param[in] useIndexFile If true (default), the sidecar index file is used if it exists and is up to date, or (re)generated otherwise.
+			  * \return false on any error opening the file, or if it is gz-compressed but not block-compressed.
+			  */
+			bool open(const std::string &fileName, bool useIndexFile = true);
+			void close(); //!< Closes the file, if open. Objects previously returned by getObject() remain valid.
+			bool isOpen() const { return m_file.is_open(); }
+			bool isBlockCompressed() const { return m_gz_blocks.size()!=0; } //!< Whether the open file is a block-compressed gz file.
+			const std::string & getFileName() const { return m_file.getFileName(); }
+
+			size_t size() const { return m_entries.size(); } //!< Number of objects in the rawlog
+			/** Returns the index data of the i'th object in the rawlog \exception std::exception On index out of bounds */
+			const TEntry & getEntry(size_t index) const;
+
+			/** Deserializes and returns the i'th object in the rawlog \exception std::exception On index out of bounds or errors deserializing */
+			mrpt::utils::CSerializablePtr getObject(size_t index) const;
+			/** Like getObject(), but returns an empty smart pointer if the i'th object is not a CObservation */
+			CObservationPtr getObservation(size_t index) const;
+
+			/** Returns the index of the first object (in time order) whose timestamp is equal or later than the given one,
+			  * or size() if there is none. Objects without a valid timestamp are never returned. This takes O(1) time on average. */
+			size_t findIndexByTimestamp(const mrpt::system::TTimeStamp t) const;
+
+			/** Returns the name of the sidecar index file for a given rawlog file (currently, the same file name plus the extension `.idx`) */
+			static std::string getIndexFileName(const std::string &rawlogFileName);
+
+		private:
+			mrpt::utils::CMemoryMappedFile m_file;
+			mrpt::compress::zip::TGZBlockIndex m_gz_blocks; //!< Only for block-compressed files
+			std::vector<TEntry> m_entries;
+			/** Indices of entries with valid timestamps, sorted by timestamp */
+			std::vector<size_t> m_sorted_by_time;
+			/** Uniform buckets over [m_time_min,m_time_max]: index of the first element in m_sorted_by_time which falls in each bucket */
+			std::vector<size_t> m_time_buckets;
+			mrpt::system::TTimeStamp m_time_min, m_time_max;
+			uint64_t m_time_bucket_width;
+
+			uint64_t dataSize() const; //!< Size of the (uncompressed) serialized data
+			void buildIndex();
+			bool loadIndexFile(const std::string &idxFile);
+			bool saveIndexFile(const std::string &idxFile) const;
+			void buildTimeLookupTable();
+		}; // End of class def.
+	} // End of namespace
+} // End of namespace
+
+#endif
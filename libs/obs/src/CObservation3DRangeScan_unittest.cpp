@@ -177,3 +177,58 @@ TEST(CObservation3DRangeScan, Project3D_filterMax)
 		EXPECT_EQ(o.points3D_x.size(), 3U ) << " testcase flags: i=" << i << std::endl;
 	}
 }
+
+TEST(CObservation3DRangeScan, Project3D_multiThreaded)
+{
+	mrpt::obs::T3DPointsProjectionParams pp;
+	mrpt::obs::TRangeImageFilterParams fp;
+	mrpt::math::CMatrix fMin(TEST_RANGEIMG_HEIGHT,TEST_RANGEIMG_WIDTH);
+	fMin.setConstant(1.0f);
+	fMin(11,10) = 12.0f; // Filter out one point
+	fp.rangeMask_min = &fMin;
+
+	for (int i=0;i<8;i++) // test all combinations of flags
+	{
+		mrpt::obs::CObservation3DRangeScan  o1;
+		fillSampleObs(o1,pp,i);
+		o1.sensorPose = mrpt::poses::CPose3D(0.1,0.2,0.3, 0.4,-0.1,0.05);
+		pp.numThreads = 1;
+		o1.project3DPointsFromDepthImageInto(o1,pp,fp);
+		EXPECT_EQ(o1.points3D_x.size(),20U) << " testcase flags: i=" << i << std::endl;
+
+		// The output must not depend on the number of threads (0=all cores):
+		for (unsigned int nThreads=0;nThreads<=TEST_RANGEIMG_HEIGHT+1;nThreads+=5)
+		{
+			mrpt::obs::CObservation3DRangeScan  o;
+			fillSampleObs(o,pp,i);
+			o.sensorPose = o1.sensorPose;
+			pp.numThreads = nThreads;
+			o.project3DPointsFromDepthImageInto(o,pp,fp);
+			EXPECT_TRUE(o.points3D_x==o1.points3D_x && o.points3D_y==o1.points3D_y && o.points3D_z==o1.points3D_z) << " testcase flags: i=" << i << " nThreads=" << nThreads << std::endl;
+			EXPECT_TRUE(o.points3D_idxs_x==o1.points3D_idxs_x && o.points3D_idxs_y==o1.points3D_idxs_y) << " testcase flags: i=" << i << " nThreads=" << nThreads << std::endl;
+		}
+	}
+}
+
+TEST(CObservation3DRangeScan, Project3D_LUTvsNoLUT)
+{
+	mrpt::obs::T3DPointsProjectionParams pp;
+	mrpt::obs::TRangeImageFilterParams fp;
+
+	for (int sse=0;sse<2;sse++)
+	{
+		mrpt::obs::CObservation3DRangeScan  o1, o2;
+		fillSampleObs(o1,pp,0); // No LUT
+		o1.project3DPointsFromDepthImageInto(o1,pp,fp);
+		fillSampleObs(o2,pp,1 | (sse ? 2:0)); // LUT, w/ or w/o SSE2
+		o2.project3DPointsFromDepthImageInto(o2,pp,fp);
+
+		ASSERT_EQ(o1.points3D_x.size(),o2.points3D_x.size());
+		for (size_t k=0;k<o1.points3D_x.size();k++)
+		{
+			EXPECT_FLOAT_EQ(o1.points3D_x[k],o2.points3D_x[k]);
+			EXPECT_FLOAT_EQ(o1.points3D_y[k],o2.points3D_y[k]);
+			EXPECT_FLOAT_EQ(o1.points3D_z[k],o2.points3D_z[k]);
+		}
+	}
+}
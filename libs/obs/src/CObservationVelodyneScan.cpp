@@ -13,6 +13,9 @@
 #include <mrpt/poses/CPose3DInterpolator.h>
 #include <mrpt/utils/round.h>
 #include <mrpt/utils/CStream.h>
+#include <mrpt/system/threads.h>
+#include <mrpt/utils/SSE_types.h>
+#include <cstring>
 
 using namespace std;
 using namespace mrpt::obs;
@@ -65,7 +68,8 @@ CObservationVelodyneScan::TGeneratePointCloudParameters::TGeneratePointCloudPara
 	dualKeepStrongest(true),
 	dualKeepLast(true),
 	generatePerPointTimestamp(false),
-	generatePerPointAzimuth(false)
+	generatePerPointAzimuth(false),
+	numThreads(1)
 {
 }
 
@@ -182,19 +186,40 @@ double VLP16AdjustTimeStamp(int firingblock,int dsr,int firingwithinblock)  //!<
 		(firingwithinblock * VLP16_FIRING_TOFFSET);
 }
 
-/** Auxiliary class used to refactor CObservationVelodyneScan::generatePointCloud() */
-struct PointCloudStorageWrapper {
-	/** Process the insertion of a new (x,y,z) point to the cloud, in sensor-centric coordinates, with the exact timestamp of that LIDAR ray */
-	virtual void add_point(double pt_x,double pt_y, double pt_z,uint8_t pt_intensity, const mrpt::system::TTimeStamp &tim, const float azimuth) = 0;
-};
+mrpt::system::TTimeStamp CObservationVelodyneScan::getPacketTimestamp(size_t packet_idx) const
+{
+	ASSERT_BELOW_(packet_idx,scan_packets.size())
+	const uint32_t us_pkt0     = scan_packets[0].gps_timestamp;
+	const uint32_t us_pkt_this = scan_packets[packet_idx].gps_timestamp;
+	// Handle the case of time counter reset by new hour 00:00:00
+	const uint32_t us_ellapsed = (us_pkt_this>=us_pkt0) ? (us_pkt_this-us_pkt0) : (1000000UL*3600UL + us_pkt_this-us_pkt0);
+	return mrpt::system::timestampAdd(timestamp,us_ellapsed*1e-6);
+}
 
-static void velodyne_scan_to_pointcloud(
-	const CObservationVelodyneScan & scan,
-	const CObservationVelodyneScan::TGeneratePointCloudParameters &params,
-	PointCloudStorageWrapper & out_pc)
+CObservationVelodyneScan::TPointCloudDecoder::TPointCloudDecoder() :
+	m_lut_cos(NULL),
+	m_lut_sin(NULL)
 {
-	// Initially based on code from ROS velodyne & from vtkVelodyneHDLReader::vtkInternal::ProcessHDLPacket(). 
-	using mrpt::utils::round;
+	memset(m_azimuth_adjust,0,sizeof(m_azimuth_adjust));
+}
+
+void CObservationVelodyneScan::TPointCloudDecoder::setup(const CObservationVelodyneScan &scan)
+{
+	MRPT_START
+
+	const std::vector<VelodyneCalibration::PerLaserCalib> &calib = scan.calibration.laser_corrections;
+	// This is: 16,32,64 depending on the LIDAR model
+	const size_t num_lasers = calib.size();
+
+	if (num_lasers!=16 && num_lasers!=32 && num_lasers!=64 && !scan.scan_packets.empty())
+		THROW_EXCEPTION("Error: unhandled LIDAR model!")
+
+	// Are the tables up to date?
+	if (m_lut_cos!=NULL && m_calib.size()==num_lasers &&
+		(num_lasers==0 || 0==memcmp(&m_calib[0],&calib[0],sizeof(calib[0])*num_lasers)))
+		return;
+
+	m_calib = calib;
 
 	// Access to sin/cos table:
 	mrpt::obs::T2DScanProperties scan_props;
@@ -203,111 +228,32 @@ static void velodyne_scan_to_pointcloud(
 	scan_props.rightToLeft = true;
 	// The LUT contains sin/cos values for angles in this order: [180deg ... 0 deg ... -180 deg]
 	const CSinCosLookUpTableFor2DScans::TSinCosValues & lut_sincos = velodyne_sincos_tables.getSinCosForScan(scan_props);
-
-	const int minAzimuth_int = round( params.minAzimuth_deg * 100 );
-	const int maxAzimuth_int = round( params.maxAzimuth_deg * 100 );
-	const float realMinDist = std::max(static_cast<float>(scan.minRange),params.minDistance);
-	const float realMaxDist = std::min(params.maxDistance,static_cast<float>(scan.maxRange));
-	const int16_t isolatedPointsFilterDistance_units = params.isolatedPointsFilterDistance/CObservationVelodyneScan::DISTANCE_RESOLUTION;
-
-	// This is: 16,32,64 depending on the LIDAR model
-	const size_t num_lasers = scan.calibration.laser_corrections.size();
-
-	for (size_t iPkt = 0; iPkt<scan.scan_packets.size();iPkt++)
+	m_lut_cos = &lut_sincos.ccos[0];
+	m_lut_sin = &lut_sincos.csin[0];
+
+	// Per-laser calibration:
+	m_distance_correction.resize(num_lasers);
+	m_cos_vert.resize(num_lasers);
+	m_sin_vert.resize(num_lasers);
+	m_horz_offset.resize(num_lasers);
+	m_vert_offset.resize(num_lasers);
+	for (size_t i=0;i<num_lasers;i++)
 	{
-		const CObservationVelodyneScan::TVelodyneRawPacket *raw = &scan.scan_packets[iPkt];
-
-		mrpt::system::TTimeStamp pkt_tim; // Find out timestamp of this pkt
-		{
-			const uint32_t us_pkt0     = scan.scan_packets[0].gps_timestamp;
-			const uint32_t us_pkt_this = raw->gps_timestamp;
-			// Handle the case of time counter reset by new hour 00:00:00
-			const uint32_t us_ellapsed = (us_pkt_this>=us_pkt0) ? (us_pkt_this-us_pkt0) : (1000000UL*3600UL + us_pkt_this-us_pkt0);
-			pkt_tim = mrpt::system::timestampAdd(scan.timestamp,us_ellapsed*1e-6);
-		}
-
-		// Take the median rotational speed as a good value for interpolating the missing azimuths:
-		int median_azimuth_diff;
-		{
-			// In dual return, the azimuth rate is actually twice this estimation:
-			const int nBlocksPerAzimuth = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL) ? 2 : 1;
-			std::vector<int> diffs(CObservationVelodyneScan::BLOCKS_PER_PACKET - nBlocksPerAzimuth);
-			for(int i = 0; i < CObservationVelodyneScan::BLOCKS_PER_PACKET-nBlocksPerAzimuth; ++i) {
-				int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS + raw->blocks[i+nBlocksPerAzimuth].rotation - raw->blocks[i].rotation) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				diffs[i] = localDiff;
-			}
-			std::nth_element(diffs.begin(), diffs.begin() + CObservationVelodyneScan::BLOCKS_PER_PACKET/2, diffs.end()); // Calc median
-			median_azimuth_diff = diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET/2];
-		}
+		m_distance_correction[i] = calib[i].distanceCorrection;
+		m_cos_vert[i] = calib[i].cosVertCorrection;
+		m_sin_vert[i] = calib[i].sinVertCorrection;
+		m_horz_offset[i] = calib[i].horizontalOffsetCorrection;
+		m_vert_offset[i] = calib[i].verticalOffsetCorrection;
+	}
 
-		for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET; block++)  // Firings per packet
+	// Azimuth correction: correct for the laser rotation as a function of timing during the firings.
+	// Only laser IDs 0-31 of the upper bank need an adjustment (and only for VLP-16 and HDL-32), so laserId=dsr here.
+	for (int dual=0;dual<2;dual++)
+	{
+		for (int block=0;block<BLOCKS_PER_PACKET;block++)
 		{
-			// ignore packets with mangled or otherwise different contents
-			if ((num_lasers!=64 && CObservationVelodyneScan::UPPER_BANK != raw->blocks[block].header) ||
-				(raw->blocks[block].header!=CObservationVelodyneScan::UPPER_BANK && raw->blocks[block].header!=CObservationVelodyneScan::LOWER_BANK) )
+			for (int dsr=0;dsr<SCANS_PER_BLOCK;dsr++)
 			{
-				cerr << "[CObservationVelodyneScan] skipping invalid packet: block " << block << " header value is " << raw->blocks[block].header;
-				continue;
-			}
-
-			const int dsr_offset = (raw->blocks[block].header==CObservationVelodyneScan::LOWER_BANK) ? 32:0;
-			const float azimuth_raw_f = (float)(raw->blocks[block].rotation);
-			const bool block_is_dual_2nd_ranges  = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL && ((block & 0x01)!=0));
-			const bool block_is_dual_last_ranges = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL && ((block & 0x01)==0));
-
-			for (int dsr=0,k=0; dsr < SCANS_PER_FIRING; dsr++, k++)
-			{
-				if (!raw->blocks[block].laser_returns[k].distance) // Invalid return?
-					continue;
-
-				const uint8_t rawLaserId = static_cast<uint8_t>(dsr + dsr_offset);
-				uint8_t laserId = rawLaserId;
-
-				// Detect VLP-16 data and adjust laser id if necessary
-				bool firingWithinBlock = false;
-				if(num_lasers==16) {
-					if(laserId >= 16) {
-						laserId -= 16;
-						firingWithinBlock = true;
-					}
-				}
-
-				ASSERT_BELOW_(laserId,num_lasers)
-				const mrpt::obs::VelodyneCalibration::PerLaserCalib &calib = scan.calibration.laser_corrections[laserId];
-
-				// In dual return, if the distance is equal in both ranges, ignore one of them:
-				if (block_is_dual_2nd_ranges) {
-					if (raw->blocks[block].laser_returns[k].distance == raw->blocks[block-1].laser_returns[k].distance)
-						continue; // duplicated point
-					if (!params.dualKeepStrongest)
-						continue;
-				}
-				if (block_is_dual_last_ranges && !params.dualKeepLast)
-					continue;
-
-				// Return distance:
-				const float distance = raw->blocks[block].laser_returns[k].distance * CObservationVelodyneScan::DISTANCE_RESOLUTION + calib.distanceCorrection;
-				if (distance<realMinDist || distance>realMaxDist)
-					continue;
-
-				// Isolated points filtering:
-				if (params.filterOutIsolatedPoints) {
-					bool pass_filter = true;
-					const int16_t dist_this = raw->blocks[block].laser_returns[k].distance;
-					if (k>0) {
-						const int16_t dist_prev = raw->blocks[block].laser_returns[k-1].distance;
-						if (!dist_prev || std::abs(dist_this-dist_prev)>isolatedPointsFilterDistance_units)
-							pass_filter=false;
-					}
-					if (k<(SCANS_PER_FIRING-1)) {
-						const int16_t dist_next = raw->blocks[block].laser_returns[k+1].distance;
-						if (!dist_next || std::abs(dist_this-dist_next)>isolatedPointsFilterDistance_units)
-							pass_filter=false;
-					}
-					if (!pass_filter) continue; // Filter out this point
-				}
-
-				// Azimuth correction: correct for the laser rotation as a function of timing during the firings
 				double timestampadjustment = 0.0; // [us] since beginning of scan
 				double blockdsr0 = 0.0;
 				double nextblockdsr0 = 1.0;
@@ -316,13 +262,13 @@ static void velodyne_scan_to_pointcloud(
 				// VLP-16
 				case 16:
 					{
-						if (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL) {
-							timestampadjustment = VLP16AdjustTimeStamp(block/2, laserId, firingWithinBlock);
+						if (dual) {
+							timestampadjustment = VLP16AdjustTimeStamp(block/2, dsr, 0);
 							nextblockdsr0 = VLP16AdjustTimeStamp(block/2+1,0,0);
 							blockdsr0 = VLP16AdjustTimeStamp(block/2,0,0);
 						}
 						else {
-							timestampadjustment = VLP16AdjustTimeStamp(block, laserId, firingWithinBlock);
+							timestampadjustment = VLP16AdjustTimeStamp(block, dsr, 0);
 							nextblockdsr0 = VLP16AdjustTimeStamp(block+1,0,0);
 							blockdsr0 = VLP16AdjustTimeStamp(block,0,0);
 						}
@@ -334,96 +280,296 @@ static void velodyne_scan_to_pointcloud(
 					nextblockdsr0 = HDL32AdjustTimeStamp(block+1,0);
 					blockdsr0 = HDL32AdjustTimeStamp(block,0);
 					break;
-				case 64:
+				default:
 					break;
-				default: {
-					THROW_EXCEPTION("Error: unhandled LIDAR model!")
-					}
 				};
+				m_azimuth_adjust[dual][block][dsr] = (timestampadjustment - blockdsr0) / (nextblockdsr0 - blockdsr0);
+			}
+		}
+	}
+
+	MRPT_END
+}
 
-				const int azimuthadjustment = mrpt::utils::round( median_azimuth_diff * ((timestampadjustment - blockdsr0) / (nextblockdsr0 - blockdsr0)));
+size_t CObservationVelodyneScan::TPointCloudDecoder::decodePacket(
+	const CObservationVelodyneScan &scan,
+	size_t packet_idx,
+	TPointCloud &out_pc,
+	const TGeneratePointCloudParameters &params) const
+{
+	// Initially based on code from ROS velodyne & from vtkVelodyneHDLReader::vtkInternal::ProcessHDLPacket(). 
+	using mrpt::utils::round;
 
-				const float azimuth_corrected_f = azimuth_raw_f + azimuthadjustment;
-				const int azimuth_corrected = ((int)round(azimuth_corrected_f)) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
+	ASSERTMSG_(m_lut_cos!=NULL && m_calib.size()==scan.calibration.laser_corrections.size(), "setup() must be called before decodePacket()")
+	ASSERT_BELOW_(packet_idx,scan.scan_packets.size())
 
-				// Filter by azimuth:
-				if (!((minAzimuth_int < maxAzimuth_int && azimuth_corrected >= minAzimuth_int && azimuth_corrected <= maxAzimuth_int )
-					||(minAzimuth_int > maxAzimuth_int && (azimuth_corrected <= maxAzimuth_int || azimuth_corrected >= minAzimuth_int))))
-					continue;
+	const int minAzimuth_int = round( params.minAzimuth_deg * 100 );
+	const int maxAzimuth_int = round( params.maxAzimuth_deg * 100 );
+	const float realMinDist = std::max(static_cast<float>(scan.minRange),params.minDistance);
+	const float realMaxDist = std::min(params.maxDistance,static_cast<float>(scan.maxRange));
+	const int16_t isolatedPointsFilterDistance_units = params.isolatedPointsFilterDistance/CObservationVelodyneScan::DISTANCE_RESOLUTION;
 
-				// Vertical axis mis-alignment calibration:
-				const float cos_vert_angle = calib.cosVertCorrection;
-				const float sin_vert_angle = calib.sinVertCorrection;
-				const float horz_offset = calib.horizontalOffsetCorrection;
-				const float vert_offset = calib.verticalOffsetCorrection;
-
-				float xy_distance = distance * cos_vert_angle; 
-				if (vert_offset) xy_distance+= vert_offset * sin_vert_angle;
-
-				const int azimuth_corrected_for_lut = (azimuth_corrected + (CObservationVelodyneScan::ROTATION_MAX_UNITS/2))%CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				const float cos_azimuth = lut_sincos.ccos[azimuth_corrected_for_lut];
-				const float sin_azimuth = lut_sincos.csin[azimuth_corrected_for_lut];
-
-				// Compute raw position
-				const mrpt::math::TPoint3Df pt(
-					xy_distance * cos_azimuth + horz_offset * sin_azimuth, // MRPT +X = Velodyne +Y
-					-(xy_distance * sin_azimuth - horz_offset * cos_azimuth), // MRPT +Y = Velodyne -X
-					distance * sin_vert_angle + vert_offset
-					);
-
-				bool add_point = true;
-				if (params.filterByROI && (
-				 pt.x>params.ROI_x_max || pt.x<params.ROI_x_min ||
-				 pt.y>params.ROI_y_max || pt.y<params.ROI_y_min ||
-				 pt.z>params.ROI_z_max || pt.z<params.ROI_z_min))
-				  add_point=false;
-
-				if (params.filterBynROI && (
-				 pt.x<=params.nROI_x_max && pt.x>=params.nROI_x_min &&
-				 pt.y<=params.nROI_y_max && pt.y>=params.nROI_y_min &&
-				 pt.z<=params.nROI_z_max && pt.z>=params.nROI_z_min))
-				  add_point=false;
-
-				if (!add_point)
+	// This is: 16,32,64 depending on the LIDAR model
+	const size_t num_lasers = m_calib.size();
+
+	const CObservationVelodyneScan::TVelodyneRawPacket *raw = &scan.scan_packets[packet_idx];
+	const mrpt::system::TTimeStamp pkt_tim = scan.getPacketTimestamp(packet_idx);
+	const bool is_dual = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL);
+	const size_t old_size = out_pc.size();
+
+	// Take the median rotational speed as a good value for interpolating the missing azimuths:
+	int median_azimuth_diff;
+	{
+		// In dual return, the azimuth rate is actually twice this estimation:
+		const int nBlocksPerAzimuth = is_dual ? 2 : 1;
+		std::vector<int> diffs(CObservationVelodyneScan::BLOCKS_PER_PACKET - nBlocksPerAzimuth);
+		for(int i = 0; i < CObservationVelodyneScan::BLOCKS_PER_PACKET-nBlocksPerAzimuth; ++i) {
+			int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS + raw->blocks[i+nBlocksPerAzimuth].rotation - raw->blocks[i].rotation) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			diffs[i] = localDiff;
+		}
+		std::nth_element(diffs.begin(), diffs.begin() + CObservationVelodyneScan::BLOCKS_PER_PACKET/2, diffs.end()); // Calc median
+		median_azimuth_diff = diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET/2];
+	}
+
+	// Structure-of-arrays buffers with the valid returns of one block, padded up to a multiple of 4:
+	MRPT_ALIGN16 float b_dist[SCANS_PER_FIRING], b_cos_vert[SCANS_PER_FIRING], b_sin_vert[SCANS_PER_FIRING], b_horz_offset[SCANS_PER_FIRING], b_vert_offset[SCANS_PER_FIRING];
+	MRPT_ALIGN16 float b_cos_azimuth[SCANS_PER_FIRING], b_sin_azimuth[SCANS_PER_FIRING];
+	MRPT_ALIGN16 float b_x[SCANS_PER_FIRING], b_y[SCANS_PER_FIRING], b_z[SCANS_PER_FIRING];
+	uint8_t b_intensity[SCANS_PER_FIRING];
+	int     b_azimuth[SCANS_PER_FIRING];
+
+	for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET; block++)  // Firings per packet
+	{
+		const CObservationVelodyneScan::raw_block_t &blk = raw->blocks[block];
+
+		// ignore packets with mangled or otherwise different contents.
+		// (Silently: this may run in worker threads, and a corrupted stream would flood the console)
+		if ((num_lasers!=64 && CObservationVelodyneScan::UPPER_BANK != blk.header) ||
+			(blk.header!=CObservationVelodyneScan::UPPER_BANK && blk.header!=CObservationVelodyneScan::LOWER_BANK) )
+			continue;
+
+		const int dsr_offset = (blk.header==CObservationVelodyneScan::LOWER_BANK) ? 32:0;
+		const float azimuth_raw_f = (float)(blk.rotation);
+		const bool block_is_dual_2nd_ranges  = (is_dual && ((block & 0x01)!=0));
+		const bool block_is_dual_last_ranges = (is_dual && ((block & 0x01)==0));
+		const double *azimuth_adjust = m_azimuth_adjust[is_dual ? 1:0][block];
+
+		// 1st pass: validity filters and gathering of the calibration terms of each valid return:
+		int nPts = 0;
+		for (int dsr=0,k=0; dsr < SCANS_PER_FIRING; dsr++, k++)
+		{
+			if (!blk.laser_returns[k].distance) // Invalid return?
+				continue;
+
+			// In 16 and 32 laser models only the upper bank is accepted, so laserId=dsr is always valid here:
+			const uint8_t laserId = static_cast<uint8_t>(dsr + dsr_offset);
+
+			// In dual return, if the distance is equal in both ranges, ignore one of them:
+			if (block_is_dual_2nd_ranges) {
+				if (blk.laser_returns[k].distance == raw->blocks[block-1].laser_returns[k].distance)
+					continue; // duplicated point
+				if (!params.dualKeepStrongest)
 					continue;
+			}
+			if (block_is_dual_last_ranges && !params.dualKeepLast)
+				continue;
+
+			// Return distance:
+			const float distance = blk.laser_returns[k].distance * CObservationVelodyneScan::DISTANCE_RESOLUTION + m_distance_correction[laserId];
+			if (distance<realMinDist || distance>realMaxDist)
+				continue;
 
-				// Insert point:
-				out_pc.add_point(pt.x,pt.y,pt.z, raw->blocks[block].laser_returns[k].intensity,pkt_tim, azimuth_corrected_f);
+			// Isolated points filtering:
+			if (params.filterOutIsolatedPoints) {
+				bool pass_filter = true;
+				const int16_t dist_this = blk.laser_returns[k].distance;
+				if (k>0) {
+					const int16_t dist_prev = blk.laser_returns[k-1].distance;
+					if (!dist_prev || std::abs(dist_this-dist_prev)>isolatedPointsFilterDistance_units)
+						pass_filter=false;
+				}
+				if (k<(SCANS_PER_FIRING-1)) {
+					const int16_t dist_next = blk.laser_returns[k+1].distance;
+					if (!dist_next || std::abs(dist_this-dist_next)>isolatedPointsFilterDistance_units)
+						pass_filter=false;
+				}
+				if (!pass_filter) continue; // Filter out this point
+			}
 
-			} // end for k,dsr=[0,31]
-		} // end for each block [0,11]
-	} // end for each data packet
+			const int azimuthadjustment = round( median_azimuth_diff * azimuth_adjust[dsr] );
+			const float azimuth_corrected_f = azimuth_raw_f + azimuthadjustment;
+			const int azimuth_corrected = ((int)round(azimuth_corrected_f)) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
+
+			// Filter by azimuth:
+			if (!((minAzimuth_int < maxAzimuth_int && azimuth_corrected >= minAzimuth_int && azimuth_corrected <= maxAzimuth_int )
+				||(minAzimuth_int > maxAzimuth_int && (azimuth_corrected <= maxAzimuth_int || azimuth_corrected >= minAzimuth_int))))
+				continue;
+
+			const int azimuth_corrected_for_lut = (azimuth_corrected + (CObservationVelodyneScan::ROTATION_MAX_UNITS/2))%CObservationVelodyneScan::ROTATION_MAX_UNITS;
+
+			b_dist[nPts] = distance;
+			b_cos_vert[nPts] = m_cos_vert[laserId];
+			b_sin_vert[nPts] = m_sin_vert[laserId];
+			b_horz_offset[nPts] = m_horz_offset[laserId];
+			b_vert_offset[nPts] = m_vert_offset[laserId];
+			b_cos_azimuth[nPts] = m_lut_cos[azimuth_corrected_for_lut];
+			b_sin_azimuth[nPts] = m_lut_sin[azimuth_corrected_for_lut];
+			b_intensity[nPts] = blk.laser_returns[k].intensity;
+			b_azimuth[nPts] = azimuth_corrected;
+			nPts++;
+		}
+		if (!nPts)
+			continue;
+
+		// 2nd pass: compute raw positions, in MRPT axes (MRPT +X = Velodyne +Y, MRPT +Y = Velodyne -X):
+		//  xy = dist * cos_vert + vert_offset * sin_vert
+		//  x  = xy * cos_azimuth + horz_offset * sin_azimuth
+		//  y  = -(xy * sin_azimuth - horz_offset * cos_azimuth)
+		//  z  = dist * sin_vert + vert_offset
+#if MRPT_HAS_SSE2
+		for (int i=nPts;i<((nPts+3) & ~0x03);i++)
+			b_dist[i]=b_cos_vert[i]=b_sin_vert[i]=b_horz_offset[i]=b_vert_offset[i]=b_cos_azimuth[i]=b_sin_azimuth[i]=.0f;
+
+		const __m128 sign_mask = _mm_set1_ps(-0.0f);
+		for (int i=0;i<nPts;i+=4)
+		{
+			const __m128 d  = _mm_load_ps(b_dist+i);
+			const __m128 cv = _mm_load_ps(b_cos_vert+i);
+			const __m128 sv = _mm_load_ps(b_sin_vert+i);
+			const __m128 ho = _mm_load_ps(b_horz_offset+i);
+			const __m128 vo = _mm_load_ps(b_vert_offset+i);
+			const __m128 ca = _mm_load_ps(b_cos_azimuth+i);
+			const __m128 sa = _mm_load_ps(b_sin_azimuth+i);
+			const __m128 xy = _mm_add_ps(_mm_mul_ps(d,cv),_mm_mul_ps(vo,sv));
+			_mm_store_ps(b_x+i, _mm_add_ps(_mm_mul_ps(xy,ca),_mm_mul_ps(ho,sa)) );
+			_mm_store_ps(b_y+i, _mm_xor_ps(_mm_sub_ps(_mm_mul_ps(xy,sa),_mm_mul_ps(ho,ca)),sign_mask) );
+			_mm_store_ps(b_z+i, _mm_add_ps(_mm_mul_ps(d,sv),vo) );
+		}
+#else
+		for (int i=0;i<nPts;i++)
+		{
+			const float xy = b_dist[i]*b_cos_vert[i] + b_vert_offset[i]*b_sin_vert[i];
+			b_x[i] = xy * b_cos_azimuth[i] + b_horz_offset[i] * b_sin_azimuth[i];
+			b_y[i] = -(xy * b_sin_azimuth[i] - b_horz_offset[i] * b_cos_azimuth[i]);
+			b_z[i] = b_dist[i] * b_sin_vert[i] + b_vert_offset[i];
+		}
+#endif
+
+		// 3rd pass: ROI filters and insertion:
+		for (int i=0;i<nPts;i++)
+		{
+			const float x=b_x[i], y=b_y[i], z=b_z[i];
+			if (params.filterByROI && (
+			 x>params.ROI_x_max || x<params.ROI_x_min ||
+			 y>params.ROI_y_max || y<params.ROI_y_min ||
+			 z>params.ROI_z_max || z<params.ROI_z_min))
+			  continue;
+
+			if (params.filterBynROI && (
+			 x<=params.nROI_x_max && x>=params.nROI_x_min &&
+			 y<=params.nROI_y_max && y>=params.nROI_y_min &&
+			 z<=params.nROI_z_max && z>=params.nROI_z_min))
+			  continue;
+
+			// Insert point:
+			out_pc.x.push_back(x);
+			out_pc.y.push_back(y);
+			out_pc.z.push_back(z);
+			out_pc.intensity.push_back(b_intensity[i]);
+			if (params.generatePerPointTimestamp)
+				out_pc.timestamp.push_back(pkt_tim);
+			if (params.generatePerPointAzimuth)
+				out_pc.azimuth.push_back(b_azimuth[i] * ROTATION_RESOLUTION);
+		}
+	} // end for each block [0,11]
+
+	return out_pc.size()-old_size;
 }
 
+void CObservationVelodyneScan::TPointCloudDecoder::decodeScan(const CObservationVelodyneScan &scan, TPointCloud &out_pc, const TGeneratePointCloudParameters &params)
+{
+	out_pc.clear();
+	this->setup(scan);
+
+	// Pre-alloc mem for the worst case:
+	const size_t max_pts = scan.scan_packets.size() * BLOCKS_PER_PACKET * SCANS_PER_FIRING;
+	out_pc.x.reserve(max_pts);
+	out_pc.y.reserve(max_pts);
+	out_pc.z.reserve(max_pts);
+	out_pc.intensity.reserve(max_pts);
+	if (params.generatePerPointTimestamp) out_pc.timestamp.reserve(max_pts);
+	if (params.generatePerPointAzimuth)   out_pc.azimuth.reserve(max_pts);
+
+	for (size_t iPkt = 0; iPkt<scan.scan_packets.size();iPkt++)
+		this->decodePacket(scan,iPkt,out_pc,params);
+}
 
 void CObservationVelodyneScan::generatePointCloud(const TGeneratePointCloudParameters &params)
 {
-	struct PointCloudStorageWrapper_Inner : public PointCloudStorageWrapper {
-		CObservationVelodyneScan & me_;
-		const TGeneratePointCloudParameters &params_;
-		PointCloudStorageWrapper_Inner(CObservationVelodyneScan &me, const TGeneratePointCloudParameters &p) : me_(me), params_(p) {
-			// Reset point cloud:
-			me_.point_cloud.clear();
-		}
-		void add_point(double pt_x,double pt_y, double pt_z,uint8_t pt_intensity, const mrpt::system::TTimeStamp &tim, const float azimuth) MRPT_OVERRIDE {
-			me_.point_cloud.x.push_back( pt_x );
-			me_.point_cloud.y.push_back( pt_y );
-			me_.point_cloud.z.push_back( pt_z );
-			me_.point_cloud.intensity.push_back( pt_intensity );
-			if (params_.generatePerPointTimestamp) {
-				me_.point_cloud.timestamp.push_back(tim);
-			}
-			if (params_.generatePerPointAzimuth) {
-				const int azimuth_corrected = ((int)round(azimuth)) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				me_.point_cloud.azimuth.push_back(azimuth_corrected * ROTATION_RESOLUTION);
-			}
-		}
+	TPointCloudDecoder decoder;
+	decoder.decodeScan(*this,point_cloud,params);
+}
+
+namespace
+{
+	// Data shared by the worker threads of generatePointCloudAlongSE3Trajectory():
+	struct TSE3TrajectoryThreadsData
+	{
+		const CObservationVelodyneScan *me;
+		const CObservationVelodyneScan::TPointCloudDecoder *decoder;
+		const mrpt::poses::CPose3DInterpolator *vehicle_path;
+		const CObservationVelodyneScan::TGeneratePointCloudParameters *params;
+		const mrpt::system::TTimeStamp *unique_tims;    //!< Distinct packet timestamps, sorted
+		mrpt::poses::CPose3D *sensor_poses;             //!< Global sensor pose for each unique_tims[i]...
+		uint8_t *sensor_pose_valid;                     //!< ... and whether it could be interpolated.
+		const size_t *pkt_pose_idx;                     //!< Index in unique_tims[] for each packet
+		std::vector<mrpt::math::TPointXYZIu8> *thread_points; //!< Output points of each thread (block of packets)
+		CObservationVelodyneScan::TGeneratePointCloudSE3Results *thread_stats;
 	};
 
-	PointCloudStorageWrapper_Inner my_pc_wrap(*this, params);
+	// Worker (for mrpt::system::parallelForBlocks) interpolating the sensor pose for a block of timestamps.
+	void interpolateSensorPosesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TSE3TrajectoryThreadsData &d = *static_cast<const TSE3TrajectoryThreadsData*>(user_param);
+		mrpt::poses::CPose3D vehicle_pose;
+		for (size_t i=first;i<last;i++)
+		{
+			bool valid_pose;
+			d.vehicle_path->interpolate(d.unique_tims[i],vehicle_pose,valid_pose);
+			d.sensor_pose_valid[i] = valid_pose ? 1:0;
+			if (valid_pose)
+				d.sensor_poses[i].composeFrom(vehicle_pose, d.me->sensorPose);
+		}
+	}
 
-	velodyne_scan_to_pointcloud(*this,params, my_pc_wrap);
+	// Worker (for mrpt::system::parallelForBlocks) decoding and transforming a block of consecutive packets.
+	void transformPacketsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		const TSE3TrajectoryThreadsData &d = *static_cast<const TSE3TrajectoryThreadsData*>(user_param);
+		std::vector<mrpt::math::TPointXYZIu8> &out_points = d.thread_points[thread_idx];
+		CObservationVelodyneScan::TGeneratePointCloudSE3Results &stats = d.thread_stats[thread_idx];
 
+		out_points.reserve((last-first) * CObservationVelodyneScan::BLOCKS_PER_PACKET * CObservationVelodyneScan::SCANS_PER_BLOCK);
+		CObservationVelodyneScan::TPointCloud pkt_pc;
+		for (size_t iPkt=first;iPkt<last;iPkt++)
+		{
+			pkt_pc.clear();
+			const size_t nPts = d.decoder->decodePacket(*d.me,iPkt,pkt_pc,*d.params);
+			stats.num_points += nPts;
+			const size_t pose_idx = d.pkt_pose_idx[iPkt];
+			if (!nPts || !d.sensor_pose_valid[pose_idx]) continue;
+
+			const mrpt::poses::CPose3D &global_sensor_pose = d.sensor_poses[pose_idx];
+			for (size_t i=0;i<nPts;i++)
+			{
+				double gx,gy,gz;
+				global_sensor_pose.composePoint(pkt_pc.x[i],pkt_pc.y[i],pkt_pc.z[i], gx,gy,gz);
+				out_points.push_back( mrpt::math::TPointXYZIu8(gx,gy,gz,pkt_pc.intensity[i]) );
+			}
+			stats.num_correctly_inserted_points += nPts;
+		}
+	}
 }
 
 void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
@@ -435,41 +581,79 @@ void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
 	// Pre-alloc mem:
 	out_points.reserve( out_points.size() + scan_packets.size() * BLOCKS_PER_PACKET * SCANS_PER_BLOCK + 16);
 
-	struct PointCloudStorageWrapper_SE3_Interp : public PointCloudStorageWrapper {
-		CObservationVelodyneScan & me_;
-		const mrpt::poses::CPose3DInterpolator & vehicle_path_;
-		std::vector<mrpt::math::TPointXYZIu8>      & out_points_;
-		TGeneratePointCloudSE3Results &results_stats_;
-		mrpt::system::TTimeStamp last_query_tim_;
-		mrpt::poses::CPose3D last_query_;
-		bool last_query_valid_;
-
-		PointCloudStorageWrapper_SE3_Interp(CObservationVelodyneScan &me,const mrpt::poses::CPose3DInterpolator & vehicle_path,std::vector<mrpt::math::TPointXYZIu8> & out_points,TGeneratePointCloudSE3Results &results_stats) : 
-			me_(me),vehicle_path_(vehicle_path),out_points_(out_points),results_stats_(results_stats),last_query_tim_(INVALID_TIMESTAMP),last_query_valid_(false) 
+	TPointCloudDecoder decoder;
+	decoder.setup(*this);
+
+	if (params.numThreads!=1)
+	{
+		const size_t nPkts = scan_packets.size();
+		if (!nPkts) return;
+
+		// Packets sharing a timestamp share the interpolated pose, so only distinct timestamps are interpolated:
+		std::vector<mrpt::system::TTimeStamp> pkt_tims(nPkts);
+		for (size_t i=0;i<nPkts;i++)
+			pkt_tims[i] = getPacketTimestamp(i);
+		std::vector<mrpt::system::TTimeStamp> unique_tims(pkt_tims);
+		std::sort(unique_tims.begin(),unique_tims.end());
+		unique_tims.erase(std::unique(unique_tims.begin(),unique_tims.end()),unique_tims.end());
+		std::vector<size_t> pkt_pose_idx(nPkts);
+		for (size_t i=0;i<nPkts;i++)
+			pkt_pose_idx[i] = std::lower_bound(unique_tims.begin(),unique_tims.end(),pkt_tims[i]) - unique_tims.begin();
+
+		const unsigned int nThreads = params.numThreads ? params.numThreads : mrpt::system::getNumberOfProcessors();
+		std::vector<mrpt::poses::CPose3D> sensor_poses(unique_tims.size());
+		std::vector<uint8_t> sensor_pose_valid(unique_tims.size());
+		std::vector<std::vector<mrpt::math::TPointXYZIu8> > thread_points(nThreads);
+		std::vector<TGeneratePointCloudSE3Results> thread_stats(nThreads);
+
+		TSE3TrajectoryThreadsData data;
+		data.me = this;
+		data.decoder = &decoder;
+		data.vehicle_path = &vehicle_path;
+		data.params = &params;
+		data.unique_tims = &unique_tims[0];
+		data.sensor_poses = &sensor_poses[0];
+		data.sensor_pose_valid = &sensor_pose_valid[0];
+		data.pkt_pose_idx = &pkt_pose_idx[0];
+		data.thread_points = &thread_points[0];
+		data.thread_stats = &thread_stats[0];
+
+		mrpt::system::parallelForBlocks(unique_tims.size(), &interpolateSensorPosesBlock, &data, nThreads);
+		mrpt::system::parallelForBlocks(nPkts, &transformPacketsBlock, &data, nThreads);
+
+		// Blocks are contiguous ranges of packets, in thread order:
+		for (unsigned int t=0;t<nThreads;t++)
 		{
+			out_points.insert(out_points.end(),thread_points[t].begin(),thread_points[t].end());
+			results_stats.num_points += thread_stats[t].num_points;
+			results_stats.num_correctly_inserted_points += thread_stats[t].num_correctly_inserted_points;
 		}
-		void add_point(double pt_x,double pt_y, double pt_z,uint8_t pt_intensity, const mrpt::system::TTimeStamp &tim, const float azimuth) MRPT_OVERRIDE
-		{
-			// Use a cache since it's expected that the same timestamp is queried several times in a row:
-			if (last_query_tim_!=tim) {
-				last_query_tim_ = tim;
-				vehicle_path_.interpolate(tim,last_query_,last_query_valid_);
-			}
+		return;
+	}
 
-			if (last_query_valid_) {
-				mrpt::poses::CPose3D  global_sensor_pose(mrpt::poses::UNINITIALIZED_POSE);
-				global_sensor_pose.composeFrom(last_query_, me_.sensorPose);
-				double gx,gy,gz;
-				global_sensor_pose.composePoint(pt_x,pt_y,pt_z, gx,gy,gz);
-				out_points_.push_back( mrpt::math::TPointXYZIu8(gx,gy,gz,pt_intensity) );
-				++results_stats_.num_correctly_inserted_points;
-			}
-			++results_stats_.num_points;
+	TPointCloud pkt_pc;
+	mrpt::poses::CPose3D vehicle_pose, global_sensor_pose(mrpt::poses::UNINITIALIZED_POSE);
+	for (size_t iPkt = 0; iPkt<scan_packets.size();iPkt++)
+	{
+		pkt_pc.clear();
+		const size_t nPts = decoder.decodePacket(*this,iPkt,pkt_pc,params);
+		if (!nPts) continue;
+		results_stats.num_points += nPts;
+
+		// All points in one packet share the same timestamp, so the vehicle pose is interpolated only once:
+		bool valid_pose;
+		vehicle_path.interpolate(getPacketTimestamp(iPkt),vehicle_pose,valid_pose);
+		if (!valid_pose) continue;
+
+		global_sensor_pose.composeFrom(vehicle_pose, sensorPose);
+		for (size_t i=0;i<nPts;i++)
+		{
+			double gx,gy,gz;
+			global_sensor_pose.composePoint(pkt_pc.x[i],pkt_pc.y[i],pkt_pc.z[i], gx,gy,gz);
+			out_points.push_back( mrpt::math::TPointXYZIu8(gx,gy,gz,pkt_pc.intensity[i]) );
 		}
-	};
-
-	PointCloudStorageWrapper_SE3_Interp my_pc_wrap(*this,vehicle_path,out_points,results_stats);
-	velodyne_scan_to_pointcloud(*this,params, my_pc_wrap);
+		results_stats.num_correctly_inserted_points += nPts;
+	}
 }
 
 void CObservationVelodyneScan::TPointCloud::clear()
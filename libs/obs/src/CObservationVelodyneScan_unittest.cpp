@@ -0,0 +1,340 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/random.h>
+#include <mrpt/utils/bits.h>
+#include <mrpt/utils/round.h>
+#include <mrpt/system/datetime.h>
+
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace std;
+
+namespace
+{
+	typedef CObservationVelodyneScan::TPointCloud TPointCloud;
+
+	// Builds a scan with NUM_PKTS synthetic packets covering (roughly) a full turn, with random ranges.
+	// The azimuth step (77 units) is coprime with the timing ratios of the firings, so the interpolated
+	// azimuth of a return never lies exactly halfway between two units, where rounding would be ambiguous.
+	void createTestScan(CObservationVelodyneScan &scan, const std::string &model, uint8_t return_mode)
+	{
+		const size_t NUM_PKTS = 40;
+		mrpt::random::CRandomGenerator rnd(1234);
+
+		scan.calibration = VelodyneCalibration::LoadDefaultCalibration(model);
+		ASSERT_FALSE(scan.calibration.empty());
+		scan.minRange = 1.0;
+		scan.maxRange = 100.0;
+		scan.timestamp = mrpt::system::now();
+		scan.scan_packets.resize(NUM_PKTS);
+
+		const bool dual = (return_mode==CObservationVelodyneScan::RETMODE_DUAL);
+		for (size_t p=0;p<NUM_PKTS;p++)
+		{
+			CObservationVelodyneScan::TVelodyneRawPacket &pkt = scan.scan_packets[p];
+			pkt.gps_timestamp = (3599990000UL + p*550) % 3600000000UL; // The hour counter wraps around within this scan
+			pkt.laser_return_mode = return_mode;
+			pkt.velodyne_model_ID = 0;
+			for (int b=0;b<CObservationVelodyneScan::BLOCKS_PER_PACKET;b++)
+			{
+				CObservationVelodyneScan::raw_block_t &blk = pkt.blocks[b];
+				const int az_idx = dual ? (p*CObservationVelodyneScan::BLOCKS_PER_PACKET + b)/2 : p*CObservationVelodyneScan::BLOCKS_PER_PACKET + b;
+				blk.header = CObservationVelodyneScan::UPPER_BANK;
+				blk.rotation = (az_idx * 77) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
+				for (int k=0;k<CObservationVelodyneScan::SCANS_PER_BLOCK;k++)
+				{
+					// Some invalid returns, and some repeated ones in dual mode:
+					const bool invalid = rnd.drawUniform32bit()%10==0;
+					blk.laser_returns[k].distance = invalid ? 0 : static_cast<uint16_t>( rnd.drawUniform(0.5,60.0)/CObservationVelodyneScan::DISTANCE_RESOLUTION );
+					blk.laser_returns[k].intensity = static_cast<uint8_t>(rnd.drawUniform32bit() & 0xff);
+					if (dual && (b & 0x01)!=0 && rnd.drawUniform32bit()%3==0)
+						blk.laser_returns[k].distance = pkt.blocks[b-1].laser_returns[k].distance;
+				}
+			}
+		}
+	}
+
+	// Straightforward (and slow) decoder used as ground truth, written after the sensors documentation and independent of
+	// CObservationVelodyneScan::TPointCloudDecoder. As in the latter, only the first 16 returns of each block are decoded.
+	// Supported parameters: min/max azimuth, isolated points and dual return filters.
+	void referenceDecodeScan(const CObservationVelodyneScan &scan, const CObservationVelodyneScan::TGeneratePointCloudParameters &params, TPointCloud &pc)
+	{
+		const int RETURNS_PER_BLOCK = 16;
+		const int ROT_UNITS = CObservationVelodyneScan::ROTATION_MAX_UNITS;
+		const size_t num_lasers = scan.calibration.laser_corrections.size();
+		ASSERT_TRUE(num_lasers==16 || num_lasers==32);
+
+		// Firing timing [us]: VLP-16: 110.592 per block (sequence of 16 firings) and 2.304 per laser. HDL-32: 46.08 per block and 1.152 per laser.
+		// Along a block, the azimuth is linearly interpolated from the laser firing time.
+		const double block_duration = (num_lasers==16) ? 110.592 : 46.08;
+		const double laser_delay    = (num_lasers==16) ? 2.304 : 1.152;
+
+		const double minDist = std::max<double>(scan.minRange, params.minDistance), maxDist = std::min<double>(scan.maxRange, params.maxDistance);
+		const int minAz = mrpt::utils::round(params.minAzimuth_deg*100), maxAz = mrpt::utils::round(params.maxAzimuth_deg*100);
+		const int isolated_thres = static_cast<int>(params.isolatedPointsFilterDistance/CObservationVelodyneScan::DISTANCE_RESOLUTION);
+
+		pc.clear();
+		for (size_t p=0;p<scan.scan_packets.size();p++)
+		{
+			const CObservationVelodyneScan::TVelodyneRawPacket &pkt = scan.scan_packets[p];
+			const bool dual = (pkt.laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL);
+
+			// The GPS timestamp (microseconds since the beginning of the hour) wraps around every hour:
+			const uint32_t t0 = scan.scan_packets[0].gps_timestamp;
+			const uint32_t elapsed_us = (pkt.gps_timestamp>=t0) ? pkt.gps_timestamp-t0 : 3600000000UL+pkt.gps_timestamp-t0;
+			const mrpt::system::TTimeStamp pkt_tim = mrpt::system::timestampAdd(scan.timestamp, elapsed_us*1e-6);
+
+			// Azimuth increment between consecutive firing sequences: median of those in the packet
+			const int nBlocksPerAzimuth = dual ? 2:1;
+			std::vector<int> az_incrs;
+			for (int b=0;b+nBlocksPerAzimuth<CObservationVelodyneScan::BLOCKS_PER_PACKET;b++)
+				az_incrs.push_back( (ROT_UNITS + pkt.blocks[b+nBlocksPerAzimuth].rotation - pkt.blocks[b].rotation) % ROT_UNITS );
+			std::sort(az_incrs.begin(),az_incrs.end());
+			const int az_incr = az_incrs[CObservationVelodyneScan::BLOCKS_PER_PACKET/2];
+
+			for (int b=0;b<CObservationVelodyneScan::BLOCKS_PER_PACKET;b++)
+			{
+				const CObservationVelodyneScan::raw_block_t &blk = pkt.blocks[b];
+				for (int k=0;k<RETURNS_PER_BLOCK;k++)
+				{
+					const int d = blk.laser_returns[k].distance;
+					if (!d) continue;
+					// Dual mode: odd blocks hold the strongest returns, which are dropped if equal to the last ones.
+					if (dual && (b & 0x01) && (d==pkt.blocks[b-1].laser_returns[k].distance || !params.dualKeepStrongest)) continue;
+					if (dual && !(b & 0x01) && !params.dualKeepLast) continue;
+
+					const VelodyneCalibration::PerLaserCalib &calib = scan.calibration.laser_corrections[k];
+					const double r = d*CObservationVelodyneScan::DISTANCE_RESOLUTION + calib.distanceCorrection;
+					if (r<minDist || r>maxDist) continue;
+
+					if (params.filterOutIsolatedPoints)
+					{
+						if (k>0 && (!blk.laser_returns[k-1].distance || std::abs(d-blk.laser_returns[k-1].distance)>isolated_thres)) continue;
+						if (k<RETURNS_PER_BLOCK-1 && (!blk.laser_returns[k+1].distance || std::abs(d-blk.laser_returns[k+1].distance)>isolated_thres)) continue;
+					}
+
+					const int az = (blk.rotation + mrpt::utils::round(az_incr * k*laser_delay/block_duration)) % ROT_UNITS;
+					if (minAz<maxAz ? (az<minAz || az>maxAz) : (az>maxAz && az<minAz)) continue;
+
+					// Azimuth angle, as in the sin/cos look-up table used by CObservationVelodyneScan:
+					// ROT_UNITS values from -180 to +180 degrees, for az=180 to 0, 359.99 to 180.01 degrees.
+					const double ang = -M_PI + ((az+ROT_UNITS/2)%ROT_UNITS) * (2*M_PI/(ROT_UNITS-1));
+					const double xy = r*calib.cosVertCorrection + calib.verticalOffsetCorrection*calib.sinVertCorrection;
+					pc.x.push_back(static_cast<float>( xy*cos(ang) + calib.horizontalOffsetCorrection*sin(ang) )); // MRPT +X = Velodyne +Y
+					pc.y.push_back(static_cast<float>( -xy*sin(ang) + calib.horizontalOffsetCorrection*cos(ang) )); // MRPT +Y = Velodyne -X
+					pc.z.push_back(static_cast<float>( r*calib.sinVertCorrection + calib.verticalOffsetCorrection ));
+					pc.intensity.push_back(blk.laser_returns[k].intensity);
+					if (params.generatePerPointTimestamp) pc.timestamp.push_back(pkt_tim);
+					if (params.generatePerPointAzimuth) pc.azimuth.push_back(az*0.01f);
+				}
+			}
+		}
+	}
+
+	// Compares a decoded cloud against the one from referenceDecodeScan(), up to float rounding errors:
+	void expectCloudMatchesReference(const TPointCloud &pc, const TPointCloud &ref)
+	{
+		ASSERT_EQ(pc.size(),ref.size());
+		ASSERT_EQ(pc.timestamp.size(),ref.timestamp.size());
+		ASSERT_EQ(pc.azimuth.size(),ref.azimuth.size());
+		for (size_t i=0;i<ref.size();i++)
+		{
+			EXPECT_NEAR(pc.x[i],ref.x[i],1e-3) << "Point #" << i;
+			EXPECT_NEAR(pc.y[i],ref.y[i],1e-3) << "Point #" << i;
+			EXPECT_NEAR(pc.z[i],ref.z[i],1e-3) << "Point #" << i;
+			EXPECT_EQ(pc.intensity[i],ref.intensity[i]) << "Point #" << i;
+		}
+		EXPECT_TRUE(pc.timestamp==ref.timestamp);
+		for (size_t i=0;i<ref.azimuth.size();i++)
+			EXPECT_NEAR(pc.azimuth[i],ref.azimuth[i],1e-4) << "Point #" << i;
+	}
+
+	void expectEqualClouds(const TPointCloud &a, const TPointCloud &b)
+	{
+		ASSERT_EQ(a.size(),b.size());
+		EXPECT_TRUE(a.x==b.x);
+		EXPECT_TRUE(a.y==b.y);
+		EXPECT_TRUE(a.z==b.z);
+		EXPECT_TRUE(a.intensity==b.intensity);
+		EXPECT_TRUE(a.timestamp==b.timestamp);
+		EXPECT_TRUE(a.azimuth==b.azimuth);
+	}
+
+	// generatePointCloud() must match the reference decoder, and decoding packet by packet must give the same cloud, in the same order.
+	void testDecodePerPacket(const std::string &model, uint8_t return_mode)
+	{
+		CObservationVelodyneScan scan;
+		createTestScan(scan,model,return_mode);
+
+		CObservationVelodyneScan::TGeneratePointCloudParameters params;
+		params.generatePerPointTimestamp = true;
+		params.generatePerPointAzimuth = true;
+		params.filterOutIsolatedPoints = true;
+		params.minAzimuth_deg = 270.0;
+		params.maxAzimuth_deg = 90.0;
+
+		scan.generatePointCloud(params);
+		EXPECT_GT(scan.point_cloud.size(),0u);
+
+		TPointCloud pc_ref;
+		referenceDecodeScan(scan,params,pc_ref);
+		expectCloudMatchesReference(scan.point_cloud,pc_ref);
+
+		CObservationVelodyneScan::TPointCloudDecoder decoder;
+		decoder.setup(scan);
+		TPointCloud pc_all, pc_pkt;
+		for (size_t i=0;i<scan.scan_packets.size();i++)
+		{
+			pc_pkt.clear();
+			const size_t n = decoder.decodePacket(scan,i,pc_pkt,params);
+			EXPECT_EQ(n,pc_pkt.size());
+			for (size_t j=0;j<n;j++) {
+				EXPECT_EQ(pc_pkt.timestamp[j],scan.getPacketTimestamp(i));
+				pc_all.x.push_back(pc_pkt.x[j]);
+				pc_all.y.push_back(pc_pkt.y[j]);
+				pc_all.z.push_back(pc_pkt.z[j]);
+				pc_all.intensity.push_back(pc_pkt.intensity[j]);
+				pc_all.timestamp.push_back(pc_pkt.timestamp[j]);
+				pc_all.azimuth.push_back(pc_pkt.azimuth[j]);
+			}
+		}
+		expectEqualClouds(scan.point_cloud,pc_all);
+	}
+}
+
+TEST(CObservationVelodyneScan, DecodePerPacketVLP16)
+{
+	testDecodePerPacket("VLP16",CObservationVelodyneScan::RETMODE_STRONGEST);
+	testDecodePerPacket("VLP16",CObservationVelodyneScan::RETMODE_DUAL);
+}
+
+TEST(CObservationVelodyneScan, DecodePerPacketHDL32)
+{
+	testDecodePerPacket("HDL32",CObservationVelodyneScan::RETMODE_STRONGEST);
+}
+
+TEST(CObservationVelodyneScan, MatchesReferenceDecoder)
+{
+	const char* models[] = {"VLP16","HDL32"};
+	const uint8_t modes[] = {CObservationVelodyneScan::RETMODE_STRONGEST, CObservationVelodyneScan::RETMODE_DUAL};
+	for (int m=0;m<2;m++)
+		for (int r=0;r<2;r++)
+			for (int keep_last=0;keep_last<2;keep_last++)
+			{
+				CObservationVelodyneScan scan;
+				createTestScan(scan,models[m],modes[r]);
+
+				CObservationVelodyneScan::TGeneratePointCloudParameters params;
+				params.generatePerPointTimestamp = true;
+				params.generatePerPointAzimuth = true;
+				params.dualKeepLast = keep_last!=0;
+				params.minDistance = 2.0f;
+				scan.generatePointCloud(params);
+
+				TPointCloud pc_ref;
+				referenceDecodeScan(scan,params,pc_ref);
+				EXPECT_GT(pc_ref.size(),0u);
+				SCOPED_TRACE(format("Model: %s, dual: %i, dualKeepLast: %i",models[m],r,keep_last));
+				expectCloudMatchesReference(scan.point_cloud,pc_ref);
+			}
+}
+
+TEST(CObservationVelodyneScan, DecodedPointsGeometry)
+{
+	CObservationVelodyneScan scan;
+	createTestScan(scan,"HDL32",CObservationVelodyneScan::RETMODE_STRONGEST);
+	scan.generatePointCloud();
+
+	// With the default parameters, only invalid returns and those out of range are discarded:
+	size_t num_valid = 0;
+	for (size_t p=0;p<scan.scan_packets.size();p++)
+		for (int b=0;b<CObservationVelodyneScan::BLOCKS_PER_PACKET;b++)
+			for (int k=0;k<16;k++) {
+				const uint16_t d = scan.scan_packets[p].blocks[b].laser_returns[k].distance;
+				const double r = d*CObservationVelodyneScan::DISTANCE_RESOLUTION + scan.calibration.laser_corrections[k].distanceCorrection;
+				if (d && r>=1.0 && r<=100.0) num_valid++;
+			}
+	ASSERT_EQ(scan.point_cloud.size(),num_valid);
+
+	// Ranges are preserved (up to the small sensor offsets):
+	size_t i = 0;
+	for (size_t p=0;p<scan.scan_packets.size();p++)
+		for (int b=0;b<CObservationVelodyneScan::BLOCKS_PER_PACKET;b++)
+			for (int k=0;k<16;k++) {
+				const uint16_t d = scan.scan_packets[p].blocks[b].laser_returns[k].distance;
+				const double r = d*CObservationVelodyneScan::DISTANCE_RESOLUTION + scan.calibration.laser_corrections[k].distanceCorrection;
+				if (!d || r<1.0 || r>100.0) continue;
+				const double pt_r = std::sqrt(mrpt::utils::square(scan.point_cloud.x[i])+mrpt::utils::square(scan.point_cloud.y[i])+mrpt::utils::square(scan.point_cloud.z[i]));
+				EXPECT_NEAR(pt_r,r,0.05);
+				i++;
+			}
+}
+
+TEST(CObservationVelodyneScan, DecoderReuseAcrossModels)
+{
+	CObservationVelodyneScan scan_vlp, scan_hdl;
+	createTestScan(scan_vlp,"VLP16",CObservationVelodyneScan::RETMODE_STRONGEST);
+	createTestScan(scan_hdl,"HDL32",CObservationVelodyneScan::RETMODE_STRONGEST);
+	scan_vlp.generatePointCloud();
+	scan_hdl.generatePointCloud();
+
+	// One decoder for several scans: tables must be rebuilt when the calibration changes.
+	CObservationVelodyneScan::TPointCloudDecoder decoder;
+	TPointCloud pc;
+	decoder.decodeScan(scan_vlp,pc);
+	expectEqualClouds(scan_vlp.point_cloud,pc);
+	decoder.decodeScan(scan_hdl,pc);
+	expectEqualClouds(scan_hdl.point_cloud,pc);
+	decoder.decodeScan(scan_vlp,pc);
+	expectEqualClouds(scan_vlp.point_cloud,pc);
+}
+
+TEST(CObservationVelodyneScan, SE3TrajectoryMultiThreaded)
+{
+	CObservationVelodyneScan scan;
+	createTestScan(scan,"HDL32",CObservationVelodyneScan::RETMODE_STRONGEST);
+	scan.sensorPose = mrpt::poses::CPose3D(0.5,0.1,1.2, 0.1,0.02,-0.01);
+
+	// Vehicle path covering only part of the scan, so some points can not be transformed:
+	mrpt::poses::CPose3DInterpolator path;
+	path.setInterpolationMethod(mrpt::poses::imLinearSlerp);
+	for (int i=0;i<10;i++)
+		path.insert(scan.getPacketTimestamp(scan.scan_packets.size()/3) + i*mrpt::system::secondsToTimestamp(0.01), mrpt::poses::CPose3D(0.3*i,0.05*i,0, 0.01*i,0,0));
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters params;
+	std::vector<mrpt::math::TPointXYZIu8> pts1;
+	CObservationVelodyneScan::TGeneratePointCloudSE3Results stats1;
+	params.numThreads = 1;
+	scan.generatePointCloudAlongSE3Trajectory(path,pts1,stats1,params);
+	EXPECT_GT(stats1.num_correctly_inserted_points,0u);
+	EXPECT_LT(stats1.num_correctly_inserted_points,stats1.num_points);
+	EXPECT_EQ(pts1.size(),stats1.num_correctly_inserted_points);
+
+	for (unsigned int nThreads=0;nThreads<=5;nThreads+=2)
+	{
+		std::vector<mrpt::math::TPointXYZIu8> pts;
+		CObservationVelodyneScan::TGeneratePointCloudSE3Results stats;
+		params.numThreads = nThreads;
+		scan.generatePointCloudAlongSE3Trajectory(path,pts,stats,params);
+		EXPECT_EQ(stats.num_points,stats1.num_points);
+		EXPECT_EQ(stats.num_correctly_inserted_points,stats1.num_correctly_inserted_points);
+		ASSERT_EQ(pts.size(),pts1.size());
+		for (size_t i=0;i<pts.size();i++) {
+			EXPECT_EQ(pts[i].pt.x,pts1[i].pt.x);
+			EXPECT_EQ(pts[i].pt.y,pts1[i].pt.y);
+			EXPECT_EQ(pts[i].pt.z,pts1[i].pt.z);
+			EXPECT_EQ(pts[i].intensity,pts1[i].intensity);
+		}
+	}
+}
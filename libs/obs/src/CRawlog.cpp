@@ -206,6 +206,7 @@ bool  CRawlog::loadFromRawLogFile( const std::string &fileName, bool non_obs_obj
 	// Open for read.
 	CFileGZInputStream fs(fileName);
 	if (!fs.fileOpenCorrectly()) return false;
+	fs.setNumThreads(0); // Block-compressed rawlogs: decompress in parallel
 
 	clear();  // Clear first
 
@@ -293,11 +294,17 @@ bool CRawlog::saveToRawLogFile( const std::string &fileName ) const
 {
 	try
 	{
-		CFileGZOutputStream	f(fileName);
+		CFileGZOutputStream	f;
+#if MRPT_HAS_GZ_STREAMS
+		if (!f.openBlockCompressed(fileName)) return false;
+#else
+		if (!f.open(fileName)) return false;
+#endif
 		if (!m_commentTexts.text.empty())
 			f << m_commentTexts;
 		for (size_t i=0;i<m_seqOfActObs.size();i++)
 			f << *m_seqOfActObs[i];
+		f.close(); // Writes the pending data (and the block index): throws on any error
 		return true;
 	}
 	catch(...)
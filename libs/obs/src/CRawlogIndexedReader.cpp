@@ -0,0 +1,324 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"   // Precompiled headers
+
+#include <mrpt/obs/CRawlogIndexedReader.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/utils/CMemoryStream.h>
+#include <mrpt/utils/CFileInputStream.h>
+#include <mrpt/utils/CFileOutputStream.h>
+#include <mrpt/utils/CFileGZInputStream.h>
+#include <algorithm>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+
+namespace
+{
+	const char     IDX_FILE_MAGIC[]   = "MRPT_RAWLOG_INDEX";
+	const uint32_t IDX_FILE_VERSION   = 0;
+
+	struct TSortByTime
+	{
+		const std::vector<CRawlogIndexedReader::TEntry> &entries;
+		TSortByTime(const std::vector<CRawlogIndexedReader::TEntry> &e) : entries(e) {}
+		bool operator()(size_t a, size_t b) const {
+			return entries[a].timestamp<entries[b].timestamp || (entries[a].timestamp==entries[b].timestamp && a<b);
+		}
+	};
+}
+
+CRawlogIndexedReader::TEntry::TEntry() :
+	offset(0), length(0), timestamp(INVALID_TIMESTAMP)
+{
+}
+
+CRawlogIndexedReader::CRawlogIndexedReader() :
+	m_time_min(INVALID_TIMESTAMP), m_time_max(INVALID_TIMESTAMP), m_time_bucket_width(1)
+{
+}
+
+CRawlogIndexedReader::~CRawlogIndexedReader()
+{
+	close();
+}
+
+std::string CRawlogIndexedReader::getIndexFileName(const std::string &rawlogFileName)
+{
+	return rawlogFileName + std::string(".idx");
+}
+
+bool CRawlogIndexedReader::open(const std::string &fileName, bool useIndexFile)
+{
+	MRPT_START
+
+	close();
+	if (!m_file.open(fileName))
+		return false;
+
+	// gzip magic number: only block-compressed files allow random access.
+	if (m_file.size()>=2 && m_file.data()[0]==0x1f && m_file.data()[1]==0x8b)
+	{
+		CMemoryStream ms;
+		ms.assignMemoryNotOwn(m_file.data(), m_file.size());
+		if (!mrpt::compress::zip::read_gz_block_index(ms, m_gz_blocks) || !m_gz_blocks.size())
+		{
+			std::cerr << "[CRawlogIndexedReader::open] Gz-compressed rawlogs are only supported if block-compressed, decompress it first: " << fileName << std::endl;
+			close();
+			return false;
+		}
+	}
+
+	const std::string idxFile = getIndexFileName(fileName);
+	if (!useIndexFile || !loadIndexFile(idxFile))
+	{
+		buildIndex();
+		if (useIndexFile && !saveIndexFile(idxFile))
+			std::cerr << "[CRawlogIndexedReader::open] Warning: could not save index file: " << idxFile << std::endl;
+	}
+	buildTimeLookupTable();
+	return true;
+
+	MRPT_END
+}
+
+void CRawlogIndexedReader::close()
+{
+	m_file.close();
+	m_gz_blocks.clear();
+	m_entries.clear();
+	m_sorted_by_time.clear();
+	m_time_buckets.clear();
+	m_time_min = m_time_max = INVALID_TIMESTAMP;
+	m_time_bucket_width = 1;
+}
+
+const CRawlogIndexedReader::TEntry & CRawlogIndexedReader::getEntry(size_t index) const
+{
+	ASSERT_BELOW_(index,m_entries.size())
+	return m_entries[index];
+}
+
+CSerializablePtr CRawlogIndexedReader::getObject(size_t index) const
+{
+	MRPT_START
+	ASSERT_BELOW_(index,m_entries.size())
+	const TEntry &e = m_entries[index];
+	ASSERT_(e.offset+e.length<=dataSize())
+
+	CMemoryStream ms;
+	if (!isBlockCompressed())
+	{
+		ms.assignMemoryNotOwn(m_file.data()+e.offset, e.length);
+		return ms.ReadObject();
+	}
+
+	// Decompress the block(s) holding the object:
+	const size_t first = m_gz_blocks.findBlock(e.offset), last = m_gz_blocks.findBlock(e.offset+e.length-1);
+	ASSERT_(last<m_gz_blocks.size())
+	vector_byte buf(m_gz_blocks.uncompressed_offset[last+1]-m_gz_blocks.uncompressed_offset[first]);
+	for (size_t b=first;b<=last;b++)
+	{
+		if (!mrpt::compress::zip::decompress_gz_block(
+			m_file.data()+m_gz_blocks.compressed_offset[b], m_gz_blocks.compressed_offset[b+1]-m_gz_blocks.compressed_offset[b],
+			&buf[m_gz_blocks.uncompressed_offset[b]-m_gz_blocks.uncompressed_offset[first]], m_gz_blocks.uncompressed_offset[b+1]-m_gz_blocks.uncompressed_offset[b]))
+			THROW_EXCEPTION_FMT("Error decompressing block #%u of rawlog file", static_cast<unsigned int>(b));
+	}
+	ms.assignMemoryNotOwn(&buf[e.offset-m_gz_blocks.uncompressed_offset[first]], e.length);
+	return ms.ReadObject();
+	MRPT_END
+}
+
+uint64_t CRawlogIndexedReader::dataSize() const
+{
+	return isBlockCompressed() ? m_gz_blocks.totalUncompressedSize() : m_file.size();
+}
+
+CObservationPtr CRawlogIndexedReader::getObservation(size_t index) const
+{
+	CSerializablePtr obj = getObject(index);
+	if (obj && obj->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
+		return CObservationPtr(obj);
+	return CObservationPtr();
+}
+
+size_t CRawlogIndexedReader::findIndexByTimestamp(const TTimeStamp t) const
+{
+	const size_t N = m_sorted_by_time.size();
+	if (!N || t>m_time_max) return m_entries.size();
+	if (t<=m_time_min) return m_sorted_by_time[0];
+
+	// Jump to the bucket of "t", then scan forward the (on average, one) entries in it:
+	size_t i = m_time_buckets[static_cast<size_t>((t-m_time_min)/m_time_bucket_width)];
+	while (i<N && m_entries[m_sorted_by_time[i]].timestamp<t)
+		i++;
+	return i<N ? m_sorted_by_time[i] : m_entries.size();
+}
+
+void CRawlogIndexedReader::buildIndex()
+{
+	MRPT_START
+
+	m_entries.clear();
+	CMemoryStream ms;
+	CFileGZInputStream gz;
+	CStream *in = &ms;
+	if (!isBlockCompressed())
+		ms.assignMemoryNotOwn(m_file.data(), m_file.size());
+	else
+	{
+		gz.setNumThreads(0);
+		if (!gz.open(m_file.getFileName()))
+			THROW_EXCEPTION_FMT("Error opening file: '%s'",m_file.getFileName().c_str())
+		in = &gz;
+	}
+
+	const uint64_t totalSize = dataSize();
+	for (uint64_t pos=0; pos<totalSize; pos=in->getPosition())
+	{
+		CSerializablePtr obj;
+		try {
+			obj = in->ReadObject();
+		}
+		catch (CExceptionEOF &) {
+			break;
+		}
+		catch (std::exception &e) {
+			// Truncated or corrupted file: keep what we have indexed so far, like CRawlog::loadFromRawLogFile() does.
+			std::cerr << "[CRawlogIndexedReader] Stopped indexing at offset " << pos << ": " << e.what() << std::endl;
+			break;
+		}
+		if (!obj) break;
+
+		TEntry e;
+		e.offset = pos;
+		e.length = in->getPosition()-pos;
+		e.className = obj->GetRuntimeClass()->className;
+		if (obj->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
+		{
+			const CObservationPtr o = CObservationPtr(obj);
+			e.timestamp = o->timestamp;
+			e.sensorLabel = o->sensorLabel;
+		}
+		else if (IS_CLASS(obj,CSensoryFrame))
+		{
+			const CSensoryFramePtr sf = CSensoryFramePtr(obj);
+			if (sf->size())
+				e.timestamp = sf->getObservationByIndex(0)->timestamp;
+		}
+		else if (IS_CLASS(obj,CActionCollection))
+		{
+			CActionCollectionPtr acts = CActionCollectionPtr(obj);
+			if (acts->size())
+				e.timestamp = acts->get(0)->timestamp;
+		}
+		m_entries.push_back(e);
+	}
+
+	MRPT_END
+}
+
+bool CRawlogIndexedReader::loadIndexFile(const std::string &idxFile)
+{
+	if (!mrpt::system::fileExists(idxFile))
+		return false;
+
+	try
+	{
+		CFileInputStream f;
+		if (!f.open(idxFile)) return false;
+
+		std::string magic;
+		uint32_t version, nEntries;
+		uint64_t fileSize, fileTime;
+		f >> magic >> version;
+		if (magic!=IDX_FILE_MAGIC || version!=IDX_FILE_VERSION)
+			return false;
+
+		// Is the index up to date with the rawlog file?
+		f >> fileSize >> fileTime;
+		if (fileSize!=m_file.size() || fileTime!=static_cast<uint64_t>(mrpt::system::getFileModificationTime(m_file.getFileName())))
+			return false;
+
+		f >> nEntries;
+		std::vector<TEntry> entries(nEntries);
+		for (uint32_t i=0;i<nEntries;i++)
+		{
+			TEntry &e = entries[i];
+			f >> e.offset >> e.length >> e.timestamp >> e.className >> e.sensorLabel;
+			if (e.offset+e.length>dataSize())
+				return false;
+		}
+		m_entries.swap(entries);
+		return true;
+	}
+	catch (std::exception &)
+	{
+		return false; // Corrupted index: it will be regenerated.
+	}
+}
+
+bool CRawlogIndexedReader::saveIndexFile(const std::string &idxFile) const
+{
+	try
+	{
+		CFileOutputStream f;
+		if (!f.open(idxFile)) return false;
+
+		f << std::string(IDX_FILE_MAGIC) << IDX_FILE_VERSION;
+		f << m_file.size() << static_cast<uint64_t>(mrpt::system::getFileModificationTime(m_file.getFileName()));
+		f << static_cast<uint32_t>(m_entries.size());
+		for (size_t i=0;i<m_entries.size();i++)
+		{
+			const TEntry &e = m_entries[i];
+			f << e.offset << e.length << e.timestamp << e.className << e.sensorLabel;
+		}
+		return true;
+	}
+	catch (std::exception &)
+	{
+		return false;
+	}
+}
+
+void CRawlogIndexedReader::buildTimeLookupTable()
+{
+	m_sorted_by_time.clear();
+	m_time_buckets.clear();
+	m_time_min = m_time_max = INVALID_TIMESTAMP;
+	m_time_bucket_width = 1;
+
+	for (size_t i=0;i<m_entries.size();i++)
+		if (m_entries[i].timestamp!=INVALID_TIMESTAMP)
+			m_sorted_by_time.push_back(i);
+	const size_t N = m_sorted_by_time.size();
+	if (!N) return;
+
+	std::sort(m_sorted_by_time.begin(),m_sorted_by_time.end(), TSortByTime(m_entries));
+	m_time_min = m_entries[m_sorted_by_time.front()].timestamp;
+	m_time_max = m_entries[m_sorted_by_time.back()].timestamp;
+
+	// One bucket per entry: for (roughly) uniformly-spaced timestamps, each bucket holds O(1) entries.
+	m_time_bucket_width = (m_time_max-m_time_min)/N + 1;
+	const size_t nBuckets = static_cast<size_t>((m_time_max-m_time_min)/m_time_bucket_width) + 1;
+	m_time_buckets.resize(nBuckets);
+	size_t i = 0;
+	for (size_t b=0;b<nBuckets;b++)
+	{
+		const TTimeStamp bucket_start = m_time_min + b*m_time_bucket_width;
+		while (i<N && m_entries[m_sorted_by_time[i]].timestamp<bucket_start)
+			i++;
+		m_time_buckets[b] = i;
+	}
+}
@@ -0,0 +1,143 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CRawlogIndexedReader.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/obs/CObservationComment.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/utils/CFileOutputStream.h>
+#include <mrpt/utils/CFileGZOutputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/os.h>
+
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace
+{
+	const size_t NUM_TEST_OBS = 50;
+
+	// Timestamps are increasing except for one pair, to check the time ordering.
+	mrpt::system::TTimeStamp testObsTime(size_t i)
+	{
+		if (i==10) return 1000 + 11*100;
+		if (i==11) return 1000 + 10*100;
+		return 1000 + i*100;
+	}
+
+	CObservationOdometryPtr testObs(size_t i)
+	{
+		CObservationOdometryPtr obs = CObservationOdometry::Create();
+		obs->timestamp = testObsTime(i);
+		obs->sensorLabel = mrpt::format("ODO%u", static_cast<unsigned int>(i%3));
+		obs->odometry = mrpt::poses::CPose2D(i*0.1, -double(i), 0.01*i);
+		return obs;
+	}
+
+	// Writes a comment, then NUM_TEST_OBS observations (the last one, within a sensory frame)
+	void writeTestRawlog(CStream &out)
+	{
+		CObservationComment comment;
+		comment.text = "Rawlog for CRawlogIndexedReader unit tests";
+		comment.timestamp = 500;
+		out << comment;
+		for (size_t i=0;i<NUM_TEST_OBS-1;i++)
+			out << *testObs(i);
+
+		CSensoryFrame sf;
+		sf.insert(testObs(NUM_TEST_OBS-1));
+		out << sf;
+	}
+
+	// Opens the rawlog twice (first to build the index file, then reusing it), and checks random accesses
+	void checkRandomAccess(const std::string &fil, bool isBlockCompressed)
+	{
+		for (int pass=0;pass<2;pass++)
+		{
+			CRawlogIndexedReader reader;
+			ASSERT_TRUE(reader.open(fil));
+			EXPECT_EQ(reader.isBlockCompressed(), isBlockCompressed);
+			EXPECT_TRUE(mrpt::system::fileExists(CRawlogIndexedReader::getIndexFileName(fil)));
+			ASSERT_EQ(reader.size(), NUM_TEST_OBS+1);
+
+			EXPECT_EQ(reader.getEntry(0).className, std::string("CObservationComment"));
+			EXPECT_EQ(reader.getEntry(NUM_TEST_OBS).className, std::string("CSensoryFrame"));
+			EXPECT_EQ(reader.getEntry(NUM_TEST_OBS).timestamp, testObsTime(NUM_TEST_OBS-1));
+
+			// Backwards, to make sure access does not depend on the order:
+			for (size_t i=NUM_TEST_OBS-1;i>=1;i--)
+			{
+				const CRawlogIndexedReader::TEntry &e = reader.getEntry(i);
+				const CObservationOdometryPtr gt = testObs(i-1);
+				EXPECT_EQ(e.timestamp, gt->timestamp);
+				EXPECT_EQ(e.sensorLabel, gt->sensorLabel);
+
+				CObservationPtr obs = reader.getObservation(i);
+				ASSERT_TRUE(obs.present());
+				ASSERT_TRUE(IS_CLASS(obs,CObservationOdometry));
+				const CObservationOdometryPtr odo = CObservationOdometryPtr(obs);
+				EXPECT_EQ(odo->timestamp, gt->timestamp);
+				EXPECT_EQ(odo->sensorLabel, gt->sensorLabel);
+				EXPECT_NEAR((odo->odometry-gt->odometry).norm(), 0.0, 1e-9);
+			}
+			EXPECT_FALSE(reader.getObservation(NUM_TEST_OBS).present()); // A CSensoryFrame
+
+			// Seek by time:
+			EXPECT_EQ(reader.findIndexByTimestamp(0), 0u);
+			EXPECT_EQ(reader.findIndexByTimestamp(501), 1u);
+			EXPECT_EQ(reader.findIndexByTimestamp(testObsTime(5)), 6u);
+			EXPECT_EQ(reader.findIndexByTimestamp(testObsTime(5)+1), 7u);
+			EXPECT_EQ(reader.findIndexByTimestamp(testObsTime(11)), 12u); // Out-of-order entries
+			EXPECT_EQ(reader.findIndexByTimestamp(testObsTime(10)), 11u);
+			EXPECT_EQ(reader.findIndexByTimestamp(testObsTime(NUM_TEST_OBS-1)), NUM_TEST_OBS);
+			EXPECT_EQ(reader.findIndexByTimestamp(testObsTime(NUM_TEST_OBS-1)+1), reader.size());
+		}
+
+		mrpt::system::deleteFile(CRawlogIndexedReader::getIndexFileName(fil));
+		mrpt::system::deleteFile(fil);
+	}
+}
+
+TEST(CRawlogIndexedReader, randomAccess)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		CFileOutputStream f(fil);
+		writeTestRawlog(f);
+	}
+	checkRandomAccess(fil, false);
+}
+
+TEST(CRawlogIndexedReader, randomAccessBlockCompressed)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		CFileGZOutputStream f;
+		ASSERT_TRUE(f.openBlockCompressed(fil, 1, 300 /* tiny blocks: many objects span two blocks */));
+		writeTestRawlog(f);
+	}
+	checkRandomAccess(fil, true);
+}
+
+TEST(CRawlogIndexedReader, rejectsSingleStreamGzFiles)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		CFileGZOutputStream f(fil);
+		writeTestRawlog(f);
+	}
+	CRawlogIndexedReader reader;
+	EXPECT_FALSE(reader.open(fil));
+	EXPECT_FALSE(reader.isOpen());
+	mrpt::system::deleteFile(fil);
+}
@@ -159,14 +159,13 @@ namespace mrpt
 			/** Write an individual point (checks for "i" in the valid range only in Debug). */
 			void setPoint(size_t i, const float x,const float y, const float z);
 
-			/** Write an individual point (without checking validity of the index). */
+			/** Write an individual point, *without* checking validity of the index and *without* calling markAllPointsAsNew(),
+			  * so different points can be written from several threads at once. Call markAllPointsAsNew() (or resize()) once afterwards. \sa setPoint */
 			inline void setPoint_fast(size_t i, const float x,const float y, const float z)
 			{
 				m_xs[i] = x;
 				m_ys[i] = y;
 				m_zs[i] = z;
-				m_minmax_valid = false;
-				markAllPointsAsNew();
 			}
 
 
@@ -276,7 +275,7 @@ namespace mrpt
 				y=m_obj.getArrayY()[idx];
 				z=m_obj.getArrayZ()[idx];
 			}
-			/** Set XYZ coordinates of i'th point */
+			/** Set XYZ coordinates of i'th point. It has no other side effects: the point cloud is marked as modified in resize() */
 			inline void setPointXYZ(const size_t idx, const coords_t x,const coords_t y, const coords_t z) {
 				m_obj.setPoint_fast(idx,x,y,z);
 			}
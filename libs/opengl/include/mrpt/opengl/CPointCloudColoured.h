@@ -133,17 +133,16 @@ namespace mrpt
 			/** Write an individual point (checks for "i" in the valid range only in Debug). */
 			void setPoint(size_t i, const TPointColour &p );
 
-			/** Like \a setPoint() but does not check for index out of bounds */
+			/** Like \a setPoint() but does not check for index out of bounds and does not call markAllPointsAsNew(),
+			  * so different points can be written from several threads at once. Call markAllPointsAsNew() (or resize()) once afterwards. */
 			inline void setPoint_fast(const size_t i, const TPointColour &p ) {
 				m_points[i] = p;
-				markAllPointsAsNew();
 			}
 
-			/** Like \a setPoint() but does not check for index out of bounds */
+			/** Like \a setPoint() but does not check for index out of bounds and does not call markAllPointsAsNew() */
 			inline void setPoint_fast(const size_t i, const float x,const float y, const float z ) {
 			 TPointColour &p = m_points[i];
 				p.x=x; p.y=y; p.z=z;
-				markAllPointsAsNew();
 			}
 
 			/** Like \c setPointColor but without checking for out-of-index erors */
@@ -260,7 +259,7 @@ namespace mrpt
 				y=pc.y;
 				z=pc.z;
 			}
-			/** Set XYZ coordinates of i'th point */
+			/** Set XYZ coordinates of i'th point. It has no other side effects: the point cloud is marked as modified in resize() */
 			inline void setPointXYZ(const size_t idx, const coords_t x,const coords_t y, const coords_t z) {
 				m_obj.setPoint_fast(idx, x,y,z);
 			}
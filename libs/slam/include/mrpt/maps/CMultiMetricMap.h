@@ -314,6 +314,9 @@ namespace maps
 		  */
 		void  auxParticleFilterCleanUp() MRPT_OVERRIDE;
 
+		/** The implementation in this class just calls all the corresponding method of the contained metric maps */
+		void  prepareConcurrentObservationLikelihood() MRPT_OVERRIDE;
+
 		/** Returns a 3D object representing the map.
 		  */
 		void getAs3DObject(mrpt::opengl::CSetOfObjectsPtr &outObj) const MRPT_OVERRIDE;
@@ -114,6 +114,10 @@ namespace mrpt
 				  *  of not approximating ICP by ignoring the correspondence of some points. The speed-up comes from a decimation of the number of KD-tree queries,
 				  *  the most expensive step in ICP */
 				uint32_t        corresponding_points_decimation;
+
+				/** Number of threads for the KD-tree queries in the point matching step (default=1). 0 means as many threads as CPU cores.
+				  * Results do not depend on this value. \sa mrpt::maps::TMatchingParams::numThreads */
+				uint32_t        numThreadsMatching;
 			};
 
 			TConfigParams  options; //!< The options employed by the ICP align.
@@ -136,6 +136,15 @@ namespace mrpt
 				const size_t			particleIndexForMap,
 				const mrpt::obs::CSensoryFrame		&observation,
 				const mrpt::poses::CPose3D &x ) const;
+
+			/** Builds the lazily-computed data of the maps shared among particles before evaluating them from several threads */
+			void PF_SLAM_prepareConcurrentObservationLikelihood() const MRPT_OVERRIDE;
+
+			/** Evaluates all particles at once if they share one map with occupancy grids (see mrpt::maps::COccupancyGridMap2D::computeObservationLikelihoods) */
+			bool PF_SLAM_computeObservationLikelihoodForAllParticles(
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions	&PF_options,
+				const mrpt::obs::CSensoryFrame		&observation,
+				std::vector<double>	&out_log_liks ) const MRPT_OVERRIDE;
 			/** @} */
 
 
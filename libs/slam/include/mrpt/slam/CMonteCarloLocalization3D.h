@@ -107,6 +107,9 @@ namespace mrpt
 				const size_t			particleIndexForMap,
 				const mrpt::obs::CSensoryFrame		&observation,
 				const mrpt::poses::CPose3D			&x ) const;
+
+			/** Builds the lazily-computed data of the maps shared among particles before evaluating them from several threads */
+			void PF_SLAM_prepareConcurrentObservationLikelihood() const MRPT_OVERRIDE;
 			/** @} */
 
 
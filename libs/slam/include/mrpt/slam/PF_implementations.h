@@ -13,6 +13,7 @@
 #include <mrpt/bayes/CParticleFilterCapable.h>
 #include <mrpt/bayes/CParticleFilterData.h>
 #include <mrpt/random.h>
+#include <mrpt/system/threads.h>  // parallelForBlocks()
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CActionRobotMovement3D.h>
 #include <mrpt/obs/CActionRobotMovement2D.h>
@@ -284,13 +285,50 @@ namespace mrpt
 				//	UPDATE STAGE
 				// ----------------------------------------------------------------------
 				// Compute all the likelihood values & update particles weight:
-				for (size_t i=0;i<M;i++)
+				if (PF_options.numThreadsObsLikelihood==1 || M<2)
+				{
+					std::vector<double> &logLiks = m_pfStandardProposal_obsLogLikelihoods;
+					if (PF_SLAM_computeObservationLikelihoodForAllParticles(PF_options,*sf,logLiks))
+					{
+						ASSERT_EQUAL_(logLiks.size(),M)
+						for (size_t i=0;i<M;i++)
+							me->m_particles[i].log_w += logLiks[i] * PF_options.powFactor;
+					}
+					else
+					{
+						for (size_t i=0;i<M;i++)
+						{
+							const mrpt::math::TPose3D  *partPose= getLastPose(i); // Take the particle data:
+							mrpt::poses::CPose3D  partPose2 = mrpt::poses::CPose3D(*partPose);
+							const double obs_log_likelihood = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,i,*sf,partPose2);
+							me->m_particles[i].log_w += obs_log_likelihood * PF_options.powFactor;
+						} // for each particle "i"
+					}
+				}
+				else
 				{
-					const mrpt::math::TPose3D  *partPose= getLastPose(i); // Take the particle data:
-					mrpt::poses::CPose3D  partPose2 = mrpt::poses::CPose3D(*partPose);
-					const double obs_log_likelihood = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,i,*sf,partPose2);
-					me->m_particles[i].log_w += obs_log_likelihood * PF_options.powFactor;
-				} // for each particle "i"
+					std::vector<double> &logLiks = m_pfStandardProposal_obsLogLikelihoods;
+					logLiks.resize(M);
+
+					// Maps shared among particles build their lazily-computed data now (e.g. the whole likelihood-field cache of
+					// gridmaps), so evaluating them from several threads only reads them:
+					PF_SLAM_prepareConcurrentObservationLikelihood();
+					// Evaluate the first particle from this thread, so lazily-built data of the observations (auxiliary
+					// point maps,...) and of per-particle maps (KD-trees,...) already exist before going multithreaded:
+					logLiks[0] = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,0,*sf,mrpt::poses::CPose3D(*getLastPose(0)));
+
+					TObsLikelihoodThreadsData data;
+					data.me = this;
+					data.PF_options = &PF_options;
+					data.sf = sf;
+					data.first_particle = 1;
+					data.out_log_liks = &logLiks[0];
+					mrpt::system::parallelForBlocks(M-1, &PF_implementation<PARTICLE_TYPE,MYSELF>::PF_SLAM_aux_computeObsLikelihoodBlock, &data, PF_options.numThreadsObsLikelihood);
+
+					// Each particle has its own output slot: the result does not depend on the number of threads.
+					for (size_t i=0;i<M;i++)
+						me->m_particles[i].log_w += logLiks[i] * PF_options.powFactor;
+				}
 
 				// Normalization of weights is done outside of this method automatically.
 			}
@@ -298,6 +336,20 @@ namespace mrpt
 			MRPT_END
 		}  // end of PF_SLAM_implementation_pfStandardProposal
 
+		template <class PARTICLE_TYPE,class MYSELF>
+		void PF_implementation<PARTICLE_TYPE,MYSELF>::PF_SLAM_aux_computeObsLikelihoodBlock(size_t first, size_t last, unsigned int thread_idx, void *param)
+		{
+			MRPT_UNUSED_PARAM(thread_idx);
+			const TObsLikelihoodThreadsData &data = *static_cast<const TObsLikelihoodThreadsData*>(param);
+			mrpt::poses::CPose3D partPose; // Per-thread scratch pose
+			for (size_t k=first;k<last;k++)
+			{
+				const size_t i = k + data.first_particle;
+				partPose = mrpt::poses::CPose3D(*data.me->getLastPose(i));
+				data.out_log_liks[i] = data.me->PF_SLAM_computeObservationLikelihoodForParticle(*data.PF_options,i,*data.sf,partPose);
+			}
+		}
+
 		/** A generic implementation of the PF method "prediction_and_update_pfAuxiliaryPFStandard" (Auxiliary particle filter with the standard proposal),
 		  *  common to both localization and mapping.
 		  *
@@ -63,6 +63,7 @@ namespace mrpt
 			mutable mrpt::math::CVectorDouble			m_pfAuxiliaryPFOptimal_maxLikelihood;						//!< Auxiliary variable used in the "pfAuxiliaryPFOptimal" algorithm.
 			mutable std::vector<mrpt::math::TPose3D>	m_pfAuxiliaryPFOptimal_maxLikDrawnMovement;		//!< Auxiliary variable used in the "pfAuxiliaryPFOptimal" algorithm.
 			std::vector<bool>				m_pfAuxiliaryPFOptimal_maxLikMovementDrawHasBeenUsed;
+			mutable std::vector<double>	m_pfStandardProposal_obsLogLikelihoods;	//!< Auxiliary variable used in the "pfStandardProposal" algorithm to hold the observation likelihoods of all particles
 
 			/**  Compute w[i]*p(z_t | mu_t^i), with mu_t^i being
 			  *    the mean of the new robot pose
@@ -244,6 +245,29 @@ namespace mrpt
 				const mrpt::obs::CSensoryFrame		&observation,
 				const mrpt::poses::CPose3D			&x )  const = 0;
 
+			/** Called once before PF_SLAM_computeObservationLikelihoodForParticle() is invoked from several threads at once
+			  *  (see mrpt::bayes::CParticleFilter::TParticleFilterOptions::numThreadsObsLikelihood). Make a specialization if particles share
+			  *  maps, to build their lazily-computed data beforehand (see mrpt::maps::CMetricMap::prepareConcurrentObservationLikelihood) */
+			virtual void PF_SLAM_prepareConcurrentObservationLikelihood() const
+			{
+				// By default, each particle has its own map: nothing to do.
+			}
+
+			/** Evaluate the observation likelihood for all the particles at once, for filters that can do it faster than one particle at
+			  *  a time (e.g. with mrpt::maps::COccupancyGridMap2D::computeObservationLikelihoods). The values must be the same than those
+			  *  of PF_SLAM_computeObservationLikelihoodForParticle() for each particle.
+			  *  Only used when likelihoods are evaluated from one thread (TParticleFilterOptions::numThreadsObsLikelihood=1).
+			  * \return false (default) if not supported, so likelihoods are evaluated one particle at a time.
+			  */
+			virtual bool PF_SLAM_computeObservationLikelihoodForAllParticles(
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions	&PF_options,
+				const mrpt::obs::CSensoryFrame		&observation,
+				std::vector<double>	&out_log_liks ) const
+			{
+				MRPT_UNUSED_PARAM(PF_options); MRPT_UNUSED_PARAM(observation); MRPT_UNUSED_PARAM(out_log_liks);
+				return false;
+			}
+
 			/** @} */
 
 
@@ -267,6 +291,19 @@ namespace mrpt
 				const TKLDParams &KLD_options,
 				const bool USE_OPTIMAL_SAMPLING  );
 
+			/** Data shared by the threads that evaluate the particle likelihoods in PF_SLAM_implementation_pfStandardProposal() */
+			struct TObsLikelihoodThreadsData
+			{
+				const PF_implementation *me;
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions *PF_options;
+				const mrpt::obs::CSensoryFrame *sf;
+				size_t first_particle;  //!< Offset of the particle indices passed to the worker function
+				double *out_log_liks;   //!< One output slot per particle
+			};
+
+			/** Worker function (for mrpt::system::parallelForBlocks) evaluating the observation log-likelihood of a block of particles */
+			static void PF_SLAM_aux_computeObsLikelihoodBlock(size_t first, size_t last, unsigned int thread_idx, void *param);
+
 			template <class BINTYPE>
 			void PF_SLAM_aux_perform_one_rejection_sampling_step(
 				const bool		USE_OPTIMAL_SAMPLING,
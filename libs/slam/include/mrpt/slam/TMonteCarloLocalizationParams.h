@@ -43,6 +43,10 @@ namespace mrpt
 			mrpt::maps::TMetricMapList		metricMaps;
 
 			TKLDParams			KLD_params; //!< Parameters for dynamic sample size, KLD method.
+
+			/** Calls mrpt::maps::CMetricMap::prepareConcurrentObservationLikelihood() for \a metricMap, or for each map in \a metricMaps
+			  *  shared by more than one particle (those are the only ones evaluated concurrently). */
+			void prepareConcurrentObservationLikelihood() const;
 		};
 
 	} // End of namespace
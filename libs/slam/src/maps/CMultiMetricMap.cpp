@@ -144,6 +144,16 @@ struct MapAuxPFCleanup
 	}
 }; // end of MapAuxPFCleanup
 
+struct MapPrepareConcurrentLik
+{
+	MapPrepareConcurrentLik() { }
+
+	template <typename PTR>
+	inline void operator()(PTR &ptr) {
+		if (ptr) ptr->prepareConcurrentObservationLikelihood();
+	}
+}; // end of MapPrepareConcurrentLik
+
 
 struct MapIsEmpty
 {
@@ -445,6 +455,17 @@ void  CMultiMetricMap::auxParticleFilterCleanUp()
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+					prepareConcurrentObservationLikelihood
+ ---------------------------------------------------------------*/
+void  CMultiMetricMap::prepareConcurrentObservationLikelihood()
+{
+	MRPT_START
+	MapPrepareConcurrentLik op_prepare;
+	MapExecutor::run(*this,op_prepare);
+	MRPT_END
+}
+
 /** If the map is a simple points map or it's a multi-metric map that contains EXACTLY one simple points map, return it.
 * Otherwise, return NULL
 */
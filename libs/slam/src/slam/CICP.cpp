@@ -123,7 +123,8 @@ CICP::TConfigParams::TConfigParams() :
 	skip_cov_calculation		(false),
 	skip_quality_calculation	(true),
 
-	corresponding_points_decimation ( 5 )
+	corresponding_points_decimation ( 5 ),
+	numThreadsMatching ( 1 )
 {
 }
 
@@ -169,6 +170,7 @@ void  CICP::TConfigParams::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR( skip_quality_calculation, bool, 				iniFile, section);
 
 	MRPT_LOAD_CONFIG_VAR( corresponding_points_decimation, int, 				iniFile, section);
+	MRPT_LOAD_CONFIG_VAR( numThreadsMatching, int, 				iniFile, section);
 
 }
 
@@ -208,6 +210,7 @@ void  CICP::TConfigParams::dumpToTextStream(mrpt::utils::CStream	&out) const
 	out.printf("skip_cov_calculation                    = %c\n",skip_cov_calculation ? 'Y':'N');
 	out.printf("skip_quality_calculation                = %c\n",skip_quality_calculation ? 'Y':'N');
 	out.printf("corresponding_points_decimation         = %u\n",(unsigned int)corresponding_points_decimation);
+	out.printf("numThreadsMatching                      = %u\n",(unsigned int)numThreadsMatching);
 	out.printf("\n");
 }
 
@@ -272,6 +275,7 @@ CPosePDFPtr CICP::ICP_Method_Classic(
 	matchParams.onlyKeepTheClosest = options.onlyClosestCorrespondences;
 	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
 	matchParams.decimation_other_map_points = options.corresponding_points_decimation;
+	matchParams.numThreads = options.numThreadsMatching;
 
 
 	// Asure maps are not empty!
@@ -596,6 +600,7 @@ CPosePDFPtr CICP::ICP_Method_LM(
 	matchParams.onlyKeepTheClosest = onlyKeepTheClosest;
 	matchParams.onlyUniqueRobust = onlyUniqueRobust;
 	matchParams.decimation_other_map_points = options.corresponding_points_decimation;
+	matchParams.numThreads = options.numThreadsMatching;
 
 	// The gaussian PDF to estimate:
 	// ------------------------------------------------------
@@ -981,6 +986,7 @@ CPose3DPDFPtr CICP::ICP3D_Method_Classic(
 	matchParams.onlyKeepTheClosest = options.onlyClosestCorrespondences;
 	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
 	matchParams.decimation_other_map_points = options.corresponding_points_decimation;
+	matchParams.numThreads = options.numThreadsMatching;
 
 	// Asure maps are not empty!
 	// ------------------------------------------------------
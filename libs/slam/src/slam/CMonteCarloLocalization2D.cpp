@@ -13,6 +13,7 @@
 
 #include <mrpt/utils/CTicTac.h>
 #include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CMultiMetricMap.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CSensoryFrame.h>
 
@@ -194,6 +195,77 @@ double CMonteCarloLocalization2D::PF_SLAM_computeObservationLikelihoodForParticl
 	return ret;
 }
 
+/*---------------------------------------------------------------
+			PF_SLAM_prepareConcurrentObservationLikelihood
+ ---------------------------------------------------------------*/
+void CMonteCarloLocalization2D::PF_SLAM_prepareConcurrentObservationLikelihood() const
+{
+	options.prepareConcurrentObservationLikelihood();
+}
+
+/*---------------------------------------------------------------
+			PF_SLAM_computeObservationLikelihoodForAllParticles
+ ---------------------------------------------------------------*/
+bool CMonteCarloLocalization2D::PF_SLAM_computeObservationLikelihoodForAllParticles(
+	const CParticleFilter::TParticleFilterOptions	&PF_options,
+	const CSensoryFrame		&observation,
+	std::vector<double>		&out_log_liks ) const
+{
+	MRPT_UNUSED_PARAM(PF_options);
+	MRPT_START
+
+	// Only worth it if all particles share one map with occupancy grids, which evaluate all the poses at once:
+	CMetricMap *map = options.metricMap;
+	if (!map || !map->genericMapParams.enableObservationLikelihood)
+		return false;
+
+	std::vector<CMetricMap*> maps; // The maps whose likelihoods are added up by map->computeObservationLikelihood()
+	if (IS_CLASS(map,CMultiMetricMap))
+	{
+		CMultiMetricMap *multiMap = static_cast<CMultiMetricMap*>(map);
+		for (CMultiMetricMap::iterator it=multiMap->maps.begin();it!=multiMap->maps.end();++it)
+			maps.push_back(it->pointer());
+	}
+	else maps.push_back(map);
+
+	bool anyGrid = false;
+	for (size_t k=0;k<maps.size();k++)
+		anyGrid = anyGrid || IS_CLASS(maps[k],COccupancyGridMap2D);
+	if (!anyGrid)
+		return false;
+
+	const size_t M = m_particles.size();
+	std::vector<TPose2D> poses(M);
+	for (size_t i=0;i<M;i++)
+		poses[i] = TPose2D(*getLastPose(i));
+
+	// Same sums, in the same order, than PF_SLAM_computeObservationLikelihoodForParticle():
+	out_log_liks.assign(M,1);
+	std::vector<double> obsLiks, mapLiks;
+	for (CSensoryFrame::const_iterator it=observation.begin();it!=observation.end();++it)
+	{
+		obsLiks.assign(M,0);
+		for (size_t k=0;k<maps.size();k++)
+		{
+			if (IS_CLASS(maps[k],COccupancyGridMap2D))
+				static_cast<COccupancyGridMap2D*>(maps[k])->computeObservationLikelihoods( it->pointer(), poses, mapLiks );
+			else
+			{
+				mapLiks.resize(M);
+				for (size_t i=0;i<M;i++)
+					mapLiks[i] = maps[k]->computeObservationLikelihood( it->pointer(), CPose3D(*getLastPose(i)) );
+			}
+			for (size_t i=0;i<M;i++)
+				obsLiks[i] += mapLiks[i];
+		}
+		for (size_t i=0;i<M;i++)
+			out_log_liks[i] += obsLiks[i];
+	}
+	return true;
+
+	MRPT_END
+}
+
 // Specialization for my kind of particles:
 void CMonteCarloLocalization2D::PF_SLAM_implementation_custom_update_particle_with_new_pose(
 	CPose2D *particleData,
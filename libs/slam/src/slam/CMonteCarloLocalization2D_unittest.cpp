@@ -13,6 +13,9 @@
 #include <mrpt/slam/CMonteCarloLocalization2D.h>
 #include <mrpt/maps/CMultiMetricMap.h>
 #include <mrpt/maps/CSimpleMap.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
 #include <mrpt/obs/CRawlog.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>
@@ -296,3 +299,89 @@ TEST(MonteCarlo2D, RunSampleDataset)
 	FAIL() << "Failed to converge after 3 opportunities!!" << endl;
 }
 
+
+// Evaluates the weights of the same particle set with 1 and N threads: they must be bitwise identical.
+// With 1 thread, particles sharing a map with gridmaps are evaluated all at once (COccupancyGridMap2D::computeObservationLikelihoods),
+// with N threads one particle at a time.
+static void checkParallelWeighting(CMetricMap *map, const CSensoryFrame &sf)
+{
+	CMonteCarloLocalization2D pdf1, pdfN;
+	randomGenerator.randomize(1234);
+	pdf1.resetUniform(-0.5,0.5, -0.5,0.5, -0.3,0.3, 1000);
+	randomGenerator.randomize(1234);
+	pdfN.resetUniform(-0.5,0.5, -0.5,0.5, -0.3,0.3, 1000);
+	pdf1.options.metricMap = map;
+	pdfN.options.metricMap = map;
+
+	CParticleFilter::TParticleFilterOptions pfOpts;
+	pfOpts.PF_algorithm = CParticleFilter::pfStandardProposal;
+	// Multithreaded first, while the likelihood cache of the shared grid is still empty:
+	pfOpts.numThreadsObsLikelihood = 4;
+	pdfN.prediction_and_update(NULL, &sf, pfOpts);
+	pfOpts.numThreadsObsLikelihood = 1;
+	pdf1.prediction_and_update(NULL, &sf, pfOpts);
+
+	ASSERT_EQ(pdf1.particlesCount(), pdfN.particlesCount());
+	for (size_t i=0;i<pdf1.particlesCount();i++)
+		EXPECT_EQ(pdf1.getW(i), pdfN.getW(i)) << "Particle #" << i;
+}
+
+TEST(MonteCarlo2D, ParallelWeightingIsDeterministic)
+{
+	CObservation2DRangeScan scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	const size_t nRays = 361;
+	scan.resizeScan(nRays);
+	for (size_t i=0;i<nRays;i++)
+	{
+		scan.setScanRange(i, 3.0f + 1.5f*std::sin(i*0.05f));
+		scan.setScanRangeValidity(i, true);
+	}
+
+	COccupancyGridMap2D grid(-10,10,-10,10, 0.05f);
+	grid.likelihoodOptions.likelihoodMethod = COccupancyGridMap2D::lmLikelihoodField_Thrun;
+	grid.likelihoodOptions.enableLikelihoodCache = true;
+	const CPose3D origin;
+	grid.insertObservation(&scan, &origin);
+
+	// A gridmap together with other kind of map:
+	CMultiMetricMap multiMap;
+	multiMap.maps.push_back( CMetricMapPtr(new COccupancyGridMap2D(grid)) );
+	CSimplePointsMap *points = new CSimplePointsMap();
+	points->insertObservation(&scan, &origin);
+	multiMap.maps.push_back( CMetricMapPtr(points) );
+
+	CSensoryFrame sf;
+	sf.insert( CObservation2DRangeScanPtr(new CObservation2DRangeScan(scan)) );
+
+	{
+		SCOPED_TRACE("COccupancyGridMap2D");
+		checkParallelWeighting(&grid, sf);
+	}
+	{
+		SCOPED_TRACE("CMultiMetricMap");
+		checkParallelWeighting(&multiMap, sf);
+	}
+
+	// The likelihood cache must not change the weights:
+	COccupancyGridMap2D grid_nocache(grid);
+	grid_nocache.likelihoodOptions.enableLikelihoodCache = false;
+
+	CMonteCarloLocalization2D pdfCache, pdfNoCache;
+	randomGenerator.randomize(1234);
+	pdfCache.resetUniform(-0.5,0.5, -0.5,0.5, -0.3,0.3, 1000);
+	randomGenerator.randomize(1234);
+	pdfNoCache.resetUniform(-0.5,0.5, -0.5,0.5, -0.3,0.3, 1000);
+	pdfCache.options.metricMap = &grid;
+	pdfNoCache.options.metricMap = &grid_nocache;
+
+	CParticleFilter::TParticleFilterOptions pfOpts;
+	pfOpts.PF_algorithm = CParticleFilter::pfStandardProposal;
+	pdfCache.prediction_and_update(NULL, &sf, pfOpts);
+	pdfNoCache.prediction_and_update(NULL, &sf, pfOpts);
+
+	ASSERT_EQ(pdfCache.particlesCount(), pdfNoCache.particlesCount());
+	for (size_t i=0;i<pdfCache.particlesCount();i++)
+		EXPECT_EQ(pdfCache.getW(i), pdfNoCache.getW(i)) << "Particle #" << i;
+}
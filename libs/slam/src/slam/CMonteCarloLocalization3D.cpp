@@ -200,6 +200,14 @@ double CMonteCarloLocalization3D::PF_SLAM_computeObservationLikelihoodForParticl
 	return ret;
 }
 
+/*---------------------------------------------------------------
+			PF_SLAM_prepareConcurrentObservationLikelihood
+ ---------------------------------------------------------------*/
+void CMonteCarloLocalization3D::PF_SLAM_prepareConcurrentObservationLikelihood() const
+{
+	options.prepareConcurrentObservationLikelihood();
+}
+
 // Specialization for my kind of particles:
 void CMonteCarloLocalization3D::PF_SLAM_implementation_custom_update_particle_with_new_pose(
 	CPose3D *particleData,
@@ -0,0 +1,171 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/slam/CRangeBearingKFSLAM2D.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/obs/CObservationBearingRange.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/poses/CPosePDFGaussian.h>
+#include <mrpt/math/wrap2pi.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::bayes;
+using namespace mrpt::math;
+using namespace mrpt::maps;
+using namespace mrpt::slam;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::random;
+using namespace std;
+
+namespace
+{
+	const double max_range = 6.0;
+	const float  std_range = 0.01f;
+	const float  std_yaw   = DEG2RAD(0.5f);
+
+	// A robot moving 1m per step along a corridor with 2 landmarks per meter, seen (with known IDs) up to 6m away.
+	struct TSyntheticDataset
+	{
+		vector<TPoint2D> landmarks;
+		vector<CActionCollectionPtr> actions;
+		vector<CSensoryFramePtr> observations;
+		CPose2D final_robot_pose;
+
+		TSyntheticDataset(size_t nSteps)
+		{
+			CRandomGenerator rng(123);
+			for (size_t i=0;i<2*nSteps+30;i++)
+				landmarks.push_back(TPoint2D(0.5*i-max_range, rng.drawUniform(-4.0,4.0)));
+
+			CActionRobotMovement2D::TMotionModelOptions odo_opts;
+			odo_opts.modelSelection = CActionRobotMovement2D::mmGaussian;
+			odo_opts.gaussianModel.a1 = 0;
+			odo_opts.gaussianModel.a2 = 0;
+			odo_opts.gaussianModel.a3 = 0;
+			odo_opts.gaussianModel.a4 = 0;
+			odo_opts.gaussianModel.minStdXY = 0.02f;
+			odo_opts.gaussianModel.minStdPHI = DEG2RAD(0.2f);
+
+			CPose2D robot;
+			for (size_t k=0;k<nSteps;k++)
+			{
+				// No motion in the first step: the filter does not predict the robot pose until the map has landmarks.
+				const CPose2D incr = (k==0) ? CPose2D(0,0,0) : CPose2D(1.0, 0, (k%10<5) ? DEG2RAD(2.0) : -DEG2RAD(2.0));
+				robot = robot + incr;
+
+				CActionCollectionPtr acts = CActionCollection::Create();
+				CActionRobotMovement2D act;
+				act.computeFromOdometry(CPose2D(incr.x()+rng.drawGaussian1D(0,0.01),incr.y(),incr.phi()+rng.drawGaussian1D(0,DEG2RAD(0.1))), odo_opts);
+				acts->insert(act);
+				actions.push_back(acts);
+
+				CObservationBearingRangePtr obs = CObservationBearingRange::Create();
+				obs->maxSensorDistance = max_range;
+				obs->fieldOfView_yaw = 2*M_PIf;
+				obs->sensor_std_range = std_range;
+				obs->sensor_std_yaw = std_yaw;
+				for (size_t i=0;i<landmarks.size();i++)
+				{
+					const double dx = landmarks[i].x-robot.x(), dy = landmarks[i].y-robot.y(), r = std::sqrt(dx*dx+dy*dy);
+					if (r>max_range) continue;
+					CObservationBearingRange::TMeasurement m;
+					m.range = static_cast<float>(r + rng.drawGaussian1D(0,std_range));
+					m.yaw = static_cast<float>(wrapToPi(atan2(dy,dx)-robot.phi()) + rng.drawGaussian1D(0,std_yaw));
+					m.pitch = 0;
+					m.landmarkID = static_cast<int32_t>(i);
+					obs->sensedData.push_back(m);
+				}
+				CSensoryFramePtr sf = CSensoryFrame::Create();
+				sf->insert(obs);
+				observations.push_back(sf);
+			}
+			final_robot_pose = robot;
+		}
+
+		void run(CRangeBearingKFSLAM2D &slam) const
+		{
+			slam.options.std_sensor_range = std_range;
+			slam.options.std_sensor_yaw = std_yaw;
+			for (size_t k=0;k<actions.size();k++)
+			{
+				CActionCollectionPtr acts = actions[k];
+				CSensoryFramePtr sf = observations[k];
+				slam.processActionObservation(acts,sf);
+			}
+		}
+	};
+
+	struct TSLAMState
+	{
+		CPosePDFGaussian robot;
+		vector<TPoint2D> landmarks;
+		std::map<unsigned int,CLandmark::TLandmarkID> landmarkIDs;
+		CVectorDouble mean;
+		CMatrixDouble cov;
+
+		TSLAMState(const CRangeBearingKFSLAM2D &slam) {
+			slam.getCurrentState(robot,landmarks,landmarkIDs,mean,cov);
+		}
+	};
+}
+
+// Without sparsification (all landmarks active), the SEIF is an exact information-form EKF:
+TEST(CRangeBearingKFSLAM2D, SEIF_without_sparsification_equals_EKF)
+{
+	const TSyntheticDataset dataset(40);
+
+	CRangeBearingKFSLAM2D ekf, seif;
+	ekf.KF_options.method = kfEKFNaive;
+	seif.KF_options.method = kfSEIF;
+	seif.KF_options.SEIF_max_active_landmarks = static_cast<int>(dataset.landmarks.size());
+	dataset.run(ekf);
+	dataset.run(seif);
+
+	const TSLAMState s_ekf(ekf), s_seif(seif);
+	ASSERT_EQ(s_ekf.landmarkIDs, s_seif.landmarkIDs);
+	ASSERT_EQ(s_ekf.mean.size(), s_seif.mean.size());
+	ASSERT_EQ(s_ekf.cov.rows(), s_seif.cov.rows());
+	EXPECT_GT(s_ekf.landmarks.size(), 50u);
+
+	EXPECT_LT( (s_ekf.mean-s_seif.mean).array().abs().maxCoeff(), 1e-5 );
+	EXPECT_LT( (s_ekf.cov-s_seif.cov).array().abs().maxCoeff(), 1e-6 );
+}
+
+// With sparsification, the estimate is approximate but must keep tracking the ground truth:
+TEST(CRangeBearingKFSLAM2D, SEIF_with_sparsification_is_consistent)
+{
+	const TSyntheticDataset dataset(40);
+
+	CRangeBearingKFSLAM2D seif;
+	seif.KF_options.method = kfSEIF;
+	seif.KF_options.SEIF_max_active_landmarks = 10;
+	dataset.run(seif);
+
+	const TSLAMState s(seif);
+	ASSERT_GT(s.landmarks.size(), 50u);
+
+	const CPose2D err = s.robot.mean - dataset.final_robot_pose;
+	EXPECT_LT(err.norm(), 0.3);
+	EXPECT_LT(std::abs(err.phi()), DEG2RAD(5.0));
+
+	for (size_t i=0;i<s.landmarks.size();i++)
+	{
+		const TPoint2D &gt = dataset.landmarks[s.landmarkIDs.find(i)->second];
+		EXPECT_LT(std::sqrt(square(s.landmarks[i].x-gt.x)+square(s.landmarks[i].y-gt.y)), 0.3) << "Landmark index #" << i;
+	}
+
+	// The covariance must remain a valid (symmetric, positive-definite) matrix:
+	EXPECT_LT( (s.cov-s.cov.transpose()).array().abs().maxCoeff(), 1e-9 );
+	EXPECT_GT( s.cov.eigenvalues().real().minCoeff(), 0 );
+}
@@ -10,6 +10,7 @@
 #include "slam-precomp.h"   // Precompiled headerss
 
 #include <mrpt/slam/TMonteCarloLocalizationParams.h>
+#include <set>
 
 using namespace mrpt;
 using namespace mrpt::utils;
@@ -40,3 +41,22 @@ TMonteCarloLocalizationParams & TMonteCarloLocalizationParams::operator =(const
 	KLD_params = o.KLD_params;
 	return *this;
 }
+
+/*---------------------------------------------------------------
+			prepareConcurrentObservationLikelihood
+ ---------------------------------------------------------------*/
+void TMonteCarloLocalizationParams::prepareConcurrentObservationLikelihood() const
+{
+	if (metricMap)
+	{
+		metricMap->prepareConcurrentObservationLikelihood();
+		return;
+	}
+	std::set<mrpt::maps::CMetricMap*> seen, prepared;
+	for (size_t i=0;i<metricMaps.size();i++)
+	{
+		mrpt::maps::CMetricMap *map = metricMaps[i];
+		if (!seen.insert(map).second && prepared.insert(map).second)
+			map->prepareConcurrentObservationLikelihood();
+	}
+}
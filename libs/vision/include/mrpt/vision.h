@@ -27,6 +27,7 @@ MRPT_WARNING("Including <mrpt/vision.h> makes compilation much slower, consider
 #include <mrpt/vision/CVideoFileWriter.h>
 #include <mrpt/vision/tracking.h>
 #include <mrpt/vision/descriptor_kdtrees.h>
+#include <mrpt/vision/CBinaryDescriptorIndex.h>
 #include <mrpt/vision/descriptor_pairing.h>
 #include <mrpt/vision/bundle_adjustment.h>
 #include <mrpt/vision/CUndistortMap.h>
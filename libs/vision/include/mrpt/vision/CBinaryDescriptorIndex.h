@@ -0,0 +1,124 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#ifndef mrpt_vision_CBinaryDescriptorIndex_H
+#define mrpt_vision_CBinaryDescriptorIndex_H
+
+#include <mrpt/vision/CFeature.h>
+#include <mrpt/utils/mrpt_stdint.h>
+#include <vector>
+#include <utility>
+
+#include <mrpt/vision/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace vision
+	{
+		/** \addtogroup  mrptvision_descr_kdtrees
+		    @{ */
+
+		/** An index of binary descriptors (e.g. ORB) for fast and exact nearest-neighbour search in Hamming space.
+		  *
+		  * Descriptors are split into `m` disjoint substrings of 8 or 16 bits, and each substring is indexed in one hash
+		  * table ("multi-index hashing", M. Norouzi, A. Punjani, D. Fleet, CVPR 2012). Since two descriptors at Hamming distance
+		  * `d` must have at least one substring at distance `<= d/m`, the tables are probed with increasingly distant substring
+		  * keys until the k nearest neighbours are guaranteed to have been found. If probing would cost more than a linear scan,
+		  * the remaining descriptors are scanned linearly instead. Either way results are exact: the same than a brute force search,
+		  * with ties in the distance resolved in favor of the lowest index.
+		  *
+		  * Descriptors can be taken from the ORB descriptors of a CFeatureList, or from a raw buffer with one descriptor per
+		  * row, e.g. the output of the OpenCV ORB extractor for the keypoints of a TSimpleFeatureList, in the same order.
+		  * Search results are indices in that list.
+		  *
+		  * Example of usage:
+		  *  \code
+		  *    CBinaryDescriptorIndex idx;
+		  *    idx.build(feats2);  // CFeatureList with ORB descriptors
+		  *    std::vector<std::pair<size_t,size_t> > matches;
+		  *    idx.matchRatioTest(feats1, 0.8f, 64, matches);
+		  *  \endcode
+		  * \sa CFeatureList, mrpt::vision::matchFeatures
+		  */
+		class VISION_IMPEXP CBinaryDescriptorIndex
+		{
+		public:
+			/** The index returned for non-existing neighbours in knnSearch() */
+			static const size_t INVALID_INDEX;
+
+			CBinaryDescriptorIndex();
+
+			/** Builds the index from `N` descriptors of `desc_len` bytes each, stored contiguously one after the other. Data are copied. */
+			void build(const uint8_t *descs, const size_t N, const size_t desc_len);
+			/** Builds the index from the ORB descriptors of a list of features, which must all have descriptors of the same length. */
+			void build(const CFeatureList &feats);
+
+			inline size_t size() const { return m_N; } //!< Number of indexed descriptors
+			inline size_t descriptorLength() const { return m_desc_len; } //!< Length of each descriptor, in bytes
+			inline const uint8_t *getDescriptor(size_t i) const { return &m_descs[i*m_desc_len]; }
+
+			/** Finds the (up to) `k` nearest neighbours of one descriptor (of length descriptorLength()), sorted by ascending distance.
+			  * \return The number of neighbours found: `min(k,size())` */
+			size_t knnSearch(const uint8_t *query, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist) const;
+
+			/** Finds the `k` nearest neighbours of each of the `nQueries` descriptors stored contiguously in `queries`, optionally in parallel.
+			  * \param[out] out_idx, out_dist The neighbours of query `q` are at `[q*k,(q+1)*k)`, sorted by ascending distance.
+			  *   If there are less than `k` descriptors in the index, the remaining entries are INVALID_INDEX.
+			  * \param numThreads Number of threads (0: all the cores). Results do not depend on it.
+			  */
+			void knnSearch(const uint8_t *queries, const size_t nQueries, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist, const unsigned int numThreads = 1) const;
+			/** \overload Taking the queries from the ORB descriptors of a list of features */
+			void knnSearch(const CFeatureList &queries, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist, const unsigned int numThreads = 1) const;
+
+			/** Matches each of the `nQueries` descriptors in `queries` to its nearest neighbour in the index, if its distance `d1` is not larger
+			  * than `max_dist` and it passes the ratio test `d1 < max_ratio * d2` against the second nearest neighbour (always passed if there is none).
+			  * Use `max_ratio>1` to disable the ratio test.
+			  * This is much faster than knnSearch() with `k=2`, since the search stops as soon as the result of the test is certain, usually long
+			  * before the (often far away) second neighbour is found.
+			  * \param[out] out_matches Pairs `(query index, index in this list)`, in ascending order of query.
+			  */
+			void matchRatioTest(const uint8_t *queries, const size_t nQueries, const float max_ratio, const uint32_t max_dist, std::vector<std::pair<size_t,size_t> > &out_matches, const unsigned int numThreads = 1) const;
+			/** \overload Taking the queries from the ORB descriptors of a list of features */
+			void matchRatioTest(const CFeatureList &queries, const float max_ratio, const uint32_t max_dist, std::vector<std::pair<size_t,size_t> > &out_matches, const unsigned int numThreads = 1) const;
+
+			/** Hamming distance between two binary descriptors of `len` bytes (uses the POPCNT instruction if the compiler targets it). */
+			static uint32_t hammingDistance(const uint8_t *a, const uint8_t *b, const size_t len);
+
+			/** Scratch memory of one search thread (internal use) */
+			struct TSearchScratch
+			{
+				std::vector<uint32_t> visited; //!< Stamp of the last query which evaluated each descriptor
+				uint32_t stamp;
+				std::vector<std::pair<uint32_t,size_t> > best; //!< (distance,index), sorted
+				TSearchScratch() : stamp(0) {}
+			};
+			/** Internal: k-NN search with the given scratch memory. Results are left in `scratch.best`.
+			  * If `ratio_test>0` (for matchRatioTest()), the search stops as soon as the outcome of the ratio test with `max_dist` and `ratio_test`
+			  * is certain: the nearest neighbour is then exact, but the others may be not. */
+			void knnSearch(const uint8_t *query, const size_t k, TSearchScratch &scratch, const float ratio_test = 0, const uint32_t max_dist = 0) const;
+
+		private:
+			size_t m_N, m_desc_len;
+			std::vector<uint8_t>  m_descs;       //!< All descriptors, contiguous
+			unsigned int          m_key_bits;    //!< Bits of each substring (8 or 16)
+			unsigned int          m_num_tables;  //!< Number of substrings (hash tables)
+			std::vector<std::vector<uint32_t> > m_bucket_first; //!< For each table: CSR offsets of each bucket (plus a last sentinel)
+			std::vector<std::vector<uint32_t> > m_bucket_items; //!< For each table: descriptor indices, sorted by bucket
+
+			void knnSearchBatch(const uint8_t *queries, const size_t nQueries, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist, const unsigned int numThreads, const float ratio_test, const uint32_t max_dist) const;
+
+			inline uint32_t substringKey(const uint8_t *desc, unsigned int table) const {
+				return m_key_bits==8 ? desc[table] : (static_cast<uint32_t>(desc[2*table]) | (static_cast<uint32_t>(desc[2*table+1])<<8));
+			}
+		};
+
+		/** @} */
+	}
+}
+#endif
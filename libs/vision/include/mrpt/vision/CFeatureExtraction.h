@@ -97,6 +97,12 @@ namespace mrpt
 				  */
 				bool FIND_SUBPIXEL;
 
+				/** Number of threads for the local detectors (FAST, FASTER), which are run over horizontal bands of the image, and for
+				  *  the per-feature descriptors (spin, polar and log-polar images) and KLT responses (default=1: no parallelization, 0: use all the cores).
+				  * The detected features and descriptors are exactly the same for any number of threads.
+				  */
+				unsigned int numThreads;
+
 				/** KLT Options */
 				struct VISION_IMPEXP TKLTOptions
 				{
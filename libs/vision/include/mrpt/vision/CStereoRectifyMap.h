@@ -29,7 +29,9 @@ namespace mrpt
 		  * Remember that the rectified images have a different set of intrinsic parameters than the
 		  *  original images, which can be retrieved with \a getRectifiedImageParams()
 		  *
-		  *  Works with grayscale or color images.
+		  *  Works with grayscale or color images. With linear interpolation (the default), 8-bit images are remapped with MRPT's
+		  *  own fixed-point bilinear interpolation, and the rows of both images are processed in a single pass, optionally
+		  *  split into several threads (see \a setNumThreads()).
 		  *
 		  *  Refer to the program stereo-calib-gui for a tool that generates the required stereo camera parameters
 		  *  from a set of stereo images of a checkerboard.
@@ -133,6 +135,12 @@ namespace mrpt
 			/** Get the currently selected interpolation method \sa setInterpolationMethod */
 			mrpt::utils::TInterpolationMethod getInterpolationMethod() const { return m_interpolation_method; }
 
+			/** Sets the number of threads for rectifying images (default=1, 0=all the cores). This parameter can be safely changed at any instant without consequences. */
+			void setNumThreads(unsigned int num_threads) { m_num_threads = num_threads; }
+
+			/** Get the number of threads for rectifying images \sa setNumThreads */
+			unsigned int getNumThreads() const { return m_num_threads; }
+
 			/** If enabled (default=false), the principal points in both output images will coincide.
 			  * \note Call this method before building the rectification maps, otherwise they'll be marked as invalid.
 			  */
@@ -174,7 +182,9 @@ namespace mrpt
 
 			/** Overloaded version for in-place rectification: replace input images with their rectified versions
 			  * If \a use_internal_mem_cache is set to \a true (recommended), will reuse over and over again the same
-			  * auxiliary images (kept internally to this object) needed for in-place rectification.
+			  * auxiliary images (kept internally to this object) needed for in-place rectification: rectified images are written
+			  * into them and then swapped with the input images, so no image is allocated nor copied once the sizes are stable.
+			  * Externally stored and read-only input images (see mrpt::utils::CImage::setFromImageReadOnly()) are never swapped: the results are copied into them.
 			  * The only reason not to enable this cache is when multiple threads can invoke this method simultaneously.
 			  */
 			void rectify(
@@ -211,6 +221,7 @@ namespace mrpt
 			bool     m_enable_both_centers_coincide;
 			mrpt::utils::TImageSize m_resize_output_value;
 			mrpt::utils::TInterpolationMethod m_interpolation_method;
+			unsigned int m_num_threads;
 
 			mutable mrpt::utils::CImage  m_cache1, m_cache2; //!< Memory caches for in-place rectification speed-up.
 
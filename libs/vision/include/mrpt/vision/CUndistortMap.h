@@ -22,7 +22,8 @@ namespace mrpt
 		  *  Using this class is much more efficient that calling mrpt::utils::CImage::rectifyImage or OpenCV's cvUndistort2(), since
 		  *  the remapping data is computed only once for the camera parameters (typical times: 640x480 image -> 70% build map / 30% actual undistort).
 		  *
-		  *  Works with grayscale or color images.
+		  *  Works with grayscale or color images. 8-bit images are remapped with MRPT's own fixed-point bilinear interpolation,
+		  *  optionally split by rows into several threads (see \a setNumThreads()).
 		  *
 		  * Example of usage:
 		  * \code
@@ -54,6 +55,7 @@ namespace mrpt
 			void setFromCamParams(const mrpt::utils::TCamera &params);
 
 			/** Undistort the input image and saves the result in the output one - \a setFromCamParams() must have been set prior to calling this.
+			  * The output image is only reallocated if it has not the right size and type already.
 			  */
 			void undistort(const mrpt::utils::CImage &in_img, mrpt::utils::CImage &out_img) const;
 
@@ -61,6 +63,11 @@ namespace mrpt
 			  */
 			void undistort(mrpt::utils::CImage &in_out_img) const;
 
+			/** Sets the number of threads for \a undistort() (default=1, 0=all the cores). This parameter can be safely changed at any instant. */
+			void setNumThreads(unsigned int num_threads) { m_num_threads = num_threads; }
+			/** Get the number of threads for \a undistort() \sa setNumThreads */
+			unsigned int getNumThreads() const { return m_num_threads; }
+
 			/** Returns the camera parameters which were used to generate the distortion map, as passed by the user to \a setFromCamParams */
 			inline const mrpt::utils::TCamera & getCameraParams() const { return m_camera_params; }
 
@@ -72,6 +79,7 @@ namespace mrpt
 		private:
 			std::vector<int16_t>  m_dat_mapx;
 			std::vector<uint16_t> m_dat_mapy;
+			unsigned int          m_num_threads;
 
 			mrpt::utils::TCamera  m_camera_params; //!< A copy of the data provided by the user
 
@@ -57,6 +57,13 @@ namespace mrpt
 		  *		- "num_fix_frames": Number of first frame poses to don't optimize (keep unmodified as they come in)  (default=1: the first pose is the reference and is not modified)
 		  *		- "num_fix_points": Idem, for the landmarks positions (default=0: optimize all)
 		  *		- "profiler": If !=0, displays profiling information to the console at return.
+		  *		- "solver": How to solve the reduced camera system (default=0): 0=sparse Cholesky; 1=preconditioned conjugate gradient (PCG), which needs much less memory for large problems with dense camera-camera connectivity.
+		  *		- "pcg_max_iterations": Maximum number of PCG iterations per step (default=100).
+		  *		- "pcg_tolerance": PCG stops when the norm of its residual is below this fraction of the norm of the right hand side (default=1e-6).
+		  *		- "num_threads": Number of threads for the residuals, the Jacobians, the Schur complement and the linear solver (default=1, 0 means one per core). The result does not depend on the number of threads.
+		  *
+		  * Internally, the landmarks are eliminated with the Schur complement, so only the (block-sparse) reduced camera system
+		  * of size `6*num_frames` is solved at each iteration, then the landmarks are recovered point by point.
 		  *
 		  * \note In this function, all coordinates are absolute. Camera frames are such that +Z points forward from the focal point (see the figure in mrpt::obs::CObservationImage).
 		  * \note The first frame pose will be not updated since at least one frame must remain fixed.
@@ -108,6 +115,7 @@ namespace mrpt
 		/** Compute reprojection error vector (used from within Bundle Adjustment methods, but can be used in general)
 		  *  See mrpt::vision::bundle_adj_full for a description of most parameters.
 		  * \param frame_poses_are_inverse If set to true, global camera poses are \f$ \ominus F \f$ instead of \f$ F \f$, for each F in frame_poses.
+		  * \param num_threads Number of threads among which the observations are split (0: one per core). The result does not depend on it.
 		  *
 		  *  \return Overall squared reprojection error.
 		  * \ingroup bundle_adj
@@ -121,7 +129,8 @@ namespace mrpt
 			const bool  frame_poses_are_inverse,
 			const bool  use_robust_kernel = true,
 			const double kernel_param = 3.0,
-			std::vector<double> * out_kernel_1st_deriv = NULL
+			std::vector<double> * out_kernel_1st_deriv = NULL,
+			const unsigned int num_threads = 1
 			);
 
 		//! \overload
@@ -15,6 +15,7 @@
 
 #include <mrpt/vision/CFeature.h>
 #include <mrpt/vision/TSimpleFeature.h>
+#include <mrpt/vision/CImagePyramid.h>
 #include <mrpt/utils/CImage.h>
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/utils/TParameters.h>
@@ -222,6 +223,10 @@ namespace mrpt
 		  *		- "LK_max_iters" (Default=10) Max. number of iterations in LK tracking.
 		  *		- "LK_epsilon" (Default=0.1) Minimum epsilon step in interations of LK_tracking.
 		  *		- "LK_max_tracking_error" (Default=150.0) The maximum "tracking error" of LK tracking such as a feature is marked as "lost".
+		  *		- "num_threads" (Default=1) Number of threads, each one tracking a chunk of the features (0: all the cores).
+		  *
+		  *  The grayscale pyramid of the new image is kept between calls, so when tracking through a video sequence (the old image
+		  *   of each call being the new one of the previous call) only one pyramid is built per frame.
 		  *
 		  *  \sa OpenCV's method cvCalcOpticalFlowPyrLK
 		  */
@@ -244,6 +249,7 @@ namespace mrpt
 				const mrpt::utils::CImage &new_img,
 				FEATLIST  &inout_featureList );
 
+			CImagePyramid m_prev_pyramid; //!< Grayscale pyramid of the last "new_img", to be reused as the next "old_img"
 		};
 
 
@@ -0,0 +1,322 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "vision-precomp.h"   // Precompiled headers
+
+#include <mrpt/vision/CBinaryDescriptorIndex.h>
+#include <mrpt/system/threads.h> // parallelForBlocks()
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64) && MRPT_HAS_SSE4_2
+#	include <intrin.h>
+#endif
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace std;
+
+const size_t CBinaryDescriptorIndex::INVALID_INDEX = static_cast<size_t>(-1);
+
+namespace
+{
+	inline uint32_t popcount64(uint64_t x)
+	{
+#if defined(__GNUC__)
+		return static_cast<uint32_t>(__builtin_popcountll(x)); // A single POPCNT with -msse4.2/-mpopcnt
+#elif defined(_MSC_VER) && defined(_M_X64) && MRPT_HAS_SSE4_2
+		return static_cast<uint32_t>(__popcnt64(x));
+#else
+		x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+		x = (x & UINT64_C(0x3333333333333333)) + ((x >> 2) & UINT64_C(0x3333333333333333));
+		x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+		return static_cast<uint32_t>((x * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+	}
+
+	// Inserts a candidate into the list of the (up to) k best (distance,index) pairs, sorted in ascending order.
+	inline void insertCandidate(std::vector<std::pair<uint32_t,size_t> > &best, const size_t k, const uint32_t dist, const size_t idx)
+	{
+		const std::pair<uint32_t,size_t> c(dist,idx);
+		if (best.size()==k)
+		{
+			if (!(c < best.back())) return;
+			best.pop_back();
+		}
+		best.insert(std::lower_bound(best.begin(),best.end(),c), c);
+	}
+
+	struct TKNNSearchData
+	{
+		const CBinaryDescriptorIndex *me;
+		const uint8_t *queries;
+		size_t k;
+		size_t *out_idx;
+		uint32_t *out_dist;
+		float ratio_test;
+		uint32_t max_dist;
+		std::vector<CBinaryDescriptorIndex::TSearchScratch> *thread_scratch;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) searching the neighbours of a block of queries.
+	void knnSearchBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		const TKNNSearchData &d = *static_cast<const TKNNSearchData*>(user_param);
+		CBinaryDescriptorIndex::TSearchScratch &scratch = (*d.thread_scratch)[thread_idx];
+		const size_t len = d.me->descriptorLength();
+		for (size_t q=first;q<last;q++)
+		{
+			d.me->knnSearch(d.queries + q*len, d.k, scratch, d.ratio_test, d.max_dist);
+			for (size_t i=0;i<d.k;i++)
+			{
+				const bool valid = i<scratch.best.size();
+				d.out_idx[q*d.k+i] = valid ? scratch.best[i].second : CBinaryDescriptorIndex::INVALID_INDEX;
+				d.out_dist[q*d.k+i] = valid ? scratch.best[i].first : std::numeric_limits<uint32_t>::max();
+			}
+		}
+	}
+
+	void getORBDescriptors(const CFeatureList &feats, std::vector<uint8_t> &descs, size_t &desc_len)
+	{
+		ASSERT_(!feats.empty() && feats[0]->descriptors.hasDescriptorORB())
+		desc_len = feats[0]->descriptors.ORB.size();
+		descs.resize(feats.size()*desc_len);
+		for (size_t i=0;i<feats.size();i++)
+		{
+			const std::vector<uint8_t> &orb = feats[i]->descriptors.ORB;
+			ASSERTMSG_(orb.size()==desc_len, "All features must have ORB descriptors of the same length")
+			std::memcpy(&descs[i*desc_len], &orb[0], desc_len);
+		}
+	}
+}
+
+uint32_t CBinaryDescriptorIndex::hammingDistance(const uint8_t *a, const uint8_t *b, const size_t len)
+{
+	uint32_t dist = 0;
+	size_t i = 0;
+	for (;i+8<=len;i+=8)
+	{
+		uint64_t x, y;
+		std::memcpy(&x,a+i,8);
+		std::memcpy(&y,b+i,8);
+		dist += popcount64(x^y);
+	}
+	for (;i<len;i++)
+		dist += popcount64(a[i]^b[i]);
+	return dist;
+}
+
+CBinaryDescriptorIndex::CBinaryDescriptorIndex() :
+	m_N(0),
+	m_desc_len(0),
+	m_key_bits(8),
+	m_num_tables(0)
+{
+}
+
+void CBinaryDescriptorIndex::build(const uint8_t *descs, const size_t N, const size_t desc_len)
+{
+	MRPT_START
+	ASSERT_(desc_len>0)
+	ASSERT_BELOW_(N, size_t(0xFFFFFFFF))
+
+	m_N = N;
+	m_desc_len = desc_len;
+	m_descs.assign(descs, descs + N*desc_len);
+
+	// Substrings of ~log2(N) bits are the best trade-off between the number of buckets to probe and their occupancy:
+	m_key_bits = (N>=4096 && (desc_len%2)==0) ? 16 : 8;
+	m_num_tables = static_cast<unsigned int>(desc_len*8 / m_key_bits);
+	const size_t nBuckets = size_t(1)<<m_key_bits;
+
+	m_bucket_first.resize(m_num_tables);
+	m_bucket_items.resize(m_num_tables);
+	for (unsigned int t=0;t<m_num_tables;t++)
+	{
+		// Counting sort of the descriptors by their t'th substring:
+		std::vector<uint32_t> &first = m_bucket_first[t];
+		std::vector<uint32_t> &items = m_bucket_items[t];
+		first.assign(nBuckets+1, 0);
+		for (size_t i=0;i<N;i++)
+			first[ substringKey(getDescriptor(i),t) + 1 ]++;
+		for (size_t b=0;b<nBuckets;b++)
+			first[b+1] += first[b];
+		items.resize(N);
+		std::vector<uint32_t> next(first.begin(), first.end()-1);
+		for (size_t i=0;i<N;i++)
+			items[ next[substringKey(getDescriptor(i),t)]++ ] = static_cast<uint32_t>(i);
+	}
+	MRPT_END
+}
+
+void CBinaryDescriptorIndex::build(const CFeatureList &feats)
+{
+	std::vector<uint8_t> descs;
+	size_t desc_len;
+	getORBDescriptors(feats, descs, desc_len);
+	this->build(&descs[0], feats.size(), desc_len);
+}
+
+void CBinaryDescriptorIndex::knnSearch(const uint8_t *query, const size_t k, TSearchScratch &scratch, const float ratio_test, const uint32_t max_dist) const
+{
+	std::vector<std::pair<uint32_t,size_t> > &best = scratch.best;
+	best.clear();
+	if (!m_N || !k) return;
+
+	// Stamps avoid clearing the "visited" flags of all descriptors for each query:
+	if (scratch.visited.size()!=m_N || ++scratch.stamp==0)
+	{
+		scratch.visited.assign(m_N,0);
+		scratch.stamp = 1;
+	}
+	const uint32_t stamp = scratch.stamp;
+	uint32_t *visited = &scratch.visited[0];
+	size_t nVisited = 0;
+
+	const uint32_t nKeys = uint32_t(1)<<m_key_bits;
+	double nKeysAtDist = 1; // Binomial coefficient C(key_bits, s)
+	for (unsigned int s=0;s<=m_key_bits;s++)
+	{
+		// Probing all the keys at distance s in all the tables is worth it only if it is cheaper than a linear scan
+		// (a random access to a bucket costs about as much as evaluating a few tens of contiguous descriptors):
+		if (nKeysAtDist*m_num_tables*32 > m_N-nVisited)
+		{
+			for (size_t i=0;i<m_N;i++)
+				if (visited[i]!=stamp)
+					insertCandidate(best,k, hammingDistance(query,getDescriptor(i),m_desc_len), i);
+			return;
+		}
+
+		for (unsigned int t=0;t<m_num_tables;t++)
+		{
+			const uint32_t q = substringKey(query,t);
+			const std::vector<uint32_t> &first = m_bucket_first[t];
+			const std::vector<uint32_t> &items = m_bucket_items[t];
+
+			// All the masks of key_bits bits with s bits set (Gosper's hack):
+			uint32_t mask = (uint32_t(1)<<s)-1;
+			while (mask<nKeys)
+			{
+				const uint32_t key = q ^ mask;
+				for (uint32_t j=first[key];j<first[key+1];j++)
+				{
+					const uint32_t i = items[j];
+					if (visited[i]==stamp) continue;
+					visited[i] = stamp;
+					nVisited++;
+					insertCandidate(best,k, hammingDistance(query,getDescriptor(i),m_desc_len), i);
+				}
+				if (!mask) break;
+				const uint32_t c = mask & (~mask+1), r = mask + c;
+				mask = (((r ^ mask) >> 2) / c) | r;
+			}
+		}
+		if (nVisited==m_N) return;
+
+		// Any descriptor not visited yet differs in more than s bits in every substring:
+		const uint32_t min_unvisited_dist = m_num_tables*(s+1);
+		if (best.size()==k && best.back().first < min_unvisited_dist)
+			return;
+		if (ratio_test>0)
+		{
+			// Passed: the nearest neighbour is final, and the 2nd one can't be close enough to make it ambiguous.
+			if (!best.empty() && best[0].first < min_unvisited_dist && best[0].first < ratio_test*min_unvisited_dist)
+				return;
+			// Failed: the nearest neighbour is too far.
+			if (min_unvisited_dist > max_dist && (best.empty() || best[0].first > max_dist))
+				return;
+		}
+
+		nKeysAtDist = nKeysAtDist * (m_key_bits-s) / (s+1);
+	}
+}
+
+size_t CBinaryDescriptorIndex::knnSearch(const uint8_t *query, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist) const
+{
+	TSearchScratch scratch;
+	knnSearch(query,k,scratch);
+	const size_t n = scratch.best.size();
+	out_idx.resize(n);
+	out_dist.resize(n);
+	for (size_t i=0;i<n;i++)
+	{
+		out_dist[i] = scratch.best[i].first;
+		out_idx[i] = scratch.best[i].second;
+	}
+	return n;
+}
+
+void CBinaryDescriptorIndex::knnSearch(const uint8_t *queries, const size_t nQueries, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist, const unsigned int numThreads) const
+{
+	knnSearchBatch(queries, nQueries, k, out_idx, out_dist, numThreads, 0, 0);
+}
+
+void CBinaryDescriptorIndex::knnSearchBatch(const uint8_t *queries, const size_t nQueries, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist, const unsigned int numThreads, const float ratio_test, const uint32_t max_dist) const
+{
+	MRPT_START
+	out_idx.resize(nQueries*k);
+	out_dist.resize(nQueries*k);
+	if (!nQueries || !k) return;
+
+	unsigned int nThreads = numThreads!=0 ? numThreads : mrpt::system::getNumberOfProcessors();
+	nThreads = std::min<unsigned int>(nThreads, static_cast<unsigned int>(std::min<size_t>(nQueries, 0xFFFF)));
+	std::vector<TSearchScratch> thread_scratch(nThreads);
+
+	TKNNSearchData d;
+	d.me = this;
+	d.queries = queries;
+	d.k = k;
+	d.out_idx = &out_idx[0];
+	d.out_dist = &out_dist[0];
+	d.ratio_test = ratio_test;
+	d.max_dist = max_dist;
+	d.thread_scratch = &thread_scratch;
+	mrpt::system::parallelForBlocks(nQueries, &knnSearchBlock, &d, nThreads);
+	MRPT_END
+}
+
+void CBinaryDescriptorIndex::knnSearch(const CFeatureList &queries, const size_t k, std::vector<size_t> &out_idx, std::vector<uint32_t> &out_dist, const unsigned int numThreads) const
+{
+	MRPT_START
+	std::vector<uint8_t> descs;
+	size_t desc_len;
+	getORBDescriptors(queries, descs, desc_len);
+	ASSERT_EQUAL_(desc_len, m_desc_len)
+	knnSearch(&descs[0], queries.size(), k, out_idx, out_dist, numThreads);
+	MRPT_END
+}
+
+void CBinaryDescriptorIndex::matchRatioTest(const uint8_t *queries, const size_t nQueries, const float max_ratio, const uint32_t max_dist, std::vector<std::pair<size_t,size_t> > &out_matches, const unsigned int numThreads) const
+{
+	std::vector<size_t> idx;
+	std::vector<uint32_t> dist;
+	knnSearchBatch(queries, nQueries, 2, idx, dist, numThreads, max_ratio, max_dist);
+
+	out_matches.clear();
+	for (size_t q=0;q<nQueries;q++)
+	{
+		if (idx[2*q]==INVALID_INDEX || dist[2*q]>max_dist)
+			continue;
+		if (idx[2*q+1]!=INVALID_INDEX && !(dist[2*q] < max_ratio*dist[2*q+1]))
+			continue;
+		out_matches.push_back( std::make_pair(q, idx[2*q]) );
+	}
+}
+
+void CBinaryDescriptorIndex::matchRatioTest(const CFeatureList &queries, const float max_ratio, const uint32_t max_dist, std::vector<std::pair<size_t,size_t> > &out_matches, const unsigned int numThreads) const
+{
+	MRPT_START
+	std::vector<uint8_t> descs;
+	size_t desc_len;
+	getORBDescriptors(queries, descs, desc_len);
+	ASSERT_EQUAL_(desc_len, m_desc_len)
+	matchRatioTest(&descs[0], queries.size(), max_ratio, max_dist, out_matches, numThreads);
+	MRPT_END
+}
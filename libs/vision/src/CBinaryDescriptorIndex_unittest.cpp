@@ -0,0 +1,142 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CBinaryDescriptorIndex.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using namespace mrpt::vision;
+
+namespace
+{
+	// N random descriptors, in clusters of descriptors a few bits apart (so there are close neighbours and ties):
+	void makeDescriptors(size_t N, size_t len, std::vector<uint8_t> &descs, mrpt::random::CRandomGenerator &rng)
+	{
+		descs.resize(N*len);
+		for (size_t i=0;i<N;i++)
+		{
+			if (i%4==0)
+				for (size_t k=0;k<len;k++) descs[i*len+k] = static_cast<uint8_t>(rng.drawUniform32bit());
+			else
+			{
+				std::copy(&descs[(i-1)*len], &descs[i*len], &descs[i*len]);
+				const uint32_t bit = rng.drawUniform32bit() % (len*8);
+				descs[i*len + bit/8] ^= (1 << (bit%8));
+			}
+		}
+	}
+
+	void bruteForceKNN(const std::vector<uint8_t> &descs, size_t len, const uint8_t *query, size_t k, std::vector<std::pair<uint32_t,size_t> > &out)
+	{
+		const size_t N = descs.size()/len;
+		out.resize(N);
+		for (size_t i=0;i<N;i++)
+			out[i] = std::make_pair(CBinaryDescriptorIndex::hammingDistance(query,&descs[i*len],len), i);
+		std::sort(out.begin(),out.end());
+		out.resize(std::min(k,N));
+	}
+
+	void checkKNNAgainstBruteForce(size_t N, size_t len)
+	{
+		mrpt::random::CRandomGenerator rng(N);
+		std::vector<uint8_t> descs, queries;
+		makeDescriptors(N, len, descs, rng);
+		makeDescriptors(40, len, queries, rng);
+		// Some queries identical to indexed descriptors:
+		std::copy(&descs[0], &descs[len], &queries[0]);
+
+		CBinaryDescriptorIndex idx;
+		idx.build(&descs[0], N, len);
+		EXPECT_EQ(idx.size(), N);
+
+		const size_t k = 5;
+		for (size_t q=0;q<queries.size()/len;q++)
+		{
+			std::vector<std::pair<uint32_t,size_t> > gt;
+			bruteForceKNN(descs, len, &queries[q*len], k, gt);
+
+			std::vector<size_t> out_idx;
+			std::vector<uint32_t> out_dist;
+			ASSERT_EQ(idx.knnSearch(&queries[q*len], k, out_idx, out_dist), gt.size());
+			for (size_t i=0;i<gt.size();i++)
+			{
+				EXPECT_EQ(out_dist[i], gt[i].first) << "N=" << N << " len=" << len << " q=" << q << " i=" << i;
+				EXPECT_EQ(out_idx[i], gt[i].second) << "N=" << N << " len=" << len << " q=" << q << " i=" << i;
+			}
+		}
+	}
+}
+
+TEST(CBinaryDescriptorIndex, hammingDistance)
+{
+	uint8_t a[37], b[37];
+	for (size_t i=0;i<sizeof(a);i++) { a[i] = static_cast<uint8_t>(i*37); b[i] = static_cast<uint8_t>(~a[i]); }
+	EXPECT_EQ(CBinaryDescriptorIndex::hammingDistance(a,a,sizeof(a)), 0u);
+	EXPECT_EQ(CBinaryDescriptorIndex::hammingDistance(a,b,sizeof(a)), 8*sizeof(a));
+	b[0] = a[0]; b[36] = a[36]^0x81;
+	EXPECT_EQ(CBinaryDescriptorIndex::hammingDistance(a,b,sizeof(a)), 8*sizeof(a)-8-6);
+}
+
+TEST(CBinaryDescriptorIndex, knnSameAsBruteForce)
+{
+	checkKNNAgainstBruteForce(3, 32);     // Less descriptors than k
+	checkKNNAgainstBruteForce(500, 32);   // 8-bit substrings
+	checkKNNAgainstBruteForce(500, 5);
+	checkKNNAgainstBruteForce(5000, 32);  // 16-bit substrings
+}
+
+TEST(CBinaryDescriptorIndex, batchAndRatioTest)
+{
+	const size_t N = 2000, len = 32;
+	mrpt::random::CRandomGenerator rng(1);
+	std::vector<uint8_t> descs, queries;
+	makeDescriptors(N, len, descs, rng);
+	makeDescriptors(100, len, queries, rng);
+	// Queries 0,1: unique close neighbour:
+	std::copy(&descs[17*len], &descs[18*len], &queries[0]);
+	for (size_t k=0;k<len;k++) descs[16*len+k] = descs[18*len+k] = static_cast<uint8_t>(~descs[17*len+k]);
+	std::copy(&descs[17*len], &descs[18*len], &queries[len]);
+	queries[len] ^= 0x07;
+
+	CBinaryDescriptorIndex idx;
+	idx.build(&descs[0], N, len);
+
+	const size_t nQueries = queries.size()/len;
+	std::vector<size_t> idx1, idx3;
+	std::vector<uint32_t> dist1, dist3;
+	idx.knnSearch(&queries[0], nQueries, 3, idx1, dist1, 1);
+	idx.knnSearch(&queries[0], nQueries, 3, idx3, dist3, 3);
+	ASSERT_EQ(idx1.size(), 3*nQueries);
+	EXPECT_TRUE(idx1==idx3);
+	EXPECT_TRUE(dist1==dist3);
+	EXPECT_EQ(idx1[0], 17u);
+	EXPECT_EQ(dist1[0], 0u);
+
+	std::vector<std::pair<size_t,size_t> > matches;
+	idx.matchRatioTest(&queries[0], nQueries, 0.8f, 64, matches, 2);
+	ASSERT_GE(matches.size(), 2u);
+	EXPECT_EQ(matches[0], std::make_pair(size_t(0),size_t(17)));
+	EXPECT_EQ(matches[1], std::make_pair(size_t(1),size_t(17)));
+	// Same matches than a ratio test with exact neighbours:
+	std::vector<std::pair<size_t,size_t> > gt_matches;
+	for (size_t q=0;q<nQueries;q++)
+		if (dist1[3*q]<=64 && dist1[3*q] < 0.8f*dist1[3*q+1])
+			gt_matches.push_back(std::make_pair(q,idx1[3*q]));
+	EXPECT_TRUE(matches==gt_matches);
+
+	// Less descriptors in the index than neighbours requested:
+	CBinaryDescriptorIndex small;
+	small.build(&descs[0], 1, len);
+	small.knnSearch(&queries[0], 2, 2, idx1, dist1);
+	EXPECT_EQ(idx1[0], 0u);
+	EXPECT_EQ(idx1[1], CBinaryDescriptorIndex::INVALID_INDEX);
+	small.matchRatioTest(&queries[0], 2, 0.8f, 1000, matches);
+	EXPECT_EQ(matches.size(), 2u);
+}
@@ -16,6 +16,7 @@
 #include <mrpt/utils/CStdOutStream.h>
 #include <mrpt/utils/stl_serialization.h>
 #include <mrpt/vision/CFeature.h>
+#include <mrpt/vision/CBinaryDescriptorIndex.h>
 #include <mrpt/vision/types.h>
 #include <mrpt/utils/stl_serialization.h>
 #include <mrpt/math/data_utils.h>
@@ -756,21 +757,8 @@ uint8_t CFeature::descriptorORBDistanceTo( const CFeature &oFeature ) const
 	ASSERT_( this->descriptors.hasDescriptorORB() && oFeature.descriptors.hasDescriptorORB() )
 	ASSERT_( this->descriptors.ORB.size() == oFeature.descriptors.ORB.size() )
 
-	const std::vector<uint8_t> & t_desc = this->descriptors.ORB;
-	const std::vector<uint8_t> & o_desc = oFeature.descriptors.ORB;
-
-	// Descriptors XOR + Hamming weight
-	uint8_t distance = 0;
-	for( uint8_t k = 0; k < t_desc.size(); ++k )
-	{
-		uint8_t x_or = t_desc[k] ^ o_desc[k];
-		uint8_t count;								// from : Wegner, Peter (1960), "A technique for counting ones in a binary computer", Communications of the ACM 3 (5): 322, doi:10.1145/367236.367286
-		for( count = 0; x_or; count++ )				// ...
-			x_or &= x_or-1;							// ...
-		distance += count;
-	}
-
-	return float(distance);
+	const uint32_t distance = CBinaryDescriptorIndex::hammingDistance( &this->descriptors.ORB[0], &oFeature.descriptors.ORB[0], this->descriptors.ORB.size() );
+	return static_cast<uint8_t>( std::min<uint32_t>(distance, 255) );  // Saturate (the maximum distance between 256 bit descriptors is 256)
 } // end-descriptorORBDistanceTo
 
 // --------------------------------------------------
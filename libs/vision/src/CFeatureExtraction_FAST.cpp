@@ -10,6 +10,7 @@
 #include "vision-precomp.h"   // Precompiled headers
 
 #include <mrpt/vision/CFeatureExtraction.h>
+#include "CFeatureExtraction_internal.h"
 
 // Universal include for all versions of OpenCV
 #include <mrpt/otherlibs/do_opencv_includes.h> 
@@ -22,6 +23,38 @@ using namespace mrpt::utils;
 using namespace mrpt::math;
 using namespace std;
 
+#if MRPT_HAS_OPENCV && MRPT_OPENCV_VERSION_NUM >= 0x211
+namespace
+{
+	// Runs OpenCV's FAST detector on a band of rows of the image (see mrpt::vision::detail::detectInRowBands())
+	struct TFASTRowBandDetector
+	{
+		const cv::Mat *img;
+		int  threshold;
+		bool nonmax_suppression;
+
+		void operator()(int y0_ext, int y1_ext, int y0, int y1, std::vector<cv::KeyPoint> &out) const
+		{
+			const cv::Mat band = img->rowRange(y0_ext,y1_ext);
+			std::vector<cv::KeyPoint> kps;
+#	if MRPT_OPENCV_VERSION_NUM < 0x300
+			cv::FastFeatureDetector fastDetector( threshold, nonmax_suppression );
+			fastDetector.detect( band, kps );
+#	else
+			cv::Ptr<cv::FastFeatureDetector> fastDetector = cv::FastFeatureDetector::create( threshold, nonmax_suppression );
+			fastDetector->detect( band, kps );
+#	endif
+			for (size_t i=0;i<kps.size();i++)
+			{
+				const float y = kps[i].pt.y + y0_ext;
+				if (y<y0 || y>=y1) continue; // Belongs to a neighbour band
+				kps[i].pt.y = y;
+				out.push_back(kps[i]);
+			}
+		}
+	};
+}
+#endif
 
 /************************************************************************************************
 *								extractFeaturesFAST												*
@@ -81,13 +114,14 @@ void  CFeatureExtraction::extractFeaturesFAST(
     }
 
 
-#	if MRPT_OPENCV_VERSION_NUM < 0x300
-	FastFeatureDetector fastDetector( options.FASTOptions.threshold, options.FASTOptions.nonmax_suppression );
-	fastDetector.detect( theImg, cv_feats );
-#else
-	Ptr<cv::FastFeatureDetector> fastDetector = cv::FastFeatureDetector::create(options.FASTOptions.threshold, options.FASTOptions.nonmax_suppression );
-	fastDetector->detect( theImg, cv_feats );
-#endif
+	// FAST is a local detector: run it over horizontal bands of the image in parallel. The margin between bands
+	// is the radius of the FAST circle (3) plus one pixel for the non-maximum suppression, so the result is
+	// exactly the same (and in the same order) than for the whole image at once.
+	TFASTRowBandDetector fastDetector;
+	fastDetector.img = &theImg;
+	fastDetector.threshold = options.FASTOptions.threshold;
+	fastDetector.nonmax_suppression = options.FASTOptions.nonmax_suppression;
+	mrpt::vision::detail::detectInRowBands(fastDetector, theImg.rows, 3+1, options.numThreads, cv_feats);
 
 #elif MRPT_OPENCV_VERSION_NUM >= 0x210
 	FAST(inImg_gray.getAs<IplImage>(), cv_feats, options.FASTOptions.threshold, options.FASTOptions.nonmax_suppression );
@@ -99,17 +133,8 @@ void  CFeatureExtraction::extractFeaturesFAST(
 	// Use KLT response instead of the OpenCV's original "response" field:
 	if (options.FASTOptions.use_KLT_response)
 	{
-		const unsigned int KLT_half_win = 4;
-		const unsigned int max_x = inImg_gray.getWidth() - 1 - KLT_half_win;
-		const unsigned int max_y = inImg_gray.getHeight() - 1 - KLT_half_win;
-		for (size_t i=0;i<N;i++)
-		{
-			const unsigned int x = cv_feats[i].pt.x;
-			const unsigned int y = cv_feats[i].pt.y;
-			if (x>KLT_half_win && y>KLT_half_win && x<=max_x && y<=max_y)
-					cv_feats[i].response = inImg_gray.KLT_response(x,y,KLT_half_win);
-			else	cv_feats[i].response = -100;
-		}
+		const int KLT_half_win = 4;
+		mrpt::vision::detail::computeKLTResponses(inImg_gray, KLT_half_win, options.numThreads, cv_feats);
 	}
 
 	// Now:
@@ -10,6 +10,7 @@
 #include "vision-precomp.h"   // Precompiled headers
 
 #include <mrpt/vision/CFeatureExtraction.h>
+#include "CFeatureExtraction_internal.h"
 
 // Universal include for all versions of OpenCV
 #include <mrpt/otherlibs/do_opencv_includes.h> 
@@ -25,6 +26,43 @@ using namespace mrpt::system;
 using namespace mrpt::utils;
 using namespace std;
 
+#if MRPT_HAS_OPENCV
+namespace
+{
+	// Runs one of the FASTER detectors on a band of rows of the image (see mrpt::vision::detail::detectInRowBands())
+	struct TFASTERRowBandDetector
+	{
+		const IplImage *img;
+		int N_fast, threshold;
+
+		void operator()(int y0_ext, int y1_ext, int y0, int y1, TSimpleFeatureList &out) const
+		{
+			// An image header for the band, sharing the pixels of the whole image:
+			IplImage band = *img;
+			band.roi = NULL;
+			band.height = y1_ext-y0_ext;
+			band.imageData = img->imageData + y0_ext*img->widthStep;
+			band.imageSize = band.height*band.widthStep;
+
+			TSimpleFeatureList corners;
+			switch (N_fast)
+			{
+			case 9:  fast_corner_detect_9 (&band,corners, threshold, 0, NULL); break;
+			case 10: fast_corner_detect_10(&band,corners, threshold, 0, NULL); break;
+			case 12: fast_corner_detect_12(&band,corners, threshold, 0, NULL); break;
+			};
+			for (size_t i=0;i<corners.size();i++)
+			{
+				const int y = corners[i].pt.y + y0_ext;
+				if (y<y0 || y>=y1) continue; // Belongs to a neighbour band
+				corners[i].pt.y = y;
+				out.push_back(corners[i]);
+			}
+		}
+	};
+}
+#endif
+
 
 // ------------  SSE2-optimized implementations of FASTER -------------
 void CFeatureExtraction::detectFeatures_SSE2_FASTER9(const CImage &img, TSimpleFeatureList & corners, const int threshold, bool append_to_list, uint8_t octave,std::vector<size_t> * out_feats_index_by_row)
@@ -90,14 +128,22 @@ void  CFeatureExtraction::extractFeaturesFASTER_N(
 
 	switch (N_fast)
 	{
-	case 9:  fast_corner_detect_9 (IPL,corners, options.FASTOptions.threshold, 0, NULL); type_of_this_feature=featFASTER9; break;
-	case 10: fast_corner_detect_10(IPL,corners, options.FASTOptions.threshold, 0, NULL); type_of_this_feature=featFASTER10; break;
-	case 12: fast_corner_detect_12(IPL,corners, options.FASTOptions.threshold, 0, NULL); type_of_this_feature=featFASTER12; break;
+	case 9:  type_of_this_feature=featFASTER9; break;
+	case 10: type_of_this_feature=featFASTER10; break;
+	case 12: type_of_this_feature=featFASTER12; break;
 	default:
 		THROW_EXCEPTION("Only the 9,10,12 FASTER detectors are implemented.")
 		break;
 	};
 
+	// FASTER has no non-maximum suppression, so bands of rows only need to overlap by the radius of
+	// the FAST circle (3) to give exactly the same corners than the whole image at once:
+	TFASTERRowBandDetector faster;
+	faster.img = IPL;
+	faster.N_fast = N_fast;
+	faster.threshold = options.FASTOptions.threshold;
+	mrpt::vision::detail::detectInRowBands(faster, IPL->height, 3, options.numThreads, corners);
+
 	// *All* the features have been extracted.
 	const size_t N = corners.size();
 
@@ -113,17 +159,7 @@ void  CFeatureExtraction::extractFeaturesFASTER_N(
 		)
 	{
 		const int KLT_half_win = 4;
-		const int max_x = inImg_gray.getWidth() - 1 - KLT_half_win;
-		const int max_y = inImg_gray.getHeight() - 1 - KLT_half_win;
-
-		for (size_t i=0;i<N;i++)
-		{
-			const int x = corners[i].pt.x;
-			const int y = corners[i].pt.y;
-			if (x>KLT_half_win && y>KLT_half_win && x<=max_x && y<=max_y)
-					corners[i].response = inImg_gray.KLT_response(x,y,KLT_half_win);
-			else	corners[i].response = -100;
-		}
+		mrpt::vision::detail::computeKLTResponses(inImg_gray, KLT_half_win, options.numThreads, corners);
 
 		std::sort( sorted_indices.begin(), sorted_indices.end(), KeypointResponseSorter<TSimpleFeatureList>(corners) );
 	}
@@ -283,6 +283,7 @@ CFeatureExtraction::TOptions::TOptions(const TFeatureType _featsType) :
 	FIND_SUBPIXEL	= true;					// Find subpixel
 	useMask         = false;                // Use mask for finding features
 	addNewFeatures  = false;                // Add to existing feature list
+	numThreads      = 1;                    // No parallelization
 
 	// Harris Options
 	harrisOptions.k				= 0.04f;
@@ -348,6 +349,7 @@ void CFeatureExtraction::TOptions::dumpToTextStream(mrpt::utils::CStream	&out) c
 	LOADABLEOPTS_DUMP_VAR(FIND_SUBPIXEL, bool)
 	LOADABLEOPTS_DUMP_VAR(useMask, bool)
 	LOADABLEOPTS_DUMP_VAR(addNewFeatures, bool)
+	LOADABLEOPTS_DUMP_VAR(numThreads, int)
 
 	LOADABLEOPTS_DUMP_VAR(harrisOptions.k,double)
 	LOADABLEOPTS_DUMP_VAR(harrisOptions.radius,int)
@@ -405,6 +407,7 @@ void CFeatureExtraction::TOptions::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR(FIND_SUBPIXEL, bool,  iniFile, section)
 	MRPT_LOAD_CONFIG_VAR(useMask, bool,  iniFile, section)
 	MRPT_LOAD_CONFIG_VAR(addNewFeatures, bool,  iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(numThreads, int,  iniFile, section)
 
 	//string sect = section;
 	MRPT_LOAD_CONFIG_VAR(harrisOptions.k,double,  iniFile,section)
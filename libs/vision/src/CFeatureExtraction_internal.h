@@ -0,0 +1,130 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#ifndef CFeatureExtraction_internal_H
+#define CFeatureExtraction_internal_H
+
+#include <mrpt/utils/CImage.h>
+#include <mrpt/system/threads.h> // parallelForBlocks()
+#include <vector>
+#include <algorithm>
+
+// Declarations shared between CFeatureExtraction_*.cpp files, but which are private to MRPT
+//  not to be seen by an MRPT API user.
+
+namespace mrpt
+{
+	namespace vision
+	{
+		namespace detail
+		{
+			/** Resolves CFeatureExtraction::TOptions::numThreads (0=all cores) into the actual number of threads for N items */
+			inline unsigned int featureExtractionThreads(unsigned int numThreads, size_t N)
+			{
+				unsigned int nThreads = numThreads!=0 ? numThreads : mrpt::system::getNumberOfProcessors();
+				if (N<nThreads) nThreads = static_cast<unsigned int>(N);
+				return nThreads!=0 ? nThreads : 1;
+			}
+
+			template <class FEATURE_LIST, class DETECTOR>
+			struct TRowBandsDetectionData
+			{
+				const DETECTOR *detector;
+				int img_height, margin;
+				std::vector<FEATURE_LIST> *thread_feats;
+			};
+
+			// Worker (for mrpt::system::parallelForBlocks) running the detector on one horizontal band of rows.
+			template <class FEATURE_LIST, class DETECTOR>
+			void detectInRowBandsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+			{
+				const TRowBandsDetectionData<FEATURE_LIST,DETECTOR> &d = *static_cast<const TRowBandsDetectionData<FEATURE_LIST,DETECTOR>*>(user_param);
+				const int y0 = static_cast<int>(first), y1 = static_cast<int>(last);
+				(*d.detector)(
+					std::max(0, y0-d.margin), std::min(d.img_height, y1+d.margin),
+					y0, y1,
+					(*d.thread_feats)[thread_idx] );
+			}
+
+			/** Runs a local keypoint detector over horizontal bands of the image in parallel.
+			  * Each band is extended with `margin` rows above and below (the support of the detector, including
+			  * its non-maximum suppression), so the keypoints found within the rows of each band are exactly
+			  * those the detector would find on the whole image. Bands are merged in top-down order, hence
+			  * the output keeps the raster order of the serial detector.
+			  *
+			  * \tparam DETECTOR A functor `void operator()(int y0_ext, int y1_ext, int y0, int y1, FEATURE_LIST &out) const`
+			  *  detecting keypoints in rows `[y0_ext,y1_ext)` and appending to `out` only those in rows `[y0,y1)`, in image coordinates.
+			  */
+			template <class FEATURE_LIST, class DETECTOR>
+			void detectInRowBands(const DETECTOR &detector, const int img_height, const int margin, const unsigned int numThreads, FEATURE_LIST &out)
+			{
+				const unsigned int nThreads = featureExtractionThreads(numThreads, img_height);
+				std::vector<FEATURE_LIST> thread_feats(nThreads);
+
+				TRowBandsDetectionData<FEATURE_LIST,DETECTOR> d;
+				d.detector = &detector;
+				d.img_height = img_height;
+				d.margin = margin;
+				d.thread_feats = &thread_feats;
+				mrpt::system::parallelForBlocks(img_height, &detectInRowBandsBlock<FEATURE_LIST,DETECTOR>, &d, nThreads);
+
+				size_t N = 0;
+				for (unsigned int t=0;t<nThreads;t++) N+=thread_feats[t].size();
+				out.reserve(N);
+				for (unsigned int t=0;t<nThreads;t++)
+					for (size_t i=0;i<thread_feats[t].size();i++)
+						out.push_back(thread_feats[t][i]);
+			}
+
+			template <class FEATURE_LIST>
+			struct TKLTResponseData
+			{
+				const mrpt::utils::CImage *img_gray;
+				FEATURE_LIST *feats;
+				int half_win, max_x, max_y;
+			};
+
+			// Worker (for mrpt::system::parallelForBlocks) evaluating the KLT response for a block of keypoints.
+			template <class FEATURE_LIST>
+			void computeKLTResponseBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+			{
+				MRPT_UNUSED_PARAM(thread_idx);
+				const TKLTResponseData<FEATURE_LIST> &d = *static_cast<const TKLTResponseData<FEATURE_LIST>*>(user_param);
+				FEATURE_LIST &feats = *d.feats;
+				for (size_t i=first;i<last;i++)
+				{
+					const int x = feats[i].pt.x;
+					const int y = feats[i].pt.y;
+					if (x>d.half_win && y>d.half_win && x<=d.max_x && y<=d.max_y)
+							feats[i].response = d.img_gray->KLT_response(x,y,d.half_win);
+					else	feats[i].response = -100;
+				}
+			}
+
+			/** Overwrites the `response` of all the keypoints with CImage::KLT_response() (or -100 too close to the image border), in parallel.
+			  * \tparam FEATURE_LIST Either `std::vector<cv::KeyPoint>` or mrpt::vision::TSimpleFeatureList
+			  */
+			template <class FEATURE_LIST>
+			void computeKLTResponses(const mrpt::utils::CImage &img_gray, const int half_win, const unsigned int numThreads, FEATURE_LIST &feats)
+			{
+				if (feats.empty()) return;
+				TKLTResponseData<FEATURE_LIST> d;
+				d.img_gray = &img_gray;
+				d.feats = &feats;
+				d.half_win = half_win;
+				d.max_x = static_cast<int>(img_gray.getWidth()) - 1 - half_win;  // Also makes sure a delayed-load image is loaded before spawning threads
+				d.max_y = static_cast<int>(img_gray.getHeight()) - 1 - half_win;
+				mrpt::system::parallelForBlocks(feats.size(), &computeKLTResponseBlock<FEATURE_LIST>, &d, featureExtractionThreads(numThreads, feats.size()));
+			}
+
+		}
+	}
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include "vision-precomp.h"   // Precompiled headers
 
 #include <mrpt/vision/CFeatureExtraction.h>
+#include "CFeatureExtraction_internal.h"
 
 // Universal include for all versions of OpenCV
 #include <mrpt/otherlibs/do_opencv_includes.h> 
@@ -21,6 +22,47 @@ using namespace mrpt::system;
 using namespace std;
 
 
+#if MRPT_HAS_OPENCV
+namespace
+{
+	struct TLogPolarImagesData
+	{
+		const mrpt::utils::CImage *img;
+		CFeatureList *feats;
+		unsigned int radius, patch_w, patch_h;
+		double rho_scale;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) computing the log-polar image of a block of features.
+	void computeLogPolarImagesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TLogPolarImagesData &d = *static_cast<const TLogPolarImagesData*>(user_param);
+
+		mrpt::utils::CImage	logpolar_frame( d.patch_w, d.patch_h, d.img->getChannelCount() );
+
+		for (size_t i=first;i<last;i++)
+		{
+			CFeaturePtr &ft = (*d.feats)[i];
+
+			// Overwrite scale with the descriptor scale:
+			ft->scale = d.radius;
+
+			// Use OpenCV to convert:
+			cvLogPolar(
+				d.img->getAs<IplImage>(),
+				logpolar_frame.getAs<IplImage>(),
+				cvPoint2D32f( ft->x,ft->y ),
+				d.rho_scale,
+				CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS );
+
+			// Get the image as a matrix and save as patch:
+			logpolar_frame.getAsMatrix( ft->descriptors.LogPolarImg );
+		}
+	}
+}
+#endif
+
 /************************************************************************************************
 								computeLogPolarImageDescriptors
 ************************************************************************************************/
@@ -34,33 +76,19 @@ void  CFeatureExtraction::internal_computeLogPolarImageDescriptors(
 	ASSERT_(options.LogPolarImagesOptions.radius>1)
 	ASSERT_(options.LogPolarImagesOptions.num_angles>1)
 	ASSERT_(options.LogPolarImagesOptions.rho_scale>0)
-
-	const unsigned int radius = options.LogPolarImagesOptions.radius;
-	const unsigned int patch_h = options.LogPolarImagesOptions.num_angles;
-	const double rho_scale = options.LogPolarImagesOptions.rho_scale;
-	const unsigned int patch_w = rho_scale * std::log(static_cast<double>(radius));
-
-	mrpt::utils::CImage	logpolar_frame( patch_w, patch_h, in_img.getChannelCount() );
-
-	// Compute intensity-domain spin images
-	for (CFeatureList::iterator it=in_features.begin();it!=in_features.end();++it)
-	{
-		// Overwrite scale with the descriptor scale:
-		(*it)->scale = radius;
-
-		// Use OpenCV to convert:
-		cvLogPolar(
-			in_img.getAs<IplImage>(),
-			logpolar_frame.getAs<IplImage>(),
-			cvPoint2D32f( (*it)->x,(*it)->y ),
-			rho_scale,
-			CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS );
-
-		// Get the image as a matrix and save as patch:
-		logpolar_frame.getAsMatrix( (*it)->descriptors.LogPolarImg );
-
-	} // end for it
-
+	if (in_features.empty()) return;
+
+	TLogPolarImagesData d;
+	d.img = &in_img;
+	d.feats = &in_features;
+	d.radius = options.LogPolarImagesOptions.radius;
+	d.patch_h = options.LogPolarImagesOptions.num_angles;
+	d.rho_scale = options.LogPolarImagesOptions.rho_scale;
+	d.patch_w = d.rho_scale * std::log(static_cast<double>(d.radius));
+
+	// Each thread uses its own output frame:
+	in_img.getWidth(); // Makes sure a delayed-load image is loaded before spawning threads
+	mrpt::system::parallelForBlocks(in_features.size(), &computeLogPolarImagesBlock, &d, mrpt::vision::detail::featureExtractionThreads(options.numThreads, in_features.size()));
 
 #else
 		THROW_EXCEPTION("This method needs MRPT compiled with OpenCV support")
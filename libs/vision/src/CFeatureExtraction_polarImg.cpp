@@ -10,6 +10,7 @@
 #include "vision-precomp.h"   // Precompiled headers
 
 #include <mrpt/vision/CFeatureExtraction.h>
+#include "CFeatureExtraction_internal.h"
 
 // Universal include for all versions of OpenCV
 #include <mrpt/otherlibs/do_opencv_includes.h> 
@@ -127,6 +128,50 @@ void my_cvLinearPolar( const CvArr* srcarr, CvArr* dstarr,
 #endif
 
 
+#if MRPT_HAS_OPENCV
+namespace
+{
+	struct TPolarImagesData
+	{
+		const mrpt::utils::CImage *img;
+		CFeatureList *feats;
+		unsigned int radius, patch_w, patch_h;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) computing the polar image of a block of features.
+	void computePolarImagesBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TPolarImagesData &d = *static_cast<const TPolarImagesData*>(user_param);
+
+		mrpt::utils::CImage	linpolar_frame( d.patch_w, d.patch_h, d.img->getChannelCount() );
+
+		for (size_t i=first;i<last;i++)
+		{
+			CFeaturePtr &ft = (*d.feats)[i];
+
+			// Overwrite scale with the descriptor scale:
+			ft->scale = d.radius;
+
+			// Use OpenCV to convert:
+#if MRPT_OPENCV_VERSION_NUM < 0x111
+			my_cvLinearPolar(	// Use version embedded above in this file
+#else
+			cvLinearPolar(		// Use version sent to OpenCV
+#endif
+				d.img->getAs<IplImage>(),
+				linpolar_frame.getAs<IplImage>(),
+				cvPoint2D32f( ft->x,ft->y ),
+				d.radius,
+				CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS );
+
+			// Get the image as a matrix and save as patch:
+			linpolar_frame.getAsMatrix( ft->descriptors.PolarImg );
+		}
+	}
+}
+#endif
+
 /************************************************************************************************
 								computePolarImageDescriptors
 ************************************************************************************************/
@@ -140,35 +185,18 @@ void  CFeatureExtraction::internal_computePolarImageDescriptors(
 	ASSERT_(options.PolarImagesOptions.radius>1)
 	ASSERT_(options.PolarImagesOptions.bins_angle>1)
 	ASSERT_(options.PolarImagesOptions.bins_distance>1)
-
-	const unsigned int radius = options.PolarImagesOptions.radius;
-	const unsigned int patch_w = options.PolarImagesOptions.bins_distance;
-	const unsigned int patch_h = options.PolarImagesOptions.bins_angle;
-
-	CImage	linpolar_frame( patch_w, patch_h, in_img.getChannelCount() );
-
-	// Compute intensity-domain spin images
-	for (CFeatureList::iterator it=in_features.begin();it!=in_features.end();++it)
-	{
-		// Overwrite scale with the descriptor scale:
-		(*it)->scale = radius;
-
-		// Use OpenCV to convert:
-#if MRPT_OPENCV_VERSION_NUM < 0x111
-		my_cvLinearPolar(	// Use version embedded above in this file
-#else
-		cvLinearPolar(		// Use version sent to OpenCV
-#endif
-			in_img.getAs<IplImage>(),
-			linpolar_frame.getAs<IplImage>(),
-			cvPoint2D32f( (*it)->x,(*it)->y ),
-			radius,
-			CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS );
-
-		// Get the image as a matrix and save as patch:
-		linpolar_frame.getAsMatrix( (*it)->descriptors.PolarImg );
-
-	} // end for it
+	if (in_features.empty()) return;
+
+	TPolarImagesData d;
+	d.img = &in_img;
+	d.feats = &in_features;
+	d.radius = options.PolarImagesOptions.radius;
+	d.patch_w = options.PolarImagesOptions.bins_distance;
+	d.patch_h = options.PolarImagesOptions.bins_angle;
+
+	// Each thread uses its own output frame:
+	in_img.getWidth(); // Makes sure a delayed-load image is loaded before spawning threads
+	mrpt::system::parallelForBlocks(in_features.size(), &computePolarImagesBlock, &d, mrpt::vision::detail::featureExtractionThreads(options.numThreads, in_features.size()));
 
 #else
 		THROW_EXCEPTION("This method needs MRPT compiled with OpenCV support")
@@ -0,0 +1,97 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CFeatureExtraction.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+#if MRPT_HAS_OPENCV
+
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+
+namespace
+{
+	// A grayscale image with random bright/dark rectangles, full of corners:
+	void makeTestImage(CImage &img)
+	{
+		mrpt::random::CRandomGenerator rng(1234);
+		img = CImage(320,240,CH_GRAY);
+		img.filledRectangle(0,0,319,239,TColor(128,128,128));
+		for (int i=0;i<60;i++)
+		{
+			const int x0 = rng.drawUniform32bit() % 300, y0 = rng.drawUniform32bit() % 220;
+			const int lx = 5 + rng.drawUniform32bit() % 40, ly = 5 + rng.drawUniform32bit() % 40;
+			const uint8_t v = rng.drawUniform32bit() % 256;
+			img.filledRectangle(x0,y0,x0+lx,y0+ly,TColor(v,v,v));
+		}
+	}
+
+	void detectWithThreads(TFeatureType type, unsigned int numThreads, CFeatureList &feats)
+	{
+		CImage img;
+		makeTestImage(img);
+		CFeatureExtraction fe;
+		fe.options.featsType = type;
+		fe.options.patchSize = 0;
+		fe.options.FASTOptions.threshold = 20;
+		fe.options.FASTOptions.use_KLT_response = true;
+		fe.options.numThreads = numThreads;
+		fe.detectFeatures(img, feats);
+	}
+}
+
+TEST(CFeatureExtraction, parallelDetectionSameAsSerial)
+{
+	const TFeatureType types[] = { featFAST, featFASTER9, featFASTER12 };
+	for (size_t t=0;t<sizeof(types)/sizeof(types[0]);t++)
+	{
+		CFeatureList feats1;
+		detectWithThreads(types[t], 1, feats1);
+		EXPECT_GT(feats1.size(), 10u);
+
+		for (unsigned int nThreads=2;nThreads<=7;nThreads+=5)
+		{
+			CFeatureList featsN;
+			detectWithThreads(types[t], nThreads, featsN);
+			ASSERT_EQ(feats1.size(), featsN.size()) << "type=" << types[t] << " nThreads=" << nThreads;
+			for (size_t i=0;i<feats1.size();i++)
+			{
+				EXPECT_EQ(feats1[i]->x, featsN[i]->x);
+				EXPECT_EQ(feats1[i]->y, featsN[i]->y);
+				EXPECT_EQ(feats1[i]->response, featsN[i]->response);
+			}
+		}
+	}
+}
+
+TEST(CFeatureExtraction, parallelSpinImagesSameAsSerial)
+{
+	CImage img;
+	makeTestImage(img);
+
+	CFeatureList feats1, feats4;
+	detectWithThreads(featFAST, 1, feats1);
+	feats4.copyListFrom(feats1);
+	ASSERT_GT(feats1.size(), 3u);
+
+	CFeatureExtraction fe;
+	fe.options.numThreads = 1;
+	fe.computeDescriptors(img, feats1, descSpinImages);
+	fe.options.numThreads = 4;
+	fe.computeDescriptors(img, feats4, descSpinImages);
+
+	for (size_t i=0;i<feats1.size();i++)
+	{
+		ASSERT_FALSE(feats1[i]->descriptors.SpinImg.empty());
+		EXPECT_TRUE(feats1[i]->descriptors.SpinImg == feats4[i]->descriptors.SpinImg);
+	}
+}
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "vision-precomp.h"   // Precompiled headers
 #include <mrpt/vision/CStereoRectifyMap.h>
+#include "remap_internal.h"
 
 // Universal include for all versions of OpenCV
 #include <mrpt/otherlibs/do_opencv_includes.h> 
@@ -26,7 +27,8 @@ CStereoRectifyMap::CStereoRectifyMap() :
 	m_resize_output(false),
 	m_enable_both_centers_coincide(false),
 	m_resize_output_value(0,0),
-	m_interpolation_method(mrpt::utils::IMG_INTERP_LINEAR)
+	m_interpolation_method(mrpt::utils::IMG_INTERP_LINEAR),
+	m_num_threads(1)
 {
 }
 
@@ -336,13 +338,24 @@ void CStereoRectifyMap::rectify(
 
 	if (use_internal_mem_cache)
 	{
-		// Copy the data: we have avoided one allocation & one deallocation
-		// (If the sizes match, these calls have no effects)
-		left_image.resize( trg_size.width, trg_size.height, left_image.isColor() ? 3:1, left_image.isOriginTopLeft() );
-		right_image.resize( trg_size.width, trg_size.height, right_image.isColor() ? 3:1, right_image.isOriginTopLeft() );
-
-		cvCopy(out_left_image,  left_image.getAs<IplImage>());
-		cvCopy(out_right_image, right_image.getAs<IplImage>());
+		if (!left_image.isExternallyStored() && !right_image.isExternallyStored() &&
+		    !left_image.isReadOnly() && !right_image.isReadOnly())
+		{
+			// Swap the buffers: the input images become the caches for the next call, with no allocation nor copy at all.
+			left_image.swap(m_cache1);
+			right_image.swap(m_cache2);
+		}
+		else
+		{
+			// Copy the data, not to leave in the caches images marked as externally stored, or memory owned by someone else:
+			// we have avoided one allocation & one deallocation
+			// (If the sizes match, these calls have no effects)
+			left_image.resize( trg_size.width, trg_size.height, left_image.isColor() ? 3:1, left_image.isOriginTopLeft() );
+			right_image.resize( trg_size.width, trg_size.height, right_image.isColor() ? 3:1, right_image.isOriginTopLeft() );
+
+			cvCopy(out_left_image,  left_image.getAs<IplImage>());
+			cvCopy(out_right_image, right_image.getAs<IplImage>());
+		}
 	}
 	else
 	{
@@ -401,6 +414,20 @@ void CStereoRectifyMap::rectify_IPL(
 	const uint32_t ncols_out = m_resize_output ? m_resize_output_value.x : ncols;
 	const uint32_t nrows_out = m_resize_output ? m_resize_output_value.y : nrows;
 
+	// 8-bit images with linear interpolation: rectify both images in one parallel pass with the fixed-point maps.
+	if (m_interpolation_method==mrpt::utils::IMG_INTERP_LINEAR)
+	{
+		std::vector<mrpt::vision::detail::TFixedPointRemapJob> jobs(2);
+		if (mrpt::vision::detail::makeFixedPointRemapJob(srcImg_left, outImg_left, &m_dat_mapx_left[0], &m_dat_mapy_left[0], jobs[0]) &&
+			mrpt::vision::detail::makeFixedPointRemapJob(srcImg_right, outImg_right, &m_dat_mapx_right[0], &m_dat_mapy_right[0], jobs[1]) &&
+			jobs[0].dst_width==int(ncols_out) && jobs[0].dst_height==int(nrows_out) &&
+			jobs[1].dst_width==int(ncols_out) && jobs[1].dst_height==int(nrows_out) )
+		{
+			mrpt::vision::detail::remapBilinearFixedPoint(jobs, m_num_threads);
+			return;
+		}
+	}
+
 	const CvMat mapx_left = cvMat(nrows_out,ncols_out,  CV_16SC2, const_cast<int16_t*>(&m_dat_mapx_left[0]) );
 	const CvMat mapy_left = cvMat(nrows_out,ncols_out,  CV_16UC1, const_cast<uint16_t*>(&m_dat_mapy_left[0]) );
 	const CvMat mapx_right = cvMat(nrows_out,ncols_out,  CV_16SC2, const_cast<int16_t*>(&m_dat_mapx_right[0]) );
@@ -0,0 +1,159 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CStereoRectifyMap.h>
+#include <mrpt/vision/CUndistortMap.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+#if MRPT_HAS_OPENCV
+
+// Universal include for all versions of OpenCV
+#include <mrpt/otherlibs/do_opencv_includes.h>
+
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+
+namespace
+{
+	void makeTestImage(CImage &img, bool color, uint32_t seed)
+	{
+		mrpt::random::CRandomGenerator rng(seed);
+		img = CImage(640,480, color ? CH_RGB : CH_GRAY);
+		for (unsigned int y=0;y<480;y++)
+			for (unsigned int x=0;x<640;x++)
+				img.setPixel(x,y, rng.drawUniform32bit() & 0xFFFFFF);
+	}
+
+	bool sameImages(const CImage &a, const CImage &b)
+	{
+		if (a.getWidth()!=b.getWidth() || a.getHeight()!=b.getHeight() || a.getChannelCount()!=b.getChannelCount()) return false;
+		for (unsigned int y=0;y<a.getHeight();y++)
+			for (unsigned int x=0;x<a.getWidth();x++)
+				for (unsigned int c=0;c<a.getChannelCount();c++)
+					if (*a(x,y,c) != *b(x,y,c)) return false;
+		return true;
+	}
+
+	TCamera getDistortedCamera()
+	{
+		TCamera cam;
+		cam.dist[0] = -0.3; cam.dist[1] = 0.1; cam.dist[2] = 1e-3; cam.dist[3] = -2e-3;
+		return cam;
+	}
+}
+
+TEST(CUndistortMap, parallelAndInPlaceSameAsSerial)
+{
+	for (int color=0;color<2;color++)
+	{
+		CImage img, out1, out4, in_place;
+		makeTestImage(img, color!=0, 123);
+
+		CUndistortMap unmap;
+		unmap.setFromCamParams(getDistortedCamera());
+		unmap.undistort(img, out1);
+		unmap.setNumThreads(4);
+		unmap.undistort(img, out4);
+		in_place = img;
+		unmap.undistort(in_place);
+
+		EXPECT_EQ(out1.getWidth(), 640u);
+		EXPECT_EQ(out1.isColor(), color!=0);
+		EXPECT_TRUE(sameImages(out1,out4));
+		EXPECT_TRUE(sameImages(out1,in_place));
+	}
+}
+
+// The fixed-point remap must give exactly the same pixels than OpenCV with the same maps:
+TEST(CUndistortMap, sameAsOpenCVRemap)
+{
+	for (int color=0;color<2;color++)
+	{
+		CImage img, out;
+		makeTestImage(img, color!=0, 321);
+
+		const TCamera cam = getDistortedCamera();
+		CUndistortMap unmap;
+		unmap.setFromCamParams(cam);
+		unmap.setNumThreads(2);
+		unmap.undistort(img, out);
+
+		// Same maps than CUndistortMap::setFromCamParams():
+		double aux1[3][3], aux2[1][5];
+		for (int i=0;i<3;i++)
+			for (int j=0;j<3;j++)
+				aux1[i][j] = cam.intrinsicParams(i,j);
+		for (int i=0;i<5;i++)
+			aux2[0][i] = cam.dist[i];
+		const cv::Mat inMat( 3,3, CV_64F, aux1 );
+		const cv::Mat distM( 1, 5, CV_64F, aux2 );
+		cv::Mat map1, map2;
+		cv::initUndistortRectifyMap( inMat, distM, cv::Mat(), inMat, cv::Size(cam.ncols,cam.nrows), CV_16SC2, map1, map2 );
+
+		const cv::Mat src = cv::cvarrToMat( img.getAs<IplImage>() );
+		cv::Mat ref;
+		cv::remap( src, ref, map1, map2, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar() );
+
+		ASSERT_EQ(out.getWidth(), static_cast<size_t>(ref.cols));
+		ASSERT_EQ(out.getHeight(), static_cast<size_t>(ref.rows));
+		ASSERT_EQ(out.getChannelCount(), static_cast<TImageChannels>(ref.channels()));
+		size_t nDiffs = 0;
+		for (int y=0;y<ref.rows;y++)
+			for (int x=0;x<ref.cols;x++)
+				for (int c=0;c<ref.channels();c++)
+					if (*out(x,y,c) != ref.ptr<uint8_t>(y)[x*ref.channels()+c]) nDiffs++;
+		EXPECT_EQ(nDiffs, 0u) << "color=" << color;
+	}
+}
+
+TEST(CStereoRectifyMap, parallelAndInPlaceSameAsSerial)
+{
+	TStereoCamera params;
+	params.leftCamera = getDistortedCamera();
+	params.rightCamera = getDistortedCamera();
+	params.rightCameraPose = mrpt::poses::CPose3DQuat(0.12,0.01,0, mrpt::math::CQuaternionDouble());
+
+	CStereoRectifyMap rectify_map;
+	rectify_map.setFromCamParams(params);
+
+	CImage left, right, out_left1, out_right1, out_left3, out_right3;
+	makeTestImage(left, true, 1);
+	makeTestImage(right, true, 2);
+
+	rectify_map.rectify(left, right, out_left1, out_right1);
+	rectify_map.setNumThreads(3);
+	rectify_map.rectify(left, right, out_left3, out_right3);
+	EXPECT_TRUE(sameImages(out_left1,out_left3));
+	EXPECT_TRUE(sameImages(out_right1,out_right3));
+
+	// In place, twice to also reuse the internal buffers:
+	for (int i=0;i<2;i++)
+	{
+		CImage l = left, r = right;
+		rectify_map.rectify(l, r);
+		EXPECT_TRUE(sameImages(out_left1,l));
+		EXPECT_TRUE(sameImages(out_right1,r));
+	}
+
+	// In place on read-only wrappers: the output goes to the wrapped buffers, which
+	// must not end up in the internal caches (they are freed before the next call):
+	for (int i=0;i<2;i++)
+	{
+		CImage l_buf = left, r_buf = right;
+		CImage l, r;
+		l.setFromImageReadOnly(l_buf);
+		r.setFromImageReadOnly(r_buf);
+		rectify_map.rectify(l, r);
+		EXPECT_TRUE(sameImages(out_left1,l_buf));
+		EXPECT_TRUE(sameImages(out_right1,r_buf));
+	}
+}
+
+#endif
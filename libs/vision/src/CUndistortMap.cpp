@@ -9,6 +9,7 @@
 
 #include "vision-precomp.h"   // Precompiled headers
 #include <mrpt/vision/CUndistortMap.h>
+#include "remap_internal.h"
 
 // Universal include for all versions of OpenCV
 #include <mrpt/otherlibs/do_opencv_includes.h> 
@@ -18,7 +19,8 @@ using namespace mrpt::vision;
 
 
 // Ctor: Leave all vectors empty
-CUndistortMap::CUndistortMap()
+CUndistortMap::CUndistortMap() :
+	m_num_threads(1)
 {
 }
 
@@ -59,7 +61,7 @@ void CUndistortMap::setFromCamParams(const mrpt::utils::TCamera &campar)
 	MRPT_END
 }
 
-/** Undistort the input image and saves the result in-place- \a setFromCamParams() must have been set prior to calling this.
+/** Undistort the input image and saves the result in the output one - \a setFromCamParams() must have been set prior to calling this.
   */
 void CUndistortMap::undistort(const mrpt::utils::CImage &in_img, mrpt::utils::CImage &out_img) const
 {
@@ -67,12 +69,34 @@ void CUndistortMap::undistort(const mrpt::utils::CImage &in_img, mrpt::utils::CI
 	if (m_dat_mapx.empty())
 		THROW_EXCEPTION("Error: setFromCamParams() must be called prior to undistort().")
 
+	if (&in_img==&out_img)
+	{
+		mrpt::utils::CImage aux_img;
+		this->undistort(in_img,aux_img);
+		out_img.swap(aux_img);
+		return;
+	}
+
 #if MRPT_HAS_OPENCV && MRPT_OPENCV_VERSION_NUM>=0x200
+	const IplImage *srcImg = in_img.getAs<IplImage>();	// Source Image
+	if (srcImg->depth==IPL_DEPTH_8U)
+	{
+		// The output buffer is only reallocated if it has not the right size already:
+		out_img.resize(m_camera_params.ncols, m_camera_params.nrows, in_img.isColor() ? 3:1, in_img.isOriginTopLeft() );
+
+		std::vector<mrpt::vision::detail::TFixedPointRemapJob> jobs(1);
+		if (mrpt::vision::detail::makeFixedPointRemapJob(srcImg, out_img.getAs<IplImage>(), &m_dat_mapx[0], &m_dat_mapy[0], jobs[0]))
+		{
+			mrpt::vision::detail::remapBilinearFixedPoint(jobs, m_num_threads);
+			return;
+		}
+	}
+
+	// Other image formats: use OpenCV's implementation
 	CvMat mapx = cvMat(m_camera_params.nrows,m_camera_params.ncols,  CV_16SC2, const_cast<int16_t*>(&m_dat_mapx[0]) );  // Wrappers on the data as a CvMat's.
 	CvMat mapy = cvMat(m_camera_params.nrows,m_camera_params.ncols,  CV_16UC1, const_cast<uint16_t*>(&m_dat_mapy[0]) );
 
-	const IplImage *srcImg = in_img.getAs<IplImage>();	// Source Image
-	IplImage *outImg = cvCreateImage( cvGetSize( srcImg ), srcImg->depth, srcImg->nChannels );
+	IplImage *outImg = cvCreateImage( cvSize(m_camera_params.ncols, m_camera_params.nrows), srcImg->depth, srcImg->nChannels );
 	cvRemap(srcImg, outImg, &mapx, &mapy);	//cv::remap(src, dst_part, map1_part, map2_part, INTER_LINEAR, BORDER_CONSTANT );
 	out_img.setFromIplImage(outImg);
 #endif
@@ -83,19 +107,5 @@ void CUndistortMap::undistort(const mrpt::utils::CImage &in_img, mrpt::utils::CI
   */
 void CUndistortMap::undistort(mrpt::utils::CImage &in_out_img) const
 {
-	MRPT_START
-	if (m_dat_mapx.empty())
-		THROW_EXCEPTION("Error: setFromCamParams() must be called prior to undistort().")
-
-#if MRPT_HAS_OPENCV && MRPT_OPENCV_VERSION_NUM>=0x200
-	CvMat mapx = cvMat(m_camera_params.nrows,m_camera_params.ncols,  CV_16SC2, const_cast<int16_t*>(&m_dat_mapx[0]) );  // Wrappers on the data as a CvMat's.
-	CvMat mapy = cvMat(m_camera_params.nrows,m_camera_params.ncols,  CV_16UC1, const_cast<uint16_t*>(&m_dat_mapy[0]) );
-
-	const IplImage *srcImg = in_out_img.getAs<IplImage>();	// Source Image
-	IplImage *outImg = cvCreateImage( cvGetSize( srcImg ), srcImg->depth, srcImg->nChannels );
-	cvRemap(srcImg, outImg, &mapx, &mapy);	//cv::remap(src, dst_part, map1_part, map2_part, INTER_LINEAR, BORDER_CONSTANT );
-	in_out_img.setFromIplImage(outImg);
-#endif
-	MRPT_END
+	this->undistort(in_out_img, in_out_img);
 }
-
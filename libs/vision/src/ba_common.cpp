@@ -12,6 +12,7 @@
 #include <mrpt/vision/bundle_adjustment.h>
 #include <mrpt/vision/pinhole.h>
 #include <mrpt/math/robust_kernels.h>
+#include <mrpt/system/threads.h> // parallelForBlocks()
 #include "ba_internals.h"
 
 using namespace std;
@@ -185,6 +186,52 @@ double mrpt::vision::reprojectionResiduals(
 	MRPT_END
 }
 
+namespace
+{
+	struct TResidualsData
+	{
+		const TSequenceFeatureObservations   * observations;
+		const TCamera                        * camera_params;
+		const TFramePosesVec                 * frame_poses;
+		const TLandmarkLocationsVec          * landmark_points;
+		std::vector<CArray<double,2> >       * out_residuals;
+		bool   frame_poses_are_inverse, use_robust_kernel;
+		double kernel_param;
+		std::vector<double> * out_kernel_1st_deriv;
+		double * out_costs; //!< If not NULL, the cost of each observation is stored here instead of summed
+		double   sum;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) computing the residuals of a block of observations.
+	void reprojectionResidualsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		TResidualsData &d = *static_cast<TResidualsData*>(user_param);
+
+		for (size_t i=first;i<last;i++)
+		{
+			const TFeatureObservation & OBS = (*d.observations)[i];
+
+			const TFeatureID     i_p  = OBS.id_feature;
+			const TCameraPoseID  i_f  = OBS.id_frame;
+
+			ASSERT_BELOW_(i_p,d.landmark_points->size())
+			ASSERT_BELOW_(i_f,d.frame_poses->size())
+
+			const TFramePosesVec::value_type        & frame = (*d.frame_poses)[i_f];
+			const TLandmarkLocationsVec::value_type & point = (*d.landmark_points)[i_p];
+
+			double *ptr_1st_deriv = d.out_kernel_1st_deriv ? &((*d.out_kernel_1st_deriv)[i]) : NULL;
+			double &sum = d.out_costs ? (d.out_costs[i]=0) : d.sum;
+
+			if (d.frame_poses_are_inverse)
+				reprojectionResidualsElement<true>(*d.camera_params, OBS, (*d.out_residuals)[i], frame, point, sum, d.use_robust_kernel,d.kernel_param,ptr_1st_deriv);
+			else
+				reprojectionResidualsElement<false>(*d.camera_params, OBS, (*d.out_residuals)[i], frame, point, sum, d.use_robust_kernel,d.kernel_param,ptr_1st_deriv);
+		}
+	}
+}
+
 double mrpt::vision::reprojectionResiduals(
 	const TSequenceFeatureObservations   & observations,
 	const TCamera                        & camera_params,
@@ -194,123 +241,49 @@ double mrpt::vision::reprojectionResiduals(
 	const bool  frame_poses_are_inverse,
 	const bool  use_robust_kernel,
 	const double kernel_param,
-	std::vector<double> * out_kernel_1st_deriv
+	std::vector<double> * out_kernel_1st_deriv,
+	const unsigned int num_threads
 	)
 {
 	MRPT_START
 
-	double sum = 0;
-
 	const size_t N = observations.size();
 	out_residuals.resize(N);
 	if (out_kernel_1st_deriv) out_kernel_1st_deriv->resize(N);
 
-	for (size_t i=0;i<N;i++)
+	TResidualsData d;
+	d.observations = &observations;
+	d.camera_params = &camera_params;
+	d.frame_poses = &frame_poses;
+	d.landmark_points = &landmark_points;
+	d.out_residuals = &out_residuals;
+	d.frame_poses_are_inverse = frame_poses_are_inverse;
+	d.use_robust_kernel = use_robust_kernel;
+	d.kernel_param = kernel_param;
+	d.out_kernel_1st_deriv = out_kernel_1st_deriv;
+	d.out_costs = NULL;
+	d.sum = 0;
+
+	if (num_threads==1)
 	{
-		const TFeatureObservation & OBS = observations[i];
-
-		const TFeatureID     i_p  = OBS.id_feature;
-		const TCameraPoseID  i_f  = OBS.id_frame;
-
-		ASSERT_BELOW_(i_p,landmark_points.size())
-		ASSERT_BELOW_(i_f,frame_poses.size())
-
-		const TFramePosesVec::value_type        & frame = frame_poses[i_f];
-		const TLandmarkLocationsVec::value_type & point = landmark_points[i_p];
-
-		double *ptr_1st_deriv = out_kernel_1st_deriv ? &((*out_kernel_1st_deriv)[i]) : NULL;
-
-		if (frame_poses_are_inverse)
-			reprojectionResidualsElement<true>(camera_params, OBS, out_residuals[i], frame, point, sum, use_robust_kernel,kernel_param,ptr_1st_deriv);
-		else
-			reprojectionResidualsElement<false>(camera_params, OBS, out_residuals[i], frame, point, sum, use_robust_kernel,kernel_param,ptr_1st_deriv);
+		reprojectionResidualsBlock(0,N,0,&d);
+		return d.sum;
 	}
 
-	return sum;
-	MRPT_END
-}
-
-
-// Compute gradients & Hessian blocks
-void mrpt::vision::ba_build_gradient_Hessians(
-	const TSequenceFeatureObservations          & observations,
-	const vector<CArray<double,2> >              & residual_vec,
-	const mrpt::aligned_containers<JacData<6,3,2> >::vector_t & jac_data_vec,
-	mrpt::aligned_containers<CMatrixFixedNumeric<double,6,6> >::vector_t  & U,
-	mrpt::aligned_containers<CArrayDouble<6> >::vector_t & eps_frame,
-	mrpt::aligned_containers<CMatrixFixedNumeric<double,3,3> >::vector_t & V,
-	mrpt::aligned_containers<CArrayDouble<3> >::vector_t & eps_point,
-	const size_t                                  num_fix_frames,
-	const size_t                                  num_fix_points,
-	const vector<double>   * kernel_1st_deriv
-	)
-{
-	MRPT_START
-
-	const size_t N = observations.size();
-	const bool use_robust_kernel = (kernel_1st_deriv!=NULL);
+	// Store the cost of each observation and add them up serially, in the same order than above,
+	// so the result does not depend on the number of threads:
+	std::vector<double> costs(N);
+	d.out_costs = N ? &costs[0] : NULL;
+	mrpt::system::parallelForBlocks(N, &reprojectionResidualsBlock, &d, num_threads);
 
+	double sum = 0;
 	for (size_t i=0;i<N;i++)
-	{
-		const TFeatureObservation & OBS = observations[i];
-
-		const TFeatureID     i_p  = OBS.id_feature;
-		const TCameraPoseID  i_f  = OBS.id_frame;
-
-		const Eigen::Matrix<double,2,1> RESID( &residual_vec[i][0] );
-		const JacData<6,3,2>  & JACOB = jac_data_vec[i];
-		ASSERTDEB_(JACOB.frame_id==i_f && JACOB.point_id==i_p)
-
-		if (i_f >= num_fix_frames)
-		{
-			const size_t frame_id = i_f - num_fix_frames;
-			ASSERTDEB_(JACOB.J_frame_valid)
-			ASSERT_BELOW_(frame_id,U.size())
-
-			CMatrixDouble66 JtJ(UNINITIALIZED_MATRIX);
-			JtJ.multiply_AtA(JACOB.J_frame);
-
-			CArrayDouble<6> eps_delta;
-			JACOB.J_frame.multiply_Atb(RESID, eps_delta); // eps_delta = J^t * RESID
-			if (!use_robust_kernel)
-			{
-				eps_frame[frame_id] += eps_delta;
-			}
-			else  
-			{
-				const double rho_1st_der = (*kernel_1st_deriv)[i];
-				eps_frame[frame_id] += eps_delta * rho_1st_der;
-			}
-			U[frame_id]+=JtJ;
-		}
-		if (i_p >= num_fix_points)
-		{
-			const size_t point_id = i_p - num_fix_points;
-			ASSERTDEB_(JACOB.J_point_valid)
-			ASSERT_BELOW_(point_id,V.size())
-
-			CMatrixDouble33 JtJ(UNINITIALIZED_MATRIX);
-			JtJ.multiply_AtA(JACOB.J_point);
-
-			CArrayDouble<3> eps_delta;
-			JACOB.J_point.multiply_Atb(RESID, eps_delta); // eps_delta = J^t * RESID
-			if (!use_robust_kernel)
-			{
-				eps_point[point_id] += eps_delta;
-			}
-			else  
-			{
-				const double rho_1st_der = (*kernel_1st_deriv)[i];
-				eps_point[point_id] += eps_delta  * rho_1st_der;
-			}
-				
-			V[point_id]+=JtJ;
-		}
-	}
-
+		sum += costs[i];
+	return sum;
 	MRPT_END
 }
 
+
 void mrpt::vision::add_se3_deltas_to_frames(
     const TFramePosesVec  & frame_poses,
     const CVectorDouble &delta,
@@ -14,7 +14,10 @@
 #include <mrpt/math/CSparseMatrix.h>
 #include <mrpt/math/ops_containers.h>
 
+#include <mrpt/system/threads.h> // parallelForBlocks()
+
 #include <memory>  // std::auto_ptr, unique_ptr
+#include <algorithm>
 
 #include "ba_internals.h"
 
@@ -35,6 +38,434 @@ using mrpt::aligned_containers;
 #	define INV_POSES_BOOL  false
 #endif
 
+namespace
+{
+	// Generic BA problem dimension numbers:
+	const unsigned int FrameDof = 6; // Poses: x y z yaw pitch roll
+	const unsigned int PointDof = 3; // Landmarks: x y z
+	const unsigned int ObsDim   = 2; // Obs: x y (pixels)
+
+	// Typedefs for this specific BA problem:
+	typedef JacData<FrameDof,PointDof,ObsDim>        MyJacData;
+	typedef aligned_containers<MyJacData>::vector_t  MyJacDataVec;
+
+	typedef CArray<double,ObsDim>              Array_O;
+	typedef CArrayDouble<FrameDof>             Array_F;
+	typedef CArrayDouble<PointDof>             Array_P;
+	typedef CMatrixFixedNumeric<double,FrameDof,FrameDof> Matrix_FxF;
+	typedef CMatrixFixedNumeric<double,PointDof,PointDof> Matrix_PxP;
+	typedef CMatrixFixedNumeric<double,FrameDof,PointDof> Matrix_FxP;
+	typedef CMatrixFixedNumeric<double,FrameDof,ObsDim>   Matrix_FxO;
+
+	typedef aligned_containers<Matrix_FxF>::vector_t  Matrix_FxF_Vec;
+	typedef aligned_containers<Matrix_PxP>::vector_t  Matrix_PxP_Vec;
+	typedef aligned_containers<Array_F>::vector_t     Array_F_Vec;
+	typedef aligned_containers<Array_P>::vector_t     Array_P_Vec;
+
+	const size_t INVALID_IDX = static_cast<size_t>(-1);
+
+	// Builds the lists of observations of each "row" (a frame or a landmark) in compressed form: the observations of row "r"
+	// are items[start[r]], ..., items[start[r+1]-1], in the same order than in the input. Observations with row INVALID_IDX are skipped.
+	void buildObservationLists(const std::vector<size_t> &row_of_obs, const size_t num_rows, std::vector<size_t> &start, std::vector<size_t> &items)
+	{
+		start.assign(num_rows+1, 0);
+		for (size_t o=0;o<row_of_obs.size();o++)
+			if (row_of_obs[o]!=INVALID_IDX)
+				start[row_of_obs[o]+1]++;
+		for (size_t r=0;r<num_rows;r++)
+			start[r+1]+=start[r];
+
+		items.resize(start[num_rows]);
+		std::vector<size_t> next(start.begin(), start.end()-1);
+		for (size_t o=0;o<row_of_obs.size();o++)
+			if (row_of_obs[o]!=INVALID_IDX)
+				items[next[row_of_obs[o]]++] = o;
+	}
+
+	/** The sparse structure of a BA problem, which does not change between iterations.
+	  *  All frame and point indices are relative to the first free (not fixed) one. */
+	struct TBAStructure
+	{
+		std::vector<size_t> pt_start, pt_obs;   //!< Observations of each point
+		std::vector<size_t> fr_start, fr_obs;   //!< Observations of each frame
+		std::vector<size_t> cpt_start, cpt_obs; //!< Observations of each point from free frames, which couple points and frames in the Schur complement
+		std::vector<size_t> cfr_start, cfr_obs; //!< Idem, grouped by frame
+		std::vector<size_t> cfr_pos;            //!< For each entry in cfr_obs, its position within the list of its point in cpt_obs
+		std::vector<size_t> row_start, row_cols, row_diag; //!< Block-CSR structure of the reduced camera system: the (sorted) block columns of each block row, and the index of its diagonal block
+		std::vector<size_t> pair_start, pair_block; //!< For each point with "m" coupling observations (a,b), the index of the block (frame(a),frame(b)), as a row-major m x m matrix
+
+		void build(const TSequenceFeatureObservations &observations, const size_t num_frames, const size_t num_points, const size_t num_fix_frames, const size_t num_fix_points)
+		{
+			const size_t num_obs = observations.size();
+			const size_t num_free_frames = num_frames-num_fix_frames;
+			const size_t num_free_points = num_points-num_fix_points;
+
+			std::vector<size_t> fr_of(num_obs), pt_of(num_obs), cfr_of(num_obs), cpt_of(num_obs);
+			for (size_t o=0;o<num_obs;o++)
+			{
+				const size_t i_f = observations[o].id_frame;
+				const size_t i_p = observations[o].id_feature;
+				ASSERT_BELOW_(i_f,num_frames)
+				ASSERT_BELOW_(i_p,num_points)
+
+				const bool free_frame = i_f>=num_fix_frames, free_point = i_p>=num_fix_points;
+				fr_of[o]  = free_frame ? i_f-num_fix_frames : INVALID_IDX;
+				pt_of[o]  = free_point ? i_p-num_fix_points : INVALID_IDX;
+				cfr_of[o] = free_frame && free_point ? fr_of[o] : INVALID_IDX;
+				cpt_of[o] = free_frame && free_point ? pt_of[o] : INVALID_IDX;
+			}
+			buildObservationLists(fr_of, num_free_frames, fr_start, fr_obs);
+			buildObservationLists(pt_of, num_free_points, pt_start, pt_obs);
+			buildObservationLists(cfr_of, num_free_frames, cfr_start, cfr_obs);
+			buildObservationLists(cpt_of, num_free_points, cpt_start, cpt_obs);
+
+			// Position of each coupling observation within the list of its point:
+			std::vector<size_t> pos_in_point(num_obs, INVALID_IDX);
+			for (size_t i=0;i<num_free_points;i++)
+				for (size_t k=cpt_start[i];k<cpt_start[i+1];k++)
+					pos_in_point[cpt_obs[k]] = k-cpt_start[i];
+			cfr_pos.resize(cfr_obs.size());
+			for (size_t k=0;k<cfr_obs.size();k++)
+				cfr_pos[k] = pos_in_point[cfr_obs[k]];
+
+			// Block structure of the reduced camera system: frames (j,k) are connected if they observe a common point.
+			std::vector<std::vector<size_t> > cols(num_free_frames);
+			for (size_t j=0;j<num_free_frames;j++)
+				cols[j].push_back(j);
+			for (size_t i=0;i<num_free_points;i++)
+				for (size_t a=cpt_start[i];a<cpt_start[i+1];a++)
+					for (size_t b=cpt_start[i];b<cpt_start[i+1];b++)
+						cols[cfr_of[cpt_obs[a]]].push_back(cfr_of[cpt_obs[b]]);
+
+			row_start.assign(num_free_frames+1, 0);
+			row_diag.resize(num_free_frames);
+			row_cols.clear();
+			for (size_t j=0;j<num_free_frames;j++)
+			{
+				std::vector<size_t> &c = cols[j];
+				std::sort(c.begin(),c.end());
+				c.erase(std::unique(c.begin(),c.end()), c.end());
+				row_start[j+1] = row_start[j] + c.size();
+				row_diag[j] = row_start[j] + (std::lower_bound(c.begin(),c.end(),j)-c.begin());
+				row_cols.insert(row_cols.end(), c.begin(), c.end());
+				std::vector<size_t>().swap(c); // Free memory
+			}
+
+			pair_start.assign(num_free_points+1, 0);
+			for (size_t i=0;i<num_free_points;i++)
+			{
+				const size_t m = cpt_start[i+1]-cpt_start[i];
+				pair_start[i+1] = pair_start[i] + m*m;
+			}
+			pair_block.resize(pair_start[num_free_points]);
+			for (size_t i=0;i<num_free_points;i++)
+			{
+				const size_t m = cpt_start[i+1]-cpt_start[i];
+				for (size_t a=0;a<m;a++)
+				{
+					const size_t j = cfr_of[cpt_obs[cpt_start[i]+a]];
+					const std::vector<size_t>::const_iterator row_begin = row_cols.begin()+row_start[j], row_end = row_cols.begin()+row_start[j+1];
+					for (size_t b=0;b<m;b++)
+					{
+						const size_t k = cfr_of[cpt_obs[cpt_start[i]+b]];
+						pair_block[pair_start[i]+a*m+b] = row_start[j] + (std::lower_bound(row_begin,row_end,k)-row_begin);
+					}
+				}
+			}
+		}
+	};
+
+	struct TGradientHessianData
+	{
+		const TBAStructure   * st;
+		const vector<Array_O> * residual_vec;
+		const MyJacDataVec   * jac_data_vec;
+		const vector<double> * kernel_1st_deriv; //!< NULL if not using a robust kernel
+		Matrix_FxF_Vec * H_f;
+		Array_F_Vec    * eps_frame;
+		Matrix_PxP_Vec * H_p;
+		Array_P_Vec    * eps_point;
+	};
+
+	// Workers (for mrpt::system::parallelForBlocks) building the gradient & Hessian blocks of a range of frames / points,
+	//  each one adding up its observations in the same order than in the input sequence.
+	void buildFramesGradientHessian(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TGradientHessianData &d = *static_cast<const TGradientHessianData*>(user_param);
+
+		for (size_t j=first;j<last;j++)
+		{
+			Matrix_FxF &H   = (*d.H_f)[j];
+			Array_F    &eps = (*d.eps_frame)[j];
+			H.setZero();
+			eps.assign(0);
+
+			for (size_t k=d.st->fr_start[j];k<d.st->fr_start[j+1];k++)
+			{
+				const size_t obs_idx = d.st->fr_obs[k];
+				const Eigen::Matrix<double,ObsDim,1> RESID( &(*d.residual_vec)[obs_idx][0] );
+				const MyJacData &JACOB = (*d.jac_data_vec)[obs_idx];
+				ASSERTDEB_(JACOB.J_frame_valid)
+
+				Matrix_FxF JtJ(UNINITIALIZED_MATRIX);
+				JtJ.multiply_AtA(JACOB.J_frame);
+
+				Array_F eps_delta;
+				JACOB.J_frame.multiply_Atb(RESID, eps_delta); // eps_delta = J^t * RESID
+				if (!d.kernel_1st_deriv)
+						eps += eps_delta;
+				else	eps += eps_delta * (*d.kernel_1st_deriv)[obs_idx];
+				H+=JtJ;
+			}
+		}
+	}
+
+	void buildPointsGradientHessian(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TGradientHessianData &d = *static_cast<const TGradientHessianData*>(user_param);
+
+		for (size_t i=first;i<last;i++)
+		{
+			Matrix_PxP &H   = (*d.H_p)[i];
+			Array_P    &eps = (*d.eps_point)[i];
+			H.setZero();
+			eps.assign(0);
+
+			for (size_t k=d.st->pt_start[i];k<d.st->pt_start[i+1];k++)
+			{
+				const size_t obs_idx = d.st->pt_obs[k];
+				const Eigen::Matrix<double,ObsDim,1> RESID( &(*d.residual_vec)[obs_idx][0] );
+				const MyJacData &JACOB = (*d.jac_data_vec)[obs_idx];
+				ASSERTDEB_(JACOB.J_point_valid)
+
+				Matrix_PxP JtJ(UNINITIALIZED_MATRIX);
+				JtJ.multiply_AtA(JACOB.J_point);
+
+				Array_P eps_delta;
+				JACOB.J_point.multiply_Atb(RESID, eps_delta); // eps_delta = J^t * RESID
+				if (!d.kernel_1st_deriv)
+						eps += eps_delta;
+				else	eps += eps_delta * (*d.kernel_1st_deriv)[obs_idx];
+				H+=JtJ;
+			}
+		}
+	}
+
+	// Builds the gradients (eps_*) and the diagonal Hessian blocks (H_*) of all the free frames & points.
+	void buildGradientHessians(TGradientHessianData &d, const unsigned int num_threads)
+	{
+		mrpt::system::parallelForBlocks(d.H_f->size(), &buildFramesGradientHessian, &d, num_threads);
+		mrpt::system::parallelForBlocks(d.H_p->size(), &buildPointsGradientHessian, &d, num_threads);
+	}
+
+	struct TSchurData
+	{
+		const TBAStructure   * st;
+		const MyJacDataVec   * jac_data_vec;
+		size_t                 num_fix_points;
+		const Matrix_FxF_Vec * H_f;
+		const Array_F_Vec    * eps_frame;
+		const Matrix_PxP_Vec * V_inv;   //!< Inverses of the (damped) point Hessian blocks
+		const Array_P_Vec    * eps_point;
+		double                 mu;
+		Matrix_FxF_Vec       * S;       //!< Out: blocks of the reduced camera system, with the structure in TBAStructure
+		double               * e;       //!< Out: its right hand side
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) building a range of block rows of the reduced camera system:
+	//  S_jk = U_j* \delta_jk - \sum_i Y_ij W_ik^t ,  e_j = eps_j - \sum_i Y_ij eps_i ,  with W_ij = J_j^t J_i and Y_ij = W_ij V_i^{-1}.
+	// Each row is only written by the thread which owns it, so no synchronization is needed.
+	void schurComplementRows(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TSchurData &d = *static_cast<const TSchurData*>(user_param);
+		const TBAStructure &st = *d.st;
+		const MyJacDataVec &jac_data_vec = *d.jac_data_vec;
+		Matrix_FxF_Vec &S = *d.S;
+
+		for (size_t j=first;j<last;j++)
+		{
+			for (size_t b=st.row_start[j];b<st.row_start[j+1];b++)
+				S[b].setZero();
+
+			Matrix_FxF &U_star = S[st.row_diag[j]];
+			U_star = (*d.H_f)[j];
+			for (size_t dim=0;dim<FrameDof;dim++)
+				U_star(dim,dim)+=d.mu;
+
+			Array_F e_j = (*d.eps_frame)[j];
+
+			for (size_t k=st.cfr_start[j];k<st.cfr_start[j+1];k++)
+			{
+				const MyJacData &JACOB = jac_data_vec[st.cfr_obs[k]];
+				ASSERTDEB_(JACOB.J_frame_valid && JACOB.J_point_valid)
+				const size_t i = JACOB.point_id - d.num_fix_points;
+
+				Matrix_FxP W(UNINITIALIZED_MATRIX), Y(UNINITIALIZED_MATRIX);
+				W.multiply_AtB(JACOB.J_frame, JACOB.J_point);  // W = J_f^t * J_p
+				Y.multiply_AB(W, (*d.V_inv)[i]);               // Y = W * V^{-1}
+
+				Array_F r;
+				Y.multiply_Ab( (*d.eps_point)[i], r);
+				e_j-=r;
+
+				// All the observations of this point: Y_ij W_ik^t = (Y_ij J_p(ik)^t) J_f(ik)
+				const size_t m = st.cpt_start[i+1]-st.cpt_start[i];
+				const size_t *blocks = &st.pair_block[st.pair_start[i] + st.cfr_pos[k]*m];
+				for (size_t q=0;q<m;q++)
+				{
+					const MyJacData &JACOB_k = jac_data_vec[st.cpt_obs[st.cpt_start[i]+q]];
+
+					Matrix_FxO YJt(UNINITIALIZED_MATRIX);
+					YJt.multiply_ABt(Y, JACOB_k.J_point);
+					Matrix_FxF YWt(UNINITIALIZED_MATRIX);
+					YWt.multiply_AB(YJt, JACOB_k.J_frame);
+					S[blocks[q]]-=YWt;
+				}
+			}
+
+			::memcpy(&d.e[j*FrameDof], &e_j[0], sizeof(e_j[0])*FrameDof);
+		}
+	}
+
+	struct TBlockMatVecData
+	{
+		const TBAStructure   * st;
+		const Matrix_FxF_Vec * S;
+		const double         * x;
+		double               * y;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) for the product y=S*x of a range of block rows of the reduced camera system.
+	void reducedSystemMatVec(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TBlockMatVecData &d = *static_cast<const TBlockMatVecData*>(user_param);
+
+		for (size_t j=first;j<last;j++)
+		{
+			Array_F y_j;
+			y_j.assign(0);
+			for (size_t b=d.st->row_start[j];b<d.st->row_start[j+1];b++)
+			{
+				const Array_F x_k( &d.x[d.st->row_cols[b]*FrameDof] );
+				Array_F r;
+				(*d.S)[b].multiply_Ab(x_k, r);
+				y_j+=r;
+			}
+			::memcpy(&d.y[j*FrameDof], &y_j[0], sizeof(y_j[0])*FrameDof);
+		}
+	}
+
+	/** Solves the reduced camera system S*x=b by conjugate gradient with a block-Jacobi preconditioner.
+	  * \return false if S turns out not to be positive definite. */
+	bool solveReducedSystemPCG(
+		const TBAStructure &st, const Matrix_FxF_Vec &S, const CVectorDouble &b,
+		const size_t max_iters, const double tolerance, const unsigned int num_threads,
+		CVectorDouble &x, size_t &out_iters)
+	{
+		const size_t num_rows = st.row_diag.size();
+		const size_t N = num_rows*FrameDof;
+
+		// Preconditioner: inverses of the diagonal blocks.
+		Matrix_FxF_Vec M_inv(num_rows);
+		for (size_t j=0;j<num_rows;j++)
+		{
+			const Eigen::LLT<Eigen::Matrix<double,FrameDof,FrameDof> > llt(S[st.row_diag[j]]);
+			if (llt.info()!=Eigen::Success)
+				return false;
+			M_inv[j] = llt.solve(Eigen::Matrix<double,FrameDof,FrameDof>::Identity());
+		}
+
+		x.assign(N, 0.0);
+		out_iters = 0;
+		const double b_norm = b.norm();
+		if (b_norm==0)
+			return true;
+
+		CVectorDouble r = b, z(N), p(N), q(N);
+		for (size_t j=0;j<num_rows;j++)
+			z.segment<FrameDof>(j*FrameDof) = M_inv[j] * r.segment<FrameDof>(j*FrameDof);
+		p = z;
+		double rz = r.dot(z);
+
+		TBlockMatVecData mv;
+		mv.st = &st;
+		mv.S = &S;
+		mv.x = &p[0];
+		mv.y = &q[0];
+
+		while (out_iters<max_iters)
+		{
+			out_iters++;
+			mrpt::system::parallelForBlocks(num_rows, &reducedSystemMatVec, &mv, num_threads); // q = S*p
+
+			const double pq = p.dot(q);
+			if (!(pq>0))
+				return false;
+			const double alpha = rz/pq;
+			x+= alpha*p;
+			r-= alpha*q;
+			if (r.norm()<=tolerance*b_norm)
+				break;
+
+			for (size_t j=0;j<num_rows;j++)
+				z.segment<FrameDof>(j*FrameDof) = M_inv[j] * r.segment<FrameDof>(j*FrameDof);
+			const double rz_new = r.dot(z);
+			p = z + (rz_new/rz)*p;
+			rz = rz_new;
+		}
+		return true;
+	}
+
+	struct TBackSubstitutionData
+	{
+		const TBAStructure   * st;
+		const MyJacDataVec   * jac_data_vec;
+		size_t                 num_fix_frames;
+		const Matrix_PxP_Vec * V_inv;
+		const Array_P_Vec    * eps_point;
+		size_t                 len_free_frames;
+		double               * delta; //!< In: the frames step. Out: the points step.
+		double               * g;     //!< Out: the points gradient
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) recovering the step of a range of points from the frames step:
+	//  delta_i = V_i^{-1} ( eps_i - \sum_j W_ij^t delta_j )
+	void pointsBackSubstitution(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TBackSubstitutionData &d = *static_cast<const TBackSubstitutionData*>(user_param);
+		const TBAStructure &st = *d.st;
+
+		for (size_t i=first;i<last;i++)
+		{
+			Array_P tmp = (*d.eps_point)[i];
+
+			for (size_t k=st.cpt_start[i];k<st.cpt_start[i+1];k++)
+			{
+				const MyJacData &JACOB = (*d.jac_data_vec)[st.cpt_obs[k]];
+				const size_t j = JACOB.frame_id - d.num_fix_frames;
+
+				// W_ij^t * delta_j = J_p^t * (J_f * delta_j)
+				const Array_F v( &d.delta[j*FrameDof] );
+				CArrayDouble<ObsDim> Jv;
+				JACOB.J_frame.multiply_Ab(v, Jv);
+				Array_P r;
+				JACOB.J_point.multiply_Atb(Jv, r);
+				tmp-=r;
+			}
+			Array_P Vi_tmp;
+			(*d.V_inv)[i].multiply_Ab(tmp, Vi_tmp); // Vi_tmp = V_inv[i] * tmp
+
+			::memcpy(&d.delta[d.len_free_frames + i*PointDof], &Vi_tmp[0], sizeof(Vi_tmp[0])*PointDof );
+			::memcpy(&d.g[d.len_free_frames + i*PointDof], &(*d.eps_point)[i][0], sizeof(Vi_tmp[0])*PointDof );
+		}
+	}
+}
+
 /* ----------------------------------------------------------
                     bundle_adj_full
 
@@ -58,22 +489,6 @@ double mrpt::vision::bundle_adj_full(
 {
 	MRPT_START
 
-	// Generic BA problem dimension numbers:
-	static const unsigned int FrameDof = 6; // Poses: x y z yaw pitch roll
-	static const unsigned int PointDof = 3; // Landmarks: x y z
-	static const unsigned int ObsDim   = 2; // Obs: x y (pixels)
-
-	// Typedefs for this specific BA problem:
-	typedef JacData<FrameDof,PointDof,ObsDim>        MyJacData;
-	typedef aligned_containers<MyJacData>::vector_t  MyJacDataVec;
-
-	typedef CArray<double,ObsDim>              Array_O;
-	typedef CArrayDouble<FrameDof>             Array_F;
-	typedef CArrayDouble<PointDof>             Array_P;
-	typedef CMatrixFixedNumeric<double,FrameDof,FrameDof> Matrix_FxF;
-	typedef CMatrixFixedNumeric<double,PointDof,PointDof> Matrix_PxP;
-	typedef CMatrixFixedNumeric<double,FrameDof,PointDof> Matrix_FxP;
-
 	// Extra params:
 	const bool use_robust_kernel  = 0!=extra_params.getWithDefaultVal("robust_kernel",1);
 	const bool verbose            = 0!=extra_params.getWithDefaultVal("verbose",0);
@@ -82,6 +497,10 @@ double mrpt::vision::bundle_adj_full(
 	const size_t num_fix_frames   = extra_params.getWithDefaultVal("num_fix_frames",1);
 	const size_t num_fix_points   = extra_params.getWithDefaultVal("num_fix_points",0);
 	const double kernel_param     = extra_params.getWithDefaultVal("kernel_param",3.0);
+	const int    solver           = static_cast<int>(extra_params.getWithDefaultVal("solver",0));
+	const size_t pcg_max_iters    = extra_params.getWithDefaultVal("pcg_max_iterations",100);
+	const double pcg_tolerance    = extra_params.getWithDefaultVal("pcg_tolerance",1e-6);
+	const unsigned int num_threads = static_cast<unsigned int>(extra_params.getWithDefaultVal("num_threads",1));
 
 	const bool   enable_profiler  = 0!=extra_params.getWithDefaultVal("profiler",0);
 
@@ -100,6 +519,7 @@ double mrpt::vision::bundle_adj_full(
 	ASSERT_(num_fix_frames>=1)
 	ASSERT_ABOVEEQ_(num_frames,num_fix_frames);
 	ASSERT_ABOVEEQ_(num_points,num_fix_points);
+	ASSERTMSG_(solver==0 || solver==1, "Unknown value for the 'solver' parameter")
 
 #ifdef USE_INVERSE_POSES
 	// *Warning*: This implementation assumes inverse camera poses: inverse them at the entrance and at exit:
@@ -109,6 +529,11 @@ double mrpt::vision::bundle_adj_full(
 	profiler.leave("invert_poses");
 #endif
 
+	// Sparse structure of the problem:
+	profiler.enter("build_structure");
+	TBAStructure structure;
+	structure.build(observations, num_frames, num_points, num_fix_frames, num_fix_points);
+	profiler.leave("build_structure");
 
 	MyJacDataVec     jac_data_vec(num_obs);
 	vector<Array_O>  residual_vec(num_obs);
@@ -123,7 +548,7 @@ double mrpt::vision::bundle_adj_full(
 
 	// Compute sparse Jacobians:
 	profiler.enter("compute_Jacobians");
-	ba_compute_Jacobians<INV_POSES_BOOL>(frame_poses, landmark_points, camera_params, jac_data_vec, num_fix_frames, num_fix_points);
+	ba_compute_Jacobians<INV_POSES_BOOL>(frame_poses, landmark_points, camera_params, jac_data_vec, num_fix_frames, num_fix_points, num_threads);
 	profiler.leave("compute_Jacobians");
 
 
@@ -134,31 +559,36 @@ double mrpt::vision::bundle_adj_full(
 					 INV_POSES_BOOL, // are poses inverse?
 					 use_robust_kernel,
 					 kernel_param,
-					 use_robust_kernel ? &kernel_1st_deriv : NULL );
+					 use_robust_kernel ? &kernel_1st_deriv : NULL,
+					 num_threads );
 	profiler.leave("reprojectionResiduals");
 
 	MRPT_CHECK_NORMAL_NUMBER(res)
 
 	VERBOSE_COUT << "res: " << res << endl;
 
-	// Auxiliary vars:
-	Array_F arrF_zeros;
-	arrF_zeros.assign(0);
-	Array_P arrP_zeros;
-	arrP_zeros.assign(0);
-
 	const size_t num_free_frames = num_frames-num_fix_frames;
 	const size_t num_free_points = num_points-num_fix_points;
 	const size_t len_free_frames = FrameDof * num_free_frames;
 	const size_t len_free_points = PointDof * num_free_points;
 
-	aligned_containers<Matrix_FxF>::vector_t    H_f         (num_free_frames);
-	aligned_containers<Array_F>::vector_t       eps_frame (num_free_frames, arrF_zeros);
-	aligned_containers<Matrix_PxP>::vector_t    H_p         (num_free_points);
-	aligned_containers<Array_P>::vector_t       eps_point (num_free_points, arrP_zeros);
+	Matrix_FxF_Vec  H_f       (num_free_frames);
+	Array_F_Vec     eps_frame (num_free_frames);
+	Matrix_PxP_Vec  H_p       (num_free_points);
+	Array_P_Vec     eps_point (num_free_points);
+
+	TGradientHessianData gh_data;
+	gh_data.st = &structure;
+	gh_data.residual_vec = &residual_vec;
+	gh_data.jac_data_vec = &jac_data_vec;
+	gh_data.kernel_1st_deriv = use_robust_kernel ? &kernel_1st_deriv : NULL;
+	gh_data.H_f = &H_f;
+	gh_data.eps_frame = &eps_frame;
+	gh_data.H_p = &H_p;
+	gh_data.eps_point = &eps_point;
 
 	profiler.enter("build_gradient_Hessians");
-	ba_build_gradient_Hessians(observations,residual_vec,jac_data_vec, H_f,eps_frame,H_p,eps_point, num_fix_frames, num_fix_points, use_robust_kernel ? &kernel_1st_deriv : NULL  );
+	buildGradientHessians(gh_data, num_threads);
 	profiler.leave("build_gradient_Hessians");
 
 	double nu = 2;
@@ -181,9 +611,22 @@ double mrpt::vision::bundle_adj_full(
 		mu = tau*norm_max_A;
 	}
 
-	Matrix_FxF   I_muFrame(UNINITIALIZED_MATRIX);
 	Matrix_PxP   I_muPoint(UNINITIALIZED_MATRIX);
 
+	// The reduced camera system, with the block structure in "structure", and the inverses of the damped point Hessian blocks:
+	Matrix_FxF_Vec  S_blocks(structure.row_cols.size());
+	Matrix_PxP_Vec  V_inv(num_free_points);
+
+	TSchurData schur_data;
+	schur_data.st = &structure;
+	schur_data.jac_data_vec = &jac_data_vec;
+	schur_data.num_fix_points = num_fix_points;
+	schur_data.H_f = &H_f;
+	schur_data.eps_frame = &eps_frame;
+	schur_data.V_inv = &V_inv;
+	schur_data.eps_point = &eps_point;
+	schur_data.S = &S_blocks;
+
 	// Cholesky object, as a pointer to reuse it between iterations:
 #if MRPT_HAS_CXX11
 	typedef std::unique_ptr<CSparseMatrix::CholeskyDecomp> SparseCholDecompPtr;
@@ -207,173 +650,101 @@ double mrpt::vision::bundle_adj_full(
 
 			VERBOSE_COUT << "mu: " <<mu<< endl;
 
-			I_muFrame.unit(FrameDof,mu);
 			I_muPoint.unit(PointDof,mu);
 
-			aligned_containers<Matrix_FxF>::vector_t   U_star(num_free_frames, I_muFrame);
-			aligned_containers<Matrix_PxP>::vector_t   V_inv (num_free_points);
-
-			for (size_t i=0; i<U_star.size(); ++i)
-				U_star[i] += H_f[i];
-
 			for (size_t i=0; i<H_p.size(); ++i)
 				(H_p[i]+I_muPoint).inv_fast( V_inv[i] );
 
-
-			typedef aligned_containers<pair<TCameraPoseID,TLandmarkID>,Matrix_FxP>::map_t  WMap;
-			WMap   W,Y;
-
-			// For quick look-up of entries in W affecting a given point ID:
-			vector<vector<WMap::iterator> >   W_entries(num_points);  // Index is "TLandmarkID"
-
-			MyJacDataVec::const_iterator jac_iter = jac_data_vec.begin();
-			for (TSequenceFeatureObservations::const_iterator it_obs=observations.begin(); it_obs!=observations.end(); ++it_obs)
-			{
-				const TFeatureID feat_id     = it_obs->id_feature;
-				const TCameraPoseID frame_id = it_obs->id_frame;
-
-				if (jac_iter->J_frame_valid && jac_iter->J_point_valid)
-				{
-					const CMatrixFixedNumeric<double,ObsDim,FrameDof> & J_frame = jac_iter->J_frame;
-					const CMatrixFixedNumeric<double,ObsDim,PointDof> & J_point = jac_iter->J_point;
-					const pair<TCameraPoseID,TLandmarkID> id_pair = make_pair(frame_id, feat_id);
-
-					Matrix_FxP tmp(UNINITIALIZED_MATRIX);
-					tmp.multiply_AtB(J_frame, J_point);
-
-					// W[ids] = J_f^T * J_p
-					// Was: W[id_pair] = tmp;
-					const pair<WMap::iterator,bool> &retInsert = W.insert( make_pair(id_pair,tmp) );
-					ASSERT_(retInsert.second==true)
-					W_entries[feat_id].push_back(retInsert.first); // Keep the iterator
-
-					// Y[ids] = W[ids] * H_p^{-1}
-					Y[id_pair].multiply_AB(tmp, V_inv[feat_id-num_fix_points]);
-				}
-				++jac_iter;
-			}
-
-			aligned_containers<pair<TCameraPoseID,TLandmarkID>,Matrix_FxF>::map_t  YW_map;
-			for (size_t i=0; i<H_f.size(); ++i)
-				YW_map[std::pair<TCameraPoseID,TLandmarkID>(i,i)] = U_star[i];
-
 			CVectorDouble  delta( len_free_frames + len_free_points ); // The optimal step
 			CVectorDouble  e    ( len_free_frames );
 
-
+			// Schur complement of the points: S * delta_frames = e
 			profiler.enter("Schur.build.reduced.frames");
-			for (size_t j=0; j<num_free_frames; ++j)
-				::memcpy( &e[j*FrameDof], &eps_frame[j][0], sizeof(e[0])*FrameDof ); // e.slice(j*FrameDof,FrameDof) = AT(eps_frame,j);
+			schur_data.mu = mu;
+			schur_data.e = len_free_frames ? &e[0] : NULL;
+			mrpt::system::parallelForBlocks(num_free_frames, &schurComplementRows, &schur_data, num_threads);
+			profiler.leave("Schur.build.reduced.frames");
 
-			for (WMap::iterator Y_ij=Y.begin(); Y_ij!=Y.end(); ++Y_ij)
+			bool solved = true;
+			if (len_free_frames && solver==0)
 			{
-				const TLandmarkID  point_id = Y_ij->first.second;
-				const size_t i = Y_ij->first.second - num_fix_points; // point index
-				const size_t j = Y_ij->first.first  - num_fix_frames; // frame index
+				profiler.enter("sS:ALL");
+				profiler.enter("sS:fill");
 
-				const vector<WMap::iterator> &iters = W_entries[point_id]; //->second;
+				VERBOSE_COUT << "Blocks in the reduced camera system:" << S_blocks.size() << endl;
 
-				for (size_t itIdx=0; itIdx<iters.size(); itIdx++)
-					//for (size_t k=0; k<num_free_frames; ++k)
-				{
-					const WMap::iterator &W_ik = iters[itIdx];
-					const TLandmarkID k = W_ik->first.first-num_fix_frames;
+				CSparseMatrix sS(len_free_frames, len_free_frames);
 
-					Matrix_FxF  YWt(UNINITIALIZED_MATRIX);		//-(Y_ij->second) * (W_ik->second).T();
-					YWt.multiply_ABt( Y_ij->second, W_ik->second );
-					//YWt*=-1.0; // The "-" sign is taken into account below:
+				// Only the upper triangular part is used by the Cholesky decomposition:
+				for (size_t j=0; j<num_free_frames; ++j)
+					for (size_t b=structure.row_diag[j]; b<structure.row_start[j+1]; ++b)
+						sS.insert_submatrix(j*FrameDof, structure.row_cols[b]*FrameDof, S_blocks[b]);
+				profiler.leave("sS:fill");
 
-					const pair<TCameraPoseID,TLandmarkID> ids_jk = pair<TCameraPoseID,TLandmarkID>(j,k);
+				// Compress the sparse matrix:
+				profiler.enter("sS:compress");
+				sS.compressFromTriplet();
+				profiler.leave("sS:compress");
 
-					aligned_containers<pair<TCameraPoseID,TLandmarkID>,Matrix_FxF>::map_t::iterator it = YW_map.find(ids_jk);
-					if(it!=YW_map.end())
-						it->second -= YWt;  // += (-YWt);
-					else
-						YW_map[ids_jk] = YWt*(-1.0);
+				try
+				{
+					profiler.enter("sS:chol");
+					if (!ptrCh.get())
+							ptrCh = SparseCholDecompPtr(new CSparseMatrix::CholeskyDecomp(sS, num_threads) );
+					else ptrCh.get()->update(sS);
+					profiler.leave("sS:chol");
+
+					profiler.enter("sS:backsub");
+					CVectorDouble  bck_res;
+					ptrCh->backsub(e, bck_res);  // Ax = b -->  delta= x*
+					::memcpy(&delta[0],&bck_res[0],bck_res.size()*sizeof(bck_res[0]));	// delta.slice(0,...) = Ch.backsub(e);
+					profiler.leave("sS:backsub");
 				}
-
-				CArrayDouble<FrameDof>  r;
-				Y_ij->second.multiply_Ab( eps_point[i] ,r);
-				for (size_t k=0; k<FrameDof; k++)
-					e[j*FrameDof+k]-=r[k];
+				catch (CExceptionNotDefPos &)
+				{
+					solved = false;
+				}
+				profiler.leave("sS:ALL");
 			}
-			profiler.leave("Schur.build.reduced.frames");
-
-
-			profiler.enter("sS:ALL");
-			profiler.enter("sS:fill");
-
-			VERBOSE_COUT << "Entries in YW_map:" << YW_map.size() << endl;
-
-			CSparseMatrix sS(len_free_frames, len_free_frames);
-
-			for (aligned_containers<pair<TCameraPoseID,TLandmarkID>,Matrix_FxF>::map_t::const_iterator it= YW_map.begin(); it!=YW_map.end(); ++it)
+			else if (len_free_frames)
 			{
-				const pair<TCameraPoseID,TLandmarkID> & ids = it->first;
-				const Matrix_FxF & YW = it->second;
-				sS.insert_submatrix(ids.first*FrameDof,ids.second*FrameDof, YW);
+				profiler.enter("sS:PCG");
+				CVectorDouble  pcg_res;
+				size_t pcg_iters;
+				solved = solveReducedSystemPCG(structure, S_blocks, e, pcg_max_iters, pcg_tolerance, num_threads, pcg_res, pcg_iters);
+				if (solved)
+					::memcpy(&delta[0],&pcg_res[0],pcg_res.size()*sizeof(pcg_res[0]));
+				profiler.leave("sS:PCG");
+				VERBOSE_COUT << "PCG iterations: " << pcg_iters << endl;
 			}
-			profiler.leave("sS:fill");
-
-			// Compress the sparse matrix:
-			profiler.enter("sS:compress");
-			sS.compressFromTriplet();
-			profiler.leave("sS:compress");
 
-			try
+			if (!solved)
 			{
-				profiler.enter("sS:chol");
-				if (!ptrCh.get())
-						ptrCh = SparseCholDecompPtr(new CSparseMatrix::CholeskyDecomp(sS) );
-				else ptrCh.get()->update(sS);
-				profiler.leave("sS:chol");
-
-				profiler.enter("sS:backsub");
-				CVectorDouble  bck_res;
-				ptrCh->backsub(e, bck_res);  // Ax = b -->  delta= x*
-				::memcpy(&delta[0],&bck_res[0],bck_res.size()*sizeof(bck_res[0]));	// delta.slice(0,...) = Ch.backsub(e);
-				profiler.leave("sS:backsub");
-				profiler.leave("sS:ALL");
-			}
-			catch (CExceptionNotDefPos &)
-			{
-				profiler.leave("sS:ALL");
 				// not positive definite so increase mu and try again
 				mu *= nu;
 				nu *= 2.;
 				stop = (mu>999999999.f);
+				profiler.leave("COMPLETE_ITER");
 				continue;
 			}
 
 			profiler.enter("PostSchur.landmarks");
 
 			CVectorDouble g(len_free_frames+len_free_points);
-			::memcpy(&g[0],&e[0],len_free_frames*sizeof(g[0])); //g.slice(0,FrameDof*(num_frames-num_fix_frames)) = e;
-
-			for (size_t i=0; i<num_free_points; ++i)
-			{
-				Array_P tmp = eps_point[i]; // eps_point.slice(PointDof*i,PointDof);
+			if (len_free_frames)
+				::memcpy(&g[0],&e[0],len_free_frames*sizeof(g[0])); //g.slice(0,FrameDof*(num_frames-num_fix_frames)) = e;
+
+			TBackSubstitutionData bs_data;
+			bs_data.st = &structure;
+			bs_data.jac_data_vec = &jac_data_vec;
+			bs_data.num_fix_frames = num_fix_frames;
+			bs_data.V_inv = &V_inv;
+			bs_data.eps_point = &eps_point;
+			bs_data.len_free_frames = len_free_frames;
+			bs_data.delta = delta.size() ? &delta[0] : NULL;
+			bs_data.g = g.size() ? &g[0] : NULL;
+			mrpt::system::parallelForBlocks(num_free_points, &pointsBackSubstitution, &bs_data, num_threads);
 
-				for (size_t j=0; j<num_free_frames; ++j)
-				{
-					WMap::iterator W_ij;
-					W_ij = W.find(make_pair(TCameraPoseID(j+num_fix_frames), TLandmarkID(i+num_fix_points) ));
-
-					if (W_ij!=W.end())
-					{
-						//tmp -= W_ij->second.T() * delta.slice(j*FrameDof,FrameDof);
-						const Array_F  v( &delta[j*FrameDof] );
-						Array_P  r;
-						W_ij->second.multiply_Atb(v, r); // r= A^t * v
-						tmp-=r;
-					}
-				}
-				Array_P Vi_tmp;
-				V_inv[i].multiply_Ab(tmp, Vi_tmp); // Vi_tmp = V_inv[i] * tmp
-
-				::memcpy(&delta[len_free_frames + i*PointDof], &Vi_tmp[0], sizeof(Vi_tmp[0])*PointDof );
-				::memcpy(&g[len_free_frames + i*PointDof], &eps_point[i][0], sizeof(eps_point[0][0])*PointDof );
-			}
 			profiler.leave("PostSchur.landmarks");
 
 
@@ -406,7 +777,8 @@ double mrpt::vision::bundle_adj_full(
 								 INV_POSES_BOOL, // are poses inverse?
 								 use_robust_kernel,
 								 kernel_param,
-								 use_robust_kernel ? &new_kernel_1st_deriv : NULL );
+								 use_robust_kernel ? &new_kernel_1st_deriv : NULL,
+								 num_threads );
 			profiler.leave("reprojectionResiduals");
 
 			MRPT_CHECK_NORMAL_NUMBER(res_new)
@@ -428,18 +800,11 @@ double mrpt::vision::bundle_adj_full(
 				res = res_new;
 
 				profiler.enter("compute_Jacobians");
-				ba_compute_Jacobians<INV_POSES_BOOL>(frame_poses, landmark_points, camera_params, jac_data_vec, num_fix_frames, num_fix_points);
+				ba_compute_Jacobians<INV_POSES_BOOL>(frame_poses, landmark_points, camera_params, jac_data_vec, num_fix_frames, num_fix_points, num_threads);
 				profiler.leave("compute_Jacobians");
 
-
-				// Reset to zeros:
-				H_f.assign(num_free_frames,Matrix_FxF() );
-				H_p.assign(num_free_points,Matrix_PxP() );
-				eps_frame.assign(num_free_frames, arrF_zeros);
-				eps_point.assign(num_free_points, arrP_zeros);
-
 				profiler.enter("build_gradient_Hessians");
-				ba_build_gradient_Hessians(observations,residual_vec,jac_data_vec,H_f,eps_frame,H_p,eps_point, num_fix_frames, num_fix_points, use_robust_kernel ? &kernel_1st_deriv : NULL );
+				buildGradientHessians(gh_data, num_threads);
 				profiler.leave("build_gradient_Hessians");
 
 				stop = norm_inf(g)<=eps;
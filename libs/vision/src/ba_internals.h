@@ -16,6 +16,7 @@
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/utils/aligned_containers.h>
 #include <mrpt/vision/types.h>
+#include <mrpt/system/threads.h> // parallelForBlocks()
 
 // Declarations shared between ba_*.cpp files, but which are private to MRPT
 //  not to be seen by an MRPT API user.
@@ -159,10 +160,51 @@ namespace mrpt
 			out_J.multiply_AB(tmp, dp_point);
 		}
 
+		// Worker (for mrpt::system::parallelForBlocks) of ba_compute_Jacobians(), for a block of observations.
+		template <bool POSES_ARE_INVERSE>
+		struct TBAJacobiansWorker
+		{
+			const TFramePosesVec         * frame_poses;
+			const TLandmarkLocationsVec  * landmark_points;
+			const mrpt::utils::TCamera   * camera_params;
+			mrpt::aligned_containers<JacData<6,3,2> >::vector_t * jac_data_vec;
+			size_t num_fix_frames, num_fix_points;
+
+			static void run(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+			{
+				MRPT_UNUSED_PARAM(thread_idx);
+				const TBAJacobiansWorker &d = *static_cast<const TBAJacobiansWorker*>(user_param);
+
+				for (size_t i=first;i<last;i++)
+				{
+					JacData<6,3,2> &D = (*d.jac_data_vec)[i];
+
+					const TCameraPoseID  i_f = D.frame_id;
+					const TLandmarkID    i_p = D.point_id;
+
+					ASSERTDEB_(i_f<d.frame_poses->size())
+					ASSERTDEB_(i_p<d.landmark_points->size())
+
+					if (i_f>=d.num_fix_frames)
+					{
+						frameJac<POSES_ARE_INVERSE>(*d.camera_params, (*d.frame_poses)[i_f], (*d.landmark_points)[i_p], D.J_frame);
+						D.J_frame_valid = true;
+					}
+
+					if (i_p>=d.num_fix_points)
+					{
+						pointJac<POSES_ARE_INVERSE>(*d.camera_params, (*d.frame_poses)[i_f], (*d.landmark_points)[i_p], D.J_point);
+						D.J_point_valid = true;
+					}
+				}
+			}
+		};
+
 		// === Compute sparse Jacobians ====
 		// Case: 6D poses + 3D points + 2D (x,y) observations
 		// For the case of *inverse* or *normal* frame poses being estimated.
 		// Made inline so immediate values in "poses_are_inverses" are propragated by the compiler
+		// Each observation is independent, so they are split among "num_threads" threads (0: one per core).
 		template <bool POSES_ARE_INVERSE>
 		void ba_compute_Jacobians(
 			const TFramePosesVec         & frame_poses,
@@ -170,57 +212,27 @@ namespace mrpt
 			const mrpt::utils::TCamera   & camera_params,
 			mrpt::aligned_containers<JacData<6,3,2> >::vector_t & jac_data_vec,
 			const size_t                   num_fix_frames,
-			const size_t                   num_fix_points)
+			const size_t                   num_fix_points,
+			const unsigned int             num_threads = 1)
 		{
 			MRPT_START
 
 			// num_fix_frames & num_fix_points: Are relative to the order in frame_poses & landmark_points
 			ASSERT_(!frame_poses.empty() && !landmark_points.empty())
 
-			const size_t N = jac_data_vec.size();
-
-			for (size_t i=0;i<N;i++)
-			{
-				JacData<6,3,2> &D = jac_data_vec[i];
-
-				const TCameraPoseID  i_f = D.frame_id;
-				const TLandmarkID    i_p = D.point_id;
+			TBAJacobiansWorker<POSES_ARE_INVERSE> d;
+			d.frame_poses = &frame_poses;
+			d.landmark_points = &landmark_points;
+			d.camera_params = &camera_params;
+			d.jac_data_vec = &jac_data_vec;
+			d.num_fix_frames = num_fix_frames;
+			d.num_fix_points = num_fix_points;
 
-				ASSERTDEB_(i_f<frame_poses.size())
-				ASSERTDEB_(i_p<landmark_points.size())
-
-				if (i_f>=num_fix_frames)
-				{
-					frameJac<POSES_ARE_INVERSE>(camera_params, frame_poses[i_f], landmark_points[i_p], D.J_frame);
-					D.J_frame_valid = true;
-				}
+			mrpt::system::parallelForBlocks(jac_data_vec.size(), &TBAJacobiansWorker<POSES_ARE_INVERSE>::run, &d, num_threads);
 
-				if (i_p>=num_fix_points)
-				{
-					pointJac<POSES_ARE_INVERSE>(camera_params, frame_poses[i_f], landmark_points[i_p], D.J_point);
-					D.J_point_valid = true;
-				}
-			}
 			MRPT_END
 		}
 
-		/** Construct the BA linear system.
-		  *  Set kernel_1st_deriv!=NULL if using robust kernel.
-		  */
-		void ba_build_gradient_Hessians(
-			const TSequenceFeatureObservations          & observations,
-			const std::vector<mrpt::utils::CArray<double,2> >              & residual_vec,
-			const mrpt::aligned_containers<JacData<6,3,2> >::vector_t & jac_data_vec,
-			mrpt::aligned_containers<mrpt::math::CMatrixFixedNumeric<double,6,6> >::vector_t  & U,
-			mrpt::aligned_containers<CArrayDouble<6> >::vector_t & eps_frame,
-			mrpt::aligned_containers<mrpt::math::CMatrixFixedNumeric<double,3,3> >::vector_t & V,
-			mrpt::aligned_containers<CArrayDouble<3> >::vector_t & eps_point,
-			const size_t                                  num_fix_frames,
-			const size_t                                  num_fix_points,
-			const vector<double>   * kernel_1st_deriv
-			);
-
-
 	}
 }
 
@@ -0,0 +1,75 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+// Synthetic bundle adjustment problems, shared by the unit tests and mrpt-performance.
+
+#include <mrpt/vision/bundle_adjustment.h>
+#include <mrpt/vision/pinhole.h>
+#include <mrpt/random.h>
+
+class BundleAdjustmentTestScene
+{
+public:
+	static const size_t OBS_PER_POINT = 5; //!< Each point is seen from this number of consecutive frames
+
+	/** A camera moving sideways in front of a wall of points, with the observations (plus Gaussian noise of std.dev.
+	  * \a pixel_noise_std) and an initial estimate with noisy poses and points. The first two frames are exact,
+	  * so they can be fixed (`num_fix_frames=2`) to define the scale.
+	  */
+	static void create(
+		const size_t num_frames,
+		const size_t num_points,
+		const double pixel_noise_std,
+		const mrpt::utils::TCamera &cam,
+		mrpt::vision::TSequenceFeatureObservations &obs,
+		mrpt::vision::TFramePosesVec &gt_frames,
+		mrpt::vision::TFramePosesVec &frames,
+		mrpt::vision::TLandmarkLocationsVec &points)
+	{
+		using mrpt::poses::CPose3D;
+
+		mrpt::random::CRandomGenerator rng(1234);
+
+		gt_frames.resize(num_frames);
+		for (size_t i=0;i<num_frames;i++)
+			gt_frames[i] = CPose3D(0.05*i, 0.1*sin(0.1*i), 0, 0.02*sin(0.05*i), 0, 0);
+
+		points.resize(num_points);
+		obs.clear();
+		obs.reserve(num_points*OBS_PER_POINT);
+		for (size_t i=0;i<num_points;i++)
+		{
+			const size_t first_frame = rng.drawUniform32bit() % (num_frames-OBS_PER_POINT+1);
+			const CPose3D &base = gt_frames[first_frame+OBS_PER_POINT/2];
+			points[i] = mrpt::math::TPoint3D(base.x()+rng.drawUniform(-1.5,1.5), base.y()+rng.drawUniform(-1.0,1.0), rng.drawUniform(4.0,8.0));
+			for (size_t j=first_frame;j<first_frame+OBS_PER_POINT;j++)
+			{
+				mrpt::utils::TPixelCoordf px = mrpt::vision::pinhole::projectPoint_no_distortion<false>(cam, gt_frames[j], points[i]);
+				if (pixel_noise_std>0)
+				{
+					px.x+=rng.drawGaussian1D(0,pixel_noise_std);
+					px.y+=rng.drawGaussian1D(0,pixel_noise_std);
+				}
+				obs.push_back( mrpt::vision::TFeatureObservation(i, j, px) );
+			}
+		}
+
+		frames = gt_frames;
+		for (size_t j=2;j<num_frames;j++)
+			frames[j] = CPose3D(
+				frames[j].x()+rng.drawGaussian1D(0,0.01), frames[j].y()+rng.drawGaussian1D(0,0.01), frames[j].z()+rng.drawGaussian1D(0,0.01),
+				frames[j].yaw()+rng.drawGaussian1D(0,0.005), frames[j].pitch(), frames[j].roll());
+		for (size_t i=0;i<num_points;i++)
+		{
+			points[i].x+=rng.drawGaussian1D(0,0.05);
+			points[i].y+=rng.drawGaussian1D(0,0.05);
+			points[i].z+=rng.drawGaussian1D(0,0.05);
+		}
+	}
+};
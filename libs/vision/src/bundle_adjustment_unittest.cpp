@@ -0,0 +1,74 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "bundle_adjustment_test_common.h"
+#include <gtest/gtest.h>
+
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+using namespace mrpt::poses;
+using namespace mrpt::math;
+
+namespace
+{
+	double runBA(const TSequenceFeatureObservations &obs, const TCamera &cam, TFramePosesVec &frames, TLandmarkLocationsVec &points, int solver, int num_threads)
+	{
+		TParametersDouble params;
+		params["num_fix_frames"] = 2;
+		params["max_iterations"] = 20;
+		params["robust_kernel"] = 0;
+		params["solver"] = solver;
+		params["pcg_tolerance"] = 1e-10;
+		params["num_threads"] = num_threads;
+		return bundle_adj_full(obs, cam, frames, points, params);
+	}
+}
+
+TEST(bundle_adj_full, convergesSyntheticScene)
+{
+	const TCamera cam;
+	TSequenceFeatureObservations obs;
+	TFramePosesVec gt_frames, frames0;
+	TLandmarkLocationsVec points0;
+	BundleAdjustmentTestScene::create(30, 400, 0, cam, obs, gt_frames, frames0, points0);
+
+	for (int solver=0;solver<2;solver++)
+	{
+		TFramePosesVec frames = frames0;
+		TLandmarkLocationsVec points = points0;
+		const double err = runBA(obs, cam, frames, points, solver, 1);
+
+		EXPECT_LT(err, 1e-6) << "solver=" << solver;
+		for (size_t j=0;j<frames.size();j++)
+			EXPECT_LT( (frames[j].m_coords-gt_frames[j].m_coords).norm(), 1e-4) << "solver=" << solver << " frame=" << j;
+	}
+}
+
+TEST(bundle_adj_full, resultDoesNotDependOnThreads)
+{
+	const TCamera cam;
+	TSequenceFeatureObservations obs;
+	TFramePosesVec gt_frames, frames0;
+	TLandmarkLocationsVec points0;
+	BundleAdjustmentTestScene::create(20, 200, 0.5, cam, obs, gt_frames, frames0, points0);
+
+	for (int solver=0;solver<2;solver++)
+	{
+		TFramePosesVec frames1 = frames0, frames3 = frames0;
+		TLandmarkLocationsVec points1 = points0, points3 = points0;
+		const double err1 = runBA(obs, cam, frames1, points1, solver, 1);
+		const double err3 = runBA(obs, cam, frames3, points3, solver, 3);
+
+		EXPECT_EQ(err1, err3) << "solver=" << solver;
+		for (size_t j=0;j<frames1.size();j++)
+			EXPECT_TRUE(frames1[j].m_coords==frames3[j].m_coords) << "solver=" << solver << " frame=" << j;
+		for (size_t i=0;i<points1.size();i++)
+			EXPECT_TRUE(points1[i]==points3[i]) << "solver=" << solver << " point=" << i;
+	}
+}
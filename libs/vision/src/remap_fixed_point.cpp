@@ -0,0 +1,141 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "vision-precomp.h"   // Precompiled headers
+
+#include "remap_internal.h"
+#include <mrpt/system/threads.h> // parallelForBlocks()
+
+// Universal include for all versions of OpenCV
+#include <mrpt/otherlibs/do_opencv_includes.h>
+
+using namespace mrpt;
+using namespace mrpt::vision::detail;
+
+namespace
+{
+	const int REMAP_FRAC_BITS = 5;  // As OpenCV's INTER_BITS
+	const int REMAP_FRAC_ONE = 1<<REMAP_FRAC_BITS;
+	const int REMAP_FRAC_MASK = REMAP_FRAC_ONE-1;
+	const int REMAP_WEIGHT_BITS = 2*REMAP_FRAC_BITS;
+
+	// Remaps one row of the target image.
+	template <int CHANNELS>
+	void remapRowBilinear(const TFixedPointRemapJob &job, const int y)
+	{
+		const int16_t  *mxy   = job.map_xy + 2*size_t(y)*job.dst_width;
+		const uint16_t *mfrac = job.map_frac + size_t(y)*job.dst_width;
+		uint8_t *out = job.dst + size_t(y)*job.dst_stride;
+		const int stride = job.src_stride;
+
+		for (int x=0;x<job.dst_width;x++, out+=CHANNELS)
+		{
+			const int sx = mxy[2*x], sy = mxy[2*x+1];
+			const int fx = mfrac[x] & REMAP_FRAC_MASK;
+			const int fy = (mfrac[x] >> REMAP_FRAC_BITS) & REMAP_FRAC_MASK;
+
+			// Bilinear weights, which add up to 2^REMAP_WEIGHT_BITS:
+			const int w00 = (REMAP_FRAC_ONE-fx)*(REMAP_FRAC_ONE-fy), w01 = fx*(REMAP_FRAC_ONE-fy), w10 = (REMAP_FRAC_ONE-fx)*fy, w11 = fx*fy;
+
+			if (static_cast<unsigned int>(sx) < static_cast<unsigned int>(job.src_width-1) &&
+			    static_cast<unsigned int>(sy) < static_cast<unsigned int>(job.src_height-1))
+			{
+				// Fast path: the 2x2 neighbourhood is within the image
+				const uint8_t *p = job.src + size_t(sy)*stride + sx*CHANNELS;
+				for (int c=0;c<CHANNELS;c++)
+					out[c] = static_cast<uint8_t>( (p[c]*w00 + p[c+CHANNELS]*w01 + p[c+stride]*w10 + p[c+stride+CHANNELS]*w11 + (1<<(REMAP_WEIGHT_BITS-1))) >> REMAP_WEIGHT_BITS );
+			}
+			else
+			{
+				// Image borders: pixels out of the image are zero
+				const bool in_x0 = sx>=0 && sx<job.src_width, in_x1 = sx+1>=0 && sx+1<job.src_width;
+				const bool in_y0 = sy>=0 && sy<job.src_height, in_y1 = sy+1>=0 && sy+1<job.src_height;
+				const uint8_t *p0 = job.src + size_t(sy)*stride + sx*CHANNELS;  // Only dereferenced within the image
+				for (int c=0;c<CHANNELS;c++)
+				{
+					int v = 0;
+					if (in_y0 && in_x0) v+= p0[c]*w00;
+					if (in_y0 && in_x1) v+= p0[c+CHANNELS]*w01;
+					if (in_y1 && in_x0) v+= p0[c+stride]*w10;
+					if (in_y1 && in_x1) v+= p0[c+stride+CHANNELS]*w11;
+					out[c] = static_cast<uint8_t>( (v + (1<<(REMAP_WEIGHT_BITS-1))) >> REMAP_WEIGHT_BITS );
+				}
+			}
+		}
+	}
+
+	struct TRemapData
+	{
+		const std::vector<TFixedPointRemapJob> *jobs;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) remapping a block of rows, numbered consecutively through all the jobs.
+	void remapRowsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const std::vector<TFixedPointRemapJob> &jobs = *static_cast<const TRemapData*>(user_param)->jobs;
+
+		size_t job_first_row = 0;
+		for (size_t j=0;j<jobs.size() && first<last;j++)
+		{
+			const TFixedPointRemapJob &job = jobs[j];
+			const size_t job_end_row = job_first_row + job.dst_height;
+			for (;first<last && first<job_end_row;first++)
+			{
+				const int y = static_cast<int>(first-job_first_row);
+				if (job.channels==1)
+						remapRowBilinear<1>(job,y);
+				else	remapRowBilinear<3>(job,y);
+			}
+			job_first_row = job_end_row;
+		}
+	}
+}
+
+bool mrpt::vision::detail::makeFixedPointRemapJob(const void *src_ipl, void *dst_ipl, const int16_t *map_xy, const uint16_t *map_frac, TFixedPointRemapJob &job)
+{
+#if MRPT_HAS_OPENCV
+	const IplImage *src = static_cast<const IplImage*>(src_ipl);
+	IplImage *dst = static_cast<IplImage*>(dst_ipl);
+	if (src->depth!=IPL_DEPTH_8U || dst->depth!=IPL_DEPTH_8U || src->nChannels!=dst->nChannels || (src->nChannels!=1 && src->nChannels!=3) || src->roi || dst->roi)
+		return false;
+
+	job.src = reinterpret_cast<const uint8_t*>(src->imageData);
+	job.src_width = src->width;
+	job.src_height = src->height;
+	job.src_stride = src->widthStep;
+	job.dst = reinterpret_cast<uint8_t*>(dst->imageData);
+	job.dst_width = dst->width;
+	job.dst_height = dst->height;
+	job.dst_stride = dst->widthStep;
+	job.channels = src->nChannels;
+	job.map_xy = map_xy;
+	job.map_frac = map_frac;
+	return true;
+#else
+	MRPT_UNUSED_PARAM(src_ipl); MRPT_UNUSED_PARAM(dst_ipl); MRPT_UNUSED_PARAM(map_xy); MRPT_UNUSED_PARAM(map_frac); MRPT_UNUSED_PARAM(job);
+	return false;
+#endif
+}
+
+void mrpt::vision::detail::remapBilinearFixedPoint(const std::vector<TFixedPointRemapJob> &jobs, const unsigned int numThreads)
+{
+	size_t nRows = 0;
+	for (size_t j=0;j<jobs.size();j++)
+	{
+		ASSERT_(jobs[j].channels==1 || jobs[j].channels==3)
+		nRows += jobs[j].dst_height;
+	}
+	if (!nRows) return;
+
+	TRemapData d;
+	d.jobs = &jobs;
+	const unsigned int nThreads = numThreads!=0 ? numThreads : mrpt::system::getNumberOfProcessors();
+	mrpt::system::parallelForBlocks(nRows, &remapRowsBlock, &d, static_cast<unsigned int>(std::min<size_t>(nThreads, nRows)));
+}
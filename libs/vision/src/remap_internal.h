@@ -0,0 +1,53 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#ifndef remap_internal_H
+#define remap_internal_H
+
+#include <mrpt/utils/mrpt_stdint.h>
+#include <vector>
+
+// Declarations shared between CUndistortMap and CStereoRectifyMap, but which are private to MRPT
+//  not to be seen by an MRPT API user.
+
+namespace mrpt
+{
+	namespace vision
+	{
+		namespace detail
+		{
+			/** One image to be remapped with the fixed-point maps generated by cv::initUndistortRectifyMap() with type CV_16SC2:
+			  *  `map_xy` has the integer source coordinates (x,y) of each target pixel (interleaved), and `map_frac` their
+			  *  fractional parts in 1/32 pixel units, as `32*frac_y + frac_x`.
+			  */
+			struct TFixedPointRemapJob
+			{
+				const uint8_t *src;
+				int src_width, src_height, src_stride;
+				uint8_t *dst;
+				int dst_width, dst_height, dst_stride;
+				int channels;
+				const int16_t *map_xy;
+				const uint16_t *map_frac;
+			};
+
+			/** Fills a job from OpenCV's IplImage's (passed as void* to avoid header dependencies).
+			  * \return false if the images are not supported by remapBilinearFixedPoint() (only 8-bit images with 1 or 3 channels are). */
+			bool makeFixedPointRemapJob(const void *src_ipl, void *dst_ipl, const int16_t *map_xy, const uint16_t *map_frac, TFixedPointRemapJob &job);
+
+			/** Bilinear remap of 8-bit images with fixed-point maps and a zero constant border, like
+			  *  `cv::remap(...,INTER_LINEAR,BORDER_CONSTANT)`. The rows of all the jobs are processed in parallel.
+			  * \param numThreads Number of threads (0: all the cores).
+			  */
+			void remapBilinearFixedPoint(const std::vector<TFixedPointRemapJob> &jobs, const unsigned int numThreads);
+		}
+	}
+}
+
+#endif
@@ -9,29 +9,49 @@
 
 #include "vision-precomp.h"   // Precompiled headers
 
-#include <mrpt/system/memory.h>
 #include <mrpt/vision/tracking.h>
-#include <mrpt/vision/CFeatureExtraction.h>
-
-// Universal include for all versions of OpenCV
-#include <mrpt/otherlibs/do_opencv_includes.h>
-
-#if HAVE_ALLOCA_H
-# include <alloca.h>
-#endif
-
+#include "tracking_KL_internal.h"
+#include <cstring>
 
 using namespace mrpt;
 using namespace mrpt::vision;
 using namespace mrpt::utils;
 using namespace std;
 
+namespace
+{
+	void getPyramidLevels(const CImagePyramid &pyr, std::vector<detail::TGrayImageView> &levels)
+	{
+		levels.resize(pyr.images.size());
+		for (size_t i=0;i<pyr.images.size();i++)
+		{
+			const CImage &img = pyr.images[i];
+			levels[i].data = img.get_unsafe(0,0);
+			levels[i].width = static_cast<int>(img.getWidth());
+			levels[i].height = static_cast<int>(img.getHeight());
+			levels[i].stride = static_cast<int>(img.getRowStride());
+		}
+	}
+
+	bool sameGrayImages(const CImage &a, const CImage &b)
+	{
+		if (a.getWidth()!=b.getWidth() || a.getHeight()!=b.getHeight() || a.isColor() || b.isColor())
+			return false;
+		const size_t w = a.getWidth();
+		for (unsigned int y=0;y<a.getHeight();y++)
+			if (std::memcmp(a.get_unsafe(0,y),b.get_unsafe(0,y),w)!=0)
+				return false;
+		return true;
+	}
+}
 
 /** Track a set of features from old_img -> new_img using sparse optimal flow (classic KL method)
   *  Optional parameters that can be passed in "extra_params":
   *		- "window_width"  (Default=15)
   *		- "window_height" (Default=15)
   *
+  *  The grayscale pyramid of new_img is kept for the next call, where it is reused if old_img is the same image.
+  *
   *  \sa OpenCV's method cvCalcOpticalFlowPyrLK
   */
 template <typename FEATLIST>
@@ -42,15 +62,16 @@ void CFeatureTracker_KL::trackFeatures_impl_templ(
 {
 MRPT_START
 
-#if MRPT_HAS_OPENCV
 	const unsigned int 	window_width = extra_params.getWithDefaultVal("window_width",15);
 	const unsigned int 	window_height = extra_params.getWithDefaultVal("window_height",15);
 
 	const int 	LK_levels    = extra_params.getWithDefaultVal("LK_levels",3);
 	const int 	LK_max_iters = extra_params.getWithDefaultVal("LK_max_iters",10);
-	const int 	LK_epsilon   = extra_params.getWithDefaultVal("LK_epsilon",0.1);
+	const float	LK_epsilon   = extra_params.getWithDefaultVal("LK_epsilon",0.1f);
 	const float LK_max_tracking_error = extra_params.getWithDefaultVal("LK_max_tracking_error",150.0f);
+	const unsigned int num_threads = extra_params.getWithDefaultVal("num_threads",1);
 
+	ASSERT_(LK_levels>=0)
 
 	// Both images must be of the same size
 	ASSERT_( old_img.getWidth() == new_img.getWidth() && old_img.getHeight() == new_img.getHeight() );
@@ -59,46 +80,48 @@ MRPT_START
 	const size_t  img_height = old_img.getHeight();
 
 	const size_t nFeatures	= featureList.size();					// Number of features
+	const size_t nOctaves = LK_levels+1;
 
-	// Grayscale images
-	const CImage prev_gray(old_img, FAST_REF_OR_CONVERT_TO_GRAY);
-	const CImage cur_gray(new_img, FAST_REF_OR_CONVERT_TO_GRAY);
+	// Grayscale pyramid of the new image. A freshly converted grayscale image is moved into the pyramid, while
+	//  a grayscale input must be copied, since the pyramid is kept for the next call:
+	CImagePyramid cur_pyr;
+	{
+		CImage cur_gray(new_img, FAST_REF_OR_CONVERT_TO_GRAY);
+		if (new_img.isColor())
+				cur_pyr.buildPyramidFast(cur_gray, nOctaves, true);
+		else	cur_pyr.buildPyramid(cur_gray, nOctaves, true);
+	}
 
-	// Array conversion MRPT->OpenCV
 	if (nFeatures>0)
 	{
-		CvPoint2D32f *points[2];
-
-		points[0] = reinterpret_cast<CvPoint2D32f *>( mrpt_alloca(sizeof(CvPoint2D32f)*nFeatures) );
-		points[1] = reinterpret_cast<CvPoint2D32f *>( mrpt_alloca(sizeof(CvPoint2D32f)*nFeatures) );
-
-		std::vector<char>	status(nFeatures);
-
+		// Pyramid of the old image: reuse the one of the last call if old_img was its new_img (the usual case in a video sequence).
+		{
+			const CImage prev_gray(old_img, FAST_REF_OR_CONVERT_TO_GRAY);
+			if (m_prev_pyramid.images.size()!=nOctaves || !sameGrayImages(m_prev_pyramid.images[0], prev_gray))
+				m_prev_pyramid.buildPyramid(prev_gray, nOctaves, true);
+		}
+
+		std::vector<TPixelCoordf> points(nFeatures), tracked_points;
+		std::vector<char>	status;
+		std::vector<float>	track_error;
 		for(size_t i=0;i<nFeatures;++i)
 		{
-			points[0][i].x = featureList.getFeatureX(i);
-			points[0][i].y = featureList.getFeatureY(i);
+			points[i].x = featureList.getFeatureX(i);
+			points[i].y = featureList.getFeatureY(i);
 		} // end for
 
-		// local scope for auxiliary variables around cvCalcOpticalFlowPyrLK()
-		const IplImage *prev_gray_ipl = prev_gray.getAs<IplImage>();
-		const IplImage *cur_gray_ipl  = cur_gray.getAs<IplImage>();
+		std::vector<detail::TGrayImageView> prev_levels, cur_levels;
+		getPyramidLevels(m_prev_pyramid, prev_levels);
+		getPyramidLevels(cur_pyr, cur_levels);
 
-		// Pyramids
-		// JL: It seems that cache'ing the pyramids of previous images doesn't really improve the efficiency (!?!?)
-		IplImage* pPyr = NULL;
-		IplImage* cPyr = NULL;
+		detail::TPyrLKOptions opts;
+		opts.window_width = window_width;
+		opts.window_height = window_height;
+		opts.max_iters = LK_max_iters;
+		opts.epsilon = LK_epsilon;
+		opts.min_eigen_threshold = 0.1f;  // The same than OpenCV's default (1e-4), which is in units of (32 gray levels/pixel)^2
 
-		int	flags = 0;
-
-		float* track_error = reinterpret_cast<float*>( mrpt_alloca(sizeof(float)*nFeatures) );
-
-		cvCalcOpticalFlowPyrLK(prev_gray_ipl, cur_gray_ipl, pPyr, cPyr,
-			&points[0][0], &points[1][0], nFeatures, cvSize( window_width, window_height ), LK_levels, &status[0], track_error,
-			cvTermCriteria(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS,LK_max_iters,LK_epsilon), flags );
-
-		cvReleaseImage( &pPyr );
-		cvReleaseImage( &cPyr );
+		detail::trackPointsPyrLK(prev_levels, cur_levels, points, tracked_points, status, track_error, opts, num_threads);
 
 		for(size_t i=0;i<nFeatures;++i)
 		{
@@ -106,12 +129,12 @@ MRPT_START
 
 			if( status[i] == 1 &&
 				!trck_err_too_large &&
-				points[1][i].x > 0 && points[1][i].y > 0 &&
-				points[1][i].x < img_width && points[1][i].y < img_height )
+				tracked_points[i].x > 0 && tracked_points[i].y > 0 &&
+				tracked_points[i].x < img_width && tracked_points[i].y < img_height )
 			{
 				// Feature could be tracked
-				featureList.setFeatureXf(i, points[1][i].x );
-				featureList.setFeatureYf(i, points[1][i].y );
+				featureList.setFeatureXf(i, tracked_points[i].x );
+				featureList.setFeatureYf(i, tracked_points[i].y );
 				featureList.setTrackStatus(i, status_TRACKED );
 			} // end if
 			else	// Feature could not be tracked
@@ -122,18 +145,12 @@ MRPT_START
 			} // end else
 		} // end for
 
-		mrpt_alloca_free( points[0] );
-		mrpt_alloca_free( points[1] );
-		mrpt_alloca_free( track_error );
-
-
 		// In case it needs to rebuild a kd-tree or whatever
 		featureList.mark_as_outdated();
 	}
 
-#else
-	THROW_EXCEPTION("The MRPT has been compiled with MRPT_HAS_OPENCV=0 !");
-#endif
+	// Keep the new pyramid for the next call:
+	m_prev_pyramid.images.swap(cur_pyr.images);
 
 	MRPT_END
 } // end trackFeatures
@@ -0,0 +1,63 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#ifndef tracking_KL_internal_H
+#define tracking_KL_internal_H
+
+#include <mrpt/utils/mrpt_stdint.h>
+#include <mrpt/utils/TPixelCoord.h>
+#include <vector>
+
+// Declarations of the pyramidal Lucas-Kanade tracker behind CFeatureTracker_KL, which are private to MRPT
+//  not to be seen by an MRPT API user.
+
+namespace mrpt
+{
+	namespace vision
+	{
+		namespace detail
+		{
+			/** A read-only view of an 8-bit grayscale image (e.g. one octave of a CImagePyramid). */
+			struct TGrayImageView
+			{
+				const uint8_t *data;
+				int width, height, stride;
+			};
+
+			/** Parameters of trackPointsPyrLK() */
+			struct TPyrLKOptions
+			{
+				int   window_width, window_height; //!< Size of the tracked patches (pixels)
+				int   max_iters;                   //!< Max. number of iterations at each pyramid level
+				float epsilon;                     //!< Iterations stop when the update step is shorter than this (pixels)
+				float min_eigen_threshold;         //!< Points with a smaller min. eigenvalue of the gradient matrix, per window pixel, are lost (gray levels^2/pixel^2)
+			};
+
+			/** Tracks points from \a prev to \a next with the pyramidal Lucas-Kanade method (Bouguet's formulation).
+			  *  Both pyramids must have the same number of levels, each one built by halving the previous one with a
+			  *  2x2 mean (as CImagePyramid does with `smooth_halves=true`). Pixels out of the images are replicated from the borders.
+			  *
+			  * \param[out] status  1: tracked; 0: lost (the point left the image or its patch has no texture).
+			  * \param[out] errors  Mean absolute difference between the patches at the finest level (only valid if status=1).
+			  * \param numThreads   Number of threads, each one tracking a chunk of points (0: all the cores).
+			  */
+			void trackPointsPyrLK(
+				const std::vector<TGrayImageView> &prev,
+				const std::vector<TGrayImageView> &next,
+				const std::vector<mrpt::utils::TPixelCoordf> &pts,
+				std::vector<mrpt::utils::TPixelCoordf> &out_pts,
+				std::vector<char> &status,
+				std::vector<float> &errors,
+				const TPyrLKOptions &opts,
+				const unsigned int numThreads);
+		}
+	}
+}
+
+#endif
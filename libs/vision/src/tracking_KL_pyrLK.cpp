@@ -0,0 +1,260 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "vision-precomp.h"   // Precompiled headers
+
+#include "tracking_KL_internal.h"
+#include <mrpt/system/threads.h> // parallelForBlocks()
+#include <mrpt/utils/SSE_types.h>
+#include <cmath>
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace mrpt::vision::detail;
+
+namespace
+{
+	inline int clampCoord(const int v, const int size)
+	{
+		return v<0 ? 0 : (v>=size ? size-1 : v);
+	}
+
+	// Bilinear interpolation of a row of "n" pixels, all with the same fractional offset: "p" and "q" point to the
+	//  top-left neighbour of the first pixel in two consecutive image rows, which must have n+1 valid pixels.
+	inline void sampleRowBilinear(const uint8_t *p, const uint8_t *q, const int n, const float w00, const float w01, const float w10, const float w11, float *out)
+	{
+		int i=0;
+#if MRPT_HAS_SSE2
+		const __m128 W00 = _mm_set1_ps(w00), W01 = _mm_set1_ps(w01), W10 = _mm_set1_ps(w10), W11 = _mm_set1_ps(w11);
+		const __m128i zero = _mm_setzero_si128();
+		for (;i+8<=n;i+=8)
+		{
+			// 8 pixels and their right neighbours (reads up to p[i+8], within the n+1 valid pixels), as 16-bit integers:
+			const __m128i p0 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p+i)),zero);
+			const __m128i p1 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p+i+1)),zero);
+			const __m128i q0 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(q+i)),zero);
+			const __m128i q1 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(q+i+1)),zero);
+
+			__m128 r = _mm_mul_ps(W00,_mm_cvtepi32_ps(_mm_unpacklo_epi16(p0,zero)));
+			r = _mm_add_ps(r,_mm_mul_ps(W01,_mm_cvtepi32_ps(_mm_unpacklo_epi16(p1,zero))));
+			r = _mm_add_ps(r,_mm_mul_ps(W10,_mm_cvtepi32_ps(_mm_unpacklo_epi16(q0,zero))));
+			r = _mm_add_ps(r,_mm_mul_ps(W11,_mm_cvtepi32_ps(_mm_unpacklo_epi16(q1,zero))));
+			_mm_storeu_ps(out+i, r);
+
+			r = _mm_mul_ps(W00,_mm_cvtepi32_ps(_mm_unpackhi_epi16(p0,zero)));
+			r = _mm_add_ps(r,_mm_mul_ps(W01,_mm_cvtepi32_ps(_mm_unpackhi_epi16(p1,zero))));
+			r = _mm_add_ps(r,_mm_mul_ps(W10,_mm_cvtepi32_ps(_mm_unpackhi_epi16(q0,zero))));
+			r = _mm_add_ps(r,_mm_mul_ps(W11,_mm_cvtepi32_ps(_mm_unpackhi_epi16(q1,zero))));
+			_mm_storeu_ps(out+i+4, r);
+		}
+#endif
+		// Scalar version, or the remaining pixels:
+		for (;i<n;i++)
+			out[i] = w00*p[i] + w01*p[i+1] + w10*q[i] + w11*q[i+1];
+	}
+
+	// Bilinear sampling of the w x h patch whose top-left pixel is at (x,y). Pixels out of the image are replicated from the borders.
+	void samplePatch(const TGrayImageView &img, const float x, const float y, const int w, const int h, float *out)
+	{
+		const int ix = static_cast<int>(std::floor(x)), iy = static_cast<int>(std::floor(y));
+		const float a = x-ix, b = y-iy;
+		const float w00 = (1-a)*(1-b), w01 = a*(1-b), w10 = (1-a)*b, w11 = a*b;
+
+		if (ix>=0 && iy>=0 && ix+w<img.width && iy+h<img.height)
+		{
+			// Fast path: the patch and its right/bottom neighbours are within the image
+			const uint8_t *row = img.data + size_t(iy)*img.stride + ix;
+			for (int r=0;r<h;r++, row+=img.stride)
+				sampleRowBilinear(row, row+img.stride, w, w00,w01,w10,w11, out+r*w);
+		}
+		else
+		{
+			for (int r=0;r<h;r++)
+			{
+				const uint8_t *p = img.data + size_t(clampCoord(iy+r,img.height))*img.stride;
+				const uint8_t *q = img.data + size_t(clampCoord(iy+r+1,img.height))*img.stride;
+				for (int c=0;c<w;c++)
+				{
+					const int x0 = clampCoord(ix+c,img.width), x1 = clampCoord(ix+c+1,img.width);
+					out[r*w+c] = w00*p[x0] + w01*p[x1] + w10*q[x0] + w11*q[x1];
+				}
+			}
+		}
+	}
+
+	// The whole window must not be farther than its own size from the image, as in OpenCV's cv::calcOpticalFlowPyrLK()
+	inline bool isWindowNearImage(const TGrayImageView &img, const float x, const float y, const int w, const int h)
+	{
+		return x>=-w && y>=-h && x<img.width && y<img.height;
+	}
+
+	struct TPyrLKData
+	{
+		const std::vector<TGrayImageView> *prev, *next;
+		const std::vector<TPixelCoordf> *pts;
+		std::vector<TPixelCoordf> *out_pts;
+		std::vector<char> *status;
+		std::vector<float> *errors;
+		const TPyrLKOptions *opts;
+	};
+
+	// Worker (for mrpt::system::parallelForBlocks) tracking the points [first,last).
+	void trackPointsBlock(size_t first, size_t last, unsigned int thread_idx, void *user_param)
+	{
+		MRPT_UNUSED_PARAM(thread_idx);
+		const TPyrLKData &d = *static_cast<const TPyrLKData*>(user_param);
+		const TPyrLKOptions &opts = *d.opts;
+		const std::vector<TGrayImageView> &prev = *d.prev, &next = *d.next;
+
+		const int W = opts.window_width, H = opts.window_height, area = W*H;
+		const float halfW = (W-1)*0.5f, halfH = (H-1)*0.5f;
+		const float eps2 = opts.epsilon*opts.epsilon;
+
+		// Scratch buffers of this thread: the template patch with a 1 pixel margin, and its interior, gradients and the moving patch.
+		std::vector<float> patch((W+2)*(H+2)), I(area), Ix(area), Iy(area), J(area);
+
+		for (size_t k=first;k<last;k++)
+		{
+			const TPixelCoordf &pt = (*d.pts)[k];
+			char &status = (*d.status)[k];
+			status = 1;
+
+			// Displacement of the point, in pixels of the current pyramid level:
+			float dx = 0, dy = 0;
+
+			for (int level=static_cast<int>(prev.size())-1;level>=0;level--)
+			{
+				if (level!=static_cast<int>(prev.size())-1) { dx*=2; dy*=2; }
+
+				// Top-left corner of the window at this level. Each octave halves with a 2x2 mean, so pixel centers shift by 1/2:
+				const float scale = 1.0f/(1<<level);
+				const float px = (pt.x+0.5f)*scale-0.5f-halfW, py = (pt.y+0.5f)*scale-0.5f-halfH;
+
+				if (!isWindowNearImage(prev[level],px,py,W,H))
+				{
+					if (level==0) status = 0;
+					continue;
+				}
+
+				// Template patch and its Scharr gradients:
+				samplePatch(prev[level], px-1, py-1, W+2, H+2, &patch[0]);
+				double A11=0, A12=0, A22=0;
+				for (int r=0;r<H;r++)
+				{
+					const float *p0 = &patch[r*(W+2)], *p1 = p0+(W+2), *p2 = p1+(W+2);
+					for (int c=0;c<W;c++)
+					{
+						const int i = r*W+c;
+						I[i]  = p1[c+1];
+						Ix[i] = (3*(p0[c+2]-p0[c]) + 10*(p1[c+2]-p1[c]) + 3*(p2[c+2]-p2[c]))*(1.0f/32);
+						Iy[i] = (3*(p2[c]-p0[c]) + 10*(p2[c+1]-p0[c+1]) + 3*(p2[c+2]-p0[c+2]))*(1.0f/32);
+						A11+=Ix[i]*Ix[i];
+						A12+=Ix[i]*Iy[i];
+						A22+=Iy[i]*Iy[i];
+					}
+				}
+
+				const double min_eig = (A11+A22-std::sqrt((A11-A22)*(A11-A22)+4*A12*A12))/(2*area);
+				const double D = A11*A22-A12*A12;
+				if (min_eig<opts.min_eigen_threshold || D<1e-12)
+				{
+					if (level==0) status = 0;
+					continue;
+				}
+				const double iD = 1.0/D;
+
+				// Lucas-Kanade iterations:
+				float prev_step_x = 0, prev_step_y = 0;
+				for (int it=0;it<opts.max_iters;it++)
+				{
+					const float nx = px+dx, ny = py+dy;
+					if (!isWindowNearImage(next[level],nx,ny,W,H))
+					{
+						if (level==0) status = 0;
+						break;
+					}
+					samplePatch(next[level], nx, ny, W, H, &J[0]);
+
+					double b1=0, b2=0;
+					for (int i=0;i<area;i++)
+					{
+						const float diff = J[i]-I[i];
+						b1+=diff*Ix[i];
+						b2+=diff*Iy[i];
+					}
+					const float step_x = static_cast<float>((A12*b2-A22*b1)*iD);
+					const float step_y = static_cast<float>((A12*b1-A11*b2)*iD);
+					dx+=step_x;
+					dy+=step_y;
+
+					if (step_x*step_x+step_y*step_y<=eps2)
+						break;
+					// Oscillating around the solution: take the midpoint.
+					if (it>0 && std::abs(step_x+prev_step_x)<0.01f && std::abs(step_y+prev_step_y)<0.01f)
+					{
+						dx-=step_x*0.5f;
+						dy-=step_y*0.5f;
+						break;
+					}
+					prev_step_x = step_x;
+					prev_step_y = step_y;
+				}
+
+				// Residual at the finest level:
+				if (level==0 && status)
+				{
+					const float nx = px+dx, ny = py+dy;
+					if (!isWindowNearImage(next[0],nx,ny,W,H))
+						status = 0;
+					else
+					{
+						samplePatch(next[0], nx, ny, W, H, &J[0]);
+						float err = 0;
+						for (int i=0;i<area;i++)
+							err+=std::abs(J[i]-I[i]);
+						(*d.errors)[k] = err/area;
+					}
+				}
+			}
+
+			(*d.out_pts)[k] = TPixelCoordf(pt.x+dx, pt.y+dy);
+		}
+	}
+}
+
+void mrpt::vision::detail::trackPointsPyrLK(
+	const std::vector<TGrayImageView> &prev,
+	const std::vector<TGrayImageView> &next,
+	const std::vector<TPixelCoordf> &pts,
+	std::vector<TPixelCoordf> &out_pts,
+	std::vector<char> &status,
+	std::vector<float> &errors,
+	const TPyrLKOptions &opts,
+	const unsigned int numThreads)
+{
+	ASSERT_(!prev.empty() && prev.size()==next.size())
+	ASSERT_(opts.window_width>0 && opts.window_height>0)
+
+	const size_t nPts = pts.size();
+	out_pts.resize(nPts);
+	status.assign(nPts,0);
+	errors.assign(nPts,0);
+	if (!nPts) return;
+
+	TPyrLKData d;
+	d.prev = &prev;
+	d.next = &next;
+	d.pts = &pts;
+	d.out_pts = &out_pts;
+	d.status = &status;
+	d.errors = &errors;
+	d.opts = &opts;
+	const unsigned int nThreads = numThreads!=0 ? numThreads : mrpt::system::getNumberOfProcessors();
+	mrpt::system::parallelForBlocks(nPts, &trackPointsBlock, &d, static_cast<unsigned int>(std::min<size_t>(nThreads, nPts)));
+}
@@ -0,0 +1,80 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/tracking.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+#if MRPT_HAS_OPENCV
+
+using namespace mrpt::vision;
+using namespace mrpt::utils;
+
+namespace
+{
+	// A smooth texture, displaced by (sx,sy) pixels.
+	void makeTestImage(CImage &img, const double sx, const double sy)
+	{
+		img = CImage(320,240, CH_GRAY);
+		for (unsigned int y=0;y<240;y++)
+			for (unsigned int x=0;x<320;x++)
+			{
+				const double X = x-sx, Y = y-sy;
+				const double v = 128 + 50*sin(X*0.21)*cos(Y*0.17) + 40*sin((X+Y)*0.11+1) + 30*cos(X*0.07-Y*0.23);
+				*img(x,y) = static_cast<uint8_t>(std::floor(v+0.5));
+			}
+	}
+
+	TSimpleFeaturefList makeFeatures()
+	{
+		TSimpleFeaturefList feats;
+		for (int y=30;y<220;y+=20)
+			for (int x=30;x<300;x+=20)
+				feats.push_back(TSimpleFeaturef(x+0.25f,y+0.5f));
+		return feats;
+	}
+}
+
+TEST(CFeatureTracker_KL, tracksSequenceReusingPyramids)
+{
+	CImage img0, img1, img2;
+	makeTestImage(img0, 0,0);
+	makeTestImage(img1, 2.3,-1.6);
+	makeTestImage(img2, 4.1,-0.2);
+
+	// The pyramid of img1 is reused in the second call:
+	CFeatureTracker_KL tracker;
+	TSimpleFeaturefList feats = makeFeatures();
+	const TSimpleFeaturefList feats0 = feats;
+	tracker.trackFeatures(img0,img1,feats);
+	const TSimpleFeaturefList feats1 = feats;
+	tracker.trackFeatures(img1,img2,feats);
+
+	ASSERT_EQ(feats.size(), feats0.size());
+	for (size_t i=0;i<feats.size();i++)
+	{
+		EXPECT_EQ(feats[i].track_status, status_TRACKED);
+		EXPECT_NEAR(feats[i].pt.x, feats0[i].pt.x+4.1, 0.05);
+		EXPECT_NEAR(feats[i].pt.y, feats0[i].pt.y-0.2, 0.05);
+	}
+
+	// The same than with fresh trackers (without any cached pyramid), with several threads:
+	TParametersDouble params;
+	params["num_threads"] = 3;
+	CFeatureTracker_KL tracker3(params);
+	TSimpleFeaturefList feats3 = feats1;
+	tracker3.trackFeatures(img1,img2,feats3);
+	for (size_t i=0;i<feats.size();i++)
+	{
+		EXPECT_EQ(feats[i].pt.x, feats3[i].pt.x);
+		EXPECT_EQ(feats[i].pt.y, feats3[i].pt.y);
+	}
+}
+
+#endif
@@ -14,6 +14,7 @@
 #include <mrpt/vision/pinhole.h>
 #include <mrpt/vision/CFeatureExtraction.h>
 #include <mrpt/vision/CFeature.h>
+#include <mrpt/vision/CBinaryDescriptorIndex.h>
 
 #include <mrpt/poses/CPoint3D.h>
 #include <mrpt/maps/CLandmarksMap.h>
@@ -496,6 +497,18 @@ size_t vision::matchFeatures(
 	int minLeftIdx = 0, minRightIdx;
 	int nMatches = 0;
 
+	// ORB descriptors with no geometric restriction: find the nearest neighbour of all the features in list1 at once,
+	//  with an index of the descriptors in list2 (same results than the exhaustive search below; minDist2 is not used for ORB).
+	const bool useORBIndex = options.matching_method==TMatchingOptions::mmDescriptorORB && !options.useEpipolarRestriction && !options.useXRestriction;
+	vector<size_t> orbNN_idx;
+	vector<uint32_t> orbNN_dist;
+	if( useORBIndex )
+	{
+		CBinaryDescriptorIndex orbIndex;
+		orbIndex.build( list2 );
+		orbIndex.knnSearch( list1, 1, orbNN_idx, orbNN_dist );
+	}
+
 	// For each feature in list1 ...
 	for( lFeat = 0, itList1 = list1.begin(); itList1 != list1.end(); ++itList1, ++lFeat )
 	{
@@ -514,7 +527,14 @@ size_t vision::matchFeatures(
 		// For all the cases
 		minRightIdx = 0;
 
-		for( rFeat = 0, itList2 = list2.begin(); itList2 != list2.end(); ++itList2, ++rFeat )		// ... compare with all the features in list2.
+		if( useORBIndex )
+		{
+			minLeftIdx  = lFeat;
+			minRightIdx = static_cast<int>( orbNN_idx[lFeat] );
+			minDist1    = orbNN_dist[lFeat];
+		}
+
+		for( rFeat = 0, itList2 = list2.begin(); !useORBIndex && itList2 != list2.end(); ++itList2, ++rFeat )		// ... compare with all the features in list2.
 		{
 			// Filter out by epipolar constraint
 			double d = 0.0;														// Distance to the epipolar line